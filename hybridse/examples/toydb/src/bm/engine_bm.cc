@@ -144,6 +144,14 @@ static void BM_EngineRunBatchWindowSumFeature5ExcludeCurrentTime(
     EngineRunBatchWindowSumFeature5ExcludeCurrentTime(
         &state, BENCHMARK, state.range(0), state.range(1));
 }
+static void BM_EngineRunBatchTableProjectFilter(
+    benchmark::State& state) {  // NOLINT
+    EngineRunBatchTableProjectFilter(&state, BENCHMARK, state.range(0),
+                                     state.range(1));
+}
+static void BM_EngineCompileDeployment(benchmark::State& state) {  // NOLINT
+    EngineCompileDeployment(&state, BENCHMARK, state.range(0) != 0);
+}
 static void BM_EngineRunBatchWindowSumFeature5Window5(
     benchmark::State& state) {  // NOLINT
     EngineRunBatchWindowSumFeature5Window5(&state, BENCHMARK, state.range(0),
@@ -257,6 +265,15 @@ BENCHMARK(BM_EngineRunBatchWindowSumFeature5)
     ->Args({100, 100})
     ->Args({1000, 1000})
     ->Args({10000, 10000});
+// compile without and with the jit object cache
+BENCHMARK(BM_EngineCompileDeployment)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+// exec batch size 1 is the row at a time execution
+BENCHMARK(BM_EngineRunBatchTableProjectFilter)
+    ->Args({1, 10000})
+    ->Args({64, 10000})
+    ->Args({1024, 10000})
+    ->Args({1, 100000})
+    ->Args({1024, 100000});
 BENCHMARK(BM_EngineRunBatchWindowSumFeature5Window5)
     ->Args({1, 2})
     ->Args({1, 10})
@@ -21,6 +21,7 @@
 #include <utility>
 #include <vector>
 #include "benchmark/benchmark.h"
+#include "boost/filesystem.hpp"
 #include "codec/type_codec.h"
 #include "gtest/gtest.h"
 #include "llvm/ExecutionEngine/Orc/LLJIT.h"
@@ -148,12 +149,13 @@ static void EngineRequestMode(const std::string sql, MODE mode,
 }
 
 static void EngineBatchMode(const std::string sql, MODE mode, int64_t limit_cnt,
-                            int64_t size, benchmark::State* state) {
+                            int64_t size, benchmark::State* state,
+                            const vm::EngineOptions& options = vm::EngineOptions()) {
     // prepare data into table
     InitializeNativeTarget();
     InitializeNativeTargetAsmPrinter();
     auto catalog = vm::BuildOnePkTableStorage(size);
-    Engine engine(catalog);
+    Engine engine(catalog, options);
     BatchRunSession session;
     base::Status query_status;
     engine.Get(sql, "db", session, query_status);
@@ -306,6 +308,66 @@ void EngineRunBatchWindowSumFeature5Window5(benchmark::State* state, MODE mode,
         std::to_string(limit_cnt) + ";";
     EngineBatchMode(sql, mode, limit_cnt, size, state);
 }
+void EngineRunBatchTableProjectFilter(benchmark::State* state, MODE mode,
+                                     int64_t exec_batch_size,
+                                     int64_t size) {  // NOLINT
+    // every row meets the condition
+    const std::string sql =
+        "SELECT col1 + col2 as c12, col3 * col4 as c34, col5 + 1000 as c5, "
+        "substr(col6, 1, 3) as c6 FROM t1 WHERE col1 > 0 and col4 > 0.0;";
+    vm::EngineOptions options;
+    options.SetExecBatchSize(exec_batch_size);
+    EngineBatchMode(sql, mode, size, size, state, options);
+}
+void EngineCompileDeployment(benchmark::State* state, MODE mode,
+                             bool enable_object_cache) {  // NOLINT
+    // a deployment with multiple windows
+    const std::string sql =
+        "SELECT "
+        "sum(col1) OVER w1 as w1_col1_sum, "
+        "max(col3) OVER w1 as w1_col3_max, "
+        "avg(col4) OVER w1 as w1_col4_avg, "
+        "count(col6) OVER w2 as w2_col6_cnt, "
+        "min(col2) OVER w2 as w2_col2_min, "
+        "substr(col6, 1, 3) as c6 "
+        "FROM t1 WINDOW "
+        "w1 AS (PARTITION BY col0 ORDER BY col5 ROWS_RANGE BETWEEN 30d "
+        "PRECEDING AND CURRENT ROW), "
+        "w2 AS (PARTITION BY col0 ORDER BY col5 ROWS BETWEEN 100 "
+        "PRECEDING AND CURRENT ROW);";
+    InitializeNativeTarget();
+    InitializeNativeTargetAsmPrinter();
+    auto catalog = vm::BuildOnePkTableStorage(1);
+    vm::EngineOptions options;
+    auto cache_dir = boost::filesystem::temp_directory_path() /
+                     boost::filesystem::unique_path();
+    if (enable_object_cache) {
+        options.jit_options().SetObjectCacheDir(cache_dir.string());
+    }
+    // a new engine compiles the sql as a restarted tablet
+    auto compile = [&]() {
+        Engine engine(catalog, options);
+        RequestRunSession session;
+        base::Status status;
+        return engine.Get(sql, "db", session, status);
+    };
+    switch (mode) {
+        case BENCHMARK: {
+            // fill the object cache
+            compile();
+            for (auto _ : *state) {
+                benchmark::DoNotOptimize(compile());
+            }
+            break;
+        }
+        case TEST: {
+            ASSERT_TRUE(compile());
+            ASSERT_TRUE(compile());
+            break;
+        }
+    }
+    boost::filesystem::remove_all(cache_dir);
+}
 void EngineRunBatchWindowMultiAggWindow25Feature25(benchmark::State* state,
                                                    MODE mode, int64_t limit_cnt,
                                                    int64_t size) {  // NOLINT
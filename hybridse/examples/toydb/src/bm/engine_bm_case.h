@@ -52,6 +52,13 @@ void EngineRunBatchWindowSumFeature1(benchmark::State* state, MODE mode,
 void EngineRunBatchWindowSumFeature5Window5(benchmark::State* state, MODE mode,
                                             int64_t limit_cnt,
                                             int64_t size);  // NOLINT
+// project and filter all rows of the table with `exec_batch_size` rows per run step
+void EngineRunBatchTableProjectFilter(benchmark::State* state, MODE mode,
+                                     int64_t exec_batch_size,
+                                     int64_t size);  // NOLINT
+// compile a deployment by a new engine, with or without the jit object cache
+void EngineCompileDeployment(benchmark::State* state, MODE mode,
+                             bool enable_object_cache);  // NOLINT
 void EngineRunBatchWindowMultiAggWindow25Feature25(benchmark::State* state,
                                                    MODE mode, int64_t limit_cnt,
                                                    int64_t size);  // NOLINT
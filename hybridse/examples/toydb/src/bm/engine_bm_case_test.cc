@@ -68,6 +68,16 @@ TEST_F(EngineBMCaseTest, EngineRunBatchWindowSumFeature1_TEST) {
     EngineRunBatchWindowSumFeature1(nullptr, TEST, 100L, 100L);
     EngineRunBatchWindowSumFeature1(nullptr, TEST, 1000L, 1000L);
 }
+TEST_F(EngineBMCaseTest, EngineRunBatchTableProjectFilter_TEST) {
+    EngineRunBatchTableProjectFilter(nullptr, TEST, 1L, 100L);
+    EngineRunBatchTableProjectFilter(nullptr, TEST, 16L, 10L);
+    EngineRunBatchTableProjectFilter(nullptr, TEST, 16L, 1000L);
+    EngineRunBatchTableProjectFilter(nullptr, TEST, 1024L, 1000L);
+}
+TEST_F(EngineBMCaseTest, EngineCompileDeployment_TEST) {
+    EngineCompileDeployment(nullptr, TEST, false);
+    EngineCompileDeployment(nullptr, TEST, true);
+}
 TEST_F(EngineBMCaseTest, EngineRunBatchWindowSumFeature5Window5_TEST) {
     EngineRunBatchWindowSumFeature5Window5(nullptr, TEST, 100L, 100L);
 }
@@ -147,22 +147,36 @@ class RefCountedSlice : public Slice {
     RefCountedSlice() : Slice(nullptr, 0), ref_cnt_(nullptr) {}
 
     RefCountedSlice(const RefCountedSlice &slice);
-    RefCountedSlice(RefCountedSlice &&);
+    // the moved slice becomes empty
+    RefCountedSlice(RefCountedSlice &&) noexcept;
     RefCountedSlice &operator=(const RefCountedSlice &);
-    RefCountedSlice &operator=(RefCountedSlice &&);
+    RefCountedSlice &operator=(RefCountedSlice &&) noexcept;
+
+    // Take the ownership of the managed buffer if this slice is its only
+    // reference, the slice becomes empty and the caller should free() the
+    // buffer. Return nullptr and keep the slice if the buffer is shared or
+    // not managed.
+    int8_t *TakeBuffer();
 
  private:
     RefCountedSlice(int8_t *data, size_t size, bool managed)
         : Slice(reinterpret_cast<const char *>(data), size),
-          ref_cnt_(managed ? new int(1) : nullptr) {}
+          ref_cnt_(managed ? NewRefCount() : nullptr) {}
 
     RefCountedSlice(const char *data, size_t size, bool managed)
-        : Slice(data, size), ref_cnt_(managed ? new int(1) : nullptr) {}
+        : Slice(data, size), ref_cnt_(managed ? NewRefCount() : nullptr) {}
 
     void Release();
 
     void Update(const RefCountedSlice &slice);
 
+    // The counts freed are cached by the thread freeing them and reused by
+    // its next managed slices, so creating a slice does not allocate once
+    // the cache is warm. The count is not atomic, the copies of a slice are
+    // not released by different threads at the same time.
+    static int32_t *NewRefCount();
+    static void DeleteRefCount(int32_t *ref_cnt);
+
     int32_t *ref_cnt_;
 };
 
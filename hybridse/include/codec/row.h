@@ -20,6 +20,7 @@
 #include <cstdint>
 #include <string>
 #include <vector>
+#include "absl/container/inlined_vector.h"
 #include "base/fe_slice.h"
 
 namespace hybridse {
@@ -30,6 +31,11 @@ using hybridse::base::Slice;
 
 class Row {
  public:
+    // The slices after the first one are kept inline up to this count, so
+    // the rows of joins and window unions of a few tables are built
+    // without allocating.
+    static constexpr size_t kInlineSliceNum = 3;
+
     Row();
     explicit Row(const std::string &str);
     Row(const Row &s);
@@ -76,6 +82,11 @@ class Row {
         }
         return 0 == slice_index ? slice_ : slices_[slice_index - 1];
     }
+    // Take the buffer of the pos-th slice if the row is its only owner,
+    // see RefCountedSlice::TakeBuffer
+    inline int8_t *TakeBuffer(int32_t pos) {
+        return 0 == pos ? slice_.TakeBuffer() : slices_.at(pos - 1).TakeBuffer();
+    }
     inline void Append(const hybridse::base::RefCountedSlice &slice) {
         slices_.emplace_back(slice);
     }
@@ -91,11 +102,13 @@ class Row {
     }
 
  private:
-    void Append(const std::vector<hybridse::base::RefCountedSlice> &slices);
+    using Slices = absl::InlinedVector<RefCountedSlice, kInlineSliceNum>;
+
+    void Append(const Slices &slices);
     void Append(const Row &b);
 
     RefCountedSlice slice_;
-    std::vector<RefCountedSlice> slices_;
+    Slices slices_;
 };
 
 }  // namespace codec
@@ -53,21 +53,36 @@ class RowIOBufView : public RowBaseView {
     int32_t GetDate(uint32_t, int32_t* year, int32_t* month, int32_t* day);
     int32_t GetDate(uint32_t, int32_t* date);
     int32_t GetString(uint32_t idx, butil::IOBuf* buf);
-    int32_t GetString(uint32_t idx, char** val, uint32_t* length) { return -1; }
+    // the string refers to the received block, it is only available if the
+    // row is contiguous and valid until the next Reset, return -1 otherwise
+    int32_t GetString(uint32_t idx, char** val, uint32_t* length);
     int32_t GetBool(uint32_t idx, bool* val);
 
     inline bool IsNULL(uint32_t idx) {
         uint32_t offset = codec::HEADER_LENGTH + (idx >> 3);
-        uint8_t val = 0;
-        row_.copy_to(reinterpret_cast<void*>(&val), 1, offset);
+        uint8_t val = ReadField<uint8_t>(offset);
         return val & (1 << (idx & 0x07));
     }
 
  private:
     bool Init();
 
+    template <typename T>
+    inline T ReadField(uint32_t offset) const {
+        T value = 0;
+        if (data_ != nullptr) {
+            memcpy(&value, data_ + offset, sizeof(T));
+        } else {
+            row_.copy_to(reinterpret_cast<void*>(&value), sizeof(T), offset);
+        }
+        return value;
+    }
+
  private:
     butil::IOBuf row_;
+    // the row in the block of row_ if it is not split across blocks, the
+    // fields are read from it directly instead of walking the block refs
+    const int8_t* data_;
     uint8_t str_addr_length_;
     bool is_valid_;
     uint32_t string_field_cnt_;
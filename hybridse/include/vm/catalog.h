@@ -258,6 +258,12 @@ class TableHandler : public DataHandler {
         return std::shared_ptr<Tablet>();
     }
 
+    /// Get the count of rows ever put into the dataset and the count of deletes
+    /// on it, they never decrease, so unchanged counts tell no row is put or
+    /// deleted since they were read. The rows expired by ttl are not counted.
+    /// Return `false` by default since the dataset does not track them.
+    virtual bool GetPutCount(uint64_t* put_cnt, uint64_t* delete_cnt) { return false; }
+
     static std::shared_ptr<TableHandler> Cast(std::shared_ptr<DataHandler> in);
 };
 
@@ -115,6 +115,26 @@ class EngineOptions {
     /// Return the maximum number of entries we can hold for compiling cache.
     inline uint32_t GetMaxSqlCacheSize() const { return max_sql_cache_size_; }
 
+    /// Set the maximum number of partition keys whose window state is cached by each window in
+    /// request mode, default is `0` which disables the state cache. A long window caches the
+    /// aggregate, other windows cache a copy of the window rows.
+    inline EngineOptions* SetWindowAggCacheSize(uint32_t size) {
+        window_agg_cache_size_ = size;
+        return this;
+    }
+    /// Return the maximum number of partition keys of the window aggregate state cache.
+    inline uint32_t GetWindowAggCacheSize() const { return window_agg_cache_size_; }
+
+    /// Set the number of rows the table project and filter runners read and evaluate in one run step in batch
+    /// mode, default is `1024`. The compiled function is still called once per row, the rows of a batch only share
+    /// the run step and the reads, the evaluation is not columnar. `1` evaluates the rows one at a time.
+    inline EngineOptions* SetExecBatchSize(uint32_t size) {
+        exec_batch_size_ = size;
+        return this;
+    }
+    /// Return the number of rows evaluated in one run step in batch mode.
+    inline uint32_t GetExecBatchSize() const { return exec_batch_size_; }
+
     /// Return JitOptions
     inline hybridse::vm::JitOptions& jit_options() { return jit_options_; }
 
@@ -128,6 +148,8 @@ class EngineOptions {
     bool enable_batch_window_parallelization_;
     bool enable_window_column_pruning_;
     uint32_t max_sql_cache_size_;
+    uint32_t window_agg_cache_size_;
+    uint32_t exec_batch_size_;
     JitOptions jit_options_;
 };
 
@@ -119,11 +119,22 @@ class JitOptions {
     bool IsEnablePerf() const { return enable_perf_; }
     void SetEnablePerf(bool flag) { enable_perf_ = flag; }
 
+    // the directory to keep the compiled objects, so that the same module is not compiled again,
+    // empty disables the object cache. Only supported by the default LLJIT engine.
+    const std::string& GetObjectCacheDir() const { return object_cache_dir_; }
+    void SetObjectCacheDir(const std::string& dir) { object_cache_dir_ = dir; }
+
+    // the max total bytes of the compiled objects in the cache directory
+    uint64_t GetObjectCacheMaxSize() const { return object_cache_max_size_; }
+    void SetObjectCacheMaxSize(uint64_t size) { object_cache_max_size_ = size; }
+
  private:
     bool enable_mcjit_ = false;
     bool enable_vtune_ = false;
     bool enable_gdb_ = false;
     bool enable_perf_ = false;
+    std::string object_cache_dir_;
+    uint64_t object_cache_max_size_ = 1ul << 30;
 };
 }  // namespace vm
 }  // namespace hybridse
@@ -43,6 +43,10 @@ struct SqlContext {
     bool enable_expr_optimize = false;
     bool enable_batch_window_parallelization = true;
     bool enable_window_column_pruning = false;
+    // max partition keys of the window aggregate state cache, 0 means disabled
+    uint32_t window_agg_cache_size = 0;
+    // rows evaluated in one run step by the table project and filter runners in batch mode, one compiled call per row
+    uint32_t exec_batch_size = 1024;
 
     // the sql content
     std::string sql;
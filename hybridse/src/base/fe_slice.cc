@@ -16,24 +16,81 @@
 
 #include "base/fe_slice.h"
 
+#include <vector>
+
 namespace hybridse {
 namespace base {
 
+namespace {
+
+constexpr size_t kMaxCachedRefCount = 1024;
+
+struct RefCountCache {
+    ~RefCountCache();
+    std::vector<int32_t*> free_list;
+};
+
+// the slices released after the cache of the exiting thread is destroyed
+// delete their counts directly
+thread_local bool ref_cnt_cache_destroyed = false;
+thread_local RefCountCache ref_cnt_cache;
+
+RefCountCache::~RefCountCache() {
+    for (auto ref_cnt : free_list) {
+        delete ref_cnt;
+    }
+    free_list.clear();
+    ref_cnt_cache_destroyed = true;
+}
+
+}  // namespace
+
+int32_t* RefCountedSlice::NewRefCount() {
+    if (!ref_cnt_cache_destroyed && !ref_cnt_cache.free_list.empty()) {
+        auto ref_cnt = ref_cnt_cache.free_list.back();
+        ref_cnt_cache.free_list.pop_back();
+        *ref_cnt = 1;
+        return ref_cnt;
+    }
+    return new int32_t(1);
+}
+
+void RefCountedSlice::DeleteRefCount(int32_t* ref_cnt) {
+    if (!ref_cnt_cache_destroyed && ref_cnt_cache.free_list.size() < kMaxCachedRefCount) {
+        ref_cnt_cache.free_list.push_back(ref_cnt);
+        return;
+    }
+    delete ref_cnt;
+}
+
 RefCountedSlice::~RefCountedSlice() { Release(); }
 
 void RefCountedSlice::Release() {
     if (this->ref_cnt_ != nullptr) {
-        auto& cnt = *this->ref_cnt_;
-        cnt -= 1;
-        if (cnt == 0 && buf() != nullptr) {
-            // memset in case the buf is still used after free
-            memset(buf(), 0, size());
-            free(buf());
-            delete this->ref_cnt_;
+        if (--(*this->ref_cnt_) == 0) {
+            if (buf() != nullptr) {
+                // memset in case the buf is still used after free
+                memset(buf(), 0, size());
+                free(buf());
+            }
+            DeleteRefCount(this->ref_cnt_);
         }
+        this->ref_cnt_ = nullptr;
     }
 }
 
+int8_t* RefCountedSlice::TakeBuffer() {
+    if (this->ref_cnt_ == nullptr || *this->ref_cnt_ != 1 ||
+        buf() == nullptr) {
+        return nullptr;
+    }
+    int8_t* data = buf();
+    DeleteRefCount(this->ref_cnt_);
+    this->ref_cnt_ = nullptr;
+    reset(nullptr, 0);
+    return data;
+}
+
 void RefCountedSlice::Update(const RefCountedSlice& slice) {
     reset(slice.data(), slice.size());
     this->ref_cnt_ = slice.ref_cnt_;
@@ -46,8 +103,10 @@ RefCountedSlice::RefCountedSlice(const RefCountedSlice& slice) {
     this->Update(slice);
 }
 
-RefCountedSlice::RefCountedSlice(RefCountedSlice&& slice) {
-    this->Update(slice);
+RefCountedSlice::RefCountedSlice(RefCountedSlice&& slice) noexcept
+    : Slice(slice.data(), slice.size()), ref_cnt_(slice.ref_cnt_) {
+    slice.ref_cnt_ = nullptr;
+    slice.reset(nullptr, 0);
 }
 
 RefCountedSlice& RefCountedSlice::operator=(const RefCountedSlice& slice) {
@@ -59,12 +118,15 @@ RefCountedSlice& RefCountedSlice::operator=(const RefCountedSlice& slice) {
     return *this;
 }
 
-RefCountedSlice& RefCountedSlice::operator=(RefCountedSlice&& slice) {
+RefCountedSlice& RefCountedSlice::operator=(RefCountedSlice&& slice) noexcept {
     if (&slice == this) {
         return *this;
     }
     this->Release();
-    this->Update(slice);
+    reset(slice.data(), slice.size());
+    this->ref_cnt_ = slice.ref_cnt_;
+    slice.ref_cnt_ = nullptr;
+    slice.reset(nullptr, 0);
     return *this;
 }
 
@@ -15,6 +15,11 @@
  */
 
 #include "base/fe_slice.h"
+
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
 #include "gtest/gtest.h"
 
 namespace hybridse {
@@ -46,6 +51,68 @@ TEST_F(SliceTest, ref_cnt_slice) {
     ASSERT_EQ(0, strcmp(reinterpret_cast<char*>(ref.buf()), "hello world"));
 }
 
+TEST_F(SliceTest, take_buffer) {
+    auto buf = reinterpret_cast<int8_t*>(malloc(16));
+    auto slice = RefCountedSlice::CreateManaged(buf, 16);
+    {
+        // shared buffer can not be taken
+        RefCountedSlice ref = slice;
+        ASSERT_EQ(nullptr, ref.TakeBuffer());
+        ASSERT_EQ(buf, ref.buf());
+    }
+    ASSERT_EQ(buf, slice.TakeBuffer());
+    ASSERT_EQ(nullptr, slice.buf());
+    ASSERT_EQ(0u, slice.size());
+    free(buf);
+
+    char data[] = "hello";
+    auto unmanaged = RefCountedSlice::Create(data, 5);
+    ASSERT_EQ(nullptr, unmanaged.TakeBuffer());
+    ASSERT_EQ(5u, unmanaged.size());
+}
+
+TEST_F(SliceTest, move_slice) {
+    auto buf = reinterpret_cast<int8_t*>(malloc(16));
+    auto slice = RefCountedSlice::CreateManaged(buf, 16);
+    RefCountedSlice moved(std::move(slice));
+    ASSERT_EQ(nullptr, slice.buf());  // NOLINT
+    ASSERT_EQ(buf, moved.buf());
+    RefCountedSlice assigned;
+    assigned = std::move(moved);
+    ASSERT_EQ(nullptr, moved.buf());  // NOLINT
+    // the only reference is moved along
+    ASSERT_EQ(buf, assigned.TakeBuffer());
+    free(buf);
+}
+
+TEST_F(SliceTest, release_in_other_thread) {
+    // the counts of the slices created by this thread are cached by the
+    // threads releasing them and reused by their slices
+    for (int round = 0; round < 100; round++) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++) {
+            std::vector<RefCountedSlice> slices;
+            for (int i = 0; i < 16; i++) {
+                auto buf = reinterpret_cast<int8_t*>(malloc(8));
+                slices.push_back(RefCountedSlice::CreateManaged(buf, 8));
+            }
+            threads.emplace_back([slices = std::move(slices)]() mutable {
+                std::vector<RefCountedSlice> copies(slices);
+                slices.clear();
+                copies.clear();
+                for (int i = 0; i < 16; i++) {
+                    auto buf = reinterpret_cast<int8_t*>(malloc(8));
+                    auto slice = RefCountedSlice::CreateManaged(buf, 8);
+                    ASSERT_EQ(buf, slice.buf());
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+}
+
 }  // namespace base
 }  // namespace hybridse
 
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "codec/row.h"
+
+// count the allocations by operator new, the row buffers are malloc-ed as
+// the generated code does, so the count is the bookkeeping of the rows only
+static std::atomic<uint64_t> new_cnt(0);
+
+void* operator new(size_t size) {
+    new_cnt.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = malloc(size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+
+namespace hybridse {
+namespace bm {
+
+using codec::Row;
+
+static constexpr size_t kBufSize = 64;
+
+static Row NewRow() {
+    auto buf = static_cast<int8_t*>(malloc(kBufSize));
+    return Row(base::RefCountedSlice::CreateManaged(buf, kBufSize));
+}
+
+// range(0) is the count of the slices of the left row. each iteration joins
+// a new output row to the left row as the join and window union runners do
+static void BM_RowJoin(benchmark::State& state) {  // NOLINT
+    int left_slices = state.range(0);
+    Row left = NewRow();
+    for (int i = 1; i < left_slices; i++) {
+        left = Row(i, left, 1, NewRow());
+    }
+    uint64_t start_cnt = new_cnt.load(std::memory_order_relaxed);
+    for (auto _ : state) {
+        Row out(left_slices, left, 1, NewRow());
+        benchmark::DoNotOptimize(out.buf(left_slices));
+    }
+    state.counters["allocs_per_row"] =
+        static_cast<double>(new_cnt.load(std::memory_order_relaxed) - start_cnt) / state.iterations();
+    state.SetItemsProcessed(state.iterations());
+}
+
+// each iteration creates a row of one managed slice and keeps it in a window
+// of 100 rows, the row pushed out releases its buffer
+static void BM_RowWindow(benchmark::State& state) {  // NOLINT
+    std::vector<Row> window(100);
+    size_t pos = 0;
+    uint64_t start_cnt = new_cnt.load(std::memory_order_relaxed);
+    for (auto _ : state) {
+        window[pos] = NewRow();
+        if (++pos == window.size()) {
+            pos = 0;
+        }
+    }
+    state.counters["allocs_per_row"] =
+        static_cast<double>(new_cnt.load(std::memory_order_relaxed) - start_cnt) / state.iterations();
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_RowJoin)->Arg(1)->Arg(2)->Arg(3)->Arg(4)->Arg(8);
+BENCHMARK(BM_RowWindow);
+
+}  // namespace bm
+}  // namespace hybridse
+
+BENCHMARK_MAIN();
@@ -74,6 +74,15 @@ static void BM_DateToString(benchmark::State& state) {  // NOLINT
 static void BM_DateFormat(benchmark::State& state) {  // NOLINT
     DateFormat(&state, BENCHMARK);
 }
+static void BM_RegexpLike(benchmark::State& state) {  // NOLINT
+    RegexpLike(&state, BENCHMARK, state.range(0));
+}
+static void BM_LikeMatch(benchmark::State& state) {  // NOLINT
+    LikeMatch(&state, BENCHMARK, state.range(0));
+}
+static void BM_ILikeMatch(benchmark::State& state) {  // NOLINT
+    ILikeMatch(&state, BENCHMARK, state.range(0));
+}
 
 static void BM_AllocFromByteMemPool1000(benchmark::State& state) {  // NOLINT
     ByteMemPoolAlloc1000(&state, BENCHMARK, state.range(0));
@@ -161,6 +170,10 @@ BENCHMARK(BM_TimestampFormat);
 BENCHMARK(BM_TimestampToString);
 BENCHMARK(BM_DateFormat);
 BENCHMARK(BM_DateToString);
+// one pattern is a constant pattern of a query, 1000 patterns overflow the pattern cache
+BENCHMARK(BM_RegexpLike)->Args({1})->Args({16})->Args({1000});
+BENCHMARK(BM_LikeMatch)->Args({1})->Args({16})->Args({1000});
+BENCHMARK(BM_ILikeMatch)->Args({1})->Args({16})->Args({1000});
 
 BENCHMARK(BM_HistoryWindowBuffer)
     ->Args({10})
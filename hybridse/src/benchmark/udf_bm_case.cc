@@ -592,6 +592,61 @@ void DateToString(benchmark::State* state, MODE mode) {
         }
     }
 }
+static std::vector<std::string> BuildPatterns(const std::string& prefix, const std::string& suffix,
+                                              int64_t pattern_cnt) {
+    std::vector<std::string> patterns;
+    for (int64_t i = 0; i < pattern_cnt; i++) {
+        patterns.push_back(prefix + std::to_string(i) + suffix);
+    }
+    return patterns;
+}
+template <typename F>
+static void PatternMatch(benchmark::State* state, MODE mode, const std::vector<std::string>& patterns, F&& match) {
+    codec::StringRef name("hybridse-0-user@4paradigm.com");
+    switch (mode) {
+        case BENCHMARK: {
+            size_t idx = 0;
+            for (auto _ : *state) {
+                codec::StringRef pattern(patterns[idx]);
+                bool out = false;
+                bool is_null = false;
+                match(&name, &pattern, &out, &is_null);
+                benchmark::DoNotOptimize(out);
+                idx = idx + 1 == patterns.size() ? 0 : idx + 1;
+            }
+            break;
+        }
+        case TEST: {
+            for (size_t i = 0; i < patterns.size(); i++) {
+                codec::StringRef pattern(patterns[i]);
+                bool out = false;
+                bool is_null = true;
+                match(&name, &pattern, &out, &is_null);
+                ASSERT_FALSE(is_null);
+                ASSERT_EQ(i == 0, out) << patterns[i];
+            }
+            break;
+        }
+    }
+}
+void RegexpLike(benchmark::State* state, MODE mode, int64_t pattern_cnt) {
+    PatternMatch(state, mode, BuildPatterns("[a-z]+-", "-[a-z]+@[a-z0-9]+\\.com", pattern_cnt),
+                 [](codec::StringRef* name, codec::StringRef* pattern, bool* out, bool* is_null) {
+                     udf::v1::regexp_like(name, pattern, out, is_null);
+                 });
+}
+void LikeMatch(benchmark::State* state, MODE mode, int64_t pattern_cnt) {
+    PatternMatch(state, mode, BuildPatterns("h%-", "-%@%.com", pattern_cnt),
+                 [](codec::StringRef* name, codec::StringRef* pattern, bool* out, bool* is_null) {
+                     udf::v1::like(name, pattern, out, is_null);
+                 });
+}
+void ILikeMatch(benchmark::State* state, MODE mode, int64_t pattern_cnt) {
+    PatternMatch(state, mode, BuildPatterns("H%-", "-%@%.COM", pattern_cnt),
+                 [](codec::StringRef* name, codec::StringRef* pattern, bool* out, bool* is_null) {
+                     udf::v1::ilike(name, pattern, out, is_null);
+                 });
+}
 int64_t RunHistoryWindowBuffer(const vm::WindowRange& window_range,
                                uint64_t data_size,
                                const bool exclude_current_time) {  // NOLINT
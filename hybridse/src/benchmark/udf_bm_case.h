@@ -40,6 +40,10 @@ void TimestampFormat(benchmark::State* state, MODE mode);
 
 void DateToString(benchmark::State* state, MODE mode);
 void DateFormat(benchmark::State* state, MODE mode);
+// String Udf, the rows cycle through pattern_cnt different patterns
+void RegexpLike(benchmark::State* state, MODE mode, int64_t pattern_cnt);
+void LikeMatch(benchmark::State* state, MODE mode, int64_t pattern_cnt);
+void ILikeMatch(benchmark::State* state, MODE mode, int64_t pattern_cnt);
 void ByteMemPoolAlloc1000(benchmark::State* state, MODE mode,
                           size_t request_size);
 void NewFree1000(benchmark::State* state, MODE mode, size_t request_size);
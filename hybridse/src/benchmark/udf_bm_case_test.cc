@@ -78,6 +78,18 @@ TEST_F(UdfBMCaseTest, TimestampToString_TEST) {
 TEST_F(UdfBMCaseTest, TimestampFormat_TEST) { TimestampFormat(nullptr, TEST); }
 
 TEST_F(UdfBMCaseTest, DateToString_TEST) { DateToString(nullptr, TEST); }
+TEST_F(UdfBMCaseTest, RegexpLike_TEST) {
+    RegexpLike(nullptr, TEST, 1);
+    RegexpLike(nullptr, TEST, 1000);
+}
+TEST_F(UdfBMCaseTest, LikeMatch_TEST) {
+    LikeMatch(nullptr, TEST, 1);
+    LikeMatch(nullptr, TEST, 1000);
+}
+TEST_F(UdfBMCaseTest, ILikeMatch_TEST) {
+    ILikeMatch(nullptr, TEST, 1);
+    ILikeMatch(nullptr, TEST, 1000);
+}
 TEST_F(UdfBMCaseTest, DateFormat_TEST) { DateFormat(nullptr, TEST); }
 
 }  // namespace bm
@@ -58,7 +58,7 @@ Row::Row(const RefCountedSlice &s) : slice_(s) {}
 
 Row::~Row() {}
 
-void Row::Append(const std::vector<RefCountedSlice> &slices) {
+void Row::Append(const Slices &slices) {
     if (!slices.empty()) {
         slices_.insert(slices_.end(), slices.begin(), slices.end());
     }
@@ -99,7 +99,7 @@ int8_t **Row::GetRowPtrs() const {
         int8_t **ptrs = new int8_t *[slices_.size() + 1];
         int pos = 0;
         ptrs[pos++] = slice_.buf();
-        for (auto slice : slices_) {
+        for (const auto &slice : slices_) {
             ptrs[pos++] = slice.buf();
         }
         return ptrs;
@@ -112,7 +112,7 @@ int32_t *Row::GetRowSizes() const {
         int32_t *sizes = new int32_t[slices_.size() + 1];
         int pos = 0;
         sizes[pos++] = slice_.size();
-        for (auto slice : slices_) {
+        for (const auto &slice : slices_) {
             sizes[pos++] = static_cast<int32_t>(slice.size());
         }
         return sizes;
@@ -99,6 +99,31 @@ TEST_F(RowTest, NewRowTest) {
     }
 }
 
+TEST_F(RowTest, ManySlicesTest) {
+    // more slices than the row keeps inline
+    const int slice_num = static_cast<int>(Row::kInlineSliceNum) + 3;
+    std::vector<Row> rows;
+    for (int i = 0; i < slice_num; i++) {
+        auto buf = reinterpret_cast<int8_t*>(malloc(sizeof(int32_t)));
+        *reinterpret_cast<int32_t*>(buf) = i;
+        rows.emplace_back(base::RefCountedSlice::CreateManaged(buf, sizeof(int32_t)));
+    }
+    Row joined = rows[0];
+    for (int i = 1; i < slice_num; i++) {
+        joined = Row(i, joined, 1, rows[i]);
+    }
+    rows.clear();
+    Row copied(joined);
+    ASSERT_EQ(slice_num, copied.GetRowPtrCnt());
+    for (int i = 0; i < slice_num; i++) {
+        ASSERT_EQ(i, *reinterpret_cast<int32_t*>(copied.buf(i)));
+        ASSERT_EQ(joined.buf(i), copied.buf(i));
+    }
+    ASSERT_EQ(0, joined.compare(copied));
+    // the buffers are shared by the two rows
+    ASSERT_EQ(nullptr, copied.TakeBuffer(slice_num - 1));
+}
+
 TEST_F(RowTest, JoinRowTest) {
     Row l, r;
     Row join(2, l, 2, r);
@@ -1569,6 +1569,11 @@ TEST_F(UdfIRBuilderTest, GetJsonObject) {
         {"9", json, R"(/o\p)"},  // any character can be escaped
         {nullptr, json, "/bar"},
         {nullptr, json, "/bar/0"},
+        {nullptr, json, "foo"},
+        {nullptr, json, "/m~2n"},
+        {"3", "[1, [2, 3]]", "/1/1"},
+        {nullptr, "[1, [2, 3]]", "/1/01"},
+        {nullptr, "[1, [2, 3]]", "/1/-"},
 
         {"", R"({"a": ""})", "/a"},
         {"str", R"({"a": "str"})", "/a"},
@@ -32,6 +32,11 @@ static const absl::flat_hash_set<absl::string_view> WHERE_FUNS = {
     "count_where", "sum_where", "avg_where", "min_where", "max_where",
 };
 
+// the functions whose second arg is a constant applied on output, e.g. the n of topn_frequency
+static const absl::flat_hash_set<absl::string_view> CONST_ARG_FUNS = {
+    "topn_frequency", "percentile",
+};
+
 LongWindowOptimized::LongWindowOptimized(PhysicalPlanContext* plan_ctx) : TransformUpPysicalPass(plan_ctx) {
     std::vector<std::string> windows;
     const auto* options = plan_ctx_->GetOptions();
@@ -340,6 +345,10 @@ absl::StatusOr<absl::string_view> CheckCountWhereArgs(const node::ExprNode* righ
 // - avg(col)
 // - count_where(col, simple_expr)
 // - count_where(*, simple_expr)
+// - distinct_count(col)
+// - median(col)
+// - percentile(col, constant)
+// - topn_frequency(col, constant)
 //
 // simple_expr can be
 // - BinaryExpr
@@ -372,6 +381,15 @@ absl::StatusOr<LongWindowOptimized::AggInfo> LongWindowOptimized::CheckCallExpr(
             absl::StrCat("[Long Window] first arg to op is not column or * :", call->GetExprString()));
     }
 
+    if (call->GetChildNum() == 2 && CONST_ARG_FUNS.contains(call->GetFnDef()->GetName())) {
+        // topn_frequency(col, n) or percentile(col, percentage), the second arg is constant
+        if (call->GetChild(1)->GetExprType() != node::kExprPrimary) {
+            return absl::UnimplementedError(absl::StrCat("[Long Window] second arg of ", call->GetFnDef()->GetName(),
+                                                         " is not constant: ", call->GetExprString()));
+        }
+        return AggInfo{key_col, filter_col};
+    }
+
     if (call->GetChildNum() == 2) {
         if (absl::c_none_of(WHERE_FUNS, [&call](absl::string_view e) { return call->GetFnDef()->GetName() == e; })) {
             return absl::UnimplementedError(absl::StrCat(call->GetFnDef()->GetName(), " not implemented"));
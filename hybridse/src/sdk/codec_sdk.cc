@@ -15,12 +15,14 @@
 #include "sdk/codec_sdk.h"
 
 #include "butil/iobuf.h"
+#include "codec/type_codec.h"
 
 namespace hybridse {
 namespace sdk {
 
 RowIOBufView::RowIOBufView(const hybridse::codec::Schema& schema)
     : row_(),
+      data_(nullptr),
       str_addr_length_(0),
       is_valid_(true),
       string_field_cnt_(0),
@@ -60,6 +62,7 @@ bool RowIOBufView::Init() {
 
 bool RowIOBufView::Reset(const butil::IOBuf& buf) {
     row_ = buf;
+    data_ = row_.backing_block_num() == 1 ? reinterpret_cast<const int8_t*>(row_.backing_block(0).data()) : nullptr;
     if (schema_.size() == 0 || row_.size() <= codec::HEADER_LENGTH) {
         is_valid_ = false;
         return false;
@@ -83,7 +86,7 @@ int32_t RowIOBufView::GetBool(uint32_t idx, bool* val) {
         return 1;
     }
     uint32_t offset = offset_vec_.at(idx);
-    *val = v1::GetBoolField(row_, offset) == 1 ? true : false;
+    *val = ReadField<int8_t>(offset) == 1 ? true : false;
     return 0;
 }
 
@@ -93,7 +96,7 @@ int32_t RowIOBufView::GetInt16(uint32_t idx, int16_t* val) {
         return 1;
     }
     uint32_t offset = offset_vec_.at(idx);
-    *val = v1::GetInt16Field(row_, offset);
+    *val = ReadField<int16_t>(offset);
     return 0;
 }
 
@@ -103,7 +106,7 @@ int32_t RowIOBufView::GetInt32(uint32_t idx, int32_t* val) {
         return 1;
     }
     uint32_t offset = offset_vec_.at(idx);
-    *val = v1::GetInt32Field(row_, offset);
+    *val = ReadField<int32_t>(offset);
     return 0;
 }
 
@@ -113,7 +116,7 @@ int32_t RowIOBufView::GetInt64(uint32_t idx, int64_t* val) {
         return 1;
     }
     uint32_t offset = offset_vec_.at(idx);
-    *val = v1::GetInt64Field(row_, offset);
+    *val = ReadField<int64_t>(offset);
     return 0;
 }
 
@@ -123,7 +126,7 @@ int32_t RowIOBufView::GetFloat(uint32_t idx, float* val) {
         return 1;
     }
     uint32_t offset = offset_vec_.at(idx);
-    *val = v1::GetFloatField(row_, offset);
+    *val = ReadField<float>(offset);
     return 0;
 }
 
@@ -133,7 +136,7 @@ int32_t RowIOBufView::GetDouble(uint32_t idx, double* val) {
         return 1;
     }
     uint32_t offset = offset_vec_.at(idx);
-    *val = v1::GetDoubleField(row_, offset);
+    *val = ReadField<double>(offset);
     return 0;
 }
 
@@ -143,7 +146,7 @@ int32_t RowIOBufView::GetTimestamp(uint32_t idx, int64_t* val) {
         return 1;
     }
     uint32_t offset = offset_vec_.at(idx);
-    *val = v1::GetInt64Field(row_, offset);
+    *val = ReadField<int64_t>(offset);
     return 0;
 }
 int32_t RowIOBufView::GetDate(uint32_t idx, int32_t* date) {
@@ -154,7 +157,7 @@ int32_t RowIOBufView::GetDate(uint32_t idx, int32_t* date) {
         return 1;
     }
     uint32_t offset = offset_vec_.at(idx);
-    *date = static_cast<int32_t>(v1::GetInt32Field(row_, offset));
+    *date = ReadField<int32_t>(offset);
     return 0;
 }
 int32_t RowIOBufView::GetDate(uint32_t idx, int32_t* year, int32_t* month,
@@ -166,7 +169,7 @@ int32_t RowIOBufView::GetDate(uint32_t idx, int32_t* year, int32_t* month,
         return 1;
     }
     uint32_t offset = offset_vec_.at(idx);
-    int32_t date = static_cast<int32_t>(v1::GetInt32Field(row_, offset));
+    int32_t date = ReadField<int32_t>(offset);
     *day = date & 0x0000000FF;
     date = date >> 8;
     *month = 1 + (date & 0x0000FF);
@@ -187,6 +190,23 @@ int32_t RowIOBufView::GetString(uint32_t idx, butil::IOBuf* buf) {
                            str_field_start_offset_, str_addr_length_, buf);
 }
 
+int32_t RowIOBufView::GetString(uint32_t idx, char** val, uint32_t* length) {
+    if (val == NULL || length == NULL || data_ == nullptr) return -1;
+    if (IsNULL(idx)) {
+        return 1;
+    }
+    uint32_t field_offset = offset_vec_.at(idx);
+    uint32_t next_str_field_offset = 0;
+    if (offset_vec_.at(idx) < string_field_cnt_ - 1) {
+        next_str_field_offset = field_offset + 1;
+    }
+    const char* data = nullptr;
+    int32_t ret = codec::v1::GetStrFieldUnsafe(data_, idx, field_offset, next_str_field_offset,
+                                               str_field_start_offset_, str_addr_length_, &data, length);
+    *val = const_cast<char*>(data);
+    return ret;
+}
+
 namespace v1 {
 
 int32_t GetStrField(const butil::IOBuf& row, uint32_t field_offset,
@@ -214,6 +214,58 @@ TEST_F(CodecSDKTest, Encode) {
     }
 }
 
+TEST_F(CodecSDKTest, SplitRow) {
+    codec::Schema schema;
+    ::hybridse::type::ColumnDef* col = schema.Add();
+    col->set_name("col1");
+    col->set_type(::hybridse::type::kInt64);
+    col = schema.Add();
+    col->set_name("col2");
+    col->set_type(::hybridse::type::kVarchar);
+    col = schema.Add();
+    col->set_name("col3");
+    col->set_type(::hybridse::type::kVarchar);
+    std::string str1(100, 'a');
+    std::string str2(200, 'b');
+    codec::RowBuilder builder(schema);
+    uint32_t size = builder.CalTotalLength(str1.size() + str2.size());
+    std::string row;
+    row.resize(size);
+    builder.SetBuffer(reinterpret_cast<int8_t*>(&(row[0])), size);
+    ASSERT_TRUE(builder.AppendInt64(42));
+    ASSERT_TRUE(builder.AppendString(str1.c_str(), str1.size()));
+    ASSERT_TRUE(builder.AppendString(str2.c_str(), str2.size()));
+
+    butil::IOBuf contiguous;
+    contiguous.append(row);
+    // the second half is a user data block, so the row is split across two blocks
+    butil::IOBuf split;
+    split.append(row.data(), size / 2);
+    void* second = malloc(size - size / 2);
+    memcpy(second, row.data() + size / 2, size - size / 2);
+    ASSERT_EQ(0, split.append_user_data(second, size - size / 2, free));
+    ASSERT_EQ(2u, split.backing_block_num());
+
+    for (auto* buf : {&contiguous, &split}) {
+        RowIOBufView view(schema);
+        ASSERT_TRUE(view.Reset(*buf));
+        int64_t val = 0;
+        ASSERT_EQ(view.GetInt64(0, &val), 0);
+        ASSERT_EQ(val, 42);
+        butil::IOBuf tmp;
+        ASSERT_EQ(view.GetString(2, &tmp), 0);
+        ASSERT_EQ(tmp.to_string(), str2);
+        char* data = nullptr;
+        uint32_t length = 0;
+        if (buf == &split) {
+            ASSERT_EQ(view.GetString(1, &data, &length), -1);
+        } else {
+            ASSERT_EQ(view.GetString(1, &data, &length), 0);
+            ASSERT_EQ(std::string(data, length), str1);
+        }
+    }
+}
+
 }  // namespace sdk
 }  // namespace hybridse
 
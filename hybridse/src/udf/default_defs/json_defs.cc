@@ -14,8 +14,14 @@
  * limitations under the License.
  */
 
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
+
 #include "simdjson.h"
 #include "udf/default_udf_library.h"
+#include "udf/pattern_cache.h"
 #include "udf/udf.h"
 #include "udf/udf_library.h"
 #include "udf/udf_registry.h"
@@ -23,24 +29,164 @@
 namespace hybridse {
 namespace udf {
 
+namespace {
+
+// a reference token of a JSON pointer, it is the key of an object or the index of an array, nullopt if the
+// token is invalid for the type
+struct JsonPointerToken {
+    std::optional<std::string> key;
+    std::optional<size_t> index;
+};
+
+// the tokens of a JSON pointer, empty for the whole document, nullopt if the pointer is invalid
+using JsonPointer = std::optional<std::vector<JsonPointerToken>>;
+
+// parse the pointer as simdjson at_pointer does, see https://datatracker.ietf.org/doc/html/rfc6901
+JsonPointer ParseJsonPointer(std::string_view path) {
+    std::vector<JsonPointerToken> tokens;
+    if (path.empty()) {
+        return tokens;
+    }
+    if (path[0] != '/') {
+        return std::nullopt;
+    }
+    size_t pos = 1;
+    while (true) {
+        size_t slash = path.find('/', pos);
+        std::string_view raw = path.substr(pos, slash == std::string_view::npos ? slash : slash - pos);
+        JsonPointerToken token;
+        // '~0' is '~' and '~1' is '/'
+        std::string key;
+        bool valid_key = true;
+        for (size_t i = 0; i < raw.size(); i++) {
+            if (raw[i] != '~') {
+                key.push_back(raw[i]);
+            } else if (i + 1 < raw.size() && (raw[i + 1] == '0' || raw[i + 1] == '1')) {
+                key.push_back(raw[++i] == '0' ? '~' : '/');
+            } else {
+                valid_key = false;
+                break;
+            }
+        }
+        if (valid_key) {
+            token.key = std::move(key);
+        }
+        // digits without leading zero
+        size_t index = 0;
+        bool valid_index = !raw.empty() && (raw.size() == 1 || raw[0] != '0');
+        for (size_t i = 0; valid_index && i < raw.size(); i++) {
+            uint8_t digit = static_cast<uint8_t>(raw[i] - '0');
+            valid_index = digit <= 9;
+            index = index * 10 + digit;
+        }
+        if (valid_index) {
+            token.index = index;
+        }
+        tokens.push_back(std::move(token));
+        if (slash == std::string_view::npos) {
+            break;
+        }
+        pos = slash + 1;
+    }
+    return tokens;
+}
+
+// JsonDocument is the parser of a thread and the document it parsed last. A request usually extracts many
+// fields from the same json column, so a document equal to the last one is rewound instead of parsed again.
+class JsonDocument {
+ public:
+    static JsonDocument& Local() {
+        static thread_local JsonDocument doc;
+        return doc;
+    }
+
+    // return nullptr if json is not a valid document
+    simdjson::ondemand::document* Parse(std::string_view json) {
+        if (valid_ && json.size() == size_ && (size_ == 0 || memcmp(buf_.data(), json.data(), size_) == 0)) {
+            doc_.rewind();
+            return &doc_;
+        }
+        // the padding is zeroed, so the bytes after the document do not depend on the former documents
+        if (buf_.size() < json.size() + simdjson::SIMDJSON_PADDING) {
+            buf_.resize(json.size() + simdjson::SIMDJSON_PADDING);
+        }
+        memcpy(buf_.data(), json.data(), json.size());
+        memset(buf_.data() + json.size(), 0, simdjson::SIMDJSON_PADDING);
+        size_ = json.size();
+        valid_ = !parser_.iterate(buf_.data(), size_, buf_.size()).get(doc_);
+        return valid_ ? &doc_ : nullptr;
+    }
+
+    // an error may leave the document in a broken state, so it is parsed again by the next call
+    void Invalidate() { valid_ = false; }
+
+ private:
+    simdjson::ondemand::parser parser_;
+    std::string buf_;
+    size_t size_ = 0;
+    simdjson::ondemand::document doc_;
+    bool valid_ = false;
+};
+
+// the child of a document or a value at token
+template <typename T>
+simdjson::error_code GetChild(T& node, const JsonPointerToken& token, simdjson::ondemand::value* child) {
+    simdjson::ondemand::json_type type;
+    SIMDJSON_TRY(node.type().get(type));
+    switch (type) {
+        case simdjson::ondemand::json_type::array: {
+            simdjson::ondemand::array arr;
+            SIMDJSON_TRY(node.get_array().get(arr));
+            if (!token.index) {
+                return simdjson::error_code::INCORRECT_TYPE;
+            }
+            return arr.at(*token.index).get(*child);
+        }
+        case simdjson::ondemand::json_type::object: {
+            simdjson::ondemand::object obj;
+            SIMDJSON_TRY(node.get_object().get(obj));
+            if (!token.key) {
+                return simdjson::error_code::INVALID_JSON_POINTER;
+            }
+            return obj.find_field(*token.key).get(*child);
+        }
+        default:
+            return simdjson::error_code::INVALID_JSON_POINTER;
+    }
+}
+
+simdjson::error_code GetValue(simdjson::ondemand::document* doc, const std::vector<JsonPointerToken>& tokens,
+                              simdjson::ondemand::value* val) {
+    if (tokens.empty()) {
+        return doc->get_value().get(*val);
+    }
+    SIMDJSON_TRY(GetChild(*doc, tokens[0], val));
+    for (size_t i = 1; i < tokens.size(); i++) {
+        SIMDJSON_TRY(GetChild(*val, tokens[i], val));
+    }
+    return simdjson::error_code::SUCCESS;
+}
+
+}  // namespace
+
 void json_array_length(openmldb::base::StringRef* in, int32_t* sz, bool* is_null) noexcept {
     *is_null = true;
 
-    simdjson::ondemand::parser parser;
-    simdjson::padded_string json(in->data_, in->size_);
-    simdjson::ondemand::document doc;
-    auto err = parser.iterate(json).get(doc);
-    if (err) {
+    auto& json_doc = JsonDocument::Local();
+    auto doc = json_doc.Parse(std::string_view(in->data_, in->size_));
+    if (doc == nullptr) {
         return;
     }
     simdjson::ondemand::array arr;
-    err = doc.get_array().get(arr);
+    auto err = doc->get_array().get(arr);
     if (err) {
+        json_doc.Invalidate();
         return;
     }
     size_t arr_sz;
     arr.count_elements().tie(arr_sz, err);
     if (err) {
+        json_doc.Invalidate();
         return;
     }
 
@@ -52,23 +198,28 @@ void get_json_object(openmldb::base::StringRef* in, openmldb::base::StringRef* j
                      openmldb::base::StringRef* out, bool* is_null) noexcept {
     *is_null = true;
 
-    simdjson::ondemand::parser parser;
-    simdjson::padded_string json(in->data_, in->size_);
-    simdjson::ondemand::document doc;
-    simdjson::error_code err = simdjson::error_code::SUCCESS;
-
-    if (parser.iterate(json).tie(doc, err); err) {
+    // the json path is usually a constant, it is parsed once by a thread
+    std::string_view path(json_path->data_, json_path->size_);
+    const auto& pointer = PatternCache<JsonPointer>::Local().Get(path, [&]() { return ParseJsonPointer(path); });
+    if (!pointer) {
         return;
     }
 
+    auto& json_doc = JsonDocument::Local();
+    auto doc = json_doc.Parse(std::string_view(in->data_, in->size_));
+    if (doc == nullptr) {
+        return;
+    }
+    simdjson::error_code err = simdjson::error_code::SUCCESS;
     simdjson::ondemand::value val;
-    std::string_view path(json_path->data_, json_path->size_);
-    if (doc.at_pointer(path).tie(val, err); err) {
+    if (err = GetValue(doc, *pointer, &val); err) {
+        json_doc.Invalidate();
         return;
     }
 
     simdjson::ondemand::json_type type;
     if (val.type().tie(type, err); err) {
+        json_doc.Invalidate();
         return;
     }
     std::string_view raw_str;
@@ -82,12 +233,14 @@ void get_json_object(openmldb::base::StringRef* in, openmldb::base::StringRef* j
         case simdjson::ondemand::json_type::array:
         case simdjson::ondemand::json_type::object: {
             if (simdjson::to_json_string(val).tie(raw_str, err); err) {
+                json_doc.Invalidate();
                 return;
             }
             break;
         }
         case simdjson::ondemand::json_type::string: {
             if (val.get_string().tie(raw_str, err); err) {
+                json_doc.Invalidate();
                 return;
             }
             break;
@@ -430,6 +430,52 @@ struct MedianDef {
     }
 };
 
+// the percentile by linear interpolation between the closest ranks, the rank of percentage p in n values
+// is p * (n - 1), same as the percentile of spark
+template <typename T>
+struct PercentileDef {
+    // the values and the percentage
+    using ContainerT = std::pair<std::vector<double>, double>;
+
+    void operator()(UdafRegistryHelper& helper) {  // NOLINT
+        std::string suffix = ".opaque_vector_" + DataTypeTrait<T>::to_string();
+        helper.templates<Nullable<double>, Opaque<ContainerT>, Nullable<T>, Nullable<double>>()
+            .init("percentile_init" + suffix, PercentileDef::Init)
+            .update("percentile_update" + suffix, PercentileDef::Update)
+            .output("percentile_output" + suffix, reinterpret_cast<void*>(PercentileDef::Output), true);
+    }
+
+    static void Init(ContainerT* addr) { new (addr) ContainerT({}, -1); }
+
+    static ContainerT* Update(ContainerT* container, T value, bool is_null, double percentage,
+                              bool percentage_is_null) {
+        container->second = percentage_is_null ? -1 : percentage;
+        if (!is_null) {
+            container->first.push_back(static_cast<double>(value));
+        }
+        return container;
+    }
+
+    static void Output(ContainerT* container, double* ret, bool* is_null) {
+        auto& values = container->first;
+        double percentage = container->second;
+        if (values.empty() || !(percentage >= 0 && percentage <= 1)) {
+            *is_null = true;
+        } else {
+            *is_null = false;
+            double rank = percentage * (values.size() - 1);
+            size_t lower = static_cast<size_t>(rank);
+            std::nth_element(values.begin(), values.begin() + lower, values.end());
+            *ret = values[lower];
+            if (rank > lower) {
+                double upper = *std::min_element(values.begin() + lower + 1, values.end());
+                *ret += (upper - *ret) * (rank - lower);
+            }
+        }
+        container->~ContainerT();
+    }
+};
+
 template <typename T>
 struct SumWhereDef {
     void operator()(UdafRegistryHelper& helper) {  // NOLINT
@@ -3071,6 +3117,29 @@ void DefaultUdfLibrary::InitUdaf() {
         )")
         .args_in<int16_t, int32_t, int64_t, float, double>();
 
+    RegisterUdafTemplate<PercentileDef>("percentile")
+        .doc(R"(
+            @brief Compute the percentile of values, it interpolates linearly between the closest ranks.
+
+            @param value  Specify value column to aggregate on.
+            @param percentage  Specify the percentage between 0 and 1. If NULL or out of the range, the output is NULL
+
+            Example:
+
+            |value|
+            |--|
+            |1|
+            |2|
+            |3|
+            |4|
+            @code{.sql}
+                SELECT percentile(value, 0.9) OVER w;
+                -- output 3.7
+            @endcode
+            @since 0.9.0
+        )")
+        .args_in<int16_t, int32_t, int64_t, float, double>();
+
     RegisterUdafTemplate<DrawdownUdafDef>("drawdown")
         .doc(R"(
             @brief Compute drawdown of values.
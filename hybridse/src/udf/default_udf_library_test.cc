@@ -69,6 +69,8 @@ TEST_F(DefaultUdfLibraryTest, TestCheckIsUdafByName) {
     ASSERT_TRUE(library->IsUdaf("avg"));
     // median(...) is an udaf
     ASSERT_TRUE(library->IsUdaf("median"));
+    // percentile(...) is an udaf
+    ASSERT_TRUE(library->IsUdaf("percentile"));
 
     // hour(..) isn't an udaf
     ASSERT_TRUE(!library->IsUdaf("hour"));
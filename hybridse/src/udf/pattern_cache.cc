@@ -0,0 +1,41 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "udf/pattern_cache.h"
+
+namespace hybridse {
+namespace udf {
+
+LikePattern::LikePattern(std::string_view pattern, const char* escape) : segments_(1) {
+    for (size_t i = 0; i < pattern.size(); i++) {
+        char c = pattern[i];
+        if (escape != nullptr && c == *escape) {
+            if (i + 1 == pattern.size()) {
+                // the pattern is terminated with escape character
+                valid_ = false;
+                return;
+            }
+            segments_.back().push_back({pattern[++i], false});
+        } else if (c == '%') {
+            segments_.emplace_back();
+        } else {
+            segments_.back().push_back({c, c == '_'});
+        }
+    }
+}
+
+}  // namespace udf
+}  // namespace hybridse
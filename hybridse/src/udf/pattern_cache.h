@@ -0,0 +1,152 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_SRC_UDF_PATTERN_CACHE_H_
+#define HYBRIDSE_SRC_UDF_PATTERN_CACHE_H_
+
+#include <list>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+
+namespace hybridse {
+namespace udf {
+
+// LikePattern is a SQL LIKE pattern parsed once, the pattern is split by the unescaped percent signs into
+// segments of fixed length, so a match is a linear scan instead of the backtracking over the raw pattern.
+//
+// It follows the rules of like_match: an escape character makes the next character a literal and a pattern
+// terminated with a lone escape character never matches.
+class LikePattern {
+ public:
+    // escape is nullptr if the escape is disabled
+    LikePattern(std::string_view pattern, const char* escape);
+
+    template <typename EQUAL>
+    bool Match(std::string_view name, EQUAL&& equal) const;
+
+ private:
+    // a character of a segment, any is true for the underscore
+    struct Token {
+        char c;
+        bool any;
+    };
+    using Segment = std::vector<Token>;
+
+    template <typename EQUAL>
+    static bool MatchAt(const Segment& segment, std::string_view name, size_t pos, EQUAL& equal);
+
+    // segments_.size() - 1 is the number of percent signs
+    std::vector<Segment> segments_;
+    bool valid_ = true;
+};
+
+// PatternCache is a bounded lru cache of compiled patterns for the pattern functions, e.g. regexp_like.
+// It is not thread safe, every thread has its own cache through Local(). The most recently used pattern
+// is checked before the hash lookup, so a constant pattern of a query costs one string compare per row.
+template <typename T>
+class PatternCache {
+ public:
+    static constexpr size_t kDefaultCapacity = 64;
+
+    explicit PatternCache(size_t capacity = kDefaultCapacity) : capacity_(capacity) {}
+    PatternCache(const PatternCache&) = delete;
+    PatternCache& operator=(const PatternCache&) = delete;
+
+    static PatternCache& Local() {
+        static thread_local PatternCache cache;
+        return cache;
+    }
+
+    // return the pattern of key, it is created by create(), which returns T, if it is not cached. The
+    // reference is valid until the next Get of this cache
+    template <typename CREATE>
+    const T& Get(std::string_view key, CREATE&& create) {
+        if (!lru_.empty() && lru_.front().first == key) {
+            return lru_.front().second;
+        }
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            return lru_.front().second;
+        }
+        if (lru_.size() >= capacity_) {
+            index_.erase(lru_.back().first);
+            lru_.pop_back();
+        }
+        lru_.emplace_front(std::string(key), create());
+        // the key of the index refers to the string in the list node, which never moves
+        index_.emplace(lru_.front().first, lru_.begin());
+        return lru_.front().second;
+    }
+
+    size_t GetSize() const { return lru_.size(); }
+
+ private:
+    using Entry = std::pair<std::string, T>;
+
+    const size_t capacity_;
+    std::list<Entry> lru_;
+    absl::flat_hash_map<std::string_view, typename std::list<Entry>::iterator> index_;
+};
+
+template <typename EQUAL>
+bool LikePattern::MatchAt(const Segment& segment, std::string_view name, size_t pos, EQUAL& equal) {
+    for (size_t i = 0; i < segment.size(); i++) {
+        if (!segment[i].any && !equal(segment[i].c, name[pos + i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename EQUAL>
+bool LikePattern::Match(std::string_view name, EQUAL&& equal) const {
+    if (!valid_) {
+        return false;
+    }
+    const Segment& first = segments_.front();
+    if (segments_.size() == 1) {
+        return name.size() == first.size() && MatchAt(first, name, 0, equal);
+    }
+    const Segment& last = segments_.back();
+    if (name.size() < first.size() + last.size() || !MatchAt(first, name, 0, equal) ||
+        !MatchAt(last, name, name.size() - last.size(), equal)) {
+        return false;
+    }
+    // the segments between two percent signs match at their leftmost positions, which leaves the most
+    // characters to the rest
+    size_t pos = first.size();
+    size_t end = name.size() - last.size();
+    for (size_t i = 1; i + 1 < segments_.size(); i++) {
+        const Segment& segment = segments_[i];
+        while (pos + segment.size() <= end && !MatchAt(segment, name, pos, equal)) {
+            pos++;
+        }
+        if (pos + segment.size() > end) {
+            return false;
+        }
+        pos += segment.size();
+    }
+    return true;
+}
+
+}  // namespace udf
+}  // namespace hybridse
+#endif  // HYBRIDSE_SRC_UDF_PATTERN_CACHE_H_
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "udf/pattern_cache.h"
+
+#include <random>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace hybridse {
+namespace udf {
+
+class PatternCacheTest : public ::testing::Test {};
+
+namespace {
+bool Equal(char lhs, char rhs) { return lhs == rhs; }
+
+// the backtracking match over the raw pattern
+bool SlowLike(std::string_view name, std::string_view pattern, const char* escape) {
+    if (pattern.empty()) {
+        return name.empty();
+    }
+    char c = pattern[0];
+    if (escape != nullptr && c == *escape) {
+        if (pattern.size() == 1) {
+            return false;
+        }
+        return !name.empty() && name[0] == pattern[1] && SlowLike(name.substr(1), pattern.substr(2), escape);
+    }
+    if (c == '%') {
+        for (size_t i = 0; i <= name.size(); i++) {
+            if (SlowLike(name.substr(i), pattern.substr(1), escape)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    return !name.empty() && (c == '_' || c == name[0]) && SlowLike(name.substr(1), pattern.substr(1), escape);
+}
+}  // namespace
+
+TEST_F(PatternCacheTest, LikePattern) {
+    char escape = '\\';
+    ASSERT_TRUE(LikePattern("", &escape).Match("", Equal));
+    ASSERT_FALSE(LikePattern("", &escape).Match("a", Equal));
+    ASSERT_TRUE(LikePattern("%", &escape).Match("", Equal));
+    ASSERT_TRUE(LikePattern("a%b%c", &escape).Match("abc", Equal));
+    ASSERT_TRUE(LikePattern("a%b%c", &escape).Match("axxbxxbc", Equal));
+    ASSERT_FALSE(LikePattern("a%bb%c", &escape).Match("abc", Equal));
+    ASSERT_TRUE(LikePattern("%\\%%", &escape).Match("50%", Equal));
+    ASSERT_FALSE(LikePattern("%\\%", &escape).Match("50", Equal));
+    ASSERT_FALSE(LikePattern("a\\", &escape).Match("a\\", Equal));
+    ASSERT_FALSE(LikePattern("a\\", &escape).Match("a", Equal));
+    ASSERT_TRUE(LikePattern("a\\", nullptr).Match("a\\", Equal));
+
+    // compare with the backtracking match on random patterns
+    std::mt19937 rand(42);
+    const std::string alphabet = "ab%_\\";
+    auto random_string = [&](size_t max_size, size_t alphabet_size) {
+        std::string str(rand() % (max_size + 1), 'a');
+        for (auto& c : str) {
+            c = alphabet[rand() % alphabet_size];
+        }
+        return str;
+    };
+    for (int i = 0; i < 20000; i++) {
+        std::string pattern = random_string(8, alphabet.size());
+        std::string name = random_string(8, 2);
+        const char* esc = i % 2 == 0 ? &escape : nullptr;
+        ASSERT_EQ(SlowLike(name, pattern, esc), LikePattern(pattern, esc).Match(name, Equal))
+            << name << " like " << pattern << (esc ? " escape \\" : "");
+    }
+}
+
+TEST_F(PatternCacheTest, Lru) {
+    PatternCache<std::string> cache(2);
+    int created = 0;
+    auto get = [&](const std::string& key) {
+        return cache.Get(key, [&]() {
+            created++;
+            return key + "!";
+        });
+    };
+    ASSERT_EQ("a!", get("a"));
+    ASSERT_EQ("a!", get("a"));
+    ASSERT_EQ("b!", get("b"));
+    ASSERT_EQ(2, created);
+    // a is more recently used than b, so b is evicted
+    ASSERT_EQ("a!", get("a"));
+    ASSERT_EQ("c!", get("c"));
+    ASSERT_EQ(2u, cache.GetSize());
+    ASSERT_EQ("a!", get("a"));
+    ASSERT_EQ(3, created);
+    ASSERT_EQ("b!", get("b"));
+    ASSERT_EQ(4, created);
+}
+
+}  // namespace udf
+}  // namespace hybridse
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
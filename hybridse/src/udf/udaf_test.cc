@@ -122,6 +122,27 @@ TEST_F(UdafTest, MedianTest) {
     CheckUdafOneParam<Nullable<double>, Nullable<double>>("median", 3.0, {1.0, 5.0, 2.0, 4.0, 3.0});
 }
 
+TEST_F(UdafTest, PercentileTest) {
+    CheckUdf<double, ListRef<int32_t>, ListRef<double>>("percentile", 3.7, MakeList<int32_t>({4, 1, 3, 2}),
+                                                        MakeList<double>({0.9, 0.9, 0.9, 0.9}));
+    CheckUdf<double, ListRef<int64_t>, ListRef<double>>("percentile", 2.5, MakeList<int64_t>({4, 1, 3, 2}),
+                                                        MakeList<double>({0.5, 0.5, 0.5, 0.5}));
+    CheckUdf<double, ListRef<Nullable<double>>, ListRef<double>>(
+        "percentile", 1, MakeList<Nullable<double>>({4, nullptr, 1, 3, 2}), MakeList<double>({0, 0, 0, 0, 0}));
+    CheckUdf<double, ListRef<float>, ListRef<double>>("percentile", 4, MakeList<float>({4, 1, 3, 2}),
+                                                      MakeList<double>({1, 1, 1, 1}));
+    CheckUdf<double, ListRef<int16_t>, ListRef<double>>("percentile", 5, MakeList<int16_t>({5}),
+                                                        MakeList<double>({0.3}));
+
+    // null values, null or invalid percentage
+    CheckUdf<Nullable<double>, ListRef<Nullable<int32_t>>, ListRef<double>>(
+        "percentile", nullptr, MakeList<Nullable<int32_t>>({nullptr, nullptr}), MakeList<double>({0.5, 0.5}));
+    CheckUdf<Nullable<double>, ListRef<int32_t>, ListRef<Nullable<double>>>(
+        "percentile", nullptr, MakeList<int32_t>({1, 2}), MakeList<Nullable<double>>({nullptr, nullptr}));
+    CheckUdf<Nullable<double>, ListRef<int32_t>, ListRef<double>>("percentile", nullptr, MakeList<int32_t>({1, 2}),
+                                                                  MakeList<double>({1.5, 1.5}));
+}
+
 TEST_F(UdafTest, SumWhereTest) {
     CheckUdf<int32_t, ListRef<int32_t>, ListRef<bool>>(
         "sum_where", 10, MakeList<int32_t>({4, 5, 6}),
@@ -20,6 +20,8 @@
 #include <time.h>
 
 #include <ctime>
+#include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -39,6 +41,7 @@
 #include "node/sql_node.h"
 #include "re2/re2.h"
 #include "udf/literal_traits.h"
+#include "udf/pattern_cache.h"
 #include "udf/udf_library.h"
 #include "vm/jit_runtime.h"
 
@@ -422,82 +425,8 @@ void date_to_string(Date *date, StringRef *output) {
 *     is not <escape character>, <underscore> or <precent>
 *   - empty string or null value means disable escape
 *
-* credit:
-*  Michael Cook, https://github.com/MichaelCook/glob_match/blob/master/glob_match.cpp
-*/
-template <typename EQUAL>
-bool like_internal(std::string_view name, std::string_view pattern, const char *escape, EQUAL &&equal) {
-    auto pattern_it = pattern.cbegin();
-    auto pattern_end = pattern.cend();
-    auto name_it = name.cbegin();
-    auto name_end = name.cend();
-
-    while (pattern_it != pattern_end) {
-        if (name_it == name_end) {
-            break;
-        }
-
-        char c = *pattern_it;
-        if (escape != nullptr && c == *escape) {
-            // exact character match
-            if (std::next(pattern_it) == pattern_end) {
-                // the pattern is terminated with escape character, just return false
-                return false;
-            }
-            c = *std::next(pattern_it);
-            if (!equal(c, *name_it)) {
-                return false;
-            }
-
-            std::advance(pattern_it, 2);
-        } else {
-            switch (c) {
-                case '%': {
-                    std::advance(pattern_it, 1);
-                    auto sub_pattern = std::string_view(pattern_it, std::distance(pattern_it, pattern_end));
-                    for (auto back = name_end; back >= name_it; std::advance(back, -1)) {
-                        if (like_internal(std::string_view(back, std::distance(back, name_end)),
-                                          sub_pattern, escape, std::forward<EQUAL>(equal))) {
-                            return true;
-                        }
-                    }
-                    return false;
-                }
-                case '_': {
-                    break;
-                }
-                default: {
-                    if (!equal(c, *name_it)) {
-                        return false;
-                    }
-                    break;
-                }
-            }
-
-            std::advance(pattern_it, 1);
-        }
-
-        std::advance(name_it, 1);
-    }
-
-    if (pattern_it != pattern_end) {
-        // when pattern iterator do not reach the end
-        // 1. true if there is only special character <percent>s left in pattern
-        // 2. false otherwise
-        for (; pattern_it != pattern_end; std::advance(pattern_it, 1)) {
-            if ((escape != nullptr && *pattern_it == *escape) || *pattern_it != '%') {
-                // character under pattern_it is escape character or is not <percent> character, return false
-                return false;
-            }
-        }
-
-        return true;
-    }
-
-    return name_it == name_end;
-}
-
-/*
+* the compiled patterns are cached per thread, see LikePattern
+*
 * if escape is null or ref to empty string, disable escape feature
 *
 * nullable
@@ -524,7 +453,14 @@ void like_internal(StringRef *name, StringRef *pattern, StringRef *escape, EQUAL
         }
         esc = escape->data_;
     }
-    *out = like_internal(name_view, pattern_view, esc, std::forward<EQUAL>(equal));
+    // the key is the escape character and whether it is enabled, followed by the pattern
+    static thread_local std::string key;
+    key.assign(1, esc == nullptr ? '\0' : *esc);
+    key.push_back(esc == nullptr ? '\0' : '\1');
+    key.append(pattern_view);
+    const auto& like_pattern =
+        PatternCache<LikePattern>::Local().Get(key, [&]() { return LikePattern(pattern_view, esc); });
+    *out = like_pattern.Match(name_view, std::forward<EQUAL>(equal));
 }
 
 void like(StringRef *name, StringRef *pattern, StringRef *escape, bool *out,
@@ -585,40 +521,50 @@ void regexp_like(StringRef *name, StringRef *pattern, StringRef *flags, bool *ou
     std::string_view pattern_view(pattern->data_, pattern->size_);
     std::string_view name_view(name->data_, name->size_);
 
-    RE2::Options opts(RE2::POSIX);
-    opts.set_log_errors(false);
-    opts.set_one_line(true);
-
+    bool case_sensitive = true;
+    bool one_line = true;
+    bool dot_nl = false;
     for (auto &flag : flags_view) {
         switch (flag) {
             case 'c':
-                opts.set_case_sensitive(true);
+                case_sensitive = true;
             break;
             case 'i':
-                opts.set_case_sensitive(false);
+                case_sensitive = false;
             break;
             case 'm':
-                opts.set_one_line(false);
+                one_line = false;
             break;
             case 'e':
                 // ignored here
             break;
             case 's':
-                opts.set_dot_nl(true);
+                dot_nl = true;
             break;
             // ignore unknown flag
         }
     }
 
-    RE2 re(pattern_view, opts);
-    if (re.error_code() != 0) {
-        LOG(ERROR) << "Error parsing '" << pattern_view << "': " << re.error();
+    // the key is the options followed by the pattern, so the same options in any flags share the regex
+    static thread_local std::string key;
+    key.assign(1, static_cast<char>(case_sensitive | one_line << 1 | dot_nl << 2));
+    key.append(pattern_view);
+    const auto &re = PatternCache<std::unique_ptr<RE2>>::Local().Get(key, [&]() {
+        RE2::Options opts(RE2::POSIX);
+        opts.set_log_errors(false);
+        opts.set_case_sensitive(case_sensitive);
+        opts.set_one_line(one_line);
+        opts.set_dot_nl(dot_nl);
+        return std::make_unique<RE2>(pattern_view, opts);
+    });
+    if (re->error_code() != 0) {
+        LOG(ERROR) << "Error parsing '" << pattern_view << "': " << re->error();
         out = nullptr;
         *is_null = true;
         return;
     }
     *is_null = false;
-    *out = RE2::FullMatch(name_view, re);
+    *out = RE2::FullMatch(name_view, *re);
 }
 
 void regexp_like(StringRef *name, StringRef *pattern, bool *out, bool *is_null) {
@@ -26,6 +26,8 @@
 #include "codec/fe_row_codec.h"
 #include "codec/row.h"
 #include "proto/fe_type.pb.h"
+#include "udf/udf.h"
+#include "vm/sketch.h"
 
 namespace hybridse {
 namespace vm {
@@ -368,6 +370,162 @@ class MaxAggregator : public Aggregator<T> {
     }
 };
 
+// SketchAggregator merges the sketches encoded in pre-aggr table,
+// and adds the values out of the buckets to the sketch one by one
+template <class T, class S>
+class SketchAggregator : public Aggregator<T> {
+ public:
+    SketchAggregator(type::Type type, const Schema& output_schema) : Aggregator<T>(type, output_schema, T()) {}
+
+    void Update(const std::string& bval) override {
+        S sketch;
+        if (!sketch.Decode(bval)) {
+            LOG(ERROR) << "encoded aggr val is not valid";
+            return;
+        }
+        sketch_.Merge(sketch);
+        this->counter_++;
+    }
+
+    void Reset() override {
+        Aggregator<T>::Reset();
+        sketch_.Clear();
+    }
+
+ protected:
+    template <class V>
+    Row OutputValue(const V& val, bool is_null) {
+        uint32_t str_len = 0;
+        if constexpr (std::is_same_v<V, std::string>) {
+            str_len = val.size();
+        }
+        uint32_t total_len = this->row_builder_.CalTotalLength(str_len);
+        int8_t* buf = static_cast<int8_t*>(malloc(total_len));
+        this->row_builder_.SetBuffer(buf, total_len);
+        if (is_null) {
+            this->row_builder_.AppendNULL();
+        } else if constexpr (std::is_same_v<V, std::string>) {
+            this->row_builder_.AppendString(val.c_str(), str_len);
+        } else if constexpr (std::is_same_v<V, int64_t>) {
+            this->row_builder_.AppendInt64(val);
+        } else {
+            this->row_builder_.AppendDouble(val);
+        }
+        return Row(base::RefCountedSlice::CreateManaged(buf, total_len));
+    }
+
+    S sketch_;
+};
+
+// approximate distinct_count by HyperLogLog, exact if there are no more than
+// HyperLogLog::kExactLimit distinct values in a bucket
+template <class T>
+class DistinctCountAggregator : public SketchAggregator<T, HyperLogLog> {
+ public:
+    DistinctCountAggregator(type::Type type, const Schema& output_schema)
+        : SketchAggregator<T, HyperLogLog>(type, output_schema) {}
+
+    void UpdateValue(const T& val) override {
+        this->sketch_.Add(val);
+        this->counter_++;
+    }
+
+    Row Output() override {
+        auto row = this->OutputValue(this->sketch_.Estimate(), false);
+        this->Reset();
+        return row;
+    }
+};
+
+// approximate median and percentile by t-digest, exact if a bucket has no more than TDigest::kCompression values.
+// the buckets do not depend on the percentage, it is applied on output
+template <class T>
+class PercentileAggregator : public SketchAggregator<T, TDigest> {
+ public:
+    PercentileAggregator(type::Type type, const Schema& output_schema, double percentage)
+        : SketchAggregator<T, TDigest>(type, output_schema), percentage_(percentage) {}
+
+    void UpdateValue(const T& val) override {
+        if constexpr (std::is_arithmetic_v<T>) {
+            this->sketch_.Add(val);
+        }
+        this->counter_++;
+    }
+
+    Row Output() override {
+        // null if the percentage is out of [0, 1] as the percentile udaf
+        bool is_null = this->sketch_.IsEmpty() || !(percentage_ >= 0 && percentage_ <= 1);
+        auto row = this->OutputValue(is_null ? 0 : this->sketch_.Quantile(percentage_), is_null);
+        this->Reset();
+        return row;
+    }
+
+ private:
+    double percentage_;
+};
+
+// integral values are counted as int64_t and floating values as double
+template <class T>
+using TopNKey = std::conditional_t<std::is_integral_v<T>, int64_t,
+                                   std::conditional_t<std::is_floating_point_v<T>, double, std::string>>;
+
+// approximate topn_frequency by space saving, exact if a bucket has no more than
+// SpaceSaving::kDefaultCapacity distinct keys
+template <class T>
+class TopNFrequencyAggregator : public SketchAggregator<T, SpaceSaving<TopNKey<T>>> {
+ public:
+    // same as the limit of topn_frequency udaf
+    static const int32_t MAXIMUM_TOPN = 1024;
+
+    TopNFrequencyAggregator(type::Type type, const Schema& output_schema, int32_t top_n)
+        : SketchAggregator<T, SpaceSaving<TopNKey<T>>>(type, output_schema),
+          top_n_(std::min(std::max(top_n, 0), MAXIMUM_TOPN)) {}
+
+    void UpdateValue(const T& val) override {
+        this->sketch_.Add(val);
+        this->counter_++;
+    }
+
+    // output the top n keys joined by ',' as topn_frequency udaf, 'NULL' if there are less than n keys
+    Row Output() override {
+        std::string output;
+        auto keys = this->sketch_.TopN(top_n_);
+        for (int32_t i = 0; i < top_n_; i++) {
+            if (i > 0) {
+                output.push_back(',');
+            }
+            if (static_cast<size_t>(i) >= keys.size()) {
+                output.append("NULL");
+                continue;
+            }
+            const auto& key = keys[i].first;
+            if constexpr (std::is_same_v<TopNKey<T>, std::string>) {
+                output.append(key);
+            } else if constexpr (std::is_integral_v<T>) {
+                char buf[32];
+                uint32_t len = 0;
+                if (this->type_ == type::kDate) {
+                    len = udf::v1::format_string(udf::Date(key), buf, sizeof(buf));
+                } else if (this->type_ == type::kTimestamp) {
+                    len = udf::v1::format_string(udf::Timestamp(key), buf, sizeof(buf));
+                } else {
+                    len = udf::v1::format_string(key, buf, sizeof(buf));
+                }
+                output.append(buf, std::min<uint32_t>(len, sizeof(buf) - 1));
+            } else {
+                // same as the "%f" format of the udaf
+                output.append(std::to_string(key));
+            }
+        }
+        auto row = this->OutputValue(output, false);
+        this->Reset();
+        return row;
+    }
+
+ private:
+    int32_t top_n_;
+};
+
 template <template<class> class AggregatorClass>
 std::unique_ptr<BaseAggregator> MakeOverflowAggregator(type::Type agg_col_type, const Schema& output_schema) {
     switch (agg_col_type) {
@@ -391,26 +549,28 @@ std::unique_ptr<BaseAggregator> MakeOverflowAggregator(type::Type agg_col_type,
     }
 }
 
-template <template<class> class AggregatorClass>
-std::unique_ptr<BaseAggregator> MakeSameTypeAggregator(type::Type agg_col_type, const Schema& output_schema) {
+// args are passed to the constructor after agg_col_type and output_schema
+template <template<class> class AggregatorClass, class... Args>
+std::unique_ptr<BaseAggregator> MakeSameTypeAggregator(type::Type agg_col_type, const Schema& output_schema,
+                                                       Args... args) {
     switch (agg_col_type) {
         case type::kInt16:
-            return std::make_unique<AggregatorClass<int16_t>>(agg_col_type, output_schema);
+            return std::make_unique<AggregatorClass<int16_t>>(agg_col_type, output_schema, args...);
         case type::kInt32:
         case type::kDate:
-            return std::make_unique<AggregatorClass<int32_t>>(agg_col_type, output_schema);
+            return std::make_unique<AggregatorClass<int32_t>>(agg_col_type, output_schema, args...);
         case type::kTimestamp:
         case type::kInt64: {
-            return std::make_unique<AggregatorClass<int64_t>>(agg_col_type, output_schema);
+            return std::make_unique<AggregatorClass<int64_t>>(agg_col_type, output_schema, args...);
         }
         case type::kFloat: {
-            return std::make_unique<AggregatorClass<float>>(agg_col_type, output_schema);
+            return std::make_unique<AggregatorClass<float>>(agg_col_type, output_schema, args...);
         }
         case type::kDouble: {
-            return std::make_unique<AggregatorClass<double>>(agg_col_type, output_schema);
+            return std::make_unique<AggregatorClass<double>>(agg_col_type, output_schema, args...);
         }
         case type::kVarchar: {
-            return std::make_unique<AggregatorClass<std::string>>(agg_col_type, output_schema);
+            return std::make_unique<AggregatorClass<std::string>>(agg_col_type, output_schema, args...);
         }
         default:
             LOG(ERROR) << "Not support for type " << Type_Name(agg_col_type);
@@ -17,6 +17,7 @@
 #ifndef HYBRIDSE_SRC_VM_CATALOG_WRAPPER_H_
 #define HYBRIDSE_SRC_VM_CATALOG_WRAPPER_H_
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <string>
@@ -57,44 +58,103 @@ class IteratorProjectWrapper : public RowIterator {
     Row value_;
 };
 
+// iterator over the rows of `iter` meet the predicate. The rows are read ahead and
+// evaluated in batches of up to `PredicateFun::GetBatchSize()` rows, the batch starts
+// from one row after every seek and doubles, so that reading only the first rows,
+// e.g. with a LIMIT, does not evaluate a full batch. Nothing is read until the first
+// seek or access, creating the iterator evaluates no row.
+//
+// The batch is still a batch of rows, the compiled predicate is called once per row.
+// Columnar evaluation is out of scope, it needs a columnar row layout and codegen.
 class IteratorFilterWrapper : public RowIterator {
  public:
     IteratorFilterWrapper(std::unique_ptr<RowIterator>&& iter, const Row& parameter, const PredicateFun* fun)
-        : RowIterator(), iter_(std::move(iter)), parameter_(parameter), predicate_(fun) {}
+        : RowIterator(),
+          iter_(std::move(iter)),
+          parameter_(parameter),
+          predicate_(fun),
+          max_fetch_size_(std::max(1u, fun->GetBatchSize())) {}
 
     virtual ~IteratorFilterWrapper() {}
 
     bool Valid() const override {
-        return iter_->Valid() && predicate_->operator()(iter_->GetValue(), parameter_);
+        FillFirst();
+        return pos_ < rows_.size();
     }
     void Next() override {
-        iter_->Next();
-        while (iter_->Valid() && !predicate_->operator()(iter_->GetValue(), parameter_)) {
-            iter_->Next();
+        FillFirst();
+        pos_++;
+        if (pos_ >= rows_.size()) {
+            Fill(fetch_size_);
         }
     }
-    const uint64_t& GetKey() const override { return iter_->GetKey(); }
+    const uint64_t& GetKey() const override {
+        FillFirst();
+        return keys_[pos_];
+    }
     const Row& GetValue() override {
-        value_ = iter_->GetValue();
-        return value_;
+        FillFirst();
+        return rows_[pos_];
     }
     void Seek(const uint64_t& k) override {
         iter_->Seek(k);
-        while (iter_->Valid() && !predicate_->operator()(iter_->GetValue(), parameter_)) {
-            iter_->Next();
-        }
+        Fill(1);
     }
     void SeekToFirst() override {
         iter_->SeekToFirst();
-        while (iter_->Valid() && !predicate_->operator()(iter_->GetValue(), parameter_)) {
-            iter_->Next();
-        }
+        Fill(1);
     }
     bool IsSeekable() const override { return iter_->IsSeekable(); }
+
+ private:
+    // callers may iterate without a seek, then the first batch starts where `iter_` is
+    void FillFirst() const {
+        if (!filled_) {
+            Fill(1);
+        }
+    }
+
+    // read `fetch_size` rows of `iter_`, doubling for the next read, until some of them meet the
+    // predicate or `iter_` ends
+    void Fill(uint32_t fetch_size) const {
+        filled_ = true;
+        fetch_size_ = fetch_size;
+        pos_ = 0;
+        rows_.clear();
+        keys_.clear();
+        while (rows_.empty() && iter_->Valid()) {
+            candidates_.clear();
+            candidate_keys_.clear();
+            while (iter_->Valid() && candidates_.size() < fetch_size_) {
+                candidate_keys_.push_back(iter_->GetKey());
+                candidates_.push_back(iter_->GetValue());
+                iter_->Next();
+            }
+            predicate_->Select(candidates_, parameter_, &selected_);
+            for (size_t i = 0; i < candidates_.size(); i++) {
+                if (selected_[i]) {
+                    keys_.push_back(candidate_keys_[i]);
+                    rows_.push_back(candidates_[i]);
+                }
+            }
+            fetch_size_ = std::min(fetch_size_ * 2, max_fetch_size_);
+        }
+    }
+
     std::unique_ptr<RowIterator> iter_;
     const Row& parameter_;
     const PredicateFun* predicate_;
-    Row value_;
+    const uint32_t max_fetch_size_;
+    // the read-ahead state, mutable as the const accessors read the first batch
+    mutable bool filled_ = false;
+    mutable uint32_t fetch_size_ = 1;
+    mutable size_t pos_ = 0;
+    // the selected rows of the current batch
+    mutable std::vector<uint64_t> keys_;
+    mutable std::vector<Row> rows_;
+    mutable std::vector<uint64_t> candidate_keys_;
+    mutable std::vector<Row> candidates_;
+    mutable std::vector<bool> selected_;
 };
 
 // iterator start from `iter` but limit rows count
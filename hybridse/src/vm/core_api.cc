@@ -245,6 +245,38 @@ hybridse::codec::Row CoreAPI::RowProject(const RawPtrHandle fn,
         buf, hybridse::codec::RowView::GetSize(buf)));
 }
 
+void CoreAPI::RowProjectBatch(const RawPtrHandle fn,
+                              const std::vector<hybridse::codec::Row>& rows,
+                              const hybridse::codec::Row& parameter,
+                              std::vector<hybridse::codec::Row>* outputs) {
+    auto udf = reinterpret_cast<int32_t (*)(const int64_t, const int8_t*,
+                                            const int8_t*, const int8_t*, int8_t**)>(
+        const_cast<int8_t*>(fn));
+    auto parameter_ptr = reinterpret_cast<const int8_t*>(&parameter);
+    outputs->reserve(outputs->size() + rows.size());
+
+    // the memory allocated by the run step is kept until the whole batch is
+    // projected, so the batch size bounds it
+    JitRuntime::get()->InitRunStep();
+    for (const auto& row : rows) {
+        if (row.empty()) {
+            outputs->emplace_back();
+            continue;
+        }
+        int8_t* buf = nullptr;
+        uint32_t ret = udf(0, reinterpret_cast<const int8_t*>(&row), nullptr,
+                           parameter_ptr, &buf);
+        if (ret != 0) {
+            LOG(WARNING) << "fail to run udf " << ret;
+            outputs->emplace_back();
+            continue;
+        }
+        outputs->emplace_back(base::RefCountedSlice::CreateManaged(
+            buf, hybridse::codec::RowView::GetSize(buf)));
+    }
+    JitRuntime::get()->ReleaseRunStep();
+}
+
 hybridse::codec::Row CoreAPI::UnsafeRowProject(
     const hybridse::vm::RawPtrHandle fn,
     hybridse::vm::ByteArrayPtr inputUnsafeRowBytes,
@@ -389,6 +421,38 @@ bool CoreAPI::ComputeCondition(const hybridse::vm::RawPtrHandle fn,
                                  row_view->GetSchema()->Get(out_idx).type());
 }
 
+void CoreAPI::ComputeConditionBatch(const hybridse::vm::RawPtrHandle fn,
+                                    const std::vector<Row>& rows,
+                                    const Row& parameter,
+                                    const hybridse::codec::RowView* row_view,
+                                    size_t out_idx,
+                                    std::vector<bool>* selected) {
+    auto udf = reinterpret_cast<int32_t (*)(const int64_t, const int8_t*,
+                                            const int8_t*, const int8_t*, int8_t**)>(
+        const_cast<int8_t*>(fn));
+    auto parameter_ptr = reinterpret_cast<const int8_t*>(&parameter);
+    auto type = row_view->GetSchema()->Get(out_idx).type();
+    selected->assign(rows.size(), false);
+
+    JitRuntime::get()->InitRunStep();
+    for (size_t i = 0; i < rows.size(); i++) {
+        if (rows[i].empty()) {
+            continue;
+        }
+        int8_t* buf = nullptr;
+        uint32_t ret = udf(0, reinterpret_cast<const int8_t*>(&rows[i]), nullptr,
+                           parameter_ptr, &buf);
+        if (ret != 0) {
+            LOG(WARNING) << "fail to run udf " << ret;
+            continue;
+        }
+        // the condition row is only read here, free it without wrapping into a Row
+        (*selected)[i] = Runner::GetColumnBool(buf, row_view, out_idx, type);
+        free(buf);
+    }
+    JitRuntime::get()->ReleaseRunStep();
+}
+
 hybridse::codec::Row CoreAPI::NewRow(size_t bytes) {
     auto buf = reinterpret_cast<int8_t*>(malloc(bytes));
     if (buf == nullptr) {
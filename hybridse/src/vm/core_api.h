@@ -19,6 +19,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include "codec/fe_row_codec.h"
 #include "codec/row.h"
 #include "vm/catalog.h"
@@ -135,6 +136,13 @@ class CoreAPI {
                                            const hybridse::codec::Row& row,
                                            const hybridse::codec::Row& parameter,
                                            const bool need_free = false);
+    // Project `rows` in a single run step and append the results to `outputs`,
+    // an empty row is appended for the row failed to project. `fn` is called
+    // once per row, only the run step is shared
+    static void RowProjectBatch(const hybridse::vm::RawPtrHandle fn,
+                                const std::vector<hybridse::codec::Row>& rows,
+                                const hybridse::codec::Row& parameter,
+                                std::vector<hybridse::codec::Row>* outputs);
     static hybridse::codec::Row RowConstProject(
         const hybridse::vm::RawPtrHandle fn, const hybridse::codec::Row parameter,
         const bool need_free = false);
@@ -195,6 +203,16 @@ class CoreAPI {
                                  const hybridse::codec::RowView* row_view,
                                  size_t out_idx);
 
+    // Compute the condition of `rows` in a single run step, `selected` is
+    // resized to the rows and set for the rows meet the condition. `fn` is
+    // called once per row, only the run step is shared
+    static void ComputeConditionBatch(const hybridse::vm::RawPtrHandle fn,
+                                      const std::vector<Row>& rows,
+                                      const Row& parameter,
+                                      const hybridse::codec::RowView* row_view,
+                                      size_t out_idx,
+                                      std::vector<bool>* selected);
+
     static bool EnableSignalTraceback();
 };
 
@@ -50,7 +50,9 @@ EngineOptions::EngineOptions()
       enable_expr_optimize_(true),
       enable_batch_window_parallelization_(false),
       enable_window_column_pruning_(false),
-      max_sql_cache_size_(50) {
+      max_sql_cache_size_(50),
+      window_agg_cache_size_(0),
+      exec_batch_size_(1024) {
 }
 
 static absl::Status ExtractRows(const node::ExprNode* expr, const codec::Schema* sc, std::vector<codec::Row>* out)
@@ -170,6 +172,8 @@ bool Engine::Get(const std::string& sql, const std::string& db, RunSession& sess
     sql_context.enable_batch_window_parallelization = options_.IsEnableBatchWindowParallelization();
     sql_context.enable_window_column_pruning = options_.IsEnableWindowColumnPruning();
     sql_context.enable_expr_optimize = options_.IsEnableExprOptimize();
+    sql_context.window_agg_cache_size = options_.GetWindowAggCacheSize();
+    sql_context.exec_batch_size = options_.GetExecBatchSize();
     sql_context.jit_options = options_.jit_options();
     sql_context.options = session.GetOptions();
     sql_context.index_hints = session.index_hints_;
@@ -656,6 +656,10 @@ const int64_t OrderGenerator::Gen(const Row& row) {
 const bool ConditionGenerator::Gen(const Row& row, const Row& parameter) const {
     return CoreAPI::ComputeCondition(fn_, row, parameter, &row_view_, idxs_[0]);
 }
+void ConditionGenerator::Gen(const std::vector<Row>& rows, const Row& parameter,
+                             std::vector<bool>* selected) const {
+    CoreAPI::ComputeConditionBatch(fn_, rows, parameter, &row_view_, idxs_[0], selected);
+}
 const bool ConditionGenerator::Gen(std::shared_ptr<TableHandler> table, const codec::Row& parameter) {
     Row cond_row = Runner::GroupbyProject(fn_, parameter, table.get());
     return Runner::GetColumnBool(cond_row.buf(), &row_view_, idxs_[0],
@@ -664,6 +668,9 @@ const bool ConditionGenerator::Gen(std::shared_ptr<TableHandler> table, const co
 const Row ProjectGenerator::Gen(const Row& row, const Row& parameter) {
     return CoreAPI::RowProject(fn_, row, parameter, false);
 }
+void ProjectGenerator::Gen(const std::vector<Row>& rows, const Row& parameter, std::vector<Row>* outputs) {
+    CoreAPI::RowProjectBatch(fn_, rows, parameter, outputs);
+}
 
 const Row ConstProjectGenerator::Gen(const Row& parameter) {
     return CoreAPI::RowConstProject(fn_, parameter, false);
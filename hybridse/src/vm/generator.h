@@ -19,6 +19,7 @@
 #ifndef HYBRIDSE_SRC_VM_GENERATOR_H_
 #define HYBRIDSE_SRC_VM_GENERATOR_H_
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
@@ -40,6 +41,15 @@ class ProjectFun {
 class PredicateFun {
  public:
     virtual bool operator()(const Row& row, const Row& parameter) const = 0;
+    // evaluate the predicate of `rows` at once, `selected` is resized to the rows
+    virtual void Select(const std::vector<Row>& rows, const Row& parameter, std::vector<bool>* selected) const {
+        selected->resize(rows.size());
+        for (size_t i = 0; i < rows.size(); i++) {
+            (*selected)[i] = operator()(rows[i], parameter);
+        }
+    }
+    // the max rows a filter iterator reads ahead and passes to `Select`
+    virtual uint32_t GetBatchSize() const { return 1; }
 };
 
 class FnGenerator {
@@ -73,6 +83,7 @@ class ProjectGenerator : public FnGenerator {
     explicit ProjectGenerator(const FnInfo& info) : FnGenerator(info), fun_(info.fn_ptr()) {}
     virtual ~ProjectGenerator() {}
     const Row Gen(const Row& row, const Row& parameter);
+    void Gen(const std::vector<Row>& rows, const Row& parameter, std::vector<Row>* outputs);
     RowProjectFun fun_;
 };
 
@@ -120,6 +131,7 @@ class ConditionGenerator : public FnGenerator {
     explicit ConditionGenerator(const FnInfo& info) : FnGenerator(info) {}
     virtual ~ConditionGenerator() {}
     const bool Gen(const Row& row, const Row& parameter) const;
+    void Gen(const std::vector<Row>& rows, const Row& parameter, std::vector<bool>* selected) const;
     const bool Gen(std::shared_ptr<TableHandler> table, const codec::Row& parameter_row);
 };
 class RangeGenerator : public std::enable_shared_from_this<RangeGenerator> {
@@ -245,9 +257,21 @@ class FilterGenerator : public PredicateFun {
         return condition_gen_.Gen(row, parameter);
     }
 
+    void Select(const std::vector<Row>& rows, const Row& parameter, std::vector<bool>* selected) const override {
+        if (!condition_gen_.Valid()) {
+            selected->assign(rows.size(), true);
+            return;
+        }
+        condition_gen_.Gen(rows, parameter, selected);
+    }
+
+    void SetBatchSize(uint32_t batch_size) { batch_size_ = std::max(1u, batch_size); }
+    uint32_t GetBatchSize() const override { return batch_size_; }
+
  private:
     ConditionGenerator condition_gen_;
     IndexSeekGenerator index_seek_gen_;
+    uint32_t batch_size_ = 1;
 };
 class WindowGenerator {
  public:
@@ -190,6 +190,20 @@ bool HybridSeLlvmJitWrapper::Init() {
         //         return ObjLinkingLayer;
         //     });
     }
+    if (!jit_options_.GetObjectCacheDir().empty()) {
+        object_cache_ = JitObjectCache::Get(jit_options_.GetObjectCacheDir(), jit_options_.GetObjectCacheMaxSize());
+        auto cache = object_cache_.get();
+        // the same compiler as the default one of LLJIT, with the object cache
+        builder.setCompileFunctionCreator([cache](::llvm::orc::JITTargetMachineBuilder jtmb)
+                                              -> ::llvm::Expected<::llvm::orc::IRCompileLayer::CompileFunction> {
+            auto tm = jtmb.createTargetMachine();
+            if (!tm) {
+                return tm.takeError();
+            }
+            return ::llvm::orc::IRCompileLayer::CompileFunction(
+                ::llvm::orc::TMOwningSimpleCompiler(std::move(*tm), cache));
+        });
+    }
     auto jit = builder.create();
     {
         ::llvm::Error e = jit.takeError();
@@ -235,6 +249,17 @@ bool HybridSeLlvmJitWrapper::AddModule(
     return true;
 }
 
+bool HybridSeLlvmJitWrapper::AddObject(std::unique_ptr<llvm::MemoryBuffer> object) {
+    EnsureInitialized();
+
+    ::llvm::Error e = jit_->addObjectFile(std::move(object));
+    if (e) {
+        LOG(WARNING) << "fail to add object: " << LlvmToString(e);
+        return false;
+    }
+    return true;
+}
+
 RawPtrHandle HybridSeLlvmJitWrapper::FindFunction(const std::string& funcname) {
     if (funcname == "") {
         return 0;
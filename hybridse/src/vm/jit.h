@@ -20,6 +20,7 @@
 #include <memory>
 #include <string>
 #include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "vm/jit_object_cache.h"
 #include "vm/jit_wrapper.h"
 
 #ifdef LLVM_EXT_ENABLE
@@ -94,6 +95,10 @@ class HybridSeLlvmJitWrapper : public HybridSeJitWrapper {
 
     bool AddModule(std::unique_ptr<llvm::Module> module, std::unique_ptr<llvm::LLVMContext> llvm_ctx) override;
 
+    bool AddObject(std::unique_ptr<llvm::MemoryBuffer> object) override;
+
+    JitObjectCache* GetObjectCache() const override { return object_cache_.get(); }
+
     bool AddExternalFunction(const std::string& name, void* addr) override;
 
     hybridse::vm::RawPtrHandle FindFunction(const std::string& funcname) override;
@@ -102,6 +107,7 @@ class HybridSeLlvmJitWrapper : public HybridSeJitWrapper {
     const JitOptions jit_options_;
     std::unique_ptr<HybridSeJit> jit_;
     std::unique_ptr<::llvm::orc::MangleAndInterner> mi_;
+    std::shared_ptr<JitObjectCache> object_cache_;
 };
 
 #ifdef LLVM_EXT_ENABLE
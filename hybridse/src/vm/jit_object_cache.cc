@@ -0,0 +1,265 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/jit_object_cache.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "base/fe_hash.h"
+#include "boost/filesystem.hpp"
+#include "glog/logging.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace hybridse {
+namespace vm {
+
+namespace {
+constexpr char kKeyPrefix[] = "jit-";
+constexpr char kObjectSuffix[] = ".o";
+constexpr char kMagic[4] = {'H', 'S', 'J', 'O'};
+constexpr uint32_t kHashSeed1 = 0xe17a1465;
+constexpr uint32_t kHashSeed2 = 0x5bd1e995;
+
+// magic, format version, object size, object checksum
+constexpr size_t kHeaderSize = sizeof(kMagic) + sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint64_t);
+
+uint64_t Checksum(const char* data, size_t size) { return base::MurmurHash64A(data, size, kHashSeed1); }
+
+template <class T>
+void AppendFixed(T val, std::string* output) {
+    output->append(reinterpret_cast<const char*>(&val), sizeof(T));
+}
+}  // namespace
+
+JitObjectCache::JitObjectCache(const std::string& dir, uint64_t max_size) : dir_(dir), max_size_(max_size) {
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(dir_, ec);
+    if (ec) {
+        LOG(WARNING) << "fail to create jit object cache dir " << dir_ << ": " << ec.message();
+    }
+    LoadIndex();
+}
+
+void JitObjectCache::LoadIndex() {
+    // the modification time, the key and the size of the objects
+    std::vector<std::tuple<std::time_t, std::string, uint64_t>> objects;
+    boost::system::error_code ec;
+    for (boost::filesystem::directory_iterator it(dir_, ec), end; !ec && it != end; it.increment(ec)) {
+        auto& path = it->path();
+        auto key = path.stem().string();
+        if (path.extension() != kObjectSuffix || !IsKey(key)) {
+            continue;
+        }
+        boost::system::error_code file_ec;
+        uint64_t size = boost::filesystem::file_size(path, file_ec);
+        std::time_t time = boost::filesystem::last_write_time(path, file_ec);
+        if (file_ec) {
+            continue;
+        }
+        objects.emplace_back(time, key, size);
+    }
+    std::sort(objects.begin(), objects.end());
+    std::lock_guard<std::mutex> lock(mu_);
+    for (const auto& object : objects) {
+        Touch(std::get<1>(object), std::get<2>(object));
+    }
+    // the max size may be smaller than the one of the last run
+    Evict();
+    LOG(INFO) << "load " << entries_.size() << " jit objects of " << total_size_ << " bytes from " << dir_;
+}
+
+std::shared_ptr<JitObjectCache> JitObjectCache::Get(const std::string& dir, uint64_t max_size) {
+    static std::mutex mu;
+    static std::map<std::string, std::shared_ptr<JitObjectCache>> caches;
+    std::lock_guard<std::mutex> lock(mu);
+    auto& cache = caches[dir];
+    if (!cache) {
+        cache = std::make_shared<JitObjectCache>(dir, max_size);
+    }
+    return cache;
+}
+
+std::string JitObjectCache::GetKey(const ::llvm::Module& module) {
+    std::string content;
+    ::llvm::raw_string_ostream os(content);
+    os << LLVM_VERSION_STRING << '\n'
+       << ::llvm::sys::getProcessTriple() << '\n'
+       << ::llvm::sys::getHostCPUName() << '\n'
+       << kFormatVersion << '\n';
+    module.print(os, nullptr);
+    os.flush();
+    return absl::StrFormat("%s%016x%016x", kKeyPrefix, base::MurmurHash64A(content.data(), content.size(), kHashSeed1),
+                           base::MurmurHash64A(content.data(), content.size(), kHashSeed2));
+}
+
+bool JitObjectCache::IsKey(const std::string& str) {
+    return str.size() == sizeof(kKeyPrefix) - 1 + 32 && str.compare(0, sizeof(kKeyPrefix) - 1, kKeyPrefix) == 0;
+}
+
+std::string JitObjectCache::GetPath(const std::string& key) const {
+    return absl::StrCat(dir_, "/", key, kObjectSuffix);
+}
+
+std::unique_ptr<::llvm::MemoryBuffer> JitObjectCache::Lookup(const std::string& key) {
+    auto path = GetPath(key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        // it may be evicted by another process sharing the directory
+        std::lock_guard<std::mutex> lock(mu_);
+        RemoveEntry(key);
+        return nullptr;
+    }
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    uint32_t version = 0;
+    uint64_t size = 0;
+    uint64_t checksum = 0;
+    if (data.size() >= kHeaderSize) {
+        const char* ptr = data.data() + sizeof(kMagic);
+        memcpy(&version, ptr, sizeof(version));
+        ptr += sizeof(version);
+        memcpy(&size, ptr, sizeof(size));
+        ptr += sizeof(size);
+        memcpy(&checksum, ptr, sizeof(checksum));
+    }
+    if (data.size() < kHeaderSize || memcmp(data.data(), kMagic, sizeof(kMagic)) != 0 || version != kFormatVersion ||
+        size != data.size() - kHeaderSize || checksum != Checksum(data.data() + kHeaderSize, size)) {
+        LOG(WARNING) << "remove broken jit object " << path;
+        Erase(key);
+        return nullptr;
+    }
+    // refresh the modification time as the access time for the index built on restart
+    boost::system::error_code ec;
+    boost::filesystem::last_write_time(path, std::time(nullptr), ec);
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        Touch(key, data.size());
+    }
+    DLOG(INFO) << "load jit object " << path;
+    return ::llvm::MemoryBuffer::getMemBufferCopy(::llvm::StringRef(data.data() + kHeaderSize, size), key);
+}
+
+bool JitObjectCache::Store(const std::string& key, ::llvm::StringRef object) {
+    static std::atomic<uint64_t> tmp_id(0);
+    std::string header;
+    header.append(kMagic, sizeof(kMagic));
+    AppendFixed(kFormatVersion, &header);
+    AppendFixed(static_cast<uint64_t>(object.size()), &header);
+    AppendFixed(Checksum(object.data(), object.size()), &header);
+
+    // write a temporary file then rename it, so that the processes sharing the directory never
+    // read a partial object
+    auto path = GetPath(key);
+    auto tmp_path = absl::StrCat(path, ".tmp.", getpid(), ".", tmp_id.fetch_add(1));
+    {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+        file.write(header.data(), header.size());
+        file.write(object.data(), object.size());
+        if (!file) {
+            LOG(WARNING) << "fail to write jit object " << tmp_path;
+            file.close();
+            boost::system::error_code ec;
+            boost::filesystem::remove(tmp_path, ec);
+            return false;
+        }
+    }
+    boost::system::error_code ec;
+    boost::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        LOG(WARNING) << "fail to rename jit object " << tmp_path << ": " << ec.message();
+        boost::filesystem::remove(tmp_path, ec);
+        return false;
+    }
+    DLOG(INFO) << "store jit object " << path;
+    std::lock_guard<std::mutex> lock(mu_);
+    Touch(key, header.size() + object.size());
+    Evict();
+    return true;
+}
+
+void JitObjectCache::Erase(const std::string& key) {
+    boost::system::error_code ec;
+    boost::filesystem::remove(GetPath(key), ec);
+    std::lock_guard<std::mutex> lock(mu_);
+    RemoveEntry(key);
+}
+
+void JitObjectCache::Touch(const std::string& key, uint64_t size) {
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        lru_.push_front(key);
+        entries_.emplace(key, Entry{size, lru_.begin()});
+    } else {
+        lru_.splice(lru_.begin(), lru_, it->second.pos);
+        total_size_ -= it->second.size;
+        it->second.size = size;
+    }
+    total_size_ += size;
+}
+
+void JitObjectCache::RemoveEntry(const std::string& key) {
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        total_size_ -= it->second.size;
+        lru_.erase(it->second.pos);
+        entries_.erase(it);
+    }
+}
+
+void JitObjectCache::Evict() {
+    if (total_size_ <= max_size_) {
+        return;
+    }
+    uint64_t target = max_size_ / 10 * 9;
+    boost::system::error_code ec;
+    while (total_size_ > target && !lru_.empty()) {
+        auto key = lru_.back();
+        boost::filesystem::remove(GetPath(key), ec);
+        RemoveEntry(key);
+    }
+}
+
+void JitObjectCache::notifyObjectCompiled(const ::llvm::Module* module, ::llvm::MemoryBufferRef object) {
+    const auto& key = module->getModuleIdentifier();
+    if (IsKey(key)) {
+        Store(key, object.getBuffer());
+    }
+}
+
+std::unique_ptr<::llvm::MemoryBuffer> JitObjectCache::getObject(const ::llvm::Module* module) {
+    const auto& key = module->getModuleIdentifier();
+    if (!IsKey(key)) {
+        return nullptr;
+    }
+    return Lookup(key);
+}
+
+}  // namespace vm
+}  // namespace hybridse
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_SRC_VM_JIT_OBJECT_CACHE_H_
+#define HYBRIDSE_SRC_VM_JIT_OBJECT_CACHE_H_
+
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+namespace hybridse {
+namespace vm {
+
+// JitObjectCache keeps the object files compiled by the JIT in a directory, so that a module
+// compiled before, e.g. a deployment compiled before the tablet restarts, is loaded instead of
+// optimized and compiled again.
+//
+// The objects are addressed by the hash of the module IR before optimization, together with
+// the LLVM version, the host target and the cache format version. A different sql, schema,
+// codegen or LLVM build produces a different key, so a stale object is never loaded. The
+// files are checksummed, a broken one is removed on lookup.
+//
+// The size and the recency of the objects are indexed in memory. The index is built from the
+// directory once on construction, ordered by the modification time, so a store does not scan
+// the directory. The objects stored by other processes sharing the directory join the index
+// when they are looked up.
+class JitObjectCache : public ::llvm::ObjectCache {
+ public:
+    // bump it if the codegen changes without changing the IR, e.g. the ABI of a builtin function
+    static constexpr uint32_t kFormatVersion = 1;
+
+    JitObjectCache(const std::string& dir, uint64_t max_size);
+    ~JitObjectCache() override {}
+
+    // the cache shared by all jits with the same directory in the process
+    static std::shared_ptr<JitObjectCache> Get(const std::string& dir, uint64_t max_size);
+
+    // the key of the module, it must be computed before the module is optimized
+    static std::string GetKey(const ::llvm::Module& module);
+    static bool IsKey(const std::string& str);
+
+    // return nullptr if the object is missing or broken
+    std::unique_ptr<::llvm::MemoryBuffer> Lookup(const std::string& key);
+    bool Store(const std::string& key, ::llvm::StringRef object);
+    void Erase(const std::string& key);
+
+    // the compiler sets the module identifier to the key, modules with other identifiers are not cached
+    void notifyObjectCompiled(const ::llvm::Module* module, ::llvm::MemoryBufferRef object) override;
+    std::unique_ptr<::llvm::MemoryBuffer> getObject(const ::llvm::Module* module) override;
+
+    const std::string& GetDir() const { return dir_; }
+
+ private:
+    struct Entry {
+        uint64_t size;
+        std::list<std::string>::iterator pos;
+    };
+
+    std::string GetPath(const std::string& key) const;
+    void LoadIndex();
+    // mark the object as the most recently used one, it is added to the index if absent
+    void Touch(const std::string& key, uint64_t size);
+    void RemoveEntry(const std::string& key);
+    // remove the least recently used objects until the total size is under 90% of max_size_
+    void Evict();
+
+    const std::string dir_;
+    const uint64_t max_size_;
+    std::mutex mu_;
+    // the keys from the most recently used to the least one
+    std::list<std::string> lru_;
+    std::unordered_map<std::string, Entry> entries_;
+    uint64_t total_size_ = 0;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+#endif  // HYBRIDSE_SRC_VM_JIT_OBJECT_CACHE_H_
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/jit_object_cache.h"
+
+#include <fstream>
+#include <string>
+
+#include "boost/filesystem.hpp"
+#include "codec/fe_row_codec.h"
+#include "gtest/gtest.h"
+#include "vm/engine.h"
+#include "vm/simple_catalog.h"
+
+namespace hybridse {
+namespace vm {
+
+class JitObjectCacheTest : public ::testing::Test {
+ public:
+    void SetUp() override {
+        dir_ = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+    }
+    void TearDown() override { boost::filesystem::remove_all(dir_); }
+
+    size_t CountObjects() {
+        size_t cnt = 0;
+        for (boost::filesystem::directory_iterator it(dir_), end; it != end; ++it) {
+            if (it->path().extension() == ".o") {
+                cnt++;
+            }
+        }
+        return cnt;
+    }
+
+ protected:
+    std::string dir_;
+};
+
+TEST_F(JitObjectCacheTest, StoreAndLookup) {
+    JitObjectCache cache(dir_, 1024);
+    std::string key1 = "jit-0123456789abcdef0123456789abcdef";
+    std::string key2 = "jit-fedcba9876543210fedcba9876543210";
+    ASSERT_TRUE(JitObjectCache::IsKey(key1));
+    ASSERT_FALSE(JitObjectCache::IsKey("sql"));
+    ASSERT_FALSE(cache.Lookup(key1));
+
+    ASSERT_TRUE(cache.Store(key1, std::string(100, 'a')));
+    auto object = cache.Lookup(key1);
+    ASSERT_TRUE(object);
+    ASSERT_EQ(std::string(100, 'a'), object->getBuffer().str());
+
+    // a broken object is removed
+    {
+        std::fstream file(dir_ + "/" + key1 + ".o", std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(-1, std::ios::end);
+        file.put('b');
+    }
+    ASSERT_FALSE(cache.Lookup(key1));
+    ASSERT_EQ(0u, CountObjects());
+
+    // the least recently used object is evicted
+    ASSERT_TRUE(cache.Store(key1, std::string(500, 'a')));
+    boost::filesystem::last_write_time(dir_ + "/" + key1 + ".o", std::time(nullptr) - 100);
+    ASSERT_TRUE(cache.Store(key2, std::string(500, 'b')));
+    ASSERT_FALSE(cache.Lookup(key1));
+    ASSERT_TRUE(cache.Lookup(key2));
+}
+
+TEST_F(JitObjectCacheTest, LoadIndex) {
+    std::string key1 = "jit-00000000000000000000000000000001";
+    std::string key2 = "jit-00000000000000000000000000000002";
+    std::string key3 = "jit-00000000000000000000000000000003";
+    std::string key4 = "jit-00000000000000000000000000000004";
+    {
+        JitObjectCache cache(dir_, 2048);
+        ASSERT_TRUE(cache.Store(key1, std::string(400, 'a')));
+        ASSERT_TRUE(cache.Store(key2, std::string(400, 'b')));
+        ASSERT_TRUE(cache.Store(key3, std::string(400, 'c')));
+    }
+    boost::filesystem::last_write_time(dir_ + "/" + key2 + ".o", std::time(nullptr) - 200);
+    boost::filesystem::last_write_time(dir_ + "/" + key1 + ".o", std::time(nullptr) - 100);
+
+    // a restarted cache orders the objects by the modification time and evicts the oldest one over the max size
+    JitObjectCache cache(dir_, 1024);
+    ASSERT_EQ(2u, CountObjects());
+    ASSERT_FALSE(cache.Lookup(key2));
+    ASSERT_TRUE(cache.Lookup(key3));
+    ASSERT_TRUE(cache.Lookup(key1));
+
+    // the lookup makes key1 the most recently used one
+    ASSERT_TRUE(cache.Store(key4, std::string(400, 'd')));
+    ASSERT_EQ(2u, CountObjects());
+    ASSERT_FALSE(cache.Lookup(key3));
+    ASSERT_TRUE(cache.Lookup(key1));
+    ASSERT_TRUE(cache.Lookup(key4));
+}
+
+TEST_F(JitObjectCacheTest, CompileWithCache) {
+    hybridse::type::Database db;
+    db.set_name("db");
+    auto table = db.add_tables();
+    table->set_name("t1");
+    table->set_catalog("db");
+    auto column = table->add_columns();
+    column->set_type(::hybridse::type::kInt64);
+    column->set_name("col_1");
+    auto catalog = std::make_shared<SimpleCatalog>();
+    catalog->AddDatabase(db);
+
+    EngineOptions options;
+    options.jit_options().SetObjectCacheDir(dir_);
+    auto run = [&]() {
+        // a new engine compiles the sql again as a restarted tablet
+        Engine engine(catalog, options);
+        BatchRunSession session;
+        base::Status status;
+        ASSERT_TRUE(engine.Get("select col_1 + 1 as c1 from t1;", "db", session, status)) << status;
+        auto& ctx = std::dynamic_pointer_cast<SqlCompileInfo>(session.GetCompileInfo())->get_sql_context();
+        auto fn = ctx.physical_plan->GetFnInfos()[0]->fn_ptr();
+        ASSERT_TRUE(fn != nullptr);
+
+        int8_t buf[64];
+        codec::RowBuilder builder(table->columns());
+        builder.SetBuffer(buf, 64);
+        builder.AppendInt64(41);
+        codec::Row row(base::RefCountedSlice::Create(buf, 64));
+        auto output = CoreAPI::RowProject(fn, row, codec::Row());
+        codec::RowView row_view(table->columns(), output.buf(), output.size());
+        int64_t c1 = 0;
+        ASSERT_EQ(0, row_view.GetInt64(0, &c1));
+        ASSERT_EQ(42, c1);
+    };
+    run();
+    ASSERT_EQ(1u, CountObjects());
+    run();
+    ASSERT_EQ(1u, CountObjects());
+}
+
+}  // namespace vm
+}  // namespace hybridse
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    hybridse::vm::Engine::InitializeGlobalLLVM();
+    return RUN_ALL_TESTS();
+}
@@ -21,6 +21,7 @@
 #include <string>
 #include "base/raw_buffer.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "vm/core_api.h"
 #include "vm/engine_context.h"
 
@@ -32,6 +33,7 @@ class UdfLibrary;
 namespace vm {
 
 class JitOptions;
+class JitObjectCache;
 
 class HybridSeJitWrapper {
  public:
@@ -51,6 +53,12 @@ class HybridSeJitWrapper {
 
     bool AddModuleFromBuffer(const base::RawBuffer&);
 
+    // add an object file compiled before, return false if the engine does not support it
+    virtual bool AddObject(std::unique_ptr<llvm::MemoryBuffer> object) { return false; }
+
+    // the object cache of the compiled modules, nullptr if disabled
+    virtual JitObjectCache* GetObjectCache() const { return nullptr; }
+
     virtual hybridse::vm::RawPtrHandle FindFunction(const std::string& funcname) = 0;
 
     // create the JIT wrapper with default builtin symbols imported already
@@ -493,12 +493,26 @@ std::shared_ptr<DataHandler> TableProjectRunner::Run(
     auto& parameter = ctx.GetParameterRow();
     iter->SeekToFirst();
     int32_t cnt = 0;
+    std::vector<Row> rows;
+    std::vector<Row> outputs;
+    rows.reserve(batch_size_);
     while (iter->Valid()) {
-        if (limit_cnt_.has_value() && cnt++ >= limit_cnt_) {
+        rows.clear();
+        while (iter->Valid() && rows.size() < batch_size_) {
+            if (limit_cnt_.has_value() && cnt++ >= limit_cnt_) {
+                break;
+            }
+            rows.push_back(iter->GetValue());
+            iter->Next();
+        }
+        if (rows.empty()) {
             break;
         }
-        output_table->AddRow(project_gen_.Gen(iter->GetValue(), parameter));
-        iter->Next();
+        outputs.clear();
+        project_gen_.Gen(rows, parameter, &outputs);
+        for (auto& row : outputs) {
+            output_table->AddRow(row);
+        }
     }
     return output_table;
 }
@@ -1475,6 +1489,39 @@ bool RequestAggUnionRunner::InitAggregator() {
         LOG(ERROR) << "non-support aggr expr type " << ExprTypeName(agg_col_->GetExprType());
         return false;
     }
+
+    switch (agg_type_) {
+        case kMedian:
+        case kPercentile: {
+            if (agg_col_type_ == type::kVarchar || agg_col_type_ == type::kDate ||
+                agg_col_type_ == type::kTimestamp) {
+                LOG(ERROR) << func_->GetName() << " does not support type " << Type_Name(agg_col_type_);
+                return false;
+            }
+            if (agg_type_ == kMedian) {
+                break;
+            }
+            auto percentage = dynamic_cast<const node::ConstNode*>(const_arg_);
+            if (percentage == nullptr || !(percentage->IsNumber() || percentage->IsNull())) {
+                LOG(ERROR) << "percentage of percentile should be a constant number";
+                return false;
+            }
+            // a null percentage outputs null as the percentile udaf
+            percentage_ = percentage->IsNull() ? -1 : percentage->GetAsDouble();
+            break;
+        }
+        case kTopNFrequency: {
+            auto top_n = dynamic_cast<const node::ConstNode*>(const_arg_);
+            if (top_n == nullptr || !top_n->IsNumber()) {
+                LOG(ERROR) << "top n of topn_frequency should be a constant number";
+                return false;
+            }
+            top_n_ = top_n->GetAsInt32();
+            break;
+        }
+        default:
+            break;
+    }
     return true;
 }
 
@@ -1495,12 +1542,128 @@ std::unique_ptr<BaseAggregator> RequestAggUnionRunner::CreateAggregator() const
         case kMax:
         case kMaxWhere:
             return MakeSameTypeAggregator<MaxAggregator>(agg_col_type_, *output_schemas_->GetOutputSchema());
+        case kDistinctCount:
+            return MakeSameTypeAggregator<DistinctCountAggregator>(agg_col_type_,
+                                                                   *output_schemas_->GetOutputSchema());
+        case kMedian:
+        case kPercentile:
+            return MakeSameTypeAggregator<PercentileAggregator>(agg_col_type_, *output_schemas_->GetOutputSchema(),
+                                                                percentage_);
+        case kTopNFrequency:
+            return MakeSameTypeAggregator<TopNFrequencyAggregator>(agg_col_type_,
+                                                                   *output_schemas_->GetOutputSchema(), top_n_);
         default:
             LOG(ERROR) << "RequestAggUnionRunner does not support for op " << func_->GetName();
             return nullptr;
     }
 }
 
+WindowAggKind RequestAggUnionRunner::GetWindowAggKind() const {
+    switch (agg_type_) {
+        case kSum:
+        case kSumWhere:
+            return kWindowAggSum;
+        case kAvg:
+        case kAvgWhere:
+            return kWindowAggAvg;
+        case kCount:
+        case kCountWhere:
+            return kWindowAggCount;
+        case kMin:
+        case kMinWhere:
+            return kWindowAggMin;
+        default:
+            return kWindowAggMax;
+    }
+}
+
+bool RequestAggUnionRunner::UseStateCache(int64_t ts_gen) const {
+    // only the windows bounded by time range can be slided by the request ts,
+    // and the sketches of distinct_count/median/percentile/topn_frequency can not evict values
+    if (agg_type_ == kDistinctCount || agg_type_ == kMedian || agg_type_ == kPercentile ||
+        agg_type_ == kTopNFrequency) {
+        return false;
+    }
+    return state_cache_ && ts_gen >= 0 && range_gen_->window_range_.frame_type_ == Window::kFrameRowsRange &&
+           range_gen_->window_range_.max_size_ == 0;
+}
+
+template <class Fn>
+void RequestAggUnionRunner::VisitBaseValue(const RowParser* row_parser, const Row& row, Fn&& fn) const {
+    if (!agg_col_name_.empty() && row_parser->IsNull(row, agg_col_name_)) {
+        return;
+    }
+
+    if (cond_ != nullptr) {
+        // for those condition exists and evaluated to NULL/false
+        // will apply to functions `*_where`
+        // include `count_where` has supported, or `{min/max/avg/sum}_where` support later
+        auto matches = internal::EvalCond(row_parser, row, cond_);
+        DLOG(INFO) << "[Update Base Filter] Evaluate result of " << cond_->GetExprString() << ": "
+                   << PrintEvalValue(matches);
+        if (!matches.ok()) {
+            LOG(ERROR) << matches.status();
+            return;
+        }
+        if (false == matches->value_or(false)) {
+            return;
+        }
+    }
+
+    if (agg_type_ == kCount || agg_type_ == kCountWhere) {
+        fn(static_cast<int64_t>(1));
+        return;
+    }
+
+    if (agg_col_name_.empty()) {
+        return;
+    }
+    auto type = agg_col_type_;
+    switch (type) {
+        case type::Type::kInt16: {
+            int16_t val = 0;
+            row_parser->GetValue(row, agg_col_name_, type, &val);
+            fn(val);
+            break;
+        }
+        case type::Type::kDate:
+        case type::Type::kInt32: {
+            int32_t val = 0;
+            row_parser->GetValue(row, agg_col_name_, type, &val);
+            fn(val);
+            break;
+        }
+        case type::Type::kTimestamp:
+        case type::Type::kInt64: {
+            int64_t val = 0;
+            row_parser->GetValue(row, agg_col_name_, type, &val);
+            fn(val);
+            break;
+        }
+        case type::Type::kFloat: {
+            float val = 0;
+            row_parser->GetValue(row, agg_col_name_, type, &val);
+            fn(val);
+            break;
+        }
+        case type::Type::kDouble: {
+            double val = 0;
+            row_parser->GetValue(row, agg_col_name_, type, &val);
+            fn(val);
+            break;
+        }
+        case type::Type::kVarchar: {
+            std::string val;
+            row_parser->GetString(row, agg_col_name_, &val);
+            fn(val);
+            break;
+        }
+        default:
+            LOG(ERROR) << "Not support type: " << Type_Name(type);
+            break;
+    }
+}
+
 std::shared_ptr<DataHandler> RequestAggUnionRunner::Run(
     RunnerContext& ctx,
     const std::vector<std::shared_ptr<DataHandler>>& inputs) {
@@ -1539,6 +1702,13 @@ std::shared_ptr<DataHandler> RequestAggUnionRunner::Run(
 
     auto union_segments =
         windows_union_gen_->GetRequestWindows(request, ctx.GetParameterRow(), union_inputs);
+    // the counts tell the rows put late or deleted, the segments without them are not cached
+    uint64_t put_cnt = 0;
+    uint64_t delete_cnt = 0;
+    if (UseStateCache(ts_gen) && union_segments[0] && union_segments[0]->GetPutCount(&put_cnt, &delete_cnt)) {
+        return RequestUnionWindowWithCache(request, key, union_segments[0], put_cnt, delete_cnt, ts_gen,
+                                           range_gen_->window_range_, output_request_row_, exclude_current_time_);
+    }
     // code_gen result of agg_segment is not correct. we correct the result here
     auto agg_segment = std::dynamic_pointer_cast<PartitionHandler>(union_inputs[1])->GetSegment(key);
     if (agg_segment) {
@@ -1611,78 +1781,7 @@ std::shared_ptr<TableHandler> RequestAggUnionRunner::RequestUnionWindow(
     auto aggregator = CreateAggregator();
     auto update_base_aggregator = [aggregator = aggregator.get(), row_parser = base_row_parser, this](const Row& row) {
         DLOG(INFO) << "[Update Base]\n" << GetPrettyRow(row_parser->schema_ctx(), row);
-        if (!agg_col_name_.empty() && row_parser->IsNull(row, agg_col_name_)) {
-            return;
-        }
-
-        if (cond_ != nullptr) {
-            // for those condition exists and evaluated to NULL/false
-            // will apply to functions `*_where`
-            // include `count_where` has supported, or `{min/max/avg/sum}_where` support later
-            auto matches = internal::EvalCond(row_parser, row, cond_);
-            DLOG(INFO) << "[Update Base Filter] Evaluate result of " << cond_->GetExprString() << ": "
-                       << PrintEvalValue(matches);
-            if (!matches.ok()) {
-                LOG(ERROR) << matches.status();
-                return;
-            }
-            if (false == matches->value_or(false)) {
-                return;
-            }
-        }
-
-        auto type = aggregator->type();
-        if (agg_type_ == kCount || agg_type_ == kCountWhere) {
-            dynamic_cast<Aggregator<int64_t>*>(aggregator)->UpdateValue(1);
-            return;
-        }
-
-        if (agg_col_name_.empty()) {
-            return;
-        }
-        switch (type) {
-            case type::Type::kInt16: {
-                int16_t val = 0;
-                row_parser->GetValue(row, agg_col_name_, type, &val);
-                AggregatorUpdate(aggregator, val);
-                break;
-            }
-            case type::Type::kDate:
-            case type::Type::kInt32: {
-                int32_t val = 0;
-                row_parser->GetValue(row, agg_col_name_, type, &val);
-                AggregatorUpdate(aggregator, val);
-                break;
-            }
-            case type::Type::kTimestamp:
-            case type::Type::kInt64: {
-                int64_t val = 0;
-                row_parser->GetValue(row, agg_col_name_, type, &val);
-                AggregatorUpdate(aggregator, val);
-                break;
-            }
-            case type::Type::kFloat: {
-                float val = 0;
-                row_parser->GetValue(row, agg_col_name_, type, &val);
-                AggregatorUpdate(aggregator, val);
-                break;
-            }
-            case type::Type::kDouble: {
-                double val = 0;
-                row_parser->GetValue(row, agg_col_name_, type, &val);
-                AggregatorUpdate(aggregator, val);
-                break;
-            }
-            case type::Type::kVarchar: {
-                std::string val;
-                row_parser->GetString(row, agg_col_name_, &val);
-                AggregatorUpdate(aggregator, val);
-                break;
-            }
-            default:
-                LOG(ERROR) << "Not support type: " << Type_Name(type);
-                break;
-        }
+        VisitBaseValue(row_parser, row, [aggregator](const auto& val) { AggregatorUpdate(aggregator, val); });
     };
 
     auto update_agg_aggregator = [aggregator = aggregator.get(), row_parser = agg_row_parser, this](const Row& row) {
@@ -1937,6 +2036,52 @@ std::shared_ptr<TableHandler> RequestAggUnionRunner::RequestUnionWindow(
     return window_table;
 }
 
+std::shared_ptr<TableHandler> RequestAggUnionRunner::RequestUnionWindowWithCache(
+    const Row& request, const std::string& key, std::shared_ptr<TableHandler> base_segment, uint64_t put_cnt,
+    uint64_t delete_cnt, int64_t ts_gen, const WindowRange& window_range, bool output_request_row,
+    bool exclude_current_time) const {
+    int64_t start = (ts_gen + window_range.start_offset_) < 0 ? 0 : (ts_gen + window_range.start_offset_);
+    int64_t end = 0;
+    if (exclude_current_time && 0 == window_range.end_offset_) {
+        end = (ts_gen - 1) < 0 ? 0 : (ts_gen - 1);
+    } else {
+        end = (ts_gen + window_range.end_offset_) < 0 ? 0 : (ts_gen + window_range.end_offset_);
+    }
+    const auto base_row_parser = producers_[1]->row_parser();
+    auto aggregator = CreateAggregator();
+    if (!aggregator) {
+        return nullptr;
+    }
+    if (output_request_row) {
+        VisitBaseValue(base_row_parser, request,
+                       [aggregator = aggregator.get()](const auto& val) { AggregatorUpdate(aggregator, val); });
+    }
+
+    auto window_table = std::make_shared<MemTimeTableHandler>();
+    auto base_it = base_segment ? base_segment->GetIterator() : nullptr;
+    if (!base_it) {
+        window_table->AddRow(start, aggregator->Output());
+        return window_table;
+    }
+    auto entry = state_cache_->Get(key);
+    std::lock_guard<std::mutex> lock(entry->mu);
+    if (!entry->state) {
+        entry->state = CreateWindowAggState(GetWindowAggKind(), aggregator->GetRepType());
+        if (!entry->state) {
+            return nullptr;
+        }
+    }
+    auto state = dynamic_cast<WindowAggState*>(entry->state.get());
+    auto push = [this, base_row_parser, state](int64_t ts, const Row& row) {
+        VisitBaseValue(base_row_parser, row, [state, ts](const auto& val) { WindowAggStatePush(state, ts, val); });
+    };
+    UpdateWindowState(base_it.get(), put_cnt, delete_cnt, start, end, state, push);
+    state->Output(aggregator.get());
+    window_table->AddRow(start, aggregator->Output());
+    DLOG(INFO) << "REQUEST AGG UNION with state cache, key " << key << ", state cnt = " << entry->state->GetCount();
+    return window_table;
+}
+
 std::string RequestAggUnionRunner::PrintEvalValue(const absl::StatusOr<std::optional<bool>>& val) {
     std::ostringstream os;
     if (!val.ok()) {
@@ -2012,11 +2157,69 @@ std::shared_ptr<TableHandler> RequestUnionRunner::RunOneRequest(RunnerContext* c
     // Prepare Union Window
     auto union_inputs = windows_union_gen_->RunInputs(*ctx);
     auto union_segments = windows_union_gen_->GetRequestWindows(request, ctx->GetParameterRow(), union_inputs);
+    // the counts tell the rows put late or deleted, the segments without them are not cached
+    uint64_t put_cnt = 0;
+    uint64_t delete_cnt = 0;
+    if (UseStateCache(ts_gen, union_segments) && union_segments[0]->GetPutCount(&put_cnt, &delete_cnt)) {
+        auto& key_gen = windows_union_gen_->windows_gen_[0].index_seek_gen_.index_key_gen_;
+        return RequestUnionWindowWithCache(request, key_gen.Gen(request, ctx->GetParameterRow()), union_segments[0],
+                                           put_cnt, delete_cnt, ts_gen);
+    }
     // build window with start and end offset
     return RequestUnionWindow(request, union_segments, ts_gen, range_gen_->window_range_, output_request_row_,
                               exclude_current_time_);
 }
 
+bool RequestUnionRunner::UseStateCache(int64_t ts_gen,
+                                       const std::vector<std::shared_ptr<TableHandler>>& union_segments) const {
+    // the window of one segment selected by the partition key and bounded by time range only
+    const auto& window_range = range_gen_->window_range_;
+    if (!state_cache_ || ts_gen < 0 || window_range.frame_type_ != Window::kFrameRowsRange ||
+        window_range.max_size_ > 0) {
+        return false;
+    }
+    if (exclude_current_time_ && 0 == window_range.end_offset_ && 0 == ts_gen) {
+        return false;
+    }
+    return union_segments.size() == 1 && union_segments[0] &&
+           windows_union_gen_->windows_gen_[0].index_seek_gen_.index_key_gen_.Valid();
+}
+
+std::shared_ptr<TableHandler> RequestUnionRunner::RequestUnionWindowWithCache(const Row& request,
+                                                                              const std::string& key,
+                                                                              std::shared_ptr<TableHandler> segment,
+                                                                              uint64_t put_cnt,
+                                                                              uint64_t delete_cnt,
+                                                                              int64_t ts_gen) const {
+    const auto& window_range = range_gen_->window_range_;
+    int64_t start = (ts_gen + window_range.start_offset_) < 0 ? 0 : (ts_gen + window_range.start_offset_);
+    int64_t end = 0;
+    if (exclude_current_time_ && 0 == window_range.end_offset_) {
+        end = ts_gen - 1;
+    } else {
+        end = (ts_gen + window_range.end_offset_) < 0 ? 0 : (ts_gen + window_range.end_offset_);
+    }
+    auto window_table = std::make_shared<WindowRowsTableHandler>();
+    if (output_request_row_) {
+        window_table->AddRow(ts_gen, request);
+    }
+    auto it = segment->GetIterator();
+    if (!it) {
+        return window_table;
+    }
+    auto entry = state_cache_->Get(key);
+    std::lock_guard<std::mutex> lock(entry->mu);
+    if (!entry->state) {
+        entry->state = std::make_unique<WindowRowsState>();
+    }
+    auto state = dynamic_cast<WindowRowsState*>(entry->state.get());
+    UpdateWindowState(it.get(), put_cnt, delete_cnt, start, end, state,
+                      [state](int64_t ts, const Row& row) { state->Push(ts, row); });
+    state->Output(window_table.get());
+    DLOG(INFO) << "REQUEST UNION with state cache, key " << key << ", cnt = " << window_table->GetCount();
+    return window_table;
+}
+
 std::shared_ptr<TableHandler> RequestUnionRunner::RequestUnionWindow(
     const Row& request, std::vector<std::shared_ptr<TableHandler>> union_segments, int64_t ts_gen,
     const WindowRange& window_range, bool output_request_row, bool exclude_current_time) {
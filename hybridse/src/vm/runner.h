@@ -17,6 +17,7 @@
 #ifndef HYBRIDSE_SRC_VM_RUNNER_H_
 #define HYBRIDSE_SRC_VM_RUNNER_H_
 
+#include <algorithm>
 #include <memory>
 #include <set>
 #include <string>
@@ -32,6 +33,7 @@
 #include "vm/generator.h"
 #include "vm/mem_catalog.h"
 #include "vm/physical_op.h"
+#include "vm/window_agg_cache.h"
 
 namespace hybridse {
 namespace vm {
@@ -358,7 +360,12 @@ class TableProjectRunner : public Runner {
         RunnerContext& ctx,  // NOLINT
         const std::vector<std::shared_ptr<DataHandler>>& inputs)
         override;  // NOLINT
+    // the rows projected in one run step, the compiled function is still called once per row
+    void SetBatchSize(uint32_t batch_size) { batch_size_ = std::max(1u, batch_size); }
     ProjectGenerator project_gen_;
+
+ private:
+    uint32_t batch_size_ = 1;
 };
 class RowProjectRunner : public Runner {
  public:
@@ -536,6 +543,10 @@ class RequestUnionRunner : public Runner {
         windows_union_gen_->AddWindowUnion(window, runner);
     }
 
+    // keep the window rows of at most capacity partition keys, so that a request only reads the rows put since
+    // the last request on the same key instead of the whole window. The compiled aggregates still walk the window
+    void EnableStateCache(uint32_t capacity) { state_cache_ = std::make_shared<WindowAggStateCache>(capacity); }
+
     void Print(std::ostream& output, const std::string& tab,
                        std::set<int32_t>* visited_ids) const override {
         Runner::Print(output, tab, visited_ids);
@@ -549,6 +560,14 @@ class RequestUnionRunner : public Runner {
     std::shared_ptr<RangeGenerator> range_gen_;
     bool exclude_current_time_;
     bool output_request_row_;
+    std::shared_ptr<WindowAggStateCache> state_cache_;
+
+ private:
+    bool UseStateCache(int64_t ts_gen, const std::vector<std::shared_ptr<TableHandler>>& union_segments) const;
+    std::shared_ptr<TableHandler> RequestUnionWindowWithCache(const Row& request, const std::string& key,
+                                                              std::shared_ptr<TableHandler> segment,
+                                                              uint64_t put_cnt, uint64_t delete_cnt,
+                                                              int64_t ts_gen) const;
 };
 
 class RequestAggUnionRunner : public Runner {
@@ -568,9 +587,13 @@ class RequestAggUnionRunner : public Runner {
         } /* for kAllExpr like count(*), agg_col_name_ is empty */
 
         if (project->GetChildNum() >= 2) {
-            // assume second kid of project as filter condition
-            // function support check happens in compile
-            cond_ = project->GetChild(1);
+            // assume second kid of project as filter condition, except the constant arg of
+            // topn_frequency and percentile. function support check happens in compile
+            if (func_->GetName() == "topn_frequency" || func_->GetName() == "percentile") {
+                const_arg_ = project->GetChild(1);
+            } else {
+                cond_ = project->GetChild(1);
+            }
         }
     }
 
@@ -586,6 +609,12 @@ class RequestAggUnionRunner : public Runner {
         windows_union_gen_->AddWindowUnion(window, runner);
     }
 
+    // keep the aggregate state of at most capacity partition keys, so that a request only
+    // reads the rows put since the last request on the same key instead of the whole window.
+    // a row put with a ts older than the cached ones or a delete rebuilds the state, see UpdateWindowState.
+    // the state keeps a value per row to evict, so a rebuild reads the base table, not the pre-aggregated one
+    void EnableStateCache(uint32_t capacity) { state_cache_ = std::make_shared<WindowAggStateCache>(capacity); }
+
     static std::string PrintEvalValue(const absl::StatusOr<std::optional<bool>>& val);
 
  private:
@@ -600,6 +629,10 @@ class RequestAggUnionRunner : public Runner {
         kAvgWhere,
         kMinWhere,
         kMaxWhere,
+        kDistinctCount,
+        kMedian,
+        kTopNFrequency,
+        kPercentile,
     };
 
     std::shared_ptr<RequestWindowUnionGenerator> windows_union_gen_;
@@ -620,7 +653,26 @@ class RequestAggUnionRunner : public Runner {
     // simple compassion binary expr like col < 0 is supported
     node::ExprNode* cond_ = nullptr;
 
+    // the constant n of topn_frequency or the percentage of percentile
+    node::ExprNode* const_arg_ = nullptr;
+    int32_t top_n_ = 0;
+    double percentage_ = 0.5;
+
+    std::shared_ptr<WindowAggStateCache> state_cache_;
+
     std::unique_ptr<BaseAggregator> CreateAggregator() const;
+    WindowAggKind GetWindowAggKind() const;
+    bool UseStateCache(int64_t ts_gen) const;
+    std::shared_ptr<TableHandler> RequestUnionWindowWithCache(const Row& request, const std::string& key,
+                                                              std::shared_ptr<TableHandler> base_segment,
+                                                              uint64_t put_cnt, uint64_t delete_cnt,
+                                                              int64_t request_ts,
+                                                              const WindowRange& window_range,
+                                                              bool output_request_row,
+                                                              bool exclude_current_time) const;
+    // call fn with the value of the aggr column, skip the row if it is null or does not match the condition
+    template <class Fn>
+    void VisitBaseValue(const RowParser* row_parser, const Row& row, Fn&& fn) const;
 
     static inline const absl::flat_hash_map<absl::string_view, AggType> agg_type_map_ = {
         {"sum", kSum},
@@ -632,7 +684,11 @@ class RequestAggUnionRunner : public Runner {
         {"sum_where", kSumWhere},
         {"avg_where", kAvgWhere},
         {"min_where", kMinWhere},
-        {"max_where", kMaxWhere}};
+        {"max_where", kMaxWhere},
+        {"distinct_count", kDistinctCount},
+        {"median", kMedian},
+        {"topn_frequency", kTopNFrequency},
+        {"percentile", kPercentile}};
 };
 
 class PostRequestUnionRunner : public Runner {
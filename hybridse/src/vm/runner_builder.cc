@@ -156,6 +156,7 @@ ClusterTask RunnerBuilder::Build(PhysicalOpNode* node, Status& status) {
                     }
                     TableProjectRunner* runner = CreateRunner<TableProjectRunner>(
                         id_++, node->schemas_ctx(), op->GetLimitCnt(), op->project().fn_info());
+                    runner->SetBatchSize(exec_batch_size_);
                     return RegisterTask(node, UnaryInheritTask(cluster_task, runner));
                 }
                 case kReduceAggregation: {
@@ -260,6 +261,9 @@ ClusterTask RunnerBuilder::Build(PhysicalOpNode* node, Status& status) {
             RequestUnionRunner* runner =
                 CreateRunner<RequestUnionRunner>(id_++, node->schemas_ctx(), op->GetLimitCnt(), op->window().range_,
                                                  op->exclude_current_time(), op->output_request_row());
+            if (window_agg_cache_size_ > 0) {
+                runner->EnableStateCache(window_agg_cache_size_);
+            }
             Key index_key;
             if (!op->instance_not_in_window()) {
                 runner->AddWindowUnion(op->window_, right);
@@ -459,6 +463,7 @@ ClusterTask RunnerBuilder::Build(PhysicalOpNode* node, Status& status) {
             auto op = dynamic_cast<const PhysicalFilterNode*>(node);
             FilterRunner* runner =
                 CreateRunner<FilterRunner>(id_++, node->schemas_ctx(), op->GetLimitCnt(), op->filter_);
+            runner->filter_gen_.SetBatchSize(exec_batch_size_);
             // under cluster, filter task might be completed or uncompleted
             // based on whether filter node has the index_key underlaying DataTask requires
             ClusterTask out;
@@ -590,6 +595,9 @@ ClusterTask RunnerBuilder::BuildRequestAggUnionTask(PhysicalOpNode* node, Status
     RequestAggUnionRunner* runner =
         CreateRunner<RequestAggUnionRunner>(id_++, node->schemas_ctx(), op->GetLimitCnt(), op->window().range_,
                                             op->exclude_current_time(), op->output_request_row(), op->project_);
+    if (window_agg_cache_size_ > 0) {
+        runner->EnableStateCache(window_agg_cache_size_);
+    }
     Key index_key;
     if (!op->instance_not_in_window()) {
         index_key = op->window_.index_key();
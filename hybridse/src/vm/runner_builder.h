@@ -46,6 +46,8 @@ class RunnerBuilder {
           proxy_runner_map_(),
           batch_common_node_set_(batch_common_node_set) {}
     virtual ~RunnerBuilder() {}
+    void SetWindowAggCacheSize(uint32_t size) { window_agg_cache_size_ = size; }
+    void SetExecBatchSize(uint32_t size) { exec_batch_size_ = size; }
     ClusterTask RegisterTask(PhysicalOpNode* node, ClusterTask task);
     ClusterTask Build(PhysicalOpNode* node,                            // NOLINT
                       Status& status);                                 // NOLINT
@@ -84,6 +86,8 @@ class RunnerBuilder {
     std::shared_ptr<ClusterTask> request_task_;
     std::unordered_map<hybridse::vm::Runner*, ::hybridse::vm::Runner*> proxy_runner_map_;
     std::set<size_t> batch_common_node_set_;
+    uint32_t window_agg_cache_size_ = 0;
+    uint32_t exec_batch_size_ = 1;
 };
 
 }  // namespace vm
@@ -0,0 +1,279 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/sketch.h"
+
+#include <cmath>
+
+namespace hybridse {
+namespace vm {
+
+namespace {
+constexpr uint8_t kHllExact = 0;
+constexpr uint8_t kHllRegisters = 1;
+}  // namespace
+
+void HyperLogLog::AddHash(uint64_t hash) {
+    if (!IsExact()) {
+        UpdateRegister(hash);
+        return;
+    }
+    hashes_.insert(hash);
+    if (hashes_.size() > kExactLimit) {
+        ToRegisters();
+    }
+}
+
+void HyperLogLog::UpdateRegister(uint64_t hash) {
+    uint32_t idx = hash >> (64 - kPrecision);
+    // the rank is the position of the first 1 bit in the rest bits, the guard bit limits it to 64 - kPrecision + 1
+    uint64_t rest = (hash << kPrecision) | (1ull << (kPrecision - 1));
+    uint8_t rank = __builtin_clzll(rest) + 1;
+    if (rank > registers_[idx]) {
+        registers_[idx] = rank;
+    }
+}
+
+void HyperLogLog::ToRegisters() {
+    registers_.assign(kRegisterNum, 0);
+    for (auto hash : hashes_) {
+        UpdateRegister(hash);
+    }
+    hashes_.clear();
+}
+
+void HyperLogLog::Merge(const HyperLogLog& other) {
+    if (other.IsExact()) {
+        for (auto hash : other.hashes_) {
+            AddHash(hash);
+        }
+        return;
+    }
+    if (IsExact()) {
+        ToRegisters();
+    }
+    for (uint32_t i = 0; i < kRegisterNum; i++) {
+        registers_[i] = std::max(registers_[i], other.registers_[i]);
+    }
+}
+
+int64_t HyperLogLog::Estimate() const {
+    if (IsExact()) {
+        return hashes_.size();
+    }
+    double m = kRegisterNum;
+    double sum = 0;
+    uint32_t zeros = 0;
+    for (auto reg : registers_) {
+        sum += std::ldexp(1.0, -reg);
+        if (reg == 0) {
+            zeros++;
+        }
+    }
+    double alpha = 0.7213 / (1 + 1.079 / m);
+    double estimate = alpha * m * m / sum;
+    // linear counting for the small range
+    if (estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * std::log(m / zeros);
+    }
+    return std::llround(estimate);
+}
+
+void HyperLogLog::Encode(std::string* output) const {
+    if (IsExact()) {
+        sketch::PutFixed(kHllExact, output);
+        sketch::PutFixed(static_cast<uint32_t>(hashes_.size()), output);
+        for (auto hash : hashes_) {
+            sketch::PutFixed(hash, output);
+        }
+    } else {
+        sketch::PutFixed(kHllRegisters, output);
+        output->append(reinterpret_cast<const char*>(registers_.data()), registers_.size());
+    }
+}
+
+bool HyperLogLog::Decode(absl::string_view input) {
+    Clear();
+    uint8_t format = 0;
+    if (!sketch::GetFixed(&input, &format)) {
+        return false;
+    }
+    if (format == kHllExact) {
+        uint32_t size = 0;
+        if (!sketch::GetFixed(&input, &size) || input.size() != size * sizeof(uint64_t)) {
+            return false;
+        }
+        hashes_.reserve(size);
+        for (uint32_t i = 0; i < size; i++) {
+            uint64_t hash = 0;
+            sketch::GetFixed(&input, &hash);
+            hashes_.insert(hash);
+        }
+        return true;
+    } else if (format == kHllRegisters) {
+        if (input.size() != kRegisterNum) {
+            return false;
+        }
+        registers_.assign(input.begin(), input.end());
+        return true;
+    }
+    return false;
+}
+
+void TDigest::Add(double val, double weight) {
+    if (centroids_.empty()) {
+        min_ = val;
+        max_ = val;
+    } else {
+        min_ = std::min(min_, val);
+        max_ = std::max(max_, val);
+    }
+    if (!centroids_.empty() && val < centroids_.back().mean) {
+        sorted_ = false;
+    }
+    centroids_.push_back({val, weight});
+    count_ += weight;
+    if (centroids_.size() >= kBufferSize) {
+        Compress();
+    }
+}
+
+void TDigest::Merge(const TDigest& other) {
+    if (other.IsEmpty()) {
+        return;
+    }
+    if (IsEmpty()) {
+        min_ = other.min_;
+        max_ = other.max_;
+    } else {
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+    centroids_.insert(centroids_.end(), other.centroids_.begin(), other.centroids_.end());
+    sorted_ = false;
+    count_ += other.count_;
+    if (centroids_.size() >= kBufferSize) {
+        Compress();
+    }
+}
+
+void TDigest::Sort() {
+    if (!sorted_) {
+        std::stable_sort(centroids_.begin(), centroids_.end(),
+                         [](const Centroid& l, const Centroid& r) { return l.mean < r.mean; });
+        sorted_ = true;
+    }
+}
+
+void TDigest::Compress() {
+    Sort();
+    if (centroids_.size() <= 1) {
+        return;
+    }
+    // k1 scale function: k(q) = compression / (2 * pi) * asin(2q - 1)
+    auto q_limit = [this](double q) {
+        double k = kCompression / (2 * M_PI) * std::asin(2 * q - 1) + 1;
+        if (k >= kCompression / 4) {
+            return 1.0;
+        }
+        return (std::sin(k * 2 * M_PI / kCompression) + 1) / 2;
+    };
+    std::vector<Centroid> merged;
+    merged.reserve(kCompression);
+    Centroid cur = centroids_[0];
+    double weight_so_far = 0;
+    double limit = q_limit(0);
+    for (size_t i = 1; i < centroids_.size(); i++) {
+        const auto& next = centroids_[i];
+        if ((weight_so_far + cur.weight + next.weight) / count_ <= limit) {
+            cur.weight += next.weight;
+            cur.mean += (next.mean - cur.mean) * next.weight / cur.weight;
+        } else {
+            weight_so_far += cur.weight;
+            merged.push_back(cur);
+            limit = q_limit(weight_so_far / count_);
+            cur = next;
+        }
+    }
+    merged.push_back(cur);
+    centroids_.swap(merged);
+}
+
+double TDigest::Quantile(double q) {
+    Sort();
+    if (centroids_.size() == 1) {
+        return centroids_[0].mean;
+    }
+    q = std::min(1.0, std::max(0.0, q));
+    double rank = q * (count_ - 1);
+    auto lerp = [rank](double x0, double y0, double x1, double y1) {
+        if (x1 <= x0) {
+            return y1;
+        }
+        return y0 + (y1 - y0) * (rank - x0) / (x1 - x0);
+    };
+    // the centroid is placed at the center of the ranks it covers
+    double prev_center = 0;
+    double prev_mean = min_;
+    double cum = 0;
+    for (const auto& c : centroids_) {
+        double center = cum + (c.weight - 1) / 2;
+        if (rank <= center) {
+            return lerp(prev_center, prev_mean, center, c.mean);
+        }
+        prev_center = center;
+        prev_mean = c.mean;
+        cum += c.weight;
+    }
+    return lerp(prev_center, prev_mean, count_ - 1, max_);
+}
+
+void TDigest::Encode(std::string* output) const {
+    const TDigest* digest = this;
+    TDigest compressed;
+    if (centroids_.size() > kCompression) {
+        compressed = *this;
+        compressed.Compress();
+        digest = &compressed;
+    }
+    sketch::PutFixed(static_cast<uint32_t>(digest->centroids_.size()), output);
+    sketch::PutFixed(digest->min_, output);
+    sketch::PutFixed(digest->max_, output);
+    for (const auto& c : digest->centroids_) {
+        sketch::PutFixed(c.mean, output);
+        sketch::PutFixed(c.weight, output);
+    }
+}
+
+bool TDigest::Decode(absl::string_view input) {
+    Clear();
+    uint32_t size = 0;
+    if (!sketch::GetFixed(&input, &size) || !sketch::GetFixed(&input, &min_) || !sketch::GetFixed(&input, &max_) ||
+        input.size() != size * 2 * sizeof(double)) {
+        return false;
+    }
+    centroids_.resize(size);
+    for (auto& c : centroids_) {
+        sketch::GetFixed(&input, &c.mean);
+        sketch::GetFixed(&input, &c.weight);
+        count_ += c.weight;
+    }
+    sorted_ = false;
+    return true;
+}
+
+}  // namespace vm
+}  // namespace hybridse
@@ -0,0 +1,323 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_SRC_VM_SKETCH_H_
+#define HYBRIDSE_SRC_VM_SKETCH_H_
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "base/fe_hash.h"
+
+namespace hybridse {
+namespace vm {
+
+// Sketch is the mergeable summary stored in the pre-aggr table for the aggregations which
+// can not be kept in a single value, e.g. distinct_count, median and topn_frequency.
+// The storage encodes the sketch of every bucket, the engine decodes and merges them with
+// the sketch of the rows out of the buckets.
+class Sketch {
+ public:
+    virtual ~Sketch() {}
+
+    virtual void Encode(std::string* output) const = 0;
+    virtual bool Decode(absl::string_view input) = 0;
+    virtual std::unique_ptr<Sketch> Clone() const = 0;
+    virtual void Clear() = 0;
+};
+
+namespace sketch {
+
+// the binary layout is little endian as the row codec
+template <class T>
+void PutFixed(const T& val, std::string* output) {
+    output->append(reinterpret_cast<const char*>(&val), sizeof(T));
+}
+
+template <class T>
+bool GetFixed(absl::string_view* input, T* val) {
+    if (input->size() < sizeof(T)) {
+        return false;
+    }
+    memcpy(val, input->data(), sizeof(T));
+    input->remove_prefix(sizeof(T));
+    return true;
+}
+
+// values of integral types are hashed as int64_t and floating types as double, so the storage
+// and the engine get the same hash of a value whatever the type they read it with
+template <class T>
+uint64_t Hash(const T& val) {
+    static constexpr uint32_t kSeed = 0xe17a1465;
+    if constexpr (std::is_integral_v<T>) {
+        int64_t v = val;
+        return base::MurmurHash64A(&v, sizeof(v), kSeed);
+    } else if constexpr (std::is_floating_point_v<T>) {
+        // -0.0 and 0.0 are the same value
+        double v = val == 0 ? 0 : val;
+        return base::MurmurHash64A(&v, sizeof(v), kSeed);
+    } else {
+        absl::string_view v(val);
+        return base::MurmurHash64A(v.data(), v.size(), kSeed);
+    }
+}
+
+}  // namespace sketch
+
+// HyperLogLog counts the distinct values with 2^kPrecision registers, the standard error is
+// about 1.04 / sqrt(2^kPrecision) = 1.6%. The hashes are kept exactly until there are more than
+// kExactLimit of them, so that the small sets, which are the most common, are counted exactly.
+class HyperLogLog : public Sketch {
+ public:
+    static constexpr uint32_t kPrecision = 12;
+    static constexpr uint32_t kRegisterNum = 1 << kPrecision;
+    static constexpr uint32_t kExactLimit = 256;
+
+    HyperLogLog() {}
+    ~HyperLogLog() override {}
+
+    template <class T>
+    void Add(const T& val) {
+        AddHash(sketch::Hash(val));
+    }
+    void AddHash(uint64_t hash);
+    void Merge(const HyperLogLog& other);
+    int64_t Estimate() const;
+    bool IsExact() const { return registers_.empty(); }
+
+    void Encode(std::string* output) const override;
+    bool Decode(absl::string_view input) override;
+    std::unique_ptr<Sketch> Clone() const override { return std::make_unique<HyperLogLog>(*this); }
+    void Clear() override {
+        hashes_.clear();
+        registers_.clear();
+    }
+
+ private:
+    void ToRegisters();
+    void UpdateRegister(uint64_t hash);
+
+    absl::flat_hash_set<uint64_t> hashes_;
+    // empty until the hashes exceed kExactLimit
+    std::vector<uint8_t> registers_;
+};
+
+// TDigest estimates the quantiles with at most about kCompression centroids, the error is
+// smaller at the tails. Values are kept as single centroids until there are kBufferSize of them,
+// so the quantiles of a small set are exact.
+class TDigest : public Sketch {
+ public:
+    static constexpr double kCompression = 100;
+    static constexpr size_t kBufferSize = 500;
+
+    TDigest() {}
+    ~TDigest() override {}
+
+    void Add(double val) { Add(val, 1); }
+    void Merge(const TDigest& other);
+    // q in [0, 1], the sketch must not be empty.
+    // it interpolates between the ranks as std quantiles, i.e. Quantile(0.5) of {1, 2, 3, 4} is 2.5
+    double Quantile(double q);
+    double GetCount() const { return count_; }
+    bool IsEmpty() const { return centroids_.empty(); }
+
+    // compress the centroids if there are more than kCompression of them before encoding
+    void Encode(std::string* output) const override;
+    bool Decode(absl::string_view input) override;
+    std::unique_ptr<Sketch> Clone() const override { return std::make_unique<TDigest>(*this); }
+    void Clear() override {
+        centroids_.clear();
+        sorted_ = true;
+        count_ = 0;
+        min_ = 0;
+        max_ = 0;
+    }
+
+ private:
+    struct Centroid {
+        double mean;
+        double weight;
+    };
+
+    void Add(double val, double weight);
+    void Sort();
+    // merge the adjacent centroids as long as the merged one stays in the size bound of the k1 scale function
+    void Compress();
+
+    std::vector<Centroid> centroids_;
+    bool sorted_ = true;
+    double count_ = 0;
+    double min_ = 0;
+    double max_ = 0;
+};
+
+// SpaceSaving keeps the counters of the most frequent keys. Once there are more than
+// 2 * capacity keys, the counters out of the top capacity are dropped and the largest count
+// dropped becomes the floor, a new key starts from the floor as it may be dropped before.
+// So the counts are exact until keys are dropped, then overestimated by at most the floor.
+// K is int64_t, double or std::string
+template <class K>
+class SpaceSaving : public Sketch {
+ public:
+    static constexpr uint32_t kDefaultCapacity = 256;
+
+    explicit SpaceSaving(uint32_t capacity = kDefaultCapacity) : capacity_(capacity) {}
+    ~SpaceSaving() override {}
+
+    void Add(const K& key) { Add(key, 1); }
+
+    void Merge(const SpaceSaving& other) {
+        // a key missing in one sketch may have been dropped there with a count up to its floor
+        for (auto& [key, count] : counters_) {
+            if (other.counters_.find(key) == other.counters_.end()) {
+                count += other.floor_;
+            }
+        }
+        for (const auto& [key, count] : other.counters_) {
+            auto it = counters_.find(key);
+            if (it == counters_.end()) {
+                counters_.emplace(key, count + floor_);
+            } else {
+                it->second += count;
+            }
+        }
+        floor_ += other.floor_;
+        if (counters_.size() > 2 * capacity_) {
+            Prune();
+        }
+    }
+
+    // the top n keys sorted by count desc, and key asc for the same count
+    std::vector<std::pair<K, int64_t>> TopN(size_t n) const {
+        auto entries = SortedEntries();
+        if (entries.size() > n) {
+            entries.resize(n);
+        }
+        return entries;
+    }
+
+    int64_t GetFloor() const { return floor_; }
+
+    void Encode(std::string* output) const override {
+        auto entries = SortedEntries();
+        int64_t floor = floor_;
+        if (entries.size() > capacity_) {
+            floor = std::max(floor, entries[capacity_].second);
+            entries.resize(capacity_);
+        }
+        sketch::PutFixed(capacity_, output);
+        sketch::PutFixed(floor, output);
+        sketch::PutFixed(static_cast<uint32_t>(entries.size()), output);
+        for (const auto& [key, count] : entries) {
+            PutKey(key, output);
+            sketch::PutFixed(count, output);
+        }
+    }
+
+    bool Decode(absl::string_view input) override {
+        Clear();
+        uint32_t size = 0;
+        if (!sketch::GetFixed(&input, &capacity_) || !sketch::GetFixed(&input, &floor_) ||
+            !sketch::GetFixed(&input, &size)) {
+            return false;
+        }
+        for (uint32_t i = 0; i < size; i++) {
+            K key;
+            int64_t count = 0;
+            if (!GetKey(&input, &key) || !sketch::GetFixed(&input, &count)) {
+                return false;
+            }
+            counters_.emplace(std::move(key), count);
+        }
+        return input.empty();
+    }
+
+    std::unique_ptr<Sketch> Clone() const override { return std::make_unique<SpaceSaving>(*this); }
+
+    void Clear() override {
+        counters_.clear();
+        floor_ = 0;
+    }
+
+ private:
+    void Add(const K& key, int64_t count) {
+        auto it = counters_.find(key);
+        if (it != counters_.end()) {
+            it->second += count;
+            return;
+        }
+        counters_.emplace(key, count + floor_);
+        if (counters_.size() > 2 * capacity_) {
+            Prune();
+        }
+    }
+
+    std::vector<std::pair<K, int64_t>> SortedEntries() const {
+        std::vector<std::pair<K, int64_t>> entries(counters_.begin(), counters_.end());
+        std::sort(entries.begin(), entries.end(), [](const auto& l, const auto& r) {
+            return l.second > r.second || (l.second == r.second && l.first < r.first);
+        });
+        return entries;
+    }
+
+    void Prune() {
+        auto entries = SortedEntries();
+        floor_ = std::max(floor_, entries[capacity_].second);
+        for (size_t i = capacity_; i < entries.size(); i++) {
+            counters_.erase(entries[i].first);
+        }
+    }
+
+    static void PutKey(const K& key, std::string* output) {
+        if constexpr (std::is_arithmetic_v<K>) {
+            sketch::PutFixed(key, output);
+        } else {
+            sketch::PutFixed(static_cast<uint32_t>(key.size()), output);
+            output->append(key);
+        }
+    }
+
+    static bool GetKey(absl::string_view* input, K* key) {
+        if constexpr (std::is_arithmetic_v<K>) {
+            return sketch::GetFixed(input, key);
+        } else {
+            uint32_t len = 0;
+            if (!sketch::GetFixed(input, &len) || input->size() < len) {
+                return false;
+            }
+            key->assign(input->data(), len);
+            input->remove_prefix(len);
+            return true;
+        }
+    }
+
+    uint32_t capacity_;
+    int64_t floor_ = 0;
+    absl::flat_hash_map<K, int64_t> counters_;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+
+#endif  // HYBRIDSE_SRC_VM_SKETCH_H_
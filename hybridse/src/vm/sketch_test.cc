@@ -0,0 +1,190 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/sketch.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace hybridse {
+namespace vm {
+
+class SketchTest : public ::testing::Test {};
+
+TEST_F(SketchTest, HyperLogLogExact) {
+    HyperLogLog hll;
+    ASSERT_EQ(0, hll.Estimate());
+    for (int32_t i = 0; i < 100; i++) {
+        hll.Add(i % 50);
+    }
+    ASSERT_TRUE(hll.IsExact());
+    ASSERT_EQ(50, hll.Estimate());
+    // the same value read as different integral types
+    hll.Add(static_cast<int16_t>(1));
+    hll.Add(static_cast<int64_t>(1));
+    hll.Add(std::string("1"));
+    ASSERT_EQ(51, hll.Estimate());
+
+    std::string encoded;
+    hll.Encode(&encoded);
+    HyperLogLog decoded;
+    ASSERT_TRUE(decoded.Decode(encoded));
+    ASSERT_EQ(51, decoded.Estimate());
+    ASSERT_FALSE(decoded.Decode(encoded.substr(1)));
+}
+
+TEST_F(SketchTest, HyperLogLogMerge) {
+    std::vector<HyperLogLog> buckets(10);
+    HyperLogLog all;
+    for (int64_t i = 0; i < 100000; i++) {
+        int64_t val = i % 20000;
+        buckets[i % 10].Add(val);
+        all.Add(val);
+    }
+    HyperLogLog merged;
+    for (auto& bucket : buckets) {
+        std::string encoded;
+        bucket.Encode(&encoded);
+        HyperLogLog decoded;
+        ASSERT_TRUE(decoded.Decode(encoded));
+        merged.Merge(decoded);
+    }
+    ASSERT_FALSE(merged.IsExact());
+    ASSERT_EQ(all.Estimate(), merged.Estimate());
+    ASSERT_NEAR(20000, merged.Estimate(), 20000 * 0.05);
+
+    // merge exact into registers and the reverse
+    HyperLogLog small;
+    small.Add(-1.5);
+    merged.Merge(small);
+    small.Merge(all);
+    ASSERT_EQ(merged.Estimate(), small.Estimate());
+}
+
+TEST_F(SketchTest, TDigestExact) {
+    TDigest digest;
+    ASSERT_TRUE(digest.IsEmpty());
+    for (auto val : {4.0, 1.0, 3.0, 2.0}) {
+        digest.Add(val);
+    }
+    ASSERT_DOUBLE_EQ(2.5, digest.Quantile(0.5));
+    ASSERT_DOUBLE_EQ(1, digest.Quantile(0));
+    ASSERT_DOUBLE_EQ(4, digest.Quantile(1));
+    digest.Add(10);
+    ASSERT_DOUBLE_EQ(3, digest.Quantile(0.5));
+
+    TDigest single;
+    single.Add(7);
+    ASSERT_DOUBLE_EQ(7, single.Quantile(0.5));
+
+    std::string encoded;
+    digest.Encode(&encoded);
+    TDigest decoded;
+    ASSERT_TRUE(decoded.Decode(encoded));
+    ASSERT_DOUBLE_EQ(5, decoded.GetCount());
+    ASSERT_DOUBLE_EQ(3, decoded.Quantile(0.5));
+    decoded.Merge(single);
+    ASSERT_DOUBLE_EQ(3.5, decoded.Quantile(0.5));
+}
+
+TEST_F(SketchTest, TDigestMerge) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> dist(0, 1000);
+    std::vector<double> vals;
+    TDigest merged;
+    for (int bucket = 0; bucket < 100; bucket++) {
+        TDigest digest;
+        for (int i = 0; i < 1000; i++) {
+            double val = dist(rng);
+            vals.push_back(val);
+            digest.Add(val);
+        }
+        std::string encoded;
+        digest.Encode(&encoded);
+        ASSERT_LE(encoded.size(), 16 * TDigest::kCompression + 24);
+        TDigest decoded;
+        ASSERT_TRUE(decoded.Decode(encoded));
+        merged.Merge(decoded);
+    }
+    std::sort(vals.begin(), vals.end());
+    for (double q : {0.01, 0.25, 0.5, 0.75, 0.99}) {
+        double expect = vals[static_cast<size_t>(q * (vals.size() - 1))];
+        ASSERT_NEAR(expect, merged.Quantile(q), 1000 * 0.01) << "q = " << q;
+    }
+}
+
+TEST_F(SketchTest, SpaceSavingExact) {
+    SpaceSaving<int64_t> sketch;
+    for (int64_t i = 0; i < 10; i++) {
+        for (int64_t j = 0; j <= i; j++) {
+            sketch.Add(i);
+        }
+    }
+    sketch.Add(8);
+    auto top = sketch.TopN(3);
+    ASSERT_EQ(3u, top.size());
+    // 8 and 9 have the same count, the smaller key first
+    ASSERT_EQ(8, top[0].first);
+    ASSERT_EQ(10, top[0].second);
+    ASSERT_EQ(9, top[1].first);
+    ASSERT_EQ(7, top[2].first);
+    ASSERT_EQ(10u, sketch.TopN(100).size());
+
+    std::string encoded;
+    sketch.Encode(&encoded);
+    SpaceSaving<int64_t> decoded;
+    ASSERT_TRUE(decoded.Decode(encoded));
+    ASSERT_EQ(top, decoded.TopN(3));
+}
+
+TEST_F(SketchTest, SpaceSavingMerge) {
+    std::mt19937 rng(42);
+    // keys 0 - 9 are heavy hitters among a long tail of distinct keys
+    std::vector<SpaceSaving<std::string>> buckets(10, SpaceSaving<std::string>(32));
+    int64_t tail = 100;
+    for (int i = 0; i < 20000; i++) {
+        std::string key = rng() % 2 == 0 ? std::to_string(rng() % 10) : std::to_string(tail++);
+        buckets[i % 10].Add(key);
+    }
+    SpaceSaving<std::string> merged(32);
+    for (auto& bucket : buckets) {
+        ASSERT_GT(bucket.GetFloor(), 0);
+        std::string encoded;
+        bucket.Encode(&encoded);
+        SpaceSaving<std::string> decoded;
+        ASSERT_TRUE(decoded.Decode(encoded));
+        merged.Merge(decoded);
+    }
+    auto top = merged.TopN(10);
+    ASSERT_EQ(10u, top.size());
+    std::vector<std::string> keys;
+    for (auto& [key, count] : top) {
+        keys.push_back(key);
+    }
+    std::sort(keys.begin(), keys.end());
+    ASSERT_EQ(std::vector<std::string>({"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"}), keys);
+}
+
+}  // namespace vm
+}  // namespace hybridse
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -24,6 +24,7 @@
 #include "llvm/Support/raw_ostream.h"
 #include "plan/plan_api.h"
 #include "udf/default_udf_library.h"
+#include "vm/jit_object_cache.h"
 #include "vm/runner.h"
 #include "vm/runner_builder.h"
 #include "vm/transform.h"
@@ -114,16 +115,34 @@ bool SqlCompiler::Compile(SqlContext& ctx, Status& status) {  // NOLINT
         LOG(WARNING) << status;
         return false;
     }
-    if (!jit->OptModule(m.get())) {
-        LOG(WARNING) << "fail to opt ir module for sql " << ctx.sql;
-        return false;
-    }
-    if (keep_ir_) {
-        KeepIR(ctx, m.get());
+    // load the object compiled before if any, keep_ir_ needs the optimized module
+    auto object_cache = jit->GetObjectCache();
+    bool object_loaded = false;
+    if (object_cache != nullptr && !keep_ir_) {
+        auto key = JitObjectCache::GetKey(*m);
+        auto object = object_cache->Lookup(key);
+        if (object) {
+            object_loaded = jit->AddObject(std::move(object));
+            if (!object_loaded) {
+                LOG(WARNING) << "fail to add cached object " << key << " for sql " << ctx.sql;
+                object_cache->Erase(key);
+            }
+        }
+        // the object is stored with the key once compiled
+        m->setModuleIdentifier(key);
     }
-    if (!jit->AddModule(std::move(m), std::move(llvm_ctx))) {
-        LOG(WARNING) << "fail to add ir module  for sql " << ctx.sql;
-        return false;
+    if (!object_loaded) {
+        if (!jit->OptModule(m.get())) {
+            LOG(WARNING) << "fail to opt ir module for sql " << ctx.sql;
+            return false;
+        }
+        if (keep_ir_) {
+            KeepIR(ctx, m.get());
+        }
+        if (!jit->AddModule(std::move(m), std::move(llvm_ctx))) {
+            LOG(WARNING) << "fail to add ir module  for sql " << ctx.sql;
+            return false;
+        }
     }
     if (!ResolvePlanFnAddress(ctx.physical_plan, jit, status)) {
         return false;
@@ -277,6 +296,10 @@ bool SqlCompiler::BuildClusterJob(SqlContext& ctx, Status& status) {  // NOLINT
                                  ctx.is_cluster_optimized && is_request_mode,
                                  ctx.batch_request_info.common_column_indices,
                                  ctx.batch_request_info.common_node_set);
+    runner_builder.SetWindowAggCacheSize(ctx.window_agg_cache_size);
+    if (!is_request_mode) {
+        runner_builder.SetExecBatchSize(ctx.exec_batch_size);
+    }
     if (ctx.cluster_job == nullptr) {
         ctx.cluster_job = std::make_shared<ClusterJob>();
     }
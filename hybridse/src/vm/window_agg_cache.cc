@@ -0,0 +1,207 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/window_agg_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace hybridse {
+namespace vm {
+
+std::unique_ptr<WindowAggState> CreateWindowAggState(WindowAggKind kind, type::Type rep_type) {
+    switch (rep_type) {
+        case type::kInt16:
+            return std::make_unique<WindowAggStateImpl<int16_t>>(kind, rep_type);
+        case type::kDate:
+        case type::kInt32:
+            return std::make_unique<WindowAggStateImpl<int32_t>>(kind, rep_type);
+        case type::kTimestamp:
+        case type::kInt64:
+            return std::make_unique<WindowAggStateImpl<int64_t>>(kind, rep_type);
+        case type::kFloat:
+            return std::make_unique<WindowAggStateImpl<float>>(kind, rep_type);
+        case type::kDouble:
+            return std::make_unique<WindowAggStateImpl<double>>(kind, rep_type);
+        case type::kVarchar:
+            if (kind != kWindowAggMin && kind != kWindowAggMax) {
+                LOG(ERROR) << "Window agg state on kVarchar only support min/max";
+                return nullptr;
+            }
+            return std::make_unique<WindowAggStateImpl<std::string>>(kind, rep_type);
+        default:
+            LOG(ERROR) << "Not support for type " << Type_Name(rep_type);
+            return nullptr;
+    }
+}
+
+// the rows are copied into blocks growing from kMinRowsBlockSize to kMaxRowsBlockSize bytes,
+// a larger row takes a block of its own
+static constexpr size_t kMinRowsBlockSize = 4 * 1024;
+static constexpr size_t kMaxRowsBlockSize = 64 * 1024;
+
+struct WindowRowsState::Block {
+    explicit Block(size_t capacity) : buf(new int8_t[capacity]), capacity(capacity), used(0) {}
+
+    std::unique_ptr<int8_t[]> buf;
+    const size_t capacity;
+    size_t used;
+};
+
+void WindowRowsState::Push(int64_t ts, const Row& row) {
+    size_t size = row.size();
+    if (blocks_.empty() || blocks_.back()->capacity - blocks_.back()->used < size) {
+        size_t capacity = blocks_.empty() ? kMinRowsBlockSize
+                                          : std::min(kMaxRowsBlockSize, blocks_.back()->capacity * 2);
+        blocks_.push_back(std::make_shared<Block>(std::max(capacity, size)));
+    }
+    // the windows output before only read the bytes already used, so the block is appended in place
+    Block* block = blocks_.back().get();
+    int8_t* buf = block->buf.get() + block->used;
+    if (size > 0) {
+        memcpy(buf, row.buf(), size);
+    }
+    block->used += size;
+    rows_.push_back({ts, buf, size, block});
+}
+
+void WindowRowsState::Evict(int64_t start_ts) {
+    while (!rows_.empty() && rows_.front().ts < start_ts) {
+        rows_.pop_front();
+    }
+    // the windows output before keep the blocks dropped here until they are released
+    while (!blocks_.empty() && (rows_.empty() || blocks_.front().get() != rows_.front().block)) {
+        blocks_.pop_front();
+    }
+}
+
+void WindowRowsState::Reset() {
+    WindowState::Reset();
+    rows_.clear();
+    blocks_.clear();
+}
+
+void WindowRowsState::Output(WindowRowsTableHandler* table) const {
+    for (auto it = rows_.rbegin(); it != rows_.rend(); ++it) {
+        table->AddRow(it->ts, Row(base::RefCountedSlice::Create(const_cast<int8_t*>(it->buf), it->size)));
+    }
+    for (const auto& block : blocks_) {
+        table->AddBlock(block);
+    }
+}
+
+void UpdateWindowState(RowIterator* it, uint64_t put_cnt, uint64_t delete_cnt, int64_t start, int64_t end,
+                       WindowState* state, const std::function<void(int64_t, const Row&)>& push) {
+    // rows are iterated in descending order of ts, they are pushed into state in ascending order
+    std::vector<std::pair<int64_t, Row>> rows;
+    uint64_t newer_cnt = 0;
+    uint64_t end_ts_cnt = 0;
+    // a delete may remove any rows of the window, which the counts after last_end do not tell
+    bool rebuild = !state->IsValid() || end < state->end_ts() || start < state->start_ts() ||
+                   put_cnt < state->put_cnt() || delete_cnt != state->delete_cnt();
+    if (!rebuild) {
+        int64_t last_end = state->end_ts();
+        uint64_t last_end_cnt = 0;
+        it->SeekToFirst();
+        while (it->Valid()) {
+            int64_t ts = static_cast<int64_t>(it->GetKey());
+            if (ts < last_end) {
+                break;
+            }
+            if (ts > end) {
+                newer_cnt++;
+            } else if (ts > last_end) {
+                rows.emplace_back(ts, it->GetValue());
+                if (ts == end) {
+                    end_ts_cnt++;
+                }
+            } else {
+                last_end_cnt++;
+            }
+            it->Next();
+        }
+        if (end == last_end) {
+            end_ts_cnt = last_end_cnt;
+        }
+        // the rows put since the last update are all found after last_end, unless a late row is put
+        // before it, or rows at or after last_end are removed by gc. Rebuild in both cases
+        uint64_t found = newer_cnt + rows.size() + last_end_cnt;
+        if (last_end_cnt != state->end_ts_cnt() ||
+            found != state->newer_cnt() + state->end_ts_cnt() + (put_cnt - state->put_cnt())) {
+            rebuild = true;
+        }
+    }
+    if (rebuild) {
+        state->Reset();
+        rows.clear();
+        newer_cnt = 0;
+        end_ts_cnt = 0;
+        it->SeekToFirst();
+        while (it->Valid()) {
+            int64_t ts = static_cast<int64_t>(it->GetKey());
+            if (ts < start) {
+                break;
+            }
+            if (ts > end) {
+                newer_cnt++;
+            } else {
+                rows.emplace_back(ts, it->GetValue());
+                if (ts == end) {
+                    end_ts_cnt++;
+                }
+            }
+            it->Next();
+        }
+    }
+    for (auto row = rows.rbegin(); row != rows.rend(); ++row) {
+        push(row->first, row->second);
+    }
+    // the window start bound drives the expiry, the rows before it slide out
+    state->Evict(start);
+    state->SetRange(start, end, end_ts_cnt, newer_cnt, put_cnt, delete_cnt);
+    if (rebuild) {
+        return;
+    }
+    // rows expired by ttl gc are removed from the oldest one and are not counted as deletes, drop them from state
+    while (state->GetCount() > 0) {
+        int64_t first_ts = state->GetFirstTs();
+        it->Seek(first_ts);
+        if (it->Valid() && static_cast<int64_t>(it->GetKey()) == first_ts) {
+            break;
+        }
+        state->Evict(first_ts + 1);
+    }
+}
+
+std::shared_ptr<WindowAggStateCache::Entry> WindowAggStateCache::Get(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto value = cache_.get(key);
+    if (value) {
+        return value.get();
+    }
+    auto entry = std::make_shared<Entry>();
+    cache_.insert(key, entry);
+    return entry;
+}
+
+size_t WindowAggStateCache::GetSize() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return cache_.size();
+}
+
+}  // namespace vm
+}  // namespace hybridse
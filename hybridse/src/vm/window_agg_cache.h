@@ -0,0 +1,377 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_SRC_VM_WINDOW_AGG_CACHE_H_
+#define HYBRIDSE_SRC_VM_WINDOW_AGG_CACHE_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "boost/compute/detail/lru_cache.hpp"
+#include "vm/aggregator.h"
+#include "vm/mem_catalog.h"
+
+namespace hybridse {
+namespace vm {
+
+enum WindowAggKind {
+    kWindowAggSum,
+    kWindowAggCount,
+    kWindowAggAvg,
+    kWindowAggMin,
+    kWindowAggMax,
+};
+
+// WindowState keeps the window [start_ts, end_ts] of one partition key built from the rows of a segment, so
+// that the next request only reads the rows put after end_ts and evicts the rows older than its window start.
+// It remembers the put count and the delete count of the segment and the rows it held at and after end_ts. A row
+// put later with a ts not after end_ts, a late row, makes the put count grow more than the rows found after end_ts,
+// and a delete changes the delete count, the state is rebuilt in both cases, see UpdateWindowState.
+class WindowState {
+ public:
+    WindowState() {}
+    virtual ~WindowState() {}
+
+    bool IsValid() const { return valid_; }
+    int64_t start_ts() const { return start_ts_; }
+    int64_t end_ts() const { return end_ts_; }
+    // the count of rows with ts == end_ts in the segment, including the rows skipped for null or filter
+    uint64_t end_ts_cnt() const { return end_ts_cnt_; }
+    // the count of rows with ts > end_ts in the segment
+    uint64_t newer_cnt() const { return newer_cnt_; }
+    uint64_t put_cnt() const { return put_cnt_; }
+    uint64_t delete_cnt() const { return delete_cnt_; }
+
+    // mark the state covers [start_ts, end_ts]
+    void SetRange(int64_t start_ts, int64_t end_ts, uint64_t end_ts_cnt, uint64_t newer_cnt, uint64_t put_cnt,
+                  uint64_t delete_cnt) {
+        start_ts_ = start_ts;
+        end_ts_ = end_ts;
+        end_ts_cnt_ = end_ts_cnt;
+        newer_cnt_ = newer_cnt;
+        put_cnt_ = put_cnt;
+        delete_cnt_ = delete_cnt;
+        valid_ = true;
+    }
+
+    virtual void Reset() {
+        valid_ = false;
+        start_ts_ = 0;
+        end_ts_ = 0;
+        end_ts_cnt_ = 0;
+        newer_cnt_ = 0;
+        put_cnt_ = 0;
+        delete_cnt_ = 0;
+    }
+
+    // remove the values with ts < start_ts
+    virtual void Evict(int64_t start_ts) = 0;
+    // return the ts of the oldest value, -1 if empty
+    virtual int64_t GetFirstTs() const = 0;
+    virtual size_t GetCount() const = 0;
+
+ protected:
+    bool valid_ = false;
+    int64_t start_ts_ = 0;
+    int64_t end_ts_ = 0;
+    uint64_t end_ts_cnt_ = 0;
+    uint64_t newer_cnt_ = 0;
+    uint64_t put_cnt_ = 0;
+    uint64_t delete_cnt_ = 0;
+};
+
+// WindowAggState keeps the partial aggregate of the window.
+// sum/count/avg are invertible and updated by add/subtract, min/max keep a monotonic deque.
+class WindowAggState : public WindowState {
+ public:
+    explicit WindowAggState(WindowAggKind kind) : kind_(kind) {}
+    ~WindowAggState() override {}
+
+    WindowAggKind kind() const { return kind_; }
+
+    // merge the aggregate of the state into aggregator
+    virtual void Output(BaseAggregator* aggregator) const = 0;
+
+    // representative type of the values, same as the aggregator created for the window
+    virtual type::Type GetRepType() const = 0;
+
+ protected:
+    WindowAggKind kind_;
+};
+
+template <class T>
+class WindowAggStateImpl : public WindowAggState {
+ public:
+    WindowAggStateImpl(WindowAggKind kind, type::Type rep_type) : WindowAggState(kind), rep_type_(rep_type) {}
+    ~WindowAggStateImpl() override {}
+
+    // values must be pushed in ascending order of ts
+    void Push(int64_t ts, const T& val) {
+        values_.push_back({ts, val});
+        switch (kind_) {
+            case kWindowAggSum:
+            case kWindowAggAvg:
+                AddSum(val);
+                break;
+            case kWindowAggMin:
+                while (!extremes_.empty() && !(extremes_.back().val < val)) {
+                    extremes_.pop_back();
+                }
+                extremes_.push_back({ts, val});
+                break;
+            case kWindowAggMax:
+                while (!extremes_.empty() && !(val < extremes_.back().val)) {
+                    extremes_.pop_back();
+                }
+                extremes_.push_back({ts, val});
+                break;
+            default:
+                break;
+        }
+    }
+
+    void Evict(int64_t start_ts) override {
+        while (!values_.empty() && values_.front().ts < start_ts) {
+            if (kind_ == kWindowAggSum || kind_ == kWindowAggAvg) {
+                SubSum(values_.front().val);
+            }
+            values_.pop_front();
+        }
+        while (!extremes_.empty() && extremes_.front().ts < start_ts) {
+            extremes_.pop_front();
+        }
+    }
+
+    int64_t GetFirstTs() const override { return values_.empty() ? -1 : values_.front().ts; }
+    size_t GetCount() const override { return values_.size(); }
+
+    void Output(BaseAggregator* aggregator) const override {
+        if (values_.empty()) {
+            return;
+        }
+        switch (kind_) {
+            case kWindowAggCount:
+                AggregatorUpdate(aggregator, static_cast<int64_t>(values_.size()));
+                break;
+            case kWindowAggSum:
+                OutputSum(aggregator);
+                break;
+            case kWindowAggAvg:
+                OutputAvg(aggregator);
+                break;
+            case kWindowAggMin:
+            case kWindowAggMax:
+                AggregatorUpdate(aggregator, extremes_.front().val);
+                break;
+            default:
+                break;
+        }
+    }
+
+    type::Type GetRepType() const override { return rep_type_; }
+
+    void Reset() override {
+        WindowAggState::Reset();
+        values_.clear();
+        extremes_.clear();
+        sum_ = T();
+        evicted_cnt_ = 0;
+    }
+
+ private:
+    struct Entry {
+        int64_t ts;
+        T val;
+    };
+
+    template <class TT = T>
+    void AddSum(const TT& val, std::enable_if_t<std::is_arithmetic<TT>{}>* = nullptr) {
+        sum_ += val;
+    }
+    template <class TT = T>
+    void AddSum(const TT& val, std::enable_if_t<!std::is_arithmetic<TT>{}>* = nullptr) {}
+
+    template <class TT = T>
+    void SubSum(const TT& val, std::enable_if_t<std::is_arithmetic<TT>{}>* = nullptr) {
+        if (std::is_floating_point<TT>::value) {
+            // recompute the sum once the evicted values outnumber the kept ones,
+            // so that the rounding error of subtraction does not accumulate
+            if (++evicted_cnt_ > values_.size()) {
+                evicted_cnt_ = 0;
+                sum_ = 0;
+                for (size_t i = 1; i < values_.size(); i++) {
+                    sum_ += values_[i].val;
+                }
+                return;
+            }
+        }
+        sum_ -= val;
+    }
+    template <class TT = T>
+    void SubSum(const TT& val, std::enable_if_t<!std::is_arithmetic<TT>{}>* = nullptr) {}
+
+    template <class TT = T>
+    void OutputSum(BaseAggregator* aggregator, std::enable_if_t<std::is_arithmetic<TT>{}>* = nullptr) const {
+        AggregatorUpdate(aggregator, sum_);
+    }
+    template <class TT = T>
+    void OutputSum(BaseAggregator* aggregator, std::enable_if_t<!std::is_arithmetic<TT>{}>* = nullptr) const {}
+
+    template <class TT = T>
+    void OutputAvg(BaseAggregator* aggregator, std::enable_if_t<std::is_arithmetic<TT>{}>* = nullptr) const {
+        auto avg_aggregator = dynamic_cast<AvgAggregator*>(aggregator);
+        if (avg_aggregator != nullptr) {
+            avg_aggregator->UpdateAvgValue(sum_, values_.size());
+        }
+    }
+    template <class TT = T>
+    void OutputAvg(BaseAggregator* aggregator, std::enable_if_t<!std::is_arithmetic<TT>{}>* = nullptr) const {}
+
+    type::Type rep_type_;
+    std::deque<Entry> values_;
+    // candidates of min/max, ts ascending and the first one is the result
+    std::deque<Entry> extremes_;
+    T sum_ = T();
+    size_t evicted_cnt_ = 0;
+};
+
+// create the state matching the aggregator which has rep_type as GetRepType()
+std::unique_ptr<WindowAggState> CreateWindowAggState(WindowAggKind kind, type::Type rep_type);
+
+template <class T>
+std::enable_if_t<std::is_arithmetic<T>{}> WindowAggStatePush(WindowAggState* state, int64_t ts, const T& val) {
+    switch (state->GetRepType()) {
+        case type::kInt16:
+            dynamic_cast<WindowAggStateImpl<int16_t>*>(state)->Push(ts, val);
+            break;
+        case type::kDate:
+        case type::kInt32:
+            dynamic_cast<WindowAggStateImpl<int32_t>*>(state)->Push(ts, val);
+            break;
+        case type::kTimestamp:
+        case type::kInt64:
+            dynamic_cast<WindowAggStateImpl<int64_t>*>(state)->Push(ts, val);
+            break;
+        case type::kFloat:
+            dynamic_cast<WindowAggStateImpl<float>*>(state)->Push(ts, val);
+            break;
+        case type::kDouble:
+            dynamic_cast<WindowAggStateImpl<double>*>(state)->Push(ts, val);
+            break;
+        default:
+            LOG(ERROR) << "ERROR: unsupport type " << Type_Name(state->GetRepType());
+            break;
+    }
+}
+
+template <class T>
+std::enable_if_t<!std::is_arithmetic<T>{}> WindowAggStatePush(WindowAggState* state, int64_t ts, const T& val) {
+    switch (state->GetRepType()) {
+        case type::kVarchar:
+            dynamic_cast<WindowAggStateImpl<std::string>*>(state)->Push(ts, val);
+            break;
+        default:
+            LOG(ERROR) << "ERROR: unsupport type " << Type_Name(state->GetRepType());
+            break;
+    }
+}
+
+class WindowRowsTableHandler;
+
+// WindowRowsState keeps the rows of the window for the plans whose aggregates are compiled, the window is read
+// from the state instead of the segment. The rows are copied into blocks, and a window output holds the blocks
+// of its rows, so it stays valid while a later request on the same key evicts them from the state. It saves the
+// reads of the segment only, the compiled aggregates still run over all rows of the window.
+class WindowRowsState : public WindowState {
+ public:
+    struct Block;
+
+    WindowRowsState() {}
+    ~WindowRowsState() override {}
+
+    // copy the first slice of row into the state, rows must be pushed in ascending order of ts
+    void Push(int64_t ts, const Row& row);
+
+    void Evict(int64_t start_ts) override;
+    int64_t GetFirstTs() const override { return rows_.empty() ? -1 : rows_.front().ts; }
+    size_t GetCount() const override { return rows_.size(); }
+    void Reset() override;
+
+    // add the rows to table in descending order of ts
+    void Output(WindowRowsTableHandler* table) const;
+
+ private:
+    struct Entry {
+        int64_t ts;
+        const int8_t* buf;
+        size_t size;
+        Block* block;
+    };
+
+    std::deque<Entry> rows_;
+    // the blocks of rows_ in order, the last one takes the new rows until it is full
+    std::deque<std::shared_ptr<Block>> blocks_;
+};
+
+// the window table output by WindowRowsState, the rows refer to the blocks it keeps
+class WindowRowsTableHandler : public MemTimeTableHandler {
+ public:
+    WindowRowsTableHandler() : MemTimeTableHandler() {}
+    ~WindowRowsTableHandler() override {}
+
+    void AddBlock(std::shared_ptr<const WindowRowsState::Block> block) { blocks_.push_back(std::move(block)); }
+
+ private:
+    std::vector<std::shared_ptr<const WindowRowsState::Block>> blocks_;
+};
+
+// bring state to the window [start, end] of the rows of a segment, it is rebuilt if it can not be advanced.
+// it iterates the segment in descending order of ts, put_cnt and delete_cnt are the counts of the segment read
+// before it. push is called with the rows not in the state in ascending order of ts
+void UpdateWindowState(RowIterator* it, uint64_t put_cnt, uint64_t delete_cnt, int64_t start, int64_t end,
+                       WindowState* state, const std::function<void(int64_t, const Row&)>& push);
+
+// WindowAggStateCache holds the window states of the most recently used partition keys.
+// The state of a key must be accessed with its mutex held, the requests on
+// different keys run in parallel.
+class WindowAggStateCache {
+ public:
+    struct Entry {
+        std::mutex mu;
+        std::unique_ptr<WindowState> state;
+    };
+
+    explicit WindowAggStateCache(uint32_t capacity) : cache_(capacity) {}
+
+    // get the entry of key, the state of a new entry is nullptr
+    std::shared_ptr<Entry> Get(const std::string& key);
+
+    size_t GetSize();
+
+ private:
+    std::mutex mu_;
+    boost::compute::detail::lru_cache<std::string, std::shared_ptr<Entry>> cache_;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+
+#endif  // HYBRIDSE_SRC_VM_WINDOW_AGG_CACHE_H_
@@ -0,0 +1,338 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/window_agg_cache.h"
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace hybridse {
+namespace vm {
+
+class WindowAggCacheTest : public ::testing::Test {
+ public:
+    void SetUp() override {
+        auto column = schema_.Add();
+        column->set_name("val");
+    }
+
+    void SetOutputType(type::Type type) { schema_.Mutable(0)->set_type(type); }
+
+    template <class T>
+    T GetOutput(BaseAggregator* aggregator) {
+        T val;
+        codec::RowView row_view(schema_);
+        auto row = aggregator->Output();
+        row_view.GetValue(row.buf(), 0, schema_.Get(0).type(), &val);
+        return val;
+    }
+
+    std::string GetStringOutput(BaseAggregator* aggregator) {
+        const char* val = nullptr;
+        uint32_t length = 0;
+        codec::RowView row_view(schema_);
+        auto row = aggregator->Output();
+        row_view.GetValue(row.buf(), 0, &val, &length);
+        return std::string(val, length);
+    }
+
+    bool IsNullOutput(BaseAggregator* aggregator) {
+        codec::RowView row_view(schema_);
+        auto row = aggregator->Output();
+        return row_view.IsNULL(row.buf(), 0);
+    }
+
+ protected:
+    codec::Schema schema_;
+};
+
+TEST_F(WindowAggCacheTest, Sum) {
+    SetOutputType(type::kInt64);
+    auto aggregator = MakeOverflowAggregator<SumAggregator>(type::kInt32, schema_);
+    auto state = CreateWindowAggState(kWindowAggSum, aggregator->GetRepType());
+    ASSERT_TRUE(state);
+    state->Output(aggregator.get());
+    ASSERT_TRUE(IsNullOutput(aggregator.get()));
+    for (int32_t i = 1; i <= 10; i++) {
+        WindowAggStatePush(state.get(), i * 10, i);
+    }
+    state->Output(aggregator.get());
+    ASSERT_EQ(55, GetOutput<int64_t>(aggregator.get()));
+    state->Evict(35);
+    ASSERT_EQ(40, state->GetFirstTs());
+    ASSERT_EQ(7u, state->GetCount());
+    state->Output(aggregator.get());
+    ASSERT_EQ(49, GetOutput<int64_t>(aggregator.get()));
+    state->Evict(200);
+    ASSERT_EQ(-1, state->GetFirstTs());
+    state->Output(aggregator.get());
+    ASSERT_TRUE(IsNullOutput(aggregator.get()));
+}
+
+TEST_F(WindowAggCacheTest, SumDouble) {
+    SetOutputType(type::kDouble);
+    auto aggregator = MakeOverflowAggregator<SumAggregator>(type::kDouble, schema_);
+    auto state = CreateWindowAggState(kWindowAggSum, aggregator->GetRepType());
+    ASSERT_TRUE(state);
+    for (int64_t i = 1; i <= 10000; i++) {
+        WindowAggStatePush(state.get(), i, 0.1 * i);
+        state->Evict(i - 9);
+        state->Output(aggregator.get());
+        double expect = 0;
+        for (int64_t j = std::max<int64_t>(1, i - 9); j <= i; j++) {
+            expect += 0.1 * j;
+        }
+        ASSERT_NEAR(expect, GetOutput<double>(aggregator.get()), 1e-6);
+    }
+}
+
+TEST_F(WindowAggCacheTest, CountAndAvg) {
+    SetOutputType(type::kInt64);
+    auto count_aggregator = std::make_unique<CountAggregator>(type::kInt32, schema_);
+    auto count_state = CreateWindowAggState(kWindowAggCount, count_aggregator->GetRepType());
+    ASSERT_TRUE(count_state);
+    for (int64_t i = 1; i <= 10; i++) {
+        WindowAggStatePush(count_state.get(), i, static_cast<int64_t>(1));
+    }
+    count_state->Evict(4);
+    count_state->Output(count_aggregator.get());
+    // the request row
+    AggregatorUpdate(count_aggregator.get(), static_cast<int64_t>(1));
+    ASSERT_EQ(8, GetOutput<int64_t>(count_aggregator.get()));
+
+    SetOutputType(type::kDouble);
+    auto avg_aggregator = std::make_unique<AvgAggregator>(type::kInt32, schema_);
+    auto avg_state = CreateWindowAggState(kWindowAggAvg, avg_aggregator->GetRepType());
+    ASSERT_TRUE(avg_state);
+    for (int32_t i = 1; i <= 10; i++) {
+        WindowAggStatePush(avg_state.get(), i, i);
+    }
+    avg_state->Evict(7);
+    avg_state->Output(avg_aggregator.get());
+    ASSERT_DOUBLE_EQ(8.5, GetOutput<double>(avg_aggregator.get()));
+}
+
+TEST_F(WindowAggCacheTest, MinMax) {
+    SetOutputType(type::kInt32);
+    std::vector<int32_t> vals = {5, 3, 8, 3, 9, 1, 7, 6, 2, 4};
+    auto min_aggregator = MakeSameTypeAggregator<MinAggregator>(type::kInt32, schema_);
+    auto max_aggregator = MakeSameTypeAggregator<MaxAggregator>(type::kInt32, schema_);
+    auto min_state = CreateWindowAggState(kWindowAggMin, min_aggregator->GetRepType());
+    auto max_state = CreateWindowAggState(kWindowAggMax, max_aggregator->GetRepType());
+    ASSERT_TRUE(min_state);
+    ASSERT_TRUE(max_state);
+    for (size_t i = 0; i < vals.size(); i++) {
+        WindowAggStatePush(min_state.get(), i, vals[i]);
+        WindowAggStatePush(max_state.get(), i, vals[i]);
+    }
+    for (size_t start = 0; start < vals.size(); start++) {
+        min_state->Evict(start);
+        max_state->Evict(start);
+        min_state->Output(min_aggregator.get());
+        max_state->Output(max_aggregator.get());
+        ASSERT_EQ(*std::min_element(vals.begin() + start, vals.end()), GetOutput<int32_t>(min_aggregator.get()));
+        ASSERT_EQ(*std::max_element(vals.begin() + start, vals.end()), GetOutput<int32_t>(max_aggregator.get()));
+    }
+}
+
+TEST_F(WindowAggCacheTest, MinMaxString) {
+    SetOutputType(type::kVarchar);
+    auto aggregator = MakeSameTypeAggregator<MaxAggregator>(type::kVarchar, schema_);
+    auto state = CreateWindowAggState(kWindowAggMax, aggregator->GetRepType());
+    ASSERT_TRUE(state);
+    WindowAggStatePush(state.get(), 1, std::string("c"));
+    WindowAggStatePush(state.get(), 2, std::string("a"));
+    WindowAggStatePush(state.get(), 3, std::string("b"));
+    state->Output(aggregator.get());
+    ASSERT_EQ("c", GetStringOutput(aggregator.get()));
+    state->Evict(2);
+    state->Output(aggregator.get());
+    ASSERT_EQ("b", GetStringOutput(aggregator.get()));
+    ASSERT_FALSE(CreateWindowAggState(kWindowAggSum, type::kVarchar));
+}
+
+TEST_F(WindowAggCacheTest, Reset) {
+    auto state = CreateWindowAggState(kWindowAggSum, type::kInt64);
+    ASSERT_FALSE(state->IsValid());
+    WindowAggStatePush(state.get(), 10, static_cast<int64_t>(1));
+    state->SetRange(5, 10, 1, 2, 3, 4);
+    ASSERT_TRUE(state->IsValid());
+    ASSERT_EQ(5, state->start_ts());
+    ASSERT_EQ(10, state->end_ts());
+    ASSERT_EQ(1u, state->end_ts_cnt());
+    ASSERT_EQ(2u, state->newer_cnt());
+    ASSERT_EQ(3u, state->put_cnt());
+    ASSERT_EQ(4u, state->delete_cnt());
+    state->Reset();
+    ASSERT_FALSE(state->IsValid());
+    ASSERT_EQ(0u, state->GetCount());
+}
+
+// the rows of a partition key in descending order of ts, the value of a row is its ts
+class TestSegment {
+ public:
+    void Put(int64_t ts) {
+        rows_.emplace(ts, std::to_string(ts));
+        put_cnt_++;
+    }
+    // gc
+    void Remove(int64_t ts) { rows_.erase(ts); }
+    void Delete(int64_t ts) {
+        rows_.erase(ts);
+        delete_cnt_++;
+    }
+    uint64_t GetPutCount() const { return put_cnt_; }
+    uint64_t GetDeleteCount() const { return delete_cnt_; }
+
+    std::unique_ptr<RowIterator> GetIterator() {
+        table_ = std::make_shared<MemTimeTableHandler>();
+        for (auto& row : rows_) {
+            table_->AddRow(row.first, Row(row.second));
+        }
+        return table_->GetIterator();
+    }
+
+ private:
+    std::multimap<int64_t, std::string, std::greater<int64_t>> rows_;
+    uint64_t put_cnt_ = 0;
+    uint64_t delete_cnt_ = 0;
+    std::shared_ptr<MemTimeTableHandler> table_;
+};
+
+TEST_F(WindowAggCacheTest, UpdateWindowState) {
+    TestSegment segment;
+    WindowRowsState state;
+    uint64_t pushed = 0;
+    auto update = [&](int64_t start, int64_t end) {
+        auto it = segment.GetIterator();
+        UpdateWindowState(it.get(), segment.GetPutCount(), segment.GetDeleteCount(), start, end, &state,
+                          [&](int64_t ts, const Row& row) {
+                              pushed++;
+                              state.Push(ts, row);
+                          });
+    };
+    for (int64_t ts = 10; ts <= 100; ts += 10) {
+        segment.Put(ts);
+    }
+    update(50, 100);
+    ASSERT_EQ(6u, state.GetCount());
+    ASSERT_EQ(6u, pushed);
+    // only the rows put after the window end are read
+    segment.Put(110);
+    segment.Put(120);
+    update(60, 120);
+    ASSERT_EQ(7u, state.GetCount());
+    ASSERT_EQ(8u, pushed);
+    ASSERT_EQ(60, state.GetFirstTs());
+    // a late row rebuilds the state
+    segment.Put(95);
+    update(60, 120);
+    ASSERT_EQ(8u, state.GetCount());
+    ASSERT_EQ(16u, pushed);
+    // a row after the window end is pushed once the window reaches it
+    segment.Put(200);
+    update(70, 130);
+    ASSERT_EQ(7u, state.GetCount());
+    ASSERT_EQ(16u, pushed);
+    update(70, 200);
+    ASSERT_EQ(8u, state.GetCount());
+    ASSERT_EQ(17u, pushed);
+    // the rows removed by gc are dropped from the state
+    segment.Remove(70);
+    segment.Remove(80);
+    update(70, 200);
+    ASSERT_EQ(6u, state.GetCount());
+    ASSERT_EQ(90, state.GetFirstTs());
+    ASSERT_EQ(17u, pushed);
+    // a row put with the same ts as the window end rebuilds the state
+    segment.Put(200);
+    update(70, 200);
+    ASSERT_EQ(7u, state.GetCount());
+    ASSERT_EQ(24u, pushed);
+    // a delete of a row inside the window, neither the oldest nor after the window end, rebuilds the state
+    segment.Delete(100);
+    update(70, 200);
+    ASSERT_EQ(6u, state.GetCount());
+    ASSERT_EQ(30u, pushed);
+    update(70, 200);
+    ASSERT_EQ(30u, pushed);
+    // the window moving backwards rebuilds the state
+    update(10, 100);
+    ASSERT_EQ(8u, state.GetCount());
+    ASSERT_EQ(10, state.GetFirstTs());
+    ASSERT_EQ(38u, pushed);
+}
+
+TEST_F(WindowAggCacheTest, RowsState) {
+    WindowRowsState state;
+    std::vector<std::string> vals;
+    for (int64_t ts = 1; ts <= 1000; ts++) {
+        vals.push_back(std::string(ts % 100 + 1, 'a' + ts % 26));
+    }
+    for (int64_t ts = 1; ts <= 1000; ts++) {
+        state.Push(ts, Row(vals[ts - 1]));
+    }
+    auto window = std::make_shared<WindowRowsTableHandler>();
+    state.Output(window.get());
+    ASSERT_EQ(1000u, window->GetCount());
+    // the rows evicted stay valid in the window output before
+    state.Evict(900);
+    ASSERT_EQ(101u, state.GetCount());
+    for (int64_t ts = 1001; ts <= 2000; ts++) {
+        state.Push(ts, Row(vals[ts % 1000]));
+    }
+    auto it = window->GetIterator();
+    it->SeekToFirst();
+    for (int64_t ts = 1000; ts >= 1; ts--) {
+        ASSERT_TRUE(it->Valid());
+        ASSERT_EQ(static_cast<uint64_t>(ts), it->GetKey());
+        const Row& row = it->GetValue();
+        ASSERT_EQ(vals[ts - 1], std::string(reinterpret_cast<char*>(row.buf()), row.size()));
+        it->Next();
+    }
+    ASSERT_FALSE(it->Valid());
+    state.Reset();
+    ASSERT_EQ(0u, state.GetCount());
+    ASSERT_EQ(-1, state.GetFirstTs());
+}
+
+TEST_F(WindowAggCacheTest, Cache) {
+    WindowAggStateCache cache(2);
+    auto entry = cache.Get("key1");
+    ASSERT_TRUE(entry);
+    ASSERT_FALSE(entry->state);
+    entry->state = CreateWindowAggState(kWindowAggCount, type::kInt64);
+    ASSERT_EQ(entry.get(), cache.Get("key1").get());
+    cache.Get("key2");
+    cache.Get("key3");
+    ASSERT_EQ(2u, cache.GetSize());
+    // key1 is evicted, the entry in use is still valid
+    ASSERT_TRUE(entry->state);
+    ASSERT_FALSE(cache.Get("key1")->state);
+}
+
+}  // namespace vm
+}  // namespace hybridse
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
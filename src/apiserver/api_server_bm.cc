@@ -0,0 +1,147 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gflags/gflags.h>
+
+#include <memory>
+#include <string>
+
+#include "apiserver/api_server_impl.h"
+#include "benchmark/benchmark.h"
+#include "brpc/channel.h"
+#include "brpc/server.h"
+#include "sdk/mini_cluster.h"
+#include "test/util.h"
+
+DECLARE_int32(zk_session_timeout);
+
+namespace openmldb::apiserver {
+
+const char* kDB = "api_server_bm";
+const char* kTable = "t1";
+const int kApiServerPort = 8085;
+
+brpc::Channel* http_channel;
+
+// put one row per request with the json api
+static void BM_PutJson(benchmark::State& state) {  // NOLINT
+    int64_t row_cnt = 0;
+    for (auto _ : state) {
+        for (int i = 0; i < state.range(0); i++) {
+            brpc::Controller cntl;
+            cntl.http_request().set_method(brpc::HTTP_METHOD_PUT);
+            cntl.http_request().uri() =
+                "http://127.0.0.1:" + std::to_string(kApiServerPort) + "/dbs/" + kDB + "/tables/" + kTable;
+            cntl.request_attachment().append("{\"value\": [[\"k" + std::to_string(i % 100) + "\", " +
+                                             std::to_string(i) + ", " + std::to_string(1620471840256 + row_cnt) +
+                                             "]]}");
+            http_channel->CallMethod(NULL, &cntl, NULL, NULL, NULL);
+            if (cntl.Failed()) {
+                state.SkipWithError(cntl.ErrorText().c_str());
+                return;
+            }
+            row_cnt++;
+        }
+    }
+    state.SetItemsProcessed(row_cnt);
+}
+
+// put all the rows in one request with the rows api
+static void BM_PutRows(benchmark::State& state) {  // NOLINT
+    int64_t row_cnt = 0;
+    for (auto _ : state) {
+        brpc::Controller cntl;
+        cntl.http_request().set_method(brpc::HTTP_METHOD_PUT);
+        cntl.http_request().uri() =
+            "http://127.0.0.1:" + std::to_string(kApiServerPort) + "/dbs/" + kDB + "/tables/" + kTable + "/rows";
+        for (int i = 0; i < state.range(0); i++) {
+            cntl.request_attachment().append("[\"k" + std::to_string(i % 100) + "\", " + std::to_string(i) + ", " +
+                                             std::to_string(1620471840256 + row_cnt) + "]\n");
+            row_cnt++;
+        }
+        http_channel->CallMethod(NULL, &cntl, NULL, NULL, NULL);
+        if (cntl.Failed()) {
+            state.SkipWithError(cntl.ErrorText().c_str());
+            return;
+        }
+    }
+    state.SetItemsProcessed(row_cnt);
+}
+
+BENCHMARK(BM_PutJson)->Unit(benchmark::kMillisecond)->Args({1000})->Args({10000});
+BENCHMARK(BM_PutRows)->Unit(benchmark::kMillisecond)->Args({1000})->Args({10000});
+
+}  // namespace openmldb::apiserver
+
+int main(int argc, char** argv) {
+    ::google::ParseCommandLineFlags(&argc, &argv, true);
+    ::hybridse::vm::Engine::InitializeGlobalLLVM();
+    ::openmldb::test::InitRandomDiskFlags("api_server_bm");
+    FLAGS_zk_session_timeout = 100000;
+    ::benchmark::Initialize(&argc, argv);
+    if (::benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+
+    ::openmldb::sdk::MiniCluster mc(6181);
+    if (!mc.SetUp()) {
+        return 1;
+    }
+    auto cluster_options = std::make_shared<::openmldb::sdk::SQLRouterOptions>();
+    cluster_options->zk_cluster = mc.GetZkCluster();
+    cluster_options->zk_path = mc.GetZkPath();
+    // owned by the api server
+    auto cluster_sdk = new ::openmldb::sdk::ClusterSDK(cluster_options);
+    if (!cluster_sdk->Init()) {
+        return 1;
+    }
+    ::openmldb::apiserver::APIServerImpl api_server("127.0.0.1:8010");
+    if (!api_server.Init(cluster_sdk)) {
+        return 1;
+    }
+    brpc::Server server;
+    brpc::ServerOptions server_options;
+    if (server.AddService(&api_server, brpc::SERVER_DOESNT_OWN_SERVICE, "/* => Process") != 0 ||
+        server.Start(::openmldb::apiserver::kApiServerPort, &server_options) != 0) {
+        return 1;
+    }
+
+    ::openmldb::sdk::SQLRouterOptions sql_opt;
+    sql_opt.zk_cluster = mc.GetZkCluster();
+    sql_opt.zk_path = mc.GetZkPath();
+    auto router = ::openmldb::sdk::NewClusterSQLRouter(sql_opt);
+    hybridse::sdk::Status status;
+    router->CreateDB(::openmldb::apiserver::kDB, &status);
+    if (!router->ExecuteDDL(::openmldb::apiserver::kDB,
+                            std::string("create table ") + ::openmldb::apiserver::kTable +
+                                "(c1 string, c3 int, c7 timestamp, index(key=c1, ts=c7));",
+                            &status)) {
+        return 1;
+    }
+    cluster_sdk->Refresh();
+
+    brpc::Channel channel;
+    brpc::ChannelOptions options;
+    options.protocol = "http";
+    options.timeout_ms = 60000;
+    if (channel.Init("127.0.0.1", ::openmldb::apiserver::kApiServerPort, &options) != 0) {
+        return 1;
+    }
+    ::openmldb::apiserver::http_channel = &channel;
+    ::benchmark::RunSpecifiedBenchmarks();
+
+    server.Stop(0);
+    server.Join();
+    mc.Close();
+}
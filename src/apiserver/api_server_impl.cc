@@ -26,10 +26,43 @@
 #include "absl/cleanup/cleanup.h"
 #include "brpc/server.h"
 #include "butil/time.h"
+#include "gflags/gflags.h"
+
+DECLARE_uint32(apiserver_put_batch_size);
+DECLARE_uint64(apiserver_put_rows_max_body_size);
 
 namespace openmldb {
 namespace apiserver {
 
+// IOBufStream is a rapidjson input stream over the blocks of an IOBuf, so the body is parsed without being copied
+// into a string first
+class IOBufStream {
+ public:
+    typedef char Ch;
+    explicit IOBufStream(const butil::IOBuf& buf) : it_(buf), pos_(0) {}
+    Ch Peek() const { return it_.bytes_left() > 0 ? *it_ : '\0'; }
+    Ch Take() {
+        if (it_.bytes_left() == 0) {
+            return '\0';
+        }
+        Ch c = *it_;
+        ++it_;
+        ++pos_;
+        return c;
+    }
+    size_t Tell() const { return pos_; }
+
+    // the stream is read only
+    Ch* PutBegin() { return nullptr; }
+    void Put(Ch) {}
+    void Flush() {}
+    size_t PutEnd(Ch*) { return 0; }
+
+ private:
+    butil::IOBufBytesIterator it_;
+    size_t pos_;
+};
+
 std::string PrintJsonValue(const Value& v) {
     if (v.IsNull()) {
         return "null";
@@ -83,6 +116,7 @@ bool APIServerImpl::Init(::openmldb::sdk::DBSDK* cluster) {
     sql_router_ = std::move(router);
     RegisterQuery();
     RegisterPut();
+    RegisterPutRows();
     RegisterExecSP();
     RegisterExecDeployment();
     RegisterGetSP();
@@ -446,6 +480,139 @@ void APIServerImpl::RegisterPut() {
     });
 }
 
+void APIServerImpl::RegisterPutRows() {
+    // put many rows in one request, the body is like `[1, "a"]\n[2, "b"]`
+    provider_.put("/dbs/:db_name/tables/:table_name/rows", [this](const InterfaceProvider::Params& param,
+                                                                  const butil::IOBuf& req_body, JsonWriter& writer) {
+        auto start = absl::Now();
+        absl::Cleanup method_latency = [this, start]() {
+            absl::Duration time = absl::Now() - start;
+            *md_recorder_.get_stats({"put_rows"}) << absl::ToInt64Microseconds(time);
+        };
+        auto db_it = param.find("db_name");
+        auto table_it = param.find("table_name");
+        if (db_it == param.end() || table_it == param.end()) {
+            writer << GeneralResp().Set("Invalid path");
+            return;
+        }
+        uint64_t put_cnt = 0;
+        std::vector<uint64_t> failed;
+        auto resp = PutRows(db_it->second, table_it->second, req_body, &put_cnt, &failed);
+        writer.StartObject();
+        writer.Member("code") & resp.code;
+        writer.Member("msg") & resp.msg;
+        writer.Member("data");
+        writer.StartObject();
+        writer.Member("rows") & put_cnt;
+        writer.Member("failed");
+        writer.StartArray();
+        for (auto row : failed) {
+            writer& row;
+        }
+        writer.EndArray();
+        writer.EndObject();
+        writer.EndObject();
+    });
+}
+
+GeneralResp APIServerImpl::PutRows(const std::string& db, const std::string& table, const butil::IOBuf& body,
+                                   uint64_t* put_cnt, std::vector<uint64_t>* failed) {
+    auto resp = GeneralResp();
+    // brpc has read the whole body before the handler runs, so its size is bounded here
+    if (body.size() > FLAGS_apiserver_put_rows_max_body_size) {
+        return resp.Set(absl::StrCat("request body size ", body.size(), " is larger than ",
+                                     FLAGS_apiserver_put_rows_max_body_size));
+    }
+    auto table_info = cluster_sdk_->GetTableInfo(db, table);
+    if (!table_info) {
+        return resp.Set("Table not found");
+    }
+    std::string holders;
+    for (int i = 0; i < table_info->column_desc_size(); ++i) {
+        holders += ((i == 0) ? "?" : ",?");
+    }
+    std::string insert_placeholder = "insert into " + table + " values(" + holders + ");";
+    hybridse::sdk::Status status;
+    std::shared_ptr<sdk::SQLInsertRows> rows;
+    // the number of the first row of rows in the body
+    uint64_t first_row = 1;
+    // the failed rows are noted and the next batches are still put, put_status keeps the error of the last failure
+    hybridse::sdk::Status put_status;
+    auto flush = [&]() {
+        if (!rows || rows->GetCnt() == 0) {
+            return;
+        }
+        std::vector<uint32_t> fails;
+        if (!sql_router_->ExecuteInsert(db, insert_placeholder, rows, &fails, &status)) {
+            put_status = status;
+            if (fails.empty()) {
+                for (uint32_t i = 0; i < rows->GetCnt(); ++i) {
+                    fails.push_back(i);
+                }
+            }
+        }
+        *put_cnt += rows->GetCnt() - fails.size();
+        for (auto pos : fails) {
+            failed->push_back(first_row + pos);
+        }
+        first_row += rows->GetCnt();
+        rows.reset();
+    };
+    // the rows before a malformed row are put, the rows after it are not read
+    auto malformed = [&](const std::string& msg) {
+        flush();
+        return resp.Set(msg);
+    };
+    IOBufStream is(body);
+    JsonRowStream<IOBufStream> stream(&is);
+    while (stream.Next()) {
+        if (!rows) {
+            rows = sql_router_->GetInsertRows(db, insert_placeholder, &status);
+            if (!rows) {
+                return resp.Set(status.code, status.msg);
+            }
+        }
+        const auto& arr = stream.GetRow();
+        auto schema = rows->GetSchema();
+        auto cnt = schema->GetColumnCnt();
+        if (cnt != static_cast<int>(arr.Size())) {
+            return malformed(absl::StrCat("row ", stream.GetRowCnt(), ": column size != schema size"));
+        }
+        decltype(arr.Size()) str_len_sum = 0;
+        for (int i = 0; i < cnt; ++i) {
+            if (!arr[i].IsNull() && schema->GetColumnType(i) == hybridse::sdk::kTypeString) {
+                if (!arr[i].IsString()) {
+                    return malformed(absl::StrCat("row ", stream.GetRowCnt(), ": value is not string for col ",
+                                                  schema->GetColumnName(i)));
+                }
+                str_len_sum += arr[i].GetStringLength();
+            }
+        }
+        auto row = rows->NewRow();
+        row->Init(static_cast<int>(str_len_sum));
+        for (int i = 0; i < cnt; ++i) {
+            if (!AppendJsonValue(arr[i], schema->GetColumnType(i), schema->IsColumnNotNull(i), row)) {
+                // the row is not complete, it is dropped from the batch
+                rows->RemoveLast();
+                return malformed(absl::StrCat("row ", stream.GetRowCnt(), ": convertion failed on col ",
+                                              schema->GetColumnName(i), "[", schema->GetColumnType(i),
+                                              "] with value ", PrintJsonValue(arr[i])));
+            }
+        }
+        if (rows->GetCnt() >= FLAGS_apiserver_put_batch_size) {
+            flush();
+        }
+    }
+    if (!stream.status().ok()) {
+        return malformed(std::string(stream.status().message()));
+    }
+    flush();
+    if (!failed->empty()) {
+        return resp.Set(put_status.code, absl::StrCat(failed->size(), " rows failed to put, ", put_status.msg));
+    }
+    return resp;
+}
+
 void APIServerImpl::RegisterExecDeployment() {
     provider_.post("/dbs/:db_name/deployments/:sp_name",
                    std::bind(&APIServerImpl::ExecuteProcedure, this, false, std::placeholders::_1,
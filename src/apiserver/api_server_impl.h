@@ -60,6 +60,7 @@ class APIServerImpl : public APIServer {
  private:
     void RegisterQuery();
     void RegisterPut();
+    void RegisterPutRows();
     void RegisterExecSP();
     void RegisterExecDeployment();
     void RegisterGetSP();
@@ -71,6 +72,12 @@ class APIServerImpl : public APIServer {
     void ExecuteProcedure(bool has_common_col, const InterfaceProvider::Params& param, const butil::IOBuf& req_body,
                           JsonWriter& writer);  // NOLINT
 
+    // put the rows of body, each row is a json array of the column values, in batches. The number of rows put
+    // successfully is returned in put_cnt and the numbers of the rows failed to put, from 1, in failed. The rows
+    // after a malformed row are not put
+    GeneralResp PutRows(const std::string& db, const std::string& table, const butil::IOBuf& body,
+                        uint64_t* put_cnt, std::vector<uint64_t>* failed);
+
     static absl::Status JsonArray2SQLRequestRow(const Value& non_common_cols_v, const Value& common_cols_v,
                                                 std::shared_ptr<openmldb::sdk::SQLRequestRow> row);
     static absl::Status JsonMap2SQLRequestRow(const Value& non_common_cols_v, const Value& common_cols_v,
@@ -31,6 +31,7 @@
 
 DEFINE_int32(zk_port, 6181, "zk port");
 DEFINE_string(api_server_port, "8084", "api server port");
+DECLARE_uint64(apiserver_put_rows_max_body_size);
 
 namespace openmldb::apiserver {
 
@@ -653,6 +654,81 @@ TEST_F(APIServerTest, validPut) {
     ASSERT_TRUE(env->cluster_remote->ExecuteDDL(env->db, "drop table " + table + ";", &status)) << status.msg;
 }
 
+TEST_F(APIServerTest, putRows) {
+    const auto env = APIServerTestEnv::Instance();
+
+    std::string table = "put_rows";
+    std::string ddl = "create table if not exists " + table + "(c1 string, c3 int, c7 timestamp, index(key=c1, ts=c7));";
+    hybridse::sdk::Status status;
+    ASSERT_TRUE(env->cluster_remote->ExecuteDDL(env->db, ddl, &status)) << status.msg;
+    ASSERT_TRUE(env->cluster_sdk->Refresh());
+
+    std::vector<int64_t> failed;
+    auto put_rows = [&](const std::string& body, int* code, std::string* msg, int64_t* rows) {
+        brpc::Controller cntl;
+        cntl.http_request().set_method(brpc::HTTP_METHOD_PUT);
+        cntl.http_request().uri() = env->api_server_url + "/dbs/" + env->db + "/tables/" + table + "/rows";
+        cntl.request_attachment().append(body);
+        env->http_channel.CallMethod(NULL, &cntl, NULL, NULL, NULL);
+        ASSERT_FALSE(cntl.Failed()) << cntl.ErrorText();
+        rapidjson::Document document;
+        ASSERT_FALSE(document.Parse(cntl.response_attachment().to_string().c_str()).HasParseError());
+        *code = document["code"].GetInt();
+        *msg = document["msg"].GetString();
+        *rows = document["data"]["rows"].GetInt64();
+        failed.clear();
+        for (const auto& row : document["data"]["failed"].GetArray()) {
+            failed.push_back(row.GetInt64());
+        }
+    };
+
+    // more rows than the batch size, they are put in several batches
+    int row_cnt = 2500;
+    std::string body;
+    for (int i = 0; i < row_cnt; i++) {
+        body.append("[\"k" + std::to_string(i % 10) + "\", " + std::to_string(i) + ", " +
+                    std::to_string(1620471840256 + i) + "]\n");
+    }
+    int code = 0;
+    std::string msg;
+    int64_t rows = 0;
+    put_rows(body, &code, &msg, &rows);
+    ASSERT_EQ(0, code) << msg;
+    ASSERT_EQ(row_cnt, rows);
+    ASSERT_TRUE(failed.empty());
+
+    std::string select_all = "select * from " + table + ";";
+    auto rs = env->cluster_remote->ExecuteSQL(env->db, select_all, &status);
+    ASSERT_TRUE(rs) << "fail to execute sql";
+    ASSERT_EQ(row_cnt, rs->Size());
+
+    // the rows before the invalid one are put
+    put_rows("[\"a\", 1, 1620471840256]\n[\"b\", 2, \"foo\"]\n[\"c\", 3, 1620471840258]", &code, &msg, &rows);
+    ASSERT_EQ(-1, code);
+    ASSERT_EQ(1, rows);
+    ASSERT_TRUE(failed.empty());
+    ASSERT_STREQ("row 2: convertion failed on col c7[8] with value foo", msg.c_str());
+
+    put_rows("[\"a\", 1]", &code, &msg, &rows);
+    ASSERT_EQ(-1, code);
+    ASSERT_STREQ("row 1: column size != schema size", msg.c_str());
+
+    put_rows("[\"a\", [1], 1620471840256]", &code, &msg, &rows);
+    ASSERT_EQ(-1, code);
+
+    put_rows("[\"a\", 1, 1620471840256", &code, &msg, &rows);
+    ASSERT_EQ(-1, code);
+
+    // the body is buffered as a whole, a larger one is rejected
+    FLAGS_apiserver_put_rows_max_body_size = 16;
+    put_rows("[\"a\", 1, 1620471840256]", &code, &msg, &rows);
+    FLAGS_apiserver_put_rows_max_body_size = 64 * 1024 * 1024;
+    ASSERT_EQ(-1, code);
+    ASSERT_EQ(0, rows);
+
+    ASSERT_TRUE(env->cluster_remote->ExecuteDDL(env->db, "drop table " + table + ";", &status)) << status.msg;
+}
+
 TEST_F(APIServerTest, putCase1) {
     const auto env = APIServerTestEnv::Instance();
 
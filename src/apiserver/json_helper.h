@@ -18,9 +18,13 @@
 #define SRC_APISERVER_JSON_HELPER_H_
 
 #include <cstddef>
+#include <memory>
 #include <string>
 
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "rapidjson/document.h"  // rapidjson's DOM-style API
+#include "rapidjson/reader.h"    // rapidjson's SAX-style API
 #include "rapidjson/writer.h"
 
 namespace openmldb {
@@ -141,6 +145,104 @@ class JsonWriter {
     void* stream_;  ///< Stream buffer.
 };
 
+/// Reads the rows of a body like `[1, "a"]\n[2, "b"]`, each row is a json array of the column values and the rows
+/// are separated by whitespaces. It is a SAX parser over the input stream, only the current row is kept in memory, so
+/// the body is never parsed into a whole document.
+template <typename InputStream>
+class JsonRowStream {
+ public:
+    explicit JsonRowStream(InputStream* is)
+        : is_(is),
+          buffer_(new char[kBufferSize]),
+          allocator_(buffer_.get(), kBufferSize),
+          row_(rapidjson::kArrayType),
+          handler_(this) {}
+
+    /// Read the next row, return false at the end of the stream or on error, see status().
+    bool Next() {
+        // the values of the previous row are released with the allocator
+        row_.SetArray();
+        allocator_.Clear();
+        rapidjson::SkipWhitespace(*is_);
+        if (!status_.ok() || is_->Peek() == '\0') {
+            return false;
+        }
+        row_cnt_++;
+        depth_ = 0;
+        reader_.Parse<rapidjson::kParseNanAndInfFlag | rapidjson::kParseStopWhenDoneFlag>(*is_, handler_);
+        if (reader_.HasParseError()) {
+            if (status_.ok()) {
+                status_ = absl::InvalidArgumentError(
+                    absl::StrCat("row ", row_cnt_, " parse failed, error code ",
+                                 static_cast<int>(reader_.GetParseErrorCode()), ", offset ", reader_.GetErrorOffset()));
+            }
+            return false;
+        }
+        return true;
+    }
+
+    /// The current row, an array of the column values.
+    const Value& GetRow() const { return row_; }
+    /// The number of rows read, it is the 1-based index of the current row.
+    uint64_t GetRowCnt() const { return row_cnt_; }
+    const absl::Status& status() const { return status_; }
+
+ private:
+    static constexpr size_t kBufferSize = 64 * 1024;
+
+    struct Handler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, Handler> {
+        explicit Handler(JsonRowStream* s) : stream(s) {}
+        bool Null() { return stream->Add(Value()); }
+        bool Bool(bool b) { return stream->Add(Value(b)); }
+        bool Int(int i) { return stream->Add(Value(i)); }
+        bool Uint(unsigned u) { return stream->Add(Value(u)); }
+        bool Int64(int64_t i) { return stream->Add(Value(i)); }
+        bool Uint64(uint64_t u) { return stream->Add(Value(u)); }
+        bool Double(double d) { return stream->Add(Value(d)); }
+        bool String(const char* str, SizeType len, bool) { return stream->Add(Value(str, len, stream->allocator_)); }
+        bool StartArray() {
+            if (stream->depth_++ > 0) {
+                return stream->Fail("nested array is not a column value");
+            }
+            return true;
+        }
+        bool EndArray(SizeType) {
+            stream->depth_--;
+            return true;
+        }
+        bool StartObject() { return stream->Fail("object is not a column value"); }
+        // unreachable since objects are rejected at the start
+        bool Key(const char*, SizeType, bool) { return false; }
+        bool EndObject(SizeType) { return false; }
+        bool RawNumber(const char*, SizeType, bool) { return false; }
+
+        JsonRowStream* stream;
+    };
+
+    bool Add(Value&& v) {
+        if (depth_ != 1) {
+            return Fail("row is not an array");
+        }
+        row_.PushBack(v, allocator_);
+        return true;
+    }
+
+    bool Fail(const std::string& msg) {
+        status_ = absl::InvalidArgumentError(absl::StrCat("row ", row_cnt_, ": ", msg));
+        return false;
+    }
+
+    InputStream* is_;
+    std::unique_ptr<char[]> buffer_;
+    rapidjson::MemoryPoolAllocator<> allocator_;
+    rapidjson::Reader reader_;
+    Value row_;
+    Handler handler_;
+    int depth_ = 0;
+    uint64_t row_cnt_ = 0;
+    absl::Status status_;
+};
+
 template <typename T>
 JsonReader& operator>>(JsonReader& ar, T& s) {
     return ar & s;
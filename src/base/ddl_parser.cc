@@ -298,7 +298,15 @@ bool DDLParser::ExtractInfosFromProjectPlan(hybridse::node::ProjectPlanNode* pro
 
             // extract filter column from condition expr
             std::string filter_col;
-            if (agg_expr->GetChildNum() == 2) {
+            if (agg_expr->GetChildNum() == 2 && (aggr_name == "topn_frequency" || aggr_name == "percentile")) {
+                // the second arg of topn_frequency (the top n) and percentile (the percentage) is constant,
+                // the pre-aggr table keeps the frequency of keys or the t-digest, so tables are shared by
+                // different constants
+                if (agg_expr->GetChild(1)->GetExprType() != hybridse::node::kExprPrimary) {
+                    DLOG(ERROR) << "second arg of " << aggr_name << " should be constant";
+                    return false;
+                }
+            } else if (agg_expr->GetChildNum() == 2) {
                 auto cond_expr = agg_expr->GetChild(1);
                 if (cond_expr->GetExprType() != hybridse::node::kExprBinary) {
                     DLOG(ERROR) << "long window only support binary expr on single column";
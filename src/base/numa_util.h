@@ -0,0 +1,150 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_BASE_NUMA_UTIL_H_
+#define SRC_BASE_NUMA_UTIL_H_
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+
+namespace openmldb::base {
+
+// NumaTopology is the numa nodes of the machine and their cpus read from sysfs, it does not depend on libnuma.
+// A machine without numa support is one node with all the cpus
+class NumaTopology {
+ public:
+    static const NumaTopology& Get() {
+        static NumaTopology topology;
+        return topology;
+    }
+
+    uint32_t GetNodeCount() const { return node_cpus_.size(); }
+
+    const std::vector<int>& GetCpus(uint32_t node) const { return node_cpus_[node]; }
+
+    // the partitions of a table are spread over the nodes
+    uint32_t GetNodeOfPartition(uint32_t pid) const { return pid % node_cpus_.size(); }
+
+    // -1 if the cpu is unknown
+    int GetNodeOfCpu(int cpu) const {
+        return cpu >= 0 && static_cast<size_t>(cpu) < cpu_node_.size() ? cpu_node_[cpu] : -1;
+    }
+
+    // the node of the cpu the calling thread is running on
+    int GetCurrentNode() const {
+#if defined(__linux__)
+        return GetNodeOfCpu(sched_getcpu());
+#else
+        return -1;
+#endif
+    }
+
+    // restrict the calling thread to the cpus of node
+    bool PinCurrentThread(uint32_t node) const {
+#if defined(__linux__)
+        if (node >= node_cpus_.size()) {
+            return false;
+        }
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        for (int cpu : node_cpus_[node]) {
+            CPU_SET(cpu, &cpu_set);
+        }
+        return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+#else
+        return false;
+#endif
+    }
+
+    // prefer to place the pages of [addr, addr + len) on node, addr must be page aligned and the memory
+    // should not be touched before
+    static bool BindMemory(void* addr, size_t len, uint32_t node) {
+#if defined(__linux__) && defined(SYS_mbind)
+        constexpr int kMpolPreferred = 1;
+        if (node >= sizeof(uint64_t) * 8) {
+            return false;
+        }
+        uint64_t node_mask = 1ul << node;
+        return syscall(SYS_mbind, addr, len, kMpolPreferred, &node_mask, sizeof(node_mask) * 8, 0) == 0;
+#else
+        return false;
+#endif
+    }
+
+    // parse the cpu list format of sysfs, e.g. 0-23,48-71
+    static bool ParseCpuList(absl::string_view str, std::vector<int>* cpus) {
+        for (absl::string_view range : absl::StrSplit(str, ',', absl::SkipWhitespace())) {
+            std::vector<absl::string_view> bounds = absl::StrSplit(range, '-');
+            int begin = 0;
+            int end = 0;
+            if (bounds.size() > 2 || !absl::SimpleAtoi(bounds[0], &begin) ||
+                !absl::SimpleAtoi(bounds.back(), &end) || begin > end) {
+                return false;
+            }
+            for (int cpu = begin; cpu <= end; cpu++) {
+                cpus->push_back(cpu);
+            }
+        }
+        return true;
+    }
+
+ private:
+    NumaTopology() {
+        for (uint32_t node = 0;; node++) {
+            std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            std::string line;
+            std::vector<int> cpus;
+            if (!file || !std::getline(file, line) || !ParseCpuList(line, &cpus)) {
+                break;
+            }
+            node_cpus_.push_back(std::move(cpus));
+        }
+        if (node_cpus_.empty()) {
+            long cpu_cnt = sysconf(_SC_NPROCESSORS_CONF);  // NOLINT
+            node_cpus_.emplace_back();
+            for (int cpu = 0; cpu < cpu_cnt; cpu++) {
+                node_cpus_[0].push_back(cpu);
+            }
+        }
+        for (uint32_t node = 0; node < node_cpus_.size(); node++) {
+            for (int cpu : node_cpus_[node]) {
+                if (static_cast<size_t>(cpu) >= cpu_node_.size()) {
+                    cpu_node_.resize(cpu + 1, -1);
+                }
+                cpu_node_[cpu] = node;
+            }
+        }
+    }
+
+    std::vector<std::vector<int>> node_cpus_;
+    std::vector<int> cpu_node_;
+};
+
+}  // namespace openmldb::base
+
+#endif  // SRC_BASE_NUMA_UTIL_H_
@@ -22,8 +22,10 @@
 
 #include <atomic>
 #include <iostream>
+#include <new>
 
 #include "base/random.h"
+#include "base/slab_allocator.h"
 
 namespace openmldb {
 namespace base {
@@ -53,12 +55,46 @@ class Node {
         nexts_ = new std::atomic<Node<K, V>*>[height];
     }
 
+    // Create a node whose next pointers are placed right after it, so that a
+    // node costs a single allocation from the slab
+    static Node<K, V>* New(const K& key, V& value, uint8_t height, SlabAllocator* allocator) {  // NOLINT
+        if (allocator == nullptr) {
+            return new Node<K, V>(key, value, height);
+        }
+        void* mem = allocator->Allocate(AllocSize(height));
+        auto nexts = reinterpret_cast<std::atomic<Node<K, V>*>*>(reinterpret_cast<char*>(mem) + sizeof(Node<K, V>));
+        for (uint8_t i = 0; i < height; i++) {
+            new (&nexts[i]) std::atomic<Node<K, V>*>(nullptr);
+        }
+        return new (mem) Node<K, V>(key, value, height, nexts);
+    }
+
+    // Release the node created by New, allocator must be the same one
+    static void Delete(Node<K, V>* node, SlabAllocator* allocator) {
+        if (node == nullptr) {
+            return;
+        }
+        if (!node->inline_nexts_) {
+            delete node;
+            return;
+        }
+        uint8_t height = node->height_;
+        node->~Node();
+        allocator->Free(node, AllocSize(height));
+    }
+
     // Set the next node with memory barrier
     void SetNext(uint8_t level, Node<K, V>* node) {
         assert(level < height_ && level >= 0);
         nexts_[level].store(node, std::memory_order_release);
     }
 
+    // Set the next node only if it's still expected
+    bool CasNext(uint8_t level, Node<K, V>* expected, Node<K, V>* node) {
+        assert(level < height_ && level >= 0);
+        return nexts_[level].compare_exchange_strong(expected, node, std::memory_order_acq_rel);
+    }
+
     // Set the next node without memory barrier
     void SetNextNoBarrier(uint8_t level, Node<K, V>* node) {
         assert(level < height_ && level >= 0);
@@ -81,10 +117,23 @@ class Node {
 
     const K& GetKey() const { return key_; }
 
-    ~Node() { delete[] nexts_; }
+    ~Node() {
+        if (!inline_nexts_) {
+            delete[] nexts_;
+        }
+    }
+
+ private:
+    Node(const K& key, V& value, uint8_t height, std::atomic<Node<K, V>*>* nexts)  // NOLINT
+        : height_(height), inline_nexts_(true), key_(key), value_(value), nexts_(nexts) {}
+
+    static uint32_t AllocSize(uint8_t height) {
+        return sizeof(Node<K, V>) + height * sizeof(std::atomic<Node<K, V>*>);
+    }
 
  private:
     uint8_t const height_;
+    bool const inline_nexts_ = false;
     K const key_;
     V value_;
     std::atomic<Node<K, V>*>* nexts_;
@@ -110,7 +159,9 @@ class Skiplist {
     ~Skiplist() { delete head_; }
 
     // Insert need external synchronized
-    uint8_t Insert(const K& key, V& value) {  // NOLINT
+    // The node is allocated from allocator if it's not NULL. The allocator is not kept in the list to save
+    // memory, so the caller must pass the same one to Clear and Node::Delete
+    uint8_t Insert(const K& key, V& value, SlabAllocator* allocator = NULL) {  // NOLINT
         uint8_t height = RandomHeight();
         Node<K, V>* pre[MaxHeight];
         FindLessOrEqual(key, pre);
@@ -120,7 +171,7 @@ class Skiplist {
             }
             max_height_.store(height, std::memory_order_relaxed);
         }
-        Node<K, V>* node = NewNode(key, value, height);
+        Node<K, V>* node = Node<K, V>::New(key, value, height, allocator);
         if (pre[0]->GetNext(0) == NULL) {
             tail_.store(node, std::memory_order_release);
         }
@@ -131,6 +182,54 @@ class Skiplist {
         return height;
     }
 
+    // ConcurrentInsert can run with other ConcurrentInsert calls and readers at the same time, but
+    // Insert, Remove, Split, Clear and AddToFirst still need exclusive access.
+    // If unique is true and the key exists, nothing is inserted and the existing node is returned,
+    // otherwise the new node is returned and its height is set to height if it's not NULL
+    Node<K, V>* ConcurrentInsert(const K& key, V& value, SlabAllocator* allocator = NULL,  // NOLINT
+                                 bool unique = false, uint8_t* height = NULL) {
+        uint8_t node_height = RandomHeightConcurrently();
+        uint8_t max_height = GetMaxHeight();
+        while (node_height > max_height) {
+            if (max_height_.compare_exchange_weak(max_height, node_height, std::memory_order_relaxed)) {
+                max_height = node_height;
+                break;
+            }
+        }
+        Node<K, V>* pre[MaxHeight];
+        Node<K, V>* next[MaxHeight];
+        Node<K, V>* start = head_;
+        for (int level = max_height - 1; level >= 0; level--) {
+            FindSpliceForLevel(key, start, level, &pre[level], &next[level]);
+            start = pre[level];
+        }
+        if (unique && next[0] != NULL && compare_(next[0]->GetKey(), key) == 0) {
+            return next[0];
+        }
+        Node<K, V>* node = Node<K, V>::New(key, value, node_height, allocator);
+        for (uint8_t i = 0; i < node_height; i++) {
+            while (true) {
+                node->SetNextNoBarrier(i, next[i]);
+                if (pre[i]->CasNext(i, next[i], node)) {
+                    break;
+                }
+                // other writers changed the splice, nodes are never removed here so pre[i] is still valid
+                FindSpliceForLevel(key, pre[i], i, &pre[i], &next[i]);
+                if (i == 0 && unique && next[0] != NULL && compare_(next[0]->GetKey(), key) == 0) {
+                    Node<K, V>::Delete(node, allocator);
+                    return next[0];
+                }
+            }
+            if (i == 0 && next[0] == NULL) {
+                UpdateTail(node);
+            }
+        }
+        if (height != NULL) {
+            *height = node_height;
+        }
+        return node;
+    }
+
     bool IsEmpty() {
         if (head_->GetNextNoBarrier(0) == NULL) {
             return true;
@@ -269,7 +368,7 @@ class Skiplist {
     }
 
     // Need external synchronized
-    uint64_t Clear() {
+    uint64_t Clear(SlabAllocator* allocator = NULL) {
         uint64_t cnt = 0;
         Node<K, V>* node = head_->GetNext(0);
         // Unlink all next node
@@ -286,7 +385,7 @@ class Skiplist {
             for (uint8_t i = 0; i < tmp->Height(); i++) {
                 tmp->SetNextNoBarrier(i, NULL);
             }
-            delete tmp;
+            Node<K, V>::Delete(tmp, allocator);
         }
         return cnt;
     }
@@ -354,6 +453,8 @@ class Skiplist {
 
         uint32_t GetSize() { return list_->GetSize(); }
 
+        Node<K, V>* GetNode() const { return node_; }
+
      private:
         Node<K, V>* node_;
         Skiplist<K, V, Comparator>* const list_;
@@ -376,6 +477,41 @@ class Skiplist {
         return height;
     }
 
+    // rand_ is not thread safe, concurrent writers use their own generator
+    uint8_t RandomHeightConcurrently() {
+        static thread_local Random rand(
+            static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&rand) >> 4) ^ 0xdeadbeef);
+        uint8_t height = 1;
+        while (height < MaxHeight && (rand.Next() % Branch) == 0) {
+            height++;
+        }
+        return height;
+    }
+
+    // find pre and next at level so that key is after pre and not after next
+    void FindSpliceForLevel(const K& key, Node<K, V>* start, uint8_t level, Node<K, V>** pre, Node<K, V>** next) {
+        Node<K, V>* node = start;
+        while (true) {
+            Node<K, V>* candidate = node->GetNext(level);
+            if (!IsAfterNode(key, candidate)) {
+                *pre = node;
+                *next = candidate;
+                return;
+            }
+            node = candidate;
+        }
+    }
+
+    // the node was linked at the end of level 0, move tail_ forward unless a later node has been appended
+    void UpdateTail(Node<K, V>* node) {
+        Node<K, V>* tail = tail_.load(std::memory_order_acquire);
+        while (tail == NULL || compare_(node->GetKey(), tail->GetKey()) >= 0) {
+            if (tail_.compare_exchange_weak(tail, node, std::memory_order_acq_rel)) {
+                return;
+            }
+        }
+    }
+
     Node<K, V>* FindLessOrEqual(const K& key, Node<K, V>** nodes) {
         assert(nodes != NULL);
         Node<K, V>* node = head_;
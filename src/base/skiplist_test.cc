@@ -17,6 +17,7 @@
 #include "base/skiplist.h"
 
 #include <string>
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "base/slice.h"
@@ -663,6 +664,118 @@ TEST_F(SkiplistTest, Duplicate) {
     ASSERT_FALSE(it->Valid());
 }
 
+TEST_F(SkiplistTest, ConcurrentInsert) {
+    Comparator cmp;
+    for (auto height : vec) {
+        Skiplist<uint32_t, uint32_t, Comparator> sl(height, 4, cmp);
+        uint32_t thread_num = 8;
+        uint32_t key_num = 10000;
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < thread_num; i++) {
+            threads.emplace_back([&sl, i, thread_num, key_num] {
+                for (uint32_t key = i; key < key_num; key += thread_num) {
+                    uint32_t value = key;
+                    sl.ConcurrentInsert(key, value);
+                }
+            });
+        }
+        // readers keep iterating while the list is growing
+        std::atomic<bool> done(false);
+        std::thread reader([&sl, &done] {
+            while (!done.load(std::memory_order_relaxed)) {
+                std::unique_ptr<Skiplist<uint32_t, uint32_t, Comparator>::Iterator> it(sl.NewIterator());
+                it->SeekToFirst();
+                uint32_t last = 0;
+                bool first = true;
+                while (it->Valid()) {
+                    ASSERT_TRUE(first || it->GetKey() > last);
+                    last = it->GetKey();
+                    first = false;
+                    it->Next();
+                }
+            }
+        });
+        for (auto& t : threads) {
+            t.join();
+        }
+        done.store(true, std::memory_order_relaxed);
+        reader.join();
+        ASSERT_EQ(key_num, sl.GetSize());
+        std::unique_ptr<Skiplist<uint32_t, uint32_t, Comparator>::Iterator> it(sl.NewIterator());
+        it->SeekToFirst();
+        for (uint32_t key = 0; key < key_num; key++) {
+            ASSERT_TRUE(it->Valid());
+            ASSERT_EQ(key, it->GetKey());
+            ASSERT_EQ(key, it->GetValue());
+            it->Next();
+        }
+        ASSERT_FALSE(it->Valid());
+        ASSERT_EQ(key_num - 1, sl.GetLast()->GetKey());
+        for (uint32_t key = 0; key < key_num; key += 97) {
+            it->Seek(key);
+            ASSERT_TRUE(it->Valid());
+            ASSERT_EQ(key, it->GetKey());
+        }
+    }
+}
+
+TEST_F(SkiplistTest, ConcurrentInsertUnique) {
+    StrComparator cmp;
+    Skiplist<std::string, uint32_t, StrComparator> sl(12, 4, cmp);
+    uint32_t thread_num = 8;
+    uint32_t key_num = 1000;
+    std::vector<std::thread> threads;
+    std::atomic<uint32_t> inserted(0);
+    for (uint32_t i = 0; i < thread_num; i++) {
+        threads.emplace_back([&sl, &inserted, i, key_num] {
+            // all threads insert the same keys
+            for (uint32_t key = 0; key < key_num; key++) {
+                uint32_t value = i;
+                uint8_t height = 0;
+                auto node = sl.ConcurrentInsert("key" + std::to_string(key), value, NULL, true, &height);
+                if (node->GetValue() == i && height > 0) {
+                    inserted.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    ASSERT_EQ(key_num, sl.GetSize());
+    ASSERT_EQ(key_num, inserted.load());
+    ASSERT_EQ("key999", sl.GetLast()->GetKey());
+}
+
+TEST_F(SkiplistTest, ConcurrentInsertDuplicate) {
+    DescComparator cmp;
+    Skiplist<uint32_t, uint32_t, DescComparator> sl(12, 4, cmp);
+    uint32_t thread_num = 4;
+    uint32_t key_num = 2000;
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < thread_num; i++) {
+        threads.emplace_back([&sl, key_num] {
+            for (uint32_t key = 0; key < key_num; key++) {
+                uint32_t value = key;
+                sl.ConcurrentInsert(key / 2, value);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    ASSERT_EQ(key_num * thread_num, sl.GetSize());
+    ASSERT_EQ(0u, sl.GetLast()->GetKey());
+    Node<uint32_t, uint32_t>* node = sl.Split(key_num / 4);
+    uint32_t cnt = 0;
+    while (node != NULL) {
+        ASSERT_LE(node->GetKey(), key_num / 4);
+        cnt++;
+        node = node->GetNext(0);
+    }
+    ASSERT_EQ((key_num / 4 + 1) * 2 * thread_num, cnt);
+}
+
 }  // namespace base
 }  // namespace openmldb
 
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_BASE_SLAB_ALLOCATOR_H_
+#define SRC_BASE_SLAB_ALLOCATOR_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <new>
+#include <vector>
+
+#include "base/numa_util.h"
+#include "base/spinlock.h"
+
+namespace openmldb {
+namespace base {
+
+// SlabAllocator hands out memory from large chunks grouped by size class.
+// Freed blocks are kept in a per class free list and reused by the next
+// allocation of the same class, so memory released by gc will not fragment
+// the process heap. Chunks are only returned to the system when the allocator
+// is destroyed. Requests larger than kMaxSlabSize fall back to operator new.
+// It is thread safe, one allocator is expected to be shared by all the
+// segments which have the same segment index in a table.
+// If numa_node is not negative, the chunks are placed on that numa node
+class SlabAllocator {
+ public:
+    // classes are 16 bytes apart up to 512 bytes and then grow by 1/4
+    static constexpr uint32_t kAlign = 16;
+    static constexpr uint32_t kSmallLimit = 512;
+    static constexpr uint32_t kMaxSlabSize = 32 * 1024;
+    static constexpr uint32_t kChunkSize = 1024 * 1024;
+    // the header size of the owner tagged allocation
+    static constexpr uint32_t kOwnerSize = sizeof(void*);
+    static constexpr uint32_t kPageSize = 4096;
+
+    explicit SlabAllocator(int numa_node = -1) : numa_node_(numa_node), chunk_bytes_(0), used_bytes_(0) {
+        uint32_t size = kAlign;
+        while (size <= kMaxSlabSize) {
+            class_size_.push_back(size);
+            if (size < kSmallLimit) {
+                size += kAlign;
+            } else {
+                size = AlignUp(size + size / 4);
+            }
+        }
+        classes_.reset(new SizeClass[class_size_.size()]);
+    }
+
+    ~SlabAllocator() {
+        for (size_t i = 0; i < class_size_.size(); i++) {
+            for (char* chunk : classes_[i].chunks) {
+                if (numa_node_ < 0) {
+                    delete[] chunk;
+                } else {
+                    free(chunk);
+                }
+            }
+        }
+    }
+
+    SlabAllocator(const SlabAllocator&) = delete;
+    SlabAllocator& operator=(const SlabAllocator&) = delete;
+
+    void* Allocate(uint32_t size) {
+        uint32_t idx = ClassIndex(size);
+        if (idx >= class_size_.size()) {
+            used_bytes_.fetch_add(size, std::memory_order_relaxed);
+            return ::operator new(size);
+        }
+        SizeClass& cls = classes_[idx];
+        uint32_t block_size = class_size_[idx];
+        used_bytes_.fetch_add(block_size, std::memory_order_relaxed);
+        std::lock_guard<SpinMutex> lock(cls.mu);
+        if (cls.free_list != nullptr) {
+            FreeBlock* block = cls.free_list;
+            cls.free_list = block->next;
+            return block;
+        }
+        if (cls.cur == nullptr || cls.cur + block_size > cls.end) {
+            // big classes still get at least a few blocks per chunk
+            uint32_t chunk_size = std::max(kChunkSize, block_size * 8);
+            cls.cur = NewChunk(chunk_size);
+            cls.end = cls.cur + chunk_size;
+            cls.chunks.push_back(cls.cur);
+            chunk_bytes_.fetch_add(chunk_size, std::memory_order_relaxed);
+        }
+        void* result = cls.cur;
+        cls.cur += block_size;
+        return result;
+    }
+
+    // size must be the same as the one passed to Allocate
+    void Free(void* ptr, uint32_t size) {
+        if (ptr == nullptr) {
+            return;
+        }
+        uint32_t idx = ClassIndex(size);
+        if (idx >= class_size_.size()) {
+            used_bytes_.fetch_sub(size, std::memory_order_relaxed);
+            ::operator delete(ptr);
+            return;
+        }
+        SizeClass& cls = classes_[idx];
+        used_bytes_.fetch_sub(class_size_[idx], std::memory_order_relaxed);
+        auto block = reinterpret_cast<FreeBlock*>(ptr);
+        std::lock_guard<SpinMutex> lock(cls.mu);
+        block->next = cls.free_list;
+        cls.free_list = block;
+    }
+
+    // allocate size bytes and record the allocator in front of them, the memory
+    // can be released by FreeWithOwner without knowing which allocator owns it
+    char* AllocateWithOwner(uint32_t size) {
+        char* block = reinterpret_cast<char*>(Allocate(size + kOwnerSize));
+        *reinterpret_cast<SlabAllocator**>(block) = this;
+        return block + kOwnerSize;
+    }
+
+    static void FreeWithOwner(char* ptr, uint32_t size) {
+        if (ptr == nullptr) {
+            return;
+        }
+        char* block = ptr - kOwnerSize;
+        SlabAllocator* owner = *reinterpret_cast<SlabAllocator**>(block);
+        owner->Free(block, size + kOwnerSize);
+    }
+
+    // the bytes really consumed by a request of size
+    uint32_t GetBlockSize(uint32_t size) const {
+        uint32_t idx = ClassIndex(size);
+        return idx >= class_size_.size() ? size : class_size_[idx];
+    }
+
+    // bytes requested from the system
+    uint64_t GetChunkBytes() const { return chunk_bytes_.load(std::memory_order_relaxed); }
+
+    // bytes held by live allocations
+    uint64_t GetUsedBytes() const { return used_bytes_.load(std::memory_order_relaxed); }
+
+    int GetNumaNode() const { return numa_node_; }
+
+ private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct SizeClass {
+        SpinMutex mu;
+        FreeBlock* free_list = nullptr;
+        char* cur = nullptr;
+        char* end = nullptr;
+        std::vector<char*> chunks;
+    };
+
+    static uint32_t AlignUp(uint32_t size) { return (size + kAlign - 1) & ~(kAlign - 1); }
+
+    char* NewChunk(uint32_t size) {
+        if (numa_node_ < 0) {
+            return new char[size];
+        }
+        // the pages are bound before the first touch, so they are allocated on the node
+        size = (size + kPageSize - 1) & ~(kPageSize - 1);
+        char* chunk = reinterpret_cast<char*>(aligned_alloc(kPageSize, size));
+        if (chunk == nullptr) {
+            throw std::bad_alloc();
+        }
+        NumaTopology::BindMemory(chunk, size, numa_node_);
+        return chunk;
+    }
+
+    uint32_t ClassIndex(uint32_t size) const {
+        if (size <= kSmallLimit) {
+            return size == 0 ? 0 : (size - 1) / kAlign;
+        }
+        if (size > kMaxSlabSize) {
+            return class_size_.size();
+        }
+        return std::lower_bound(class_size_.begin(), class_size_.end(), size) - class_size_.begin();
+    }
+
+ private:
+    const int numa_node_;
+    std::vector<uint32_t> class_size_;
+    std::unique_ptr<SizeClass[]> classes_;
+    std::atomic<uint64_t> chunk_bytes_;
+    std::atomic<uint64_t> used_bytes_;
+};
+
+}  // namespace base
+}  // namespace openmldb
+
+#endif  // SRC_BASE_SLAB_ALLOCATOR_H_
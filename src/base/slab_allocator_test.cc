@@ -0,0 +1,182 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/slab_allocator.h"
+
+#include <cstring>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "base/skiplist.h"
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace base {
+
+class SlabAllocatorTest : public ::testing::Test {
+ public:
+    SlabAllocatorTest() {}
+    ~SlabAllocatorTest() {}
+};
+
+TEST_F(SlabAllocatorTest, BlockSize) {
+    SlabAllocator slab;
+    ASSERT_EQ(16u, slab.GetBlockSize(1));
+    ASSERT_EQ(16u, slab.GetBlockSize(16));
+    ASSERT_EQ(32u, slab.GetBlockSize(17));
+    ASSERT_EQ(512u, slab.GetBlockSize(512));
+    uint32_t size = slab.GetBlockSize(513);
+    ASSERT_GE(size, 513u);
+    ASSERT_LE(size, 513u + 513u / 4 + SlabAllocator::kAlign);
+    // large allocation is not rounded
+    ASSERT_EQ(SlabAllocator::kMaxSlabSize + 1, slab.GetBlockSize(SlabAllocator::kMaxSlabSize + 1));
+}
+
+TEST_F(SlabAllocatorTest, Reuse) {
+    SlabAllocator slab;
+    std::vector<void*> blocks;
+    for (int i = 0; i < 10000; i++) {
+        void* ptr = slab.Allocate(100);
+        memset(ptr, 0, 100);
+        blocks.push_back(ptr);
+    }
+    ASSERT_EQ(10000u * slab.GetBlockSize(100), slab.GetUsedBytes());
+    uint64_t chunk_bytes = slab.GetChunkBytes();
+    for (auto ptr : blocks) {
+        slab.Free(ptr, 100);
+    }
+    ASSERT_EQ(0u, slab.GetUsedBytes());
+    // sizes of the same class reuse the freed blocks
+    for (int i = 0; i < 10000; i++) {
+        blocks[i] = slab.Allocate(97);
+    }
+    ASSERT_EQ(chunk_bytes, slab.GetChunkBytes());
+    for (auto ptr : blocks) {
+        slab.Free(ptr, 97);
+    }
+    void* big = slab.Allocate(SlabAllocator::kMaxSlabSize * 2);
+    ASSERT_EQ(SlabAllocator::kMaxSlabSize * 2, slab.GetUsedBytes());
+    slab.Free(big, SlabAllocator::kMaxSlabSize * 2);
+    ASSERT_EQ(0u, slab.GetUsedBytes());
+}
+
+TEST_F(SlabAllocatorTest, Owner) {
+    SlabAllocator slab;
+    char* data = slab.AllocateWithOwner(10);
+    memcpy(data, "0123456789", 10);
+    ASSERT_EQ(slab.GetBlockSize(10 + SlabAllocator::kOwnerSize), slab.GetUsedBytes());
+    SlabAllocator::FreeWithOwner(data, 10);
+    ASSERT_EQ(0u, slab.GetUsedBytes());
+}
+
+TEST_F(SlabAllocatorTest, NumaNode) {
+    const auto& topology = NumaTopology::Get();
+    ASSERT_GE(topology.GetNodeCount(), 1u);
+    SlabAllocator slab(topology.GetNodeCount() - 1);
+    std::vector<char*> blocks;
+    for (int i = 0; i < 1000; i++) {
+        blocks.push_back(reinterpret_cast<char*>(slab.Allocate(SlabAllocator::kMaxSlabSize)));
+        memset(blocks.back(), i, SlabAllocator::kMaxSlabSize);
+    }
+    for (auto block : blocks) {
+        slab.Free(block, SlabAllocator::kMaxSlabSize);
+    }
+    ASSERT_EQ(0u, slab.GetUsedBytes());
+}
+
+TEST_F(SlabAllocatorTest, ParseCpuList) {
+    std::vector<int> cpus;
+    ASSERT_TRUE(NumaTopology::ParseCpuList("0-2,8,10-11\n", &cpus));
+    ASSERT_EQ(std::vector<int>({0, 1, 2, 8, 10, 11}), cpus);
+    ASSERT_FALSE(NumaTopology::ParseCpuList("3-1", &cpus));
+    ASSERT_FALSE(NumaTopology::ParseCpuList("a", &cpus));
+}
+
+TEST_F(SlabAllocatorTest, MultiThread) {
+    SlabAllocator slab;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&slab, t]() {
+            std::vector<char*> blocks;
+            for (int round = 0; round < 10; round++) {
+                for (int i = 0; i < 1000; i++) {
+                    uint32_t size = 8 + (i + t) % 300;
+                    char* ptr = reinterpret_cast<char*>(slab.Allocate(size));
+                    memset(ptr, t, size);
+                    blocks.push_back(ptr);
+                }
+                for (size_t i = 0; i < blocks.size(); i++) {
+                    slab.Free(blocks[i], 8 + (i + t) % 300);
+                }
+                blocks.clear();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(0u, slab.GetUsedBytes());
+}
+
+struct DescComparator {
+    int operator()(const uint64_t a, const uint64_t b) const {
+        if (a > b) {
+            return -1;
+        } else if (a == b) {
+            return 0;
+        }
+        return 1;
+    }
+};
+
+TEST_F(SlabAllocatorTest, SkiplistNode) {
+    SlabAllocator slab;
+    DescComparator cmp;
+    {
+        Skiplist<uint64_t, uint64_t, DescComparator> sl(12, 4, cmp);
+        for (uint64_t i = 0; i < 1000; i++) {
+            sl.Insert(i, i, &slab);
+        }
+        ASSERT_GT(slab.GetUsedBytes(), 0u);
+        Node<uint64_t, uint64_t>* node = sl.Split(500);
+        uint32_t cnt = 0;
+        while (node != nullptr) {
+            auto tmp = node;
+            node = node->GetNextNoBarrier(0);
+            Node<uint64_t, uint64_t>::Delete(tmp, &slab);
+            cnt++;
+        }
+        ASSERT_EQ(501u, cnt);
+        std::unique_ptr<Skiplist<uint64_t, uint64_t, DescComparator>::Iterator> it(sl.NewIterator());
+        it->SeekToFirst();
+        for (uint64_t i = 999; i > 500; i--) {
+            ASSERT_TRUE(it->Valid());
+            ASSERT_EQ(i, it->GetKey());
+            it->Next();
+        }
+        ASSERT_FALSE(it->Valid());
+        ASSERT_EQ(499u, sl.Clear(&slab));
+    }
+    ASSERT_EQ(0u, slab.GetUsedBytes());
+}
+
+}  // namespace base
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
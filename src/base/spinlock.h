@@ -30,6 +30,7 @@
 
 #pragma once
 #include <atomic>
+#include <cstdint>
 #include <thread>  // NOLINT
 
 namespace openmldb {
@@ -75,5 +76,65 @@ class SpinMutex {
     std::atomic<bool> locked_;
 };
 
+//
+//  SharedSpinMutex is a reader-writer SpinMutex in four bytes. A writer waiting for the readers to leave keeps
+//  the new readers out, so a stream of readers does not starve it. Method names are chosen so you can use
+//  std::shared_lock, std::unique_lock or std::lock_guard with it.
+//
+class SharedSpinMutex {
+ public:
+    SharedSpinMutex() : state_(0) {}
+
+    bool try_lock_shared() {
+        uint32_t state = state_.load(std::memory_order_relaxed);
+        return !(state & kWriter) &&
+               state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void lock_shared() {
+        for (size_t tries = 0;; ++tries) {
+            if (try_lock_shared()) {
+                break;
+            }
+            AsmVolatilePause();
+            if (tries > 100) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void unlock_shared() { state_.fetch_sub(1, std::memory_order_release); }
+
+    void lock() {
+        for (size_t tries = 0;; ++tries) {
+            uint32_t state = state_.load(std::memory_order_relaxed);
+            if (!(state & kWriter) &&
+                state_.compare_exchange_weak(state, state | kWriter, std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+                break;
+            }
+            AsmVolatilePause();
+            if (tries > 100) {
+                std::this_thread::yield();
+            }
+        }
+        // no reader comes in once the writer bit is set, wait for the ones inside
+        for (size_t tries = 0; state_.load(std::memory_order_acquire) != kWriter; ++tries) {
+            AsmVolatilePause();
+            if (tries > 100) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void unlock() { state_.store(0, std::memory_order_release); }
+
+ private:
+    static constexpr uint32_t kWriter = 1u << 31;
+
+    // the writer bit and the count of the readers
+    std::atomic<uint32_t> state_;
+};
+
 }  // namespace base
 }  // namespace openmldb
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_BASE_TOKEN_BUCKET_H_
+#define SRC_BASE_TOKEN_BUCKET_H_
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+
+namespace openmldb {
+namespace base {
+
+// A token bucket shared by the threads of one limit, a token is one unit such as a byte. Acquire takes the
+// tokens at once and sleeps until the bucket refills the debt, so a request larger than the burst is allowed
+// and the callers are served in the order they come. rate 0 means no limit.
+class TokenBucket {
+ public:
+    TokenBucket(uint64_t rate, uint64_t burst)
+        : rate_(rate), burst_(std::max<uint64_t>(burst, 1)), tokens_(burst_), last_time_(Clock::now()) {}
+    TokenBucket(const TokenBucket&) = delete;
+    TokenBucket& operator=(const TokenBucket&) = delete;
+
+    // return the microseconds slept
+    uint64_t Acquire(uint64_t n) {
+        uint64_t wait_us = 0;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            if (rate_ == 0) {
+                return 0;
+            }
+            auto now = Clock::now();
+            double elapsed_us = std::chrono::duration<double, std::micro>(now - last_time_).count();
+            last_time_ = now;
+            tokens_ = std::min(static_cast<double>(burst_), tokens_ + elapsed_us * rate_ / 1000000);
+            tokens_ -= n;
+            if (tokens_ < 0) {
+                wait_us = static_cast<uint64_t>(-tokens_ * 1000000 / rate_);
+            }
+        }
+        if (wait_us > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(wait_us));
+        }
+        return wait_us;
+    }
+
+    void SetRate(uint64_t rate) {
+        std::lock_guard<std::mutex> lock(mu_);
+        rate_ = rate;
+    }
+    uint64_t GetRate() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        return rate_;
+    }
+
+ private:
+    using Clock = std::chrono::steady_clock;
+
+    mutable std::mutex mu_;
+    uint64_t rate_;
+    const uint64_t burst_;
+    // negative when the tokens are owed by the sleeping callers
+    double tokens_;
+    Clock::time_point last_time_;
+};
+
+}  // namespace base
+}  // namespace openmldb
+
+#endif  // SRC_BASE_TOKEN_BUCKET_H_
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/token_bucket.h"
+
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace base {
+
+class TokenBucketTest : public ::testing::Test {
+ public:
+    TokenBucketTest() {}
+    ~TokenBucketTest() {}
+};
+
+static uint64_t ElapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+TEST_F(TokenBucketTest, NoLimit) {
+    TokenBucket bucket(0, 100);
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(0u, bucket.Acquire(1000000));
+    }
+}
+
+TEST_F(TokenBucketTest, Burst) {
+    TokenBucket bucket(1000, 500);
+    // the burst is taken without waiting
+    ASSERT_EQ(0u, bucket.Acquire(500));
+    // 200 tokens owed take 200ms
+    uint64_t wait_us = bucket.Acquire(200);
+    ASSERT_GT(wait_us, 150000u);
+    ASSERT_LT(wait_us, 250000u);
+}
+
+TEST_F(TokenBucketTest, Shared) {
+    // 4 threads share 10000 tokens per second, 2000 tokens in total take about 200ms
+    TokenBucket bucket(10000, 1);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&bucket] {
+            for (int i = 0; i < 10; i++) {
+                bucket.Acquire(50);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    uint64_t elapsed = ElapsedMs(start);
+    ASSERT_GE(elapsed, 180u);
+    ASSERT_LT(elapsed, 1000u);
+}
+
+TEST_F(TokenBucketTest, SetRate) {
+    TokenBucket bucket(1000, 1);
+    bucket.Acquire(1);
+    ASSERT_GT(bucket.Acquire(100), 50000u);
+    bucket.SetRate(0);
+    ASSERT_EQ(0u, bucket.GetRate());
+    ASSERT_EQ(0u, bucket.Acquire(100));
+}
+
+}  // namespace base
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -199,6 +199,38 @@ const uint64_t TabletTableHandler::GetCount() {
     return iter->Valid() ? iter->GetValue() : ::hybridse::codec::Row();
 }
 
+bool TabletTableHandler::KeyMayExist(const std::string& index_name, const std::string& key) {
+    const auto& index_hint = GetIndex();
+    auto iter = index_hint.find(index_name);
+    if (iter == index_hint.end() || partition_num_ == 0) {
+        return true;
+    }
+    auto tables = std::atomic_load_explicit(&tables_, std::memory_order_acquire);
+    // the same partition as DistributeWindowIterator seeks
+    uint32_t pid = static_cast<uint32_t>(::openmldb::base::hash64(key) % partition_num_);
+    auto table_iter = tables->find(pid);
+    if (table_iter == tables->end()) {
+        return true;
+    }
+    return table_iter->second->KeyMayExist(iter->second.index, key);
+}
+
+bool TabletTableHandler::GetPutCount(const std::string& index_name, const std::string& key, uint64_t* put_cnt,
+                                     uint64_t* delete_cnt) {
+    const auto& index_hint = GetIndex();
+    auto iter = index_hint.find(index_name);
+    if (iter == index_hint.end() || partition_num_ == 0) {
+        return false;
+    }
+    auto tables = std::atomic_load_explicit(&tables_, std::memory_order_acquire);
+    uint32_t pid = static_cast<uint32_t>(::openmldb::base::hash64(key) % partition_num_);
+    auto table_iter = tables->find(pid);
+    if (table_iter == tables->end()) {
+        return false;
+    }
+    return table_iter->second->GetPutCount(iter->second.index, key, *put_cnt, *delete_cnt) == 0;
+}
+
 std::shared_ptr<::hybridse::vm::PartitionHandler> TabletTableHandler::GetPartition(const std::string& index_name) {
     if (GetIndex().count(index_name) == 0) {
         LOG(WARNING) << "fail to get partition for tablet table handler, index name " << index_name;
@@ -615,7 +647,30 @@ void TabletCatalog::RefreshAggrTables(const std::vector<::hybridse::vm::AggrTabl
     atomic_store_explicit(&aggr_tables_, new_aggr_tables, std::memory_order_relaxed);
 }
 
+bool TabletPartitionHandler::KeyMayExist(const std::string& key) const {
+    auto table_handler = dynamic_cast<TabletTableHandler*>(table_handler_.get());
+    return table_handler == nullptr || table_handler->KeyMayExist(index_name_, key);
+}
+
+bool TabletPartitionHandler::GetPutCount(const std::string& key, uint64_t* put_cnt, uint64_t* delete_cnt) const {
+    auto table_handler = dynamic_cast<TabletTableHandler*>(table_handler_.get());
+    return table_handler != nullptr && table_handler->GetPutCount(index_name_, key, put_cnt, delete_cnt);
+}
+
+bool TabletSegmentHandler::KeyMayExist() const {
+    auto partition_handler = dynamic_cast<TabletPartitionHandler*>(partition_handler_.get());
+    return partition_handler == nullptr || partition_handler->KeyMayExist(key_);
+}
+
+bool TabletSegmentHandler::GetPutCount(uint64_t* put_cnt, uint64_t* delete_cnt) {
+    auto partition_handler = dynamic_cast<TabletPartitionHandler*>(partition_handler_.get());
+    return partition_handler != nullptr && partition_handler->GetPutCount(key_, put_cnt, delete_cnt);
+}
+
 std::unique_ptr<::hybridse::vm::RowIterator> TabletSegmentHandler::GetIterator() {
+    if (!KeyMayExist()) {
+        return std::unique_ptr<::hybridse::vm::RowIterator>();
+    }
     auto iter = partition_handler_->GetWindowIterator();
     if (iter) {
         DLOG(INFO) << "seek to pk " << key_;
@@ -630,6 +685,9 @@ std::unique_ptr<::hybridse::vm::RowIterator> TabletSegmentHandler::GetIterator()
 }
 
 ::hybridse::vm::RowIterator* TabletSegmentHandler::GetRawIterator() {
+    if (!KeyMayExist()) {
+        return nullptr;
+    }
     auto iter = partition_handler_->GetWindowIterator();
     if (iter) {
         DLOG(INFO) << "seek to pk " << key_;
@@ -69,6 +69,8 @@ class TabletSegmentHandler : public ::hybridse::vm::TableHandler {
 
     const uint64_t GetCount() override;
 
+    bool GetPutCount(uint64_t *put_cnt, uint64_t *delete_cnt) override;
+
     ::hybridse::vm::Row At(uint64_t pos) override {
         auto iter = GetIterator();
         if (!iter) return ::hybridse::vm::Row();
@@ -79,6 +81,10 @@ class TabletSegmentHandler : public ::hybridse::vm::TableHandler {
     }
     const std::string GetHandlerTypeName() override { return "TabletSegmentHandler"; }
 
+ private:
+    // false if the key filter of the local partition tells the key is absent
+    bool KeyMayExist() const;
+
  private:
     std::shared_ptr<::hybridse::vm::PartitionHandler> partition_handler_;
     std::string key_;
@@ -126,6 +132,10 @@ class TabletPartitionHandler : public ::hybridse::vm::PartitionHandler,
     }
     const std::string GetHandlerTypeName() override { return "TabletPartitionHandler"; }
 
+    bool KeyMayExist(const std::string &key) const;
+
+    bool GetPutCount(const std::string &key, uint64_t *put_cnt, uint64_t *delete_cnt) const;
+
  private:
     std::shared_ptr<::hybridse::vm::TableHandler> table_handler_;
     std::string index_name_;
@@ -170,6 +180,13 @@ class TabletTableHandler : public ::hybridse::vm::TableHandler,
     std::shared_ptr<::hybridse::vm::PartitionHandler> GetPartition(const std::string &index_name) override;
     const std::string GetHandlerTypeName() override { return "TabletTableHandler"; }
 
+    // false if key is surely absent in the index. the key in a remote partition may exist
+    bool KeyMayExist(const std::string &index_name, const std::string &key);
+
+    // the put count of key and the delete count in the local partition, false if the partition is remote or does
+    // not track them
+    bool GetPutCount(const std::string &index_name, const std::string &key, uint64_t *put_cnt, uint64_t *delete_cnt);
+
     std::shared_ptr<::hybridse::vm::Tablet> GetTablet(const std::string &index_name, const std::string &pk) override;
     std::shared_ptr<::hybridse::vm::Tablet> GetTablet(const std::string &index_name,
                                                       const std::vector<std::string> &pks) override;
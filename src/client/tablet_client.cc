@@ -50,7 +50,7 @@ TabletClient::~TabletClient() {}
 int TabletClient::Init() { return client_.Init(); }
 
 bool TabletClient::Query(const std::string& db, const std::string& sql, const std::string& row, brpc::Controller* cntl,
-                         openmldb::api::QueryResponse* response, const bool is_debug) {
+                         openmldb::api::QueryResponse* response, const bool is_debug, int32_t pid) {
     if (cntl == NULL || response == NULL) return false;
     ::openmldb::api::QueryRequest request;
     request.set_sql(sql);
@@ -59,6 +59,9 @@ bool TabletClient::Query(const std::string& db, const std::string& sql, const st
     request.set_is_debug(is_debug);
     request.set_row_size(row.size());
     request.set_row_slices(1);
+    if (pid >= 0) {
+        request.set_pid(pid);
+    }
     auto& io_buf = cntl->request_attachment();
     if (!codec::EncodeRpcRow(reinterpret_cast<const int8_t*>(row.data()), row.size(), &io_buf)) {
         LOG(WARNING) << "Encode row buffer failed";
@@ -244,6 +247,31 @@ base::Status TabletClient::Put(uint32_t tid, uint32_t pid, uint64_t time, const
     return {response.code(), response.msg()};
 }
 
+base::Status TabletClient::PutBatch(uint32_t tid, uint32_t pid,
+                                    ::google::protobuf::RepeatedPtrField<::openmldb::api::PutBatchRequest::Row>* rows,
+                                    bool put_if_absent, std::vector<base::Status>* row_status) {
+    ::openmldb::api::PutBatchRequest request;
+    request.set_tid(tid);
+    request.set_pid(pid);
+    request.mutable_rows()->Swap(rows);
+    request.set_put_if_absent(put_if_absent);
+    ::openmldb::api::PutBatchResponse response;
+    auto st = client_.SendRequestSt(&::openmldb::api::TabletServer_Stub::PutBatch, &request, &response,
+                                    FLAGS_request_timeout_ms, 1);
+    // give the rows back, so that the caller can retry them
+    rows->Swap(request.mutable_rows());
+    if (!st.OK()) {
+        return st;
+    }
+    if (row_status != nullptr) {
+        row_status->clear();
+        for (const auto& status : response.row_status()) {
+            row_status->emplace_back(status.code(), status.msg());
+        }
+    }
+    return {response.code(), response.msg()};
+}
+
 base::Status TabletClient::Put(uint32_t tid, uint32_t pid, const std::string& pk, uint64_t time,
                                const std::string& value) {
     ::openmldb::api::PutRequest request;
@@ -330,12 +358,15 @@ bool TabletClient::RecoverSnapshot(uint32_t tid, uint32_t pid, std::shared_ptr<T
 }
 
 bool TabletClient::SendSnapshot(uint32_t tid, uint32_t remote_tid, uint32_t pid, const std::string& endpoint,
-                                std::shared_ptr<TaskInfo> task_info) {
+                                std::shared_ptr<TaskInfo> task_info, const std::string& leader_endpoint) {
     ::openmldb::api::SendSnapshotRequest request;
     request.set_tid(tid);
     request.set_pid(pid);
     request.set_endpoint(endpoint);
     request.set_remote_tid(remote_tid);
+    if (!leader_endpoint.empty()) {
+        request.set_leader_endpoint(leader_endpoint);
+    }
     if (task_info) {
         request.mutable_task_info()->CopyFrom(*task_info);
     }
@@ -1195,7 +1226,7 @@ bool TabletClient::Scan(const ::openmldb::api::ScanRequest& request, brpc::Contr
 
 bool TabletClient::CallProcedure(const std::string& db, const std::string& sp_name, const base::Slice& row,
                                  brpc::Controller* cntl, openmldb::api::QueryResponse* response, bool is_debug,
-                                 uint64_t timeout_ms) {
+                                 uint64_t timeout_ms, int32_t pid) {
     if (cntl == NULL || response == NULL) return false;
     ::openmldb::api::QueryRequest request;
     request.set_sp_name(sp_name);
@@ -1205,6 +1236,9 @@ bool TabletClient::CallProcedure(const std::string& db, const std::string& sp_na
     request.set_is_procedure(true);
     request.set_row_size(row.size());
     request.set_row_slices(1);
+    if (pid >= 0) {
+        request.set_pid(pid);
+    }
     cntl->set_timeout_ms(timeout_ms);
     auto& io_buf = cntl->request_attachment();
     if (!codec::EncodeRpcRow(reinterpret_cast<const int8_t*>(row.data()), row.size(), &io_buf)) {
@@ -1359,7 +1393,7 @@ bool TabletClient::DropProcedure(const std::string& db_name, const std::string&
 
 bool TabletClient::CallProcedure(const std::string& db, const std::string& sp_name, const base::Slice& row,
                                  uint64_t timeout_ms, bool is_debug,
-                                 openmldb::RpcCallback<openmldb::api::QueryResponse>* callback) {
+                                 openmldb::RpcCallback<openmldb::api::QueryResponse>* callback, int32_t pid) {
     if (callback == nullptr) {
         return false;
     }
@@ -1371,6 +1405,9 @@ bool TabletClient::CallProcedure(const std::string& db, const std::string& sp_na
     request.set_is_procedure(true);
     request.set_row_size(row.size());
     request.set_row_slices(1);
+    if (pid >= 0) {
+        request.set_pid(pid);
+    }
     auto& io_buf = callback->GetController()->request_attachment();
     if (!codec::EncodeRpcRow(reinterpret_cast<const int8_t*>(row.data()), row.size(), &io_buf)) {
         LOG(WARNING) << "Encode row buf failed";
@@ -1381,6 +1418,30 @@ bool TabletClient::CallProcedure(const std::string& db, const std::string& sp_na
                                callback->GetResponse().get(), callback);
 }
 
+bool TabletClient::CallProcedures(const std::string& db, const std::vector<std::string>& sp_names,
+                                  const base::Slice& row, uint64_t timeout_ms, bool is_debug,
+                                  openmldb::RpcCallback<openmldb::api::MultiProcedureQueryResponse>* callback) {
+    if (callback == nullptr) {
+        return false;
+    }
+    ::openmldb::api::MultiProcedureQueryRequest request;
+    request.set_db(db);
+    for (const auto& sp_name : sp_names) {
+        request.add_sp_names(sp_name);
+    }
+    request.set_is_debug(is_debug);
+    request.set_row_size(row.size());
+    request.set_row_slices(1);
+    auto& io_buf = callback->GetController()->request_attachment();
+    if (!codec::EncodeRpcRow(reinterpret_cast<const int8_t*>(row.data()), row.size(), &io_buf)) {
+        LOG(WARNING) << "Encode row buf failed";
+        return false;
+    }
+    callback->GetController()->set_timeout_ms(timeout_ms);
+    return client_.SendRequest(&::openmldb::api::TabletServer_Stub::MultiProcedureQuery,
+                               callback->GetController().get(), &request, callback->GetResponse().get(), callback);
+}
+
 bool TabletClient::CallSQLBatchRequestProcedure(
     const std::string& db, const std::string& sp_name, std::shared_ptr<::openmldb::sdk::SQLRequestRowBatch> row_batch,
     bool is_debug, uint64_t timeout_ms, openmldb::RpcCallback<openmldb::api::SQLBatchRequestQueryResponse>* callback) {
@@ -68,8 +68,9 @@ class TabletClient : public Client {
                const std::vector<openmldb::type::DataType>& parameter_types, const std::string& parameter_row,
                brpc::Controller* cntl, ::openmldb::api::QueryResponse* response, const bool is_debug = false);
 
+    // pid is the partition the row is routed to, the tablet runs the query on the numa node of it
     bool Query(const std::string& db, const std::string& sql, const std::string& row, brpc::Controller* cntl,
-               ::openmldb::api::QueryResponse* response, const bool is_debug = false);
+               ::openmldb::api::QueryResponse* response, const bool is_debug = false, int32_t pid = -1);
 
     bool SQLBatchRequestQuery(const std::string& db, const std::string& sql,
                               std::shared_ptr<::openmldb::sdk::SQLRequestRowBatch>, brpc::Controller* cntl,
@@ -85,6 +86,12 @@ class TabletClient : public Client {
                      ::google::protobuf::RepeatedPtrField<::openmldb::api::Dimension>* dimensions,
                      int memory_usage_limit = 0, bool put_if_absent = false, bool check_exists = false);
 
+    // put the rows in one rpc, the rows are swapped into the request. row_status is set with the status of
+    // each row if the rpc succeeds, the returned status is the first failed one
+    base::Status PutBatch(uint32_t tid, uint32_t pid,
+                          ::google::protobuf::RepeatedPtrField<::openmldb::api::PutBatchRequest::Row>* rows,
+                          bool put_if_absent, std::vector<base::Status>* row_status);
+
     bool Get(uint32_t tid, uint32_t pid, const std::string& pk, uint64_t time, std::string& value,  // NOLINT
              uint64_t& ts,                                                                          // NOLINT
              std::string& msg);                                                                     // NOLINT
@@ -136,8 +143,10 @@ class TabletClient : public Client {
     bool MakeSnapshot(uint32_t tid, uint32_t pid, uint64_t offset,
                       std::shared_ptr<TaskInfo> task_info = std::shared_ptr<TaskInfo>());
 
+    // leader_endpoint is set when the table of this tablet is a follower
     bool SendSnapshot(uint32_t tid, uint32_t remote_tid, uint32_t pid, const std::string& endpoint,
-                      std::shared_ptr<TaskInfo> task_info = std::shared_ptr<TaskInfo>());
+                      std::shared_ptr<TaskInfo> task_info = std::shared_ptr<TaskInfo>(),
+                      const std::string& leader_endpoint = "");
 
     bool PauseSnapshot(uint32_t tid, uint32_t pid, std::shared_ptr<TaskInfo> task_info = std::shared_ptr<TaskInfo>());
 
@@ -227,7 +236,7 @@ class TabletClient : public Client {
 
     bool CallProcedure(const std::string& db, const std::string& sp_name, const base::Slice& row,
                        brpc::Controller* cntl, openmldb::api::QueryResponse* response, bool is_debug,
-                       uint64_t timeout_ms);
+                       uint64_t timeout_ms, int32_t pid = -1);
 
     bool CallSQLBatchRequestProcedure(const std::string& db, const std::string& sp_name,
                                       std::shared_ptr<::openmldb::sdk::SQLRequestRowBatch>, brpc::Controller* cntl,
@@ -254,7 +263,13 @@ class TabletClient : public Client {
     bool DropFunction(const ::openmldb::common::ExternalFun& fun, std::string* msg);
 
     bool CallProcedure(const std::string& db, const std::string& sp_name, const base::Slice& row, uint64_t timeout_ms,
-                       bool is_debug, openmldb::RpcCallback<openmldb::api::QueryResponse>* callback);
+                       bool is_debug, openmldb::RpcCallback<openmldb::api::QueryResponse>* callback,
+                       int32_t pid = -1);
+
+    // call the procedures on this tablet with one rpc, the row is sent once
+    bool CallProcedures(const std::string& db, const std::vector<std::string>& sp_names, const base::Slice& row,
+                        uint64_t timeout_ms, bool is_debug,
+                        openmldb::RpcCallback<openmldb::api::MultiProcedureQueryResponse>* callback);
 
     bool CallSQLBatchRequestProcedure(const std::string& db, const std::string& sp_name,
                                       std::shared_ptr<::openmldb::sdk::SQLRequestRowBatch> row_batch, bool is_debug,
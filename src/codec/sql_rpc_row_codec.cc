@@ -96,6 +96,54 @@ bool EncodeRpcRow(const hybridse::codec::Row& row, butil::IOBuf* buf, size_t* to
     return true;
 }
 
+bool EncodeRpcRow(hybridse::codec::Row* row, butil::IOBuf* buf, size_t* total_size) {
+    if (row == nullptr || buf == nullptr) {
+        return false;
+    }
+    *total_size = 0;
+    int32_t slice_num = row->GetRowPtrCnt();
+    for (int32_t i = 0; i < slice_num; ++i) {
+        size_t slice_size = row->size(i);
+        if (row->buf(i) == nullptr || slice_size == 0) {
+            char empty_header[6] = {1, 1, 0, 0, 0, 0};
+            if (buf->append(empty_header, 6) != 0) {
+                LOG(WARNING) << "Append " << i << "th empty slice failed";
+                return false;
+            }
+            *total_size += 6;
+        } else {
+            if (!AppendRpcSlice(row, i, buf)) {
+                return false;
+            }
+            *total_size += slice_size;
+        }
+    }
+    return true;
+}
+
+bool AppendRpcSlice(hybridse::codec::Row* row, int32_t pos, butil::IOBuf* buf) {
+    size_t size = row->size(pos);
+    int8_t* owned = size >= kMinZeroCopySliceSize ? row->TakeBuffer(pos) : nullptr;
+    if (owned == nullptr) {
+        if (buf->append(row->buf(pos), size) != 0) {
+            LOG(WARNING) << "Append " << pos << "th slice of size " << size << " failed";
+            return false;
+        }
+        return true;
+    }
+    // the managed buffers are allocated by malloc, see RefCountedSlice
+    if (buf->append_user_data(owned, size, free) == 0) {
+        return true;
+    }
+    int code = buf->append(owned, size);
+    free(owned);
+    if (code != 0) {
+        LOG(WARNING) << "Append " << pos << "th slice of size " << size << " failed";
+        return false;
+    }
+    return true;
+}
+
 bool EncodeRpcRow(const int8_t* buf, size_t size, butil::IOBuf* io_buf) {
     int code = io_buf->append(buf, size);
     if (code != 0) {
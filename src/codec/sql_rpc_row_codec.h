@@ -33,8 +33,18 @@ namespace codec {
 
 bool DecodeRpcRow(const butil::IOBuf& buf, size_t offset, size_t size, size_t slice_num, hybridse::codec::Row* row);
 
+// slices smaller than this are copied into the IOBuf, a user data block costs more than copying them
+constexpr size_t kMinZeroCopySliceSize = 1024;
+
 bool EncodeRpcRow(const hybridse::codec::Row& row, butil::IOBuf* buf, size_t* total_size);
 
+// Encode the row like above, except that the buffers the row solely owns are handed to buf without copying
+// and freed once buf and its copies release them. These slices of row are empty afterwards.
+bool EncodeRpcRow(hybridse::codec::Row* row, butil::IOBuf* buf, size_t* total_size);
+
+// Append the pos-th slice of row to buf without a header, the buffer is moved like EncodeRpcRow(Row*)
+bool AppendRpcSlice(hybridse::codec::Row* row, int32_t pos, butil::IOBuf* buf);
+
 bool EncodeRpcRow(const int8_t* buf, size_t size, butil::IOBuf* io_buf);
 
 }  // namespace codec
@@ -123,6 +123,57 @@ TEST_F(SqlRpcRowCodecTest, TestMultiSlice) {
     ASSERT_EQ(0, decoded.size(3));
 }
 
+TEST_F(SqlRpcRowCodecTest, TestMoveSlice) {
+    hybridse::codec::Schema schema;
+    InitSchema(&schema);
+    hybridse::codec::RowBuilder builder(schema);
+    std::string large_str(kMinZeroCopySliceSize, 'a');
+    auto build = [&](int32_t val, const std::string& str) {
+        size_t buf_size = builder.CalTotalLength(str.size());
+        int8_t* buf = reinterpret_cast<int8_t*>(malloc(buf_size));
+        builder.SetBuffer(buf, buf_size);
+        builder.AppendInt32(val);
+        builder.AppendFloat(3.14);
+        builder.AppendString(str.c_str(), str.size());
+        return hybridse::codec::RefCountedSlice::CreateManaged(buf, buf_size);
+    };
+    auto small = build(1, "hello");
+    auto large = build(2, large_str);
+    auto shared = build(3, large_str);
+    hybridse::codec::Row row(small);
+    row.Append(large);
+    row.Append(shared);
+    row.Append(hybridse::codec::RefCountedSlice());
+    int8_t* large_buf = large.buf();
+    size_t large_size = large.size();
+    small = hybridse::codec::RefCountedSlice();
+    large = hybridse::codec::RefCountedSlice();
+
+    butil::IOBuf iobuf;
+    size_t total_size;
+    size_t expect_size = row.size(0) + row.size(1) + row.size(2) + 6;
+    ASSERT_TRUE(EncodeRpcRow(&row, &iobuf, &total_size));
+    ASSERT_EQ(expect_size, total_size);
+    ASSERT_EQ(expect_size, iobuf.size());
+    // only the large slice the row solely owns is moved
+    ASSERT_EQ(nullptr, row.buf(1));
+    ASSERT_EQ(0, row.size(1));
+    ASSERT_NE(nullptr, row.buf(0));
+    ASSERT_EQ(shared.buf(), row.buf(2));
+    ASSERT_EQ(large_buf, reinterpret_cast<const int8_t*>(iobuf.backing_block(1).data()));
+    ASSERT_EQ(large_size, iobuf.backing_block(1).size());
+
+    hybridse::codec::Row decoded;
+    ASSERT_TRUE(DecodeRpcRow(iobuf, 0, total_size, 4, &decoded));
+    hybridse::codec::RowView row_view(schema);
+    for (int32_t i = 0; i < 3; i++) {
+        row_view.Reset(decoded.buf(i), decoded.size(i));
+        ASSERT_EQ(i + 1, row_view.GetInt32Unsafe(0));
+        ASSERT_EQ(i == 0 ? "hello" : large_str, row_view.GetStringUnsafe(2));
+    }
+    ASSERT_EQ(nullptr, decoded.buf(3));
+}
+
 }  // namespace codec
 }  // namespace openmldb
 
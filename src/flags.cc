@@ -46,6 +46,10 @@ DEFINE_string(zk_log_file, "", "CLI: set zk log file, empty means stderr(default
 DEFINE_string(host, "", "used in stand-alone mode, config the name server ip");
 DEFINE_int32(port, 0, "used in stand-alone mode, config the name server port");
 DEFINE_int32(request_timeout, 600000, "rpc request timeout of CLI, unit is milliseconds");
+DEFINE_uint32(apiserver_put_batch_size, 1000,
+              "config the max number of rows the apiserver puts to the tablets at a time when putting many rows");
+DEFINE_uint64(apiserver_put_rows_max_body_size, 64 * 1024 * 1024,
+              "config the max size in bytes of a request body putting many rows, the body is buffered as a whole");
 
 DEFINE_int32(get_task_status_interval, 2000, "config the interval of get task status. unit is milliseconds");
 DEFINE_uint32(get_table_status_interval, 2000, "config the interval of get table status. unit is milliseconds");
@@ -66,10 +70,30 @@ DEFINE_uint32(replica_num, 3, "config the default replica_num. if set 3, there i
 DEFINE_uint32(system_table_replica_num, 1, "config the default replica_num of system table.");
 DEFINE_int32(gc_interval, 120, "the gc interval of tablet every two hour");
 DEFINE_int32(disk_gc_interval, 120, "the rocksdb gc interval of tablet");
+DEFINE_bool(disk_gc_by_compaction, false,
+            "drop the rows of disk tables expired by the abs ttl by a compaction filter and compact the sst files "
+            "holding them, instead of iterating the tables to delete them. the indexes with a latest ttl are still "
+            "iterated");
+DEFINE_uint64(disk_periodic_compaction_seconds, 86400,
+              "with disk_gc_by_compaction, an sst file of a disk table not compacted for the seconds is compacted, "
+              "so the compaction filter drops the expired rows in it");
+DEFINE_double(disk_compact_expired_ratio, 0.3,
+              "with disk_gc_by_compaction, the gc compacts the sst files whose estimated expired rows are no less "
+              "than the ratio");
 DEFINE_int32(gc_pool_size, 2, "the size of tablet gc thread pool");
 DEFINE_int32(gc_safe_offset, 1, "the safe offset of tablet gc in minute");
 DEFINE_uint64(gc_on_table_recover_count, 10000000, "make a gc on recover count");
 DEFINE_uint32(gc_deleted_pk_version_delta, 2, "config the gc version delta");
+DEFINE_uint64(gc_slice_key_num, 0,
+              "the keys a slice of memtable gc visits in a segment before it pauses, 0 means no limit. gc is "
+              "incremental if it or gc_slice_time_ms is set");
+DEFINE_uint32(gc_slice_time_ms, 0,
+              "the time a slice of memtable gc runs in a segment before it pauses, 0 means no limit");
+DEFINE_uint32(gc_slice_interval_ms, 10, "the pause between two slices of incremental memtable gc in a segment");
+DEFINE_uint32(gc_round_time_ms, 0,
+              "the time a round of incremental memtable gc runs the slices of a table, the segments not finished "
+              "resume in the next round. 0 means a round runs until the segments finish");
+DEFINE_uint32(gc_segment_thread_num, 1, "the threads running the gc of the segments of a memtable index in parallel");
 DEFINE_double(mem_release_rate, 5, "specify memory release rate, which should be in 0 ~ 10");
 DEFINE_int32(task_pool_size, 3, "the size of tablet task thread pool");
 DEFINE_int32(io_pool_size, 2, "the size of tablet io task thread pool");
@@ -78,6 +102,12 @@ DEFINE_string(data_dir, "./data", "the path of data dir");
 DEFINE_bool(enable_distsql, false, "enable or disable distribute sql");
 DEFINE_bool(enable_localtablet, true, "enable or disable local tablet opt when distribute sql circumstance");
 DEFINE_string(bucket_size, "1d", "the default bucket size in pre-aggr table");
+DEFINE_uint32(window_agg_cache_size, 0,
+              "the max partition keys whose window state is cached by each window in request mode, "
+              "0 means disable");
+DEFINE_string(jit_object_cache_dir, "",
+              "the dir to cache the compiled sql objects, so that deployments are not compiled again after restart. "
+              "empty means disable");
 
 // scan configuration
 // max bytes size: write all even if scan result is too large, let it fail in client(receiver)
@@ -88,6 +118,12 @@ DEFINE_uint32(preview_default_limit, 100, "config the default limit of preview")
 // binlog configuration
 DEFINE_int32(binlog_single_file_max_size, 1024 * 4, "the max size of single binlog file");
 DEFINE_int32(binlog_sync_batch_size, 32, "the batch size of sync binlog");
+DEFINE_uint32(binlog_sync_batch_max_bytes, 4 * 1024 * 1024,
+              "the max bytes of the binlog synced to a follower at a time");
+DEFINE_uint32(binlog_group_commit_max_size, 256, "the max number of entries written to the binlog with one flush");
+DEFINE_uint32(binlog_group_commit_max_delay_us, 0,
+              "config the time a group commit waits for more entries to join. unit is microseconds");
+DEFINE_bool(binlog_group_commit_sync, false, "sync the binlog to disk on every group commit");
 DEFINE_bool(binlog_notify_on_put, false, "config the sync log to follower strategy");
 DEFINE_bool(binlog_enable_crc, false, "enable crc");
 DEFINE_int32(binlog_coffee_time, 1000, "config the coffee time. unit is milliseconds");
@@ -98,6 +134,8 @@ DEFINE_int32(binlog_delete_interval, 60000, "config the interval of delete binlo
 DEFINE_int32(binlog_match_logoffset_interval, 1000, "config the interval of match log offset. unit is milliseconds");
 DEFINE_int32(binlog_name_length, 8, "binlog name length");
 DEFINE_uint32(check_binlog_sync_progress_delta, 100000, "config the delta of check binlog sync progress");
+DEFINE_bool(send_snapshot_from_follower, false,
+            "send the snapshot by a follower when adding a replica if its snapshot is not older than the leader's");
 DEFINE_uint32(go_back_max_try_cnt, 10, "config max try time of go back");
 
 DEFINE_uint32(put_slow_log_threshold, 50000, "config the threshold of put slow log");
@@ -128,7 +166,12 @@ DEFINE_int32(send_file_max_try, 3, "the max retry time when send file failed");
 DEFINE_int32(retry_send_file_wait_time_ms, 3000, "conf the wait time when retry send file. unit is milliseconds");
 DEFINE_int32(stream_close_wait_time_ms, 1000, "the wait time before close stream. unit is milliseconds");
 DEFINE_uint32(stream_block_size, 1 * 1204 * 1024, "config the write/read block size in streaming");
-DEFINE_int32(stream_bandwidth_limit, 10 * 1204 * 1024, "the limit bandwidth. Byte/Second");
+DEFINE_int32(stream_bandwidth_limit, 10 * 1204 * 1024, "the limit bandwidth of sending a snapshot. Byte/Second");
+DEFINE_int32(stream_total_bandwidth_limit, 0,
+             "the limit bandwidth shared by all the snapshots sent by a tablet, 0 means no limit. Byte/Second");
+DEFINE_uint32(send_file_thread_num, 1,
+              "the count of threads sending a snapshot, the blocks of a file are split among the threads left by "
+              "the files");
 
 // if set 23, the task will execute 23:00 every day
 DEFINE_int32(make_snapshot_time, 23, "config the time to make snapshot");
@@ -140,6 +183,13 @@ DEFINE_uint32(make_snapshot_offline_interval, 60 * 60 * 24,
               "config tablet self makesnapshot when how long time do not "
               "makesnapshot from ns. unit is second");
 DEFINE_string(snapshot_compression, "off", "Type of snapshot compression, can be off, snappy, zlib");
+DEFINE_string(snapshot_format, "log",
+              "Format of memtable snapshot, can be log or block. block is a checksummed columnar format which "
+              "can be recovered in parallel");
+DEFINE_uint32(snapshot_max_delta_num, 0,
+              "the max count of deltas appended to a memtable snapshot. a snapshot round writes the new binlog as a "
+              "delta instead of rewriting the whole snapshot, the chain is compacted when the deltas reach this "
+              "count, are as large as the base or the binlog has deletes. 0 means always rewriting");
 DEFINE_int32(snapshot_pool_size, 1, "the size of tablet thread pool for making snapshot");
 
 DEFINE_uint32(load_index_max_wait_time, 120 * 60 * 1000,
@@ -155,6 +205,23 @@ DEFINE_uint32(latest_ttl_max, 1000, "the max ttl of latest");
 DEFINE_uint32(absolute_ttl_max, 60 * 24 * 365 * 30, "the max ttl of absolute time");
 DEFINE_uint32(skiplist_max_height, 12, "the max height of skiplist");
 DEFINE_uint32(key_entry_max_height, 8, "the max height of key entry");
+DEFINE_uint32(time_index_array_max_size, 8,
+              "the rows of a key are kept in a sorted array until it has more rows than it, then in a skiplist. "
+              "0 means always skiplist");
+DEFINE_uint32(key_filter_bits_per_key, 0,
+              "the bits per key of the bloom filter of each index, lookups of absent keys return without searching "
+              "the memtable skiplist or the rocksdb blocks. 0 disables it");
+DEFINE_bool(enable_memtable_hash_index, false,
+            "serve the point lookups of memtable keys with a hash index besides the key skiplist, it costs 16 to 32 "
+            "bytes per key");
+DEFINE_bool(enable_memtable_slab, false,
+            "allocate the rows and skiplist nodes of memtable from per segment slab, the memory freed by gc is reused");
+DEFINE_bool(enable_numa_placement, false,
+            "place the memtable of each partition on the numa node pid % node count, and run its put and query on "
+            "the workers pinned to that node");
+DEFINE_uint32(numa_worker_num_per_node, 0, "the number of pinned workers per numa node, 0 means the cpus of the node");
+DEFINE_uint32(numa_max_pending_task_per_node, 1024,
+              "the max pending requests of the pinned workers of a numa node, more requests run on the rpc workers");
 DEFINE_uint32(latest_default_skiplist_height, 1, "the default height of skiplist for latest table");
 DEFINE_uint32(absolute_default_skiplist_height, 4, "the default height of skiplist for absolute table");
 DEFINE_uint32(max_col_display_length, 256, "config the max length of column display");
@@ -163,6 +230,8 @@ DEFINE_uint32(max_col_display_length, 256, "config the max length of column disp
 DEFINE_uint32(load_table_batch, 30, "set laod table batch size");
 DEFINE_uint32(load_table_thread_num, 3, "set load tabale thread pool size");
 DEFINE_uint32(load_table_queue_size, 1000, "set load tabale queue size");
+DEFINE_uint32(binlog_recover_thread_num, 3,
+              "the number of threads decoding and putting the binlog when recovering a table");
 
 // multiple data center
 DEFINE_uint32(get_replica_status_interval, 10000,
@@ -182,6 +251,13 @@ DEFINE_uint32(block_cache_shardbits, 8, "Divide block cache into 2^8 shards to a
 DEFINE_bool(verify_compression, false, "For debug");
 DEFINE_uint32(max_log_file_size, 100 * 1024 * 1024, "Specify the maximal size of the rocksdb info log file");
 DEFINE_uint32(keep_log_file_num, 5, "Maximal info log files to be kept");
+DEFINE_bool(disk_shared_row, false,
+            "the new disk tables store a row once in a row column family and the index column families hold the "
+            "row ids, instead of a copy of the row in each index");
+DEFINE_double(disk_row_sweep_ratio, 0.2,
+              "the disk table gc checks all rows of a table storing the rows once if the estimated rows held by no "
+              "index are more than the ratio of the rows, 0 means only the rows of the deleted and expired entries "
+              "are checked");
 
 DEFINE_int32(sync_job_timeout, 30 * 60 * 1000,
              "sync job timeout, unit is milliseconds, should <= server.channel_keep_alive_time in TaskManager");
@@ -50,7 +50,9 @@ class Writer {
 
     ~Writer();
 
-    Status AddRecord(const Slice& slice);
+    // the record is left in the buffer of the file if flush is false, and it is written with the next Flush
+    Status AddRecord(const Slice& slice, bool flush = true);
+    Status Flush();
     Status EndLog();
 
     inline CompressType GetCompressType() { return compress_type_; }
@@ -80,7 +82,7 @@ class Writer {
     Status CompressRecord();
     Status AppendInternal(WritableFile* wf, int leftover);
 
-    Status EmitPhysicalRecord(RecordType type, const char* ptr, size_t length);
+    Status EmitPhysicalRecord(RecordType type, const char* ptr, size_t length, bool flush = true);
 
     // No copying allowed
     Writer(const Writer&);
@@ -97,7 +99,9 @@ struct WriteHandle {
         lw_ = new Writer(compress_type, wf_, dest_length);
     }
 
-    Status Write(const ::openmldb::base::Slice& slice) { return lw_->AddRecord(slice); }
+    Status Write(const ::openmldb::base::Slice& slice, bool flush = true) { return lw_->AddRecord(slice, flush); }
+
+    Status Flush() { return lw_->Flush(); }
 
     Status Sync() { return wf_->Sync(); }
 
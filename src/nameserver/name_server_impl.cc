@@ -69,6 +69,7 @@ DECLARE_uint32(tablet_offline_check_interval);
 DECLARE_uint32(get_table_status_interval);
 DECLARE_uint32(name_server_task_max_concurrency);
 DECLARE_uint32(check_binlog_sync_progress_delta);
+DECLARE_bool(send_snapshot_from_follower);
 DECLARE_uint32(name_server_op_execute_timeout);
 DECLARE_uint32(get_replica_status_interval);
 DECLARE_int32(make_snapshot_time);
@@ -4323,6 +4324,14 @@ void NameServerImpl::AddReplicaNS(RpcController* controller, const AddReplicaNSR
     } else {
         pid_group.insert(request->pid());
     }
+    // the sources of the snapshots are chosen with the rpcs to the tablets, so it is done before the lock
+    std::map<uint32_t, std::string> snapshot_src_endpoints;
+    if (!request->has_snapshot_src_endpoint()) {
+        for (auto pid : pid_group) {
+            snapshot_src_endpoints.emplace(pid, GetSnapshotSrcEndpoint(request->name(), request->db(), pid,
+                                                                       request->endpoint()));
+        }
+    }
     std::lock_guard<std::mutex> lock(mu_);
     auto it = tablets_.find(request->endpoint());
     if (it == tablets_.end() || it->second->state_ != ::openmldb::type::EndpointState::kHealthy) {
@@ -4365,6 +4374,10 @@ void NameServerImpl::AddReplicaNS(RpcController* controller, const AddReplicaNSR
         AddReplicaNSRequest cur_request;
         cur_request.CopyFrom(*request);
         cur_request.set_pid(pid);
+        if (auto src_it = snapshot_src_endpoints.find(pid);
+            src_it != snapshot_src_endpoints.end() && !src_it->second.empty()) {
+            cur_request.set_snapshot_src_endpoint(src_it->second);
+        }
         std::string value;
         cur_request.SerializeToString(&value);
         if (CreateOPData(::openmldb::api::OPType::kAddReplicaOP, value, op_data, request->name(), request->db(), pid) <
@@ -4418,8 +4431,13 @@ void NameServerImpl::AddReplicaNSFromRemote(RpcController* controller, const Add
             return;
         }
     }
-    std::lock_guard<std::mutex> lock(mu_);
     uint32_t pid = request->pid();
+    // the sources of the snapshots are chosen with the rpcs to the tablets, so it is done before the lock
+    std::vector<std::string> snapshot_src_endpoints;
+    for (const auto& endpoint : request->endpoint_group()) {
+        snapshot_src_endpoints.push_back(GetSnapshotSrcEndpoint(request->name(), request->db(), pid, endpoint));
+    }
+    std::lock_guard<std::mutex> lock(mu_);
     auto it = tablets_.find(request->endpoint());
     if (it == tablets_.end() || it->second->state_ != ::openmldb::type::EndpointState::kHealthy) {
         response->set_code(::openmldb::base::ReturnCode::kTabletIsNotHealthy);
@@ -4467,6 +4485,9 @@ void NameServerImpl::AddReplicaNSFromRemote(RpcController* controller, const Add
         cur_request.CopyFrom(*request);
         cur_request.set_pid(pid);
         cur_request.set_endpoint(endpoint);
+        if (!snapshot_src_endpoints[idx].empty()) {
+            cur_request.set_snapshot_src_endpoint(snapshot_src_endpoints[idx]);
+        }
         std::string value;
         cur_request.SerializeToString(&value);
         if (CreateOPData(::openmldb::api::OPType::kAddReplicaOP, value, op_data, request->name(), request->db(), pid,
@@ -4543,7 +4564,24 @@ int NameServerImpl::CreateAddReplicaOPTask(std::shared_ptr<OPData> op_data) {
         return -1;
     }
     op_data->task_list_.push_back(task);
-    task = CreateTask<SendSnapshotTaskMeta>(op_index, op_type, leader_endpoint, tid, tid, pid, request.endpoint());
+    // the source is chosen before the op is created, without the lock
+    std::string src_endpoint = leader_endpoint;
+    if (request.has_snapshot_src_endpoint()) {
+        src_endpoint = request.snapshot_src_endpoint();
+    }
+    std::string src_leader_endpoint;
+    if (src_endpoint != leader_endpoint) {
+        // the snapshots of both are paused, so the leader keeps the binlog after the snapshot sent
+        src_leader_endpoint = leader_endpoint;
+        task = CreateTask<PauseSnapshotTaskMeta>(op_index, op_type, src_endpoint, tid, pid);
+        if (!task) {
+            PDLOG(WARNING, "create pausesnapshot task failed. tid[%u] pid[%u]", tid, pid);
+            return -1;
+        }
+        op_data->task_list_.push_back(task);
+    }
+    task = CreateTask<SendSnapshotTaskMeta>(op_index, op_type, src_endpoint, tid, tid, pid, request.endpoint(),
+                                            src_leader_endpoint);
     if (!task) {
         PDLOG(WARNING, "create sendsnapshot task failed. tid[%u] pid[%u]", tid, pid);
         return -1;
@@ -4569,6 +4607,14 @@ int NameServerImpl::CreateAddReplicaOPTask(std::shared_ptr<OPData> op_data) {
         return -1;
     }
     op_data->task_list_.push_back(task);
+    if (src_endpoint != leader_endpoint) {
+        task = CreateTask<RecoverSnapshotTaskMeta>(op_index, op_type, src_endpoint, tid, pid);
+        if (!task) {
+            PDLOG(WARNING, "create recoversnapshot task failed. tid[%u] pid[%u]", tid, pid);
+            return -1;
+        }
+        op_data->task_list_.push_back(task);
+    }
     task = CreateTask<AddTableInfoTaskMeta>(op_index, op_type, request.name(), request.db(), pid, request.endpoint());
     if (!task) {
         PDLOG(WARNING, "create addtableinfo task failed. tid[%u] pid[%u]", tid, pid);
@@ -5914,20 +5960,27 @@ void NameServerImpl::RecoverEndpointTable(const std::string& name, const std::st
         task_info->set_status(::openmldb::api::TaskStatus::kFailed);
         return;
     }
-    std::lock_guard<std::mutex> lock(mu_);
     PDLOG(INFO, "offset[%lu] manifest offset[%lu]. name[%s] tid[%u] pid[%u]", offset, manifest.offset(), name.c_str(),
           tid, pid);
+    bool need_snapshot = ret_code != 0 || offset < manifest.offset();
+    std::string snapshot_src_endpoint;
+    if (need_snapshot) {
+        snapshot_src_endpoint = GetSnapshotSrcEndpoint(name, db, pid, endpoint);
+    }
+    std::lock_guard<std::mutex> lock(mu_);
     if (has_table) {
-        if (ret_code == 0 && offset >= manifest.offset()) {
+        if (!need_snapshot) {
             CreateReAddReplicaSimplifyOP(name, db, pid, endpoint, offset_delta, task_info->op_id(), concurrency);
         } else {
-            CreateReAddReplicaWithDropOP(name, db, pid, endpoint, offset_delta, task_info->op_id(), concurrency);
+            CreateReAddReplicaWithDropOP(name, db, pid, endpoint, offset_delta, task_info->op_id(), concurrency,
+                                         snapshot_src_endpoint);
         }
     } else {
-        if (ret_code == 0 && offset >= manifest.offset()) {
+        if (!need_snapshot) {
             CreateReAddReplicaNoSendOP(name, db, pid, endpoint, offset_delta, task_info->op_id(), concurrency);
         } else {
-            CreateReAddReplicaOP(name, db, pid, endpoint, offset_delta, task_info->op_id(), concurrency);
+            CreateReAddReplicaOP(name, db, pid, endpoint, offset_delta, task_info->op_id(), concurrency,
+                                 snapshot_src_endpoint);
         }
     }
     task_info->set_status(::openmldb::api::TaskStatus::kDone);
@@ -5938,7 +5991,7 @@ void NameServerImpl::RecoverEndpointTable(const std::string& name, const std::st
 
 int NameServerImpl::CreateReAddReplicaOP(const std::string& name, const std::string& db, uint32_t pid,
                                          const std::string& endpoint, uint64_t offset_delta, uint64_t parent_id,
-                                         uint32_t concurrency) {
+                                         uint32_t concurrency, const std::string& snapshot_src_endpoint) {
     auto it = tablets_.find(endpoint);
     if (it == tablets_.end() || it->second->state_ != ::openmldb::type::EndpointState::kHealthy) {
         PDLOG(WARNING, "tablet[%s] is not online", endpoint.c_str());
@@ -5948,6 +6001,9 @@ int NameServerImpl::CreateReAddReplicaOP(const std::string& name, const std::str
     RecoverTableData recover_table_data;
     recover_table_data.set_endpoint(endpoint);
     recover_table_data.set_offset_delta(offset_delta);
+    if (!snapshot_src_endpoint.empty()) {
+        recover_table_data.set_snapshot_src_endpoint(snapshot_src_endpoint);
+    }
     std::string value;
     recover_table_data.SerializeToString(&value);
     if (CreateOPData(::openmldb::api::OPType::kReAddReplicaOP, value, op_data, name, db, pid, parent_id) < 0) {
@@ -6001,7 +6057,24 @@ int NameServerImpl::CreateReAddReplicaTask(std::shared_ptr<OPData> op_data) {
         return -1;
     }
     op_data->task_list_.push_back(task);
-    task = CreateTask<SendSnapshotTaskMeta>(op_index, op_type, leader_endpoint, tid, tid, pid, endpoint);
+    // the source is chosen before the op is created, without the lock
+    std::string src_endpoint = leader_endpoint;
+    if (recover_table_data.has_snapshot_src_endpoint()) {
+        src_endpoint = recover_table_data.snapshot_src_endpoint();
+    }
+    std::string src_leader_endpoint;
+    if (src_endpoint != leader_endpoint) {
+        // the snapshots of both are paused, so the leader keeps the binlog after the snapshot sent
+        src_leader_endpoint = leader_endpoint;
+        task = CreateTask<PauseSnapshotTaskMeta>(op_index, op_type, src_endpoint, tid, pid);
+        if (!task) {
+            PDLOG(WARNING, "create pausesnapshot task failed. tid[%u] pid[%u]", tid, pid);
+            return -1;
+        }
+        op_data->task_list_.push_back(task);
+    }
+    task = CreateTask<SendSnapshotTaskMeta>(op_index, op_type, src_endpoint, tid, tid, pid, endpoint,
+                                            src_leader_endpoint);
     if (!task) {
         PDLOG(WARNING, "create sendsnapshot task failed. tid[%u] pid[%u]", tid, pid);
         return -1;
@@ -6026,6 +6099,14 @@ int NameServerImpl::CreateReAddReplicaTask(std::shared_ptr<OPData> op_data) {
         return -1;
     }
     op_data->task_list_.push_back(task);
+    if (src_endpoint != leader_endpoint) {
+        task = CreateTask<RecoverSnapshotTaskMeta>(op_index, op_type, src_endpoint, tid, pid);
+        if (!task) {
+            PDLOG(WARNING, "create recoversnapshot task failed. tid[%u] pid[%u]", tid, pid);
+            return -1;
+        }
+        op_data->task_list_.push_back(task);
+    }
     task = CreateTask<CheckBinlogSyncProgressTaskMeta>(op_index, op_type, name, db, pid, endpoint, offset_delta);
     if (!task) {
         PDLOG(WARNING, "create CheckBinlogSyncProgressTask failed. name[%s] pid[%u]", name.c_str(), pid);
@@ -6045,11 +6126,14 @@ int NameServerImpl::CreateReAddReplicaTask(std::shared_ptr<OPData> op_data) {
 
 int NameServerImpl::CreateReAddReplicaWithDropOP(const std::string& name, const std::string& db, uint32_t pid,
                                                  const std::string& endpoint, uint64_t offset_delta, uint64_t parent_id,
-                                                 uint32_t concurrency) {
+                                                 uint32_t concurrency, const std::string& snapshot_src_endpoint) {
     std::shared_ptr<OPData> op_data;
     RecoverTableData recover_table_data;
     recover_table_data.set_endpoint(endpoint);
     recover_table_data.set_offset_delta(offset_delta);
+    if (!snapshot_src_endpoint.empty()) {
+        recover_table_data.set_snapshot_src_endpoint(snapshot_src_endpoint);
+    }
     std::string value;
     recover_table_data.SerializeToString(&value);
     if (CreateOPData(::openmldb::api::OPType::kReAddReplicaWithDropOP, value, op_data, name, db, pid, parent_id) < 0) {
@@ -6113,13 +6197,30 @@ int NameServerImpl::CreateReAddReplicaWithDropTask(std::shared_ptr<OPData> op_da
         return -1;
     }
     op_data->task_list_.push_back(task);
+    // the source is chosen before the op is created, without the lock
+    std::string src_endpoint = leader_endpoint;
+    if (recover_table_data.has_snapshot_src_endpoint()) {
+        src_endpoint = recover_table_data.snapshot_src_endpoint();
+    }
+    std::string src_leader_endpoint;
+    if (src_endpoint != leader_endpoint) {
+        // the snapshots of both are paused, so the leader keeps the binlog after the snapshot sent
+        src_leader_endpoint = leader_endpoint;
+        task = CreateTask<PauseSnapshotTaskMeta>(op_index, op_type, src_endpoint, tid, pid);
+        if (!task) {
+            PDLOG(WARNING, "create pausesnapshot task failed. tid[%u] pid[%u]", tid, pid);
+            return -1;
+        }
+        op_data->task_list_.push_back(task);
+    }
     task = CreateTask<DropTableTaskMeta>(op_index, op_type, endpoint, tid, pid);
     if (!task) {
         PDLOG(WARNING, "create droptable task failed. tid[%u] pid[%u]", tid, pid);
         return -1;
     }
     op_data->task_list_.push_back(task);
-    task = CreateTask<SendSnapshotTaskMeta>(op_index, op_type, leader_endpoint, tid, tid, pid, endpoint);
+    task = CreateTask<SendSnapshotTaskMeta>(op_index, op_type, src_endpoint, tid, tid, pid, endpoint,
+                                            src_leader_endpoint);
     if (!task) {
         PDLOG(WARNING, "create sendsnapshot task failed. tid[%u] pid[%u]", tid, pid);
         return -1;
@@ -6144,6 +6245,14 @@ int NameServerImpl::CreateReAddReplicaWithDropTask(std::shared_ptr<OPData> op_da
         return -1;
     }
     op_data->task_list_.push_back(task);
+    if (src_endpoint != leader_endpoint) {
+        task = CreateTask<RecoverSnapshotTaskMeta>(op_index, op_type, src_endpoint, tid, pid);
+        if (!task) {
+            PDLOG(WARNING, "create recoversnapshot task failed. tid[%u] pid[%u]", tid, pid);
+            return -1;
+        }
+        op_data->task_list_.push_back(task);
+    }
     task = CreateTask<CheckBinlogSyncProgressTaskMeta>(op_index, op_type, name, db, pid, endpoint, offset_delta);
     if (!task) {
         PDLOG(WARNING, "create CheckBinlogSyncProgressTask failed. name[%s] pid[%u]", name.c_str(), pid);
@@ -6289,6 +6398,67 @@ int NameServerImpl::GetLeader(std::shared_ptr<::openmldb::nameserver::TableInfo>
     return -1;
 }
 
+std::string NameServerImpl::GetSnapshotSrcEndpoint(const std::string& name, const std::string& db, uint32_t pid,
+                                                   const std::string& des_endpoint) {
+    uint32_t tid = 0;
+    ::openmldb::common::StorageMode storage_mode = ::openmldb::common::kMemory;
+    std::string leader_endpoint;
+    std::shared_ptr<TabletClient> leader_client;
+    std::vector<std::pair<std::string, std::shared_ptr<TabletClient>>> follower_clients;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        std::shared_ptr<::openmldb::nameserver::TableInfo> table_info;
+        if (!GetTableInfoUnlock(name, db, &table_info) || GetLeader(table_info, pid, leader_endpoint) < 0) {
+            return "";
+        }
+        if (!FLAGS_send_snapshot_from_follower) {
+            return leader_endpoint;
+        }
+        tid = table_info->tid();
+        storage_mode = table_info->storage_mode();
+        for (const auto& partition : table_info->table_partition()) {
+            if (partition.pid() != pid) {
+                continue;
+            }
+            for (const auto& meta : partition.partition_meta()) {
+                if (!meta.is_alive() || meta.endpoint() == des_endpoint) {
+                    continue;
+                }
+                auto it = tablets_.find(meta.endpoint());
+                if (it == tablets_.end() || it->second->state_ != ::openmldb::type::EndpointState::kHealthy) {
+                    continue;
+                }
+                if (meta.endpoint() == leader_endpoint) {
+                    leader_client = it->second->client_;
+                } else {
+                    follower_clients.emplace_back(meta.endpoint(), it->second->client_);
+                }
+            }
+            break;
+        }
+    }
+    // the manifests are got without the lock, the chosen follower checks the leader again before sending
+    if (!leader_client || follower_clients.empty()) {
+        return leader_endpoint;
+    }
+    ::openmldb::api::Manifest leader_manifest;
+    if (!leader_client->GetManifest(tid, pid, storage_mode, leader_manifest)) {
+        PDLOG(WARNING, "get manifest failed. tid[%u] pid[%u] endpoint[%s]", tid, pid, leader_endpoint.c_str());
+        return leader_endpoint;
+    }
+    for (const auto& kv : follower_clients) {
+        // the leader deletes the binlog before its snapshot, the replica loaded from an older snapshot could
+        // not catch up
+        ::openmldb::api::Manifest manifest;
+        if (kv.second->GetManifest(tid, pid, storage_mode, manifest) && manifest.offset() >= leader_manifest.offset()) {
+            PDLOG(INFO, "send snapshot from follower[%s]. tid[%u] pid[%u] offset[%lu] leader offset[%lu]",
+                  kv.first.c_str(), tid, pid, manifest.offset(), leader_manifest.offset());
+            return kv.first;
+        }
+    }
+    return leader_endpoint;
+}
+
 int NameServerImpl::CreateReAddReplicaSimplifyOP(const std::string& name, const std::string& db, uint32_t pid,
                                                  const std::string& endpoint, uint64_t offset_delta, uint64_t parent_id,
                                                  uint32_t concurrency) {
@@ -10214,7 +10384,7 @@ std::shared_ptr<Task> NameServerImpl::CreateTaskInternal(const TaskMeta* task_me
         case ::openmldb::api::TaskType::kSendSnapshot: {
             auto meta = dynamic_cast<const SendSnapshotTaskMeta*>(task_meta);
             boost::function<bool()> fun = boost::bind(&TabletClient::SendSnapshot, client, meta->tid, meta->remote_tid,
-                                                      meta->pid, meta->des_endpoint, task_info);
+                                                      meta->pid, meta->des_endpoint, task_info, meta->leader_endpoint);
             task->fun_ = boost::bind(&NameServerImpl::WrapTaskFun, this, fun, task_info);
             break;
         }
@@ -547,16 +547,22 @@ class NameServerImpl : public NameServer {
                               std::shared_ptr<::openmldb::api::TaskInfo> task_info);
     int GetLeader(std::shared_ptr<::openmldb::nameserver::TableInfo> table_info, uint32_t pid,
                   std::string& leader_endpoint);  // NOLINT
+    // the tablet to send the snapshot of the partition to des_endpoint. it is an alive follower whose snapshot is
+    // not older than the leader's if send_snapshot_from_follower is set, otherwise the leader. empty if the
+    // partition has no leader. it takes mu_ and gets the manifests after releasing it, so call it without mu_
+    std::string GetSnapshotSrcEndpoint(const std::string& name, const std::string& db, uint32_t pid,
+                                       const std::string& des_endpoint);
     int MatchTermOffset(const std::string& name, const std::string& db, uint32_t pid, bool has_table, uint64_t term,
                         uint64_t offset);
     int CreateReAddReplicaOP(const std::string& name, const std::string& db, uint32_t pid, const std::string& endpoint,
-                             uint64_t offset_delta, uint64_t parent_id, uint32_t concurrency);
+                             uint64_t offset_delta, uint64_t parent_id, uint32_t concurrency,
+                             const std::string& snapshot_src_endpoint);
     int CreateReAddReplicaSimplifyOP(const std::string& name, const std::string& db, uint32_t pid,
                                      const std::string& endpoint, uint64_t offset_delta, uint64_t parent_id,
                                      uint32_t concurrency);
     int CreateReAddReplicaWithDropOP(const std::string& name, const std::string& db, uint32_t pid,
                                      const std::string& endpoint, uint64_t offset_delta, uint64_t parent_id,
-                                     uint32_t concurrency);
+                                     uint32_t concurrency, const std::string& snapshot_src_endpoint);
     int CreateReAddReplicaNoSendOP(const std::string& name, const std::string& db, uint32_t pid,
                                    const std::string& endpoint, uint64_t offset_delta, uint64_t parent_id,
                                    uint32_t concurrency);
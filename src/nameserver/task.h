@@ -134,13 +134,17 @@ class RecoverSnapshotTaskMeta : public TaskMeta {
 class SendSnapshotTaskMeta : public TaskMeta {
  public:
     SendSnapshotTaskMeta(uint64_t op_id, ::openmldb::api::OPType op_type, const std::string& endpoint,
-            uint32_t tid_i, uint32_t remote_tid_i, uint32_t pid_i, const std::string& des_endpoint_i) :
+            uint32_t tid_i, uint32_t remote_tid_i, uint32_t pid_i, const std::string& des_endpoint_i,
+            const std::string& leader_endpoint_i = "") :
         TaskMeta(op_id, op_type, ::openmldb::api::TaskType::kSendSnapshot, endpoint),
-        tid(tid_i), remote_tid(remote_tid_i), pid(pid_i), des_endpoint(des_endpoint_i) {}
+        tid(tid_i), remote_tid(remote_tid_i), pid(pid_i), des_endpoint(des_endpoint_i),
+        leader_endpoint(leader_endpoint_i) {}
     uint32_t tid;
     uint32_t remote_tid;
     uint32_t pid;
     std::string des_endpoint;
+    // set if the snapshot is sent by a follower
+    std::string leader_endpoint;
 };
 
 class LoadTableTaskMeta : public TaskMeta {
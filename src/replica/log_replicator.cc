@@ -35,6 +35,9 @@
 
 DECLARE_int32(binlog_single_file_max_size);
 DECLARE_int32(binlog_name_length);
+DECLARE_uint32(binlog_group_commit_max_size);
+DECLARE_uint32(binlog_group_commit_max_delay_us);
+DECLARE_bool(binlog_group_commit_sync);
 DECLARE_string(zk_cluster);
 
 namespace openmldb {
@@ -291,6 +294,31 @@ void LogReplicator::SetLeaderTerm(uint64_t term) { term_.store(term, std::memory
 
 bool LogReplicator::ApplyEntry(const LogEntry& entry) {
     std::lock_guard<std::mutex> lock(wmu_);
+    return ApplyEntryUnlock(entry, true);
+}
+
+bool LogReplicator::ApplyEntries(const ::google::protobuf::RepeatedPtrField<LogEntry>& entries, int* applied_cnt) {
+    std::lock_guard<std::mutex> lock(wmu_);
+    *applied_cnt = 0;
+    bool ok = true;
+    for (const auto& entry : entries) {
+        if (!ApplyEntryUnlock(entry, false)) {
+            ok = false;
+            break;
+        }
+        (*applied_cnt)++;
+    }
+    if (wh_ != NULL) {
+        ::openmldb::log::Status status = wh_->Flush();
+        if (!status.ok()) {
+            PDLOG(WARNING, "fail to flush replication log in dir %s for %s", path_.c_str(), status.ToString().c_str());
+            return false;
+        }
+    }
+    return ok;
+}
+
+bool LogReplicator::ApplyEntryUnlock(const LogEntry& entry, bool flush) {
     uint64_t last_log_offset = GetOffset();
     if (wh_ == NULL || (wh_->GetSize() / (1024 * 1024)) > (uint32_t)FLAGS_binlog_single_file_max_size) {
         if (!RollWLogFile()) {
@@ -306,7 +334,7 @@ bool LogReplicator::ApplyEntry(const LogEntry& entry) {
     std::string buffer;
     entry.SerializeToString(&buffer);
     ::openmldb::base::Slice slice(buffer.c_str(), buffer.size());
-    ::openmldb::log::Status status = wh_->Write(slice);
+    ::openmldb::log::Status status = wh_->Write(slice, flush);
     if (!status.ok()) {
         PDLOG(WARNING, "fail to write replication log in dir %s for %s", path_.c_str(), status.ToString().c_str());
         return false;
@@ -434,7 +462,105 @@ bool LogReplicator::DelAllReplicateNode() {
 }
 
 bool LogReplicator::AppendEntry(LogEntry& entry, ::google::protobuf::Closure* done) {
-    std::lock_guard<std::mutex> lock(wmu_);
+    PendingAppend append;
+    append.entries = &entry;
+    append.cnt = 1;
+    append.done = done;
+    return GroupAppend(&append);
+}
+
+bool LogReplicator::AppendEntries(std::vector<LogEntry>* entries, ::google::protobuf::Closure* done,
+                                  int* appended_cnt) {
+    PendingAppend append;
+    append.entries = entries->data();
+    append.cnt = entries->size();
+    append.done = done;
+    append.appended_cnt = appended_cnt;
+    return GroupAppend(&append);
+}
+
+bool LogReplicator::GroupAppend(PendingAppend* append) {
+    std::unique_lock<bthread::Mutex> lock(append_mu_);
+    append_queue_.push_back(append);
+    while (!append->finished && append != append_queue_.front()) {
+        append->cv.wait(lock);
+    }
+    if (append->finished) {
+        return append->ok;
+    }
+    auto queued_cnt = [this]() {
+        size_t cnt = 0;
+        for (const auto* cur : append_queue_) {
+            cnt += cur->cnt;
+        }
+        return cnt;
+    };
+    if (FLAGS_binlog_group_commit_max_delay_us > 0 && queued_cnt() < FLAGS_binlog_group_commit_max_size) {
+        // wait a moment for more appends to join the group
+        lock.unlock();
+        bthread_usleep(FLAGS_binlog_group_commit_max_delay_us);
+        lock.lock();
+    }
+    // the group takes at least the first append, and the following ones as long as the size is not exceeded
+    size_t group_size = 0;
+    size_t entry_cnt = 0;
+    for (const auto* cur : append_queue_) {
+        if (group_size > 0 && entry_cnt + cur->cnt > FLAGS_binlog_group_commit_max_size) {
+            break;
+        }
+        entry_cnt += cur->cnt;
+        group_size++;
+    }
+    std::vector<PendingAppend*> group(append_queue_.begin(), append_queue_.begin() + group_size);
+    lock.unlock();
+    {
+        std::lock_guard<std::mutex> wlock(wmu_);
+        std::vector<int> appended(group.size(), 0);
+        for (size_t pos = 0; pos < group.size(); pos++) {
+            auto* cur = group[pos];
+            int cnt = static_cast<int>(cur->cnt);
+            while (appended[pos] < cnt && AppendEntryUnlock(cur->entries[appended[pos]], false)) {
+                appended[pos]++;
+            }
+            cur->ok = appended[pos] == cnt;
+        }
+        ::openmldb::log::Status status;
+        if (wh_ != NULL) {
+            status = FLAGS_binlog_group_commit_sync ? wh_->Sync() : wh_->Flush();
+        }
+        for (size_t pos = 0; pos < group.size(); pos++) {
+            auto* cur = group[pos];
+            if (!status.ok()) {
+                cur->ok = false;
+                appended[pos] = 0;
+            }
+            if (cur->appended_cnt) {
+                *cur->appended_cnt = appended[pos];
+            }
+            // the done closures run in the order of the log index with wmu_ held
+            if (appended[pos] > 0 && cur->done) {
+                cur->done->Run();
+            }
+        }
+        if (!status.ok()) {
+            PDLOG(WARNING, "fail to flush replication log in dir %s for %s", path_.c_str(), status.ToString().c_str());
+        }
+    }
+    lock.lock();
+    for (auto* cur : group) {
+        append_queue_.pop_front();
+        cur->finished = true;
+        if (cur != append) {
+            cur->cv.notify_one();
+        }
+    }
+    if (!append_queue_.empty()) {
+        append_queue_.front()->cv.notify_one();
+    }
+    return append->ok;
+}
+
+bool LogReplicator::AppendEntryUnlock(LogEntry& entry, bool flush) {
     if (wh_ == NULL || wh_->GetSize() / (1024 * 1024) > (uint32_t)FLAGS_binlog_single_file_max_size) {
         bool ok = RollWLogFile();
         if (!ok) {
@@ -446,7 +572,7 @@ bool LogReplicator::AppendEntry(LogEntry& entry, ::google::protobuf::Closure* do
     std::string buffer;
     entry.SerializeToString(&buffer);
     ::openmldb::base::Slice slice(buffer);
-    ::openmldb::log::Status status = wh_->Write(slice);
+    ::openmldb::log::Status status = wh_->Write(slice, flush);
     if (!status.ok()) {
         PDLOG(WARNING, "fail to write replication log in dir %s for %s", path_.c_str(), status.ToString().c_str());
         return false;
@@ -456,9 +582,6 @@ bool LogReplicator::AppendEntry(LogEntry& entry, ::google::protobuf::Closure* do
                                      // sync to remote replica
         follower_offset_.store(cur_offset + 1, std::memory_order_relaxed);
     }
-    if (done) {
-        done->Run();
-    }
     return true;
 }
 
@@ -19,6 +19,7 @@
 
 #include <atomic>
 #include <condition_variable>  // NOLINT
+#include <deque>
 #include <map>
 #include <memory>
 #include <mutex>  // NOLINT
@@ -62,9 +63,18 @@ class LogReplicator {
 
     // the slave node receives master log entries
     bool ApplyEntry(const ::openmldb::api::LogEntry& entry);
+    // apply the entries of a request with one flush of the binlog, applied_cnt is set to the number of the leading
+    // entries that are applied or have been applied before
+    bool ApplyEntries(const ::google::protobuf::RepeatedPtrField<::openmldb::api::LogEntry>& entries,
+                      int* applied_cnt);
 
     // the master node append entry
     bool AppendEntry(::openmldb::api::LogEntry& entry, ::google::protobuf::Closure* done = nullptr);  // NOLINT
+    // append the entries of a batch with the write lock taken once. appended_cnt is set to the number of the leading
+    // entries that are appended, and done runs after them if there are any, so a failure in the middle keeps the
+    // entries before it. returns true if all are appended
+    bool AppendEntries(std::vector<::openmldb::api::LogEntry>* entries, ::google::protobuf::Closure* done = nullptr,
+                       int* appended_cnt = nullptr);
 
     //  data to slave nodes
     void Notify();
@@ -114,6 +124,23 @@ class LogReplicator {
 
  private:
     bool OpenSeqFile(const std::string& path, SequentialFile** sf);
+    // an AppendEntry or AppendEntries call waiting in append_queue_
+    struct PendingAppend {
+        ::openmldb::api::LogEntry* entries;
+        size_t cnt;
+        ::google::protobuf::Closure* done;
+        // the number of the leading entries appended, set before done runs
+        int* appended_cnt = nullptr;
+        bool ok = false;
+        bool finished = false;
+        bthread::ConditionVariable cv;
+    };
+    // group commit, the first call in append_queue_ writes the entries of the calls queued behind it too, with one
+    // flush and an optional sync of the binlog
+    bool GroupAppend(PendingAppend* append);
+    // append an entry with wmu_ held
+    bool AppendEntryUnlock(::openmldb::api::LogEntry& entry, bool flush = true);  // NOLINT
+    bool ApplyEntryUnlock(const ::openmldb::api::LogEntry& entry, bool flush);
 
  private:
     // the replicator root data path
@@ -141,6 +168,9 @@ class LogReplicator {
     std::atomic<uint64_t> snapshot_last_offset_;
 
     std::mutex wmu_;
+    // the pending appends of the group commit
+    bthread::Mutex append_mu_;
+    std::deque<PendingAppend*> append_queue_;
 };
 
 }  // namespace replica
@@ -25,6 +25,7 @@
 #include <unistd.h>
 
 #include <filesystem>
+#include <thread>  // NOLINT
 #include <utility>
 
 #include "base/glog_wrapper.h"
@@ -49,6 +50,8 @@ using ::openmldb::storage::TableIterator;
 using ::openmldb::storage::Ticket;
 
 DECLARE_int32(binlog_single_file_max_size);
+DECLARE_uint32(binlog_group_commit_max_delay_us);
+DECLARE_bool(binlog_group_commit_sync);
 
 namespace openmldb {
 namespace replica {
@@ -151,6 +154,120 @@ TEST_F(LogReplicatorTest, BenchMark) {
     ASSERT_TRUE(ok);
 }
 
+TEST_F(LogReplicatorTest, GroupCommit) {
+    FLAGS_binlog_group_commit_max_delay_us = 100;
+    FLAGS_binlog_group_commit_sync = true;
+    std::map<std::string, std::string> map;
+    std::filesystem::path folder = std::filesystem::temp_directory_path() / GenRand();
+    absl::Cleanup clean = [&folder]() {
+        std::filesystem::remove_all(folder);
+        FLAGS_binlog_group_commit_max_delay_us = 0;
+        FLAGS_binlog_group_commit_sync = false;
+    };
+    LogReplicator replicator(1, 1, folder, map, kLeaderNode);
+    ASSERT_TRUE(replicator.Init());
+
+    // the done closures run in the order of the log index
+    struct OrderClosure : public Closure {
+        std::vector<::openmldb::api::LogEntry>* entries;
+        std::vector<uint64_t>* order;
+        void Run() override {
+            for (const auto& entry : *entries) {
+                order->push_back(entry.log_index());
+            }
+        }
+    };
+    std::vector<uint64_t> order;
+    int thread_num = 8;
+    int num = 1000;
+    std::atomic<int> failed_cnt(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_num; t++) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < num; i++) {
+                std::vector<::openmldb::api::LogEntry> entries(i % 2 == 0 ? 1 : 3);
+                for (auto& entry : entries) {
+                    entry.set_term(1);
+                    entry.set_pk(absl::StrCat("key", t));
+                    entry.set_value("value");
+                    entry.set_ts(i);
+                }
+                OrderClosure closure;
+                closure.entries = &entries;
+                closure.order = &order;
+                bool ok = entries.size() == 1 ? replicator.AppendEntry(entries[0], &closure)
+                                              : replicator.AppendEntries(&entries, &closure);
+                if (!ok) {
+                    failed_cnt++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(0, failed_cnt.load());
+    uint64_t total = thread_num * num * 2;
+    ASSERT_EQ(total, replicator.GetOffset());
+    ASSERT_EQ(total, order.size());
+    for (uint64_t i = 0; i < total; i++) {
+        ASSERT_EQ(i + 1, order[i]);
+    }
+
+    LogReader reader(replicator.GetLogPart(), replicator.GetLogPath(), false);
+    ASSERT_TRUE(reader.SetOffset(0));
+    std::string buffer;
+    ::openmldb::base::Slice record;
+    for (uint64_t i = 0; i < total; i++) {
+        buffer.clear();
+        ASSERT_TRUE(reader.ReadNextRecord(&record, &buffer).ok());
+        ::openmldb::api::LogEntry entry;
+        ASSERT_TRUE(entry.ParseFromString(record.ToString()));
+        ASSERT_EQ(i + 1, entry.log_index());
+    }
+}
+
+TEST_F(LogReplicatorTest, AppendEntriesPartly) {
+    int32_t old_max_size = FLAGS_binlog_single_file_max_size;
+    FLAGS_binlog_single_file_max_size = 1;
+    std::map<std::string, std::string> map;
+    std::filesystem::path folder = std::filesystem::temp_directory_path() / GenRand();
+    absl::Cleanup clean = [&folder, old_max_size]() {
+        std::filesystem::remove_all(folder);
+        FLAGS_binlog_single_file_max_size = old_max_size;
+    };
+    LogReplicator replicator(1, 1, folder, map, kLeaderNode);
+    ASSERT_TRUE(replicator.Init());
+    ::openmldb::api::LogEntry first;
+    first.set_term(1);
+    first.set_pk("key");
+    first.set_value("value");
+    ASSERT_TRUE(replicator.AppendEntry(first));
+
+    // the binlog file is rolled after 2 MB, and the new file can not be created without the log dir
+    std::filesystem::remove_all(replicator.GetLogPath());
+    std::vector<::openmldb::api::LogEntry> entries(40);
+    for (auto& entry : entries) {
+        entry.set_term(1);
+        entry.set_pk("key");
+        entry.set_value(std::string(64 * 1024, 'v'));
+    }
+    int run_cnt = 0;
+    int appended_cnt = -1;
+    struct CountClosure : public Closure {
+        int* run_cnt;
+        void Run() override { (*run_cnt)++; }
+    } closure;
+    closure.run_cnt = &run_cnt;
+    ASSERT_FALSE(replicator.AppendEntries(&entries, &closure, &appended_cnt));
+    // the entries before the failure are kept and done runs for them
+    ASSERT_GT(appended_cnt, 0);
+    ASSERT_LT(appended_cnt, static_cast<int>(entries.size()));
+    ASSERT_EQ(1, run_cnt);
+    ASSERT_EQ(static_cast<uint64_t>(appended_cnt) + 1, replicator.GetOffset());
+    ASSERT_EQ(static_cast<uint64_t>(appended_cnt) + 1, entries[appended_cnt - 1].log_index());
+}
+
 TEST_F(LogReplicatorTest, LogReader) {
     // set to 1 MB, every binlog file will be a little larger than 2 MB
     // as the checking logic is: (wh_->GetSize() / (1024 * 1024)) > (uint32_t)FLAGS_binlog_single_file_max_size
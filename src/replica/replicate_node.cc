@@ -24,6 +24,7 @@
 #include "base/strings.h"
 
 DECLARE_int32(binlog_sync_batch_size);
+DECLARE_uint32(binlog_sync_batch_max_bytes);
 DECLARE_int32(binlog_sync_wait_time);
 DECLARE_int32(binlog_coffee_time);
 DECLARE_int32(binlog_match_logoffset_interval);
@@ -208,7 +209,8 @@ int ReplicateNode::SyncData(uint64_t log_offset) {
         }
         uint32_t batchSize = log_offset - last_sync_offset_;
         batchSize = std::min(batchSize, (uint32_t)FLAGS_binlog_sync_batch_size);
-        for (uint64_t i = 0; i < batchSize;) {
+        uint64_t batch_bytes = 0;
+        for (uint64_t i = 0; i < batchSize && batch_bytes < FLAGS_binlog_sync_batch_max_bytes;) {
             std::string buffer;
             ::openmldb::base::Slice record;
             ::openmldb::log::Status status = log_reader_.ReadNextRecord(&record, &buffer);
@@ -244,6 +246,7 @@ int ReplicateNode::SyncData(uint64_t log_offset) {
                     break;
                 }
                 sync_log_offset = entry->log_index();
+                batch_bytes += record.size();
             } else if (status.IsWaitRecord()) {
                 DEBUGLOG("got a coffee time for[%s]", endpoint_.c_str());
                 need_wait = true;
@@ -603,17 +603,20 @@ std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>> DBSDK::GetTabl
 }
 
 std::shared_ptr<::openmldb::catalog::TabletAccessor> DBSDK::GetTablet(const std::string& db, const std::string& name,
-                                                                      const std::string& pk) {
+                                                                      const std::string& pk, uint32_t* pid) {
     auto table_handler = GetCatalog()->GetTable(db, name);
     if (table_handler) {
         auto sdk_table_handler = dynamic_cast<::openmldb::catalog::SDKTableHandler*>(table_handler.get());
         if (sdk_table_handler) {
             uint32_t pid_num = sdk_table_handler->GetPartitionNum();
-            uint32_t pid = 0;
+            uint32_t cur_pid = 0;
             if (pid_num > 0) {
-                pid = ::openmldb::base::hash64(pk) % pid_num;
+                cur_pid = ::openmldb::base::hash64(pk) % pid_num;
             }
-            return sdk_table_handler->GetTablet(pid);
+            if (pid != nullptr) {
+                *pid = cur_pid;
+            }
+            return sdk_table_handler->GetTablet(cur_pid);
         }
     }
     return {};
@@ -97,8 +97,9 @@ class DBSDK {
     std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>> GetTabletFollowers(const std::string& db,
                                                                                          const std::string& name,
                                                                                          uint32_t pid);
+    // the tablet of the partition pk is hashed to, pid is set to that partition if not null
     std::shared_ptr<::openmldb::catalog::TabletAccessor> GetTablet(const std::string& db, const std::string& name,
-                                                                   const std::string& pk);
+                                                                   const std::string& pk, uint32_t* pid = nullptr);
 
     std::shared_ptr<hybridse::sdk::ProcedureInfo> GetProcedureInfo(const std::string& db, const std::string& sp_name,
                                                                    std::string* msg);
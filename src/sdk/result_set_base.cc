@@ -44,13 +44,18 @@ bool ResultSetBase::Reset() {
 
 bool ResultSetBase::Next() {
     index_++;
+    if (index_ == 0) {
+        remaining_ = *io_buf_;
+    }
     if (index_ < static_cast<int32_t>(count_) && position_ < buf_size_) {
         // get row size
         uint32_t row_size = 0;
-        io_buf_->copy_to(reinterpret_cast<void*>(&row_size), 4, position_ + 2);
+        remaining_.copy_to(reinterpret_cast<void*>(&row_size), 4, 2);
         DLOG(INFO) << "row size " << row_size << " position " << position_ << " byte size " << buf_size_;
+        // cutting from the front refers to the blocks without copying, and unlike append_to with
+        // position_ it does not walk the blocks of the previous rows
         butil::IOBuf tmp;
-        io_buf_->append_to(&tmp, row_size, position_);
+        remaining_.cutn(&tmp, row_size);
         position_ += row_size;
         bool ok = row_view_->Reset(tmp);
         if (!ok) {
@@ -69,8 +74,18 @@ bool ResultSetBase::GetString(uint32_t index, std::string* str) {
         LOG(WARNING) << "input ptr is null pointer";
         return false;
     }
+    char* data = nullptr;
+    uint32_t size = 0;
+    int32_t ret = row_view_->GetString(index, &data, &size);
+    if (ret == 0) {
+        str->append(data, size);
+        return true;
+    } else if (ret > 0) {
+        return false;
+    }
+    // the row is split across blocks
     butil::IOBuf tmp;
-    int32_t ret = row_view_->GetString(index, &tmp);
+    ret = row_view_->GetString(index, &tmp);
     if (ret == 0) {
         DLOG(INFO) << "get str size " << tmp.size();
         tmp.append_to(str, tmp.size(), 0);
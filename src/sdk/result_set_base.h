@@ -70,6 +70,8 @@ class ResultSetBase {
 
  private:
     const butil::IOBuf* io_buf_;
+    // the rows of io_buf_ after position_, each row is cut from its front
+    butil::IOBuf remaining_;
     uint32_t count_;
     uint32_t buf_size_;
     std::unique_ptr<::hybridse::sdk::RowIOBufView> row_view_;
@@ -86,6 +86,32 @@ std::shared_ptr<::hybridse::sdk::ResultSet> ResultSetSQL::MakeResultSet(
     return rs;
 }
 
+std::shared_ptr<::hybridse::sdk::ResultSet> ResultSetSQL::MakeResultSet(const ::openmldb::api::QueryResponse& response,
+                                                                        butil::IOBuf* buf,
+                                                                        hybridse::sdk::Status* status) {
+    if (!status || !buf) {
+        return {};
+    }
+    ::hybridse::vm::Schema schema;
+    if (!::hybridse::codec::SchemaCodec::Decode(response.schema(), &schema)) {
+        *status = {::hybridse::common::StatusCode::kCmdError, "request error, fail to decodec schema"};
+        return {};
+    }
+    if (buf->length() < response.byte_size()) {
+        *status = {::hybridse::common::StatusCode::kCmdError, "request error, the attachment is truncated"};
+        return {};
+    }
+    auto io_buf = std::make_shared<butil::IOBuf>();
+    buf->cutn(io_buf.get(), response.byte_size());
+    auto rs = std::make_shared<openmldb::sdk::ResultSetSQL>(schema, response.count(), io_buf);
+    if (!rs->Init()) {
+        *status = {::hybridse::common::StatusCode::kCmdError, "request error, ResultSetSQL init failed"};
+        return {};
+    }
+    *status = {};
+    return rs;
+}
+
 std::shared_ptr<::hybridse::sdk::ResultSet> ResultSetSQL::MakeResultSet(
     const std::shared_ptr<::openmldb::api::ScanResponse>& response,
     const ::google::protobuf::RepeatedField<uint32_t>& projection, const std::shared_ptr<brpc::Controller>& cntl,
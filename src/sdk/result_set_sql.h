@@ -47,6 +47,11 @@ class ResultSetSQL : public ::hybridse::sdk::ResultSet {
         const std::shared_ptr<::openmldb::api::QueryResponse>& response, const std::shared_ptr<brpc::Controller>& cntl,
         ::hybridse::sdk::Status* status);
 
+    // the rows of response are the first byte_size bytes of buf, they are cut from buf without copy
+    static std::shared_ptr<::hybridse::sdk::ResultSet> MakeResultSet(const ::openmldb::api::QueryResponse& response,
+                                                                     butil::IOBuf* buf,
+                                                                     ::hybridse::sdk::Status* status);
+
     static std::shared_ptr<::hybridse::sdk::ResultSet> MakeResultSet(
         const std::shared_ptr<::openmldb::api::ScanResponse>& response,
         const ::google::protobuf::RepeatedField<uint32_t>& projection, const std::shared_ptr<brpc::Controller>& cntl,
@@ -20,6 +20,7 @@
 #include <fstream>
 #include <future>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -1011,14 +1012,17 @@ std::shared_ptr<SQLCache> SQLClusterRouter::GetSQLCache(const std::string& db, c
 
 std::shared_ptr<::openmldb::client::TabletClient> SQLClusterRouter::GetTabletClient(
     const std::string& db, const std::string& sql, const ::hybridse::vm::EngineMode engine_mode,
-    const std::shared_ptr<SQLRequestRow>& row, hybridse::sdk::Status* status) {
-    return GetTabletClient(db, sql, engine_mode, row, std::shared_ptr<openmldb::sdk::SQLRequestRow>(), status);
+    const std::shared_ptr<SQLRequestRow>& row, hybridse::sdk::Status* status, int32_t* pid) {
+    return GetTabletClient(db, sql, engine_mode, row, std::shared_ptr<openmldb::sdk::SQLRequestRow>(), status, pid);
 }
 std::shared_ptr<::openmldb::client::TabletClient> SQLClusterRouter::GetTabletClient(
     const std::string& db, const std::string& sql, const ::hybridse::vm::EngineMode engine_mode,
     const std::shared_ptr<SQLRequestRow>& row, const std::shared_ptr<openmldb::sdk::SQLRequestRow>& parameter,
-    hybridse::sdk::Status* status) {
+    hybridse::sdk::Status* status, int32_t* pid) {
     RET_IF_NULL_AND_WARN(status, "output status is nullptr");
+    if (pid != nullptr) {
+        *pid = -1;
+    }
     auto cache = GetSQLCache(db, sql, engine_mode, parameter, status);
     WARN_NOT_OK_AND_RET(status, "sql plan failed(get/create cache failed)", nullptr);
     std::shared_ptr<::openmldb::catalog::TabletAccessor> tablet;
@@ -1033,7 +1037,11 @@ std::shared_ptr<::openmldb::client::TabletClient> SQLClusterRouter::GetTabletCli
                 DLOG(INFO) << "get main table" << main_table;
                 std::string val;
                 if (!col.empty() && row && row->GetRecordVal(col, &val)) {
-                    tablet = cluster_sdk_->GetTablet(main_db, main_table, val);
+                    uint32_t routed_pid = 0;
+                    tablet = cluster_sdk_->GetTablet(main_db, main_table, val, &routed_pid);
+                    if (tablet && pid != nullptr) {
+                        *pid = routed_pid;
+                    }
                 }
                 if (!tablet) {
                     tablet = cluster_sdk_->GetTablet(main_db, main_table);
@@ -1101,8 +1109,12 @@ std::shared_ptr<TableReader> SQLClusterRouter::GetTableReader() {
 std::shared_ptr<openmldb::client::TabletClient> SQLClusterRouter::GetTablet(const std::string& db,
                                                                             const std::string& sp_name,
                                                                             const std::string& router_col,
-                                                                            hybridse::sdk::Status* status) {
+                                                                            hybridse::sdk::Status* status,
+                                                                            int32_t* pid) {
     RET_IF_NULL_AND_WARN(status, "output status is nullptr");
+    if (pid != nullptr) {
+        *pid = -1;
+    }
     auto sp_info = cluster_sdk_->GetProcedureInfo(db, sp_name, &status->msg);
     if (!sp_info) {
         CODE_PREPEND_AND_WARN(status, StatusCode::kCmdError, "procedure not found");
@@ -1114,7 +1126,11 @@ std::shared_ptr<openmldb::client::TabletClient> SQLClusterRouter::GetTablet(cons
     if (router_col.empty()) {
         tablet = cluster_sdk_->GetTablet(db_name, table);
     } else {
-        tablet = cluster_sdk_->GetTablet(db_name, table, router_col);
+        uint32_t routed_pid = 0;
+        tablet = cluster_sdk_->GetTablet(db_name, table, router_col, &routed_pid);
+        if (tablet && pid != nullptr) {
+            *pid = routed_pid;
+        }
     }
     if (!tablet) {
         SET_STATUS_AND_WARN(status, StatusCode::kCmdError, "fail to get tablet, table " + db_name + "." + table);
@@ -1166,7 +1182,8 @@ std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::ExecuteSQLRequest(co
     auto cntl = std::make_shared<::brpc::Controller>();
     cntl->set_timeout_ms(options_->request_timeout);
     auto response = std::make_shared<::openmldb::api::QueryResponse>();
-    auto client = GetTabletClient(db, sql, hybridse::vm::kRequestMode, row, status);
+    int32_t pid = -1;
+    auto client = GetTabletClient(db, sql, hybridse::vm::kRequestMode, row, status, &pid);
     if (0 != status->code) {
         return {};
     }
@@ -1174,7 +1191,7 @@ std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::ExecuteSQLRequest(co
         SET_STATUS_AND_WARN(status, StatusCode::kCmdError, "tablet client not found");
         return {};
     }
-    if (!client->Query(db, sql, row->GetRow(), cntl.get(), response.get(), options_->enable_debug) ||
+    if (!client->Query(db, sql, row->GetRow(), cntl.get(), response.get(), options_->enable_debug, pid) ||
         response->code() != ::openmldb::base::kOk) {
         RPC_STATUS_AND_WARN(status, cntl, response, "Query request rpc failed");
         return {};
@@ -1269,15 +1286,13 @@ bool SQLClusterRouter::ExecuteInsert(const std::string& db, const std::string& s
     }
 
     std::vector<size_t> fails;
+    std::vector<std::shared_ptr<SQLInsertRow>> rows;
+    // the position of each row in the statement
+    std::vector<size_t> row_pos;
     if (!codegen_rows.empty()) {
         for (size_t i = 0; i < codegen_rows.size(); ++i) {
-            auto r = codegen_rows[i];
-            auto row = std::make_shared<SQLInsertRow>(table_info, schema, r, put_if_absent);
-            if (!PutRow(table_info->tid(), row, tablets, status)) {
-                LOG(WARNING) << "fail to put row[" << i << "] due to: " << status->msg;
-                fails.push_back(i);
-                continue;
-            }
+            rows.push_back(std::make_shared<SQLInsertRow>(table_info, schema, codegen_rows[i], put_if_absent));
+            row_pos.push_back(i);
         }
     } else {
         for (size_t i = 0; i < default_maps.size(); i++) {
@@ -1289,13 +1304,16 @@ bool SQLClusterRouter::ExecuteInsert(const std::string& db, const std::string& s
                 fails.push_back(i);
                 continue;
             }
-            if (!PutRow(table_info->tid(), row, tablets, status)) {
-                LOG(WARNING) << "fail to put row[" << i << "] due to: " << status->msg;
-                fails.push_back(i);
-                continue;
-            }
+            rows.push_back(row);
+            row_pos.push_back(i);
         }
     }
+    std::vector<size_t> put_fails;
+    PutRows(table_info->tid(), rows, tablets, &put_fails, status);
+    for (auto idx : put_fails) {
+        fails.push_back(row_pos[idx]);
+    }
+    std::sort(fails.begin(), fails.end());
     if (!fails.empty()) {
         auto ori_size = fails.size();
         // for peek
@@ -1496,31 +1514,133 @@ bool SQLClusterRouter::PutRow(uint32_t tid, const std::shared_ptr<SQLInsertRow>&
     return true;
 }
 
+bool SQLClusterRouter::PutRows(uint32_t tid, const std::vector<std::shared_ptr<SQLInsertRow>>& rows,
+                               const std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>>& tablets,
+                               std::vector<size_t>* fails, ::hybridse::sdk::Status* status) {
+    RET_FALSE_IF_NULL_AND_WARN(status, "output status is nullptr");
+    RET_FALSE_IF_NULL_AND_WARN(fails, "output fails is nullptr");
+    fails->clear();
+    if (rows.empty()) {
+        return true;
+    }
+    bool put_if_absent = rows[0]->IsPutIfAbsent();
+    bool same_put_if_absent = std::all_of(rows.begin(), rows.end(), [put_if_absent](const auto& row) {
+        return row->IsPutIfAbsent() == put_if_absent;
+    });
+    // iot tables check the primary key before put, so the rows are put one by one
+    if (rows.size() == 1 || !same_put_if_absent || IsIOT(rows[0]->GetTableInfo())) {
+        for (size_t i = 0; i < rows.size(); i++) {
+            if (!PutRow(tid, rows[i], tablets, status)) {
+                LOG(WARNING) << "fail to put row[" << i << "] due to: " << status->msg;
+                fails->push_back(i);
+            }
+        }
+        return fails->empty();
+    }
+    uint64_t cur_ts = ::baidu::common::timer::get_micros() / 1000;
+    // group the rows by partition, each partition gets the rows in one rpc
+    std::map<uint32_t, ::google::protobuf::RepeatedPtrField<::openmldb::api::PutBatchRequest::Row>> pid_rows;
+    std::map<uint32_t, std::vector<size_t>> pid_row_idx;
+    for (size_t i = 0; i < rows.size(); i++) {
+        for (const auto& kv : rows[i]->GetDimensions()) {
+            auto pb_row = pid_rows[kv.first].Add();
+            pb_row->set_time(cur_ts);
+            pb_row->set_value(rows[i]->GetRow());
+            for (const auto& dim : kv.second) {
+                auto pb_dim = pb_row->add_dimensions();
+                pb_dim->set_key(dim.first);
+                pb_dim->set_idx(dim.second);
+            }
+            pid_row_idx[kv.first].push_back(i);
+        }
+    }
+    std::vector<bool> failed(rows.size(), false);
+    for (auto& kv : pid_rows) {
+        uint32_t pid = kv.first;
+        const auto& row_idx = pid_row_idx[pid];
+        std::shared_ptr<::openmldb::client::TabletClient> client;
+        if (pid < tablets.size() && tablets[pid]) {
+            client = tablets[pid]->GetClient();
+        }
+        if (!client) {
+            SET_STATUS_AND_WARN(status, StatusCode::kCmdError, "fail to get tablet client. pid " + std::to_string(pid));
+            for (auto idx : row_idx) {
+                failed[idx] = true;
+            }
+            continue;
+        }
+        DLOG(INFO) << "put " << kv.second.size() << " rows to endpoint " << client->GetEndpoint();
+        std::vector<base::Status> row_status;
+        auto ret = client->PutBatch(tid, pid, &kv.second, put_if_absent, &row_status);
+        if (!ret.OK()) {
+            APPEND_FROM_BASE_AND_WARN(status, ret, "put failed");
+        }
+        for (size_t i = 0; i < row_idx.size(); i++) {
+            if (i >= row_status.size() || !row_status[i].OK()) {
+                failed[row_idx[i]] = true;
+            }
+        }
+    }
+    for (size_t i = 0; i < rows.size(); i++) {
+        if (!failed[i]) {
+            continue;
+        }
+        fails->push_back(i);
+        // the row may be put into other partitions, remove it from all of them
+        const auto& dimensions = rows[i]->GetDimensions();
+        if (auto rp = RevertPut(rows[i]->GetTableInfo(), dimensions.rbegin()->first, dimensions, cur_ts,
+                                base::Slice(rows[i]->GetRow()), tablets);
+            !rp.IsOK()) {
+            APPEND_AND_WARN(status, "tid " + std::to_string(tid) + ". RevertPut failed: " + rp.ToString() +
+                                        "Note that data might have been partially inserted. "
+                                        "You are encouraged to perform DELETE to remove any "
+                                        "partially inserted data before trying INSERT again.");
+        }
+    }
+    return fails->empty();
+}
+
 bool SQLClusterRouter::ExecuteInsert(const std::string& db, const std::string& sql, std::shared_ptr<SQLInsertRows> rows,
                                      hybridse::sdk::Status* status) {
+    std::vector<uint32_t> fails;
+    return ExecuteInsert(db, sql, rows, &fails, status);
+}
+
+bool SQLClusterRouter::ExecuteInsert(const std::string& db, const std::string& sql, std::shared_ptr<SQLInsertRows> rows,
+                                     std::vector<uint32_t>* fails, hybridse::sdk::Status* status) {
     RET_FALSE_IF_NULL_AND_WARN(status, "output status is nullptr");
+    RET_FALSE_IF_NULL_AND_WARN(fails, "output fails is nullptr");
+    fails->clear();
     if (!rows) {
         LOG(WARNING) << "input rows is nullptr";
         return false;
     }
+    // no row is put
+    auto fail_all = [&rows, fails]() {
+        for (uint32_t i = 0; i < rows->GetCnt(); ++i) {
+            fails->push_back(i);
+        }
+        return false;
+    };
     std::shared_ptr<SQLCache> cache = GetCache(db, sql, hybridse::vm::kBatchMode);
     if (cache) {
         std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>> tablets;
         bool ret = cluster_sdk_->GetTablet(db, cache->GetTableName(), &tablets);
         if (!ret || tablets.empty()) {
             status->msg = "fail to get table " + cache->GetTableName() + " tablet";
-            return false;
+            return fail_all();
         }
+        std::vector<std::shared_ptr<SQLInsertRow>> insert_rows;
         for (uint32_t i = 0; i < rows->GetCnt(); ++i) {
-            std::shared_ptr<SQLInsertRow> row = rows->GetRow(i);
-            if (!PutRow(cache->GetTableId(), row, tablets, status)) {
-                return false;
-            }
+            insert_rows.push_back(rows->GetRow(i));
         }
-        return true;
+        std::vector<size_t> fail_pos;
+        bool ok = PutRows(cache->GetTableId(), insert_rows, tablets, &fail_pos, status);
+        fails->assign(fail_pos.begin(), fail_pos.end());
+        return ok;
     } else {
         status->msg = "please use getInsertRow with " + sql + " first";
-        return false;
+        return fail_all();
     }
 }
 
@@ -1798,7 +1918,8 @@ std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::CallProcedure(const
                                                                           const std::string& router_col,
                                                                           hybridse::sdk::Status* status) {
     RET_IF_NULL_AND_WARN(status, "output status is nullptr");
-    auto tablet = GetTablet(db, sp_name, router_col, status);
+    int32_t pid = -1;
+    auto tablet = GetTablet(db, sp_name, router_col, status, &pid);
     if (!tablet) {
         SET_STATUS_AND_WARN(status, StatusCode::kCmdError, "cannot get tablet");
         return nullptr;
@@ -1807,7 +1928,7 @@ std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::CallProcedure(const
     auto cntl = std::make_shared<::brpc::Controller>();
     auto response = std::make_shared<::openmldb::api::QueryResponse>();
     bool ok = tablet->CallProcedure(db, sp_name, row, cntl.get(), response.get(), options_->enable_debug,
-                                    options_->request_timeout);
+                                    options_->request_timeout, pid);
     if (!ok || response->code() != ::openmldb::base::kOk) {
         RPC_STATUS_AND_WARN(status, cntl, response, "CallProcedure failed");
         return nullptr;
@@ -1815,6 +1936,98 @@ std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::CallProcedure(const
     return ResultSetSQL::MakeResultSet(response, cntl, status);
 }
 
+std::vector<std::shared_ptr<hybridse::sdk::ResultSet>> SQLClusterRouter::CallProcedures(
+    const std::string& db, const std::vector<std::string>& sp_names, std::shared_ptr<SQLRequestRow> row,
+    hybridse::sdk::Status* status) {
+    RET_IF_NULL_AND_WARN(status, "output status is nullptr");
+    if (!row || !row->OK()) {
+        SET_STATUS_AND_WARN(status, StatusCode::kCmdError, "make sure the request row is built before execute sql");
+        return {};
+    }
+    // each procedure is routed by the partition key of the row in its main table, the procedures routed to the
+    // same tablet are called together
+    struct TabletCall {
+        std::shared_ptr<openmldb::client::TabletClient> tablet;
+        std::vector<std::string> sp_names;
+        std::vector<size_t> positions;
+        openmldb::RpcCallback<openmldb::api::MultiProcedureQueryResponse>* callback = nullptr;
+        bool sent = false;
+    };
+    std::map<std::string, TabletCall> calls;
+    for (size_t i = 0; i < sp_names.size(); i++) {
+        auto sp_info = cluster_sdk_->GetProcedureInfo(db, sp_names[i], &status->msg);
+        if (!sp_info) {
+            CODE_PREPEND_AND_WARN(status, StatusCode::kProcedureNotFound, db + "-" + sp_names[i]);
+            return {};
+        }
+        // the row records the value of the router column if it is built by GetRequestRowByProcedure, otherwise
+        // the procedure goes to a tablet of its main table
+        std::string router_val;
+        int router_col = sp_info->GetRouterCol();
+        if (router_col >= 0 && router_col < sp_info->GetInputSchema().GetColumnCnt()) {
+            row->GetRecordVal(sp_info->GetInputSchema().GetColumnName(router_col), &router_val);
+        }
+        auto tablet = GetTablet(db, sp_names[i], router_val, status);
+        if (!tablet) {
+            return {};
+        }
+        auto& call = calls[tablet->GetEndpoint()];
+        call.tablet = tablet;
+        call.sp_names.push_back(sp_names[i]);
+        call.positions.push_back(i);
+    }
+    base::Slice data(row->GetRow());
+    for (auto& kv : calls) {
+        auto& call = kv.second;
+        call.callback = new openmldb::RpcCallback<openmldb::api::MultiProcedureQueryResponse>(
+            std::make_shared<openmldb::api::MultiProcedureQueryResponse>(), std::make_shared<brpc::Controller>());
+        // the callback is released by the rpc once it is done, keep it until the results are read
+        call.callback->Ref();
+        call.sent = call.tablet->CallProcedures(db, call.sp_names, data, options_->request_timeout,
+                                                options_->enable_debug, call.callback);
+        if (!call.sent) {
+            call.callback->UnRef();
+        }
+    }
+    std::vector<std::shared_ptr<hybridse::sdk::ResultSet>> result_sets(sp_names.size());
+    *status = {};
+    for (auto& kv : calls) {
+        auto& call = kv.second;
+        auto& cntl = call.callback->GetController();
+        auto& response = call.callback->GetResponse();
+        if (call.sent) {
+            brpc::Join(cntl->call_id());
+        }
+        if (!call.sent || cntl->Failed() || response->code() != ::openmldb::base::kOk ||
+            response->results_size() != static_cast<int>(call.sp_names.size())) {
+            if (status->IsOK()) {
+                RPC_STATUS_AND_WARN(status, cntl, response, "CallProcedures failed on tablet " + kv.first);
+            }
+            call.callback->UnRef();
+            continue;
+        }
+        auto& buf = cntl->response_attachment();
+        for (int i = 0; i < response->results_size(); i++) {
+            const auto& result = response->results(i);
+            if (result.code() != ::openmldb::base::kOk) {
+                if (status->IsOK()) {
+                    SET_STATUS_AND_WARN(status, StatusCode::kCmdError,
+                                        absl::StrCat("CallProcedures failed on ", call.sp_names[i], ": ",
+                                                     result.code(), " ", result.msg()));
+                }
+                continue;
+            }
+            hybridse::sdk::Status rs_status;
+            result_sets[call.positions[i]] = ResultSetSQL::MakeResultSet(result, &buf, &rs_status);
+            if (!rs_status.IsOK() && status->IsOK()) {
+                *status = rs_status;
+            }
+        }
+        call.callback->UnRef();
+    }
+    return result_sets;
+}
+
 std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::CallSQLBatchRequestProcedure(
     const std::string& db, const std::string& sp_name, std::shared_ptr<SQLRequestRowBatch> row_batch,
     hybridse::sdk::Status* status) {
@@ -2630,7 +2843,8 @@ std::shared_ptr<openmldb::sdk::QueryFuture> SQLClusterRouter::CallProcedure(cons
                                                                             const std::string& router_col,
                                                                             hybridse::sdk::Status* status) {
     RET_IF_NULL_AND_WARN(status, "output status is nullptr");
-    auto tablet = GetTablet(db, sp_name, router_col, status);
+    int32_t pid = -1;
+    auto tablet = GetTablet(db, sp_name, router_col, status, &pid);
     if (!tablet) {
         return {};
     }
@@ -2639,7 +2853,7 @@ std::shared_ptr<openmldb::sdk::QueryFuture> SQLClusterRouter::CallProcedure(cons
     auto* callback = new openmldb::RpcCallback<openmldb::api::QueryResponse>(response, cntl);
 
     std::shared_ptr<openmldb::sdk::QueryFutureImpl> future = std::make_shared<openmldb::sdk::QueryFutureImpl>(callback);
-    bool ok = tablet->CallProcedure(db, sp_name, row, timeout_ms, options_->enable_debug, callback);
+    bool ok = tablet->CallProcedure(db, sp_name, row, timeout_ms, options_->enable_debug, callback, pid);
     if (!ok) {
         // async rpc
         SET_STATUS_AND_WARN(status, StatusCode::kConnError, "CallProcedure failed(stub is null)");
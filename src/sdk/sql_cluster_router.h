@@ -88,6 +88,9 @@ class SQLClusterRouter : public SQLRouter {
     bool ExecuteInsert(const std::string& db, const std::string& sql, std::shared_ptr<SQLInsertRows> rows,
                        hybridse::sdk::Status* status) override;
 
+    bool ExecuteInsert(const std::string& db, const std::string& sql, std::shared_ptr<SQLInsertRows> rows,
+                       std::vector<uint32_t>* fails, hybridse::sdk::Status* status) override;
+
     bool ExecuteInsert(const std::string& db, const std::string& name, int tid, int partition_num,
                 hybridse::sdk::ByteArrayPtr dimension, int dimension_len,
                 hybridse::sdk::ByteArrayPtr value, int len, bool put_if_absent, hybridse::sdk::Status* status) override;
@@ -164,6 +167,11 @@ class SQLClusterRouter : public SQLRouter {
             hybridse::sdk::ByteArrayPtr buf, int len, const std::string& router_col,
             hybridse::sdk::Status* status) override;
 
+    std::vector<std::shared_ptr<hybridse::sdk::ResultSet>> CallProcedures(const std::string& db,
+                                                                          const std::vector<std::string>& sp_names,
+                                                                          std::shared_ptr<SQLRequestRow> row,
+                                                                          hybridse::sdk::Status* status) override;
+
     std::shared_ptr<hybridse::sdk::ResultSet> CallSQLBatchRequestProcedure(
         const std::string& db, const std::string& sp_name, std::shared_ptr<SQLRequestRowBatch> row_batch,
         hybridse::sdk::Status* status) override;
@@ -202,11 +210,12 @@ class SQLClusterRouter : public SQLRouter {
     std::shared_ptr<::openmldb::client::TabletClient> GetTabletClient(const std::string& db, const std::string& sql,
                                                                       ::hybridse::vm::EngineMode engine_mode,
                                                                       const std::shared_ptr<SQLRequestRow>& row,
-                                                                      hybridse::sdk::Status* status);
+                                                                      hybridse::sdk::Status* status,
+                                                                      int32_t* pid = nullptr);
     std::shared_ptr<::openmldb::client::TabletClient> GetTabletClient(
         const std::string& db, const std::string& sql, ::hybridse::vm::EngineMode engine_mode,
         const std::shared_ptr<SQLRequestRow>& row, const std::shared_ptr<SQLRequestRow>& parameter_row,
-        hybridse::sdk::Status* status);
+        hybridse::sdk::Status* status, int32_t* pid = nullptr);
 
     std::shared_ptr<SQLCache> GetSQLCache(const std::string& db, const std::string& sql,
                                           ::hybridse::vm::EngineMode engine_mode,
@@ -312,6 +321,10 @@ class SQLClusterRouter : public SQLRouter {
     bool PutRow(uint32_t tid, const std::shared_ptr<SQLInsertRow>& row,
                 const std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>>& tablets,
                 ::hybridse::sdk::Status* status);
+    // put the rows with one PutBatch rpc per partition, fails has the positions of the rows failed to put
+    bool PutRows(uint32_t tid, const std::vector<std::shared_ptr<SQLInsertRow>>& rows,
+                 const std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>>& tablets,
+                 std::vector<size_t>* fails, ::hybridse::sdk::Status* status);
 
     bool IsConstQuery(::hybridse::vm::PhysicalOpNode* node);
     std::shared_ptr<SQLCache> GetCache(const std::string& db, const std::string& sql,
@@ -338,8 +351,9 @@ class SQLClusterRouter : public SQLRouter {
 
     inline bool CheckSQLSyntax(const std::string& sql);
 
+    // pid is set to the partition routed by router_col, -1 if the tablet is not chosen by partition
     std::shared_ptr<openmldb::client::TabletClient> GetTablet(const std::string& db, const std::string& sp_name,
-            const std::string& router_col, hybridse::sdk::Status* status);
+            const std::string& router_col, hybridse::sdk::Status* status, int32_t* pid = nullptr);
 
     bool ExtractDBTypes(const std::shared_ptr<hybridse::sdk::Schema>& schema,
                         std::vector<openmldb::type::DataType>* parameter_types);
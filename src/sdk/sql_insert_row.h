@@ -224,6 +224,12 @@ class SQLInsertRows {
                   const std::vector<uint32_t>& hole_idx_arr, bool put_if_absent);
     ~SQLInsertRows() = default;
     std::shared_ptr<SQLInsertRow> NewRow();
+    // drop the last row got by NewRow, e.g. it can not be filled
+    inline void RemoveLast() {
+        if (!rows_.empty()) {
+            rows_.pop_back();
+        }
+    }
     inline uint32_t GetCnt() { return rows_.size(); }
     inline std::shared_ptr<SQLInsertRow> GetRow(uint32_t i) {
         if (i >= rows_.size()) {
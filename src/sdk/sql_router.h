@@ -101,6 +101,11 @@ class SQLRouter {
     virtual bool ExecuteInsert(const std::string& db, const std::string& sql,
                                std::shared_ptr<openmldb::sdk::SQLInsertRows> row, hybridse::sdk::Status* status) = 0;
 
+    // the same as above, fails has the positions of the rows failed to put, the other rows are put
+    virtual bool ExecuteInsert(const std::string& db, const std::string& sql,
+                               std::shared_ptr<openmldb::sdk::SQLInsertRows> rows, std::vector<uint32_t>* fails,
+                               hybridse::sdk::Status* status) = 0;
+
     virtual bool ExecuteInsert(const std::string& db, const std::string& name, int tid, int partition_num,
                 hybridse::sdk::ByteArrayPtr dimension, int dimension_len,
                 hybridse::sdk::ByteArrayPtr value, int len, bool put_if_absent, hybridse::sdk::Status* status) = 0;
@@ -164,6 +169,14 @@ class SQLRouter {
             hybridse::sdk::ByteArrayPtr buf, int len, const std::string& router_col,
             hybridse::sdk::Status* status) = 0;
 
+    /// call the procedures with the same request row, each procedure is routed by the partition key of the row
+    /// recorded by GetRequestRowByProcedure, the procedures on the same tablet are called by one rpc and run in
+    /// parallel. The result sets are in the order of sp_names, the result set of a failed procedure
+    /// is nullptr and status is the error of the first failed one
+    virtual std::vector<std::shared_ptr<hybridse::sdk::ResultSet>> CallProcedures(
+        const std::string& db, const std::vector<std::string>& sp_names,
+        std::shared_ptr<openmldb::sdk::SQLRequestRow> row, hybridse::sdk::Status* status) = 0;
+
     virtual std::shared_ptr<hybridse::sdk::ResultSet> CallSQLBatchRequestProcedure(
         const std::string& db, const std::string& sp_name, std::shared_ptr<openmldb::sdk::SQLRequestRowBatch> row_batch,
         hybridse::sdk::Status* status) = 0;
@@ -68,6 +68,7 @@
 %shared_ptr(openmldb::sdk::DefaultValueContainer);
 %template(VectorUint32) std::vector<uint32_t>;
 %template(VectorString) std::vector<std::string>;
+%template(VectorResultSet) std::vector<std::shared_ptr<hybridse::sdk::ResultSet>>;
 
 %shared_ptr(openmldb::sdk::DAGNode);
 %{
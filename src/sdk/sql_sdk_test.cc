@@ -568,6 +568,83 @@ TEST_F(SQLSDKQueryTest, RequestProcedureTest) {
     ASSERT_TRUE(router->ExecuteDDL(db, "drop table trans;", &status));
 }
 
+TEST_F(SQLSDKQueryTest, MultiProcedureTest) {
+    std::string ddl =
+        "create table trans(c1 string,\n"
+        "                   c3 int,\n"
+        "                   c4 bigint,\n"
+        "                   c7 timestamp,\n"
+        "                   index(key=c1, ts=c7)) OPTIONS(replicanum=1, partitionnum=1);";
+    SQLRouterOptions sql_opt;
+    sql_opt.zk_cluster = mc_->GetZkCluster();
+    sql_opt.zk_path = mc_->GetZkPath();
+    sql_opt.zk_session_timeout = 30000;
+    sql_opt.enable_debug = hybridse::sqlcase::SqlCase::IsDebug();
+    auto router = NewClusterSQLRouter(sql_opt);
+    if (!router) {
+        FAIL() << "Fail new cluster sql router";
+    }
+    SetOnlineMode(router);
+    std::string db = "test_multi_sp";
+    hybridse::sdk::Status status;
+    router->CreateDB(db, &status);
+    ASSERT_TRUE(router->RefreshCatalog());
+    ASSERT_TRUE(router->ExecuteDDL(db, ddl, &status)) << status.msg;
+    ASSERT_TRUE(router->RefreshCatalog());
+    ASSERT_TRUE(router->ExecuteInsert(db, "insert into trans values(\"bb\",24,34,1590738994000);", &status));
+
+    std::string sum_sql =
+        "SELECT c1, sum(c4) OVER w1 as w1_c4_sum FROM trans WINDOW w1 AS"
+        " (PARTITION BY trans.c1 ORDER BY trans.c7 ROWS BETWEEN 2 PRECEDING AND CURRENT ROW);";
+    std::string count_sql =
+        "SELECT c1, c3, count(c4) OVER w1 as w1_c4_cnt FROM trans WINDOW w1 AS"
+        " (PARTITION BY trans.c1 ORDER BY trans.c7 ROWS BETWEEN 2 PRECEDING AND CURRENT ROW);";
+    std::string sp_params = " (const c1 string, const c3 int, c4 bigint, const c7 timestamp)";
+    ASSERT_TRUE(router->ExecuteDDL(db, "create procedure sp_sum" + sp_params + " begin " + sum_sql + " end;", &status))
+        << status.msg;
+    ASSERT_TRUE(
+        router->ExecuteDDL(db, "create procedure sp_count" + sp_params + " begin " + count_sql + " end;", &status))
+        << status.msg;
+    ASSERT_TRUE(router->RefreshCatalog());
+
+    auto request_row = router->GetRequestRowByProcedure(db, "sp_sum", &status);
+    ASSERT_TRUE(request_row);
+    request_row->Init(2);
+    ASSERT_TRUE(request_row->AppendString("bb"));
+    ASSERT_TRUE(request_row->AppendInt32(23));
+    ASSERT_TRUE(request_row->AppendInt64(33));
+    ASSERT_TRUE(request_row->AppendTimestamp(1590738994000));
+    ASSERT_TRUE(request_row->Build());
+    auto result_sets = router->CallProcedures(db, {"sp_count", "sp_sum", "sp_count"}, request_row, &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    ASSERT_EQ(3u, result_sets.size());
+    for (size_t i : {0, 2}) {
+        auto& rs = result_sets[i];
+        ASSERT_TRUE(rs);
+        ASSERT_EQ(3, rs->GetSchema()->GetColumnCnt());
+        ASSERT_TRUE(rs->Next());
+        ASSERT_EQ(rs->GetStringUnsafe(0), "bb");
+        ASSERT_EQ(rs->GetInt32Unsafe(1), 23);
+        ASSERT_EQ(rs->GetInt64Unsafe(2), 2);
+        ASSERT_FALSE(rs->Next());
+    }
+    auto& rs = result_sets[1];
+    ASSERT_TRUE(rs);
+    ASSERT_EQ(2, rs->GetSchema()->GetColumnCnt());
+    ASSERT_TRUE(rs->Next());
+    ASSERT_EQ(rs->GetStringUnsafe(0), "bb");
+    ASSERT_EQ(rs->GetInt64Unsafe(1), 67);
+    ASSERT_FALSE(rs->Next());
+
+    result_sets = router->CallProcedures(db, {"sp_sum", "sp_not_exist"}, request_row, &status);
+    ASSERT_FALSE(status.IsOK());
+    ASSERT_TRUE(result_sets.empty());
+
+    ASSERT_TRUE(router->ExecuteDDL(db, "drop procedure sp_sum;", &status));
+    ASSERT_TRUE(router->ExecuteDDL(db, "drop procedure sp_count;", &status));
+    ASSERT_TRUE(router->ExecuteDDL(db, "drop table trans;", &status));
+}
+
 TEST_F(SQLSDKQueryTest, DropTableWithProcedureTest) {
     // create table trans
     std::string ddl =
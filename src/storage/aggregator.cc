@@ -1235,6 +1235,188 @@ bool AvgAggregator::DecodeAggrVal(const int8_t* row_ptr, AggrBuffer* buffer) {
     return true;
 }
 
+SketchBaseAggregator::SketchBaseAggregator(const ::openmldb::api::TableMeta& base_meta,
+        std::shared_ptr<Table> base_table,
+        const ::openmldb::api::TableMeta& aggr_meta, std::shared_ptr<Table> aggr_table,
+        std::shared_ptr<LogReplicator> aggr_replicator,
+        uint32_t index_pos, const std::string& aggr_col, const AggrType& aggr_type,
+        const std::string& ts_col, WindowType window_tpye, uint32_t window_size)
+    : Aggregator(base_meta, base_table, aggr_meta, aggr_table, aggr_replicator, index_pos,
+            aggr_col, aggr_type, ts_col, window_tpye, window_size) {}
+
+template <class Fn>
+bool SketchBaseAggregator::VisitAggrVal(const codec::RowView& row_view, const int8_t* row_ptr, Fn&& fn) {
+    switch (aggr_col_type_) {
+        case DataType::kSmallInt: {
+            int16_t val;
+            row_view.GetValue(row_ptr, aggr_col_idx_, aggr_col_type_, &val);
+            return fn(static_cast<int64_t>(val));
+        }
+        case DataType::kDate:
+        case DataType::kInt: {
+            int32_t val;
+            row_view.GetValue(row_ptr, aggr_col_idx_, aggr_col_type_, &val);
+            return fn(static_cast<int64_t>(val));
+        }
+        case DataType::kTimestamp:
+        case DataType::kBigInt: {
+            int64_t val;
+            row_view.GetValue(row_ptr, aggr_col_idx_, aggr_col_type_, &val);
+            return fn(val);
+        }
+        case DataType::kFloat: {
+            float val;
+            row_view.GetValue(row_ptr, aggr_col_idx_, aggr_col_type_, &val);
+            return fn(static_cast<double>(val));
+        }
+        case DataType::kDouble: {
+            double val;
+            row_view.GetValue(row_ptr, aggr_col_idx_, aggr_col_type_, &val);
+            return fn(val);
+        }
+        case DataType::kString:
+        case DataType::kVarchar: {
+            char* ch = nullptr;
+            uint32_t ch_length = 0;
+            row_view.GetValue(row_ptr, aggr_col_idx_, &ch, &ch_length);
+            return fn(absl::string_view(ch, ch_length));
+        }
+        default: {
+            PDLOG(ERROR, "Unsupported data type");
+            return false;
+        }
+    }
+}
+
+bool SketchBaseAggregator::EncodeAggrVal(const AggrBuffer& buffer, std::string* aggr_val) {
+    aggr_val->clear();
+    if (buffer.sketch_) {
+        buffer.sketch_->Encode(aggr_val);
+    } else {
+        NewSketch()->Encode(aggr_val);
+    }
+    return true;
+}
+
+bool SketchBaseAggregator::DecodeAggrVal(const int8_t* row_ptr, AggrBuffer* buffer) {
+    char* aggr_val = nullptr;
+    uint32_t ch_length = 0;
+    if (aggr_row_view_.GetValue(row_ptr, 4, &aggr_val, &ch_length) == 1) {
+        return true;
+    }
+    if (!GetSketch(buffer)->Decode(absl::string_view(aggr_val, ch_length))) {
+        PDLOG(ERROR, "Decode sketch failed");
+        return false;
+    }
+    return true;
+}
+
+DistinctCountAggregator::DistinctCountAggregator(const ::openmldb::api::TableMeta& base_meta,
+        std::shared_ptr<Table> base_table,
+        const ::openmldb::api::TableMeta& aggr_meta, std::shared_ptr<Table> aggr_table,
+        std::shared_ptr<LogReplicator> aggr_replicator,
+        uint32_t index_pos, const std::string& aggr_col, const AggrType& aggr_type,
+        const std::string& ts_col, WindowType window_tpye, uint32_t window_size)
+    : SketchBaseAggregator(base_meta, base_table, aggr_meta, aggr_table, aggr_replicator, index_pos,
+            aggr_col, aggr_type, ts_col, window_tpye, window_size) {}
+
+std::unique_ptr<hybridse::vm::Sketch> DistinctCountAggregator::NewSketch() const {
+    return std::make_unique<hybridse::vm::HyperLogLog>();
+}
+
+bool DistinctCountAggregator::UpdateAggrVal(const codec::RowView& row_view, const int8_t* row_ptr,
+                                            AggrBuffer* aggr_buffer) {
+    if (row_view.IsNULL(row_ptr, aggr_col_idx_)) {
+        return true;
+    }
+    auto sketch = static_cast<hybridse::vm::HyperLogLog*>(GetSketch(aggr_buffer));
+    bool ok = VisitAggrVal(row_view, row_ptr, [sketch](const auto& val) {
+        sketch->Add(val);
+        return true;
+    });
+    if (ok) {
+        aggr_buffer->non_null_cnt_++;
+    }
+    return ok;
+}
+
+MedianAggregator::MedianAggregator(const ::openmldb::api::TableMeta& base_meta, std::shared_ptr<Table> base_table,
+        const ::openmldb::api::TableMeta& aggr_meta, std::shared_ptr<Table> aggr_table,
+        std::shared_ptr<LogReplicator> aggr_replicator,
+        uint32_t index_pos, const std::string& aggr_col, const AggrType& aggr_type,
+        const std::string& ts_col, WindowType window_tpye, uint32_t window_size)
+    : SketchBaseAggregator(base_meta, base_table, aggr_meta, aggr_table, aggr_replicator, index_pos,
+            aggr_col, aggr_type, ts_col, window_tpye, window_size) {}
+
+std::unique_ptr<hybridse::vm::Sketch> MedianAggregator::NewSketch() const {
+    return std::make_unique<hybridse::vm::TDigest>();
+}
+
+bool MedianAggregator::UpdateAggrVal(const codec::RowView& row_view, const int8_t* row_ptr,
+                                     AggrBuffer* aggr_buffer) {
+    if (row_view.IsNULL(row_ptr, aggr_col_idx_)) {
+        return true;
+    }
+    auto sketch = static_cast<hybridse::vm::TDigest*>(GetSketch(aggr_buffer));
+    bool ok = VisitAggrVal(row_view, row_ptr, [sketch](const auto& val) {
+        if constexpr (std::is_arithmetic_v<std::decay_t<decltype(val)>>) {
+            sketch->Add(val);
+            return true;
+        } else {
+            PDLOG(ERROR, "Unsupported data type");
+            return false;
+        }
+    });
+    if (ok) {
+        aggr_buffer->non_null_cnt_++;
+    }
+    return ok;
+}
+
+TopNFrequencyAggregator::TopNFrequencyAggregator(const ::openmldb::api::TableMeta& base_meta,
+        std::shared_ptr<Table> base_table,
+        const ::openmldb::api::TableMeta& aggr_meta, std::shared_ptr<Table> aggr_table,
+        std::shared_ptr<LogReplicator> aggr_replicator,
+        uint32_t index_pos, const std::string& aggr_col, const AggrType& aggr_type,
+        const std::string& ts_col, WindowType window_tpye, uint32_t window_size)
+    : SketchBaseAggregator(base_meta, base_table, aggr_meta, aggr_table, aggr_replicator, index_pos,
+            aggr_col, aggr_type, ts_col, window_tpye, window_size) {}
+
+std::unique_ptr<hybridse::vm::Sketch> TopNFrequencyAggregator::NewSketch() const {
+    // the key type is the same as hybridse::vm::TopNKey of the column type
+    switch (aggr_col_type_) {
+        case DataType::kFloat:
+        case DataType::kDouble:
+            return std::make_unique<hybridse::vm::SpaceSaving<double>>();
+        case DataType::kString:
+        case DataType::kVarchar:
+            return std::make_unique<hybridse::vm::SpaceSaving<std::string>>();
+        default:
+            return std::make_unique<hybridse::vm::SpaceSaving<int64_t>>();
+    }
+}
+
+bool TopNFrequencyAggregator::UpdateAggrVal(const codec::RowView& row_view, const int8_t* row_ptr,
+                                            AggrBuffer* aggr_buffer) {
+    if (row_view.IsNULL(row_ptr, aggr_col_idx_)) {
+        return true;
+    }
+    auto sketch = GetSketch(aggr_buffer);
+    bool ok = VisitAggrVal(row_view, row_ptr, [sketch](const auto& val) {
+        using V = std::decay_t<decltype(val)>;
+        if constexpr (std::is_arithmetic_v<V>) {
+            static_cast<hybridse::vm::SpaceSaving<V>*>(sketch)->Add(val);
+        } else {
+            static_cast<hybridse::vm::SpaceSaving<std::string>*>(sketch)->Add(std::string(val));
+        }
+        return true;
+    });
+    if (ok) {
+        aggr_buffer->non_null_cnt_++;
+    }
+    return ok;
+}
+
 std::shared_ptr<Aggregator> CreateAggregator(const ::openmldb::api::TableMeta& base_meta,
                                              std::shared_ptr<Table> base_table,
                                              const ::openmldb::api::TableMeta& aggr_meta,
@@ -1298,6 +1480,16 @@ std::shared_ptr<Aggregator> CreateAggregator(const ::openmldb::api::TableMeta& b
     } else if (aggr_type == "avg" || aggr_type == "avg_where") {
         agg = std::make_shared<AvgAggregator>(base_meta, base_table, aggr_meta, aggr_table, aggr_replicator,
                 index_pos, aggr_col, AggrType::kAvg, ts_col, window_type, window_size);
+    } else if (aggr_type == "distinct_count") {
+        agg = std::make_shared<DistinctCountAggregator>(base_meta, base_table, aggr_meta, aggr_table,
+                aggr_replicator, index_pos, aggr_col, AggrType::kDistinctCount, ts_col, window_type, window_size);
+    } else if (aggr_type == "median" || aggr_type == "percentile") {
+        // the t-digest of a bucket does not depend on the percentage
+        agg = std::make_shared<MedianAggregator>(base_meta, base_table, aggr_meta, aggr_table, aggr_replicator,
+                index_pos, aggr_col, AggrType::kMedian, ts_col, window_type, window_size);
+    } else if (aggr_type == "topn_frequency") {
+        agg = std::make_shared<TopNFrequencyAggregator>(base_meta, base_table, aggr_meta, aggr_table,
+                aggr_replicator, index_pos, aggr_col, AggrType::kTopNFrequency, ts_col, window_type, window_size);
     } else {
         PDLOG(ERROR, "Unsupported aggregate function type");
         return {};
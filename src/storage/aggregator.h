@@ -28,6 +28,7 @@
 #include "proto/type.pb.h"
 #include "replica/log_replicator.h"
 #include "storage/table.h"
+#include "vm/sketch.h"
 
 namespace openmldb {
 namespace storage {
@@ -43,6 +44,9 @@ enum class AggrType {
     kMax = 3,
     kCount = 4,
     kAvg = 5,
+    kDistinctCount = 6,
+    kMedian = 7,
+    kTopNFrequency = 8,
 };
 
 enum class WindowType {
@@ -75,6 +79,8 @@ class AggrBuffer {
     int64_t non_null_cnt_;
     int32_t aggr_cnt_;
     DataType data_type_;
+    // the state of sketch based aggregation, e.g. distinct_count
+    std::unique_ptr<hybridse::vm::Sketch> sketch_;
     AggrBuffer() : aggr_val_(), ts_begin_(-1), ts_end_(0), binlog_offset_(0), non_null_cnt_(0), aggr_cnt_(0) {}
     AggrBuffer(const AggrBuffer& buffer) {
         memcpy(&aggr_val_, &buffer.aggr_val_, sizeof(aggr_val_));
@@ -90,6 +96,9 @@ class AggrBuffer {
                 memcpy(aggr_val_.vstring.data, buffer.aggr_val_.vstring.data, buffer.aggr_val_.vstring.len);
             }
         }
+        if (buffer.sketch_) {
+            sketch_ = buffer.sketch_->Clone();
+        }
     }
     AggrBuffer& operator=(const AggrBuffer& buffer) = delete;
     ~AggrBuffer() { Clear(); }
@@ -100,6 +109,9 @@ class AggrBuffer {
             }
         }
         memset(&aggr_val_, 0, sizeof(aggr_val_));
+        if (sketch_) {
+            sketch_->Clear();
+        }
         ts_begin_ = -1;
         ts_end_ = 0;
         aggr_cnt_ = 0;
@@ -319,6 +331,87 @@ class AvgAggregator : public Aggregator {
     bool DecodeAggrVal(const int8_t* row_ptr, AggrBuffer* buffer) override;
 };
 
+// the aggregators keep a sketch in aggr buffer, agg_val is the encoded sketch
+// which is merged by the engine, see hybridse/src/vm/sketch.h
+class SketchBaseAggregator : public Aggregator {
+ public:
+    SketchBaseAggregator(const ::openmldb::api::TableMeta& base_meta, std::shared_ptr<Table> base_table,
+            const ::openmldb::api::TableMeta& aggr_meta, std::shared_ptr<Table> aggr_table,
+            std::shared_ptr<LogReplicator> aggr_replicator,
+            uint32_t index_pos, const std::string& aggr_col, const AggrType& aggr_type,
+            const std::string& ts_col, WindowType window_tpye, uint32_t window_size);
+
+    ~SketchBaseAggregator() = default;
+
+ protected:
+    virtual std::unique_ptr<hybridse::vm::Sketch> NewSketch() const = 0;
+
+    hybridse::vm::Sketch* GetSketch(AggrBuffer* aggr_buffer) const {
+        if (!aggr_buffer->sketch_) {
+            aggr_buffer->sketch_ = NewSketch();
+        }
+        return aggr_buffer->sketch_.get();
+    }
+
+    // call fn with the aggr column value of row, integral values are passed as int64_t,
+    // floating values as double and strings as absl::string_view.
+    template <class Fn>
+    bool VisitAggrVal(const codec::RowView& row_view, const int8_t* row_ptr, Fn&& fn);
+
+ private:
+    bool EncodeAggrVal(const AggrBuffer& buffer, std::string* aggr_val) override;
+
+    bool DecodeAggrVal(const int8_t* row_ptr, AggrBuffer* buffer) override;
+};
+
+class DistinctCountAggregator : public SketchBaseAggregator {
+ public:
+    DistinctCountAggregator(const ::openmldb::api::TableMeta& base_meta, std::shared_ptr<Table> base_table,
+            const ::openmldb::api::TableMeta& aggr_meta, std::shared_ptr<Table> aggr_table,
+            std::shared_ptr<LogReplicator> aggr_replicator,
+            uint32_t index_pos, const std::string& aggr_col, const AggrType& aggr_type,
+            const std::string& ts_col, WindowType window_tpye, uint32_t window_size);
+
+    ~DistinctCountAggregator() = default;
+
+ private:
+    std::unique_ptr<hybridse::vm::Sketch> NewSketch() const override;
+
+    bool UpdateAggrVal(const codec::RowView& row_view, const int8_t* row_ptr, AggrBuffer* aggr_buffer) override;
+};
+
+class MedianAggregator : public SketchBaseAggregator {
+ public:
+    MedianAggregator(const ::openmldb::api::TableMeta& base_meta, std::shared_ptr<Table> base_table,
+            const ::openmldb::api::TableMeta& aggr_meta, std::shared_ptr<Table> aggr_table,
+            std::shared_ptr<LogReplicator> aggr_replicator,
+            uint32_t index_pos, const std::string& aggr_col, const AggrType& aggr_type,
+            const std::string& ts_col, WindowType window_tpye, uint32_t window_size);
+
+    ~MedianAggregator() = default;
+
+ private:
+    std::unique_ptr<hybridse::vm::Sketch> NewSketch() const override;
+
+    bool UpdateAggrVal(const codec::RowView& row_view, const int8_t* row_ptr, AggrBuffer* aggr_buffer) override;
+};
+
+class TopNFrequencyAggregator : public SketchBaseAggregator {
+ public:
+    TopNFrequencyAggregator(const ::openmldb::api::TableMeta& base_meta, std::shared_ptr<Table> base_table,
+            const ::openmldb::api::TableMeta& aggr_meta, std::shared_ptr<Table> aggr_table,
+            std::shared_ptr<LogReplicator> aggr_replicator,
+            uint32_t index_pos, const std::string& aggr_col, const AggrType& aggr_type,
+            const std::string& ts_col, WindowType window_tpye, uint32_t window_size);
+
+    ~TopNFrequencyAggregator() = default;
+
+ private:
+    std::unique_ptr<hybridse::vm::Sketch> NewSketch() const override;
+
+    bool UpdateAggrVal(const codec::RowView& row_view, const int8_t* row_ptr, AggrBuffer* aggr_buffer) override;
+};
+
 std::shared_ptr<Aggregator> CreateAggregator(const ::openmldb::api::TableMeta& base_meta,
                                              std::shared_ptr<Table> base_table,
                                              const ::openmldb::api::TableMeta& aggr_meta,
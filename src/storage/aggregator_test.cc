@@ -723,6 +723,65 @@ TEST_F(AggregatorTest, CountWhereAggregatorUpdate) {
     ASSERT_EQ(last_buffer->non_null_cnt_, 0);
 }
 
+// check the sketch decoded from agg_val of the i-th bucket, whose rows are i * 2 and i * 2 + 1
+template <typename S, typename Fn>
+void CheckSketchAggrResult(std::shared_ptr<Table> aggr_table, Fn&& check) {
+    ASSERT_EQ(aggr_table->GetRecordCnt(), 50);
+    auto it = aggr_table->NewTraverseIterator(0);
+    it->SeekToFirst();
+    for (int i = 50 - 1; i >= 0; --i) {
+        ASSERT_TRUE(it->Valid());
+        auto tmp_val = it->GetValue();
+        std::string origin_data = tmp_val.ToString();
+        codec::RowView origin_row_view(aggr_table->GetTableMeta()->column_desc(),
+                                       reinterpret_cast<int8_t*>(const_cast<char*>(origin_data.c_str())),
+                                       origin_data.size());
+        char* ch = NULL;
+        uint32_t ch_length = 0;
+        origin_row_view.GetString(4, &ch, &ch_length);
+        S sketch;
+        ASSERT_TRUE(sketch.Decode(absl::string_view(ch, ch_length)));
+        check(i, &sketch);
+        it->Next();
+    }
+}
+
+TEST_F(AggregatorTest, SketchAggregatorUpdate) {
+    std::shared_ptr<Aggregator> aggregator;
+    AggrBuffer* last_buffer;
+    std::shared_ptr<Table> aggr_table;
+    ASSERT_TRUE(GetUpdatedResult(counter, "col9", "distinct_count", "1s", aggregator, aggr_table, &last_buffer));
+    ASSERT_EQ(aggregator->GetAggrType(), AggrType::kDistinctCount);
+    CheckSketchAggrResult<hybridse::vm::HyperLogLog>(
+        aggr_table, [](int i, hybridse::vm::HyperLogLog* sketch) { ASSERT_EQ(sketch->Estimate(), 2); });
+    ASSERT_EQ(last_buffer->non_null_cnt_, 1);
+    ASSERT_EQ(static_cast<hybridse::vm::HyperLogLog*>(last_buffer->sketch_.get())->Estimate(), 1);
+    counter += 2;
+    ASSERT_TRUE(GetUpdatedResult(counter, "col7", "median", "1s", aggregator, aggr_table, &last_buffer));
+    CheckSketchAggrResult<hybridse::vm::TDigest>(aggr_table, [](int i, hybridse::vm::TDigest* sketch) {
+        ASSERT_DOUBLE_EQ(sketch->Quantile(0.5), i * 2 + 0.5);
+    });
+    counter += 2;
+    // percentile keeps the same t-digest as median, the percentage is applied by the engine
+    ASSERT_TRUE(GetUpdatedResult(counter, "col7", "percentile", "1s", aggregator, aggr_table, &last_buffer));
+    ASSERT_EQ(aggregator->GetAggrType(), AggrType::kMedian);
+    CheckSketchAggrResult<hybridse::vm::TDigest>(aggr_table, [](int i, hybridse::vm::TDigest* sketch) {
+        ASSERT_DOUBLE_EQ(sketch->Quantile(0.9), i * 2 + 0.9);
+    });
+    counter += 2;
+    ASSERT_TRUE(GetUpdatedResult(counter, "low_card", "topn_frequency", "1s", aggregator, aggr_table, &last_buffer));
+    CheckSketchAggrResult<hybridse::vm::SpaceSaving<int64_t>>(
+        aggr_table, [](int i, hybridse::vm::SpaceSaving<int64_t>* sketch) {
+            std::vector<std::pair<int64_t, int64_t>> expect = {{0, 1}, {1, 1}};
+            ASSERT_EQ(sketch->TopN(3), expect);
+        });
+    counter += 2;
+    ASSERT_TRUE(GetUpdatedResult(counter, "col_null", "distinct_count", "1s", aggregator, aggr_table, &last_buffer));
+    CheckSketchAggrResult<hybridse::vm::HyperLogLog>(
+        aggr_table, [](int i, hybridse::vm::HyperLogLog* sketch) { ASSERT_EQ(sketch->Estimate(), 0); });
+    ASSERT_EQ(last_buffer->non_null_cnt_, 0);
+}
+
 TEST_F(AggregatorTest, OutOfOrder) {
     ::openmldb::test::TempPath tmp_path;
     std::string folder = tmp_path.GetTempPath();
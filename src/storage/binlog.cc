@@ -16,14 +16,20 @@
 
 #include "storage/binlog.h"
 
+#include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <functional>
 #include <map>
+#include <mutex>  // NOLINT
 #include <set>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "base/glog_wrapper.h"
 #include "base/hash.h"
 #include "base/strings.h"
+#include "base/taskpool.hpp"
 #include "codec/schema_codec.h"
 #include "common/timer.h"
 #include "gflags/gflags.h"
@@ -32,10 +38,225 @@
 
 DECLARE_uint64(gc_on_table_recover_count);
 DECLARE_int32(binlog_name_length);
+DECLARE_uint32(binlog_recover_thread_num);
 
 namespace openmldb {
 namespace storage {
 
+namespace {
+
+// the number of records decoded and put at a time
+constexpr uint32_t kReplayBatchSize = 4096;
+
+// BinlogReplayer puts the binlog records into the table with several threads. The records of a batch are decoded in
+// parallel, then the puts are grouped so that the entries sharing the key of any index are in the same group, and a
+// group is put by one thread in the order of the binlog. A delete waits for all the puts before it and then runs
+// alone, as it does in the sequential replay
+class BinlogReplayer {
+ public:
+    BinlogReplayer(std::shared_ptr<Table> table, uint64_t offset, uint32_t thread_num)
+        : table_(table), cur_offset_(offset), shards_(std::max(1u, thread_num)) {
+        if (shards_.size() > 1) {
+            pool_ = std::make_unique<::openmldb::base::TaskPool>(shards_.size(), shards_.size());
+        }
+        records_.reserve(kReplayBatchSize);
+    }
+    ~BinlogReplayer() {
+        if (pool_) {
+            pool_->Stop();
+        }
+    }
+
+    void Add(const ::openmldb::base::Slice& record) {
+        records_.emplace_back(record.data(), record.size());
+        bytes_ += record.size();
+        if (records_.size() >= kReplayBatchSize) {
+            Flush();
+        }
+    }
+
+    void Flush() {
+        if (records_.empty()) {
+            return;
+        }
+        uint64_t start = ::baidu::common::timer::get_micros();
+        if (entries_.size() < records_.size()) {
+            entries_.resize(records_.size());
+        }
+        parsed_.assign(records_.size(), 0);
+        size_t chunk = (records_.size() + shards_.size() - 1) / shards_.size();
+        RunAll(shards_.size(), [this, chunk](uint32_t i) {
+            for (size_t pos = i * chunk; pos < std::min(records_.size(), (i + 1) * chunk); pos++) {
+                parsed_[pos] = entries_[pos].ParseFromString(records_[pos]);
+            }
+        });
+        uint64_t decoded = ::baidu::common::timer::get_micros();
+        decode_us_ += decoded - start;
+        uint32_t tid = table_->GetId();
+        uint32_t pid = table_->GetPid();
+        for (size_t pos = 0; pos < records_.size(); pos++) {
+            if (!parsed_[pos]) {
+                PDLOG(WARNING, "fail parse record for tid %u, pid %u with value %s", tid, pid,
+                      ::openmldb::base::DebugString(records_[pos]).c_str());
+                failed_cnt_++;
+                continue;
+            }
+            const auto& entry = entries_[pos];
+            if (cur_offset_ >= entry.log_index()) {
+                DEBUGLOG("offset %lu has been made snapshot", entry.log_index());
+                continue;
+            }
+            if (cur_offset_ + 1 != entry.log_index()) {
+                PDLOG(WARNING, "missing log entry cur_offset %lu , new entry offset %lu for tid %u, pid %u",
+                      cur_offset_, entry.log_index(), tid, pid);
+            }
+            if (entry.has_method_type() && entry.method_type() == ::openmldb::api::MethodType::kDelete) {
+                PutShards();
+                table_->Delete(entry);
+            } else {
+                puts_.push_back(&entry);
+            }
+            cur_offset_ = entry.log_index();
+            succ_cnt_++;
+            if (succ_cnt_ % 100000 == 0) {
+                PDLOG(INFO, "[Recover] load data from binlog succ_cnt %lu, failed_cnt %lu for tid %u, pid %u",
+                      succ_cnt_, failed_cnt_, tid, pid);
+            }
+            if (succ_cnt_ % FLAGS_gc_on_table_recover_count == 0) {
+                table_->SchedGc();
+            }
+        }
+        PutShards();
+        put_us_ += ::baidu::common::timer::get_micros() - decoded;
+        records_.clear();
+    }
+
+    void AddFailed() { failed_cnt_++; }
+    uint64_t GetOffset() const { return cur_offset_; }
+    uint64_t GetSuccCnt() const { return succ_cnt_; }
+    uint64_t GetFailedCnt() const { return failed_cnt_; }
+    uint64_t GetBytes() const { return bytes_; }
+    uint64_t GetDecodeMicros() const { return decode_us_; }
+    uint64_t GetPutMicros() const { return put_us_; }
+
+ private:
+    // runs fn(0) ... fn(n - 1) in the pool and waits for all of them
+    void RunAll(uint32_t n, const std::function<void(uint32_t)>& fn) {
+        if (!pool_) {
+            for (uint32_t i = 0; i < n; i++) {
+                fn(i);
+            }
+            return;
+        }
+        std::mutex mu;
+        std::condition_variable cv;
+        uint32_t done = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            pool_->AddTask([&mu, &cv, &done, &fn, i, n]() {
+                fn(i);
+                std::lock_guard<std::mutex> lock(mu);
+                if (++done == n) {
+                    cv.notify_one();
+                }
+            });
+        }
+        std::unique_lock<std::mutex> lock(mu);
+        cv.wait(lock, [&done, n] { return done == n; });
+    }
+
+    // entries are linked by the (index, key) pairs they share, every set of linked entries goes to one shard. Once
+    // a key is seen the later entries of it join the same set, so the order of the entries of a key is kept
+    void SplitPuts() {
+        if (shards_.size() == 1) {
+            shards_[0].swap(puts_);
+            return;
+        }
+        parent_.resize(puts_.size());
+        for (uint32_t i = 0; i < puts_.size(); i++) {
+            parent_[i] = i;
+        }
+        key_owner_.clear();
+        std::string index_key;
+        auto link = [this, &index_key](uint32_t pos, uint32_t idx, const std::string& key) {
+            index_key.assign(reinterpret_cast<const char*>(&idx), sizeof(idx));
+            index_key.append(key);
+            auto result = key_owner_.try_emplace(index_key, pos);
+            if (!result.second) {
+                uint32_t root = FindRoot(result.first->second);
+                uint32_t cur = FindRoot(pos);
+                // the earlier root stays, so a set is named by its first entry
+                parent_[std::max(root, cur)] = std::min(root, cur);
+            }
+        };
+        for (uint32_t pos = 0; pos < puts_.size(); pos++) {
+            const auto* entry = puts_[pos];
+            if (entry->dimensions_size() == 0) {
+                link(pos, 0, entry->pk());
+            }
+            for (const auto& dimension : entry->dimensions()) {
+                link(pos, dimension.idx(), dimension.key());
+            }
+        }
+        // the sets are given to the least loaded shard in the order of their first entries
+        set_size_.assign(puts_.size(), 0);
+        for (uint32_t pos = 0; pos < puts_.size(); pos++) {
+            parent_[pos] = FindRoot(pos);
+            set_size_[parent_[pos]]++;
+        }
+        std::vector<size_t> load(shards_.size(), 0);
+        set_shard_.resize(puts_.size());
+        for (uint32_t pos = 0; pos < puts_.size(); pos++) {
+            uint32_t root = parent_[pos];
+            if (root == pos) {
+                set_shard_[pos] = std::min_element(load.begin(), load.end()) - load.begin();
+                load[set_shard_[pos]] += set_size_[pos];
+            }
+            shards_[set_shard_[root]].push_back(puts_[pos]);
+        }
+        puts_.clear();
+    }
+
+    uint32_t FindRoot(uint32_t pos) {
+        while (parent_[pos] != pos) {
+            parent_[pos] = parent_[parent_[pos]];
+            pos = parent_[pos];
+        }
+        return pos;
+    }
+
+    void PutShards() {
+        SplitPuts();
+        RunAll(shards_.size(), [this](uint32_t i) {
+            for (const auto* entry : shards_[i]) {
+                table_->Put(*entry);
+            }
+            shards_[i].clear();
+        });
+    }
+
+    std::shared_ptr<Table> table_;
+    uint64_t cur_offset_;
+    std::unique_ptr<::openmldb::base::TaskPool> pool_;
+    std::vector<std::string> records_;
+    std::vector<::openmldb::api::LogEntry> entries_;
+    // not vector<bool>, the elements are set by different threads
+    std::vector<char> parsed_;
+    // the puts since the last delete, and the union-find of them to split them into shards
+    std::vector<const ::openmldb::api::LogEntry*> puts_;
+    std::vector<uint32_t> parent_;
+    std::vector<uint32_t> set_size_;
+    std::vector<uint32_t> set_shard_;
+    absl::flat_hash_map<std::string, uint32_t> key_owner_;
+    std::vector<std::vector<const ::openmldb::api::LogEntry*>> shards_;
+    uint64_t succ_cnt_ = 0;
+    uint64_t failed_cnt_ = 0;
+    uint64_t bytes_ = 0;
+    uint64_t decode_us_ = 0;
+    uint64_t put_us_ = 0;
+};
+
+}  // namespace
+
 Binlog::Binlog(LogParts* log_part, const std::string& binlog_path) : log_part_(log_part), log_path_(binlog_path) {}
 
 bool Binlog::RecoverFromBinlog(std::shared_ptr<Table> table, uint64_t offset, uint64_t& latest_offset) {
@@ -44,12 +265,9 @@ bool Binlog::RecoverFromBinlog(std::shared_ptr<Table> table, uint64_t offset, ui
     PDLOG(INFO, "start recover table tid %u, pid %u from binlog with start offset %lu", tid, pid, offset);
     ::openmldb::log::LogReader log_reader(log_part_, log_path_, false);
     log_reader.SetOffset(offset);
-    ::openmldb::api::LogEntry entry;
-    uint64_t cur_offset = offset;
+    BinlogReplayer replayer(table, offset, FLAGS_binlog_recover_thread_num);
     std::string buffer;
-    uint64_t succ_cnt = 0;
-    uint64_t failed_cnt = 0;
-    uint64_t consumed = ::baidu::common::timer::now_time();
+    uint64_t consumed = ::baidu::common::timer::get_micros();
     int last_log_index = log_reader.GetLogIndex();
     bool reach_end_log = true;
     while (true) {
@@ -64,12 +282,9 @@ bool Binlog::RecoverFromBinlog(std::shared_ptr<Table> table, uint64_t offset, ui
                 PDLOG(WARNING,
                       "read new binlog file. tid[%u] pid[%u] cur_log_index[%d] "
                       "end_log_index[%d] cur_offset[%lu]",
-                      tid, pid, cur_log_index, end_log_index, cur_offset);
+                      tid, pid, cur_log_index, end_log_index, replayer.GetOffset());
                 continue;
             }
-            consumed = ::baidu::common::timer::now_time() - consumed;
-            PDLOG(INFO, "table tid %u pid %u completed, succ_cnt %lu, failed_cnt %lu, consumed %us",
-                  tid, pid, succ_cnt, failed_cnt, consumed);
             reach_end_log = false;
             break;
         }
@@ -82,42 +297,20 @@ bool Binlog::RecoverFromBinlog(std::shared_ptr<Table> table, uint64_t offset, ui
         }
 
         if (!status.ok()) {
-            failed_cnt++;
-            continue;
-        }
-        bool ok = entry.ParseFromString(record.ToString());
-        if (!ok) {
-            PDLOG(WARNING, "fail parse record for tid %u, pid %u with value %s", tid, pid,
-                  ::openmldb::base::DebugString(record.ToString()).c_str());
-            failed_cnt++;
-            continue;
-        }
-
-        if (cur_offset >= entry.log_index()) {
-            DEBUGLOG("offset %lu has been made snapshot", entry.log_index());
+            replayer.AddFailed();
             continue;
         }
-
-        if (cur_offset + 1 != entry.log_index()) {
-            PDLOG(WARNING, "missing log entry cur_offset %lu , new entry offset %lu for tid %u, pid %u",
-                  cur_offset, entry.log_index(), tid, pid);
-        }
-        if (entry.has_method_type() && entry.method_type() == ::openmldb::api::MethodType::kDelete) {
-            table->Delete(entry);
-        } else {
-            table->Put(entry);
-        }
-        cur_offset = entry.log_index();
-        succ_cnt++;
-        if (succ_cnt % 100000 == 0) {
-            PDLOG(INFO, "[Recover] load data from binlog succ_cnt %lu, failed_cnt %lu for tid %u, pid %u",
-                  succ_cnt, failed_cnt, tid, pid);
-        }
-        if (succ_cnt % FLAGS_gc_on_table_recover_count == 0) {
-            table->SchedGc();
-        }
+        replayer.Add(record);
     }
-    latest_offset = cur_offset;
+    replayer.Flush();
+    consumed = ::baidu::common::timer::get_micros() - consumed;
+    PDLOG(INFO,
+          "table tid %u pid %u completed, succ_cnt %lu, failed_cnt %lu, bytes %lu, consumed %lums "
+          "(decode %lums, put %lums), %lu records/s",
+          tid, pid, replayer.GetSuccCnt(), replayer.GetFailedCnt(), replayer.GetBytes(), consumed / 1000,
+          replayer.GetDecodeMicros() / 1000, replayer.GetPutMicros() / 1000,
+          replayer.GetSuccCnt() * 1000000 / std::max<uint64_t>(consumed, 1));
+    latest_offset = replayer.GetOffset();
     if (!reach_end_log) {
         int log_index = log_reader.GetLogIndex();
         if (log_index < 0) {
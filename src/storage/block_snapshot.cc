@@ -0,0 +1,438 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/block_snapshot.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <snappy.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "base/glog_wrapper.h"
+#include "log/coding.h"
+#include "log/crc32c.h"
+
+namespace openmldb {
+namespace storage {
+
+using ::openmldb::log::Status;
+
+namespace {
+
+// fixed width columns of a record: log_index, ts, term, flags, pk_len, value_len, dim_cnt
+constexpr uint32_t kRecordFixedSize = 8 * 3 + 1 + 4 * 3;
+// dim_idx and dim_key_len
+constexpr uint32_t kDimFixedSize = 4 * 2;
+
+void PutFixed32(std::string* dst, uint32_t value) {
+    char buf[sizeof(value)];
+    ::openmldb::log::EncodeFixed32(buf, value);
+    dst->append(buf, sizeof(buf));
+}
+
+void PutFixed64(std::string* dst, uint64_t value) {
+    char buf[sizeof(value)];
+    ::openmldb::log::EncodeFixed64(buf, value);
+    dst->append(buf, sizeof(buf));
+}
+
+uint32_t ChunkCrc(const char* header, const char* payload, uint32_t size) {
+    // record_cnt and raw_size are covered as well as the payload
+    uint32_t crc = ::openmldb::log::Value(header + 4, 8);
+    crc = ::openmldb::log::Extend(crc, payload, size);
+    return ::openmldb::log::Mask(crc);
+}
+
+::openmldb::log::CompressType ParseCompressType(const std::string& compress_type) {
+    if (compress_type == "snappy") {
+        return ::openmldb::log::kSnappy;
+    } else if (compress_type == "zlib") {
+        return ::openmldb::log::kZlib;
+    }
+    return ::openmldb::log::kNoCompress;
+}
+
+}  // namespace
+
+bool IsBlockSnapshot(const std::string& path) { return path.find(BLOCK_SNAPSHOT_SUFFIX) != std::string::npos; }
+
+Status BlockChunk::Decode(const char* data, uint32_t size, uint32_t record_cnt) {
+    uint64_t n = record_cnt;
+    if (n * kRecordFixedSize > size) {
+        return Status::Corruption("chunk is too small for the record count");
+    }
+    record_cnt_ = record_cnt;
+    log_index_ = data;
+    ts_ = log_index_ + 8 * n;
+    term_ = ts_ + 8 * n;
+    flags_ = term_ + 8 * n;
+    const char* pk_len = flags_ + n;
+    const char* value_len = pk_len + 4 * n;
+    const char* dim_cnt = value_len + 4 * n;
+    uint64_t pos = n * kRecordFixedSize;
+
+    dim_start_.resize(n + 1);
+    pk_offset_.resize(n + 1);
+    value_offset_.resize(n + 1);
+    uint64_t dim_total = 0;
+    uint64_t pk_total = 0;
+    uint64_t value_total = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        dim_start_[i] = dim_total;
+        pk_offset_[i] = pk_total;
+        value_offset_[i] = value_total;
+        dim_total += ::openmldb::log::DecodeFixed32(dim_cnt + 4 * i);
+        pk_total += ::openmldb::log::DecodeFixed32(pk_len + 4 * i);
+        value_total += ::openmldb::log::DecodeFixed32(value_len + 4 * i);
+    }
+    dim_start_[n] = dim_total;
+    pk_offset_[n] = pk_total;
+    value_offset_[n] = value_total;
+    if (pos + dim_total * kDimFixedSize > size) {
+        return Status::Corruption("chunk is too small for the dimensions");
+    }
+    dim_idx_ = data + pos;
+    const char* dim_key_len = dim_idx_ + 4 * dim_total;
+    pos += dim_total * kDimFixedSize;
+    dim_key_offset_.resize(dim_total + 1);
+    uint64_t key_total = 0;
+    for (uint64_t i = 0; i < dim_total; i++) {
+        dim_key_offset_[i] = key_total;
+        key_total += ::openmldb::log::DecodeFixed32(dim_key_len + 4 * i);
+    }
+    dim_key_offset_[dim_total] = key_total;
+    if (pos + pk_total + key_total + value_total != size) {
+        return Status::Corruption("chunk size mismatch");
+    }
+    pk_data_ = data + pos;
+    dim_key_data_ = pk_data_ + pk_total;
+    value_data_ = dim_key_data_ + key_total;
+    return Status::OK();
+}
+
+uint64_t BlockChunk::GetLogIndex(uint32_t i) const { return ::openmldb::log::DecodeFixed64(log_index_ + 8 * i); }
+
+uint64_t BlockChunk::GetTs(uint32_t i) const { return ::openmldb::log::DecodeFixed64(ts_ + 8 * i); }
+
+uint64_t BlockChunk::GetTerm(uint32_t i) const { return ::openmldb::log::DecodeFixed64(term_ + 8 * i); }
+
+::openmldb::base::Slice BlockChunk::GetPk(uint32_t i) const {
+    return ::openmldb::base::Slice(pk_data_ + pk_offset_[i], pk_offset_[i + 1] - pk_offset_[i]);
+}
+
+::openmldb::base::Slice BlockChunk::GetValue(uint32_t i) const {
+    return ::openmldb::base::Slice(value_data_ + value_offset_[i], value_offset_[i + 1] - value_offset_[i]);
+}
+
+void BlockChunk::GetDimensions(uint32_t i,
+        ::google::protobuf::RepeatedPtrField<::openmldb::api::Dimension>* dimensions) const {
+    int cnt = static_cast<int>(GetDimensionCnt(i));
+    while (dimensions->size() > cnt) {
+        dimensions->RemoveLast();
+    }
+    for (int pos = 0; pos < cnt; pos++) {
+        auto dim = pos < dimensions->size() ? dimensions->Mutable(pos) : dimensions->Add();
+        uint32_t dim_pos = dim_start_[i] + pos;
+        dim->set_idx(::openmldb::log::DecodeFixed32(dim_idx_ + 4 * dim_pos));
+        uint32_t key_offset = dim_key_offset_[dim_pos];
+        dim->set_key(dim_key_data_ + key_offset, dim_key_offset_[dim_pos + 1] - key_offset);
+    }
+}
+
+void BlockChunk::GetLogEntry(uint32_t i, ::openmldb::api::LogEntry* entry) const {
+    entry->Clear();
+    uint8_t flags = GetFlags(i);
+    entry->set_log_index(GetLogIndex(i));
+    if (flags & kBlockRecordHasTerm) {
+        entry->set_term(GetTerm(i));
+    }
+    if (flags & kBlockRecordHasTs) {
+        entry->set_ts(GetTs(i));
+    }
+    if (flags & kBlockRecordHasPk) {
+        auto pk = GetPk(i);
+        entry->set_pk(pk.data(), pk.size());
+    }
+    if (flags & kBlockRecordDelete) {
+        entry->set_method_type(::openmldb::api::MethodType::kDelete);
+    }
+    auto value = GetValue(i);
+    entry->set_value(value.data(), value.size());
+    GetDimensions(i, entry->mutable_dimensions());
+}
+
+BlockSnapshotWriter::BlockSnapshotWriter(const std::string& compress_type, FILE* fd)
+    : fd_(fd), compress_type_(ParseCompressType(compress_type)) {}
+
+BlockSnapshotWriter::~BlockSnapshotWriter() {
+    if (fd_ != nullptr) {
+        fclose(fd_);
+    }
+}
+
+Status BlockSnapshotWriter::Write(const ::openmldb::api::LogEntry& entry) {
+    uint8_t flags = 0;
+    if (entry.has_ts()) {
+        flags |= kBlockRecordHasTs;
+    }
+    if (entry.has_term()) {
+        flags |= kBlockRecordHasTerm;
+    }
+    if (entry.has_pk()) {
+        flags |= kBlockRecordHasPk;
+    }
+    if (entry.has_method_type() && entry.method_type() == ::openmldb::api::MethodType::kDelete) {
+        flags |= kBlockRecordDelete;
+    }
+    PutFixed64(&log_index_col_, entry.log_index());
+    PutFixed64(&ts_col_, entry.ts());
+    PutFixed64(&term_col_, entry.term());
+    flags_col_.push_back(static_cast<char>(flags));
+    PutFixed32(&pk_len_col_, entry.pk().size());
+    pk_col_.append(entry.pk());
+    PutFixed32(&value_len_col_, entry.value().size());
+    value_col_.append(entry.value());
+    PutFixed32(&dim_cnt_col_, entry.dimensions_size());
+    uint64_t size = kRecordFixedSize + entry.pk().size() + entry.value().size();
+    for (const auto& dim : entry.dimensions()) {
+        PutFixed32(&dim_idx_col_, dim.idx());
+        PutFixed32(&dim_key_len_col_, dim.key().size());
+        dim_key_col_.append(dim.key());
+        size += kDimFixedSize + dim.key().size();
+    }
+    record_cnt_++;
+    raw_size_ += size;
+    if (raw_size_ >= BLOCK_SNAPSHOT_CHUNK_SIZE) {
+        return Flush();
+    }
+    return Status::OK();
+}
+
+Status BlockSnapshotWriter::Append(const char* data, size_t size) {
+    if (size > 0 && fwrite(data, 1, size, fd_) != size) {
+        return Status::IOError(absl::StrCat("fail to write block snapshot: ", strerror(errno)));
+    }
+    size_ += size;
+    return Status::OK();
+}
+
+Status BlockSnapshotWriter::Flush() {
+    if (size_ == 0) {
+        char file_header[BLOCK_SNAPSHOT_FILE_HEADER_SIZE];
+        ::openmldb::log::EncodeFixed32(file_header, BLOCK_SNAPSHOT_FILE_MAGIC);
+        ::openmldb::log::EncodeFixed32(file_header + 4, BLOCK_SNAPSHOT_VERSION);
+        Status status = Append(file_header, sizeof(file_header));
+        if (!status.ok()) {
+            return status;
+        }
+    }
+    if (record_cnt_ == 0) {
+        return Status::OK();
+    }
+    raw_.clear();
+    raw_.reserve(raw_size_);
+    for (const std::string* col : {&log_index_col_, &ts_col_, &term_col_, &flags_col_, &pk_len_col_,
+            &value_len_col_, &dim_cnt_col_, &dim_idx_col_, &dim_key_len_col_, &pk_col_, &dim_key_col_, &value_col_}) {
+        raw_.append(*col);
+    }
+    const char* payload = raw_.data();
+    uint32_t stored_size = raw_.size();
+    uint8_t compress_type = ::openmldb::log::kNoCompress;
+    if (compress_type_ == ::openmldb::log::kSnappy) {
+        compressed_.resize(snappy::MaxCompressedLength(raw_.size()));
+        size_t compressed_len = 0;
+        snappy::RawCompress(raw_.data(), raw_.size(), &compressed_[0], &compressed_len);
+        if (compressed_len < raw_.size()) {
+            payload = compressed_.data();
+            stored_size = compressed_len;
+            compress_type = ::openmldb::log::kSnappy;
+        }
+    } else if (compress_type_ == ::openmldb::log::kZlib) {
+        uLongf compressed_len = compressBound(raw_.size());
+        compressed_.resize(compressed_len);
+        int ret = compress(reinterpret_cast<Bytef*>(&compressed_[0]), &compressed_len,
+                reinterpret_cast<const Bytef*>(raw_.data()), raw_.size());
+        if (ret != Z_OK) {
+            return Status::InvalidRecord(absl::StrCat("zlib compress failed, error code: ", ret));
+        }
+        if (compressed_len < raw_.size()) {
+            payload = compressed_.data();
+            stored_size = compressed_len;
+            compress_type = ::openmldb::log::kZlib;
+        }
+    }
+    char header[BLOCK_SNAPSHOT_CHUNK_HEADER_SIZE] = {0};
+    ::openmldb::log::EncodeFixed32(header, BLOCK_SNAPSHOT_CHUNK_MAGIC);
+    ::openmldb::log::EncodeFixed32(header + 4, record_cnt_);
+    ::openmldb::log::EncodeFixed32(header + 8, raw_.size());
+    ::openmldb::log::EncodeFixed32(header + 12, stored_size);
+    header[16] = static_cast<char>(compress_type);
+    ::openmldb::log::EncodeFixed32(header + 20, ChunkCrc(header, payload, stored_size));
+    Status status = Append(header, sizeof(header));
+    if (status.ok()) {
+        status = Append(payload, stored_size);
+    }
+    for (std::string* col : {&log_index_col_, &ts_col_, &term_col_, &flags_col_, &pk_len_col_, &value_len_col_,
+            &dim_cnt_col_, &dim_idx_col_, &dim_key_len_col_, &pk_col_, &dim_key_col_, &value_col_}) {
+        col->clear();
+    }
+    record_cnt_ = 0;
+    raw_size_ = 0;
+    return status;
+}
+
+Status BlockSnapshotWriter::EndLog() {
+    Status status = Flush();
+    if (!status.ok()) {
+        return status;
+    }
+    if (fflush(fd_) != 0 || fsync(fileno(fd_)) != 0) {
+        return Status::IOError(absl::StrCat("fail to sync block snapshot: ", strerror(errno)));
+    }
+    return Status::OK();
+}
+
+std::shared_ptr<BlockSnapshotWriter> CreateBlockSnapshotWriter(const std::string& compress_type,
+        const std::string& path) {
+    FILE* fd = fopen(path.c_str(), "wb");
+    if (fd == nullptr) {
+        PDLOG(WARNING, "fail to open file %s for error %s", path.c_str(), strerror(errno));
+        return {};
+    }
+    return std::make_shared<BlockSnapshotWriter>(compress_type, fd);
+}
+
+BlockSnapshotReader::~BlockSnapshotReader() {
+    if (data_ != nullptr) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+Status BlockSnapshotReader::Open() {
+    int fd = open(path_.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return Status::IOError(absl::StrCat("fail to open ", path_, ": ", strerror(errno)));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return Status::IOError(absl::StrCat("fail to stat ", path_, ": ", strerror(errno)));
+    }
+    if (static_cast<uint64_t>(st.st_size) < BLOCK_SNAPSHOT_FILE_HEADER_SIZE) {
+        close(fd);
+        return Status::Corruption(absl::StrCat("block snapshot is too small: ", path_));
+    }
+    void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        return Status::IOError(absl::StrCat("fail to mmap ", path_, ": ", strerror(errno)));
+    }
+    data_ = reinterpret_cast<const char*>(addr);
+    size_ = st.st_size;
+    madvise(addr, size_, MADV_WILLNEED);
+    if (::openmldb::log::DecodeFixed32(data_) != BLOCK_SNAPSHOT_FILE_MAGIC) {
+        return Status::Corruption(absl::StrCat("invalid block snapshot magic: ", path_));
+    }
+    uint32_t version = ::openmldb::log::DecodeFixed32(data_ + 4);
+    if (version != BLOCK_SNAPSHOT_VERSION) {
+        return Status::NotSupported(absl::StrCat("unsupported block snapshot version ", version));
+    }
+    // only a tmp file may be cut in the middle of a chunk by a crash of the writer, a sealed file never is
+    bool sealed = !absl::EndsWith(path_, ".tmp");
+    uint64_t offset = BLOCK_SNAPSHOT_FILE_HEADER_SIZE;
+    while (offset < size_) {
+        const char* header = data_ + offset;
+        if (offset + BLOCK_SNAPSHOT_CHUNK_HEADER_SIZE > size_ ||
+            ::openmldb::log::DecodeFixed32(header) != BLOCK_SNAPSHOT_CHUNK_MAGIC) {
+            if (sealed) {
+                return Status::Corruption(absl::StrCat("invalid chunk header at offset ", offset, " of ", path_));
+            }
+            PDLOG(WARNING, "invalid chunk header at offset %lu, ignore the tail of %s", offset, path_.c_str());
+            break;
+        }
+        ChunkMeta meta;
+        meta.offset = offset + BLOCK_SNAPSHOT_CHUNK_HEADER_SIZE;
+        meta.record_cnt = ::openmldb::log::DecodeFixed32(header + 4);
+        meta.raw_size = ::openmldb::log::DecodeFixed32(header + 8);
+        meta.stored_size = ::openmldb::log::DecodeFixed32(header + 12);
+        meta.compress_type = static_cast<uint8_t>(header[16]);
+        meta.crc = ::openmldb::log::DecodeFixed32(header + 20);
+        if (meta.offset + meta.stored_size > size_) {
+            if (sealed) {
+                return Status::Corruption(absl::StrCat("truncated chunk at offset ", offset, " of ", path_));
+            }
+            PDLOG(WARNING, "truncated chunk at offset %lu, ignore the tail of %s", offset, path_.c_str());
+            break;
+        }
+        chunks_.push_back(meta);
+        record_cnt_ += meta.record_cnt;
+        offset = meta.offset + meta.stored_size;
+    }
+    return Status::OK();
+}
+
+Status BlockSnapshotReader::ReadChunk(uint32_t idx, std::string* buf, BlockChunk* chunk) const {
+    if (idx >= chunks_.size()) {
+        return Status::InvalidArgument("chunk index out of range");
+    }
+    const ChunkMeta& meta = chunks_[idx];
+    const char* payload = data_ + meta.offset;
+    if (ChunkCrc(payload - BLOCK_SNAPSHOT_CHUNK_HEADER_SIZE, payload, meta.stored_size) != meta.crc) {
+        return Status::Corruption(absl::StrCat("checksum mismatch of chunk ", idx));
+    }
+    const char* raw = payload;
+    switch (meta.compress_type) {
+        case ::openmldb::log::kNoCompress:
+            if (meta.stored_size != meta.raw_size) {
+                return Status::Corruption(absl::StrCat("size mismatch of chunk ", idx));
+            }
+            break;
+        case ::openmldb::log::kSnappy: {
+            size_t len = 0;
+            if (!snappy::GetUncompressedLength(payload, meta.stored_size, &len) || len != meta.raw_size) {
+                return Status::Corruption(absl::StrCat("invalid snappy chunk ", idx));
+            }
+            buf->resize(meta.raw_size);
+            if (!snappy::RawUncompress(payload, meta.stored_size, &(*buf)[0])) {
+                return Status::Corruption(absl::StrCat("fail to uncompress chunk ", idx));
+            }
+            raw = buf->data();
+            break;
+        }
+        case ::openmldb::log::kZlib: {
+            buf->resize(meta.raw_size);
+            uLongf len = meta.raw_size;
+            if (uncompress(reinterpret_cast<Bytef*>(&(*buf)[0]), &len, reinterpret_cast<const Bytef*>(payload),
+                        meta.stored_size) != Z_OK || len != meta.raw_size) {
+                return Status::Corruption(absl::StrCat("fail to uncompress chunk ", idx));
+            }
+            raw = buf->data();
+            break;
+        }
+        default:
+            return Status::NotSupported(absl::StrCat("unsupported compress type ", meta.compress_type));
+    }
+    return chunk->Decode(raw, meta.raw_size, meta.record_cnt);
+}
+
+}  // namespace storage
+}  // namespace openmldb
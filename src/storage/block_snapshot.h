@@ -0,0 +1,178 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_STORAGE_BLOCK_SNAPSHOT_H_
+#define SRC_STORAGE_BLOCK_SNAPSHOT_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/slice.h"
+#include "log/log_format.h"
+#include "log/status.h"
+#include "proto/tablet.pb.h"
+
+namespace openmldb {
+namespace storage {
+
+// Block snapshot is a binary snapshot format which is designed for fast recovery.
+//
+// file   := file_magic(4) version(4) chunk*
+// chunk  := chunk_magic(4) record_cnt(4) raw_size(4) stored_size(4) compress_type(1) pad(3) crc(4) payload
+//
+// The payload is stored_size bytes, it is compressed with compress_type when compression is enabled and
+// crc is the masked crc32c of record_cnt, raw_size and the stored payload. The raw payload is columnar:
+//
+//   log_index(8)*n ts(8)*n term(8)*n flags(1)*n pk_len(4)*n value_len(4)*n dim_cnt(4)*n
+//   dim_idx(4)*m dim_key_len(4)*m pk_bytes dim_key_bytes value_bytes
+//
+// n is the record count of the chunk and m is the total count of dimensions. Only the fields needed
+// to replay a record into table are kept, the chunks are independent so they can be decoded in parallel.
+
+constexpr const char* BLOCK_SNAPSHOT_SUFFIX = ".bsdb";
+constexpr uint32_t BLOCK_SNAPSHOT_FILE_MAGIC = 0x53424d4f;   // "OMBS"
+constexpr uint32_t BLOCK_SNAPSHOT_CHUNK_MAGIC = 0x43424d4f;  // "OMBC"
+constexpr uint32_t BLOCK_SNAPSHOT_VERSION = 1;
+constexpr uint32_t BLOCK_SNAPSHOT_FILE_HEADER_SIZE = 8;
+constexpr uint32_t BLOCK_SNAPSHOT_CHUNK_HEADER_SIZE = 24;
+// flush a chunk once the raw payload reaches this size
+constexpr uint32_t BLOCK_SNAPSHOT_CHUNK_SIZE = 2 * 1024 * 1024;
+
+enum BlockRecordFlag : uint8_t {
+    kBlockRecordHasTs = 1,
+    kBlockRecordHasTerm = 2,
+    kBlockRecordHasPk = 4,
+    kBlockRecordDelete = 8,
+};
+
+bool IsBlockSnapshot(const std::string& path);
+
+// BlockChunk is the decoded view of a chunk, it does not own the memory
+class BlockChunk {
+ public:
+    ::openmldb::log::Status Decode(const char* data, uint32_t size, uint32_t record_cnt);
+
+    uint32_t GetRecordCnt() const { return record_cnt_; }
+    uint64_t GetLogIndex(uint32_t i) const;
+    uint64_t GetTs(uint32_t i) const;
+    uint64_t GetTerm(uint32_t i) const;
+    uint8_t GetFlags(uint32_t i) const { return static_cast<uint8_t>(flags_[i]); }
+    bool IsDelete(uint32_t i) const { return GetFlags(i) & kBlockRecordDelete; }
+    ::openmldb::base::Slice GetPk(uint32_t i) const;
+    ::openmldb::base::Slice GetValue(uint32_t i) const;
+    uint32_t GetDimensionCnt(uint32_t i) const { return dim_start_[i + 1] - dim_start_[i]; }
+
+    // the existing elements of dimensions are reused
+    void GetDimensions(uint32_t i, ::google::protobuf::RepeatedPtrField<::openmldb::api::Dimension>* dimensions) const;
+    void GetLogEntry(uint32_t i, ::openmldb::api::LogEntry* entry) const;
+
+ private:
+    uint32_t record_cnt_ = 0;
+    const char* log_index_ = nullptr;
+    const char* ts_ = nullptr;
+    const char* term_ = nullptr;
+    const char* flags_ = nullptr;
+    const char* dim_idx_ = nullptr;
+    std::vector<uint32_t> pk_offset_;
+    std::vector<uint32_t> value_offset_;
+    std::vector<uint32_t> dim_start_;
+    std::vector<uint32_t> dim_key_offset_;
+    const char* pk_data_ = nullptr;
+    const char* dim_key_data_ = nullptr;
+    const char* value_data_ = nullptr;
+};
+
+class BlockSnapshotWriter {
+ public:
+    BlockSnapshotWriter(const std::string& compress_type, FILE* fd);
+    ~BlockSnapshotWriter();
+    BlockSnapshotWriter(const BlockSnapshotWriter&) = delete;
+    BlockSnapshotWriter& operator=(const BlockSnapshotWriter&) = delete;
+
+    ::openmldb::log::Status Write(const ::openmldb::api::LogEntry& entry);
+    // flush the pending chunk and sync the file
+    ::openmldb::log::Status EndLog();
+    uint64_t GetSize() const { return size_; }
+
+ private:
+    ::openmldb::log::Status Flush();
+    ::openmldb::log::Status Append(const char* data, size_t size);
+
+ private:
+    FILE* fd_;
+    ::openmldb::log::CompressType compress_type_;
+    uint64_t size_ = 0;
+    uint32_t record_cnt_ = 0;
+    uint32_t raw_size_ = 0;
+    std::string log_index_col_;
+    std::string ts_col_;
+    std::string term_col_;
+    std::string flags_col_;
+    std::string pk_len_col_;
+    std::string value_len_col_;
+    std::string dim_cnt_col_;
+    std::string dim_idx_col_;
+    std::string dim_key_len_col_;
+    std::string pk_col_;
+    std::string dim_key_col_;
+    std::string value_col_;
+    std::string raw_;
+    std::string compressed_;
+};
+
+std::shared_ptr<BlockSnapshotWriter> CreateBlockSnapshotWriter(const std::string& compress_type,
+        const std::string& path);
+
+// BlockSnapshotReader maps the whole file and indexes the chunks, ReadChunk is thread safe
+class BlockSnapshotReader {
+ public:
+    explicit BlockSnapshotReader(const std::string& path) : path_(path) {}
+    ~BlockSnapshotReader();
+    BlockSnapshotReader(const BlockSnapshotReader&) = delete;
+    BlockSnapshotReader& operator=(const BlockSnapshotReader&) = delete;
+
+    ::openmldb::log::Status Open();
+    uint32_t GetChunkCnt() const { return chunks_.size(); }
+    uint64_t GetRecordCnt() const { return record_cnt_; }
+    uint32_t GetChunkRecordCnt(uint32_t idx) const { return chunks_[idx].record_cnt; }
+    // buf keeps the uncompressed payload, it must outlive the chunk
+    ::openmldb::log::Status ReadChunk(uint32_t idx, std::string* buf, BlockChunk* chunk) const;
+
+ private:
+    struct ChunkMeta {
+        uint64_t offset;
+        uint32_t record_cnt;
+        uint32_t raw_size;
+        uint32_t stored_size;
+        uint8_t compress_type;
+        uint32_t crc;
+    };
+
+    std::string path_;
+    const char* data_ = nullptr;
+    uint64_t size_ = 0;
+    uint64_t record_cnt_ = 0;
+    std::vector<ChunkMeta> chunks_;
+};
+
+}  // namespace storage
+}  // namespace openmldb
+
+#endif  // SRC_STORAGE_BLOCK_SNAPSHOT_H_
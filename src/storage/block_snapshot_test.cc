@@ -0,0 +1,194 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/block_snapshot.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace storage {
+
+class BlockSnapshotTest : public ::testing::TestWithParam<std::string> {
+ public:
+    BlockSnapshotTest() {}
+    ~BlockSnapshotTest() {}
+
+    void SetUp() override {
+        char path[] = "/tmp/block_snapshot_testXXXXXX";
+        int fd = mkstemp(path);
+        ASSERT_GE(fd, 0);
+        close(fd);
+        path_ = path;
+    }
+
+    void TearDown() override { unlink(path_.c_str()); }
+
+    static ::openmldb::api::LogEntry GenEntry(uint64_t idx) {
+        ::openmldb::api::LogEntry entry;
+        entry.set_log_index(idx);
+        entry.set_ts(1000 + idx);
+        entry.set_term(idx % 3);
+        entry.set_value(std::string(idx % 100 + 1, 'a' + idx % 26));
+        auto dim = entry.add_dimensions();
+        dim->set_key("key" + std::to_string(idx % 17));
+        dim->set_idx(0);
+        if (idx % 2 == 0) {
+            dim = entry.add_dimensions();
+            dim->set_key("card" + std::to_string(idx));
+            dim->set_idx(1);
+        }
+        if (idx % 5 == 0) {
+            entry.set_pk("pk" + std::to_string(idx));
+        }
+        return entry;
+    }
+
+    void WriteFile(uint64_t cnt) {
+        auto writer = CreateBlockSnapshotWriter(GetParam(), path_);
+        ASSERT_TRUE(writer);
+        for (uint64_t i = 1; i <= cnt; i++) {
+            ASSERT_TRUE(writer->Write(GenEntry(i)).ok());
+        }
+        ASSERT_TRUE(writer->EndLog().ok());
+    }
+
+ protected:
+    std::string path_;
+};
+
+TEST_P(BlockSnapshotTest, ReadWrite) {
+    uint64_t cnt = 100000;
+    WriteFile(cnt);
+    BlockSnapshotReader reader(path_);
+    ASSERT_TRUE(reader.Open().ok());
+    ASSERT_EQ(cnt, reader.GetRecordCnt());
+    ASSERT_GT(reader.GetChunkCnt(), 1u);
+    std::string buf;
+    BlockChunk chunk;
+    ::openmldb::api::LogEntry entry;
+    uint64_t idx = 0;
+    for (uint32_t i = 0; i < reader.GetChunkCnt(); i++) {
+        ASSERT_TRUE(reader.ReadChunk(i, &buf, &chunk).ok());
+        for (uint32_t j = 0; j < chunk.GetRecordCnt(); j++) {
+            idx++;
+            chunk.GetLogEntry(j, &entry);
+            ASSERT_EQ(GenEntry(idx).SerializeAsString(), entry.SerializeAsString());
+            ASSERT_EQ(1000 + idx, chunk.GetTs(j));
+        }
+    }
+    ASSERT_EQ(cnt, idx);
+}
+
+TEST_P(BlockSnapshotTest, Empty) {
+    WriteFile(0);
+    BlockSnapshotReader reader(path_);
+    ASSERT_TRUE(reader.Open().ok());
+    ASSERT_EQ(0u, reader.GetChunkCnt());
+    ASSERT_EQ(0u, reader.GetRecordCnt());
+}
+
+TEST_P(BlockSnapshotTest, Corruption) {
+    WriteFile(50000);
+    uint32_t chunk_cnt = 0;
+    {
+        BlockSnapshotReader reader(path_);
+        ASSERT_TRUE(reader.Open().ok());
+        chunk_cnt = reader.GetChunkCnt();
+    }
+    ASSERT_GT(chunk_cnt, 0u);
+    // flip one byte in the payload of the first chunk
+    FILE* fd = fopen(path_.c_str(), "r+b");
+    ASSERT_TRUE(fd != nullptr);
+    long pos = BLOCK_SNAPSHOT_FILE_HEADER_SIZE + BLOCK_SNAPSHOT_CHUNK_HEADER_SIZE + 10;  // NOLINT
+    fseek(fd, pos, SEEK_SET);
+    int c = fgetc(fd);
+    fseek(fd, pos, SEEK_SET);
+    fputc(c ^ 0xff, fd);
+    fclose(fd);
+
+    BlockSnapshotReader reader(path_);
+    ASSERT_TRUE(reader.Open().ok());
+    ASSERT_EQ(chunk_cnt, reader.GetChunkCnt());
+    std::string buf;
+    BlockChunk chunk;
+    ASSERT_TRUE(reader.ReadChunk(0, &buf, &chunk).IsCorruption());
+    for (uint32_t i = 1; i < reader.GetChunkCnt(); i++) {
+        ASSERT_TRUE(reader.ReadChunk(i, &buf, &chunk).ok());
+    }
+}
+
+TEST_P(BlockSnapshotTest, Truncate) {
+    WriteFile(100000);
+    uint32_t chunk_cnt = 0;
+    {
+        BlockSnapshotReader reader(path_);
+        ASSERT_TRUE(reader.Open().ok());
+        chunk_cnt = reader.GetChunkCnt();
+    }
+    ASSERT_GT(chunk_cnt, 1u);
+    FILE* fd = fopen(path_.c_str(), "r+b");
+    ASSERT_TRUE(fd != nullptr);
+    fseek(fd, 0, SEEK_END);
+    ASSERT_EQ(0, ftruncate(fileno(fd), ftell(fd) - 10));
+    fclose(fd);
+    {
+        // a sealed snapshot is never cut in a chunk
+        BlockSnapshotReader reader(path_);
+        ASSERT_TRUE(reader.Open().IsCorruption());
+    }
+    // the broken tail chunk of a tmp file is ignored
+    std::string tmp_path = path_ + ".tmp";
+    ASSERT_EQ(0, rename(path_.c_str(), tmp_path.c_str()));
+    BlockSnapshotReader reader(tmp_path);
+    ASSERT_TRUE(reader.Open().ok());
+    ASSERT_EQ(chunk_cnt - 1, reader.GetChunkCnt());
+    unlink(tmp_path.c_str());
+}
+
+TEST_P(BlockSnapshotTest, Dimensions) {
+    WriteFile(100);
+    BlockSnapshotReader reader(path_);
+    ASSERT_TRUE(reader.Open().ok());
+    std::string buf;
+    BlockChunk chunk;
+    ASSERT_TRUE(reader.ReadChunk(0, &buf, &chunk).ok());
+    ::google::protobuf::RepeatedPtrField<::openmldb::api::Dimension> dimensions;
+    for (uint32_t i = 0; i < chunk.GetRecordCnt(); i++) {
+        auto entry = GenEntry(i + 1);
+        chunk.GetDimensions(i, &dimensions);
+        ASSERT_EQ(entry.dimensions_size(), dimensions.size());
+        for (int pos = 0; pos < dimensions.size(); pos++) {
+            ASSERT_EQ(entry.dimensions(pos).key(), dimensions.Get(pos).key());
+            ASSERT_EQ(entry.dimensions(pos).idx(), dimensions.Get(pos).idx());
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(CompressType, BlockSnapshotTest, ::testing::Values("off", "snappy", "zlib"));
+
+}  // namespace storage
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
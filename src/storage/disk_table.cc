@@ -16,11 +16,17 @@
 
 #include "storage/disk_table.h"
 #include <snappy.h>
+#include <algorithm>
 #include <utility>
 #include "absl/cleanup/cleanup.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
 #include "base/file_util.h"
 #include "base/glog_wrapper.h"
 #include "gflags/gflags.h"
+#include "rocksdb/utilities/table_properties_collectors.h"
 #include "storage/disk_table_iterator.h"
 
 DECLARE_bool(disable_wal);
@@ -29,8 +35,14 @@ DECLARE_string(file_compression);
 DECLARE_uint32(block_cache_mb);
 DECLARE_uint32(write_buffer_mb);
 DECLARE_uint32(block_cache_shardbits);
+DECLARE_uint32(key_filter_bits_per_key);
 DECLARE_bool(verify_compression);
 DECLARE_int32(disk_gc_interval);
+DECLARE_bool(disk_gc_by_compaction);
+DECLARE_uint64(disk_periodic_compaction_seconds);
+DECLARE_double(disk_compact_expired_ratio);
+DECLARE_bool(disk_shared_row);
+DECLARE_double(disk_row_sweep_ratio);
 DECLARE_uint32(max_log_file_size);
 DECLARE_uint32(keep_log_file_num);
 
@@ -40,6 +52,198 @@ namespace storage {
 static rocksdb::Options ssd_option_template;
 static rocksdb::Options hdd_option_template;
 static bool options_template_initialized = false;
+static std::shared_ptr<rocksdb::TableFactory> row_table_factory;
+// a row column family file with kRowDeletionTrigger deletes in any kRowDeletionWindow entries is compacted
+static constexpr size_t kRowDeletionWindow = 16384;
+static constexpr size_t kRowDeletionTrigger = 4096;
+// the rows deleted in a write batch by GcRows
+static constexpr uint32_t kRowGcBatch = 1024;
+// the dead row ids kept until GcRows, all rows are checked if there are more
+static constexpr size_t kMaxDeadRows = 1 << 20;
+
+// the abs part of ttl, a row expired by it is expired by ttl whatever its position in the pk
+static bool GetAbsTTL(const TTLSt& ttl, TTLSt* abs_ttl) {
+    if (ttl.abs_ttl == 0 || (ttl.ttl_type != TTLType::kAbsoluteTime && ttl.ttl_type != TTLType::kAbsOrLat)) {
+        return false;
+    }
+    *abs_ttl = TTLSt(ttl.abs_ttl, 0, TTLType::kAbsoluteTime);
+    return true;
+}
+
+// whether ttl expires a row by its position in the pk
+static bool HasLatTTL(const TTLSt& ttl) { return ttl.ttl_type != TTLType::kAbsoluteTime && ttl.NeedGc() && ttl.lat_ttl > 0; }
+
+bool KeyTsTTLFilter::Filter(int level, const rocksdb::Slice& key, const rocksdb::Slice& existing_value,
+                            std::string* new_value, bool* value_changed) const {
+    rocksdb::Slice pk;
+    uint64_t ts = 0;
+    uint32_t ts_idx = 0;
+    if (ParseKeyAndTs(has_ts_idx_, key, &pk, &ts, &ts_idx) != 0) {
+        return false;
+    }
+    auto iter = ttl_map_.find(ts_idx);
+    if (iter == ttl_map_.end() || !iter->second.IsExpired(ts, 0, current_time_)) {
+        return false;
+    }
+    if (on_drop_) {
+        on_drop_(existing_value);
+    }
+    return true;
+}
+
+std::unique_ptr<rocksdb::CompactionFilter> KeyTsTTLFilterFactory::CreateCompactionFilter(
+    const rocksdb::CompactionFilter::Context& context) {
+    auto inner_index = table_index_->GetInnerIndex(inner_id_);
+    if (!inner_index) {
+        return nullptr;
+    }
+    const auto& indexs = inner_index->GetIndex();
+    bool has_ts_idx = indexs.size() > 1;
+    std::map<uint32_t, TTLSt> ttl_map;
+    for (const auto& index : indexs) {
+        TTLSt abs_ttl;
+        if (index->IsReady() && GetAbsTTL(*(index->GetTTL()), &abs_ttl)) {
+            ttl_map.emplace(has_ts_idx ? index->GetTsColumn()->GetId() : 0, abs_ttl);
+        }
+    }
+    if (ttl_map.empty()) {
+        return nullptr;
+    }
+    uint64_t current_time = ::baidu::common::timer::get_micros() / 1000;
+    return std::make_unique<KeyTsTTLFilter>(has_ts_idx, std::move(ttl_map), current_time, on_drop_);
+}
+
+void TsStat::Add(uint64_t ts, bool key_changed) {
+    if (key_changed) {
+        key_cnt_++;
+    }
+    row_cnt_++;
+    buckets_[ts / width_]++;
+    while (buckets_.size() > kMaxBuckets) {
+        std::map<uint64_t, uint64_t> merged;
+        for (const auto& kv : buckets_) {
+            merged[kv.first / 2] += kv.second;
+        }
+        buckets_.swap(merged);
+        width_ *= 2;
+    }
+}
+
+std::string TsStat::Encode() const {
+    std::string value = absl::StrCat(row_cnt_, " ", key_cnt_, " ", width_);
+    for (const auto& kv : buckets_) {
+        absl::StrAppend(&value, " ", kv.first, ":", kv.second);
+    }
+    return value;
+}
+
+bool TsStat::Decode(const std::string& value) {
+    std::vector<absl::string_view> parts = absl::StrSplit(value, ' ', absl::SkipEmpty());
+    if (parts.size() < 3 || !absl::SimpleAtoi(parts[0], &row_cnt_) || !absl::SimpleAtoi(parts[1], &key_cnt_) ||
+        !absl::SimpleAtoi(parts[2], &width_) || width_ == 0) {
+        return false;
+    }
+    buckets_.clear();
+    for (size_t i = 3; i < parts.size(); i++) {
+        std::pair<absl::string_view, absl::string_view> kv = absl::StrSplit(parts[i], ':');
+        uint64_t bucket = 0;
+        uint64_t cnt = 0;
+        if (!absl::SimpleAtoi(kv.first, &bucket) || !absl::SimpleAtoi(kv.second, &cnt)) {
+            return false;
+        }
+        buckets_[bucket] = cnt;
+    }
+    return true;
+}
+
+double TsStat::FractionNotAfter(uint64_t ts) const {
+    if (row_cnt_ == 0) {
+        return 0;
+    }
+    uint64_t last_bucket = ts / width_;
+    double cnt = 0;
+    for (const auto& kv : buckets_) {
+        if (kv.first > last_bucket) {
+            break;
+        } else if (kv.first < last_bucket) {
+            cnt += kv.second;
+        } else {
+            // the rows of a bucket are assumed to spread evenly over it
+            cnt += static_cast<double>(kv.second) * (ts % width_ + 1) / width_;
+        }
+    }
+    return cnt / row_cnt_;
+}
+
+double TsStat::FractionBeyond(uint64_t lat_ttl) const {
+    if (row_cnt_ == 0 || key_cnt_ * lat_ttl >= row_cnt_) {
+        return 0;
+    }
+    return static_cast<double>(row_cnt_ - key_cnt_ * lat_ttl) / row_cnt_;
+}
+
+double TsStat::ExpiredFraction(const TTLSt& ttl, uint64_t current_time) const {
+    double abs = 0;
+    if (ttl.abs_ttl > 0 && current_time >= ttl.abs_ttl) {
+        abs = FractionNotAfter(current_time - ttl.abs_ttl);
+    }
+    double lat = ttl.lat_ttl > 0 ? FractionBeyond(ttl.lat_ttl) : 0;
+    switch (ttl.ttl_type) {
+        case TTLType::kAbsoluteTime:
+            return abs;
+        case TTLType::kLatestTime:
+            return lat;
+        case TTLType::kAbsAndLat:
+            return ttl.abs_ttl > 0 && ttl.lat_ttl > 0 ? std::min(abs, lat) : 0;
+        case TTLType::kAbsOrLat:
+            return std::max(abs, lat);
+        default:
+            return 0;
+    }
+}
+
+rocksdb::Status TsStatCollector::AddUserKey(const rocksdb::Slice& key, const rocksdb::Slice& value,
+                                            rocksdb::EntryType type, rocksdb::SequenceNumber seq,
+                                            uint64_t file_size) {
+    if (type != rocksdb::kEntryPut) {
+        return rocksdb::Status::OK();
+    }
+    rocksdb::Slice pk;
+    uint64_t ts = 0;
+    uint32_t ts_idx = 0;
+    if (ParseKeyAndTs(has_ts_idx_, key, &pk, &ts, &ts_idx) != 0) {
+        return rocksdb::Status::OK();
+    }
+    // the keys come in the order of KeyTSComparator, the rows of a pk and ts idx are adjacent
+    rocksdb::Slice prefix(key.data(), key.size() - TS_LEN);
+    bool key_changed = prefix != rocksdb::Slice(last_prefix_);
+    if (key_changed) {
+        last_prefix_.assign(prefix.data(), prefix.size());
+    }
+    stats_[ts_idx].Add(ts, key_changed);
+    return rocksdb::Status::OK();
+}
+
+rocksdb::Status TsStatCollector::Finish(rocksdb::UserCollectedProperties* properties) {
+    for (const auto& kv : stats_) {
+        properties->emplace(absl::StrCat(kTsStatProperty, kv.first), kv.second.Encode());
+    }
+    return rocksdb::Status::OK();
+}
+
+rocksdb::UserCollectedProperties TsStatCollector::GetReadableProperties() const {
+    rocksdb::UserCollectedProperties properties;
+    for (const auto& kv : stats_) {
+        properties.emplace(absl::StrCat(kTsStatProperty, kv.first), kv.second.Encode());
+    }
+    return properties;
+}
+
+rocksdb::TablePropertiesCollector* TsStatCollectorFactory::CreateTablePropertiesCollector(
+    rocksdb::TablePropertiesCollectorFactory::Context context) {
+    auto inner_index = table_index_->GetInnerIndex(inner_id_);
+    return new TsStatCollector(inner_index && inner_index->GetIndex().size() > 1);
+}
 
 DiskTable::DiskTable(const std::string& name, uint32_t id, uint32_t pid, const std::map<std::string, uint32_t>& mapping,
                      uint64_t ttl, ::openmldb::type::TTLType ttl_type, ::openmldb::common::StorageMode storage_mode,
@@ -48,7 +252,14 @@ DiskTable::DiskTable(const std::string& name, uint32_t id, uint32_t pid, const s
             ::openmldb::type::CompressType::kNoCompress),
       write_opts_(),
       offset_(0),
-      table_path_(table_path) {
+      table_path_(table_path),
+      shared_row_(false),
+      row_handle_(nullptr),
+      row_id_(0),
+      dead_row_mu_(),
+      dead_rows_(),
+      sweep_rows_(false),
+      row_gap_(0) {
     if (!options_template_initialized) {
         initOptionTemplate();
     }
@@ -62,7 +273,14 @@ DiskTable::DiskTable(const ::openmldb::api::TableMeta& table_meta, const std::st
             ::openmldb::type::CompressType::kNoCompress),
       write_opts_(),
       offset_(0),
-      table_path_(table_path) {
+      table_path_(table_path),
+      shared_row_(false),
+      row_handle_(nullptr),
+      row_id_(0),
+      dead_row_mu_(),
+      dead_rows_(),
+      sweep_rows_(false),
+      row_gap_(0) {
     if (!options_template_initialized) {
         initOptionTemplate();
     }
@@ -76,6 +294,7 @@ DiskTable::~DiskTable() {
     for (auto handle : cf_hs_) {
         delete handle;
     }
+    delete row_handle_;
     if (db_ != nullptr) {
         db_->Close();
         delete db_;
@@ -105,8 +324,11 @@ void DiskTable::initOptionTemplate() {
     // table_options.cache_index_and_filter_blocks = true;
     // table_options.pin_l0_filter_and_index_blocks_in_cache = true;
     table_options.block_cache = cache;
-    // table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10,
-    // false));
+    // with whole_key_filtering off, the filter is built on the pk prefix of KeyTsPrefixTransform, so the prefix
+    // seek of an absent pk skips the sst files
+    if (FLAGS_key_filter_bits_per_key > 0) {
+        table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(FLAGS_key_filter_bits_per_key, false));
+    }
     table_options.whole_key_filtering = false;
     table_options.block_size = 256 << 10;
     table_options.use_delta_encoding = false;
@@ -146,6 +368,10 @@ void DiskTable::initOptionTemplate() {
     hdd_option_template.target_file_size_base = 256 << 20;
     hdd_option_template.max_bytes_for_level_base = 1024 << 20;
     hdd_option_template.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
+    // the rows are read by the row ids, so the filter is on the whole keys and the blocks are small
+    table_options.whole_key_filtering = true;
+    table_options.block_size = 16 << 10;
+    row_table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
 
     options_template_initialized = true;
 }
@@ -166,11 +392,21 @@ bool DiskTable::InitColumnFamilyDescriptor() {
         rocksdb::ColumnFamilyOptions cfo(options_);
         cfo.comparator = &cmp_;
         cfo.prefix_extractor.reset(new KeyTsPrefixTransform());
+        SetTTLCompaction(inner_index->GetId(), &cfo);
         const auto& indexs = inner_index->GetIndex();
         auto index_def = indexs.front();
         cf_ds_.push_back(rocksdb::ColumnFamilyDescriptor(index_def->GetName(), cfo));
         DEBUGLOG("add cf_name %s. tid %u pid %u", index_def->GetName().c_str(), id_, pid_);
     }
+    if (shared_row_) {
+        rocksdb::ColumnFamilyOptions cfo(options_);
+        cfo.table_factory = row_table_factory;
+        // the files with many deleted rows are compacted, so the rows deleted by GcRows are dropped from the disk
+        // without compacting the whole column family
+        cfo.table_properties_collector_factories.push_back(
+            rocksdb::NewCompactOnDeletionCollectorFactory(kRowDeletionWindow, kRowDeletionTrigger));
+        cf_ds_.push_back(rocksdb::ColumnFamilyDescriptor(kRowColumnFamily, cfo));
+    }
     return true;
 }
 
@@ -178,8 +414,14 @@ bool DiskTable::Init() {
     if (!InitFromMeta()) {
         return false;
     }
-    InitColumnFamilyDescriptor();
     std::string path = table_path_ + "/data";
+    // an existing table keeps its layout, the flag is for the new tables
+    shared_row_ = FLAGS_disk_shared_row;
+    std::vector<std::string> cf_names;
+    if (rocksdb::DB::ListColumnFamilies(rocksdb::DBOptions(), path, &cf_names).ok()) {
+        shared_row_ = std::find(cf_names.begin(), cf_names.end(), kRowColumnFamily) != cf_names.end();
+    }
+    InitColumnFamilyDescriptor();
     if (!openmldb::base::IsExists(path)) {
         PDLOG(INFO, "Create new disk table with path %s", path);
     }
@@ -196,8 +438,15 @@ bool DiskTable::Init() {
         PDLOG(WARNING, "rocksdb open failed. tid %u pid %u error %s", id_, pid_, s.ToString().c_str());
         return false;
     }
-    PDLOG(INFO, "Open DB. tid %u pid %u ColumnFamilyHandle size %u with data path %s",
-        id_, pid_, cf_hs_.size(), path.c_str());
+    if (shared_row_) {
+        row_handle_ = cf_hs_.back();
+        cf_hs_.pop_back();
+        std::unique_ptr<rocksdb::Iterator> it(db_->NewIterator(rocksdb::ReadOptions(), row_handle_));
+        it->SeekToLast();
+        row_id_.store(it->Valid() ? DecodeRowId(it->key()) + 1 : 0, std::memory_order_relaxed);
+    }
+    PDLOG(INFO, "Open DB. tid %u pid %u ColumnFamilyHandle size %u with data path %s shared row %d",
+        id_, pid_, cf_hs_.size(), path.c_str(), shared_row_);
     cf_hs_.resize(MAX_INDEX_NUM, nullptr);
     return true;
 }
@@ -206,7 +455,15 @@ bool DiskTable::Put(const std::string& pk, uint64_t time, const char* data, uint
     rocksdb::Status s;
     std::string combine_key = CombineKeyTs(rocksdb::Slice(pk), time);
     rocksdb::Slice spk = rocksdb::Slice(combine_key);
-    s = db_->Put(write_opts_, cf_hs_[1], spk, rocksdb::Slice(data, size));
+    if (row_handle_ != nullptr) {
+        std::string row_id = EncodeRowId(row_id_.fetch_add(1, std::memory_order_relaxed));
+        rocksdb::WriteBatch batch;
+        batch.Put(cf_hs_[1], spk, row_id);
+        batch.Put(row_handle_, row_id, EncodeRowRecord({{0, combine_key}}, rocksdb::Slice(data, size)));
+        s = db_->Write(write_opts_, &batch);
+    } else {
+        s = db_->Put(write_opts_, cf_hs_[1], spk, rocksdb::Slice(data, size));
+    }
     if (s.ok()) {
         offset_.fetch_add(1, std::memory_order_relaxed);
         return true;
@@ -230,6 +487,8 @@ absl::Status DiskTable::Put(uint64_t time, const std::string& value, const Dimen
         return absl::InvalidArgumentError(absl::StrCat(id_, ".", pid_, ": invalid schema version ", version));
     }
     rocksdb::WriteBatch batch;
+    // the index entries holding the row id if the row is stored once
+    std::vector<std::pair<uint32_t, std::string>> refs;
     for (auto it = dimensions.begin(); it != dimensions.end(); ++it) {
         auto index_def = table_index_.GetIndex(it->idx());
         if (!index_def || !index_def->IsReady()) {
@@ -255,10 +514,21 @@ absl::Status DiskTable::Put(uint64_t time, const std::string& value, const Dimen
             } else {
                 combine_key = CombineKeyTs(it->key(), ts);
             }
+            if (row_handle_ != nullptr) {
+                refs.emplace_back(inner_pos, std::move(combine_key));
+                continue;
+            }
             rocksdb::Slice spk = rocksdb::Slice(combine_key);
             batch.Put(cf_hs_[inner_pos + 1], spk, value);
         }
     }
+    if (!refs.empty()) {
+        std::string row_id = EncodeRowId(row_id_.fetch_add(1, std::memory_order_relaxed));
+        for (const auto& ref : refs) {
+            batch.Put(cf_hs_[ref.first + 1], rocksdb::Slice(ref.second), row_id);
+        }
+        batch.Put(row_handle_, row_id, EncodeRowRecord(refs, value));
+    }
     auto s = db_->Write(write_opts_, &batch);
     if (s.ok()) {
         offset_.fetch_add(1, std::memory_order_relaxed);
@@ -322,6 +592,13 @@ bool DiskTable::Delete(uint32_t idx, const std::string& pk,
         combine_key1 = CombineKeyTs(pk, real_start_ts);
         combine_key2 = CombineKeyTs(pk, real_end_ts);
     }
+    if (row_handle_ != nullptr) {
+        rocksdb::ReadOptions ro;
+        ro.prefix_same_as_start = true;
+        std::unique_ptr<rocksdb::Iterator> it(db_->NewIterator(ro, cf_hs_[inner_pos + 1]));
+        it->Seek(rocksdb::Slice(combine_key1));
+        AddDeadRows(it.get(), rocksdb::Slice(combine_key2));
+    }
     rocksdb::WriteBatch batch;
     batch.DeleteRange(cf_hs_[inner_pos + 1], rocksdb::Slice(combine_key1), rocksdb::Slice(combine_key2));
     rocksdb::Status s = db_->Write(write_opts_, &batch);
@@ -381,6 +658,9 @@ base::Status DiskTable::Truncate() {
             }
         }
     }
+    if (row_handle_ != nullptr) {
+        batch.DeleteRange(row_handle_, EncodeRowId(0), EncodeRowId(UINT64_MAX));
+    }
     rocksdb::Status s = db_->Write(write_opts_, &batch);
     if (!s.ok()) {
         PDLOG(WARNING, "delete failed, tid %u pid %u msg %s", id_, pid_, s.ToString().c_str());
@@ -391,10 +671,268 @@ base::Status DiskTable::Truncate() {
 
 void DiskTable::SchedGc() {
     HandleDeletedIndex();
-    GcAll();
+    if (FLAGS_disk_gc_by_compaction) {
+        CompactExpired();
+        GcAll(true);
+    } else {
+        GcAll();
+    }
+    if (row_handle_ != nullptr) {
+        GcRows();
+    }
     UpdateTTL();
 }
 
+void DiskTable::GcRows() {
+    uint64_t start_time = ::baidu::common::timer::get_micros() / 1000;
+    std::vector<std::string> dead_rows;
+    bool sweep = false;
+    {
+        std::lock_guard<std::mutex> lock(dead_row_mu_);
+        dead_rows.swap(dead_rows_);
+        sweep = sweep_rows_;
+        sweep_rows_ = false;
+    }
+    // the rows of the overwritten entries are not noted, all rows are checked once the rows are more than the
+    // entries of the largest index by the ratio, compared with the gap left by the last check of all rows
+    uint64_t row_cnt = 0;
+    uint64_t entry_cnt = 0;
+    db_->GetIntProperty(row_handle_, "rocksdb.estimate-num-keys", &row_cnt);
+    for (uint32_t i = 1; i < cf_hs_.size(); i++) {
+        uint64_t cnt = 0;
+        if (cf_hs_[i] != nullptr && db_->GetIntProperty(cf_hs_[i], "rocksdb.estimate-num-keys", &cnt)) {
+            entry_cnt = std::max(entry_cnt, cnt);
+        }
+    }
+    int64_t gap = static_cast<int64_t>(row_cnt) - static_cast<int64_t>(entry_cnt);
+    if (!sweep && FLAGS_disk_row_sweep_ratio > 0 &&
+        gap - row_gap_ - static_cast<int64_t>(dead_rows.size()) > row_cnt * FLAGS_disk_row_sweep_ratio) {
+        sweep = true;
+    }
+    uint64_t checked_cnt = 0;
+    uint64_t deleted_cnt = 0;
+    rocksdb::WriteBatch batch;
+    auto check = [&](const rocksdb::Slice& row_id, const rocksdb::Slice& record) {
+        checked_cnt++;
+        if (IsRowReferred(row_id, record)) {
+            return;
+        }
+        // a delete keeps the row for the snapshots taken before it, unlike dropping it in compaction
+        batch.Delete(row_handle_, row_id);
+        deleted_cnt++;
+        if (batch.Count() >= kRowGcBatch) {
+            rocksdb::Status s = db_->Write(write_opts_, &batch);
+            if (!s.ok()) {
+                PDLOG(WARNING, "delete rows failed. tid %u pid %u msg %s", id_, pid_, s.ToString().c_str());
+            }
+            batch.Clear();
+        }
+    };
+    if (sweep) {
+        std::unique_ptr<rocksdb::Iterator> it(db_->NewIterator(rocksdb::ReadOptions(), row_handle_));
+        for (it->SeekToFirst(); it->Valid(); it->Next()) {
+            check(it->key(), it->value());
+        }
+    } else {
+        std::sort(dead_rows.begin(), dead_rows.end());
+        dead_rows.erase(std::unique(dead_rows.begin(), dead_rows.end()), dead_rows.end());
+        std::string record;
+        for (const auto& row_id : dead_rows) {
+            rocksdb::Status s = db_->Get(rocksdb::ReadOptions(), row_handle_, row_id, &record);
+            if (s.IsNotFound()) {
+                continue;
+            } else if (!s.ok()) {
+                PDLOG(WARNING, "get row failed. tid %u pid %u msg %s", id_, pid_, s.ToString().c_str());
+                continue;
+            }
+            check(row_id, record);
+        }
+    }
+    if (batch.Count() > 0) {
+        rocksdb::Status s = db_->Write(write_opts_, &batch);
+        if (!s.ok()) {
+            PDLOG(WARNING, "delete rows failed. tid %u pid %u msg %s", id_, pid_, s.ToString().c_str());
+        }
+    }
+    if (sweep) {
+        // the rows left are referred, so the gap left is of the estimates and the rows held by some indexes only
+        row_gap_ = gap - static_cast<int64_t>(deleted_cnt);
+    }
+    uint64_t time_used = ::baidu::common::timer::get_micros() / 1000 - start_time;
+    PDLOG(INFO, "gc rows checked %lu rows and deleted %lu rows, sweep %d, used %lu ms. tid %u pid %u", checked_cnt,
+          deleted_cnt, sweep, time_used, id_, pid_);
+}
+
+void DiskTable::AddDeadRows(rocksdb::Iterator* it, const rocksdb::Slice& end_key) {
+    if (row_handle_ == nullptr) {
+        return;
+    }
+    for (; it->Valid() && cmp_.Compare(it->key(), end_key) < 0; it->Next()) {
+        AddDeadRow(it->value());
+    }
+}
+
+void DiskTable::AddDeadRow(const rocksdb::Slice& row_id) {
+    std::lock_guard<std::mutex> lock(dead_row_mu_);
+    if (sweep_rows_) {
+        return;
+    }
+    // too many rows to keep, check all rows instead
+    if (dead_rows_.size() >= kMaxDeadRows) {
+        dead_rows_.clear();
+        dead_rows_.shrink_to_fit();
+        sweep_rows_ = true;
+        return;
+    }
+    dead_rows_.emplace_back(row_id.data(), row_id.size());
+}
+
+bool DiskTable::IsRowReferred(const rocksdb::Slice& row_id, const rocksdb::Slice& record) {
+    std::vector<std::pair<uint32_t, rocksdb::Slice>> refs;
+    rocksdb::Slice row;
+    // keep the row if it can not be parsed
+    if (!ParseRowRecord(record, &refs, &row)) {
+        PDLOG(WARNING, "parse row record failed. tid %u pid %u row id %lu", id_, pid_, DecodeRowId(row_id));
+        return true;
+    }
+    for (const auto& ref : refs) {
+        if (IsRowReferred(ref.first, ref.second, row_id)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DiskTable::IsRowReferred(uint32_t inner_pos, const rocksdb::Slice& key, const rocksdb::Slice& row_id) {
+    // the column family of an index is dropped after it is not ready
+    auto inner_index = table_index_.GetInnerIndex(inner_pos);
+    if (!inner_index || inner_pos + 1 >= cf_hs_.size() || cf_hs_[inner_pos + 1] == nullptr) {
+        return false;
+    }
+    const auto& indexs = inner_index->GetIndex();
+    if (std::none_of(indexs.begin(), indexs.end(), [](const auto& index) { return index->IsReady(); })) {
+        return false;
+    }
+    std::string value;
+    rocksdb::Status s = db_->Get(rocksdb::ReadOptions(), cf_hs_[inner_pos + 1], key, &value);
+    if (s.IsNotFound()) {
+        return false;
+    }
+    // keep the row if the entry can not be read
+    return !s.ok() || rocksdb::Slice(value) == row_id;
+}
+
+DiskRowReader* DiskTable::NewRowReader(uint32_t inner_pos, const rocksdb::Snapshot* snapshot, bool same_prefix) {
+    if (row_handle_ == nullptr) {
+        return nullptr;
+    }
+    return new DiskRowReader(db_, snapshot, cf_hs_[inner_pos + 1], row_handle_, same_prefix);
+}
+
+void DiskTable::SetTTLCompaction(uint32_t inner_id, rocksdb::ColumnFamilyOptions* cfo) {
+    if (!FLAGS_disk_gc_by_compaction) {
+        return;
+    }
+    KeyTsTTLFilter::DropCallback on_drop;
+    if (shared_row_) {
+        on_drop = [this](const rocksdb::Slice& row_id) { AddDeadRow(row_id); };
+    }
+    cfo->compaction_filter_factory = std::make_shared<KeyTsTTLFilterFactory>(&table_index_, inner_id, on_drop);
+    cfo->table_properties_collector_factories.push_back(
+        std::make_shared<TsStatCollectorFactory>(&table_index_, inner_id));
+    // the filter drops the rows expired by the abs ttl in the background compactions, a file no compaction picks for
+    // the period is compacted too
+    cfo->periodic_compaction_seconds = FLAGS_disk_periodic_compaction_seconds;
+}
+
+void DiskTable::CompactExpired() {
+    uint64_t start_time = ::baidu::common::timer::get_micros() / 1000;
+    auto inner_indexs = table_index_.GetAllInnerIndex();
+    for (const auto& inner_index : *inner_indexs) {
+        uint32_t idx = inner_index->GetId();
+        auto handle = cf_hs_[idx + 1];
+        if (handle == nullptr) {
+            continue;
+        }
+        const auto& indexs = inner_index->GetIndex();
+        bool has_ts_idx = indexs.size() > 1;
+        std::map<uint32_t, TTLSt> ttl_map;
+        for (const auto& index : indexs) {
+            TTLSt abs_ttl;
+            if (index->IsReady() && GetAbsTTL(*(index->GetTTL()), &abs_ttl)) {
+                ttl_map.emplace(has_ts_idx ? index->GetTsColumn()->GetId() : 0, abs_ttl);
+            }
+        }
+        if (ttl_map.empty()) {
+            continue;
+        }
+        // the rows in memtable are checked after they are flushed
+        rocksdb::Status s = db_->Flush(rocksdb::FlushOptions(), handle);
+        if (!s.ok()) {
+            PDLOG(WARNING, "flush failed. tid %u pid %u idx %u msg %s", id_, pid_, idx, s.ToString().c_str());
+        }
+        rocksdb::TablePropertiesCollection props;
+        s = db_->GetPropertiesOfAllTables(handle, &props);
+        if (!s.ok()) {
+            PDLOG(WARNING, "get table properties failed. tid %u pid %u idx %u msg %s", id_, pid_, idx,
+                  s.ToString().c_str());
+            continue;
+        }
+        // <file name, estimated expired fraction>, the files written before the collector was set have no stat and
+        // are left to the periodic compaction
+        std::map<std::string, double> expired_map;
+        for (const auto& kv : props) {
+            uint64_t row_cnt = 0;
+            double expired_cnt = 0;
+            for (const auto& prop : kv.second->user_collected_properties) {
+                uint32_t ts_idx = 0;
+                TsStat stat;
+                if (!absl::StartsWith(prop.first, kTsStatProperty) ||
+                    !absl::SimpleAtoi(prop.first.substr(sizeof(kTsStatProperty) - 1), &ts_idx) ||
+                    !stat.Decode(prop.second)) {
+                    continue;
+                }
+                row_cnt += stat.GetRowCnt();
+                if (auto iter = ttl_map.find(ts_idx); iter != ttl_map.end()) {
+                    expired_cnt += stat.ExpiredFraction(iter->second, start_time) * stat.GetRowCnt();
+                }
+            }
+            if (row_cnt > 0) {
+                auto pos = kv.first.rfind('/');
+                expired_map.emplace(pos == std::string::npos ? kv.first : kv.first.substr(pos + 1),
+                                    expired_cnt / row_cnt);
+            }
+        }
+        // a file is rewritten in its level and a level 0 file goes to level 1, so the compaction reads the files
+        // picked and the ones of level 1 that a level 0 file overlaps
+        rocksdb::ColumnFamilyMetaData cf_meta;
+        db_->GetColumnFamilyMetaData(handle, &cf_meta);
+        uint32_t file_cnt = 0;
+        for (const auto& level : cf_meta.levels) {
+            std::vector<std::string> files;
+            for (const auto& file : level.files) {
+                auto pos = file.name.rfind('/');
+                auto iter = expired_map.find(pos == std::string::npos ? file.name : file.name.substr(pos + 1));
+                if (iter != expired_map.end() && iter->second >= FLAGS_disk_compact_expired_ratio) {
+                    files.push_back(file.name);
+                }
+            }
+            if (files.empty()) {
+                continue;
+            }
+            file_cnt += files.size();
+            s = db_->CompactFiles(rocksdb::CompactionOptions(), handle, files, std::max(level.level, 1));
+            if (!s.ok()) {
+                PDLOG(WARNING, "compact %lu files of level %d failed. tid %u pid %u idx %u msg %s", files.size(),
+                      level.level, id_, pid_, idx, s.ToString().c_str());
+            }
+        }
+        PDLOG(INFO, "compact %u of %lu sst files. tid %u pid %u idx %u", file_cnt, expired_map.size(), id_, pid_, idx);
+    }
+    uint64_t time_used = ::baidu::common::timer::get_micros() / 1000 - start_time;
+    PDLOG(INFO, "Gc by compaction used %lu second. tid %u pid %u", time_used / 1000, id_, pid_);
+}
+
 void DiskTable::HandleDeletedIndex() {
     auto inner_indexs = table_index_.GetAllInnerIndex();
     for (const auto& inner_index : *inner_indexs) {
@@ -416,6 +954,12 @@ void DiskTable::HandleDeletedIndex() {
                     } else {
                         DeleteIndexData(cur_index);
                     }
+                    if (row_handle_ != nullptr) {
+                        // the entries of the index are not read, so all rows are checked
+                        std::lock_guard<std::mutex> lock(dead_row_mu_);
+                        dead_rows_.clear();
+                        sweep_rows_ = true;
+                    }
                     cur_index->SetStatus(IndexStatus::kDeleted);
                     break;
                 }
@@ -471,7 +1015,7 @@ void DiskTable::DeleteIndexData(const std::shared_ptr<IndexDef>& index_def) {
     }
 }
 
-void DiskTable::GcAll() {
+void DiskTable::GcAll(bool lat_only) {
     uint64_t start_time = ::baidu::common::timer::get_micros() / 1000;
     auto inner_indexs = table_index_.GetAllInnerIndex();
     const rocksdb::Snapshot* snapshot = db_->GetSnapshot();
@@ -510,7 +1054,7 @@ void DiskTable::GcAll() {
                 if (ts_idx < min_ts_idx) {
                     min_ts_idx = ts_idx;
                 }
-                if (index->GetTTL()->NeedGc()) {
+                if (index->GetTTL()->NeedGc() && (!lat_only || HasLatTTL(*(index->GetTTL())))) {
                     ttl_map.emplace(ts_idx, *(index->GetTTL()));
                 }
             }
@@ -523,7 +1067,7 @@ void DiskTable::GcAll() {
             if (!index->IsReady()) {
                 continue;
             }
-            if (!index->GetTTL()->NeedGc()) {
+            if (!index->GetTTL()->NeedGc() || (lat_only && !HasLatTTL(*(index->GetTTL())))) {
                 continue;
             }
             GcData(*(index->GetTTL()), it.get(), handle);
@@ -570,6 +1114,7 @@ void DiskTable::GcData(const TTLSt& ttl, rocksdb::Iterator* it, rocksdb::ColumnF
                 DLOG(INFO) << "key " << cur_pk.ToString() << " ts " << ts << " count " << count << " expired";
                 std::string combine_key1 = CombineKeyTs(cur_pk, ts);
                 std::string combine_key2 = CombineKeyTs(cur_pk, 0);
+                AddDeadRows(it, rocksdb::Slice(combine_key2));
                 rocksdb::Status s = db_->DeleteRange(write_opts_, handle,
                             rocksdb::Slice(combine_key1), rocksdb::Slice(combine_key2));
                 if (!s.ok()) {
@@ -620,6 +1165,7 @@ void DiskTable::GcData(const std::map<uint32_t, TTLSt>& ttl_map, uint32_t min_ts
                 if (kv.second.IsExpired(ts, count, current_time)) {
                     std::string combine_key1 = CombineKeyTs(cur_pk, ts, ts_idx);
                     std::string combine_key2 = CombineKeyTs(cur_pk, 0, ts_idx);
+                    AddDeadRows(it, rocksdb::Slice(combine_key2));
                     rocksdb::Status s = db_->DeleteRange(write_opts_, handle,
                                 rocksdb::Slice(combine_key1), rocksdb::Slice(combine_key2));
                     if (!s.ok()) {
@@ -687,10 +1233,11 @@ TableIterator* DiskTable::NewIterator(uint32_t idx, const std::string& pk, Ticke
     if (inner_index && inner_index->GetIndex().size() > 1) {
         auto ts_col = index_def->GetTsColumn();
         if (ts_col) {
-            return new DiskTableIterator(db_, it, snapshot, pk, ts_col->GetId(), GetCompressType());
+            return new DiskTableIterator(db_, it, snapshot, pk, ts_col->GetId(), GetCompressType(),
+                                         NewRowReader(inner_pos, snapshot, true));
         }
     }
-    return new DiskTableIterator(db_, it, snapshot, pk, GetCompressType());
+    return new DiskTableIterator(db_, it, snapshot, pk, GetCompressType(), NewRowReader(inner_pos, snapshot, true));
 }
 
 TraverseIterator* DiskTable::NewTraverseIterator(uint32_t index) {
@@ -712,11 +1259,14 @@ TraverseIterator* DiskTable::NewTraverseIterator(uint32_t index) {
     if (inner_index && inner_index->GetIndex().size() > 1) {
         auto ts_col = index_def->GetTsColumn();
         if (ts_col) {
+            // the iterator skips the entries of the other ts idx, so a batch is of the entries of one pk
             return new DiskTableTraverseIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt,
-                                                 ts_col->GetId(), GetCompressType());
+                                                 ts_col->GetId(), GetCompressType(),
+                                                 NewRowReader(inner_pos, snapshot, true));
         }
     }
-    return new DiskTableTraverseIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt, GetCompressType());
+    return new DiskTableTraverseIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt, GetCompressType(),
+                                         NewRowReader(inner_pos, snapshot, false));
 }
 
 ::hybridse::vm::WindowIterator* DiskTable::NewWindowIterator(uint32_t idx) {
@@ -739,11 +1289,11 @@ TraverseIterator* DiskTable::NewTraverseIterator(uint32_t index) {
         auto ts_col = index_def->GetTsColumn();
         if (ts_col) {
             return new DiskTableKeyIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt,
-                    ts_col->GetId(), cf_hs_[inner_pos + 1], GetCompressType());
+                    ts_col->GetId(), cf_hs_[inner_pos + 1], GetCompressType(), row_handle_);
         }
     }
     return new DiskTableKeyIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt,
-            cf_hs_[inner_pos + 1], GetCompressType());
+            cf_hs_[inner_pos + 1], GetCompressType(), row_handle_);
 }
 
 bool DiskTable::AddIndexToTable(const std::shared_ptr<IndexDef>& index_def) {
@@ -756,6 +1306,7 @@ bool DiskTable::AddIndexToTable(const std::shared_ptr<IndexDef>& index_def) {
     uint32_t inner_id = index_def->GetInnerPos();
     cfo.comparator = &cmp_;
     cfo.prefix_extractor.reset(new KeyTsPrefixTransform());
+    SetTTLCompaction(inner_id, &cfo);
     rocksdb::ColumnFamilyHandle* handle = nullptr;
     rocksdb::Status s = db_->CreateColumnFamily(cfo, index_def->GetName(), &handle);
     if (!s.ok()) {
@@ -17,9 +17,12 @@
 #pragma once
 
 #include <atomic>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/slice.h"
@@ -27,6 +30,7 @@
 #include "common/timer.h"
 #include "proto/common.pb.h"
 #include "proto/tablet.pb.h"
+#include "rocksdb/compaction_filter.h"
 #include "rocksdb/db.h"
 #include "rocksdb/filter_policy.h"
 #include "rocksdb/options.h"
@@ -34,9 +38,11 @@
 #include "rocksdb/slice_transform.h"
 #include "rocksdb/status.h"
 #include "rocksdb/table.h"
+#include "rocksdb/table_properties.h"
 #include "rocksdb/utilities/checkpoint.h"
 #include "storage/iterator.h"
 #include "storage/key_transform.h"
+#include "storage/schema.h"
 #include "storage/table.h"
 
 namespace openmldb {
@@ -83,6 +89,121 @@ class KeyTsPrefixTransform : public rocksdb::SliceTransform {
     bool SameResultWhenAppended(const rocksdb::Slice& prefix) const override { return InDomain(prefix); }
 };
 
+// the prefix of the user collected properties of an sst file, each ts idx of the rows in it has one
+static constexpr char kTsStatProperty[] = "openmldb.ts_stat.";
+
+// drops the rows of an inner index expired by the abs ttl in compaction. the latest ttl is not applied here, a filter
+// also sees the rows deleted by a DeleteRange and not the tombstones of the other levels, so the position of a row
+// in its pk can not be counted. GcAll iterates the indexes with a latest ttl instead
+class KeyTsTTLFilter : public rocksdb::CompactionFilter {
+ public:
+    // called with the value of each dropped entry, which is the row id if the rows are stored once
+    using DropCallback = std::function<void(const rocksdb::Slice& value)>;
+
+    // the keys of ttl_map are the ts idx if has_ts_idx, else the only key is 0. the ttl are kAbsoluteTime, on_drop
+    // may be empty
+    KeyTsTTLFilter(bool has_ts_idx, std::map<uint32_t, TTLSt> ttl_map, uint64_t current_time,
+                   DropCallback on_drop = nullptr)
+        : has_ts_idx_(has_ts_idx),
+          ttl_map_(std::move(ttl_map)),
+          current_time_(current_time),
+          on_drop_(std::move(on_drop)) {}
+    const char* Name() const override { return "KeyTsTTLFilter"; }
+
+    bool Filter(int level, const rocksdb::Slice& key, const rocksdb::Slice& existing_value, std::string* new_value,
+                bool* value_changed) const override;
+
+ private:
+    const bool has_ts_idx_;
+    const std::map<uint32_t, TTLSt> ttl_map_;
+    const uint64_t current_time_;
+    const DropCallback on_drop_;
+};
+
+// creates the KeyTsTTLFilter of a compaction with the current ttl of the inner index
+class KeyTsTTLFilterFactory : public rocksdb::CompactionFilterFactory {
+ public:
+    // table_index must outlive the db
+    KeyTsTTLFilterFactory(const TableIndex* table_index, uint32_t inner_id,
+                          KeyTsTTLFilter::DropCallback on_drop = nullptr)
+        : table_index_(table_index), inner_id_(inner_id), on_drop_(std::move(on_drop)) {}
+    const char* Name() const override { return "KeyTsTTLFilterFactory"; }
+
+    std::unique_ptr<rocksdb::CompactionFilter> CreateCompactionFilter(
+        const rocksdb::CompactionFilter::Context& context) override;
+
+ private:
+    const TableIndex* table_index_;
+    const uint32_t inner_id_;
+    const KeyTsTTLFilter::DropCallback on_drop_;
+};
+
+// the time distribution of the rows of a ts idx in an sst file. the rows are counted in the buckets of width ms, and
+// the width doubles when there are more than kMaxBuckets buckets, so the property of a file stays small
+class TsStat {
+ public:
+    // called in the key order, key_changed is set for the first row of a pk
+    void Add(uint64_t ts, bool key_changed);
+    std::string Encode() const;
+    bool Decode(const std::string& value);
+
+    uint64_t GetRowCnt() const { return row_cnt_; }
+    // the estimated fraction of the rows whose ts <= ts
+    double FractionNotAfter(uint64_t ts) const;
+    // the fraction of the rows out of the latest lat_ttl rows of their pk in the file. the rows of the pk in the
+    // other files only expire more of them, so it's a lower bound
+    double FractionBeyond(uint64_t lat_ttl) const;
+    // the estimated fraction of the rows expired by ttl at current_time
+    double ExpiredFraction(const TTLSt& ttl, uint64_t current_time) const;
+
+ private:
+    static constexpr uint64_t kMinWidth = 60 * 1000;
+    static constexpr size_t kMaxBuckets = 64;
+
+    uint64_t width_ = kMinWidth;
+    // <ts / width_, row count>
+    std::map<uint64_t, uint64_t> buckets_;
+    uint64_t row_cnt_ = 0;
+    uint64_t key_cnt_ = 0;
+};
+
+// collects the TsStat of each ts idx of an sst file, the gc compaction picks the files by them
+class TsStatCollector : public rocksdb::TablePropertiesCollector {
+ public:
+    explicit TsStatCollector(bool has_ts_idx) : has_ts_idx_(has_ts_idx) {}
+    const char* Name() const override { return "TsStatCollector"; }
+
+    rocksdb::Status AddUserKey(const rocksdb::Slice& key, const rocksdb::Slice& value, rocksdb::EntryType type,
+                               rocksdb::SequenceNumber seq, uint64_t file_size) override;
+    rocksdb::Status Finish(rocksdb::UserCollectedProperties* properties) override;
+    rocksdb::UserCollectedProperties GetReadableProperties() const override;
+
+ private:
+    const bool has_ts_idx_;
+    std::string last_prefix_;
+    std::map<uint32_t, TsStat> stats_;
+};
+
+class TsStatCollectorFactory : public rocksdb::TablePropertiesCollectorFactory {
+ public:
+    // table_index must outlive the db
+    TsStatCollectorFactory(const TableIndex* table_index, uint32_t inner_id)
+        : table_index_(table_index), inner_id_(inner_id) {}
+    const char* Name() const override { return "TsStatCollectorFactory"; }
+    rocksdb::TablePropertiesCollector* CreateTablePropertiesCollector(
+        rocksdb::TablePropertiesCollectorFactory::Context context) override;
+
+ private:
+    const TableIndex* table_index_;
+    const uint32_t inner_id_;
+};
+
+class DiskRowReader;
+
+// the column family storing the rows of a table with disk_shared_row, keyed by the row ids. a row is removed by a
+// delete after no index entry holds its row id, so the snapshots taken before still read it
+static constexpr char kRowColumnFamily[] = "__openmldb_row";
+
 class DiskTable : public Table {
  public:
     DiskTable(const std::string& name, uint32_t id, uint32_t pid, const std::map<std::string, uint32_t>& mapping,
@@ -141,7 +262,8 @@ class DiskTable : public Table {
 
     void SchedGc() override;
 
-    void GcAll();
+    // delete the expired rows by iterating the table, only the indexes with a latest ttl if lat_only
+    void GcAll(bool lat_only = false);
 
     bool IsExpire(const ::openmldb::api::LogEntry& entry) override;
 
@@ -162,6 +284,23 @@ class DiskTable : public Table {
     base::Status Delete(uint32_t idx, const std::string& pk, uint64_t start_ts, const std::optional<uint64_t>& end_ts);
     void HandleDeletedIndex();
     void DeleteIndexData(const std::shared_ptr<IndexDef>& index_def);
+    // set the compaction filter of ttl, the ts stat collector and the periodic compaction on the options of the
+    // column family of inner_id
+    void SetTTLCompaction(uint32_t inner_id, rocksdb::ColumnFamilyOptions* cfo);
+    // compact the sst files whose estimated expired rows are no less than disk_compact_expired_ratio, the compaction
+    // filter drops the rows
+    void CompactExpired();
+    // delete the rows that no index entry holds. the rows of the dropped entries are checked, and all rows are
+    // checked if an index is deleted or the estimated unreferenced rows are more than disk_row_sweep_ratio
+    void GcRows();
+    // note the row ids of the entries of it before end_key, they are checked by the next GcRows
+    void AddDeadRows(rocksdb::Iterator* it, const rocksdb::Slice& end_key);
+    void AddDeadRow(const rocksdb::Slice& row_id);
+    // whether an index entry holds the row id of the row record
+    bool IsRowReferred(const rocksdb::Slice& row_id, const rocksdb::Slice& record);
+    bool IsRowReferred(uint32_t inner_pos, const rocksdb::Slice& key, const rocksdb::Slice& row_id);
+    // the reader of the rows of the index entries of inner_pos, nullptr if the rows are in the entries
+    DiskRowReader* NewRowReader(uint32_t inner_pos, const rocksdb::Snapshot* snapshot, bool same_prefix);
     void GcData(const TTLSt& ttl, rocksdb::Iterator* it, rocksdb::ColumnFamilyHandle* handle);
     void GcData(const std::map<uint32_t, TTLSt>& ttl_map, uint32_t min_ts_idx,
             rocksdb::Iterator* it, rocksdb::ColumnFamilyHandle* handle);
@@ -179,6 +318,18 @@ class DiskTable : public Table {
     KeyTSComparator cmp_;
     std::atomic<uint64_t> offset_;
     std::string table_path_;
+    // whether the rows are stored once and the index entries hold the row ids
+    bool shared_row_;
+    // the row column family if shared_row_, else nullptr
+    rocksdb::ColumnFamilyHandle* row_handle_;
+    std::atomic<uint64_t> row_id_;
+    // the row ids of the dropped entries, and whether GcRows checks all rows, the rows of the entries dropped by
+    // the overwrites are found by checking all rows only
+    std::mutex dead_row_mu_;
+    std::vector<std::string> dead_rows_;
+    bool sweep_rows_;
+    // the estimated rows minus the entries of the largest index after all rows were checked
+    int64_t row_gap_;
 };
 
 }  // namespace storage
@@ -0,0 +1,228 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "base/file_util.h"
+#include "benchmark/benchmark.h"
+#include "codec/schema_codec.h"
+#include "codec/sdk_codec.h"
+#include "gflags/gflags.h"
+#include "storage/disk_table.h"
+#include "storage/ticket.h"
+
+DECLARE_bool(disk_shared_row);
+
+namespace openmldb {
+namespace storage {
+
+using ::openmldb::codec::SchemaCodec;
+
+static constexpr int kKeyNum = 10000;
+static constexpr int kRowNum = 100000;
+static constexpr int kMaxIndexNum = 5;
+static constexpr char kTablePath[] = "/tmp/disk_table_bm";
+
+// a table of kMaxIndexNum key columns, the first index_num of them are indexed and keep the latest lat_ttl rows
+// of a key, 0 keeps all rows
+static ::openmldb::api::TableMeta CreateMeta(uint32_t tid, int index_num, uint64_t lat_ttl = 0) {
+    ::openmldb::api::TableMeta meta;
+    meta.set_tid(tid);
+    meta.set_pid(1);
+    meta.set_storage_mode(::openmldb::common::kHDD);
+    for (int i = 0; i < kMaxIndexNum; i++) {
+        SchemaCodec::SetColumnDesc(meta.add_column_desc(), absl::StrCat("k", i), ::openmldb::type::kString);
+    }
+    SchemaCodec::SetColumnDesc(meta.add_column_desc(), "ts", ::openmldb::type::kBigInt);
+    SchemaCodec::SetColumnDesc(meta.add_column_desc(), "value", ::openmldb::type::kString);
+    for (int i = 0; i < index_num; i++) {
+        SchemaCodec::SetIndex(meta.add_column_key(), absl::StrCat("index", i), absl::StrCat("k", i), "ts",
+                              lat_ttl > 0 ? ::openmldb::type::kLatestTime : ::openmldb::type::kAbsoluteTime, 0,
+                              lat_ttl);
+    }
+    return meta;
+}
+
+static std::string EncodeRow(const ::openmldb::api::TableMeta& meta, int key, uint64_t ts) {
+    codec::SDKCodec codec(meta);
+    std::vector<std::string> row;
+    for (int i = 0; i < kMaxIndexNum; i++) {
+        row.push_back(absl::StrCat("key", i, "_", key));
+    }
+    row.push_back(std::to_string(ts));
+    row.push_back(std::string(100, 'a'));
+    std::string value;
+    codec.EncodeRow(row, &value);
+    return value;
+}
+
+static Dimensions GetDimensions(int index_num, int key) {
+    Dimensions dims;
+    for (int i = 0; i < index_num; i++) {
+        auto dim = dims.Add();
+        dim->set_key(absl::StrCat("key", i, "_", key));
+        dim->set_idx(i);
+    }
+    return dims;
+}
+
+// range(0) is the count of indexes, range(1) is 1 if the rows are stored once. disk_bytes_per_row is the size of
+// the table on disk after the memtables are flushed
+static void BM_DiskTablePut(benchmark::State& state) {  // NOLINT
+    int index_num = state.range(0);
+    auto meta = CreateMeta(1, index_num);
+    std::string table_path = absl::StrCat(kTablePath, "/put_", index_num, "_", state.range(1));
+    FLAGS_disk_shared_row = state.range(1) != 0;
+    auto table = std::make_unique<DiskTable>(meta, table_path);
+    bool ok = table->Init();
+    FLAGS_disk_shared_row = false;
+    if (!ok) {
+        state.SkipWithError("init table failed");
+        return;
+    }
+    // the rows have distinct ts, so none of them is overwritten
+    std::vector<std::string> rows;
+    std::vector<Dimensions> dims;
+    for (int i = 0; i < kRowNum; i++) {
+        rows.push_back(EncodeRow(meta, i % kKeyNum, i + 1));
+        dims.push_back(GetDimensions(index_num, i % kKeyNum));
+    }
+    int pos = 0;
+    for (auto _ : state) {
+        table->Put(pos + 1, rows[pos], dims[pos]);
+        if (++pos == kRowNum) {
+            pos = 0;
+        }
+    }
+    // closing the table flushes the memtables
+    table.reset();
+    uint64_t size = 0;
+    ::openmldb::base::GetDirSizeRecur(table_path + "/data", size);
+    state.counters["disk_bytes_per_row"] = static_cast<double>(size) / state.iterations();
+    state.SetItemsProcessed(state.iterations());
+    std::filesystem::remove_all(table_path);
+}
+
+// range(0) and range(1) are as BM_DiskTablePut, each iteration reads the 10 rows of a key in the first index
+static void BM_DiskTableScan(benchmark::State& state) {  // NOLINT
+    int index_num = state.range(0);
+    auto meta = CreateMeta(2, index_num);
+    std::string table_path = absl::StrCat(kTablePath, "/scan_", index_num, "_", state.range(1));
+    FLAGS_disk_shared_row = state.range(1) != 0;
+    auto table = std::make_unique<DiskTable>(meta, table_path);
+    bool ok = table->Init();
+    FLAGS_disk_shared_row = false;
+    if (!ok) {
+        state.SkipWithError("init table failed");
+        return;
+    }
+    for (int i = 0; i < kKeyNum; i++) {
+        auto dims = GetDimensions(index_num, i);
+        for (uint64_t ts = 1; ts <= 10; ts++) {
+            table->Put(ts, EncodeRow(meta, i, ts), dims);
+        }
+    }
+    int pos = 0;
+    for (auto _ : state) {
+        Ticket ticket;
+        std::unique_ptr<TableIterator> it(table->NewIterator(0, absl::StrCat("key0_", pos), ticket));
+        for (it->SeekToFirst(); it->Valid(); it->Next()) {
+            benchmark::DoNotOptimize(it->GetValue());
+        }
+        if (++pos == kKeyNum) {
+            pos = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 10);
+    table.reset();
+    std::filesystem::remove_all(table_path);
+}
+
+// the bytes written to the disk by the process, false if /proc/self/io can not be read
+static bool GetWrittenBytes(uint64_t* written) {
+    std::ifstream io("/proc/self/io");
+    std::string name;
+    uint64_t value = 0;
+    while (io >> name >> value) {
+        if (name == "write_bytes:") {
+            *written = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+// range(0) is 1 if the rows are stored once. each iteration puts 10 rows of each key in 3 indexes keeping the
+// latest 5 rows and runs the gc. write_amp is the bytes written to the disk over the bytes of the rows put, and
+// disk_bytes_per_row is the size of the table after the gc over the rows left
+static void BM_DiskTableGc(benchmark::State& state) {  // NOLINT
+    constexpr int kIndexNum = 3;
+    auto meta = CreateMeta(3, kIndexNum, 5);
+    std::string table_path = absl::StrCat(kTablePath, "/gc_", state.range(0));
+    uint64_t put_bytes = 0;
+    uint64_t written_bytes = 0;
+    uint64_t disk_bytes = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::filesystem::remove_all(table_path);
+        FLAGS_disk_shared_row = state.range(0) != 0;
+        auto table = std::make_unique<DiskTable>(meta, table_path);
+        bool ok = table->Init();
+        FLAGS_disk_shared_row = false;
+        if (!ok) {
+            state.SkipWithError("init table failed");
+            return;
+        }
+        state.ResumeTiming();
+        uint64_t start_written = 0;
+        if (!GetWrittenBytes(&start_written)) {
+            state.SkipWithError("can not read the written bytes from /proc/self/io");
+            return;
+        }
+        for (uint64_t ts = 1; ts <= 10; ts++) {
+            for (int i = 0; i < kKeyNum; i++) {
+                std::string row = EncodeRow(meta, i, ts);
+                put_bytes += row.size();
+                table->Put(ts, row, GetDimensions(kIndexNum, i));
+            }
+        }
+        table->SchedGc();
+        // closing the table flushes the memtables
+        table.reset();
+        uint64_t end_written = 0;
+        GetWrittenBytes(&end_written);
+        written_bytes += end_written - start_written;
+        uint64_t size = 0;
+        ::openmldb::base::GetDirSizeRecur(table_path + "/data", size);
+        disk_bytes += size;
+    }
+    state.counters["write_amp"] = put_bytes == 0 ? 0 : static_cast<double>(written_bytes) / put_bytes;
+    state.counters["disk_bytes_per_row"] = static_cast<double>(disk_bytes) / (state.iterations() * kKeyNum * 5);
+    state.SetItemsProcessed(state.iterations() * kKeyNum * 10);
+    std::filesystem::remove_all(table_path);
+}
+
+BENCHMARK(BM_DiskTablePut)->ArgsProduct({{1, 3, 5}, {0, 1}})->Iterations(kRowNum);
+BENCHMARK(BM_DiskTableScan)->ArgsProduct({{1, 5}, {0, 1}});
+BENCHMARK(BM_DiskTableGc)->Arg(0)->Arg(1)->Iterations(3);
+
+}  // namespace storage
+}  // namespace openmldb
@@ -16,7 +16,9 @@
 
 #include "storage/disk_table_iterator.h"
 #include <snappy.h>
+#include <algorithm>
 #include <string>
+#include "base/glog_wrapper.h"
 #include "gflags/gflags.h"
 #include "storage/key_transform.h"
 
@@ -25,17 +27,91 @@ DECLARE_uint32(max_traverse_cnt);
 namespace openmldb {
 namespace storage {
 
+DiskRowReader::DiskRowReader(rocksdb::DB* db, const rocksdb::Snapshot* snapshot,
+                             rocksdb::ColumnFamilyHandle* index_handle, rocksdb::ColumnFamilyHandle* row_handle,
+                             bool same_prefix)
+    : db_(db),
+      ro_(),
+      index_handle_(index_handle),
+      row_handle_(row_handle),
+      same_prefix_(same_prefix),
+      batch_size_(1),
+      ahead_(),
+      keys_(),
+      row_ids_(),
+      rows_(),
+      statuses_(),
+      pos_(0) {
+    ro_.snapshot = snapshot;
+    ro_.prefix_same_as_start = same_prefix;
+    ro_.total_order_seek = !same_prefix;
+}
+
+bool DiskRowReader::Read(const rocksdb::Iterator* it, rocksdb::Slice* row) {
+    // the iterators go forward, so the entry is not before the last one read if it is in the batch
+    while (pos_ < keys_.size() && it->key() != rocksdb::Slice(keys_[pos_])) {
+        pos_++;
+    }
+    if (pos_ >= keys_.size()) {
+        Fill(it);
+    }
+    if (!statuses_[pos_].ok()) {
+        PDLOG(ERROR, "read row %lu failed. msg %s", DecodeRowId(row_ids_[pos_]), statuses_[pos_].ToString().c_str());
+        return false;
+    }
+    if (!ParseRowRecord(rows_[pos_], nullptr, row)) {
+        PDLOG(ERROR, "parse row %lu failed", DecodeRowId(row_ids_[pos_]));
+        return false;
+    }
+    return true;
+}
+
+void DiskRowReader::Fill(const rocksdb::Iterator* it) {
+    keys_.clear();
+    row_ids_.clear();
+    rocksdb::Slice key = it->key();
+    keys_.emplace_back(key.data(), key.size());
+    row_ids_.emplace_back(it->value().data(), it->value().size());
+    if (batch_size_ > 1) {
+        if (!ahead_) {
+            ahead_.reset(db_->NewIterator(ro_, index_handle_));
+        }
+        rocksdb::Slice prefix(key.data(), key.size() >= TS_LEN ? key.size() - TS_LEN : 0);
+        ahead_->Seek(key);
+        // the entry of it is in the batch already
+        if (ahead_->Valid()) {
+            ahead_->Next();
+        }
+        for (; ahead_->Valid() && keys_.size() < batch_size_; ahead_->Next()) {
+            rocksdb::Slice cur_key = ahead_->key();
+            if (same_prefix_ && (cur_key.size() != key.size() || !cur_key.starts_with(prefix))) {
+                break;
+            }
+            keys_.emplace_back(cur_key.data(), cur_key.size());
+            row_ids_.emplace_back(ahead_->value().data(), ahead_->value().size());
+        }
+    }
+    batch_size_ = std::min(batch_size_ * 2, kMaxRowBatch);
+    std::vector<rocksdb::Slice> row_ids(row_ids_.begin(), row_ids_.end());
+    rows_ = std::vector<rocksdb::PinnableSlice>(row_ids.size());
+    statuses_ = std::vector<rocksdb::Status>(row_ids.size());
+    db_->MultiGet(ro_, row_handle_, row_ids.size(), row_ids.data(), rows_.data(), statuses_.data());
+    pos_ = 0;
+}
+
 DiskTableIterator::DiskTableIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot,
-        const std::string& pk, type::CompressType compress_type)
-    : db_(db), it_(it), snapshot_(snapshot), pk_(pk), ts_(0), compress_type_(compress_type) {}
+        const std::string& pk, type::CompressType compress_type, DiskRowReader* row_reader)
+    : db_(db), it_(it), snapshot_(snapshot), pk_(pk), ts_(0), compress_type_(compress_type), row_reader_(row_reader) {}
 
 DiskTableIterator::DiskTableIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot,
-        const std::string& pk, uint32_t ts_idx, type::CompressType compress_type)
-    : db_(db), it_(it), snapshot_(snapshot), pk_(pk), ts_(0), ts_idx_(ts_idx), compress_type_(compress_type) {
+        const std::string& pk, uint32_t ts_idx, type::CompressType compress_type, DiskRowReader* row_reader)
+    : db_(db), it_(it), snapshot_(snapshot), pk_(pk), ts_(0), ts_idx_(ts_idx), compress_type_(compress_type),
+      row_reader_(row_reader) {
     has_ts_idx_ = true;
 }
 
 DiskTableIterator::~DiskTableIterator() {
+    delete row_reader_;
     delete it_;
     db_->ReleaseSnapshot(snapshot_);
 }
@@ -48,13 +124,21 @@ bool DiskTableIterator::Valid() {
     uint32_t cur_ts_idx = UINT32_MAX;
     ParseKeyAndTs(has_ts_idx_, it_->key(), &cur_pk, &ts_, &cur_ts_idx);
     int ret = cur_pk.compare(rocksdb::Slice(pk_));
-    return has_ts_idx_ ? ret == 0 && cur_ts_idx == ts_idx_ : ret == 0;
+    if (has_ts_idx_ ? ret != 0 || cur_ts_idx != ts_idx_ : ret != 0) {
+        return false;
+    }
+    // stop at a missing row rather than return an empty row
+    rocksdb::Slice row;
+    return row_reader_ == nullptr || row_reader_->Read(it_, &row);
 }
 
 void DiskTableIterator::Next() { return it_->Next(); }
 
 openmldb::base::Slice DiskTableIterator::GetValue() const {
     rocksdb::Slice value = it_->value();
+    if (row_reader_ != nullptr && !row_reader_->Read(it_, &value)) {
+        return openmldb::base::Slice();
+    }
     if (compress_type_ == type::CompressType::kSnappy) {
         tmp_buf_.clear();
         snappy::Uncompress(value.data(), value.size(), &tmp_buf_);
@@ -92,7 +176,7 @@ DiskTableTraverseIterator::DiskTableTraverseIterator(rocksdb::DB* db, rocksdb::I
                                                      const rocksdb::Snapshot* snapshot,
                                                      ::openmldb::storage::TTLType ttl_type, const uint64_t& expire_time,
                                                      const uint64_t& expire_cnt,
-                                                     type::CompressType compress_type)
+                                                     type::CompressType compress_type, DiskRowReader* row_reader)
     : db_(db),
       it_(it),
       snapshot_(snapshot),
@@ -101,13 +185,14 @@ DiskTableTraverseIterator::DiskTableTraverseIterator(rocksdb::DB* db, rocksdb::I
       has_ts_idx_(false),
       ts_idx_(0),
       traverse_cnt_(0),
-      compress_type_(compress_type) {}
+      compress_type_(compress_type),
+      row_reader_(row_reader) {}
 
 DiskTableTraverseIterator::DiskTableTraverseIterator(rocksdb::DB* db, rocksdb::Iterator* it,
                                                      const rocksdb::Snapshot* snapshot,
                                                      ::openmldb::storage::TTLType ttl_type, const uint64_t& expire_time,
                                                      const uint64_t& expire_cnt, int32_t ts_idx,
-                                                     type::CompressType compress_type)
+                                                     type::CompressType compress_type, DiskRowReader* row_reader)
     : db_(db),
       it_(it),
       snapshot_(snapshot),
@@ -116,9 +201,11 @@ DiskTableTraverseIterator::DiskTableTraverseIterator(rocksdb::DB* db, rocksdb::I
       has_ts_idx_(true),
       ts_idx_(ts_idx),
       traverse_cnt_(0),
-      compress_type_(compress_type) {}
+      compress_type_(compress_type),
+      row_reader_(row_reader) {}
 
 DiskTableTraverseIterator::~DiskTableTraverseIterator() {
+    delete row_reader_;
     delete it_;
     db_->ReleaseSnapshot(snapshot_);
 }
@@ -129,7 +216,12 @@ bool DiskTableTraverseIterator::Valid() {
     if (FLAGS_max_traverse_cnt > 0 && traverse_cnt_ >= FLAGS_max_traverse_cnt) {
         return false;
     }
-    return it_->Valid();
+    if (!it_->Valid()) {
+        return false;
+    }
+    // stop at a missing row rather than return an empty row
+    rocksdb::Slice row;
+    return row_reader_ == nullptr || row_reader_->Read(it_, &row);
 }
 
 void DiskTableTraverseIterator::Next() {
@@ -164,6 +256,9 @@ void DiskTableTraverseIterator::Next() {
 
 openmldb::base::Slice DiskTableTraverseIterator::GetValue() const {
     rocksdb::Slice value = it_->value();
+    if (row_reader_ != nullptr && !row_reader_->Read(it_, &value)) {
+        return openmldb::base::Slice();
+    }
     if (compress_type_ == type::CompressType::kSnappy) {
         tmp_buf_.clear();
         snappy::Uncompress(value.data(), value.size(), &tmp_buf_);
@@ -313,7 +408,7 @@ DiskTableKeyIterator::DiskTableKeyIterator(rocksdb::DB* db, rocksdb::Iterator* i
                                            const rocksdb::Snapshot* snapshot, ::openmldb::storage::TTLType ttl_type,
                                            const uint64_t& expire_time, const uint64_t& expire_cnt,
                                            rocksdb::ColumnFamilyHandle* column_handle,
-                                           type::CompressType compress_type)
+                                           type::CompressType compress_type, rocksdb::ColumnFamilyHandle* row_handle)
     : db_(db),
       it_(it),
       snapshot_(snapshot),
@@ -323,13 +418,14 @@ DiskTableKeyIterator::DiskTableKeyIterator(rocksdb::DB* db, rocksdb::Iterator* i
       has_ts_idx_(false),
       ts_idx_(0),
       column_handle_(column_handle),
-      compress_type_(compress_type) {}
+      compress_type_(compress_type),
+      row_handle_(row_handle) {}
 
 DiskTableKeyIterator::DiskTableKeyIterator(rocksdb::DB* db, rocksdb::Iterator* it,
                                            const rocksdb::Snapshot* snapshot, ::openmldb::storage::TTLType ttl_type,
                                            const uint64_t& expire_time, const uint64_t& expire_cnt, int32_t ts_idx,
                                            rocksdb::ColumnFamilyHandle* column_handle,
-                                           type::CompressType compress_type)
+                                           type::CompressType compress_type, rocksdb::ColumnFamilyHandle* row_handle)
     : db_(db),
       it_(it),
       snapshot_(snapshot),
@@ -339,7 +435,8 @@ DiskTableKeyIterator::DiskTableKeyIterator(rocksdb::DB* db, rocksdb::Iterator* i
       has_ts_idx_(true),
       ts_idx_(ts_idx),
       column_handle_(column_handle),
-      compress_type_(compress_type) {}
+      compress_type_(compress_type),
+      row_handle_(row_handle) {}
 
 DiskTableKeyIterator::~DiskTableKeyIterator() {
     delete it_;
@@ -416,8 +513,10 @@ std::unique_ptr<::hybridse::vm::RowIterator> DiskTableKeyIterator::GetValue() {
     // ro.prefix_same_as_start = true;
     ro.pin_data = true;
     rocksdb::Iterator* it = db_->NewIterator(ro, column_handle_);
+    auto row_reader = row_handle_ == nullptr ? nullptr
+                                             : new DiskRowReader(db_, snapshot, column_handle_, row_handle_, true);
     return std::make_unique<DiskTableRowIterator>(db_, it, snapshot, ttl_type_, expire_time_,
-            expire_cnt_, pk_, ts_, has_ts_idx_, ts_idx_, compress_type_);
+            expire_cnt_, pk_, ts_, has_ts_idx_, ts_idx_, compress_type_, row_reader);
 }
 
 ::hybridse::vm::RowIterator* DiskTableKeyIterator::GetRawValue() {
@@ -427,14 +526,17 @@ std::unique_ptr<::hybridse::vm::RowIterator> DiskTableKeyIterator::GetValue() {
     // ro.prefix_same_as_start = true;
     ro.pin_data = true;
     rocksdb::Iterator* it = db_->NewIterator(ro, column_handle_);
+    auto row_reader = row_handle_ == nullptr ? nullptr
+                                             : new DiskRowReader(db_, snapshot, column_handle_, row_handle_, true);
     return new DiskTableRowIterator(db_, it, snapshot, ttl_type_, expire_time_,
-            expire_cnt_, pk_, ts_, has_ts_idx_, ts_idx_, compress_type_);
+            expire_cnt_, pk_, ts_, has_ts_idx_, ts_idx_, compress_type_, row_reader);
 }
 
 DiskTableRowIterator::DiskTableRowIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot,
                                            ::openmldb::storage::TTLType ttl_type, uint64_t expire_time,
                                            uint64_t expire_cnt, std::string pk, uint64_t ts, bool has_ts_idx,
-                                           uint32_t ts_idx, type::CompressType compress_type)
+                                           uint32_t ts_idx, type::CompressType compress_type,
+                                           DiskRowReader* row_reader)
     : db_(db),
       it_(it),
       snapshot_(snapshot),
@@ -446,9 +548,11 @@ DiskTableRowIterator::DiskTableRowIterator(rocksdb::DB* db, rocksdb::Iterator* i
       has_ts_idx_(has_ts_idx),
       ts_idx_(ts_idx),
       row_(),
-      compress_type_(compress_type) {}
+      compress_type_(compress_type),
+      row_reader_(row_reader) {}
 
 DiskTableRowIterator::~DiskTableRowIterator() {
+    delete row_reader_;
     delete it_;
     db_->ReleaseSnapshot(snapshot_);
 }
@@ -458,7 +562,9 @@ bool DiskTableRowIterator::Valid() const {
     if (!it_->Valid() || expire_value_.IsExpired(ts_, record_idx_)) {
         return false;
     }
-    return true;
+    // stop at a missing row rather than return an empty row
+    rocksdb::Slice row;
+    return row_reader_ == nullptr || row_reader_->Read(it_, &row);
 }
 
 void DiskTableRowIterator::Next() {
@@ -488,17 +594,22 @@ const ::hybridse::codec::Row& DiskTableRowIterator::GetValue() {
     if (ValidValue()) {
         return row_;
     }
+    rocksdb::Slice value = it_->value();
+    if (row_reader_ != nullptr && !row_reader_->Read(it_, &value)) {
+        row_.Reset(nullptr, 0);
+        return row_;
+    }
     valid_value_ = true;
-    size_t size = it_->value().size();
+    size_t size = value.size();
     if (compress_type_ == type::CompressType::kSnappy) {
         tmp_buf_.clear();
-        snappy::Uncompress(it_->value().data(), size, &tmp_buf_);
+        snappy::Uncompress(value.data(), size, &tmp_buf_);
         int8_t* copyed_row_data = reinterpret_cast<int8_t*>(malloc(tmp_buf_.size()));
         memcpy(copyed_row_data, tmp_buf_.data(), tmp_buf_.size());
         row_.Reset(::hybridse::base::RefCountedSlice::CreateManaged(copyed_row_data, tmp_buf_.size()));
     } else {
         int8_t* copyed_row_data = reinterpret_cast<int8_t*>(malloc(size));
-        memcpy(copyed_row_data, it_->value().data(), size);
+        memcpy(copyed_row_data, value.data(), size);
         row_.Reset(::hybridse::base::RefCountedSlice::CreateManaged(copyed_row_data, size));
     }
     return row_;
@@ -18,6 +18,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include "rocksdb/db.h"
 #include "rocksdb/options.h"
 #include "storage/iterator.h"
@@ -27,12 +28,50 @@
 namespace openmldb {
 namespace storage {
 
+// reads the rows of the index entries of a table storing the rows once in the row column family, the entries hold
+// the row ids. the rows of the entries after the one read are read with it by a MultiGet, the batch doubles up to
+// kMaxRowBatch as the iterator goes on, so a point lookup reads one row. an iterator owns its reader, which is
+// nullptr if the rows are in the index entries
+class DiskRowReader {
+ public:
+    // same_prefix limits a batch to the entries of the same pk and ts idx
+    DiskRowReader(rocksdb::DB* db, const rocksdb::Snapshot* snapshot, rocksdb::ColumnFamilyHandle* index_handle,
+                  rocksdb::ColumnFamilyHandle* row_handle, bool same_prefix);
+    DiskRowReader(const DiskRowReader&) = delete;
+    DiskRowReader& operator=(const DiskRowReader&) = delete;
+
+    // read the row of the entry it points to, it is valid until the next read. a row is deleted only after no
+    // entry holds it and kept for the snapshots before, so a missing row is an error, which is logged and false
+    // is returned
+    bool Read(const rocksdb::Iterator* it, rocksdb::Slice* row);
+
+ private:
+    static constexpr uint32_t kMaxRowBatch = 64;
+
+    void Fill(const rocksdb::Iterator* it);
+
+    rocksdb::DB* db_;
+    rocksdb::ReadOptions ro_;
+    rocksdb::ColumnFamilyHandle* index_handle_;
+    rocksdb::ColumnFamilyHandle* row_handle_;
+    bool same_prefix_;
+    uint32_t batch_size_;
+    // seeks the entries after the one read, created by the first batch of more than one row
+    std::unique_ptr<rocksdb::Iterator> ahead_;
+    std::vector<std::string> keys_;
+    std::vector<std::string> row_ids_;
+    std::vector<rocksdb::PinnableSlice> rows_;
+    std::vector<rocksdb::Status> statuses_;
+    uint32_t pos_;
+};
+
 class DiskTableIterator : public TableIterator {
  public:
     DiskTableIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot,
-            const std::string& pk, type::CompressType compress_type);
+            const std::string& pk, type::CompressType compress_type, DiskRowReader* row_reader = nullptr);
     DiskTableIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot,
-            const std::string& pk, uint32_t ts_idx, type::CompressType compress_type);
+            const std::string& pk, uint32_t ts_idx, type::CompressType compress_type,
+            DiskRowReader* row_reader = nullptr);
     virtual ~DiskTableIterator();
     bool Valid() override;
     void Next() override;
@@ -51,6 +90,7 @@ class DiskTableIterator : public TableIterator {
     uint32_t ts_idx_;
     bool has_ts_idx_ = false;
     type::CompressType compress_type_;
+    DiskRowReader* row_reader_;
     mutable std::string tmp_buf_;
 };
 
@@ -58,10 +98,12 @@ class DiskTableTraverseIterator : public TraverseIterator {
  public:
     DiskTableTraverseIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot,
                               ::openmldb::storage::TTLType ttl_type, const uint64_t& expire_time,
-                              const uint64_t& expire_cnt, type::CompressType compress_type);
+                              const uint64_t& expire_cnt, type::CompressType compress_type,
+                              DiskRowReader* row_reader = nullptr);
     DiskTableTraverseIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot,
                               ::openmldb::storage::TTLType ttl_type, const uint64_t& expire_time,
-                              const uint64_t& expire_cnt, int32_t ts_idx, type::CompressType compress_type);
+                              const uint64_t& expire_cnt, int32_t ts_idx, type::CompressType compress_type,
+                              DiskRowReader* row_reader = nullptr);
     virtual ~DiskTableTraverseIterator();
     bool Valid() override;
     void Next() override;
@@ -88,6 +130,7 @@ class DiskTableTraverseIterator : public TraverseIterator {
     uint32_t ts_idx_;
     uint64_t traverse_cnt_;
     type::CompressType compress_type_;
+    DiskRowReader* row_reader_;
     mutable std::string tmp_buf_;
 };
 
@@ -96,7 +139,7 @@ class DiskTableRowIterator : public ::hybridse::vm::RowIterator {
     DiskTableRowIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot,
                          ::openmldb::storage::TTLType ttl_type, uint64_t expire_time, uint64_t expire_cnt,
                          std::string pk, uint64_t ts, bool has_ts_idx, uint32_t ts_idx,
-                         type::CompressType compress_type);
+                         type::CompressType compress_type, DiskRowReader* row_reader = nullptr);
 
     ~DiskTableRowIterator();
 
@@ -136,6 +179,7 @@ class DiskTableRowIterator : public ::hybridse::vm::RowIterator {
     bool pk_valid_;
     bool valid_value_ = false;
     type::CompressType compress_type_;
+    DiskRowReader* row_reader_;
     std::string tmp_buf_;
 };
 
@@ -144,12 +188,12 @@ class DiskTableKeyIterator : public ::hybridse::vm::WindowIterator {
     DiskTableKeyIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot,
                          ::openmldb::storage::TTLType ttl_type, const uint64_t& expire_time, const uint64_t& expire_cnt,
                          int32_t ts_idx, rocksdb::ColumnFamilyHandle* column_handle,
-                         type::CompressType compress_type);
+                         type::CompressType compress_type, rocksdb::ColumnFamilyHandle* row_handle = nullptr);
 
     DiskTableKeyIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot,
                          ::openmldb::storage::TTLType ttl_type, const uint64_t& expire_time, const uint64_t& expire_cnt,
                          rocksdb::ColumnFamilyHandle* column_handle,
-                         type::CompressType compress_type);
+                         type::CompressType compress_type, rocksdb::ColumnFamilyHandle* row_handle = nullptr);
 
     ~DiskTableKeyIterator() override;
 
@@ -182,6 +226,8 @@ class DiskTableKeyIterator : public ::hybridse::vm::WindowIterator {
     uint32_t ts_idx_;
     rocksdb::ColumnFamilyHandle* column_handle_;
     type::CompressType compress_type_;
+    // the row column family, nullptr if the rows are in the index
+    rocksdb::ColumnFamilyHandle* row_handle_;
 };
 
 }  // namespace storage
@@ -18,6 +18,7 @@
 #include <filesystem>
 #include <iostream>
 #include <utility>
+#include "absl/cleanup/cleanup.h"
 #include "base/file_util.h"
 #include "base/glog_wrapper.h"
 #include "base/random.h"
@@ -35,6 +36,8 @@ DECLARE_string(ssd_root_path);
 DECLARE_string(hdd_root_path);
 DECLARE_uint32(max_traverse_cnt);
 DECLARE_int32(gc_safe_offset);
+DECLARE_bool(disk_gc_by_compaction);
+DECLARE_bool(disk_shared_row);
 
 namespace openmldb {
 namespace storage {
@@ -1266,6 +1269,258 @@ TEST_F(DiskTableTest, GcLatest) {
     RemoveData(table_path);
 }
 
+TEST_F(DiskTableTest, TsStat) {
+    uint64_t cur_time = 100 * 60 * 1000;
+    TsStat stat;
+    // 10 keys with 10 rows of one minute apart
+    for (int idx = 0; idx < 10; idx++) {
+        for (int i = 0; i < 10; i++) {
+            stat.Add(cur_time - i * 60 * 1000, i == 0);
+        }
+    }
+    ASSERT_EQ(100u, stat.GetRowCnt());
+    // the rows are counted in the buckets of one minute
+    uint64_t abs_ttl = 6 * 60 * 1000 + 1;
+    ASSERT_DOUBLE_EQ(0.3, stat.FractionNotAfter(cur_time - abs_ttl));
+    ASSERT_DOUBLE_EQ(1.0, stat.FractionNotAfter(cur_time + 60 * 1000 - 1));
+    ASSERT_DOUBLE_EQ(0.8, stat.FractionBeyond(2));
+    ASSERT_DOUBLE_EQ(0.0, stat.FractionBeyond(10));
+    ASSERT_DOUBLE_EQ(0.3, stat.ExpiredFraction(TTLSt(abs_ttl, 0, TTLType::kAbsoluteTime), cur_time));
+    ASSERT_DOUBLE_EQ(0.0, stat.ExpiredFraction(TTLSt(0, 10, TTLType::kLatestTime), cur_time));
+    ASSERT_DOUBLE_EQ(0.3, stat.ExpiredFraction(TTLSt(abs_ttl, 2, TTLType::kAbsAndLat), cur_time));
+    ASSERT_DOUBLE_EQ(0.8, stat.ExpiredFraction(TTLSt(abs_ttl, 2, TTLType::kAbsOrLat), cur_time));
+
+    TsStat decoded;
+    ASSERT_TRUE(decoded.Decode(stat.Encode()));
+    ASSERT_EQ(stat.Encode(), decoded.Encode());
+    ASSERT_FALSE(decoded.Decode("1 2"));
+
+    // the buckets are merged when the rows spread over a long time
+    TsStat wide;
+    for (uint64_t i = 0; i < 1000; i++) {
+        wide.Add(i * 60 * 1000, true);
+    }
+    ASSERT_LT(wide.Encode().size(), 1024u);
+    ASSERT_NEAR(0.5, wide.FractionNotAfter(500 * 60 * 1000), 0.05);
+}
+
+TEST_F(DiskTableTest, GcByCompaction) {
+    FLAGS_disk_gc_by_compaction = true;
+    absl::Cleanup reset_flag = [] { FLAGS_disk_gc_by_compaction = false; };
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_tid(14);
+    table_meta.set_pid(1);
+    table_meta.set_storage_mode(::openmldb::common::kHDD);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "mcc", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts1", ::openmldb::type::kBigInt);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts2", ::openmldb::type::kBigInt);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card", "card", "ts1", ::openmldb::type::kAbsoluteTime, 3, 0);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card1", "card", "ts2", ::openmldb::type::kLatestTime, 0, 2);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "mcc", "mcc", "ts2", ::openmldb::type::kAbsOrLat, 5, 3);
+
+    std::string table_path = FLAGS_hdd_root_path + "/14_1";
+    auto table = std::make_unique<DiskTable>(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+
+    codec::SDKCodec codec(table_meta);
+    uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
+    for (int idx = 0; idx < 100; idx++) {
+        Dimensions dims;
+        ::openmldb::api::Dimension* dim = dims.Add();
+        dim->set_key("card" + std::to_string(idx));
+        dim->set_idx(0);
+        ::openmldb::api::Dimension* dim1 = dims.Add();
+        dim1->set_key("card" + std::to_string(idx));
+        dim1->set_idx(1);
+        ::openmldb::api::Dimension* dim2 = dims.Add();
+        dim2->set_key("mcc" + std::to_string(idx));
+        dim2->set_idx(2);
+        for (int i = 0; i < 10; i++) {
+            uint64_t ts = cur_time - i * 60 * 1000;
+            std::vector<std::string> row = {"value" + std::to_string(i), "value" + std::to_string(i),
+                                            std::to_string(ts), std::to_string(ts)};
+            std::string value;
+            ASSERT_EQ(0, codec.EncodeRow(row, &value));
+            ASSERT_TRUE(table->Put(ts, value, dims).ok());
+        }
+    }
+    table->SchedGc();
+    for (int idx = 0; idx < 100; idx++) {
+        std::string key = "card" + std::to_string(idx);
+        std::string key1 = "mcc" + std::to_string(idx);
+        for (int i = 0; i < 10; i++) {
+            uint64_t ts = cur_time - i * 60 * 1000;
+            std::vector<std::string> row = {"value" + std::to_string(i), "value" + std::to_string(i),
+                                            std::to_string(ts), std::to_string(ts)};
+            std::string e_value;
+            ASSERT_EQ(0, codec.EncodeRow(row, &e_value));
+            std::string value;
+            // the rows of 3 minutes in card, the latest 2 rows in card1, the latest 3 rows in 5 minutes in mcc
+            if (i < 3) {
+                ASSERT_TRUE(table->Get(0, key, ts, value));
+                ASSERT_EQ(e_value, value);
+                ASSERT_TRUE(table->Get(2, key1, ts, value));
+                ASSERT_EQ(e_value, value);
+            } else {
+                ASSERT_FALSE(table->Get(0, key, ts, value));
+                ASSERT_FALSE(table->Get(2, key1, ts, value));
+            }
+            if (i < 2) {
+                ASSERT_TRUE(table->Get(1, key, ts, value));
+                ASSERT_EQ(e_value, value);
+            } else {
+                ASSERT_FALSE(table->Get(1, key, ts, value));
+            }
+        }
+    }
+    // a row deleted by range does not count in the latest ttl, the older row is kept
+    ::openmldb::api::LogEntry entry;
+    entry.set_ts(cur_time);
+    entry.set_end_ts(cur_time - 1);
+    auto dim = entry.add_dimensions();
+    dim->set_key("card0");
+    dim->set_idx(1);
+    ASSERT_TRUE(table->Delete(entry));
+    table->SchedGc();
+    std::string value;
+    ASSERT_FALSE(table->Get(1, "card0", cur_time, value));
+    ASSERT_TRUE(table->Get(1, "card0", cur_time - 60 * 1000, value));
+    RemoveData(table_path);
+}
+
+TEST_F(DiskTableTest, SharedRow) {
+    FLAGS_disk_shared_row = true;
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_tid(16);
+    table_meta.set_pid(1);
+    table_meta.set_storage_mode(::openmldb::common::kHDD);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "mcc", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts1", ::openmldb::type::kBigInt);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts2", ::openmldb::type::kBigInt);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card", "card", "ts1", ::openmldb::type::kAbsoluteTime, 0, 0);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card1", "card", "ts2", ::openmldb::type::kAbsoluteTime, 0, 0);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "mcc", "mcc", "ts2", ::openmldb::type::kAbsoluteTime, 0, 0);
+
+    std::string table_path = FLAGS_hdd_root_path + "/16_1";
+    auto table = std::make_unique<DiskTable>(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+
+    codec::SDKCodec codec(table_meta);
+    auto encode = [&codec](int idx, uint64_t ts) {
+        std::vector<std::string> row = {"card" + std::to_string(idx), "mcc" + std::to_string(idx),
+                                        std::to_string(ts), std::to_string(ts)};
+        std::string value;
+        codec.EncodeRow(row, &value);
+        return value;
+    };
+    auto put = [&table, &encode](int idx, uint64_t ts) {
+        Dimensions dims;
+        ::openmldb::api::Dimension* dim = dims.Add();
+        dim->set_key("card" + std::to_string(idx));
+        dim->set_idx(0);
+        ::openmldb::api::Dimension* dim1 = dims.Add();
+        dim1->set_key("card" + std::to_string(idx));
+        dim1->set_idx(1);
+        ::openmldb::api::Dimension* dim2 = dims.Add();
+        dim2->set_key("mcc" + std::to_string(idx));
+        dim2->set_idx(2);
+        return table->Put(ts, encode(idx, ts), dims).ok();
+    };
+    for (int idx = 0; idx < 100; idx++) {
+        for (int i = 0; i < 10; i++) {
+            ASSERT_TRUE(put(idx, 1000 + i));
+        }
+    }
+    // put again with the same keys and ts, the entries hold the new row ids
+    ASSERT_TRUE(put(5, 1005));
+    auto check = [&table, &encode]() {
+        for (int idx = 0; idx < 100; idx++) {
+            std::string key = "card" + std::to_string(idx);
+            std::string key1 = "mcc" + std::to_string(idx);
+            for (int i = 0; i < 10; i++) {
+                std::string value;
+                ASSERT_TRUE(table->Get(0, key, 1000 + i, value));
+                ASSERT_EQ(encode(idx, 1000 + i), value);
+                ASSERT_TRUE(table->Get(1, key, 1000 + i, value));
+                ASSERT_EQ(encode(idx, 1000 + i), value);
+                ASSERT_TRUE(table->Get(2, key1, 1000 + i, value));
+                ASSERT_EQ(encode(idx, 1000 + i), value);
+            }
+        }
+        Ticket ticket;
+        std::unique_ptr<TableIterator> it(table->NewIterator(1, "card7", ticket));
+        it->SeekToFirst();
+        int count = 0;
+        while (it->Valid()) {
+            ASSERT_EQ(1009u - count, it->GetKey());
+            ASSERT_EQ(encode(7, it->GetKey()), it->GetValue().ToString());
+            count++;
+            it->Next();
+        }
+        ASSERT_EQ(10, count);
+        std::unique_ptr<TraverseIterator> traverse_it(table->NewTraverseIterator(2));
+        traverse_it->SeekToFirst();
+        count = 0;
+        while (traverse_it->Valid()) {
+            int idx = std::stoi(traverse_it->GetPK().substr(3));
+            ASSERT_EQ(encode(idx, traverse_it->GetKey()), traverse_it->GetValue().ToString());
+            count++;
+            traverse_it->Next();
+        }
+        ASSERT_EQ(1000, count);
+        std::unique_ptr<::hybridse::vm::WindowIterator> window_it(table->NewWindowIterator(0));
+        window_it->Seek("card9");
+        ASSERT_TRUE(window_it->Valid());
+        std::unique_ptr<::hybridse::vm::RowIterator> row_it = window_it->GetValue();
+        row_it->SeekToFirst();
+        count = 0;
+        while (row_it->Valid()) {
+            const auto& row = row_it->GetValue();
+            ASSERT_EQ(encode(9, row_it->GetKey()), std::string(reinterpret_cast<const char*>(row.buf()), row.size()));
+            count++;
+            row_it->Next();
+        }
+        ASSERT_EQ(10, count);
+    };
+    check();
+    table->SchedGc();
+    check();
+
+    // the table keeps its layout after it is opened again
+    FLAGS_disk_shared_row = false;
+    table = std::make_unique<DiskTable>(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    check();
+    ASSERT_TRUE(put(3, 2000));
+    std::string value;
+    ASSERT_TRUE(table->Get(2, "mcc3", 2000, value));
+    ASSERT_EQ(encode(3, 2000), value);
+
+    // the gc deletes the row after its entries are deleted, an iterator created before still reads it
+    Ticket ticket;
+    std::unique_ptr<TableIterator> it(table->NewIterator(2, "mcc3", ticket));
+    ::openmldb::api::LogEntry entry;
+    entry.set_ts(2000);
+    entry.set_end_ts(1999);
+    for (int idx = 0; idx < 3; idx++) {
+        auto dim = entry.add_dimensions();
+        dim->set_key(idx == 2 ? "mcc3" : "card3");
+        dim->set_idx(idx);
+    }
+    ASSERT_TRUE(table->Delete(entry));
+    ASSERT_FALSE(table->Get(2, "mcc3", 2000, value));
+    table->SchedGc();
+    it->SeekToFirst();
+    ASSERT_TRUE(it->Valid());
+    ASSERT_EQ(2000u, it->GetKey());
+    ASSERT_EQ(encode(3, 2000), it->GetValue().ToString());
+    it.reset();
+    check();
+    RemoveData(table_path);
+}
+
 TEST_F(DiskTableTest, CheckPoint) {
     std::map<std::string, uint32_t> mapping;
     mapping.insert(std::make_pair("idx0", 0));
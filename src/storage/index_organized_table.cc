@@ -37,8 +37,8 @@ IOTIterator* NewNullIterator() {
 IOTIterator* NewIOTIterator(Segment* segment, const Slice& key, Ticket& ticket, type::CompressType compress_type,
                             std::unique_ptr<hybridse::codec::WindowIterator> cidx_iter) {
     void* entry = nullptr;
-    auto entries = segment->GetKeyEntries();
-    if (entries == nullptr || segment->GetTsCnt() > 1 || entries->Get(key, entry) < 0 || entry == nullptr) {
+    if (segment->GetKeyEntries() == nullptr || segment->GetTsCnt() > 1 || segment->GetKeyEntry(key, entry) < 0 ||
+        entry == nullptr) {
         return NewNullIterator();
     }
     ticket.Push(reinterpret_cast<KeyEntry*>(entry));
@@ -55,12 +55,11 @@ IOTIterator* NewIOTIterator(Segment* segment, const Slice& key, uint32_t idx, Ti
         LOG(WARNING) << "can't find idx in segment";
         return NewNullIterator();
     }
-    auto entries = segment->GetKeyEntries();
     if (segment->GetTsCnt() == 1) {
         return NewIOTIterator(segment, key, ticket, compress_type, std::move(cidx_iter));
     }
     void* entry_arr = nullptr;
-    if (entries->Get(key, entry_arr) < 0 || entry_arr == nullptr) {
+    if (segment->GetKeyEntry(key, entry_arr) < 0 || entry_arr == nullptr) {
         return NewNullIterator();
     }
     auto entry = reinterpret_cast<KeyEntry**>(entry_arr)[pos->second];
@@ -600,6 +599,7 @@ void IndexOrganizedTable::SchedGCByDelete(const std::shared_ptr<sdk::SQLRouter>&
             segment->GcFreeList(&statistics_info);
             // don't gc in cidx, it's not a good way to impl, refactor later
             segment->ExecuteGc(ttl_st_map, &statistics_info, segment->ClusteredTs());
+            segment->RebuildKeyFilter();
             gc_idx_cnt += statistics_info.GetTotalCnt();
             gc_record_byte_size += statistics_info.record_byte_size;
             seg_gc_time = ::baidu::common::timer::get_micros() / 1000 - seg_gc_time;
@@ -42,6 +42,12 @@ class IndexOrganizedTable : public MemTable {
     absl::Status Put(uint64_t time, const std::string& value, const Dimensions& dimensions,
                      bool put_if_absent) override;
 
+    // the clustered index checks existing rows on put, so the rows are put one by one
+    void PutBatch(const std::vector<::openmldb::api::LogEntry>& entries, bool put_if_absent,
+                  std::vector<absl::Status>* status) override {
+        Table::PutBatch(entries, put_if_absent, status);
+    }
+
     absl::Status CheckDataExists(uint64_t tsv, const Dimensions& dimensions);
 
     // TODO(hw): iot bulk load unsupported
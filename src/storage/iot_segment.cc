@@ -59,15 +59,15 @@ bool IOTSegment::PutUnlock(const Slice& key, uint64_t time, DataBlock* row, bool
     void* entry = nullptr;
     uint32_t byte_size = 0;
     // one key just one entry
-    int ret = entries_->Get(key, entry);
+    int ret = GetKeyEntry(key, entry);
     if (ret < 0 || entry == nullptr) {
         char* pk = new char[key.size()];
         memcpy(pk, key.data(), key.size());
         // need to delete memory when free node
         Slice skey(pk, key.size());
         entry = reinterpret_cast<void*>(new KeyEntry(key_entry_max_height_));
-        uint8_t height = entries_->Insert(skey, entry);
-        byte_size += GetRecordPkIdxSize(height, key.size(), key_entry_max_height_);
+        uint8_t height = InsertKeyEntryUnlock(skey, entry);
+        byte_size += GetRecordPkIdxSize(height, key.size());
         pk_cnt_.fetch_add(1, std::memory_order_relaxed);
         // no need to check if absent when first put
     } else if (IsClusteredTs(ts_idx_map_.begin()->first)) {
@@ -88,9 +88,9 @@ bool IOTSegment::PutUnlock(const Slice& key, uint64_t time, DataBlock* row, bool
     }
 
     idx_cnt_vec_[0]->fetch_add(1, std::memory_order_relaxed);
-    uint8_t height = reinterpret_cast<KeyEntry*>(entry)->entries.Insert(time, row);
-    reinterpret_cast<KeyEntry*>(entry)->count_.fetch_add(1, std::memory_order_relaxed);
-    byte_size += GetRecordTsIdxSize(height);
+    byte_size += InsertEntry(0, reinterpret_cast<KeyEntry*>(entry), time, row);
+    UpdateOldestPutTime(time);
+    reinterpret_cast<KeyEntry*>(entry)->CountPut();
     idx_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
     DLOG(INFO) << "idx_byte_size_ " << idx_byte_size_ << " after add " << byte_size;
     return true;
@@ -112,7 +112,8 @@ bool IOTSegment::Put(const Slice& key, const std::map<int32_t, uint64_t>& ts_map
         return ret;
     }
     void* entry_arr = nullptr;
-    std::lock_guard<std::mutex> lock(mu_);
+    ReserveKeyIndex(1);
+    std::lock_guard<std::shared_mutex> lock(mu_);
     for (const auto& kv : ts_map) {
         uint32_t byte_size = 0;
         auto pos = ts_idx_map_.find(kv.first);
@@ -120,7 +121,7 @@ bool IOTSegment::Put(const Slice& key, const std::map<int32_t, uint64_t>& ts_map
             continue;
         }
         if (entry_arr == nullptr) {
-            int ret = entries_->Get(key, entry_arr);
+            int ret = GetKeyEntry(key, entry_arr);
             if (ret < 0 || entry_arr == nullptr) {
                 char* pk = new char[key.size()];
                 memcpy(pk, key.data(), key.size());
@@ -130,8 +131,8 @@ bool IOTSegment::Put(const Slice& key, const std::map<int32_t, uint64_t>& ts_map
                     entry_arr_tmp[i] = new KeyEntry(key_entry_max_height_);
                 }
                 entry_arr = reinterpret_cast<void*>(entry_arr_tmp);
-                uint8_t height = entries_->Insert(skey, entry_arr);
-                byte_size += GetRecordPkMultiIdxSize(height, key.size(), key_entry_max_height_, ts_cnt_);
+                uint8_t height = InsertKeyEntryUnlock(skey, entry_arr);
+                byte_size += GetRecordPkMultiIdxSize(height, key.size(), ts_cnt_);
                 pk_cnt_.fetch_add(1, std::memory_order_relaxed);
             }
         }
@@ -157,9 +158,8 @@ bool IOTSegment::Put(const Slice& key, const std::map<int32_t, uint64_t>& ts_map
                 }
             }
         }
-        uint8_t height = entry->entries.Insert(kv.second, pblock);
-        entry->count_.fetch_add(1, std::memory_order_relaxed);
-        byte_size += GetRecordTsIdxSize(height);
+        byte_size += InsertEntry(pos->second, entry, kv.second, pblock);
+        entry->CountPut();
         idx_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
         DLOG(INFO) << "idx_byte_size_ " << idx_byte_size_ << " after add " << byte_size;
         idx_cnt_vec_[pos->second]->fetch_add(1, std::memory_order_relaxed);
@@ -170,8 +170,8 @@ bool IOTSegment::Put(const Slice& key, const std::map<int32_t, uint64_t>& ts_map
 absl::Status IOTSegment::CheckKeyExists(const Slice& key, const std::map<int32_t, uint64_t>& ts_map) {
     // check lock
     void* entry_arr = nullptr;
-    std::lock_guard<std::mutex> lock(mu_);  // need shrink?
-    int ret = entries_->Get(key, entry_arr);
+    std::lock_guard<std::shared_mutex> lock(mu_);  // need shrink?
+    int ret = GetKeyEntry(key, entry_arr);
     if (ret < 0 || entry_arr == nullptr) {
         return absl::NotFoundError("key not found");
     }
@@ -270,6 +270,8 @@ class IOTSegment : public Segment {
     ~IOTSegment() override {}
 
     bool PutUnlock(const Slice& key, uint64_t time, DataBlock* row, bool put_if_absent, bool check_all_time);
+    // the clustered index checks existing rows before insert, so puts are serialized
+    bool SupportConcurrentPut() const override { return false; }
     bool Put(const Slice& key, const std::map<int32_t, uint64_t>& ts_map, DataBlock* cblock, DataBlock* sblock,
              bool put_if_absent = false);
     // use ts map to get idx in entry_arr
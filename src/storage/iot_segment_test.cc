@@ -222,8 +222,8 @@ TEST_F(IOTSegmentTest, TestGc4TTL) {
         ASSERT_TRUE(CheckStatisticsInfo({1}, 0, GetRecordSize(5), statistics_info));
         segment->IncrGcVersion();  // delta default is 2, version should >=2, and node_cache free version should >= 3
         segment->GcFreeList(&statistics_info);
-        // don't know why 197
-        ASSERT_TRUE(CheckStatisticsInfo({1}, 197, GetRecordSize(5), statistics_info));
+        // the pk idx size of the removed key, the row is kept in an array so no skiplist head is counted
+        ASSERT_TRUE(CheckStatisticsInfo({1}, 93, GetRecordSize(5), statistics_info));
     }
 }
 
@@ -14,38 +14,485 @@
  * limitations under the License.
  */
 
-#include "base/glog_wrapper.h"
 #include "storage/key_entry.h"
+
+#include <algorithm>
+#include <mutex>  // NOLINT
+#include <shared_mutex>  // NOLINT
+
+#include "absl/container/inlined_vector.h"
+#include "base/glog_wrapper.h"
+#include "gflags/gflags.h"
 #include "storage/record.h"
 
+DECLARE_uint32(time_index_array_max_size);
+
 namespace openmldb {
 namespace storage {
 
-void KeyEntry::Release(uint32_t idx, StatisticsInfo* statistics_info) {
-    if (entries.IsEmpty()) {
+TimeArray* TimeArray::New(uint32_t capacity, base::SlabAllocator* allocator) {
+    void* mem = allocator == nullptr ? new char[AllocSize(capacity)] : allocator->Allocate(AllocSize(capacity));
+    return new (mem) TimeArray(capacity);
+}
+
+void TimeArray::Delete(TimeArray* array, base::SlabAllocator* allocator) {
+    if (array == nullptr) {
         return;
     }
-    std::unique_ptr<TimeEntries::Iterator> it(entries.NewIterator());
-    it->SeekToFirst();
-    if (!it->Valid()) {
-        return;
+    uint32_t size = AllocSize(array->capacity_);
+    array->~TimeArray();
+    if (allocator == nullptr) {
+        delete[] reinterpret_cast<char*>(array);
+    } else {
+        allocator->Free(array, size);
     }
-    uint64_t ts = it->GetKey();
-    base::Node<uint64_t, DataBlock*>* node = entries.Split(ts);
-    while (node) {
-        if (node->GetValue()->dim_cnt_down > 1) {
-            node->GetValue()->dim_cnt_down--;
+}
+
+uint32_t TimeArray::UpperBound(uint64_t ts, uint32_t size) const {
+    const TimeSlot* slots = Slots();
+    uint32_t low = 0;
+    uint32_t high = size;
+    while (low < high) {
+        uint32_t mid = (low + high) / 2;
+        if (slots[mid].ts <= ts) {
+            low = mid + 1;
         } else {
-            VLOG(1) << "delete data block for key " << node->GetKey();
-            statistics_info->record_byte_size += GetRecordSize(node->GetValue()->size);
-            delete node->GetValue();
+            high = mid;
+        }
+    }
+    return low;
+}
+
+void TimeArray::Append(uint64_t ts, DataBlock* row) {
+    uint32_t size = size_.load(std::memory_order_relaxed);
+    Slots()[size] = {ts, row};
+    size_.store(size + 1, std::memory_order_release);
+}
+
+TimeArray* TimeArray::Copy(uint32_t start, uint32_t end, uint32_t capacity, base::SlabAllocator* allocator) const {
+    TimeArray* array = New(capacity, allocator);
+    memcpy(array->Slots(), Slots() + start, (end - start) * sizeof(TimeSlot));
+    array->size_.store(end - start, std::memory_order_relaxed);
+    return array;
+}
+
+TimeArray* TimeArray::CopyInsert(uint64_t ts, DataBlock* row, uint32_t capacity,
+                                 base::SlabAllocator* allocator) const {
+    uint32_t size = GetSize();
+    uint32_t pos = UpperBound(ts, size);
+    TimeArray* array = New(capacity, allocator);
+    TimeSlot* slots = array->Slots();
+    memcpy(slots, Slots(), pos * sizeof(TimeSlot));
+    slots[pos] = {ts, row};
+    memcpy(slots + pos + 1, Slots() + pos, (size - pos) * sizeof(TimeSlot));
+    array->size_.store(size + 1, std::memory_order_relaxed);
+    return array;
+}
+
+TimeArray* TimeArray::CopyErase(uint32_t pos, base::SlabAllocator* allocator) const {
+    uint32_t size = GetSize();
+    TimeArray* array = New(capacity_, allocator);
+    TimeSlot* slots = array->Slots();
+    memcpy(slots, Slots(), pos * sizeof(TimeSlot));
+    memcpy(slots + pos, Slots() + pos + 1, (size - pos - 1) * sizeof(TimeSlot));
+    array->size_.store(size - 1, std::memory_order_relaxed);
+    return array;
+}
+
+RemovedRows RemovedRows::TakeRetired() {
+    RemovedRows retired;
+    retired.retired_array = retired_array;
+    retired.retired_list = retired_list;
+    retired_array = nullptr;
+    retired_list = nullptr;
+    return retired;
+}
+
+uint64_t RemovedRows::Free(uint32_t idx, StatisticsInfo* statistics_info, base::SlabAllocator* allocator) {
+    uint64_t byte_size = 0;
+    auto free_row = [idx, statistics_info](uint64_t ts, DataBlock* row) {
+        if (row->dim_cnt_down > 1) {
+            row->dim_cnt_down--;
+        } else {
+            VLOG(1) << "delete data block for key " << ts;
+            statistics_info->record_byte_size += GetRecordSize(row->size);
+            delete row;
         }
         statistics_info->IncrIdxCnt(idx);
-        statistics_info->idx_byte_size += GetRecordTsIdxSize(node->Height());
-        auto tmp = node;
-        node = node->GetNextNoBarrier(0);
-        delete tmp;
+    };
+    while (nodes != nullptr) {
+        auto tmp = nodes;
+        nodes = nodes->GetNextNoBarrier(0);
+        byte_size += GetRecordTsIdxSize(tmp->Height());
+        free_row(tmp->GetKey(), tmp->GetValue());
+        base::Node<uint64_t, DataBlock*>::Delete(tmp, allocator);
+    }
+    if (rows != nullptr) {
+        for (uint32_t i = 0; i < rows->GetSize(); i++) {
+            byte_size += TIME_SLOT_SIZE;
+            free_row(rows->GetSlot(i).ts, rows->GetSlot(i).row);
+        }
+        TimeArray::Delete(rows, allocator);
+        rows = nullptr;
+    }
+    TimeArray::Delete(retired_array, allocator);
+    retired_array = nullptr;
+    if (retired_list != nullptr) {
+        TimeList::Iterator it(retired_list);
+        it.SeekToFirst();
+        auto node = it.Valid() ? retired_list->Split(it.GetKey()) : nullptr;
+        while (node != nullptr) {
+            auto tmp = node;
+            node = node->GetNextNoBarrier(0);
+            base::Node<uint64_t, DataBlock*>::Delete(tmp, allocator);
+        }
+        delete retired_list;
+        retired_list = nullptr;
+    }
+    return byte_size;
+}
+
+TimeEntries::~TimeEntries() { delete GetList(index_.load(std::memory_order_relaxed)); }
+
+TimeEntries::InsertStatus TimeEntries::Insert(uint64_t ts, DataBlock* row, base::SlabAllocator* allocator,
+                                              RemovedRows* retired, uint32_t* byte_size) {
+    {
+        std::shared_lock<base::SharedSpinMutex> lock(mu_);
+        if (closed_) {
+            return InsertStatus::kClosed;
+        }
+        if (TimeList* list = GetList(index_.load(std::memory_order_acquire)); list != nullptr) {
+            uint8_t height = 0;
+            list->ConcurrentInsert(ts, row, allocator, false, &height);
+            *byte_size += GetRecordTsIdxSize(height);
+            return InsertStatus::kInserted;
+        }
+    }
+    std::lock_guard<base::SharedSpinMutex> lock(mu_);
+    if (closed_) {
+        return InsertStatus::kClosed;
+    }
+    *byte_size += InsertExclusive(ts, row, allocator, retired);
+    return InsertStatus::kInserted;
+}
+
+uint32_t TimeEntries::InsertExclusive(uint64_t ts, DataBlock* row, base::SlabAllocator* allocator,
+                                      RemovedRows* retired) {
+    uintptr_t index = index_.load(std::memory_order_relaxed);
+    if (TimeList* list = GetList(index); list != nullptr) {
+        // promoted by another put
+        uint8_t height = 0;
+        list->ConcurrentInsert(ts, row, allocator, false, &height);
+        return GetRecordTsIdxSize(height);
+    }
+    TimeArray* array = GetArray(index);
+    uint32_t size = array == nullptr ? 0 : array->GetSize();
+    if (size >= FLAGS_time_index_array_max_size) {
+        return Promote(array, ts, row, allocator, retired);
+    }
+    if (array != nullptr && size < array->GetCapacity() && (size == 0 || array->GetSlot(size - 1).ts <= ts)) {
+        array->Append(ts, row);
+        return TIME_SLOT_SIZE;
+    }
+    // a row out of time order or a full array, the slots read by the readers are not moved in place
+    uint32_t capacity = std::min(FLAGS_time_index_array_max_size, std::max(size * 2, 1u));
+    TimeArray* new_array = nullptr;
+    if (array == nullptr) {
+        new_array = TimeArray::New(capacity, allocator);
+        new_array->Append(ts, row);
+    } else {
+        new_array = array->CopyInsert(ts, row, std::max(capacity, array->GetCapacity()), allocator);
+    }
+    index_.store(reinterpret_cast<uintptr_t>(new_array), std::memory_order_release);
+    retired->retired_array = array;
+    return TIME_SLOT_SIZE;
+}
+
+bool TimeEntries::Close(bool only_empty) {
+    std::lock_guard<base::SharedSpinMutex> lock(mu_);
+    if (only_empty && !IsEmpty()) {
+        return false;
+    }
+    closed_ = true;
+    return true;
+}
+
+void TimeEntries::Reopen() {
+    std::lock_guard<base::SharedSpinMutex> lock(mu_);
+    closed_ = false;
+}
+
+uint32_t TimeEntries::Promote(TimeArray* array, uint64_t ts, DataBlock* row, base::SlabAllocator* allocator,
+                              RemovedRows* retired) {
+    auto list = new TimeList(max_height_, 4, tcmp);
+    uint32_t byte_size = GetTimeListSize(max_height_);
+    if (array != nullptr) {
+        // a new node goes before the nodes with the same time, insert from the oldest to keep the order
+        for (uint32_t i = 0; i < array->GetSize(); i++) {
+            const TimeSlot& slot = array->GetSlot(i);
+            DataBlock* value = slot.row;
+            byte_size += GetRecordTsIdxSize(list->Insert(slot.ts, value, allocator));
+            byte_size -= TIME_SLOT_SIZE;
+        }
+    }
+    byte_size += GetRecordTsIdxSize(list->Insert(ts, row, allocator));
+    index_.store(reinterpret_cast<uintptr_t>(list) | kListTag, std::memory_order_release);
+    retired->retired_array = array;
+    return byte_size;
+}
+
+bool TimeEntries::IsEmpty() {
+    uintptr_t index = index_.load(std::memory_order_acquire);
+    if (TimeList* list = GetList(index); list != nullptr) {
+        return list->IsEmpty();
+    }
+    TimeArray* array = GetArray(index);
+    return array == nullptr || array->GetSize() == 0;
+}
+
+uint32_t TimeEntries::GetSize() {
+    uintptr_t index = index_.load(std::memory_order_acquire);
+    if (TimeList* list = GetList(index); list != nullptr) {
+        return list->GetSize();
+    }
+    TimeArray* array = GetArray(index);
+    return array == nullptr ? 0 : array->GetSize();
+}
+
+bool TimeEntries::GetLastTime(uint64_t* ts) {
+    uintptr_t index = index_.load(std::memory_order_acquire);
+    if (TimeList* list = GetList(index); list != nullptr) {
+        auto node = list->GetLast();
+        if (node == nullptr) {
+            return false;
+        }
+        *ts = node->GetKey();
+        return true;
+    }
+    TimeArray* array = GetArray(index);
+    if (array == nullptr || array->GetSize() == 0) {
+        return false;
     }
+    *ts = array->GetSlot(0).ts;
+    return true;
+}
+
+int TimeEntries::Get(uint64_t ts, DataBlock*& row) {
+    uintptr_t index = index_.load(std::memory_order_acquire);
+    if (TimeList* list = GetList(index); list != nullptr) {
+        return list->Get(ts, row);
+    }
+    TimeArray* array = GetArray(index);
+    if (array == nullptr) {
+        return -1;
+    }
+    // the newest row of the time as the skiplist returns
+    uint32_t pos = array->UpperBound(ts, array->GetSize());
+    if (pos == 0 || array->GetSlot(pos - 1).ts != ts) {
+        return -1;
+    }
+    row = array->GetSlot(pos - 1).row;
+    return 0;
+}
+
+uint32_t TimeEntries::CountNewer(const TimeArray* array, uint64_t ts) {
+    uint32_t size = array->GetSize();
+    return size - array->UpperBound(ts, size);
+}
+
+RemovedRows TimeEntries::TruncateArray(TimeArray* array, uint64_t pos, base::SlabAllocator* allocator) {
+    RemovedRows removed;
+    uint32_t size = array == nullptr ? 0 : array->GetSize();
+    if (pos >= size) {
+        return removed;
+    }
+    if (pos == 0) {
+        index_.store(0, std::memory_order_release);
+        removed.rows = array;
+        return removed;
+    }
+    uint32_t end = size - pos;
+    TimeArray* kept = array->Copy(end, size, array->GetCapacity(), allocator);
+    removed.rows = array->Copy(0, end, end, allocator);
+    index_.store(reinterpret_cast<uintptr_t>(kept), std::memory_order_release);
+    removed.retired_array = array;
+    return removed;
+}
+
+RemovedRows TimeEntries::Split(uint64_t ts, base::SlabAllocator* allocator) {
+    std::lock_guard<base::SharedSpinMutex> lock(mu_);
+    uintptr_t index = index_.load(std::memory_order_relaxed);
+    if (TimeList* list = GetList(index); list != nullptr) {
+        return RemovedRows{list->Split(ts), nullptr};
+    }
+    TimeArray* array = GetArray(index);
+    return TruncateArray(array, array == nullptr ? 0 : CountNewer(array, ts), allocator);
+}
+
+RemovedRows TimeEntries::SplitByPos(uint64_t pos, base::SlabAllocator* allocator) {
+    std::lock_guard<base::SharedSpinMutex> lock(mu_);
+    uintptr_t index = index_.load(std::memory_order_relaxed);
+    if (TimeList* list = GetList(index); list != nullptr) {
+        return RemovedRows{list->SplitByPos(pos), nullptr};
+    }
+    return TruncateArray(GetArray(index), pos, allocator);
+}
+
+RemovedRows TimeEntries::SplitByKeyOrPos(uint64_t ts, uint64_t pos, base::SlabAllocator* allocator) {
+    std::lock_guard<base::SharedSpinMutex> lock(mu_);
+    uintptr_t index = index_.load(std::memory_order_relaxed);
+    if (TimeList* list = GetList(index); list != nullptr) {
+        return RemovedRows{list->SplitByKeyOrPos(ts, pos), nullptr};
+    }
+    TimeArray* array = GetArray(index);
+    if (array == nullptr) {
+        return RemovedRows();
+    }
+    return TruncateArray(array, std::min(pos, static_cast<uint64_t>(CountNewer(array, ts))), allocator);
+}
+
+RemovedRows TimeEntries::SplitByKeyAndPos(uint64_t ts, uint64_t pos, base::SlabAllocator* allocator) {
+    std::lock_guard<base::SharedSpinMutex> lock(mu_);
+    uintptr_t index = index_.load(std::memory_order_relaxed);
+    if (TimeList* list = GetList(index); list != nullptr) {
+        return RemovedRows{list->SplitByKeyAndPos(ts, pos), nullptr};
+    }
+    TimeArray* array = GetArray(index);
+    if (array == nullptr) {
+        return RemovedRows();
+    }
+    return TruncateArray(array, std::max(pos, static_cast<uint64_t>(CountNewer(array, ts))), allocator);
+}
+
+RemovedRows TimeEntries::Remove(uint64_t ts, base::SlabAllocator* allocator) {
+    std::lock_guard<base::SharedSpinMutex> lock(mu_);
+    uintptr_t index = index_.load(std::memory_order_relaxed);
+    if (TimeList* list = GetList(index); list != nullptr) {
+        return RemovedRows{list->Remove(ts), nullptr};
+    }
+    RemovedRows removed;
+    TimeArray* array = GetArray(index);
+    if (array == nullptr) {
+        return removed;
+    }
+    uint32_t size = array->GetSize();
+    uint32_t pos = array->UpperBound(ts, size);
+    if (pos == 0 || array->GetSlot(pos - 1).ts != ts) {
+        return removed;
+    }
+    if (size == 1) {
+        index_.store(0, std::memory_order_release);
+        removed.rows = array;
+        return removed;
+    }
+    removed.rows = array->Copy(pos - 1, pos, 1, allocator);
+    index_.store(reinterpret_cast<uintptr_t>(array->CopyErase(pos - 1, allocator)), std::memory_order_release);
+    removed.retired_array = array;
+    return removed;
+}
+
+RemovedRows TimeEntries::SplitAll(base::SlabAllocator* allocator) {
+    std::lock_guard<base::SharedSpinMutex> lock(mu_);
+    uintptr_t index = index_.load(std::memory_order_relaxed);
+    RemovedRows removed;
+    if (TimeList* list = GetList(index); list != nullptr) {
+        TimeList::Iterator it(list);
+        it.SeekToFirst();
+        if (it.Valid()) {
+            removed.nodes = list->Split(it.GetKey());
+        }
+    } else if (TimeArray* array = GetArray(index); array != nullptr) {
+        index_.store(0, std::memory_order_release);
+        removed.rows = array;
+    }
+    return removed;
+}
+
+uint32_t TimeEntries::Compact(base::SlabAllocator* allocator, RemovedRows* retired) {
+    // the puts on the list are kept out until the array is published
+    std::lock_guard<base::SharedSpinMutex> lock(mu_);
+    TimeList* list = GetList(index_.load(std::memory_order_relaxed));
+    if (list == nullptr || FLAGS_time_index_array_max_size == 0) {
+        return 0;
+    }
+    uint32_t size = list->GetSize();
+    if (size > FLAGS_time_index_array_max_size / 2) {
+        return 0;
+    }
+    uint32_t byte_size = GetTimeListSize(max_height_);
+    TimeArray* array = nullptr;
+    if (size > 0) {
+        array = TimeArray::New(size, allocator);
+        // the list is in desc time order, fill the array from the oldest
+        absl::InlinedVector<TimeSlot, 8> slots;
+        TimeList::Iterator it(list);
+        for (it.SeekToFirst(); it.Valid(); it.Next()) {
+            slots.push_back({it.GetKey(), it.GetValue()});
+            byte_size += GetRecordTsIdxSize(it.GetNode()->Height()) - TIME_SLOT_SIZE;
+        }
+        for (auto slot = slots.rbegin(); slot != slots.rend(); ++slot) {
+            array->Append(slot->ts, slot->row);
+        }
+    }
+    index_.store(reinterpret_cast<uintptr_t>(array), std::memory_order_release);
+    retired->retired_list = list;
+    return byte_size;
+}
+
+uint32_t TimeEntries::GetListSize() {
+    return GetList(index_.load(std::memory_order_acquire)) == nullptr ? 0 : GetTimeListSize(max_height_);
+}
+
+void TimeEntries::Iterator::Load() {
+    list_it_.reset();
+    array_ = nullptr;
+    size_ = 0;
+    pos_ = 0;
+    uintptr_t index = entries_->index_.load(std::memory_order_acquire);
+    if (TimeList* list = entries_->GetList(index); list != nullptr) {
+        list_it_.emplace(list);
+    } else if (TimeArray* array = entries_->GetArray(index); array != nullptr) {
+        array_ = array;
+        size_ = array->GetSize();
+    }
+}
+
+void TimeEntries::Iterator::Next() {
+    if (list_it_) {
+        list_it_->Next();
+    } else {
+        pos_++;
+    }
+}
+
+void TimeEntries::Iterator::Seek(uint64_t ts) {
+    Load();
+    if (list_it_) {
+        list_it_->Seek(ts);
+    } else if (array_ != nullptr) {
+        pos_ = size_ - array_->UpperBound(ts, size_);
+    }
+}
+
+void TimeEntries::Iterator::SeekToFirst() {
+    Load();
+    if (list_it_) {
+        list_it_->SeekToFirst();
+    }
+}
+
+void TimeEntries::Iterator::SeekToLast() {
+    Load();
+    if (list_it_) {
+        list_it_->SeekToLast();
+    } else if (size_ > 0) {
+        pos_ = size_ - 1;
+    }
+}
+
+void KeyEntry::Release(uint32_t idx, StatisticsInfo* statistics_info, base::SlabAllocator* allocator) {
+    RemovedRows rows = entries.SplitAll(allocator);
+    statistics_info->idx_byte_size += rows.Free(idx, statistics_info, allocator) + entries.GetListSize();
 }
 
 }  // namespace storage
@@ -17,9 +17,15 @@
 #ifndef SRC_STORAGE_KEY_ENTRY_H_
 #define SRC_STORAGE_KEY_ENTRY_H_
 
+#include <atomic>
 #include <cstring>
 #include <memory>
+#include <mutex>  // NOLINT
+#include <optional>
+
 #include "base/skiplist.h"
+#include "base/slab_allocator.h"
+#include "base/spinlock.h"
 
 namespace openmldb {
 namespace storage {
@@ -27,16 +33,30 @@ namespace storage {
 struct DataBlock {
     // dimension count down
     uint8_t dim_cnt_down;
+    // data is allocated from a segment slab, it fills the padding so the size of DataBlock doesn't change
+    bool in_slab;
     uint32_t size;
     char* data;
 
-    DataBlock(uint8_t dim_cnt, const char* input, uint32_t len) : dim_cnt_down(dim_cnt), size(len), data(nullptr) {
+    DataBlock(uint8_t dim_cnt, const char* input, uint32_t len)
+        : dim_cnt_down(dim_cnt), in_slab(false), size(len), data(nullptr) {
         data = new char[len];
         memcpy(data, input, len);
     }
 
+    // copy input into the slab if allocator is not null
+    DataBlock(uint8_t dim_cnt, const char* input, uint32_t len, base::SlabAllocator* allocator)
+        : dim_cnt_down(dim_cnt), in_slab(allocator != nullptr), size(len), data(nullptr) {
+        if (in_slab) {
+            data = allocator->AllocateWithOwner(len);
+        } else {
+            data = new char[len];
+        }
+        memcpy(data, input, len);
+    }
+
     DataBlock(uint8_t dim_cnt, char* input, uint32_t len, bool skip_copy)
-        : dim_cnt_down(dim_cnt), size(len), data(nullptr) {
+        : dim_cnt_down(dim_cnt), in_slab(false), size(len), data(nullptr) {
         if (skip_copy) {
             data = input;
         } else {
@@ -46,7 +66,11 @@ struct DataBlock {
     }
 
     ~DataBlock() {
-        delete[] data;
+        if (in_slab) {
+            base::SlabAllocator::FreeWithOwner(data, size);
+        } else {
+            delete[] data;
+        }
         data = nullptr;
     }
 
@@ -72,15 +96,193 @@ struct TimeComparator {
 };
 
 static const TimeComparator tcmp;
-using TimeEntries = base::Skiplist<uint64_t, DataBlock*, TimeComparator>;
+using TimeList = base::Skiplist<uint64_t, DataBlock*, TimeComparator>;
 struct StatisticsInfo;
 
+struct TimeSlot {
+    uint64_t ts;
+    DataBlock* row;
+};
+
+// TimeArray keeps the rows of a key in asc time order, a new row goes after the rows with the same time, so the rows
+// read backward are in the order of the skiplist. It's allocated in one block with the slots placed right after the
+// header. The slots below the size are never changed, a put appends a slot and then publishes the size, so a reader
+// reads the slots below the size it loads without a lock
+class TimeArray {
+ public:
+    static TimeArray* New(uint32_t capacity, base::SlabAllocator* allocator);
+    // allocator must be the one that the array is created with
+    static void Delete(TimeArray* array, base::SlabAllocator* allocator);
+
+    uint32_t GetCapacity() const { return capacity_; }
+    uint32_t GetSize() const { return size_.load(std::memory_order_acquire); }
+    // the pos-th oldest slot, pos must be less than the size loaded
+    const TimeSlot& GetSlot(uint32_t pos) const { return Slots()[pos]; }
+
+    // the array must not be full and ts must not be less than the time of the last slot
+    void Append(uint64_t ts, DataBlock* row);
+    // a copy of the slots in [start, end) with the capacity
+    TimeArray* Copy(uint32_t start, uint32_t end, uint32_t capacity, base::SlabAllocator* allocator) const;
+    // a copy with the row inserted, capacity must be greater than the size
+    TimeArray* CopyInsert(uint64_t ts, DataBlock* row, uint32_t capacity, base::SlabAllocator* allocator) const;
+    // a copy without the slot at pos
+    TimeArray* CopyErase(uint32_t pos, base::SlabAllocator* allocator) const;
+    // the count of the slots whose time <= ts in the first size slots
+    uint32_t UpperBound(uint64_t ts, uint32_t size) const;
+
+ private:
+    explicit TimeArray(uint32_t capacity) : capacity_(capacity), size_(0) {}
+    static uint32_t AllocSize(uint32_t capacity) { return sizeof(TimeArray) + capacity * sizeof(TimeSlot); }
+    TimeSlot* Slots() { return reinterpret_cast<TimeSlot*>(this + 1); }
+    const TimeSlot* Slots() const { return reinterpret_cast<const TimeSlot*>(this + 1); }
+
+    const uint32_t capacity_;
+    std::atomic<uint32_t> size_;
+};
+
+// RemovedRows are the rows split from TimeEntries, a reader may still see them until they are freed
+struct RemovedRows {
+    base::Node<uint64_t, DataBlock*>* nodes = nullptr;
+    TimeArray* rows = nullptr;
+    // the index replaced by a new one, it's freed without the rows which are moved to the new one
+    TimeArray* retired_array = nullptr;
+    TimeList* retired_list = nullptr;
+
+    bool IsEmpty() const {
+        return nodes == nullptr && rows == nullptr && retired_array == nullptr && retired_list == nullptr;
+    }
+    // move the retired index out, so the rows can be freed at once while the index is freed by the node cache
+    RemovedRows TakeRetired();
+    // release the rows and return the idx byte size of them, the retired index is counted when it's replaced
+    uint64_t Free(uint32_t idx, StatisticsInfo* statistics_info, base::SlabAllocator* allocator);
+};
+
+// TimeEntries is the time index of a key. The rows of a key with a few rows are kept in a TimeArray, which costs
+// a slot per row instead of a skiplist node and the skiplist head, and is promoted to a skiplist when it grows over
+// FLAGS_time_index_array_max_size rows. A skiplist that gc shrinks to the half of it is compacted to an array again.
+//
+// Puts on a skiplist insert with cas holding the spin lock shared, the other changes hold it exclusively. A put in
+// time order appends to the array in place, the other changes build a new array or list, publish it by index_ and
+// return the replaced one in RemovedRows, which must be retired by the gc version as the removed rows are. Readers
+// load index_ without a lock.
+//
+// The segment puts rows without its lock, so a key is closed before it's removed from the segment. An insert into
+// closed entries fails and the put looks the key up again.
+class TimeEntries {
+ public:
+    enum class InsertStatus { kInserted, kExisted, kClosed };
+
+    explicit TimeEntries(uint8_t max_height) : index_(0), max_height_(max_height), closed_(false), mu_() {}
+    // the rows must be split before
+    ~TimeEntries();
+    TimeEntries(const TimeEntries&) = delete;
+    TimeEntries& operator=(const TimeEntries&) = delete;
+
+    // add the idx byte size to byte_size, the rows are allocated from allocator if it's not null. The index replaced
+    // is set to retired. It can run with other inserts and readers at the same time
+    InsertStatus Insert(uint64_t ts, DataBlock* row, base::SlabAllocator* allocator, RemovedRows* retired,
+                        uint32_t* byte_size);
+    // the same as Insert, but no other insert runs between exists and the insert. kExisted if exists returns true
+    template <typename Exists>
+    InsertStatus InsertIfAbsent(uint64_t ts, DataBlock* row, base::SlabAllocator* allocator, RemovedRows* retired,
+                                uint32_t* byte_size, Exists exists) {
+        std::lock_guard<base::SharedSpinMutex> lock(mu_);
+        if (closed_) {
+            return InsertStatus::kClosed;
+        }
+        if (exists()) {
+            return InsertStatus::kExisted;
+        }
+        *byte_size += InsertExclusive(ts, row, allocator, retired);
+        return InsertStatus::kInserted;
+    }
+
+    // the inserts fail after it's closed. If only_empty is set, it's closed only when there is no row. Return
+    // whether it's closed
+    bool Close(bool only_empty);
+    // undo Close if the key is not removed at last
+    void Reopen();
+
+    bool IsEmpty();
+    uint32_t GetSize();
+    // the time of the last row, return false if it's empty
+    bool GetLastTime(uint64_t* ts);
+    int Get(uint64_t ts, DataBlock*& row);  // NOLINT
+
+    // the same as the ones of skiplist, allocator must be the one that the rows are inserted with
+    RemovedRows Split(uint64_t ts, base::SlabAllocator* allocator);
+    RemovedRows SplitByPos(uint64_t pos, base::SlabAllocator* allocator);
+    RemovedRows SplitByKeyOrPos(uint64_t ts, uint64_t pos, base::SlabAllocator* allocator);
+    RemovedRows SplitByKeyAndPos(uint64_t ts, uint64_t pos, base::SlabAllocator* allocator);
+    RemovedRows Remove(uint64_t ts, base::SlabAllocator* allocator);
+    RemovedRows SplitAll(base::SlabAllocator* allocator);
+
+    // turn a skiplist with a few rows into an array, the list is set to retired. Return the idx byte size released
+    uint32_t Compact(base::SlabAllocator* allocator, RemovedRows* retired);
+
+    // the idx byte size of the skiplist head, 0 if the rows are in an array
+    uint32_t GetListSize();
+
+    class Iterator {
+     public:
+        explicit Iterator(TimeEntries* entries) : entries_(entries), list_it_(), array_(nullptr), size_(0), pos_(0) {}
+        bool Valid() const { return list_it_ ? list_it_->Valid() : pos_ < size_; }
+        void Next();
+        uint64_t GetKey() const { return list_it_ ? list_it_->GetKey() : array_->GetSlot(size_ - 1 - pos_).ts; }
+        DataBlock* GetValue() { return list_it_ ? list_it_->GetValue() : array_->GetSlot(size_ - 1 - pos_).row; }
+        // seek to the first row whose time <= ts
+        void Seek(uint64_t ts);
+        void SeekToFirst();
+        void SeekToLast();
+
+     private:
+        // reload the index which may be changed since the last seek
+        void Load();
+
+        TimeEntries* const entries_;
+        std::optional<TimeList::Iterator> list_it_;
+        // the array and the size loaded, the rows are read backward from the newest
+        const TimeArray* array_;
+        uint32_t size_;
+        uint32_t pos_;
+    };
+
+    // delete the iterator after it's used
+    Iterator* NewIterator() { return new Iterator(this); }
+
+ private:
+    static constexpr uintptr_t kListTag = 1;
+
+    TimeList* GetList(uintptr_t index) const {
+        return (index & kListTag) ? reinterpret_cast<TimeList*>(index & ~kListTag) : nullptr;
+    }
+    TimeArray* GetArray(uintptr_t index) const {
+        return (index & kListTag) ? nullptr : reinterpret_cast<TimeArray*>(index);
+    }
+    // the count of the rows whose time > ts
+    static uint32_t CountNewer(const TimeArray* array, uint64_t ts);
+    // keep the newest pos rows of the array, the spin lock must be held exclusively
+    RemovedRows TruncateArray(TimeArray* array, uint64_t pos, base::SlabAllocator* allocator);
+    // return the idx byte size added, the spin lock must be held exclusively
+    uint32_t InsertExclusive(uint64_t ts, DataBlock* row, base::SlabAllocator* allocator, RemovedRows* retired);
+    uint32_t Promote(TimeArray* array, uint64_t ts, DataBlock* row, base::SlabAllocator* allocator,
+                     RemovedRows* retired);
+
+    // a TimeArray, or a TimeList tagged with kListTag, 0 if no row is put
+    std::atomic<uintptr_t> index_;
+    const uint8_t max_height_;
+    // set and read with mu_ held
+    bool closed_;
+    base::SharedSpinMutex mu_;
+};
+
 class KeyEntry {
  public:
-    KeyEntry() : entries(12, 4, tcmp), refs_(0), count_(0) {}
-    explicit KeyEntry(uint8_t height) : entries(height, 4, tcmp), refs_(0), count_(0) {}
+    KeyEntry() : entries(12), refs_(0), put_cnt_(0), count_(0) {}
+    explicit KeyEntry(uint8_t height) : entries(height), refs_(0), put_cnt_(0), count_(0) {}
 
-    void Release(uint32_t idx, StatisticsInfo* statistics_info);
+    // allocator must be the one that the entries are inserted with
+    void Release(uint32_t idx, StatisticsInfo* statistics_info, base::SlabAllocator* allocator = nullptr);
 
     void Ref() { refs_.fetch_add(1, std::memory_order_relaxed); }
 
@@ -88,9 +290,21 @@ class KeyEntry {
 
     uint64_t GetCount() { return count_.load(std::memory_order_relaxed); }
 
+    // count a row inserted into entries
+    void CountPut() {
+        count_.fetch_add(1, std::memory_order_relaxed);
+        put_cnt_.fetch_add(1, std::memory_order_release);
+    }
+
+    // the rows ever put, it only decreases when it wraps around after 2^32 puts. The rows counted are visible
+    // to the reader which loads it
+    uint64_t GetPutCount() { return put_cnt_.load(std::memory_order_acquire); }
+
  public:
     TimeEntries entries;
-    std::atomic<uint64_t> refs_;
+    std::atomic<uint32_t> refs_;
+    // it fills the padding after refs_, so the put count costs no memory
+    std::atomic<uint32_t> put_cnt_;
     std::atomic<uint64_t> count_;
 };
 
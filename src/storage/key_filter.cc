@@ -0,0 +1,144 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/key_filter.h"
+
+#include <algorithm>
+
+#include "base/hash.h"
+
+namespace openmldb {
+namespace storage {
+
+// differs from the seed of segment and partition hash, the keys of a segment share those hash values
+static constexpr uint32_t kKeyFilterSeed = 0x9747b28c;
+static constexpr uint32_t kBlockBits = 512;
+
+struct KeyFilter::Stage {
+    struct alignas(64) Block {
+        std::atomic<uint64_t> words[kBlockBits / 64];
+    };
+
+    Stage(uint64_t cap, uint64_t cnt) : capacity(cap), block_cnt(cnt), key_cnt(0), blocks(new Block[cnt]) {
+        for (uint64_t i = 0; i < block_cnt; i++) {
+            for (auto& word : blocks[i].words) {
+                word.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    Block& GetBlock(uint64_t hash) const { return blocks[(hash >> 32) % block_cnt]; }
+
+    const uint64_t capacity;
+    const uint64_t block_cnt;
+    std::atomic<uint64_t> key_cnt;
+    std::unique_ptr<Block[]> blocks;
+};
+
+KeyFilter::KeyFilter(uint32_t bits_per_key, uint64_t capacity)
+    : bits_per_key_(std::max(bits_per_key, 1u)),
+      // k = ln2 * bits_per_key minimizes the false positive rate
+      probe_cnt_(std::clamp(static_cast<uint32_t>(bits_per_key_ * 0.69), 1u, 30u)),
+      stages_(),
+      stage_cnt_(1),
+      mu_() {
+    stages_[0].store(NewStage(std::max<uint64_t>(capacity, 1)), std::memory_order_relaxed);
+}
+
+KeyFilter::~KeyFilter() {
+    for (uint32_t i = 0; i < stage_cnt_.load(std::memory_order_relaxed); i++) {
+        delete stages_[i].load(std::memory_order_relaxed);
+    }
+}
+
+KeyFilter::Stage* KeyFilter::NewStage(uint64_t capacity) const {
+    uint64_t block_cnt = (capacity * bits_per_key_ + kBlockBits - 1) / kBlockBits;
+    return new Stage(capacity, block_cnt);
+}
+
+KeyFilter::Stage* KeyFilter::GetAddStage() {
+    uint32_t cnt = stage_cnt_.load(std::memory_order_acquire);
+    Stage* stage = stages_[cnt - 1].load(std::memory_order_acquire);
+    if (stage->key_cnt.fetch_add(1, std::memory_order_relaxed) < stage->capacity || cnt == kMaxStageCnt) {
+        return stage;
+    }
+    // the key goes to the next stage, it is not counted in the full one
+    stage->key_cnt.fetch_sub(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mu_);
+    cnt = stage_cnt_.load(std::memory_order_relaxed);
+    // another add may have appended a stage already
+    if (stages_[cnt - 1].load(std::memory_order_relaxed) == stage && cnt < kMaxStageCnt) {
+        stages_[cnt].store(NewStage(stage->capacity * 2), std::memory_order_release);
+        stage_cnt_.store(++cnt, std::memory_order_release);
+    }
+    stage = stages_[cnt - 1].load(std::memory_order_relaxed);
+    stage->key_cnt.fetch_add(1, std::memory_order_relaxed);
+    return stage;
+}
+
+void KeyFilter::Add(const base::Slice& key) {
+    uint64_t hash = base::MurmurHash64A(key.data(), static_cast<int>(key.size()), kKeyFilterSeed);
+    auto& block = GetAddStage()->GetBlock(hash);
+    uint32_t h = static_cast<uint32_t>(hash);
+    const uint32_t delta = (h >> 17) | (h << 15);
+    for (uint32_t i = 0; i < probe_cnt_; i++) {
+        uint32_t pos = h % kBlockBits;
+        block.words[pos / 64].fetch_or(1ull << (pos % 64), std::memory_order_relaxed);
+        h += delta;
+    }
+}
+
+bool KeyFilter::MayContain(const base::Slice& key) const {
+    uint64_t hash = base::MurmurHash64A(key.data(), static_cast<int>(key.size()), kKeyFilterSeed);
+    // the last stage is the largest one
+    for (uint32_t i = stage_cnt_.load(std::memory_order_acquire); i > 0; i--) {
+        const auto& block = stages_[i - 1].load(std::memory_order_acquire)->GetBlock(hash);
+        uint32_t h = static_cast<uint32_t>(hash);
+        const uint32_t delta = (h >> 17) | (h << 15);
+        bool match = true;
+        for (uint32_t j = 0; j < probe_cnt_; j++) {
+            uint32_t pos = h % kBlockBits;
+            if ((block.words[pos / 64].load(std::memory_order_relaxed) & (1ull << (pos % 64))) == 0) {
+                match = false;
+                break;
+            }
+            h += delta;
+        }
+        if (match) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t KeyFilter::GetKeyCnt() const {
+    uint64_t key_cnt = 0;
+    for (uint32_t i = 0; i < stage_cnt_.load(std::memory_order_acquire); i++) {
+        key_cnt += stages_[i].load(std::memory_order_acquire)->key_cnt.load(std::memory_order_relaxed);
+    }
+    return key_cnt;
+}
+
+uint64_t KeyFilter::GetByteSize() const {
+    uint64_t byte_size = 0;
+    for (uint32_t i = 0; i < stage_cnt_.load(std::memory_order_acquire); i++) {
+        byte_size += stages_[i].load(std::memory_order_acquire)->block_cnt * sizeof(Stage::Block);
+    }
+    return byte_size;
+}
+
+}  // namespace storage
+}  // namespace openmldb
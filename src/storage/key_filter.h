@@ -0,0 +1,68 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_STORAGE_KEY_FILTER_H_
+#define SRC_STORAGE_KEY_FILTER_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>  // NOLINT
+
+#include "base/slice.h"
+
+namespace openmldb {
+namespace storage {
+
+// A bloom filter of the keys in a segment, MayContain returning false means the key is absent.
+// Add and MayContain are lock free. The bits of a key are in one cache line. When the keys added exceed
+// the capacity, a new stage with the double capacity is appended, so the false positive rate stays bounded
+// as the segment grows. Keys can not be removed, the segment builds a new filter after gc.
+class KeyFilter {
+ public:
+    KeyFilter(uint32_t bits_per_key, uint64_t capacity);
+    ~KeyFilter();
+    KeyFilter(const KeyFilter&) = delete;
+    KeyFilter& operator=(const KeyFilter&) = delete;
+
+    void Add(const base::Slice& key);
+    bool MayContain(const base::Slice& key) const;
+
+    // the count of adds, a key added twice is counted twice
+    uint64_t GetKeyCnt() const;
+    uint32_t GetBitsPerKey() const { return bits_per_key_; }
+    uint32_t GetStageCnt() const { return stage_cnt_.load(std::memory_order_acquire); }
+    uint64_t GetByteSize() const;
+
+ private:
+    struct Stage;
+    static constexpr uint32_t kMaxStageCnt = 32;
+
+    Stage* NewStage(uint64_t capacity) const;
+    // return the stage to add to, append a new one if the last stage is full
+    Stage* GetAddStage();
+
+    const uint32_t bits_per_key_;
+    const uint32_t probe_cnt_;
+    std::atomic<Stage*> stages_[kMaxStageCnt];
+    std::atomic<uint32_t> stage_cnt_;
+    // only taken to append a stage
+    std::mutex mu_;
+};
+
+}  // namespace storage
+}  // namespace openmldb
+
+#endif  // SRC_STORAGE_KEY_FILTER_H_
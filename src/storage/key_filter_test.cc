@@ -0,0 +1,107 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/key_filter.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace storage {
+
+class KeyFilterTest : public ::testing::Test {
+ public:
+    KeyFilterTest() {}
+    ~KeyFilterTest() {}
+};
+
+TEST_F(KeyFilterTest, MayContain) {
+    KeyFilter filter(10, 1000);
+    for (int i = 0; i < 1000; i++) {
+        filter.Add(absl::StrCat("key", i));
+    }
+    ASSERT_EQ(1u, filter.GetStageCnt());
+    ASSERT_EQ(1000u, filter.GetKeyCnt());
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(filter.MayContain(absl::StrCat("key", i)));
+    }
+    int false_positive = 0;
+    for (int i = 0; i < 10000; i++) {
+        if (filter.MayContain(absl::StrCat("absent", i))) {
+            false_positive++;
+        }
+    }
+    // about 1% with 10 bits per key
+    ASSERT_LT(false_positive, 300);
+}
+
+TEST_F(KeyFilterTest, Grow) {
+    KeyFilter filter(10, 100);
+    uint64_t byte_size = filter.GetByteSize();
+    for (int i = 0; i < 10000; i++) {
+        filter.Add(absl::StrCat("key", i));
+    }
+    // the stages of 100, 200, ..., 6400 keys
+    ASSERT_EQ(7u, filter.GetStageCnt());
+    ASSERT_EQ(10000u, filter.GetKeyCnt());
+    ASSERT_GT(filter.GetByteSize(), byte_size);
+    for (int i = 0; i < 10000; i++) {
+        ASSERT_TRUE(filter.MayContain(absl::StrCat("key", i)));
+    }
+    int false_positive = 0;
+    for (int i = 0; i < 10000; i++) {
+        if (filter.MayContain(absl::StrCat("absent", i))) {
+            false_positive++;
+        }
+    }
+    // each stage adds about 1%
+    ASSERT_LT(false_positive, 1500);
+}
+
+TEST_F(KeyFilterTest, ConcurrentAdd) {
+    KeyFilter filter(10, 16);
+    const int thread_num = 8;
+    const int key_num = 5000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_num; t++) {
+        threads.emplace_back([&filter, t] {
+            for (int i = 0; i < key_num; i++) {
+                filter.Add(absl::StrCat("key", t, "_", i));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(static_cast<uint64_t>(thread_num * key_num), filter.GetKeyCnt());
+    for (int t = 0; t < thread_num; t++) {
+        for (int i = 0; i < key_num; i++) {
+            ASSERT_TRUE(filter.MayContain(absl::StrCat("key", t, "_", i)));
+        }
+    }
+}
+
+}  // namespace storage
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
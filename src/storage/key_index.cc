@@ -0,0 +1,129 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/key_index.h"
+
+#include <algorithm>
+
+#include "base/hash.h"
+
+namespace openmldb {
+namespace storage {
+
+static_assert(sizeof(void*) == sizeof(uint64_t), "the slot packs a pointer with the hash tag");
+
+static constexpr uint64_t kKeyIndexMinCapacity = 1024;
+static constexpr uint32_t kKeyIndexSeed = 0x5bd1e995;
+// user space pointers have the high 16 bits clear
+static constexpr uint32_t kTagShift = 48;
+static constexpr uint64_t kPtrMask = (1ull << kTagShift) - 1;
+static constexpr uint64_t kEmptySlot = 0;
+static constexpr uint64_t kRemovedSlot = 1;
+
+static inline uint64_t HashKey(const base::Slice& key) {
+    return base::MurmurHash64A(key.data(), static_cast<int>(key.size()), kKeyIndexSeed);
+}
+
+static inline uint64_t MakeSlot(uint64_t hash, const KeyIndex::KeyNode* node) {
+    return (hash >> kTagShift << kTagShift) | reinterpret_cast<uint64_t>(node);
+}
+
+static inline KeyIndex::KeyNode* GetNode(uint64_t slot) {
+    return reinterpret_cast<KeyIndex::KeyNode*>(slot & kPtrMask);
+}
+
+static uint64_t CapacityOf(uint64_t key_cnt) {
+    uint64_t capacity = kKeyIndexMinCapacity;
+    while (capacity < key_cnt * 4) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+KeyIndex::KeyIndex(uint64_t key_cnt)
+    : capacity_(CapacityOf(key_cnt)), slots_(new std::atomic<uint64_t>[capacity_]), used_cnt_(0), full_(false) {
+    for (uint64_t i = 0; i < capacity_; i++) {
+        slots_[i].store(kEmptySlot, std::memory_order_relaxed);
+    }
+}
+
+KeyIndex::KeyNode* KeyIndex::Get(const base::Slice& key) const {
+    uint64_t hash = HashKey(key);
+    uint64_t tag = hash >> kTagShift;
+    uint64_t pos = hash & (capacity_ - 1);
+    for (uint64_t i = 0; i < capacity_; i++) {
+        uint64_t slot = slots_[pos].load(std::memory_order_acquire);
+        if (slot == kEmptySlot) {
+            return nullptr;
+        }
+        if (slot != kRemovedSlot && slot >> kTagShift == tag) {
+            KeyNode* node = GetNode(slot);
+            if (node->GetKey().compare(key) == 0) {
+                return node;
+            }
+        }
+        pos = (pos + 1) & (capacity_ - 1);
+    }
+    return nullptr;
+}
+
+bool KeyIndex::Insert(KeyNode* node) {
+    uint64_t hash = HashKey(node->GetKey());
+    uint64_t value = MakeSlot(hash, node);
+    uint64_t pos = hash & (capacity_ - 1);
+    for (uint64_t i = 0; i < capacity_; i++) {
+        uint64_t slot = slots_[pos].load(std::memory_order_relaxed);
+        // the node is new to the skiplist, so its key is not after a removed slot unless it is inserted twice
+        while (slot == kEmptySlot || slot == kRemovedSlot) {
+            uint64_t expected = slot;
+            if (slots_[pos].compare_exchange_strong(slot, value, std::memory_order_release,
+                                                    std::memory_order_relaxed)) {
+                if (expected == kEmptySlot) {
+                    used_cnt_.fetch_add(1, std::memory_order_relaxed);
+                }
+                return true;
+            }
+        }
+        // the rebuild of the index and a put could insert the same node
+        if (slot == value) {
+            return true;
+        }
+        pos = (pos + 1) & (capacity_ - 1);
+    }
+    full_.store(true, std::memory_order_relaxed);
+    return false;
+}
+
+void KeyIndex::Remove(KeyNode* node) {
+    uint64_t hash = HashKey(node->GetKey());
+    uint64_t value = MakeSlot(hash, node);
+    uint64_t pos = hash & (capacity_ - 1);
+    for (uint64_t i = 0; i < capacity_; i++) {
+        uint64_t slot = slots_[pos].load(std::memory_order_relaxed);
+        if (slot == kEmptySlot) {
+            return;
+        }
+        if (slot == value) {
+            // a removed slot still links the probe sequence of the keys after it. go on for the other slot of a
+            // node inserted twice
+            slots_[pos].store(kRemovedSlot, std::memory_order_release);
+        }
+        pos = (pos + 1) & (capacity_ - 1);
+    }
+}
+
+}  // namespace storage
+}  // namespace openmldb
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_STORAGE_KEY_INDEX_H_
+#define SRC_STORAGE_KEY_INDEX_H_
+
+#include <atomic>
+#include <memory>
+
+#include "base/skiplist.h"
+#include "base/slice.h"
+
+namespace openmldb {
+namespace storage {
+
+// An open addressing hash table from the keys of a segment to their nodes in the KeyEntries skiplist, it serves
+// the point lookups while the skiplist keeps serving ordered traversal. A slot is one word holding the node
+// pointer and 16 bits of the key hash, so a probe compares keys only on a hash match.
+// Get is lock free. Insert can run with Get, other inserts and Remove, and reuses the removed slots. A node
+// inserted twice at the same time could take two slots, Remove clears all the slots of the node, but a node
+// inserted while it is removed could stay and it must be removed again.
+class KeyIndex {
+ public:
+    using KeyNode = base::Node<base::Slice, void*>;
+
+    // the capacity keeps the load factor of key_cnt under 1/4
+    explicit KeyIndex(uint64_t key_cnt);
+    KeyIndex(const KeyIndex&) = delete;
+    KeyIndex& operator=(const KeyIndex&) = delete;
+
+    KeyNode* Get(const base::Slice& key) const;
+    // false if there is no empty slot, the index misses the node then
+    bool Insert(KeyNode* node);
+    void Remove(KeyNode* node);
+
+    // whether the index must grow before n more keys are inserted. the removed slots lengthen the probes, so they
+    // count until an insert reuses them or the index is rebuilt
+    bool NeedGrow(uint64_t n) const {
+        return full_.load(std::memory_order_relaxed) ||
+               (used_cnt_.load(std::memory_order_relaxed) + n) * 2 > capacity_;
+    }
+    bool IsFull() const { return full_.load(std::memory_order_relaxed); }
+    uint64_t GetCapacity() const { return capacity_; }
+    uint64_t GetByteSize() const { return capacity_ * sizeof(uint64_t); }
+
+ private:
+    const uint64_t capacity_;
+    std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+    // the slots of keys and removed keys
+    std::atomic<uint64_t> used_cnt_;
+    std::atomic<bool> full_;
+};
+
+}  // namespace storage
+}  // namespace openmldb
+
+#endif  // SRC_STORAGE_KEY_INDEX_H_
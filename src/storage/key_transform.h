@@ -17,6 +17,8 @@
 #define SRC_STORAGE_KEY_TRANSFORM_H_
 
 #include <string>
+#include <utility>
+#include <vector>
 #include "base/endianconv.h"
 #include "rocksdb/slice.h"
 
@@ -25,6 +27,7 @@ namespace storage {
 
 static constexpr uint32_t TS_LEN = sizeof(uint64_t);
 static constexpr uint32_t TS_POS_LEN = sizeof(uint32_t);
+static constexpr uint32_t ROW_ID_LEN = sizeof(uint64_t);
 
 static inline int ParseKeyAndTs(bool has_ts_idx, const rocksdb::Slice& s,
         rocksdb::Slice* key, uint64_t* ts, uint32_t* ts_idx) {
@@ -79,6 +82,78 @@ static inline std::string CombineKeyTs(const rocksdb::Slice& key, uint64_t ts, u
     return result;
 }
 
+// the row ids of the row column family are big endian, so the rows are in the order of ids
+static inline std::string EncodeRowId(uint64_t row_id) {
+    std::string result(ROW_ID_LEN, '\0');
+    for (int i = ROW_ID_LEN - 1; i >= 0; i--) {
+        result[i] = static_cast<char>(row_id & 0xff);
+        row_id >>= 8;
+    }
+    return result;
+}
+
+static inline uint64_t DecodeRowId(const rocksdb::Slice& s) {
+    uint64_t row_id = 0;
+    for (uint32_t i = 0; i < ROW_ID_LEN && i < s.size(); i++) {
+        row_id = (row_id << 8) | static_cast<uint8_t>(s[i]);
+    }
+    return row_id;
+}
+
+// a record of the row column family is the index entries holding the row id followed by the row
+// ref cnt (4 bytes) | [inner pos (4 bytes) | key size (4 bytes) | key] ... | row
+static inline std::string EncodeRowRecord(const std::vector<std::pair<uint32_t, std::string>>& refs,
+        const rocksdb::Slice& row) {
+    uint32_t size = TS_POS_LEN + row.size();
+    for (const auto& ref : refs) {
+        size += TS_POS_LEN * 2 + ref.second.size();
+    }
+    std::string result;
+    result.reserve(size);
+    uint32_t ref_cnt = refs.size();
+    result.append(reinterpret_cast<const char*>(&ref_cnt), TS_POS_LEN);
+    for (const auto& ref : refs) {
+        uint32_t key_size = ref.second.size();
+        result.append(reinterpret_cast<const char*>(&ref.first), TS_POS_LEN);
+        result.append(reinterpret_cast<const char*>(&key_size), TS_POS_LEN);
+        result.append(ref.second);
+    }
+    result.append(row.data(), row.size());
+    return result;
+}
+
+// refs can be nullptr if only the row is needed
+static inline bool ParseRowRecord(const rocksdb::Slice& record,
+        std::vector<std::pair<uint32_t, rocksdb::Slice>>* refs, rocksdb::Slice* row) {
+    if (record.size() < TS_POS_LEN) {
+        return false;
+    }
+    const char* cur = record.data();
+    const char* end = record.data() + record.size();
+    uint32_t ref_cnt = 0;
+    memcpy(&ref_cnt, cur, TS_POS_LEN);
+    cur += TS_POS_LEN;
+    for (uint32_t i = 0; i < ref_cnt; i++) {
+        uint32_t inner_pos = 0;
+        uint32_t key_size = 0;
+        if (static_cast<uint64_t>(end - cur) < TS_POS_LEN * 2) {
+            return false;
+        }
+        memcpy(&inner_pos, cur, TS_POS_LEN);
+        memcpy(&key_size, cur + TS_POS_LEN, TS_POS_LEN);
+        cur += TS_POS_LEN * 2;
+        if (static_cast<uint64_t>(end - cur) < key_size) {
+            return false;
+        }
+        if (refs != nullptr) {
+            refs->emplace_back(inner_pos, rocksdb::Slice(cur, key_size));
+        }
+        cur += key_size;
+    }
+    *row = rocksdb::Slice(cur, end - cur);
+    return true;
+}
+
 }  // namespace storage
 }  // namespace openmldb
 #endif  // SRC_STORAGE_KEY_TRANSFORM_H_
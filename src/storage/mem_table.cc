@@ -19,10 +19,13 @@
 #include <snappy.h>
 
 #include <algorithm>
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
 #include <utility>
 
 #include "base/glog_wrapper.h"
 #include "base/hash.h"
+#include "base/numa_util.h"
 #include "base/slice.h"
 #include "common/timer.h"
 #include "gflags/gflags.h"
@@ -35,6 +38,13 @@ DECLARE_uint32(skiplist_max_height);
 DECLARE_uint32(key_entry_max_height);
 DECLARE_uint32(absolute_default_skiplist_height);
 DECLARE_uint32(latest_default_skiplist_height);
+DECLARE_bool(enable_memtable_slab);
+DECLARE_bool(enable_numa_placement);
+DECLARE_uint64(gc_slice_key_num);
+DECLARE_uint32(gc_slice_time_ms);
+DECLARE_uint32(gc_slice_interval_ms);
+DECLARE_uint32(gc_round_time_ms);
+DECLARE_uint32(gc_segment_thread_num);
 
 namespace openmldb {
 namespace storage {
@@ -111,6 +121,19 @@ bool MemTable::Init() {
         return false;
     }
 
+    if (FLAGS_enable_numa_placement) {
+        numa_node_ = base::NumaTopology::Get().GetNodeOfPartition(pid_);
+    }
+    // the rows and skiplist nodes are placed on the numa node by the slab. the key entries, the pk copies and the
+    // key index are allocated by malloc and not bound. the new pages take the node of the thread that touches them
+    // first, which runs on the node of the partition unless its workers were full, see TabletImpl::DispatchToNumaNode
+    if (FLAGS_enable_memtable_slab || numa_node_ >= 0) {
+        // segments with the same seg idx share one slab, rows put into multi indexes are allocated from the slab
+        // of the first index, so the slab must be alive until all the segments are released
+        for (uint32_t j = 0; j < seg_cnt_; j++) {
+            slabs_.push_back(std::make_shared<base::SlabAllocator>(numa_node_));
+        }
+    }
     auto inner_indexs = table_index_.GetAllInnerIndex();
     for (uint32_t i = 0; i < inner_indexs->size(); i++) {
         const std::vector<uint32_t>& ts_vec = inner_indexs->at(i)->GetTsIdx();
@@ -119,13 +142,13 @@ bool MemTable::Init() {
         Segment** seg_arr = new Segment*[seg_cnt_];
         if (!ts_vec.empty()) {
             for (uint32_t j = 0; j < seg_cnt_; j++) {
-                seg_arr[j] = new Segment(cur_key_entry_max_height, ts_vec);
+                seg_arr[j] = new Segment(cur_key_entry_max_height, ts_vec, GetSlab(j));
                 PDLOG(INFO, "init %u, %u segment. height %u, ts col num %u. tid %u pid %u", i, j,
                       cur_key_entry_max_height, ts_vec.size(), id_, pid_);
             }
         } else {
             for (uint32_t j = 0; j < seg_cnt_; j++) {
-                seg_arr[j] = new Segment(cur_key_entry_max_height);
+                seg_arr[j] = new Segment(cur_key_entry_max_height, GetSlab(j));
                 PDLOG(INFO, "init %u, %u segment. height %u tid %u pid %u", i, j, cur_key_entry_max_height, id_, pid_);
             }
         }
@@ -154,18 +177,93 @@ bool MemTable::Put(const std::string& pk, uint64_t time, const char* data, uint3
 }
 
 absl::Status MemTable::Put(uint64_t time, const std::string& value, const Dimensions& dimensions, bool put_if_absent) {
+    std::map<int32_t, Slice> inner_index_key_map;
+    std::map<uint32_t, std::map<int32_t, uint64_t>> ts_value_map;
+    uint32_t real_ref_cnt = 0;
+    if (auto status = ParseIndexEntries(time, value, dimensions, &inner_index_key_map, &ts_value_map, &real_ref_cnt);
+        !status.ok()) {
+        return status;
+    }
+    DataBlock* block = nullptr;
+    for (const auto& kv : inner_index_key_map) {
+        auto iter = ts_value_map.find(kv.first);
+        if (iter == ts_value_map.end()) {
+            continue;
+        }
+        uint32_t seg_idx = 0;
+        if (seg_cnt_ > 1) {
+            seg_idx = ::openmldb::base::hash(kv.second.data(), kv.second.size(), SEED) % seg_cnt_;
+        }
+        Segment* segment = segments_[kv.first][seg_idx];
+        if (block == nullptr) {
+            block = new DataBlock(real_ref_cnt, value.c_str(), value.length(), segment->GetSlab());
+        }
+        if (!segment->Put(kv.second, iter->second, block, put_if_absent)) {
+            return absl::AlreadyExistsError("data exists");  // let caller know exists
+        }
+    }
+    record_byte_size_.fetch_add(GetRecordSize(value.length()));
+    return absl::OkStatus();
+}
+
+void MemTable::PutBatch(const std::vector<::openmldb::api::LogEntry>& entries, bool put_if_absent,
+                        std::vector<absl::Status>* status) {
+    if (put_if_absent) {
+        // the existence check of a row must see the rows put before it
+        Table::PutBatch(entries, put_if_absent, status);
+        return;
+    }
+    status->assign(entries.size(), absl::OkStatus());
+    std::vector<std::map<int32_t, Slice>> key_maps(entries.size());
+    std::vector<std::map<uint32_t, std::map<int32_t, uint64_t>>> ts_value_maps(entries.size());
+    // group the index entries by segment, so that each segment is locked once for the batch
+    std::map<Segment*, std::vector<SegmentPutRow>> segment_rows;
+    for (size_t i = 0; i < entries.size(); i++) {
+        const auto& entry = entries[i];
+        uint32_t real_ref_cnt = 0;
+        (*status)[i] = ParseIndexEntries(entry.ts(), entry.value(), entry.dimensions(), &key_maps[i],
+                                         &ts_value_maps[i], &real_ref_cnt);
+        if (!(*status)[i].ok()) {
+            continue;
+        }
+        DataBlock* block = nullptr;
+        for (const auto& kv : key_maps[i]) {
+            auto iter = ts_value_maps[i].find(kv.first);
+            if (iter == ts_value_maps[i].end()) {
+                continue;
+            }
+            uint32_t seg_idx = 0;
+            if (seg_cnt_ > 1) {
+                seg_idx = ::openmldb::base::hash(kv.second.data(), kv.second.size(), SEED) % seg_cnt_;
+            }
+            Segment* segment = segments_[kv.first][seg_idx];
+            if (block == nullptr) {
+                block = new DataBlock(real_ref_cnt, entry.value().c_str(), entry.value().length(), segment->GetSlab());
+            }
+            segment_rows[segment].push_back({kv.second, &iter->second, block});
+        }
+        record_byte_size_.fetch_add(GetRecordSize(entry.value().length()));
+    }
+    for (const auto& kv : segment_rows) {
+        kv.first->Put(kv.second);
+    }
+}
+
+absl::Status MemTable::ParseIndexEntries(uint64_t time, const std::string& value, const Dimensions& dimensions,
+                                         std::map<int32_t, Slice>* inner_index_key_map,
+                                         std::map<uint32_t, std::map<int32_t, uint64_t>>* ts_value_map,
+                                         uint32_t* ref_cnt) {
     if (dimensions.empty()) {
         PDLOG(WARNING, "empty dimension. tid %u pid %u", id_, pid_);
         return absl::InvalidArgumentError(absl::StrCat(id_, ".", pid_, ": empty dimension"));
     }
     // inner index pos: -1 means invalid, so it's positive in inner_index_key_map
-    std::map<int32_t, Slice> inner_index_key_map;
     for (auto iter = dimensions.begin(); iter != dimensions.end(); iter++) {
         int32_t inner_pos = table_index_.GetInnerIndexPos(iter->idx());
         if (inner_pos < 0) {
             return absl::InvalidArgumentError(absl::StrCat(id_, ".", pid_, ": invalid dimension idx ", iter->idx()));
         }
-        inner_index_key_map.emplace(inner_pos, iter->key());
+        inner_index_key_map->emplace(inner_pos, iter->key());
     }
     uint32_t real_ref_cnt = 0;
     const int8_t* data = reinterpret_cast<const int8_t*>(value.data());
@@ -185,8 +283,7 @@ absl::Status MemTable::Put(uint64_t time, const std::string& value, const Dimens
     if (decoder == nullptr) {
         return absl::InvalidArgumentError(absl::StrCat(id_, ".", pid_, ": invalid schema version ", version));
     }
-    std::map<uint32_t, std::map<int32_t, uint64_t>> ts_value_map;
-    for (const auto& kv : inner_index_key_map) {
+    for (const auto& kv : *inner_index_key_map) {
         auto inner_index = table_index_.GetInnerIndex(kv.first);
         if (!inner_index) {
             return absl::InvalidArgumentError(absl::StrCat(id_, ".", pid_, ": invalid inner index pos ", kv.first));
@@ -213,28 +310,13 @@ absl::Status MemTable::Put(uint64_t time, const std::string& value, const Dimens
             }
         }
         if (!ts_map.empty()) {
-            ts_value_map.emplace(kv.first, std::move(ts_map));
+            ts_value_map->emplace(kv.first, std::move(ts_map));
         }
     }
-    if (ts_value_map.empty()) {
+    if (ts_value_map->empty()) {
         return absl::InvalidArgumentError(absl::StrCat(id_, ".", pid_, ": empty ts value map"));
     }
-    auto* block = new DataBlock(real_ref_cnt, value.c_str(), value.length());
-    for (const auto& kv : inner_index_key_map) {
-        auto iter = ts_value_map.find(kv.first);
-        if (iter == ts_value_map.end()) {
-            continue;
-        }
-        uint32_t seg_idx = 0;
-        if (seg_cnt_ > 1) {
-            seg_idx = ::openmldb::base::hash(kv.second.data(), kv.second.size(), SEED) % seg_cnt_;
-        }
-        Segment* segment = segments_[kv.first][seg_idx];
-        if (!segment->Put(kv.second, iter->second, block, put_if_absent)) {
-            return absl::AlreadyExistsError("data exists");  // let caller know exists
-        }
-    }
-    record_byte_size_.fetch_add(GetRecordSize(value.length()));
+    *ref_cnt = real_ref_cnt;
     return absl::OkStatus();
 }
 
@@ -319,8 +401,9 @@ void MemTable::SchedGc() {
     uint64_t consumed = ::baidu::common::timer::get_micros();
     PDLOG(INFO, "start making gc for table %s, tid %u, pid %u", name_.c_str(), id_, pid_);
     auto inner_indexs = table_index_.GetAllInnerIndex();
-    uint64_t gc_idx_cnt = 0;
-    uint64_t gc_record_byte_size = 0;
+    uint64_t round_deadline = FLAGS_gc_round_time_ms == 0 ? 0 : consumed + FLAGS_gc_round_time_ms * 1000ull;
+    std::atomic<uint64_t> gc_idx_cnt = 0;
+    std::atomic<uint64_t> gc_record_byte_size = 0;
     for (uint32_t i = 0; i < inner_indexs->size(); i++) {
         const std::vector<std::shared_ptr<IndexDef>>& real_index = inner_indexs->at(i)->GetIndex();
         std::map<uint32_t, TTLSt> ttl_st_map;
@@ -352,8 +435,8 @@ void MemTable::SchedGc() {
                         } else {
                             segments_[i][k]->ReleaseAndCount(deleting_pos, &statistics_info);
                         }
-                        gc_idx_cnt += statistics_info.GetTotalCnt();
-                        gc_record_byte_size += statistics_info.record_byte_size;
+                        gc_idx_cnt.fetch_add(statistics_info.GetTotalCnt(), std::memory_order_relaxed);
+                        gc_record_byte_size.fetch_add(statistics_info.record_byte_size, std::memory_order_relaxed);
                     }
                 }
             }
@@ -368,31 +451,69 @@ void MemTable::SchedGc() {
         if (deleted_num == real_index.size() || ttl_st_map.empty()) {
             continue;
         }
-        for (uint32_t j = 0; j < seg_cnt_; j++) {
-            uint64_t seg_gc_time = ::baidu::common::timer::get_micros() / 1000;
-            Segment* segment = segments_[i][j];
-            StatisticsInfo statistics_info(segment->GetTsCnt());
-            segment->IncrGcVersion();
-            segment->GcFreeList(&statistics_info);
-            if (ttl_st_map.size() == 1) {
-                segment->ExecuteGc(ttl_st_map.begin()->second, &statistics_info);
-            } else {
-                segment->ExecuteGc(ttl_st_map, &statistics_info);
+        // the segments are taken by the threads one by one
+        std::atomic<uint32_t> next_seg_idx = 0;
+        auto gc_segments = [&, i] {
+            for (uint32_t j = next_seg_idx.fetch_add(1); j < seg_cnt_; j = next_seg_idx.fetch_add(1)) {
+                StatisticsInfo statistics_info(segments_[i][j]->GetTsCnt());
+                GcSegment(i, j, ttl_st_map, round_deadline, &statistics_info);
+                gc_idx_cnt.fetch_add(statistics_info.GetTotalCnt(), std::memory_order_relaxed);
+                gc_record_byte_size.fetch_add(statistics_info.record_byte_size, std::memory_order_relaxed);
             }
-            gc_idx_cnt += statistics_info.GetTotalCnt();
-            gc_record_byte_size += statistics_info.record_byte_size;
-            seg_gc_time = ::baidu::common::timer::get_micros() / 1000 - seg_gc_time;
-            PDLOG(INFO, "gc segment[%u][%u] done consumed %lu for table %s tid %u pid %u", i, j, seg_gc_time,
-                  name_.c_str(), id_, pid_);
+        };
+        uint32_t thread_num = std::min(std::max(FLAGS_gc_segment_thread_num, 1u), seg_cnt_);
+        std::vector<std::thread> threads;
+        for (uint32_t t = 1; t < thread_num; t++) {
+            threads.emplace_back(gc_segments);
+        }
+        gc_segments();
+        for (auto& thread : threads) {
+            thread.join();
         }
     }
     consumed = ::baidu::common::timer::get_micros() - consumed;
-    record_byte_size_.fetch_sub(gc_record_byte_size, std::memory_order_relaxed);
-    PDLOG(INFO, "gc finished, gc_idx_cnt %lu, consumed %lu ms for table %s tid %u pid %u", gc_idx_cnt, consumed / 1000,
-          name_.c_str(), id_, pid_);
+    record_byte_size_.fetch_sub(gc_record_byte_size.load(), std::memory_order_relaxed);
+    PDLOG(INFO, "gc finished, gc_idx_cnt %lu, consumed %lu ms for table %s tid %u pid %u", gc_idx_cnt.load(),
+          consumed / 1000, name_.c_str(), id_, pid_);
     UpdateTTL();
 }
 
+void MemTable::GcSegment(uint32_t idx, uint32_t seg_idx, const std::map<uint32_t, TTLSt>& ttl_st_map,
+                         uint64_t round_deadline, StatisticsInfo* statistics_info) {
+    uint64_t seg_gc_time = ::baidu::common::timer::get_micros() / 1000;
+    Segment* segment = segments_[idx][seg_idx];
+    GcBudget budget{FLAGS_gc_slice_key_num, FLAGS_gc_slice_time_ms * 1000ull};
+    segment->IncrGcVersion();
+    segment->GcFreeList(statistics_info);
+    uint32_t slice_cnt = 0;
+    uint64_t visited_key_cnt = 0;
+    while (true) {
+        if (ttl_st_map.size() == 1) {
+            segment->ExecuteGc(ttl_st_map.begin()->second, statistics_info, budget);
+        } else {
+            segment->ExecuteGc(ttl_st_map, statistics_info, std::nullopt, budget);
+        }
+        slice_cnt++;
+        visited_key_cnt += segment->GetGcVisitedKeyCnt();
+        if (segment->IsGcPassFinished()) {
+            segment->RebuildKeyFilter();
+            break;
+        }
+        if (!enable_gc_.load(std::memory_order_relaxed) ||
+            (round_deadline > 0 && ::baidu::common::timer::get_micros() >= round_deadline)) {
+            break;
+        }
+        // the puts take the segment lock between the slices
+        std::this_thread::sleep_for(std::chrono::milliseconds(FLAGS_gc_slice_interval_ms));
+    }
+    seg_gc_time = ::baidu::common::timer::get_micros() / 1000 - seg_gc_time;
+    PDLOG(INFO,
+          "gc segment[%u][%u] done consumed %lu in %u slices, visited %lu keys, pass finished %d for table %s tid %u "
+          "pid %u",
+          idx, seg_idx, seg_gc_time, slice_cnt, visited_key_cnt, segment->IsGcPassFinished(), name_.c_str(), id_,
+          pid_);
+}
+
 // tll as ms
 uint64_t MemTable::GetExpireTime(const TTLSt& ttl_st) {
     if (!enable_gc_.load(std::memory_order_relaxed) || ttl_st.abs_ttl == 0 ||
@@ -514,6 +635,22 @@ int MemTable::GetCount(uint32_t index, const std::string& pk, uint64_t& count) {
     return segment->GetCount(spk, count);
 }
 
+int MemTable::GetPutCount(uint32_t index, const std::string& pk, uint64_t& put_cnt, uint64_t& delete_cnt) {
+    std::shared_ptr<IndexDef> index_def = table_index_.GetIndex(index);
+    if (!index_def || !index_def->IsReady()) {
+        return -1;
+    }
+    uint32_t seg_idx = 0;
+    if (seg_cnt_ > 1) {
+        seg_idx = ::openmldb::base::hash(pk.c_str(), pk.length(), SEED) % seg_cnt_;
+    }
+    Segment* segment = segments_[index_def->GetInnerPos()][seg_idx];
+    auto ts_col = index_def->GetTsColumn();
+    // read before the rows, a delete missed here is seen by the next read
+    delete_cnt = segment->GetDeleteCount();
+    return segment->GetPutCount(Slice(pk), ts_col ? ts_col->GetId() : 0, put_cnt);
+}
+
 TableIterator* MemTable::NewIterator(const std::string& pk, Ticket& ticket) { return NewIterator(0, pk, ticket); }
 
 TableIterator* MemTable::NewIterator(uint32_t index, const std::string& pk, Ticket& ticket) {
@@ -536,6 +673,18 @@ TableIterator* MemTable::NewIterator(uint32_t index, const std::string& pk, Tick
     return segment->NewIterator(spk, ticket, GetCompressType());
 }
 
+bool MemTable::KeyMayExist(uint32_t index, const std::string& pk) {
+    std::shared_ptr<IndexDef> index_def = table_index_.GetIndex(index);
+    if (!index_def || !index_def->IsReady()) {
+        return true;
+    }
+    uint32_t seg_idx = 0;
+    if (seg_cnt_ > 1) {
+        seg_idx = ::openmldb::base::hash(pk.c_str(), pk.length(), SEED) % seg_cnt_;
+    }
+    return segments_[index_def->GetInnerPos()][seg_idx]->KeyMayExist(Slice(pk));
+}
+
 uint64_t MemTable::GetRecordIdxByteSize() {
     uint64_t record_idx_byte_size = 0;
     auto inner_indexs = table_index_.GetAllInnerIndex();
@@ -635,7 +784,7 @@ bool MemTable::AddIndexToTable(const std::shared_ptr<IndexDef>& index_def) {
     uint32_t inner_id = index_def->GetInnerPos();
     Segment** seg_arr = new Segment*[seg_cnt_];
     for (uint32_t j = 0; j < seg_cnt_; j++) {
-        seg_arr[j] = new Segment(FLAGS_absolute_default_skiplist_height, ts_vec);
+        seg_arr[j] = new Segment(FLAGS_absolute_default_skiplist_height, ts_vec, GetSlab(j));
         PDLOG(INFO, "init %u, %u segment. height %u, ts col num %u. tid %u pid %u", inner_id, j,
               FLAGS_absolute_default_skiplist_height, ts_vec.size(), id_, pid_);
     }
@@ -54,6 +54,9 @@ class MemTable : public Table {
     absl::Status Put(uint64_t time, const std::string& value, const Dimensions& dimensions,
                      bool put_if_absent) override;
 
+    void PutBatch(const std::vector<::openmldb::api::LogEntry>& entries, bool put_if_absent,
+                  std::vector<absl::Status>* status) override;
+
     virtual bool GetBulkLoadInfo(::openmldb::api::BulkLoadInfoResponse* response);
 
     virtual bool BulkLoad(const std::vector<DataBlock*>& data_blocks,
@@ -70,6 +73,8 @@ class MemTable : public Table {
 
     ::hybridse::vm::WindowIterator* NewWindowIterator(uint32_t index) override;
 
+    bool KeyMayExist(uint32_t index, const std::string& pk) override;
+
     // release all memory allocated
     uint64_t Release();
 
@@ -77,6 +82,9 @@ class MemTable : public Table {
 
     int GetCount(uint32_t index, const std::string& pk, uint64_t& count) override;  // NOLINT
 
+    int GetPutCount(uint32_t index, const std::string& pk, uint64_t& put_cnt,  // NOLINT
+                    uint64_t& delete_cnt) override;                            // NOLINT
+
     uint64_t GetRecordIdxCnt() override;
     bool GetRecordIdxCnt(uint32_t idx, uint64_t** stat, uint32_t* size) override;
     uint64_t GetRecordIdxByteSize() override;
@@ -101,6 +109,9 @@ class MemTable : public Table {
 
     inline uint32_t GetKeyEntryHeight() const { return key_entry_max_height_; }
 
+    // the numa node the memory is placed on, -1 if numa placement is disabled
+    int GetNumaNode() const { return numa_node_; }
+
  protected:
     bool AddIndexToTable(const std::shared_ptr<IndexDef>& index_def) override;
 
@@ -112,10 +123,24 @@ class MemTable : public Table {
     }
     Segment** GetSegments(uint32_t real_idx) { return segments_[real_idx]; }
 
+    std::shared_ptr<base::SlabAllocator> GetSlab(uint32_t seg_idx) {
+        return seg_idx < slabs_.size() ? slabs_[seg_idx] : nullptr;
+    }
+
     bool InitMeta();
     uint32_t KeyEntryMaxHeight(const std::shared_ptr<InnerIndexSt>& inner_idx);
 
+    // get the key of each inner index and the ts values of its ready indexes from a row to put,
+    // ref_cnt is the number of index entries referring to the row
+    absl::Status ParseIndexEntries(uint64_t time, const std::string& value, const Dimensions& dimensions,
+                                   std::map<int32_t, Slice>* inner_index_key_map,
+                                   std::map<uint32_t, std::map<int32_t, uint64_t>>* ts_value_map, uint32_t* ref_cnt);
+
  private:
+    // gc segments_[idx][seg_idx] slice by slice until its pass finishes or the round deadline passes
+    void GcSegment(uint32_t idx, uint32_t seg_idx, const std::map<uint32_t, TTLSt>& ttl_st_map,
+                   uint64_t round_deadline, StatisticsInfo* statistics_info);
+
     bool CheckAbsolute(const TTLSt& ttl, uint64_t ts);
 
     bool CheckLatest(uint32_t index_id, const std::string& key, uint64_t ts);
@@ -126,11 +151,14 @@ class MemTable : public Table {
  protected:
     uint32_t seg_cnt_;
     std::vector<Segment**> segments_;
+    // one slab per seg idx, empty if enable_memtable_slab is false
+    std::vector<std::shared_ptr<base::SlabAllocator>> slabs_;
     std::atomic<bool> enable_gc_;
     uint64_t ttl_offset_;
     bool segment_released_;
     std::atomic<uint64_t> record_byte_size_;
     uint32_t key_entry_max_height_;
+    int numa_node_ = -1;
 };
 
 }  // namespace storage
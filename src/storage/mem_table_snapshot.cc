@@ -48,6 +48,8 @@ DECLARE_uint32(load_table_batch);
 DECLARE_uint32(load_table_thread_num);
 DECLARE_uint32(load_table_queue_size);
 DECLARE_string(snapshot_compression);
+DECLARE_string(snapshot_format);
+DECLARE_uint32(snapshot_max_delta_num);
 
 namespace openmldb {
 namespace storage {
@@ -97,16 +99,13 @@ bool DataReader::Init() {
             return false;
         } else if (ret == 0) {
             snapshot_offset = manifest.offset();
-            std::string path = absl::StrCat(snapshot_path_, "/", manifest.name());
-            FILE* fd = fopen(path.c_str(), "rb");
-            if (fd == nullptr) {
-                PDLOG(WARNING, "fail to open path %s for error %s", path.c_str(), strerror(errno));
+            snapshot_files_.push_back(manifest.name());
+            for (const auto& delta : manifest.deltas()) {
+                snapshot_files_.push_back(delta.name());
+            }
+            if (!OpenSnapshot()) {
                 return false;
             }
-            seq_file_.reset(::openmldb::log::NewSeqFile(path, fd));
-            bool compressed = IsCompressed(path);
-            snapshot_reader_ = std::make_shared<::openmldb::log::Reader>(
-                    seq_file_.get(), nullptr, false, 0, compressed);
             read_snapshot_ = true;
         }
     }
@@ -122,20 +121,58 @@ bool DataReader::Init() {
     return true;
 }
 
+bool DataReader::OpenSnapshot() {
+    std::string path = absl::StrCat(snapshot_path_, "/", snapshot_files_[snapshot_file_idx_]);
+    block_reader_.reset();
+    snapshot_reader_.reset();
+    seq_file_.reset();
+    if (IsBlockSnapshot(path)) {
+        block_reader_ = std::make_shared<BlockSnapshotReader>(path);
+        auto status = block_reader_->Open();
+        if (!status.ok()) {
+            PDLOG(WARNING, "fail to open block snapshot %s. error %s", path.c_str(), status.ToString().c_str());
+            return false;
+        }
+        block_chunk_ = BlockChunk();
+        block_chunk_idx_ = 0;
+        block_record_idx_ = 0;
+    } else {
+        FILE* fd = fopen(path.c_str(), "rb");
+        if (fd == nullptr) {
+            PDLOG(WARNING, "fail to open path %s for error %s", path.c_str(), strerror(errno));
+            return false;
+        }
+        seq_file_.reset(::openmldb::log::NewSeqFile(path, fd));
+        bool compressed = IsCompressed(path);
+        snapshot_reader_ = std::make_shared<::openmldb::log::Reader>(seq_file_.get(), nullptr, false, 0, compressed);
+    }
+    return true;
+}
+
 bool DataReader::ReadFromSnapshot() {
-    if (!read_snapshot_) {
-        return false;
+    while (read_snapshot_) {
+        bool has_record = block_reader_ ? ReadFromBlockSnapshot() : ReadFromLogSnapshot();
+        if (has_record) {
+            return true;
+        }
+        // go on with the next delta of the chain
+        if (++snapshot_file_idx_ >= snapshot_files_.size() || !OpenSnapshot()) {
+            read_snapshot_ = false;
+        }
     }
+    return false;
+}
+
+bool DataReader::ReadFromLogSnapshot() {
     do {
         buffer_.clear();
         record_.clear();
         auto status = snapshot_reader_->ReadRecord(&record_, &buffer_);
         if (status.IsWaitRecord() || status.IsEof()) {
-            PDLOG(INFO, "read snapshot completed, succ_cnt %lu, failed_cnt %lu, path %s",
-                    succ_cnt_, failed_cnt_, snapshot_path_.c_str());
+            PDLOG(INFO, "read snapshot completed, succ_cnt %lu, failed_cnt %lu, path %s%s",
+                    succ_cnt_, failed_cnt_, snapshot_path_.c_str(), snapshot_files_[snapshot_file_idx_].c_str());
             succ_cnt_ = 0;
             failed_cnt_ = 0;
-            read_snapshot_ = false;
             return false;
         }
         if (!status.ok()) {
@@ -145,6 +182,7 @@ bool DataReader::ReadFromSnapshot() {
             continue;
         }
         entry_buff_.assign(record_.data(), record_.size());
+        entry_buff_valid_ = true;
         if (!entry_.ParseFromString(entry_buff_)) {
             PDLOG(WARNING, "fail to parse record. path %s", snapshot_path_);
             failed_cnt_++;
@@ -156,6 +194,31 @@ bool DataReader::ReadFromSnapshot() {
     return true;
 }
 
+bool DataReader::ReadFromBlockSnapshot() {
+    while (block_record_idx_ >= block_chunk_.GetRecordCnt()) {
+        if (block_chunk_idx_ >= block_reader_->GetChunkCnt()) {
+            PDLOG(INFO, "read block snapshot completed, succ_cnt %lu, failed_cnt %lu, path %s%s",
+                    succ_cnt_, failed_cnt_, snapshot_path_.c_str(), snapshot_files_[snapshot_file_idx_].c_str());
+            succ_cnt_ = 0;
+            failed_cnt_ = 0;
+            return false;
+        }
+        uint32_t idx = block_chunk_idx_++;
+        block_record_idx_ = 0;
+        auto status = block_reader_->ReadChunk(idx, &block_buf_, &block_chunk_);
+        if (!status.ok()) {
+            PDLOG(WARNING, "fail to read chunk %u. path %s, error %s", idx, snapshot_path_.c_str(),
+                    status.ToString().c_str());
+            failed_cnt_ += block_reader_->GetChunkRecordCnt(idx);
+            block_chunk_ = BlockChunk();
+        }
+    }
+    block_chunk_.GetLogEntry(block_record_idx_++, &entry_);
+    entry_buff_valid_ = false;
+    succ_cnt_++;
+    return true;
+}
+
 bool DataReader::ReadFromBinlog() {
     if (!read_binlog_) {
         return false;
@@ -190,6 +253,7 @@ bool DataReader::ReadFromBinlog() {
             continue;
         }
         entry_buff_.assign(record_.data(), record_.size());
+        entry_buff_valid_ = true;
         if (!entry_.ParseFromString(entry_buff_)) {
             PDLOG(WARNING, "fail to parse record. path %s", log_path_.c_str());
             failed_cnt_++;
@@ -327,29 +391,48 @@ bool MemTableSnapshot::Recover(std::shared_ptr<Table> table, uint64_t& latest_of
         return false;
     }
     if (ret == 0) {
-        RecoverFromSnapshot(manifest.name(), manifest.count(), table);
+        // the count of manifest is of the whole chain
+        uint64_t base_cnt = manifest.count();
+        for (const auto& delta : manifest.deltas()) {
+            base_cnt -= delta.count();
+        }
+        if (!RecoverFromSnapshot(manifest.name(), base_cnt, table)) {
+            return false;
+        }
+        for (const auto& delta : manifest.deltas()) {
+            if (!RecoverFromSnapshot(delta.name(), delta.count(), table)) {
+                return false;
+            }
+        }
         latest_offset = manifest.offset();
         offset_ = latest_offset;
     }
     return true;
 }
 
-void MemTableSnapshot::RecoverFromSnapshot(const std::string& snapshot_name, uint64_t expect_cnt,
+bool MemTableSnapshot::RecoverFromSnapshot(const std::string& snapshot_name, uint64_t expect_cnt,
                                            std::shared_ptr<Table> table) {
     std::string full_path = absl::StrCat(snapshot_path_, "/", snapshot_name);
     std::atomic<uint64_t> g_succ_cnt(0);
     std::atomic<uint64_t> g_failed_cnt(0);
-    RecoverSingleSnapshot(full_path, table, &g_succ_cnt, &g_failed_cnt);
+    if (!RecoverSingleSnapshot(full_path, expect_cnt, table, &g_succ_cnt, &g_failed_cnt)) {
+        return false;
+    }
     PDLOG(INFO, "[Recover] progress done stat: success count %lu, failed count %lu",
           g_succ_cnt.load(std::memory_order_relaxed), g_failed_cnt.load(std::memory_order_relaxed));
     if (g_succ_cnt.load(std::memory_order_relaxed) != expect_cnt) {
         PDLOG(WARNING, "snapshot %s , expect cnt %lu but succ_cnt %lu", snapshot_name.c_str(), expect_cnt,
               g_succ_cnt.load(std::memory_order_relaxed));
     }
+    return true;
 }
 
-void MemTableSnapshot::RecoverSingleSnapshot(const std::string& path, std::shared_ptr<Table> table,
-                                             std::atomic<uint64_t>* g_succ_cnt, std::atomic<uint64_t>* g_failed_cnt) {
+bool MemTableSnapshot::RecoverSingleSnapshot(const std::string& path, uint64_t expect_cnt,
+                                             std::shared_ptr<Table> table, std::atomic<uint64_t>* g_succ_cnt,
+                                             std::atomic<uint64_t>* g_failed_cnt) {
+    if (IsBlockSnapshot(path)) {
+        return RecoverBlockSnapshot(path, expect_cnt, table, g_succ_cnt, g_failed_cnt);
+    }
     ::openmldb::base::TaskPool load_pool_(FLAGS_load_table_thread_num, FLAGS_load_table_batch);
     std::atomic<uint64_t> succ_cnt, failed_cnt;
     succ_cnt = failed_cnt = 0;
@@ -412,6 +495,94 @@ void MemTableSnapshot::RecoverSingleSnapshot(const std::string& path, std::share
         }
     } while (false);
     load_pool_.Stop();
+    return true;
+}
+
+bool MemTableSnapshot::RecoverBlockSnapshot(const std::string& path, uint64_t expect_cnt,
+                                            std::shared_ptr<Table> table, std::atomic<uint64_t>* g_succ_cnt,
+                                            std::atomic<uint64_t>* g_failed_cnt) {
+    if (table == NULL) {
+        PDLOG(WARNING, "table input is NULL");
+        return false;
+    }
+    BlockSnapshotReader reader(path);
+    auto status = reader.Open();
+    if (!status.ok()) {
+        PDLOG(WARNING, "fail to open block snapshot %s for tid %u, pid %u with error %s", path.c_str(), tid_, pid_,
+              status.ToString().c_str());
+        return false;
+    }
+    if (reader.GetRecordCnt() != expect_cnt) {
+        PDLOG(WARNING, "block snapshot %s has %lu records but the manifest expects %lu. tid %u, pid %u",
+              path.c_str(), reader.GetRecordCnt(), expect_cnt, tid_, pid_);
+        return false;
+    }
+    uint64_t consumed = ::baidu::common::timer::now_time();
+    std::atomic<uint32_t> next_chunk(0);
+    std::atomic<uint64_t> succ_cnt(0), failed_cnt(0);
+    uint32_t thread_num = std::max(1u, std::min(FLAGS_load_table_thread_num, reader.GetChunkCnt()));
+    {
+        // every task keeps taking the next chunk until all of them are loaded
+        ::openmldb::base::TaskPool load_pool(thread_num, thread_num);
+        for (uint32_t i = 0; i < thread_num; i++) {
+            load_pool.AddTask(boost::bind(&MemTableSnapshot::PutBlockChunks, this, path, table, &reader,
+                                          &next_chunk, &succ_cnt, &failed_cnt));
+        }
+        load_pool.Stop();
+    }
+    consumed = ::baidu::common::timer::now_time() - consumed;
+    PDLOG(INFO,
+          "read block snapshot %s for table tid %u pid %u completed, "
+          "chunk_cnt %u, succ_cnt %lu, failed_cnt %lu, consumed %us",
+          path.c_str(), tid_, pid_, reader.GetChunkCnt(), succ_cnt.load(std::memory_order_relaxed),
+          failed_cnt.load(std::memory_order_relaxed), consumed);
+    if (g_succ_cnt) {
+        g_succ_cnt->fetch_add(succ_cnt, std::memory_order_relaxed);
+    }
+    if (g_failed_cnt) {
+        g_failed_cnt->fetch_add(failed_cnt, std::memory_order_relaxed);
+    }
+    // a chunk failing the checksum is corruption as well
+    return failed_cnt.load(std::memory_order_relaxed) == 0;
+}
+
+void MemTableSnapshot::PutBlockChunks(const std::string& path, const std::shared_ptr<Table>& table,
+                                      const BlockSnapshotReader* reader, std::atomic<uint32_t>* next_chunk,
+                                      std::atomic<uint64_t>* succ_cnt, std::atomic<uint64_t>* failed_cnt) {
+    std::string buf;
+    std::string value;
+    BlockChunk chunk;
+    Dimensions dimensions;
+    ::openmldb::api::LogEntry entry;
+    while (true) {
+        uint32_t idx = next_chunk->fetch_add(1, std::memory_order_relaxed);
+        if (idx >= reader->GetChunkCnt()) {
+            break;
+        }
+        auto status = reader->ReadChunk(idx, &buf, &chunk);
+        if (!status.ok()) {
+            PDLOG(WARNING, "fail to read chunk %u of %s with error %s", idx, path.c_str(), status.ToString().c_str());
+            failed_cnt->fetch_add(reader->GetChunkRecordCnt(idx), std::memory_order_relaxed);
+            continue;
+        }
+        for (uint32_t i = 0; i < chunk.GetRecordCnt(); i++) {
+            if (chunk.IsDelete(i)) {
+                chunk.GetLogEntry(i, &entry);
+                table->Delete(entry);
+                continue;
+            }
+            // the value and dimensions are copied into the reused buffers, no protobuf parsing
+            auto slice = chunk.GetValue(i);
+            value.assign(slice.data(), slice.size());
+            chunk.GetDimensions(i, &dimensions);
+            table->Put(chunk.GetTs(i), value, dimensions);
+        }
+        uint64_t scount = succ_cnt->fetch_add(chunk.GetRecordCnt(), std::memory_order_relaxed);
+        if (scount / 100000 != (scount + chunk.GetRecordCnt()) / 100000) {
+            PDLOG(INFO, "load snapshot %s with succ_cnt %lu, failed_cnt %lu", path.c_str(),
+                  scount + chunk.GetRecordCnt(), failed_cnt->load(std::memory_order_relaxed));
+        }
+    }
 }
 
 void MemTableSnapshot::Put(std::string& path, std::shared_ptr<Table>& table, std::vector<std::string*> recordPtr,
@@ -438,7 +609,7 @@ void MemTableSnapshot::Put(std::string& path, std::shared_ptr<Table>& table, std
 }
 
 int MemTableSnapshot::TTLSnapshot(std::shared_ptr<Table> table, const ::openmldb::api::Manifest& manifest,
-        const std::shared_ptr<WriteHandle>& wh, MemSnapshotMeta* snapshot_meta) {
+        SnapshotWriter* writer, MemSnapshotMeta* snapshot_meta) {
     auto data_reader = DataReader::CreateDataReader(snapshot_path_, nullptr, "", DataReaderType::kSnapshot);
     if (!data_reader) {
         PDLOG(WARNING, "fail to create data reader. tid %u pid %u", tid_, pid_);
@@ -463,7 +634,7 @@ int MemTableSnapshot::TTLSnapshot(std::shared_ptr<Table> table, const ::openmldb
             snapshot_meta->expired_key_num++;
             continue;
         }
-        auto status = wh->Write(record);
+        auto status = writer->Write(entry, record);
         if (!status.ok()) {
             PDLOG(WARNING, "fail to write snapshot. status[%s]", status.ToString().c_str());
             has_error = true;
@@ -538,22 +709,31 @@ int MemTableSnapshot::MakeSnapshot(std::shared_ptr<Table> table, uint64_t& out_o
         this->making_snapshot_.store(false, std::memory_order_release);
         this->delete_collector_.Clear();
     };
-    MemSnapshotMeta snapshot_meta(GenSnapshotName(), snapshot_path_, FLAGS_snapshot_compression);
-    auto wh = ::openmldb::log::CreateWriteHandle(FLAGS_snapshot_compression,
-            snapshot_meta.snapshot_name, snapshot_meta.tmp_file_path);
-    if (!wh) {
-        PDLOG(WARNING, "fail to create file %s", snapshot_meta.tmp_file_path.c_str());
-        return -1;
-    }
     uint64_t collected_offset = CollectDeletedKey(end_offset);
     uint64_t start_time = ::baidu::common::timer::now_time();
     ::openmldb::api::Manifest manifest;
+    int result = GetLocalManifest(snapshot_path_ + MANIFEST, manifest);
+    bool is_delta = !NeedCompact(result, manifest);
+    bool block_format = FLAGS_snapshot_format == "block";
+    MemSnapshotMeta snapshot_meta(GenSnapshotName(block_format, is_delta), snapshot_path_,
+            FLAGS_snapshot_compression);
+    snapshot_meta.is_delta = is_delta;
+    SnapshotWriter writer;
+    if (block_format) {
+        writer.block_writer = CreateBlockSnapshotWriter(FLAGS_snapshot_compression, snapshot_meta.tmp_file_path);
+    } else {
+        writer.wh = ::openmldb::log::CreateWriteHandle(FLAGS_snapshot_compression,
+                snapshot_meta.snapshot_name, snapshot_meta.tmp_file_path);
+    }
+    if (!writer.IsValid()) {
+        PDLOG(WARNING, "fail to create file %s", snapshot_meta.tmp_file_path.c_str());
+        return -1;
+    }
     bool has_error = false;
     snapshot_meta.term = term;
-    int result = GetLocalManifest(snapshot_path_ + MANIFEST, manifest);
     if (result == 0) {
-        // filter old snapshot
-        if (TTLSnapshot(table, manifest, wh, &snapshot_meta) < 0) {
+        // filter old snapshot into the new base, a delta has the binlog after the chain only
+        if (!is_delta && TTLSnapshot(table, manifest, &writer, &snapshot_meta) < 0) {
             has_error = true;
         }
         snapshot_meta.term = manifest.term();
@@ -609,7 +789,7 @@ int MemTableSnapshot::MakeSnapshot(std::shared_ptr<Table> table, uint64_t& out_o
                 snapshot_meta.expired_key_num++;
                 continue;
             }
-            ::openmldb::log::Status status = wh->Write(record);
+            ::openmldb::log::Status status = writer.Write(entry, record);
             if (!status.ok()) {
                 PDLOG(WARNING, "fail to write snapshot. path[%s] status[%s]",
                         snapshot_meta.tmp_file_path.c_str(), status.ToString().c_str());
@@ -643,11 +823,20 @@ int MemTableSnapshot::MakeSnapshot(std::shared_ptr<Table> table, uint64_t& out_o
             break;
         }
     }
-    wh->EndLog();
-    wh.reset();
+    auto end_status = writer.EndLog();
+    if (!end_status.ok()) {
+        PDLOG(WARNING, "fail to end snapshot. path[%s] status[%s]",
+                snapshot_meta.tmp_file_path.c_str(), end_status.ToString().c_str());
+        has_error = true;
+    }
+    writer.Reset();
     if (has_error) {
         unlink(snapshot_meta.tmp_file_path.c_str());
         return -1;
+    } else if (is_delta && cur_offset == offset_) {
+        // nothing to append to the chain
+        unlink(snapshot_meta.tmp_file_path.c_str());
+        out_offset = offset_;
     } else {
         snapshot_meta.offset = cur_offset;
         uint64_t old_offset = offset_;
@@ -657,10 +846,11 @@ int MemTableSnapshot::MakeSnapshot(std::shared_ptr<Table> table, uint64_t& out_o
             return -1;
         }
         uint64_t consumed = ::baidu::common::timer::now_time() - start_time;
-        PDLOG(INFO, "make snapshot[%s] success. update offset from %lu to %lu."
+        PDLOG(INFO, "make %s[%s] success. update offset from %lu to %lu."
               "use %lu second. write key %lu expired key %lu deleted key %lu",
-              snapshot_meta.snapshot_name.c_str(), old_offset, snapshot_meta.offset, consumed,
-              snapshot_meta.count, snapshot_meta.expired_key_num, snapshot_meta.deleted_key_num);
+              is_delta ? "snapshot delta" : "snapshot", snapshot_meta.snapshot_name.c_str(), old_offset,
+              snapshot_meta.offset, consumed, snapshot_meta.count, snapshot_meta.expired_key_num,
+              snapshot_meta.deleted_key_num);
         out_offset = snapshot_meta.offset;
     }
     return 0;
@@ -740,9 +930,30 @@ int MemTableSnapshot::CheckDeleteAndUpdate(std::shared_ptr<Table> table, openmld
     return 0;
 }
 
-std::string MemTableSnapshot::GenSnapshotName() {
+bool MemTableSnapshot::NeedCompact(int manifest_ret, const ::openmldb::api::Manifest& manifest) const {
+    if (FLAGS_snapshot_max_delta_num == 0 || manifest_ret != 0) {
+        return true;
+    }
+    // a delta can not remove the keys of the files before it, and the expired keys of the chain are removed
+    // only when it is compacted
+    if (!delete_collector_.IsEmpty() || manifest.deltas_size() >= static_cast<int>(FLAGS_snapshot_max_delta_num)) {
+        return true;
+    }
+    // the deltas are merged once they are as large as the base, so each key is rewritten a few times at most
+    uint64_t delta_cnt = 0;
+    for (const auto& delta : manifest.deltas()) {
+        delta_cnt += delta.count();
+    }
+    return delta_cnt * 2 >= manifest.count();
+}
+
+std::string MemTableSnapshot::GenSnapshotName(bool block_format, bool delta) {
     std::string now_time = ::openmldb::base::GetNowTime();
-    std::string snapshot_name = now_time.substr(0, now_time.length() - 2) + ".sdb";
+    std::string snapshot_name = now_time.substr(0, now_time.length() - 2);
+    if (delta) {
+        absl::StrAppend(&snapshot_name, "_", offset_ + 1);
+    }
+    snapshot_name.append(block_format ? BLOCK_SNAPSHOT_SUFFIX : SNAPSHOT_SUBFIX);
     if (FLAGS_snapshot_compression != "off") {
         snapshot_name.append(".");
         snapshot_name.append(FLAGS_snapshot_compression);
@@ -755,12 +966,34 @@ std::string MemTableSnapshot::GenSnapshotName() {
     if (GetLocalManifest(snapshot_path_ + MANIFEST, old_manifest) < 0) {
         return {-1, absl::StrCat("get old manifest failed. snapshot path is ", snapshot_path_)};
     }
+    ::openmldb::api::Manifest manifest;
+    if (snapshot_meta.is_delta) {
+        manifest.CopyFrom(old_manifest);
+        auto delta = manifest.add_deltas();
+        delta->set_name(snapshot_meta.snapshot_name);
+        delta->set_count(snapshot_meta.count);
+        delta->set_offset(snapshot_meta.offset);
+        manifest.set_count(old_manifest.count() + snapshot_meta.count);
+    } else {
+        manifest.set_name(snapshot_meta.snapshot_name);
+        manifest.set_count(snapshot_meta.count);
+    }
+    manifest.set_offset(snapshot_meta.offset);
+    manifest.set_term(snapshot_meta.term);
     if (rename(snapshot_meta.tmp_file_path.c_str(), snapshot_meta.full_path.c_str()) == 0) {
-        if (GenManifest(snapshot_meta) == 0) {
-            // delete old snapshot
-            if (old_manifest.has_name() && old_manifest.name() != snapshot_meta.snapshot_name) {
-                DEBUGLOG("old snapshot[%s] has deleted", old_manifest.name().c_str());
-                unlink((snapshot_path_ + old_manifest.name()).c_str());
+        if (GenManifest(manifest) == 0) {
+            // delete old snapshot and its deltas, a new base replaces the whole chain
+            if (!snapshot_meta.is_delta) {
+                if (old_manifest.has_name() && old_manifest.name() != snapshot_meta.snapshot_name) {
+                    DEBUGLOG("old snapshot[%s] has deleted", old_manifest.name().c_str());
+                    unlink((snapshot_path_ + old_manifest.name()).c_str());
+                }
+                for (const auto& delta : old_manifest.deltas()) {
+                    if (delta.name() != snapshot_meta.snapshot_name) {
+                        DEBUGLOG("old snapshot delta[%s] has deleted", delta.name().c_str());
+                        unlink((snapshot_path_ + delta.name()).c_str());
+                    }
+                }
             }
             offset_ = snapshot_meta.offset;
         } else {
@@ -33,6 +33,7 @@
 #include "log/log_writer.h"
 #include "log/sequential_file.h"
 #include "proto/tablet.pb.h"
+#include "storage/block_snapshot.h"
 #include "storage/snapshot.h"
 
 namespace openmldb {
@@ -55,12 +56,31 @@ struct MemSnapshotMeta : SnapshotMeta {
 
     uint64_t expired_key_num = 0;
     uint64_t deleted_key_num = 0;
+    // the snapshot is appended to the chain of the manifest instead of replacing it
+    bool is_delta = false;
     std::string snapshot_compression;
     std::string snapshot_name_tmp;
     std::string full_path;
     std::string tmp_file_path;
 };
 
+// SnapshotWriter writes the records in log format or block format, only one of the handles is set
+struct SnapshotWriter {
+    std::shared_ptr<WriteHandle> wh;
+    std::shared_ptr<BlockSnapshotWriter> block_writer;
+
+    bool IsValid() const { return wh || block_writer; }
+    // record is the serialized entry which is written to the log format snapshot directly
+    ::openmldb::log::Status Write(const ::openmldb::api::LogEntry& entry, const ::openmldb::base::Slice& record) {
+        return block_writer ? block_writer->Write(entry) : wh->Write(record);
+    }
+    ::openmldb::log::Status EndLog() { return block_writer ? block_writer->EndLog() : wh->EndLog(); }
+    void Reset() {
+        wh.reset();
+        block_writer.reset();
+    }
+};
+
 enum class DataReaderType {
     kSnapshot = 1,
     kBinlog = 2,
@@ -85,11 +105,22 @@ class DataReader {
 
     bool HasNext();
     ::openmldb::api::LogEntry& GetValue() { return entry_; }
-    const std::string& GetStrValue() { return entry_buff_; }
+    const std::string& GetStrValue() {
+        // the entry decoded from block snapshot is serialized only when it is required
+        if (!entry_buff_valid_) {
+            entry_.SerializeToString(&entry_buff_);
+            entry_buff_valid_ = true;
+        }
+        return entry_buff_;
+    }
     bool Init();
 
  private:
+    // open the snapshot file of the chain in the manifest at snapshot_file_idx_
+    bool OpenSnapshot();
     bool ReadFromSnapshot();
+    bool ReadFromLogSnapshot();
+    bool ReadFromBlockSnapshot();
     bool ReadFromBinlog();
 
  private:
@@ -102,11 +133,20 @@ class DataReader {
     uint64_t cur_offset_ = 0;
     bool read_snapshot_ = false;
     bool read_binlog_ = false;
+    // the base and deltas of the snapshot, they are read in order
+    std::vector<std::string> snapshot_files_;
+    uint32_t snapshot_file_idx_ = 0;
     std::shared_ptr<::openmldb::log::SequentialFile> seq_file_;
     std::shared_ptr<::openmldb::log::Reader> snapshot_reader_;
     std::shared_ptr<::openmldb::log::LogReader> binlog_reader_;
+    std::shared_ptr<BlockSnapshotReader> block_reader_;
+    BlockChunk block_chunk_;
+    std::string block_buf_;
+    uint32_t block_chunk_idx_ = 0;
+    uint32_t block_record_idx_ = 0;
     std::string buffer_;
     std::string entry_buff_;
+    bool entry_buff_valid_ = false;
     ::openmldb::base::Slice record_;
     ::openmldb::api::LogEntry entry_;
     uint64_t succ_cnt_ = 0;
@@ -150,7 +190,8 @@ class MemTableSnapshot : public Snapshot {
 
     bool Recover(std::shared_ptr<Table> table, uint64_t& latest_offset) override;
 
-    void RecoverFromSnapshot(const std::string& snapshot_name, uint64_t expect_cnt, std::shared_ptr<Table> table);
+    // false if the snapshot is a corrupted block snapshot
+    bool RecoverFromSnapshot(const std::string& snapshot_name, uint64_t expect_cnt, std::shared_ptr<Table> table);
 
     int MakeSnapshot(std::shared_ptr<Table> table,
                      uint64_t& out_offset,  // NOLINT
@@ -158,7 +199,7 @@ class MemTableSnapshot : public Snapshot {
                      uint64_t term = 0) override;
 
     int TTLSnapshot(std::shared_ptr<Table> table, const ::openmldb::api::Manifest& manifest,
-            const std::shared_ptr<WriteHandle>& wh, MemSnapshotMeta* snapshot_meta);
+            SnapshotWriter* writer, MemSnapshotMeta* snapshot_meta);
 
     void Put(std::string& path, std::shared_ptr<Table>& table,  // NOLINT
              std::vector<std::string*> recordPtr, std::atomic<uint64_t>* succ_cnt, std::atomic<uint64_t>* failed_cnt);
@@ -174,12 +215,25 @@ class MemTableSnapshot : public Snapshot {
 
  private:
     // load single snapshot to table
-    void RecoverSingleSnapshot(const std::string& path, std::shared_ptr<Table> table, std::atomic<uint64_t>* g_succ_cnt,
-                               std::atomic<uint64_t>* g_failed_cnt);
+    bool RecoverSingleSnapshot(const std::string& path, uint64_t expect_cnt, std::shared_ptr<Table> table,
+                               std::atomic<uint64_t>* g_succ_cnt, std::atomic<uint64_t>* g_failed_cnt);
+
+    // load the chunks of block snapshot in parallel, false if the file is corrupted or its record count is not
+    // expect_cnt of the manifest
+    bool RecoverBlockSnapshot(const std::string& path, uint64_t expect_cnt, std::shared_ptr<Table> table,
+                              std::atomic<uint64_t>* g_succ_cnt, std::atomic<uint64_t>* g_failed_cnt);
+
+    void PutBlockChunks(const std::string& path, const std::shared_ptr<Table>& table,
+                        const BlockSnapshotReader* reader, std::atomic<uint32_t>* next_chunk,
+                        std::atomic<uint64_t>* succ_cnt, std::atomic<uint64_t>* failed_cnt);
 
     uint64_t CollectDeletedKey(uint64_t end_offset);
 
-    std::string GenSnapshotName();
+    // whether the snapshot chain of manifest is compacted into a new base rather than appended a delta
+    bool NeedCompact(int manifest_ret, const ::openmldb::api::Manifest& manifest) const;
+
+    // the name of a delta has the offset it starts from, so it differs from the base made in the same minute
+    std::string GenSnapshotName(bool block_format = false, bool delta = false);
 
     ::openmldb::base::Status WriteSnapshot(const MemSnapshotMeta& snapshot_meta);
 
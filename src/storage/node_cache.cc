@@ -20,8 +20,8 @@
 namespace openmldb {
 namespace storage {
 
-NodeCache::NodeCache(uint32_t ts_cnt, uint32_t height) : ts_cnt_(ts_cnt), key_entry_max_height_(height),
-    mutex_(), key_entry_node_list_(4, 4, tcmp), value_node_list_(4, 4, tcmp) {}
+NodeCache::NodeCache(uint32_t ts_cnt, base::SlabAllocator* allocator) : ts_cnt_(ts_cnt),
+    allocator_(allocator), mutex_(), key_entry_node_list_(4, 4, tcmp), value_node_list_(4, 4, tcmp) {}
 
 NodeCache::~NodeCache() {
     Clear();
@@ -45,11 +45,7 @@ void NodeCache::Clear() {
     while (node_it->Valid()) {
         auto node_list = node_it->GetValue();
         for (auto& node : *node_list) {
-            if (node.type == NodeType::kNode) {
-                FreeNode(node.idx, node.node, &gc_info);
-            } else {
-                FreeNodeList(node.idx, node.node, &gc_info);
-            }
+            FreeRemovedRows(node.idx, &node.rows, &gc_info);
         }
         delete node_list;
         node_it->Next();
@@ -62,12 +58,11 @@ void NodeCache::AddKeyEntryNode(uint64_t version, base::Node<base::Slice, void*>
     AddNode(version, node, &key_entry_node_list_);
 }
 
-void NodeCache::AddSingleValueNode(uint32_t idx, uint64_t version, base::Node<uint64_t, DataBlock*>* node) {
-    AddNode(version, DataNode(idx, NodeType::kNode, node), &value_node_list_);
-}
-
-void NodeCache::AddValueNodeList(uint32_t idx, uint64_t version, base::Node<uint64_t, DataBlock*>* node) {
-    AddNode(version, DataNode(idx, NodeType::kList, node), &value_node_list_);
+void NodeCache::AddRemovedRows(uint32_t idx, uint64_t version, const RemovedRows& rows) {
+    if (rows.IsEmpty()) {
+        return;
+    }
+    AddNode(version, DataNode(idx, rows), &value_node_list_);
 }
 
 void NodeCache::Free(uint64_t version, StatisticsInfo* gc_info) {
@@ -93,11 +88,7 @@ void NodeCache::Free(uint64_t version, StatisticsInfo* gc_info) {
     while (node2) {
         auto node_list = node2->GetValue();
         for (auto& node : *node_list) {
-            if (node.type == NodeType::kNode) {
-                FreeNode(node.idx, node.node, gc_info);
-            } else {
-                FreeNodeList(node.idx, node.node, gc_info);
-            }
+            FreeRemovedRows(node.idx, &node.rows, gc_info);
         }
         delete node_list;
         auto tmp = node2;
@@ -108,42 +99,17 @@ void NodeCache::Free(uint64_t version, StatisticsInfo* gc_info) {
     DLOG(INFO) << "free record_byte_size " << gc_info->record_byte_size - old.record_byte_size;
 }
 
-void NodeCache::FreeNode(uint32_t idx, base::Node<uint64_t, DataBlock*>* node, StatisticsInfo* gc_info) {
-    if (node == nullptr) {
-        return;
-    }
-    gc_info->IncrIdxCnt(idx);
-    gc_info->idx_byte_size += GetRecordTsIdxSize(node->Height());
-    VLOG(1) << "delete key " << node->GetKey() << " with height " << (unsigned int)node->Height();
-    if (node->GetValue()->dim_cnt_down > 1) {
-        node->GetValue()->dim_cnt_down--;
-    } else {
-        VLOG(1) << "delete data block for key " << node->GetKey();
-        gc_info->record_byte_size += GetRecordSize(node->GetValue()->size);
-        delete node->GetValue();
-    }
-    delete node;
-}
-
-void NodeCache::FreeNodeList(uint32_t idx, base::Node<uint64_t, DataBlock*>* node, StatisticsInfo* gc_info) {
-    while (node) {
-        auto tmp = node;
-        node = node->GetNextNoBarrier(0);
-        FreeNode(idx, tmp, gc_info);
-    }
+void NodeCache::FreeRemovedRows(uint32_t idx, RemovedRows* rows, StatisticsInfo* gc_info) {
+    gc_info->idx_byte_size += rows->Free(idx, gc_info, allocator_);
 }
 
 void NodeCache::FreeKeyEntry(uint32_t idx, KeyEntry* entry, StatisticsInfo* gc_info) {
     if (entry == nullptr) {
         return;
     }
-    std::unique_ptr<TimeEntries::Iterator> it(entry->entries.NewIterator());
-    it->SeekToFirst();
-    if (it->Valid()) {
-        uint64_t ts = it->GetKey();
-        base::Node<uint64_t, DataBlock*>* data_node = entry->entries.Split(ts);
-        FreeNodeList(idx, data_node, gc_info);
-    }
+    RemovedRows rows = entry->entries.SplitAll(allocator_);
+    FreeRemovedRows(idx, &rows, gc_info);
+    gc_info->idx_byte_size += entry->entries.GetListSize();
     delete entry;
 }
 
@@ -160,17 +126,15 @@ void NodeCache::FreeKeyEntryNode(base::Node<base::Slice, void*>* entry_node, Sta
             FreeKeyEntry(i, entry, gc_info);
         }
         delete[] entry_arr;
-        uint64_t byte_size =
-            GetRecordPkMultiIdxSize(entry_node->Height(), entry_node->GetKey().size(), key_entry_max_height_, ts_cnt_);
+        uint64_t byte_size = GetRecordPkMultiIdxSize(entry_node->Height(), entry_node->GetKey().size(), ts_cnt_);
         gc_info->idx_byte_size += byte_size;
     } else {
         KeyEntry* entry = reinterpret_cast<KeyEntry*>(entry_node->GetValue());
         FreeKeyEntry(0, entry, gc_info);
-        uint64_t byte_size =
-            GetRecordPkIdxSize(entry_node->Height(), entry_node->GetKey().size(), key_entry_max_height_);
+        uint64_t byte_size = GetRecordPkIdxSize(entry_node->Height(), entry_node->GetKey().size());
         gc_info->idx_byte_size += byte_size;
     }
-    delete entry_node;
+    base::Node<base::Slice, void*>::Delete(entry_node, allocator_);
 }
 
 }  // namespace storage
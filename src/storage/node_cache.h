@@ -28,26 +28,19 @@
 namespace openmldb {
 namespace storage {
 
-enum class NodeType : uint32_t {
-    kNode = 1,
-    kList = 2
-};
-
 struct DataNode {
-    DataNode(uint32_t i, NodeType node_type, base::Node<uint64_t, DataBlock*>* value_node) :
-        idx(i), type(node_type), node(value_node) {}
+    DataNode(uint32_t i, const RemovedRows& removed_rows) : idx(i), rows(removed_rows) {}
     uint32_t idx = 0;
-    NodeType type = NodeType::kNode;
-    base::Node<uint64_t, DataBlock*>* node = nullptr;
+    RemovedRows rows;
 };
 
 class NodeCache {
  public:
-    explicit NodeCache(uint32_t ts_cnt, uint32_t height);
+    // allocator is the slab which the key entry and time entry nodes come from, can be nullptr
+    explicit NodeCache(uint32_t ts_cnt, base::SlabAllocator* allocator = nullptr);
     ~NodeCache();
     void AddKeyEntryNode(uint64_t version, base::Node<base::Slice, void*>* node);
-    void AddSingleValueNode(uint32_t idx, uint64_t version, base::Node<uint64_t, DataBlock*>* node);
-    void AddValueNodeList(uint32_t idx, uint64_t version, base::Node<uint64_t, DataBlock*>* node);
+    void AddRemovedRows(uint32_t idx, uint64_t version, const RemovedRows& rows);
 
     void Free(uint64_t version, StatisticsInfo* gc_info);
     void Clear();
@@ -71,12 +64,11 @@ class NodeCache {
 
     void FreeKeyEntryNode(base::Node<base::Slice, void*>* entry_node, StatisticsInfo* gc_info);
     void FreeKeyEntry(uint32_t idx, KeyEntry* entry, StatisticsInfo* gc_info);
-    void FreeNode(uint32_t idx, base::Node<uint64_t, DataBlock*>* node, StatisticsInfo* gc_info);
-    void FreeNodeList(uint32_t idx, base::Node<uint64_t, DataBlock*>* node, StatisticsInfo* gc_info);
+    void FreeRemovedRows(uint32_t idx, RemovedRows* rows, StatisticsInfo* gc_info);
 
  private:
     uint32_t ts_cnt_;
-    uint32_t key_entry_max_height_;
+    base::SlabAllocator* allocator_;
     std::mutex mutex_;
     KeyEntryNodeList key_entry_node_list_;
     ValueNodeList value_node_list_;
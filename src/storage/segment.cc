@@ -18,8 +18,11 @@
 
 #include <snappy.h>
 
+#include <algorithm>
 #include <memory>
+#include <utility>
 
+#include "absl/cleanup/cleanup.h"
 #include "base/glog_wrapper.h"
 #include "base/strings.h"
 #include "common/timer.h"
@@ -29,36 +32,95 @@
 DECLARE_int32(gc_safe_offset);
 DECLARE_uint32(skiplist_max_height);
 DECLARE_uint32(gc_deleted_pk_version_delta);
+DECLARE_uint32(key_filter_bits_per_key);
+DECLARE_bool(enable_memtable_hash_index);
 
 namespace openmldb {
 namespace storage {
 
 static const SliceComparator scmp;
+// the capacity of the key filter of an empty segment, it grows by stages as keys are put
+static constexpr uint64_t kKeyFilterMinCapacity = 4096;
+// the keys of a chunk in the expiry directory of gc
+static constexpr uint64_t kGcChunkKeyCnt = 1024;
+// the keys visited between two checks of the time budget of a gc slice
+static constexpr uint64_t kGcTimeCheckKeyCnt = 16;
 
-Segment::Segment(uint8_t height)
-    : entries_(nullptr),
+Segment::Segment(uint8_t height, std::shared_ptr<base::SlabAllocator> slab)
+    : slab_(std::move(slab)),
+      entries_(nullptr),
       mu_(),
       idx_byte_size_(0),
       pk_cnt_(0),
       key_entry_max_height_(height),
       ts_cnt_(1),
       gc_version_(0),
+      delete_cnt_(0),
       ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000),
-      node_cache_(1, height) {
+      node_cache_(1, slab_.get()),
+      key_filter_(nullptr),
+      building_key_filter_(nullptr),
+      key_index_(nullptr),
+      building_key_index_(nullptr),
+      building_removed_nodes_(),
+      grow_key_index_mu_(),
+      retired_mu_(),
+      retired_key_filters_(),
+      retired_key_indexes_(),
+      gc_cursor_(),
+      gc_cursor_mode_(GcPassMode::kScan),
+      gc_pass_stopped_(false),
+      gc_visited_key_cnt_(0),
+      gc_chunks_(),
+      building_gc_chunks_(),
+      gc_chunks_ready_(false),
+      oldest_put_time_(UINT64_MAX) {
+    if (FLAGS_key_filter_bits_per_key > 0) {
+        key_filter_.store(new KeyFilter(FLAGS_key_filter_bits_per_key, kKeyFilterMinCapacity));
+    }
+    if (FLAGS_enable_memtable_hash_index) {
+        key_index_.store(new KeyIndex(0));
+    }
     entries_ = new KeyEntries((uint8_t)FLAGS_skiplist_max_height, 4, scmp);
     idx_cnt_vec_.push_back(std::make_shared<std::atomic<uint64_t>>(0));
 }
 
-Segment::Segment(uint8_t height, const std::vector<uint32_t>& ts_idx_vec)
-    : entries_(nullptr),
+Segment::Segment(uint8_t height, const std::vector<uint32_t>& ts_idx_vec,
+                 std::shared_ptr<base::SlabAllocator> slab)
+    : slab_(std::move(slab)),
+      entries_(nullptr),
       mu_(),
       idx_byte_size_(0),
       pk_cnt_(0),
       key_entry_max_height_(height),
       ts_cnt_(ts_idx_vec.size()),
       gc_version_(0),
+      delete_cnt_(0),
       ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000),
-      node_cache_(ts_idx_vec.size(), height) {
+      node_cache_(ts_idx_vec.size(), slab_.get()),
+      key_filter_(nullptr),
+      building_key_filter_(nullptr),
+      key_index_(nullptr),
+      building_key_index_(nullptr),
+      building_removed_nodes_(),
+      grow_key_index_mu_(),
+      retired_mu_(),
+      retired_key_filters_(),
+      retired_key_indexes_(),
+      gc_cursor_(),
+      gc_cursor_mode_(GcPassMode::kScan),
+      gc_pass_stopped_(false),
+      gc_visited_key_cnt_(0),
+      gc_chunks_(),
+      building_gc_chunks_(),
+      gc_chunks_ready_(false),
+      oldest_put_time_(UINT64_MAX) {
+    if (FLAGS_key_filter_bits_per_key > 0) {
+        key_filter_.store(new KeyFilter(FLAGS_key_filter_bits_per_key, kKeyFilterMinCapacity));
+    }
+    if (FLAGS_enable_memtable_hash_index) {
+        key_index_.store(new KeyIndex(0));
+    }
     entries_ = new KeyEntries((uint8_t)FLAGS_skiplist_max_height, 4, scmp);
     for (uint32_t i = 0; i < ts_idx_vec.size(); i++) {
         ts_idx_map_[ts_idx_vec[i]] = i;
@@ -66,7 +128,11 @@ Segment::Segment(uint8_t height, const std::vector<uint32_t>& ts_idx_vec)
     }
 }
 
-Segment::~Segment() { delete entries_; }
+Segment::~Segment() {
+    delete entries_;
+    delete key_filter_.load(std::memory_order_relaxed);
+    delete key_index_.load(std::memory_order_relaxed);
+}
 
 void Segment::Release(StatisticsInfo* statistics_info) {
     std::unique_ptr<KeyEntries::Iterator> it(entries_->NewIterator());
@@ -77,20 +143,31 @@ void Segment::Release(StatisticsInfo* statistics_info) {
             if (ts_cnt_ > 1) {
                 KeyEntry** entry_arr = reinterpret_cast<KeyEntry**>(it->GetValue());
                 for (uint32_t i = 0; i < ts_cnt_; i++) {
-                    entry_arr[i]->Release(i, statistics_info);
+                    entry_arr[i]->Release(i, statistics_info, slab_.get());
                     delete entry_arr[i];
                 }
                 delete[] entry_arr;
             } else {
                 KeyEntry* entry = reinterpret_cast<KeyEntry*>(it->GetValue());
-                entry->Release(0, statistics_info);
+                entry->Release(0, statistics_info, slab_.get());
                 delete entry;
             }
         }
         it->Next();
     }
-    entries_->Clear();
+    entries_->Clear(slab_.get());
     node_cache_.Clear();
+    if (auto filter = key_filter_.load(std::memory_order_relaxed); filter != nullptr) {
+        std::lock_guard<std::shared_mutex> lock(mu_);
+        ReplaceKeyFilterUnlock(new KeyFilter(filter->GetBitsPerKey(), kKeyFilterMinCapacity));
+    }
+    if (key_index_.load(std::memory_order_relaxed) != nullptr) {
+        std::lock_guard<std::shared_mutex> lock(mu_);
+        // the index being built has the nodes released, ReserveKeyIndex drops it
+        building_key_index_ = nullptr;
+        building_removed_nodes_.clear();
+        ReplaceKeyIndexUnlock(new KeyIndex(0));
+    }
     idx_byte_size_.store(0);
     pk_cnt_.store(0);
     for (auto& idx_cnt : idx_cnt_vec_) {
@@ -120,13 +197,8 @@ void Segment::ReleaseAndCount(const std::vector<size_t>& id_vec, StatisticsInfo*
             KeyEntry** entry_arr = reinterpret_cast<KeyEntry**>(it->GetValue());
             for (auto pos : real_idx_vec) {
                 KeyEntry* entry = entry_arr[pos];
-                std::unique_ptr<TimeEntries::Iterator> ts_it(entry->entries.NewIterator());
-                ts_it->SeekToFirst();
-                if (ts_it->Valid()) {
-                    uint64_t ts = ts_it->GetKey();
-                    auto data_node = entry->entries.Split(ts);
-                    FreeList(pos, data_node, statistics_info);
-                }
+                RemovedRows rows = entry->entries.SplitAll(slab_.get());
+                FreeList(pos, &rows, statistics_info);
             }
         }
         it->Next();
@@ -138,7 +210,7 @@ void Segment::Put(const Slice& key, uint64_t time, const char* data, uint32_t si
     if (ts_cnt_ > 1) {
         return;
     }
-    auto* db = new DataBlock(1, data, size);
+    auto* db = new DataBlock(1, data, size, slab_.get());
     Put(key, time, db, put_if_absent, check_all_time);
 }
 
@@ -147,65 +219,96 @@ bool Segment::Put(const Slice& key, uint64_t time, DataBlock* row, bool put_if_a
         LOG(ERROR) << "wrong call";
         return false;
     }
-    std::lock_guard<std::mutex> lock(mu_);
+    ReserveKeyIndex(1);
+    std::unique_lock<std::shared_mutex> lock(mu_, std::defer_lock);
+    if (!SupportConcurrentPut()) {
+        lock.lock();
+    }
     return PutUnlock(key, time, row, put_if_absent, check_all_time);
 }
 
-bool Segment::PutUnlock(const Slice& key, uint64_t time, DataBlock* row, bool put_if_absent, bool check_all_time) {
+void* Segment::GetOrCreateEntry(const Slice& key, uint32_t* byte_size, bool skip_lookup) {
     void* entry = nullptr;
-    uint32_t byte_size = 0;
     // one key just one entry
-    int ret = entries_->Get(key, entry);
-    if (ret < 0 || entry == nullptr) {
-        char* pk = new char[key.size()];
-        memcpy(pk, key.data(), key.size());
-        // need to delete memory when free node
-        Slice skey(pk, key.size());
+    if (!skip_lookup && GetKeyEntry(key, entry) == 0 && entry != nullptr) {
+        return entry;
+    }
+    // a segment without concurrent put holds mu_ exclusively already
+    std::shared_lock<std::shared_mutex> lock(mu_, std::defer_lock);
+    if (SupportConcurrentPut()) {
+        lock.lock();
+    }
+    char* pk = new char[key.size()];
+    memcpy(pk, key.data(), key.size());
+    // need to delete memory when free node
+    Slice skey(pk, key.size());
+    if (ts_cnt_ == 1) {
         entry = reinterpret_cast<void*>(new KeyEntry(key_entry_max_height_));
-        uint8_t height = entries_->Insert(skey, entry);
-        byte_size += GetRecordPkIdxSize(height, key.size(), key_entry_max_height_);
-        pk_cnt_.fetch_add(1, std::memory_order_relaxed);
-        // no need to check if absent when first put
-    } else if (put_if_absent && ListContains(reinterpret_cast<KeyEntry*>(entry), time, row, check_all_time)) {
-        return false;
+    } else {
+        KeyEntry** entry_arr = new KeyEntry*[ts_cnt_];
+        for (uint32_t i = 0; i < ts_cnt_; i++) {
+            entry_arr[i] = new KeyEntry(key_entry_max_height_);
+        }
+        entry = reinterpret_cast<void*>(entry_arr);
+    }
+    AddToKeyFilter(skey);
+    uint8_t height = 0;
+    auto node = entries_->ConcurrentInsert(skey, entry, slab_.get(), true, &height);
+    if (node->GetValue() != entry) {
+        // another put has inserted the same key
+        if (ts_cnt_ == 1) {
+            delete reinterpret_cast<KeyEntry*>(entry);
+        } else {
+            KeyEntry** entry_arr = reinterpret_cast<KeyEntry**>(entry);
+            for (uint32_t i = 0; i < ts_cnt_; i++) {
+                delete entry_arr[i];
+            }
+            delete[] entry_arr;
+        }
+        delete[] pk;
+        return node->GetValue();
     }
+    InsertKeyIndex(node);
+    if (ts_cnt_ == 1) {
+        *byte_size += GetRecordPkIdxSize(height, key.size());
+    } else {
+        *byte_size += GetRecordPkMultiIdxSize(height, key.size(), ts_cnt_);
+    }
+    pk_cnt_.fetch_add(1, std::memory_order_relaxed);
+    return entry;
+}
 
+bool Segment::PutUnlock(const Slice& key, uint64_t time, DataBlock* row, bool put_if_absent, bool check_all_time) {
+    uint32_t byte_size = 0;
+    void* entry = nullptr;
+    if (!InsertEntry(key, 0, time, row, put_if_absent, check_all_time, &entry, &byte_size)) {
+        idx_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
+        return false;
+    }
     idx_cnt_vec_[0]->fetch_add(1, std::memory_order_relaxed);
-    uint8_t height = reinterpret_cast<KeyEntry*>(entry)->entries.Insert(time, row);
-    reinterpret_cast<KeyEntry*>(entry)->count_.fetch_add(1, std::memory_order_relaxed);
-    byte_size += GetRecordTsIdxSize(height);
+    UpdateOldestPutTime(time);
+    reinterpret_cast<KeyEntry*>(entry)->CountPut();
     idx_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
     DLOG(INFO) << "idx_byte_size_ " << idx_byte_size_ << " after add " << byte_size;
     return true;
 }
 
 void Segment::BulkLoadPut(unsigned int key_entry_id, const Slice& key, uint64_t time, DataBlock* row) {
-    void* key_entry_or_list = nullptr;
-    uint32_t byte_size = 0;
-    std::lock_guard<std::mutex> lock(mu_);  // TODO(hw): need lock?
-    int ret = entries_->Get(key, key_entry_or_list);
+    ReserveKeyIndex(1);
+    std::unique_lock<std::shared_mutex> lock(mu_, std::defer_lock);
+    if (!SupportConcurrentPut()) {
+        lock.lock();
+    }
     if (ts_cnt_ == 1) {
         PutUnlock(key, time, row);
-    } else {
-        if (ret < 0 || key_entry_or_list == nullptr) {
-            char* pk = new char[key.size()];
-            memcpy(pk, key.data(), key.size());
-            Slice skey(pk, key.size());
-            auto** entry_arr_tmp = new KeyEntry*[ts_cnt_];
-            for (uint32_t i = 0; i < ts_cnt_; i++) {
-                entry_arr_tmp[i] = new KeyEntry(key_entry_max_height_);
-            }
-            auto entry_arr = reinterpret_cast<void*>(entry_arr_tmp);
-            uint8_t height = entries_->Insert(skey, entry_arr);
-            byte_size += GetRecordPkMultiIdxSize(height, key.size(), key_entry_max_height_, ts_cnt_);
-            pk_cnt_.fetch_add(1, std::memory_order_relaxed);
-        }
-        uint8_t height = reinterpret_cast<KeyEntry**>(key_entry_or_list)[key_entry_id]->entries.Insert(time, row);
-        reinterpret_cast<KeyEntry**>(key_entry_or_list)[key_entry_id]->count_.fetch_add(1, std::memory_order_relaxed);
-        byte_size += GetRecordTsIdxSize(height);
-        idx_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
-        idx_cnt_vec_[key_entry_id]->fetch_add(1, std::memory_order_relaxed);
+        return;
     }
+    uint32_t byte_size = 0;
+    void* entry_arr = nullptr;
+    InsertEntry(key, key_entry_id, time, row, false, false, &entry_arr, &byte_size);
+    reinterpret_cast<KeyEntry**>(entry_arr)[key_entry_id]->CountPut();
+    idx_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
+    idx_cnt_vec_[key_entry_id]->fetch_add(1, std::memory_order_relaxed);
 }
 
 bool Segment::Put(const Slice& key, const std::map<int32_t, uint64_t>& ts_map, DataBlock* row, bool put_if_absent) {
@@ -220,37 +323,49 @@ bool Segment::Put(const Slice& key, const std::map<int32_t, uint64_t>& ts_map, D
         }
         return ret;
     }
+    ReserveKeyIndex(1);
+    std::unique_lock<std::shared_mutex> lock(mu_, std::defer_lock);
+    if (!SupportConcurrentPut()) {
+        lock.lock();
+    }
+    return PutMultiTsUnlock(key, ts_map, row, put_if_absent);
+}
+
+void Segment::Put(const std::vector<SegmentPutRow>& rows) {
+    ReserveKeyIndex(rows.size());
+    std::unique_lock<std::shared_mutex> lock(mu_, std::defer_lock);
+    if (!SupportConcurrentPut()) {
+        lock.lock();
+    }
+    for (const auto& put_row : rows) {
+        if (put_row.ts_map->empty()) {
+            continue;
+        }
+        if (ts_cnt_ == 1) {
+            if (auto pos = put_row.ts_map->find(ts_idx_map_.begin()->first); pos != put_row.ts_map->end()) {
+                PutUnlock(put_row.key, pos->second, put_row.row, false, pos->first == DEFAULT_TS_COL_ID);
+            }
+        } else {
+            PutMultiTsUnlock(put_row.key, *put_row.ts_map, put_row.row, false);
+        }
+    }
+}
+
+bool Segment::PutMultiTsUnlock(const Slice& key, const std::map<int32_t, uint64_t>& ts_map, DataBlock* row,
+                               bool put_if_absent) {
     void* entry_arr = nullptr;
-    std::lock_guard<std::mutex> lock(mu_);
     for (const auto& kv : ts_map) {
         uint32_t byte_size = 0;
         auto pos = ts_idx_map_.find(kv.first);
         if (pos == ts_idx_map_.end()) {
             continue;
         }
-        if (entry_arr == nullptr) {
-            int ret = entries_->Get(key, entry_arr);
-            if (ret < 0 || entry_arr == nullptr) {
-                char* pk = new char[key.size()];
-                memcpy(pk, key.data(), key.size());
-                Slice skey(pk, key.size());
-                KeyEntry** entry_arr_tmp = new KeyEntry*[ts_cnt_];
-                for (uint32_t i = 0; i < ts_cnt_; i++) {
-                    entry_arr_tmp[i] = new KeyEntry(key_entry_max_height_);
-                }
-                entry_arr = reinterpret_cast<void*>(entry_arr_tmp);
-                uint8_t height = entries_->Insert(skey, entry_arr);
-                byte_size += GetRecordPkMultiIdxSize(height, key.size(), key_entry_max_height_, ts_cnt_);
-                pk_cnt_.fetch_add(1, std::memory_order_relaxed);
-            }
-        }
-        auto entry = reinterpret_cast<KeyEntry**>(entry_arr)[pos->second];
-        if (put_if_absent && ListContains(entry, kv.second, row, pos->first == DEFAULT_TS_COL_ID)) {
+        if (!InsertEntry(key, pos->second, kv.second, row, put_if_absent, pos->first == DEFAULT_TS_COL_ID, &entry_arr,
+                         &byte_size)) {
+            idx_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
             return false;
         }
-        uint8_t height = entry->entries.Insert(kv.second, row);
-        entry->count_.fetch_add(1, std::memory_order_relaxed);
-        byte_size += GetRecordTsIdxSize(height);
+        reinterpret_cast<KeyEntry**>(entry_arr)[pos->second]->CountPut();
         idx_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
         DLOG(INFO) << "idx_byte_size_ " << idx_byte_size_ << " after add " << byte_size;
         idx_cnt_vec_[pos->second]->fetch_add(1, std::memory_order_relaxed);
@@ -263,11 +378,12 @@ bool Segment::Delete(const std::optional<uint32_t>& idx, const Slice& key) {
     if (!GetTsIdx(idx, &ts_idx)) {
         return false;
     }
+    absl::Cleanup count_delete = [this] { delete_cnt_.fetch_add(1, std::memory_order_release); };
     if (ts_cnt_ == 1) {
         ::openmldb::base::Node<Slice, void*>* entry_node = nullptr;
         {
-            std::lock_guard<std::mutex> lock(mu_);
-            entry_node = entries_->Remove(key);
+            std::lock_guard<std::shared_mutex> lock(mu_);
+            entry_node = RemoveKeyEntryUnlock(key, false);
         }
         if (entry_node != nullptr) {
             DLOG(INFO) << "add key " << key.ToString() << " to node cache. version " << gc_version_;
@@ -275,35 +391,19 @@ bool Segment::Delete(const std::optional<uint32_t>& idx, const Slice& key) {
             return true;
         }
     } else {
-        base::Node<uint64_t, DataBlock*>* data_node = nullptr;
+        RemovedRows rows;
         ::openmldb::base::Node<Slice, void*>* entry_node = nullptr;
         {
-            std::lock_guard<std::mutex> lock(mu_);
+            std::lock_guard<std::shared_mutex> lock(mu_);
             void* entry_arr = nullptr;
-            if (entries_->Get(key, entry_arr) < 0 || entry_arr == nullptr) {
+            if (GetKeyEntry(key, entry_arr) < 0 || entry_arr == nullptr) {
                 return true;
             }
             KeyEntry* key_entry = reinterpret_cast<KeyEntry**>(entry_arr)[ts_idx];
-            std::unique_ptr<TimeEntries::Iterator> it(key_entry->entries.NewIterator());
-            it->SeekToFirst();
-            if (it->Valid()) {
-                uint64_t ts = it->GetKey();
-                data_node = key_entry->entries.Split(ts);
-            }
-            bool is_empty = true;
-            for (uint32_t i = 0; i < ts_cnt_; i++) {
-                if (!reinterpret_cast<KeyEntry**>(entry_arr)[i]->entries.IsEmpty()) {
-                    is_empty = false;
-                    break;
-                }
-            }
-            if (is_empty) {
-                entry_node = entries_->Remove(key);
-            }
-        }
-        if (data_node != nullptr) {
-            node_cache_.AddValueNodeList(ts_idx, gc_version_.load(std::memory_order_relaxed), data_node);
+            rows = key_entry->entries.SplitAll(slab_.get());
+            entry_node = RemoveKeyEntryUnlock(key, true);
         }
+        node_cache_.AddRemovedRows(ts_idx, gc_version_.load(std::memory_order_relaxed), rows);
         if (entry_node != nullptr) {
             DLOG(INFO) << "add key " << key.ToString() << " to node cache. version " << gc_version_;
             node_cache_.AddKeyEntryNode(gc_version_.load(std::memory_order_relaxed), entry_node);
@@ -339,9 +439,10 @@ bool Segment::Delete(const std::optional<uint32_t>& idx, const Slice& key, uint6
     }
 
     void* entry = nullptr;
-    if (entries_->Get(key, entry) < 0 || entry == nullptr) {
+    if (GetKeyEntry(key, entry) < 0 || entry == nullptr) {
         return true;
     }
+    absl::Cleanup count_delete = [this] { delete_cnt_.fetch_add(1, std::memory_order_release); };
     KeyEntry* key_entry = nullptr;
     if (ts_cnt_ == 1) {
         key_entry = reinterpret_cast<KeyEntry*>(entry);
@@ -349,50 +450,36 @@ bool Segment::Delete(const std::optional<uint32_t>& idx, const Slice& key, uint6
         key_entry = reinterpret_cast<KeyEntry**>(entry)[ts_idx];
     }
     if (end_ts.has_value()) {
-        if (auto node = key_entry->entries.GetLast(); node == nullptr) {
+        if (uint64_t last_ts = 0; !key_entry->entries.GetLastTime(&last_ts)) {
             return true;
-        } else if (node->GetKey() <= end_ts.value()) {
+        } else if (last_ts <= end_ts.value()) {
+            // the ticket keeps gc from compacting the list under the iterator
+            Ticket ticket;
+            ticket.Push(key_entry);
             std::unique_ptr<TimeEntries::Iterator> it(key_entry->entries.NewIterator());
             it->Seek(ts);
             while (it->Valid()) {
                 uint64_t cur_ts = it->GetKey();
                 it->Next();
-                base::Node<uint64_t, DataBlock*>* data_node = nullptr;
+                RemovedRows rows;
                 if (cur_ts <= ts && cur_ts > end_ts.value()) {
-                    std::lock_guard<std::mutex> lock(mu_);
-                    data_node = key_entry->entries.Remove(cur_ts);
+                    rows = key_entry->entries.Remove(cur_ts, slab_.get());
                 } else {
                     return true;
                 }
-                node_cache_.AddSingleValueNode(ts_idx, gc_version_.load(std::memory_order_relaxed), data_node);
+                node_cache_.AddRemovedRows(ts_idx, gc_version_.load(std::memory_order_relaxed), rows);
             }
             return true;
         }
     }
-    base::Node<uint64_t, DataBlock*>* data_node = nullptr;
+    RemovedRows rows = key_entry->entries.Split(ts, slab_.get());
+    DLOG(INFO) << "after delete, entry " << key.ToString() << " split by " << ts;
     base::Node<openmldb::base::Slice, void*>* entry_node = nullptr;
-    {
-        std::lock_guard<std::mutex> lock(mu_);
-        data_node = key_entry->entries.Split(ts);
-        DLOG(INFO) << "after delete, entry " << key.ToString() << " split by " << ts;
-        bool is_empty = true;
-        if (ts_cnt_ == 1) {
-            is_empty = key_entry->entries.IsEmpty();
-        } else {
-            for (uint32_t i = 0; i < ts_cnt_; i++) {
-                if (!reinterpret_cast<KeyEntry**>(entry)[i]->entries.IsEmpty()) {
-                    is_empty = false;
-                    break;
-                }
-            }
-        }
-        if (is_empty) {
-            entry_node = entries_->Remove(key);
-        }
-    }
-    if (data_node != nullptr) {
-        node_cache_.AddValueNodeList(ts_idx, gc_version_.load(std::memory_order_relaxed), data_node);
+    if (key_entry->entries.IsEmpty()) {
+        std::lock_guard<std::shared_mutex> lock(mu_);
+        entry_node = RemoveKeyEntryUnlock(key, true);
     }
+    node_cache_.AddRemovedRows(ts_idx, gc_version_.load(std::memory_order_relaxed), rows);
     if (entry_node != nullptr) {
         DLOG(INFO) << "add key " << key.ToString() << " to node cache. version " << gc_version_;
         node_cache_.AddKeyEntryNode(gc_version_.load(std::memory_order_relaxed), entry_node);
@@ -400,23 +487,59 @@ bool Segment::Delete(const std::optional<uint32_t>& idx, const Slice& key, uint6
     return true;
 }
 
-void Segment::FreeList(uint32_t ts_idx, ::openmldb::base::Node<uint64_t, DataBlock*>* node,
-                       StatisticsInfo* statistics_info) {
-    while (node != nullptr) {
-        statistics_info->IncrIdxCnt(ts_idx);
-        ::openmldb::base::Node<uint64_t, DataBlock*>* tmp = node;
-        idx_byte_size_.fetch_sub(GetRecordTsIdxSize(tmp->Height()));
-        DLOG(INFO) << "idx_byte_size_ " << idx_byte_size_ << " after sub " << GetRecordTsIdxSize(tmp->Height());
-        node = node->GetNextNoBarrier(0);
-        VLOG(1) << "delete key " << tmp->GetKey() << " with height " << (unsigned int)tmp->Height();
-        if (tmp->GetValue()->dim_cnt_down > 1) {
-            tmp->GetValue()->dim_cnt_down--;
+void Segment::FreeList(uint32_t ts_idx, RemovedRows* rows, StatisticsInfo* statistics_info) {
+    // the rows are not read as refs is checked before the split, but a reader may load the replaced index still
+    node_cache_.AddRemovedRows(ts_idx, gc_version_.load(std::memory_order_relaxed), rows->TakeRetired());
+    uint64_t byte_size = rows->Free(ts_idx, statistics_info, slab_.get());
+    idx_byte_size_.fetch_sub(byte_size);
+    DLOG(INFO) << "idx_byte_size_ " << idx_byte_size_ << " after sub " << byte_size;
+}
+
+void Segment::CompactEntry(KeyEntry* entry, RemovedRows* rows) {
+    if (rows->IsEmpty()) {
+        return;
+    }
+    uint32_t byte_size = entry->entries.Compact(slab_.get(), rows);
+    if (byte_size > 0) {
+        idx_byte_size_.fetch_sub(byte_size);
+        DLOG(INFO) << "idx_byte_size_ " << idx_byte_size_ << " after compact " << byte_size;
+    }
+}
+
+uint32_t Segment::InsertEntry(uint32_t ts_idx, KeyEntry* entry, uint64_t time, DataBlock* row) {
+    RemovedRows retired;
+    uint32_t byte_size = 0;
+    auto status = entry->entries.Insert(time, row, slab_.get(), &retired, &byte_size);
+    DCHECK(status == TimeEntries::InsertStatus::kInserted);
+    node_cache_.AddRemovedRows(ts_idx, gc_version_.load(std::memory_order_relaxed), retired);
+    return byte_size;
+}
+
+bool Segment::InsertEntry(const Slice& key, uint32_t ts_idx, uint64_t time, DataBlock* row, bool put_if_absent,
+                          bool check_all_time, void** key_entry, uint32_t* byte_size) {
+    bool skip_lookup = false;
+    while (true) {
+        if (*key_entry == nullptr) {
+            *key_entry = GetOrCreateEntry(key, byte_size, skip_lookup);
+        }
+        KeyEntry* entry = ts_cnt_ == 1 ? reinterpret_cast<KeyEntry*>(*key_entry)
+                                       : reinterpret_cast<KeyEntry**>(*key_entry)[ts_idx];
+        RemovedRows retired;
+        TimeEntries::InsertStatus status;
+        if (put_if_absent) {
+            status = entry->entries.InsertIfAbsent(time, row, slab_.get(), &retired, byte_size, [&] {
+                return ListContains(entry, time, row, check_all_time);
+            });
         } else {
-            VLOG(1) << "delete data block for key " << tmp->GetKey();
-            statistics_info->record_byte_size += GetRecordSize(tmp->GetValue()->size);
-            delete tmp->GetValue();
+            status = entry->entries.Insert(time, row, slab_.get(), &retired, byte_size);
+        }
+        node_cache_.AddRemovedRows(ts_idx, gc_version_.load(std::memory_order_relaxed), retired);
+        if (status != TimeEntries::InsertStatus::kClosed) {
+            return status == TimeEntries::InsertStatus::kInserted;
         }
-        delete tmp;
+        // removed by delete or gc meanwhile
+        *key_entry = nullptr;
+        skip_lookup = true;
     }
 }
 
@@ -428,8 +551,28 @@ void Segment::GcFreeList(StatisticsInfo* statistics_info) {
     StatisticsInfo old = *statistics_info;
     DLOG(INFO) << "cur " << old.DebugString();
     uint64_t free_list_version = cur_version - FLAGS_gc_deleted_pk_version_delta;
-    node_cache_.Free(free_list_version, statistics_info);
+    {
+        // the build of the key index may insert the nodes removed during it, they are freed by a later call
+        std::unique_lock<std::mutex> grow_lock(grow_key_index_mu_, std::try_to_lock);
+        if (!grow_lock.owns_lock()) {
+            return;
+        }
+        node_cache_.Free(free_list_version, statistics_info);
+    }
     DLOG(INFO) << "after node cache free  " << statistics_info->DebugString();
+    {
+        std::lock_guard<std::mutex> lock(retired_mu_);
+        retired_key_filters_.erase(std::remove_if(retired_key_filters_.begin(), retired_key_filters_.end(),
+                                                  [free_list_version](const auto& kv) {
+                                                      return kv.first <= free_list_version;
+                                                  }),
+                                   retired_key_filters_.end());
+        retired_key_indexes_.erase(std::remove_if(retired_key_indexes_.begin(), retired_key_indexes_.end(),
+                                                  [free_list_version](const auto& kv) {
+                                                      return kv.first <= free_list_version;
+                                                  }),
+                                   retired_key_indexes_.end());
+    }
     for (size_t idx = 0; idx < idx_cnt_vec_.size(); idx++) {
         idx_cnt_vec_[idx]->fetch_sub(statistics_info->GetIdxCnt(idx) - old.GetIdxCnt(idx), std::memory_order_relaxed);
     }
@@ -439,7 +582,180 @@ void Segment::GcFreeList(StatisticsInfo* statistics_info) {
                << statistics_info->idx_byte_size - old.idx_byte_size;
 }
 
-void Segment::ExecuteGc(const TTLSt& ttl_st, StatisticsInfo* statistics_info) {
+// visits the keys of a gc slice in key order. it resumes the pass the last slice stops in if they are in the same
+// mode, and stops when the budget runs out. with a budget, a pass by expire time on a single ts segment builds the
+// expiry directory when it visits all keys. the later passes visit only the chunks that have rows older than the
+// expire time while the directory is valid
+class Segment::GcScanner {
+ public:
+    GcScanner(Segment* segment, const GcBudget& budget, uint64_t expire_time)
+        : segment_(segment),
+          budget_(budget),
+          expire_time_(expire_time),
+          mode_(GcPassMode::kScan),
+          it_(segment->entries_->NewIterator()),
+          deadline_(budget.time_us == 0 ? 0 : ::baidu::common::timer::get_micros() + budget.time_us),
+          visited_cnt_(0),
+          finished_(false),
+          stopped_(false),
+          chunk_key_cnt_(kGcChunkKeyCnt),
+          chunk_idx_(0),
+          in_chunk_(false),
+          chunk_complete_(false),
+          chunk_oldest_time_(UINT64_MAX) {
+        if (expire_time_ > 0 && budget_.IsIncremental() && segment_->ts_cnt_ == 1) {
+            if (segment_->gc_chunks_ready_ && segment_->oldest_put_time_.load() > expire_time_) {
+                mode_ = GcPassMode::kDirectory;
+            } else {
+                mode_ = GcPassMode::kBuild;
+            }
+        }
+        auto& cursor = segment_->gc_cursor_;
+        if (cursor.has_value() && segment_->gc_cursor_mode_ != mode_) {
+            cursor.reset();
+        }
+        if (mode_ == GcPassMode::kBuild && !cursor.has_value()) {
+            // the rows put from now on are tracked by oldest_put_time_, the ones put before are seen by the pass
+            segment_->oldest_put_time_.store(UINT64_MAX);
+            segment_->gc_chunks_ready_ = false;
+            segment_->gc_chunks_.clear();
+            segment_->building_gc_chunks_.clear();
+        }
+        if (mode_ == GcPassMode::kDirectory && cursor.has_value()) {
+            // the first part of the chunk the cursor is in was visited by the last slice
+            const auto& chunks = segment_->gc_chunks_;
+            auto pos = std::upper_bound(chunks.begin(), chunks.end(), *cursor,
+                                        [](const std::string& key, const GcChunk& chunk) {
+                                            return Slice(key).compare(Slice(chunk.start_key)) < 0;
+                                        });
+            // the start key of the first chunk is empty, so pos is not the first one
+            chunk_idx_ = pos - chunks.begin() - 1;
+            in_chunk_ = true;
+            it_->Seek(Slice(*cursor));
+        } else if (cursor.has_value()) {
+            it_->Seek(Slice(*cursor));
+        } else {
+            it_->SeekToFirst();
+        }
+    }
+
+    ~GcScanner() {
+        segment_->gc_visited_key_cnt_ = visited_cnt_;
+        segment_->gc_pass_stopped_ = stopped_;
+        if (stopped_) {
+            segment_->gc_cursor_mode_ = mode_;
+            return;
+        }
+        segment_->gc_cursor_.reset();
+        if (finished_ && mode_ == GcPassMode::kBuild) {
+            segment_->gc_chunks_.swap(segment_->building_gc_chunks_);
+            segment_->building_gc_chunks_.clear();
+            segment_->gc_chunks_ready_ = true;
+        }
+    }
+
+    // the next key of the slice and its value, the scanner has moved past it so the key can be removed
+    bool Next(Slice* key, void** value) {
+        if (finished_ || stopped_) {
+            return false;
+        }
+        if (!(mode_ == GcPassMode::kDirectory ? SeekInDirectory() : it_->Valid())) {
+            finished_ = true;
+            return false;
+        }
+        if (OutOfBudget()) {
+            stopped_ = true;
+            segment_->gc_cursor_ = it_->GetKey().ToString();
+            return false;
+        }
+        *key = it_->GetKey();
+        *value = it_->GetValue();
+        if (mode_ == GcPassMode::kBuild) {
+            auto& chunks = segment_->building_gc_chunks_;
+            if (chunk_key_cnt_ >= kGcChunkKeyCnt) {
+                chunks.push_back({chunks.empty() ? std::string() : key->ToString(), UINT64_MAX});
+                chunk_key_cnt_ = 0;
+            }
+            chunk_key_cnt_++;
+        }
+        visited_cnt_++;
+        it_->Next();
+        return true;
+    }
+
+    // the oldest time of the rows left in the key returned last
+    void Keep(uint64_t oldest_time) {
+        if (mode_ == GcPassMode::kBuild) {
+            auto& chunk = segment_->building_gc_chunks_.back();
+            chunk.oldest_time = std::min(chunk.oldest_time, oldest_time);
+        } else if (mode_ == GcPassMode::kDirectory) {
+            chunk_oldest_time_ = std::min(chunk_oldest_time_, oldest_time);
+        }
+    }
+
+ private:
+    // move it_ to the next key in the chunks that have rows older than the expire time
+    bool SeekInDirectory() {
+        auto& chunks = segment_->gc_chunks_;
+        while (true) {
+            if (in_chunk_ && it_->Valid() &&
+                (chunk_idx_ + 1 == chunks.size() ||
+                 it_->GetKey().compare(Slice(chunks[chunk_idx_ + 1].start_key)) < 0)) {
+                return true;
+            }
+            if (in_chunk_) {
+                if (chunk_complete_) {
+                    chunks[chunk_idx_].oldest_time = chunk_oldest_time_;
+                }
+                chunk_idx_++;
+            }
+            while (chunk_idx_ < chunks.size() && chunks[chunk_idx_].oldest_time > expire_time_) {
+                chunk_idx_++;
+            }
+            if (chunk_idx_ >= chunks.size()) {
+                return false;
+            }
+            in_chunk_ = true;
+            chunk_complete_ = true;
+            chunk_oldest_time_ = UINT64_MAX;
+            it_->Seek(Slice(chunks[chunk_idx_].start_key));
+        }
+    }
+
+    // a slice visits one key at least
+    bool OutOfBudget() const {
+        if (visited_cnt_ == 0) {
+            return false;
+        }
+        if (budget_.key_cnt > 0 && visited_cnt_ >= budget_.key_cnt) {
+            return true;
+        }
+        return deadline_ > 0 && visited_cnt_ % kGcTimeCheckKeyCnt == 0 &&
+               ::baidu::common::timer::get_micros() >= deadline_;
+    }
+
+    Segment* segment_;
+    const GcBudget budget_;
+    // 0 if the pass does not gc by time, all keys are visited then
+    const uint64_t expire_time_;
+    GcPassMode mode_;
+    std::unique_ptr<KeyEntries::Iterator> it_;
+    const uint64_t deadline_;
+    uint64_t visited_cnt_;
+    bool finished_;
+    bool stopped_;
+    // the keys of the last chunk built by the slice
+    uint64_t chunk_key_cnt_;
+    // the chunk visited in the directory, its oldest time is updated only if the slice visits all its keys
+    size_t chunk_idx_;
+    bool in_chunk_;
+    bool chunk_complete_;
+    uint64_t chunk_oldest_time_;
+};
+
+void Segment::ExecuteGc(const TTLSt& ttl_st, StatisticsInfo* statistics_info, const GcBudget& budget) {
+    gc_pass_stopped_ = false;
+    gc_visited_key_cnt_ = 0;
     uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
     switch (ttl_st.ttl_type) {
         case ::openmldb::storage::TTLType::kAbsoluteTime: {
@@ -447,14 +763,14 @@ void Segment::ExecuteGc(const TTLSt& ttl_st, StatisticsInfo* statistics_info) {
                 return;
             }
             uint64_t expire_time = cur_time - ttl_offset_ - ttl_st.abs_ttl;
-            Gc4TTL(expire_time, statistics_info);
+            Gc4TTL(expire_time, statistics_info, budget);
             break;
         }
         case ::openmldb::storage::TTLType::kLatestTime: {
             if (ttl_st.lat_ttl == 0) {
                 return;
             }
-            Gc4Head(ttl_st.lat_ttl, statistics_info);
+            Gc4Head(ttl_st.lat_ttl, statistics_info, budget);
             break;
         }
         case ::openmldb::storage::TTLType::kAbsAndLat: {
@@ -462,7 +778,7 @@ void Segment::ExecuteGc(const TTLSt& ttl_st, StatisticsInfo* statistics_info) {
                 return;
             }
             uint64_t expire_time = cur_time - ttl_offset_ - ttl_st.abs_ttl;
-            Gc4TTLAndHead(expire_time, ttl_st.lat_ttl, statistics_info);
+            Gc4TTLAndHead(expire_time, ttl_st.lat_ttl, statistics_info, budget);
             break;
         }
         case ::openmldb::storage::TTLType::kAbsOrLat: {
@@ -470,7 +786,7 @@ void Segment::ExecuteGc(const TTLSt& ttl_st, StatisticsInfo* statistics_info) {
                 return;
             }
             uint64_t expire_time = ttl_st.abs_ttl == 0 ? 0 : cur_time - ttl_offset_ - ttl_st.abs_ttl;
-            Gc4TTLOrHead(expire_time, ttl_st.lat_ttl, statistics_info);
+            Gc4TTLOrHead(expire_time, ttl_st.lat_ttl, statistics_info, budget);
             break;
         }
         default:
@@ -479,7 +795,9 @@ void Segment::ExecuteGc(const TTLSt& ttl_st, StatisticsInfo* statistics_info) {
 }
 
 void Segment::ExecuteGc(const std::map<uint32_t, TTLSt>& ttl_st_map, StatisticsInfo* statistics_info,
-                        std::optional<uint32_t> clustered_ts_id) {
+                        std::optional<uint32_t> clustered_ts_id, const GcBudget& budget) {
+    gc_pass_stopped_ = false;
+    gc_visited_key_cnt_ = 0;
     if (ttl_st_map.empty()) {
         return;
     }
@@ -488,7 +806,7 @@ void Segment::ExecuteGc(const std::map<uint32_t, TTLSt>& ttl_st_map, StatisticsI
             DLOG(INFO) << "skip normal gc in cidx";
             return;
         }
-        ExecuteGc(ttl_st_map.begin()->second, statistics_info);
+        ExecuteGc(ttl_st_map.begin()->second, statistics_info, budget);
         return;
     }
     bool need_gc = false;
@@ -503,31 +821,29 @@ void Segment::ExecuteGc(const std::map<uint32_t, TTLSt>& ttl_st_map, StatisticsI
     if (!need_gc) {
         return;
     }
-    GcAllType(ttl_st_map, statistics_info, clustered_ts_id);
+    GcAllType(ttl_st_map, statistics_info, clustered_ts_id, budget);
 }
 
-void Segment::Gc4Head(uint64_t keep_cnt, StatisticsInfo* statistics_info) {
+void Segment::Gc4Head(uint64_t keep_cnt, StatisticsInfo* statistics_info, const GcBudget& budget) {
     if (keep_cnt == 0) {
         PDLOG(WARNING, "[Gc4Head] segment gc4head is disabled");
         return;
     }
     uint64_t consumed = ::baidu::common::timer::get_micros();
     uint64_t old = statistics_info->GetIdxCnt(0);
-    std::unique_ptr<KeyEntries::Iterator> it(entries_->NewIterator());
-    it->SeekToFirst();
-    while (it->Valid()) {
-        auto entry = reinterpret_cast<KeyEntry*>(it->GetValue());
-        ::openmldb::base::Node<uint64_t, DataBlock*>* node = nullptr;
-        {
-            std::lock_guard<std::mutex> lock(mu_);
-            if (entry->refs_.load(std::memory_order_acquire) <= 0) {
-                node = entry->entries.SplitByPos(keep_cnt);
-            }
+    GcScanner scanner(this, budget, 0);
+    Slice key;
+    void* value = nullptr;
+    while (scanner.Next(&key, &value)) {
+        auto entry = reinterpret_cast<KeyEntry*>(value);
+        RemovedRows rows;
+        if (entry->refs_.load(std::memory_order_acquire) <= 0) {
+            rows = entry->entries.SplitByPos(keep_cnt, slab_.get());
+            CompactEntry(entry, &rows);
         }
         uint64_t cur_idx_cnt = statistics_info->GetIdxCnt(0);
-        FreeList(0, node, statistics_info);
+        FreeList(0, &rows, statistics_info);
         entry->count_.fetch_sub(statistics_info->GetIdxCnt(0) - cur_idx_cnt, std::memory_order_relaxed);
-        it->Next();
     }
     DEBUGLOG("[Gc4Head] segment gc keep cnt %lu consumed %lu, count %lu", keep_cnt,
              (::baidu::common::timer::get_micros() - consumed) / 1000, statistics_info->GetIdxCnt(0) - old);
@@ -535,19 +851,18 @@ void Segment::Gc4Head(uint64_t keep_cnt, StatisticsInfo* statistics_info) {
 }
 
 void Segment::GcAllType(const std::map<uint32_t, TTLSt>& ttl_st_map, StatisticsInfo* statistics_info,
-                        std::optional<uint32_t> clustered_ts_id) {
+                        std::optional<uint32_t> clustered_ts_id, const GcBudget& budget) {
     uint64_t old = statistics_info->GetTotalCnt();
     uint64_t consumed = ::baidu::common::timer::get_micros();
-    std::unique_ptr<KeyEntries::Iterator> it(entries_->NewIterator());
-    it->SeekToFirst();
+    GcScanner scanner(this, budget, 0);
     for (auto [ts, ttl_st] : ttl_st_map) {
         DLOG(INFO) << "ts " << ts << " ttl_st " << ttl_st.ToString() << " it will be current time - ttl?";
     }
 
-    while (it->Valid()) {
-        KeyEntry** entry_arr = reinterpret_cast<KeyEntry**>(it->GetValue());
-        Slice key = it->GetKey();
-        it->Next();
+    Slice key;
+    void* value = nullptr;
+    while (scanner.Next(&key, &value)) {
+        KeyEntry** entry_arr = reinterpret_cast<KeyEntry**>(value);
         uint32_t empty_cnt = 0;
         for (const auto& kv : ttl_st_map) {
             if (!kv.second.NeedGc()) {
@@ -563,17 +878,15 @@ void Segment::GcAllType(const std::map<uint32_t, TTLSt>& ttl_st_map, StatisticsI
                 continue;
             }
             KeyEntry* entry = entry_arr[pos->second];
-            ::openmldb::base::Node<uint64_t, DataBlock*>* node = nullptr;
+            RemovedRows rows;
+            uint64_t last_ts = 0;
             bool continue_flag = false;
             switch (kv.second.ttl_type) {
                 case ::openmldb::storage::TTLType::kAbsoluteTime: {
-                    node = entry->entries.GetLast();
-                    if (node == nullptr || node->GetKey() > kv.second.abs_ttl) {
+                    if (!entry->entries.GetLastTime(&last_ts) || last_ts > kv.second.abs_ttl) {
                         continue_flag = true;
                     } else {
-                        node = nullptr;
-                        std::lock_guard<std::mutex> lock(mu_);
-                        SplitList(entry, kv.second.abs_ttl, &node);
+                        SplitList(entry, kv.second.abs_ttl, &rows);
                         if (entry->entries.IsEmpty()) {
                             DLOG(INFO) << "gc key " << key.ToString() << " is empty";
                             empty_cnt++;
@@ -582,40 +895,38 @@ void Segment::GcAllType(const std::map<uint32_t, TTLSt>& ttl_st_map, StatisticsI
                     break;
                 }
                 case ::openmldb::storage::TTLType::kLatestTime: {
-                    std::lock_guard<std::mutex> lock(mu_);
                     if (entry->refs_.load(std::memory_order_acquire) <= 0) {
-                        node = entry->entries.SplitByPos(kv.second.lat_ttl);
+                        rows = entry->entries.SplitByPos(kv.second.lat_ttl, slab_.get());
+                        CompactEntry(entry, &rows);
                     }
                     break;
                 }
                 case ::openmldb::storage::TTLType::kAbsAndLat: {
-                    node = entry->entries.GetLast();
-                    if (node == nullptr || node->GetKey() > kv.second.abs_ttl) {
+                    if (!entry->entries.GetLastTime(&last_ts) || last_ts > kv.second.abs_ttl) {
                         continue_flag = true;
                     } else {
-                        node = nullptr;
-                        std::lock_guard<std::mutex> lock(mu_);
                         if (entry->refs_.load(std::memory_order_acquire) <= 0) {
-                            node = entry->entries.SplitByKeyAndPos(kv.second.abs_ttl, kv.second.lat_ttl);
+                            rows = entry->entries.SplitByKeyAndPos(kv.second.abs_ttl, kv.second.lat_ttl,
+                                                                   slab_.get());
+                            CompactEntry(entry, &rows);
                         }
                     }
                     break;
                 }
                 case ::openmldb::storage::TTLType::kAbsOrLat: {
-                    node = entry->entries.GetLast();
-                    if (node == nullptr) {
+                    if (!entry->entries.GetLastTime(&last_ts)) {
                         continue_flag = true;
                     } else {
-                        node = nullptr;
-                        std::lock_guard<std::mutex> lock(mu_);
                         if (entry->refs_.load(std::memory_order_acquire) <= 0) {
                             if (kv.second.abs_ttl == 0) {
-                                node = entry->entries.SplitByPos(kv.second.lat_ttl);
+                                rows = entry->entries.SplitByPos(kv.second.lat_ttl, slab_.get());
                             } else if (kv.second.lat_ttl == 0) {
-                                node = entry->entries.Split(kv.second.abs_ttl);
+                                rows = entry->entries.Split(kv.second.abs_ttl, slab_.get());
                             } else {
-                                node = entry->entries.SplitByKeyOrPos(kv.second.abs_ttl, kv.second.lat_ttl);
+                                rows = entry->entries.SplitByKeyOrPos(kv.second.abs_ttl, kv.second.lat_ttl,
+                                                                      slab_.get());
                             }
+                            CompactEntry(entry, &rows);
                         }
                         if (entry->entries.IsEmpty()) {
                             empty_cnt++;
@@ -630,25 +941,16 @@ void Segment::GcAllType(const std::map<uint32_t, TTLSt>& ttl_st_map, StatisticsI
                 continue;
             }
             uint64_t cur_idx_cnt = statistics_info->GetIdxCnt(pos->second);
-            FreeList(pos->second, node, statistics_info);
+            FreeList(pos->second, &rows, statistics_info);
             uint64_t free_idx_cnt = statistics_info->GetIdxCnt(pos->second) - cur_idx_cnt;
             entry->count_.fetch_sub(free_idx_cnt, std::memory_order_relaxed);
             idx_cnt_vec_[pos->second]->fetch_sub(free_idx_cnt, std::memory_order_relaxed);
         }
         if (empty_cnt == ts_cnt_) {
-            bool is_empty = true;
             ::openmldb::base::Node<Slice, void*>* entry_node = nullptr;
             {
-                std::lock_guard<std::mutex> lock(mu_);
-                for (uint32_t i = 0; i < ts_cnt_; i++) {
-                    if (!entry_arr[i]->entries.IsEmpty()) {
-                        is_empty = false;
-                        break;
-                    }
-                }
-                if (is_empty) {
-                    entry_node = entries_->Remove(key);
-                }
+                std::lock_guard<std::shared_mutex> lock(mu_);
+                entry_node = RemoveKeyEntryUnlock(key, true);
             }
             if (entry_node != nullptr) {
                 DLOG(INFO) << "add key " << key.ToString() << " to node cache. version " << gc_version_;
@@ -660,10 +962,11 @@ void Segment::GcAllType(const std::map<uint32_t, TTLSt>& ttl_st_map, StatisticsI
                << "ms, count " << statistics_info->GetTotalCnt() - old;
 }
 
-void Segment::SplitList(KeyEntry* entry, uint64_t ts, ::openmldb::base::Node<uint64_t, DataBlock*>** node) {
+void Segment::SplitList(KeyEntry* entry, uint64_t ts, RemovedRows* rows) {
     // skip entry that ocupied by reader
     if (entry->refs_.load(std::memory_order_acquire) <= 0) {
-        *node = entry->entries.Split(ts);
+        *rows = entry->entries.Split(ts, slab_.get());
+        CompactEntry(entry, rows);
     }
 }
 
@@ -697,37 +1000,38 @@ bool Segment::ListContains(KeyEntry* entry, uint64_t time, DataBlock* row, bool
 }
 
 // fast gc with no global pause
-void Segment::Gc4TTL(const uint64_t time, StatisticsInfo* statistics_info) {
+void Segment::Gc4TTL(const uint64_t time, StatisticsInfo* statistics_info, const GcBudget& budget) {
     uint64_t consumed = ::baidu::common::timer::get_micros();
     uint64_t old = statistics_info->GetIdxCnt(0);
-    std::unique_ptr<KeyEntries::Iterator> it(entries_->NewIterator());
-    it->SeekToFirst();
-    while (it->Valid()) {
-        KeyEntry* entry = reinterpret_cast<KeyEntry*>(it->GetValue());
-        Slice key = it->GetKey();
-        it->Next();
-        ::openmldb::base::Node<uint64_t, DataBlock*>* node = entry->entries.GetLast();
-        if (node == nullptr) {
+    GcScanner scanner(this, budget, time);
+    Slice key;
+    void* value = nullptr;
+    while (scanner.Next(&key, &value)) {
+        KeyEntry* entry = reinterpret_cast<KeyEntry*>(value);
+        uint64_t last_ts = 0;
+        if (!entry->entries.GetLastTime(&last_ts)) {
             continue;
-        } else if (node->GetKey() > time) {
-            DEBUGLOG("[Gc4TTL] segment gc with key %lu need not ttl, last node key %lu", time, node->GetKey());
+        } else if (last_ts > time) {
+            DEBUGLOG("[Gc4TTL] segment gc with key %lu need not ttl, last node key %lu", time, last_ts);
+            scanner.Keep(last_ts);
             continue;
         }
-        node = nullptr;
+        RemovedRows rows;
+        SplitList(entry, time, &rows);
         ::openmldb::base::Node<Slice, void*>* entry_node = nullptr;
-        {
-            std::lock_guard<std::mutex> lock(mu_);
-            SplitList(entry, time, &node);
-            if (entry->entries.IsEmpty()) {
-                entry_node = entries_->Remove(key);
-            }
+        if (entry->entries.IsEmpty()) {
+            std::lock_guard<std::shared_mutex> lock(mu_);
+            entry_node = RemoveKeyEntryUnlock(key, true);
+        }
+        if (entry_node == nullptr && entry->entries.GetLastTime(&last_ts)) {
+            scanner.Keep(last_ts);
         }
         if (entry_node != nullptr) {
             DLOG(INFO) << "add key " << key.ToString() << " to node cache. version " << gc_version_;
             node_cache_.AddKeyEntryNode(gc_version_.load(std::memory_order_relaxed), entry_node);
         }
         uint64_t cur_idx_cnt = statistics_info->GetIdxCnt(0);
-        FreeList(0, node, statistics_info);
+        FreeList(0, &rows, statistics_info);
         entry->count_.fetch_sub(statistics_info->GetIdxCnt(0) - cur_idx_cnt, std::memory_order_relaxed);
     }
     DEBUGLOG("[Gc4TTL] segment gc with key %lu ,consumed %lu, count %lu", time,
@@ -735,34 +1039,37 @@ void Segment::Gc4TTL(const uint64_t time, StatisticsInfo* statistics_info) {
     idx_cnt_vec_[0]->fetch_sub(statistics_info->GetIdxCnt(0) - old, std::memory_order_relaxed);
 }
 
-void Segment::Gc4TTLAndHead(const uint64_t time, const uint64_t keep_cnt, StatisticsInfo* statistics_info) {
+void Segment::Gc4TTLAndHead(const uint64_t time, const uint64_t keep_cnt, StatisticsInfo* statistics_info,
+                            const GcBudget& budget) {
     if (time == 0 || keep_cnt == 0) {
         PDLOG(INFO, "[Gc4TTLAndHead] segment gc4ttlandhead is disabled");
         return;
     }
     uint64_t consumed = ::baidu::common::timer::get_micros();
     uint64_t old = statistics_info->GetIdxCnt(0);
-    std::unique_ptr<KeyEntries::Iterator> it(entries_->NewIterator());
-    it->SeekToFirst();
-    while (it->Valid()) {
-        KeyEntry* entry = reinterpret_cast<KeyEntry*>(it->GetValue());
-        ::openmldb::base::Node<uint64_t, DataBlock*>* node = entry->entries.GetLast();
-        it->Next();
-        if (node == nullptr) {
+    GcScanner scanner(this, budget, time);
+    Slice key;
+    void* value = nullptr;
+    while (scanner.Next(&key, &value)) {
+        KeyEntry* entry = reinterpret_cast<KeyEntry*>(value);
+        uint64_t last_ts = 0;
+        if (!entry->entries.GetLastTime(&last_ts)) {
             continue;
-        } else if (node->GetKey() > time) {
-            DEBUGLOG("[Gc4TTLAndHead] segment gc with key %lu need not ttl, last node key %lu", time, node->GetKey());
+        } else if (last_ts > time) {
+            DEBUGLOG("[Gc4TTLAndHead] segment gc with key %lu need not ttl, last node key %lu", time, last_ts);
+            scanner.Keep(last_ts);
             continue;
         }
-        node = nullptr;
-        {
-            std::lock_guard<std::mutex> lock(mu_);
-            if (entry->refs_.load(std::memory_order_acquire) <= 0) {
-                node = entry->entries.SplitByKeyAndPos(time, keep_cnt);
-            }
+        RemovedRows rows;
+        if (entry->refs_.load(std::memory_order_acquire) <= 0) {
+            rows = entry->entries.SplitByKeyAndPos(time, keep_cnt, slab_.get());
+            CompactEntry(entry, &rows);
+        }
+        if (entry->entries.GetLastTime(&last_ts)) {
+            scanner.Keep(last_ts);
         }
         uint64_t cur_idx_cnt = statistics_info->GetIdxCnt(0);
-        FreeList(0, node, statistics_info);
+        FreeList(0, &rows, statistics_info);
         entry->count_.fetch_sub(statistics_info->GetIdxCnt(0) - cur_idx_cnt, std::memory_order_relaxed);
     }
     DEBUGLOG("[Gc4TTLAndHead] segment gc time %lu and keep cnt %lu consumed %lu, count %lu", time, keep_cnt,
@@ -770,46 +1077,45 @@ void Segment::Gc4TTLAndHead(const uint64_t time, const uint64_t keep_cnt, Statis
     idx_cnt_vec_[0]->fetch_sub(statistics_info->GetIdxCnt(0) - old, std::memory_order_relaxed);
 }
 
-void Segment::Gc4TTLOrHead(const uint64_t time, const uint64_t keep_cnt, StatisticsInfo* statistics_info) {
+void Segment::Gc4TTLOrHead(const uint64_t time, const uint64_t keep_cnt, StatisticsInfo* statistics_info,
+                           const GcBudget& budget) {
     if (time == 0 && keep_cnt == 0) {
         PDLOG(INFO, "[Gc4TTLOrHead] segment gc4ttlorhead is disabled");
         return;
     } else if (time == 0) {
-        Gc4Head(keep_cnt, statistics_info);
+        Gc4Head(keep_cnt, statistics_info, budget);
         return;
     } else if (keep_cnt == 0) {
-        Gc4TTL(time, statistics_info);
+        Gc4TTL(time, statistics_info, budget);
         return;
     }
     uint64_t consumed = ::baidu::common::timer::get_micros();
     uint64_t old = statistics_info->GetIdxCnt(0);
-    std::unique_ptr<KeyEntries::Iterator> it(entries_->NewIterator());
-    it->SeekToFirst();
-    while (it->Valid()) {
-        KeyEntry* entry = reinterpret_cast<KeyEntry*>(it->GetValue());
-        Slice key = it->GetKey();
-        it->Next();
-        ::openmldb::base::Node<uint64_t, DataBlock*>* node = entry->entries.GetLast();
-        if (node == nullptr) {
+    // the rows beyond keep_cnt expire whatever their time is, so all keys are visited
+    GcScanner scanner(this, budget, 0);
+    Slice key;
+    void* value = nullptr;
+    while (scanner.Next(&key, &value)) {
+        KeyEntry* entry = reinterpret_cast<KeyEntry*>(value);
+        if (entry->entries.IsEmpty()) {
             continue;
         }
-        node = nullptr;
+        RemovedRows rows;
+        if (entry->refs_.load(std::memory_order_acquire) <= 0) {
+            rows = entry->entries.SplitByKeyOrPos(time, keep_cnt, slab_.get());
+            CompactEntry(entry, &rows);
+        }
         ::openmldb::base::Node<Slice, void*>* entry_node = nullptr;
-        {
-            std::lock_guard<std::mutex> lock(mu_);
-            if (entry->refs_.load(std::memory_order_acquire) <= 0) {
-                node = entry->entries.SplitByKeyOrPos(time, keep_cnt);
-            }
-            if (entry->entries.IsEmpty()) {
-                entry_node = entries_->Remove(key);
-            }
+        if (entry->entries.IsEmpty()) {
+            std::lock_guard<std::shared_mutex> lock(mu_);
+            entry_node = RemoveKeyEntryUnlock(key, true);
         }
         if (entry_node != nullptr) {
             DLOG(INFO) << "add key " << key.ToString() << " to node cache. version " << gc_version_;
             node_cache_.AddKeyEntryNode(gc_version_.load(std::memory_order_relaxed), entry_node);
         }
         uint64_t cur_idx_cnt = statistics_info->GetIdxCnt(0);
-        FreeList(0, node, statistics_info);
+        FreeList(0, &rows, statistics_info);
         entry->count_.fetch_sub(statistics_info->GetIdxCnt(0) - cur_idx_cnt, std::memory_order_relaxed);
     }
     DEBUGLOG("[Gc4TTLAndHead] segment gc time %lu and keep cnt %lu consumed %lu, count %lu", time, keep_cnt,
@@ -822,7 +1128,7 @@ int Segment::GetCount(const Slice& key, uint64_t& count) {
         return -1;
     }
     void* entry = nullptr;
-    if (entries_->Get(key, entry) < 0 || entry == nullptr) {
+    if (!KeyMayExist(key) || GetKeyEntry(key, entry) < 0 || entry == nullptr) {
         return -1;
     }
     count = reinterpret_cast<KeyEntry*>(entry)->count_.load(std::memory_order_relaxed);
@@ -838,19 +1144,180 @@ int Segment::GetCount(const Slice& key, uint32_t idx, uint64_t& count) {
         return GetCount(key, count);
     }
     void* entry_arr = nullptr;
-    if (entries_->Get(key, entry_arr) < 0 || entry_arr == nullptr) {
+    if (!KeyMayExist(key) || GetKeyEntry(key, entry_arr) < 0 || entry_arr == nullptr) {
         return -1;
     }
     count = reinterpret_cast<KeyEntry**>(entry_arr)[pos->second]->count_.load(std::memory_order_relaxed);
     return 0;
 }
 
+int Segment::GetPutCount(const Slice& key, uint32_t idx, uint64_t& count) {
+    void* entry = nullptr;
+    if (!KeyMayExist(key) || GetKeyEntry(key, entry) < 0 || entry == nullptr) {
+        return -1;
+    }
+    if (ts_cnt_ == 1) {
+        count = reinterpret_cast<KeyEntry*>(entry)->GetPutCount();
+        return 0;
+    }
+    auto pos = ts_idx_map_.find(idx);
+    if (pos == ts_idx_map_.end()) {
+        return -1;
+    }
+    count = reinterpret_cast<KeyEntry**>(entry)[pos->second]->GetPutCount();
+    return 0;
+}
+
+int Segment::GetKeyEntry(const Slice& key, void*& entry) {
+    auto index = key_index_.load(std::memory_order_acquire);
+    // a full index may miss keys
+    if (index == nullptr || index->IsFull()) {
+        return entries_->Get(key, entry);
+    }
+    auto node = index->Get(key);
+    if (node == nullptr) {
+        return -1;
+    }
+    entry = node->GetValue();
+    return 0;
+}
+
+void Segment::ReserveKeyIndex(uint64_t n) {
+    auto index = key_index_.load(std::memory_order_acquire);
+    if (index == nullptr || !index->NeedGrow(n)) {
+        return;
+    }
+    // one put builds the index, the others go on with the old one. a full index falls back to the skiplist
+    std::unique_lock<std::mutex> grow_lock(grow_key_index_mu_, std::try_to_lock);
+    if (!grow_lock.owns_lock()) {
+        return;
+    }
+    index = key_index_.load(std::memory_order_acquire);
+    if (index == nullptr || !index->NeedGrow(n)) {
+        return;
+    }
+    // rebuilt from the skiplist, it drops the removed slots and recovers the keys missed by a full index
+    auto new_index = std::make_unique<KeyIndex>(pk_cnt_.load(std::memory_order_relaxed) + n);
+    {
+        std::lock_guard<std::shared_mutex> lock(mu_);
+        building_key_index_ = new_index.get();
+    }
+    // the keys inserted from now on are added by the puts. the nodes removed during the traverse are kept by
+    // GcFreeList until the build is done, so the traverse is safe without mu_
+    std::unique_ptr<KeyEntries::Iterator> it(entries_->NewIterator());
+    for (it->SeekToFirst(); it->Valid(); it->Next()) {
+        new_index->Insert(it->GetNode());
+    }
+    std::lock_guard<std::shared_mutex> lock(mu_);
+    if (building_key_index_ != new_index.get()) {
+        // released during the build
+        return;
+    }
+    for (auto node : building_removed_nodes_) {
+        new_index->Remove(node);
+    }
+    building_key_index_ = nullptr;
+    building_removed_nodes_.clear();
+    DLOG(INFO) << "grow key index from " << index->GetCapacity() << " to " << new_index->GetCapacity();
+    ReplaceKeyIndexUnlock(new_index.release());
+}
+
+void Segment::ReplaceKeyIndexUnlock(KeyIndex* index) {
+    auto old_index = key_index_.exchange(index, std::memory_order_acq_rel);
+    std::lock_guard<std::mutex> lock(retired_mu_);
+    retired_key_indexes_.emplace_back(gc_version_.load(std::memory_order_relaxed), old_index);
+}
+
+uint8_t Segment::InsertKeyEntryUnlock(const Slice& key, void* entry) {
+    AddToKeyFilter(key);
+    uint8_t height = 0;
+    auto node = entries_->ConcurrentInsert(key, entry, slab_.get(), false, &height);
+    InsertKeyIndex(node);
+    return height;
+}
+
+void Segment::InsertKeyIndex(base::Node<Slice, void*>* node) {
+    if (auto index = key_index_.load(std::memory_order_relaxed); index != nullptr) {
+        index->Insert(node);
+    }
+    if (building_key_index_ != nullptr) {
+        building_key_index_->Insert(node);
+    }
+}
+
+base::Node<Slice, void*>* Segment::RemoveKeyEntryUnlock(const Slice& key, bool only_empty) {
+    void* entry = nullptr;
+    if (GetKeyEntry(key, entry) < 0 || entry == nullptr) {
+        return nullptr;
+    }
+    if (ts_cnt_ == 1) {
+        if (!reinterpret_cast<KeyEntry*>(entry)->entries.Close(only_empty)) {
+            return nullptr;
+        }
+    } else {
+        KeyEntry** entry_arr = reinterpret_cast<KeyEntry**>(entry);
+        for (uint32_t i = 0; i < ts_cnt_; i++) {
+            if (!entry_arr[i]->entries.Close(only_empty)) {
+                // a put comes, the puts that see the closed entries wait for mu_ and find the key again
+                for (uint32_t j = 0; j < i; j++) {
+                    entry_arr[j]->entries.Reopen();
+                }
+                return nullptr;
+            }
+        }
+    }
+    auto node = entries_->Remove(key);
+    if (auto index = key_index_.load(std::memory_order_relaxed); index != nullptr && node != nullptr) {
+        index->Remove(node);
+    }
+    if (building_key_index_ != nullptr && node != nullptr) {
+        // the traverse of the build could still insert it
+        building_key_index_->Remove(node);
+        building_removed_nodes_.push_back(node);
+    }
+    return node;
+}
+
+void Segment::ReplaceKeyFilterUnlock(KeyFilter* filter) {
+    auto old_filter = key_filter_.exchange(filter, std::memory_order_acq_rel);
+    std::lock_guard<std::mutex> lock(retired_mu_);
+    retired_key_filters_.emplace_back(gc_version_.load(std::memory_order_relaxed), old_filter);
+}
+
+void Segment::RebuildKeyFilter() {
+    auto filter = key_filter_.load(std::memory_order_acquire);
+    if (filter == nullptr) {
+        return;
+    }
+    uint64_t pk_cnt = GetPkCnt();
+    uint64_t capacity = std::max(pk_cnt * 2, kKeyFilterMinCapacity);
+    if (filter->GetStageCnt() <= 1 && filter->GetKeyCnt() <= capacity) {
+        return;
+    }
+    auto new_filter = std::make_unique<KeyFilter>(filter->GetBitsPerKey(), capacity);
+    {
+        std::lock_guard<std::shared_mutex> lock(mu_);
+        building_key_filter_ = new_filter.get();
+    }
+    // the keys inserted from now on are added by the puts. the nodes removed by deletes during the traverse
+    // are freed by a later GcFreeList of the gc thread, so the traverse is safe without mu_
+    std::unique_ptr<KeyEntries::Iterator> it(entries_->NewIterator());
+    for (it->SeekToFirst(); it->Valid(); it->Next()) {
+        new_filter->Add(it->GetKey());
+    }
+    DLOG(INFO) << "rebuild key filter with " << new_filter->GetKeyCnt() << " keys, old filter has "
+               << filter->GetKeyCnt() << " keys in " << filter->GetStageCnt() << " stages";
+    std::lock_guard<std::shared_mutex> lock(mu_);
+    building_key_filter_ = nullptr;
+    ReplaceKeyFilterUnlock(new_filter.release());
+}
+
 MemTableIterator* Segment::NewIterator(const Slice& key, Ticket& ticket, type::CompressType compress_type) {
     if (entries_ == nullptr || ts_cnt_ > 1) {
         return new MemTableIterator(nullptr, compress_type);
     }
     void* entry = nullptr;
-    if (entries_->Get(key, entry) < 0 || entry == nullptr) {
+    if (!KeyMayExist(key) || GetKeyEntry(key, entry) < 0 || entry == nullptr) {
         return new MemTableIterator(nullptr, compress_type);
     }
     ticket.Push(reinterpret_cast<KeyEntry*>(entry));
@@ -867,7 +1334,7 @@ MemTableIterator* Segment::NewIterator(const Slice& key, uint32_t idx, Ticket& t
         return NewIterator(key, ticket, compress_type);
     }
     void* entry_arr = nullptr;
-    if (entries_->Get(key, entry_arr) < 0 || entry_arr == nullptr) {
+    if (!KeyMayExist(key) || GetKeyEntry(key, entry_arr) < 0 || entry_arr == nullptr) {
         return new MemTableIterator(nullptr, compress_type);
     }
     auto entry = reinterpret_cast<KeyEntry**>(entry_arr)[pos->second];
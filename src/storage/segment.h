@@ -22,14 +22,19 @@
 #include <memory>
 #include <mutex>  // NOLINT
 #include <optional>
+#include <shared_mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/skiplist.h"
+#include "base/slab_allocator.h"
 #include "base/slice.h"
 #include "proto/tablet.pb.h"
 #include "storage/iterator.h"
 #include "storage/key_entry.h"
+#include "storage/key_filter.h"
+#include "storage/key_index.h"
 #include "storage/node_cache.h"
 #include "storage/schema.h"
 #include "storage/ticket.h"
@@ -65,10 +70,28 @@ struct SliceComparator {
 using KeyEntries = base::Skiplist<base::Slice, void*, SliceComparator>;
 using KeyEntryNodeList = base::Skiplist<uint64_t, base::Node<Slice, void*>*, TimeComparator>;
 
+// a row of a batch put into one segment, the key and the ts map must outlive the put
+struct SegmentPutRow {
+    Slice key;
+    const std::map<int32_t, uint64_t>* ts_map;
+    DataBlock* row;
+};
+
+// the budget of one gc slice of a segment, 0 is unlimited. gc with a budget is incremental: a slice stops when
+// the budget runs out and the next slice resumes from the key it stops at
+struct GcBudget {
+    uint64_t key_cnt = 0;
+    uint64_t time_us = 0;
+
+    bool IsIncremental() const { return key_cnt > 0 || time_us > 0; }
+};
+
 class Segment {
  public:
-    explicit Segment(uint8_t height);
-    Segment(uint8_t height, const std::vector<uint32_t>& ts_idx_vec);
+    // if slab is not null, the nodes of key entries and time entries are allocated from it
+    explicit Segment(uint8_t height, std::shared_ptr<base::SlabAllocator> slab = nullptr);
+    Segment(uint8_t height, const std::vector<uint32_t>& ts_idx_vec,
+            std::shared_ptr<base::SlabAllocator> slab = nullptr);
     virtual ~Segment();
 
     // legacy interface called by memtable and ut
@@ -81,6 +104,8 @@ class Segment {
     // main put method
     virtual bool Put(const Slice& key, const std::map<int32_t, uint64_t>& ts_map, DataBlock* row,
                      bool put_if_absent = false);
+    // put the rows of a batch, it does not check if the rows exist
+    void Put(const std::vector<SegmentPutRow>& rows);
 
     bool Delete(const std::optional<uint32_t>& idx, const Slice& key);
     bool Delete(const std::optional<uint32_t>& idx, const Slice& key, uint64_t ts,
@@ -88,16 +113,32 @@ class Segment {
 
     void Release(StatisticsInfo* statistics_info);
 
-    void ExecuteGc(const TTLSt& ttl_st, StatisticsInfo* statistics_info);
+    void ExecuteGc(const TTLSt& ttl_st, StatisticsInfo* statistics_info, const GcBudget& budget = GcBudget());
     void ExecuteGc(const std::map<uint32_t, TTLSt>& ttl_st_map, StatisticsInfo* statistics_info,
-                   std::optional<uint32_t> clustered_ts_id = std::nullopt);
-
-    void Gc4TTL(const uint64_t time, StatisticsInfo* statistics_info);
-    void Gc4Head(uint64_t keep_cnt, StatisticsInfo* statistics_info);
-    void Gc4TTLAndHead(const uint64_t time, const uint64_t keep_cnt, StatisticsInfo* statistics_info);
-    void Gc4TTLOrHead(const uint64_t time, const uint64_t keep_cnt, StatisticsInfo* statistics_info);
+                   std::optional<uint32_t> clustered_ts_id = std::nullopt, const GcBudget& budget = GcBudget());
+
+    void Gc4TTL(const uint64_t time, StatisticsInfo* statistics_info, const GcBudget& budget = GcBudget());
+    void Gc4Head(uint64_t keep_cnt, StatisticsInfo* statistics_info, const GcBudget& budget = GcBudget());
+    void Gc4TTLAndHead(const uint64_t time, const uint64_t keep_cnt, StatisticsInfo* statistics_info,
+                       const GcBudget& budget = GcBudget());
+    void Gc4TTLOrHead(const uint64_t time, const uint64_t keep_cnt, StatisticsInfo* statistics_info,
+                      const GcBudget& budget = GcBudget());
     void GcAllType(const std::map<uint32_t, TTLSt>& ttl_st_map, StatisticsInfo* statistics_info,
-                   std::optional<uint32_t> clustered_ts_id = std::nullopt);
+                   std::optional<uint32_t> clustered_ts_id = std::nullopt, const GcBudget& budget = GcBudget());
+
+    // false if the last gc stopped at its budget before it visited all keys, the next gc resumes the pass
+    bool IsGcPassFinished() const { return !gc_pass_stopped_; }
+    // the keys visited by the last gc
+    uint64_t GetGcVisitedKeyCnt() const { return gc_visited_key_cnt_; }
+
+    // false if the key filter tells the key is absent, always true if the filter is disabled
+    bool KeyMayExist(const Slice& key) const {
+        auto filter = key_filter_.load(std::memory_order_acquire);
+        return filter == nullptr || filter->MayContain(key);
+    }
+    // build a new key filter sized to the current keys if the filter has grown stages or the keys removed
+    // by gc make up half of it. it must be called by the gc thread
+    void RebuildKeyFilter();
 
     MemTableIterator* NewIterator(const Slice& key, Ticket& ticket, type::CompressType compress_type);  // NOLINT
     MemTableIterator* NewIterator(const Slice& key, uint32_t idx, Ticket& ticket,                       // NOLINT
@@ -136,8 +177,15 @@ class Segment {
 
     KeyEntries* GetKeyEntries() { return entries_; }
 
+    // the point lookup of the key entry or the entry array of key, it is served by the key index if enabled
+    int GetKeyEntry(const Slice& key, void*& entry);  // NOLINT
+
     int GetCount(const Slice& key, uint64_t& count);                // NOLINT
     int GetCount(const Slice& key, uint32_t idx, uint64_t& count);  // NOLINT
+    // the count of the rows ever put into the entry of key and ts column idx, see KeyEntry::GetPutCount
+    int GetPutCount(const Slice& key, uint32_t idx, uint64_t& count);  // NOLINT
+    // the count of the deletes on the segment, a delete counts after its rows are removed. Gc is not counted
+    uint64_t GetDeleteCount() const { return delete_cnt_.load(std::memory_order_acquire); }
 
     void IncrGcVersion() { gc_version_.fetch_add(1, std::memory_order_relaxed); }
 
@@ -145,29 +193,126 @@ class Segment {
 
     void ReleaseAndCount(const std::vector<size_t>& id_vec, StatisticsInfo* statistics_info);
 
+    base::SlabAllocator* GetSlab() const { return slab_.get(); }
+
  protected:
-    void FreeList(uint32_t ts_idx, ::openmldb::base::Node<uint64_t, DataBlock*>* node, StatisticsInfo* statistics_info);
-    void SplitList(KeyEntry* entry, uint64_t ts, ::openmldb::base::Node<uint64_t, DataBlock*>** node);
+    void FreeList(uint32_t ts_idx, RemovedRows* rows, StatisticsInfo* statistics_info);
+    void SplitList(KeyEntry* entry, uint64_t ts, RemovedRows* rows);
+    // compact the time index of entry after gc removes rows into rows
+    void CompactEntry(KeyEntry* entry, RemovedRows* rows);
+    // insert a row into the time index of entry with mu_ held exclusively, so the key can not be closed. The index
+    // it replaces is retired to the node cache
+    uint32_t InsertEntry(uint32_t ts_idx, KeyEntry* entry, uint64_t time, DataBlock* row);
+    // insert a row into the entry of ts_idx of key without mu_. key_entry is the entry or the entry array of key
+    // got before or nullptr, a key removed meanwhile is looked up again. Add the idx byte size to byte_size,
+    // return false if put_if_absent is set and the row exists
+    bool InsertEntry(const Slice& key, uint32_t ts_idx, uint64_t time, DataBlock* row, bool put_if_absent,
+                     bool check_all_time, void** key_entry, uint32_t* byte_size);
     bool GetTsIdx(const std::optional<uint32_t>& idx, uint32_t* ts_idx);
 
     bool ListContains(KeyEntry* entry, uint64_t time, DataBlock* row, bool check_all_time);
 
+    // PutUnlock of segment runs without mu_, the one of a segment without concurrent put needs it held exclusively
     virtual bool PutUnlock(const Slice& key, uint64_t time, DataBlock* row, bool put_if_absent = false,
                            bool check_all_time = false);
 
+    bool PutMultiTsUnlock(const Slice& key, const std::map<int32_t, uint64_t>& ts_map, DataBlock* row,
+                          bool put_if_absent);
+
+    // whether PutUnlock is safe to run without mu_
+    virtual bool SupportConcurrentPut() const { return true; }
+
+    // return the key entry or the entry array of key, create it with mu_ held shared if it does not exist. A put
+    // whose key is closed skips the lookup without mu_, the key is unlinked or reopened once mu_ is got
+    void* GetOrCreateEntry(const Slice& key, uint32_t* byte_size, bool skip_lookup = false);
+
+    // add a new key to the key filter before it is inserted to entries_, mu_ must be held
+    void AddToKeyFilter(const Slice& key) {
+        if (auto filter = key_filter_.load(std::memory_order_relaxed); filter != nullptr) {
+            filter->Add(key);
+        }
+        if (building_key_filter_ != nullptr) {
+            building_key_filter_->Add(key);
+        }
+    }
+
+    // grow the key index for n new keys before mu_ is held, inserts can not grow it
+    void ReserveKeyIndex(uint64_t n);
+    // the methods below need mu_ held exclusively
+    // the replaced index is freed by GcFreeList as the nodes removed at the same gc version
+    void ReplaceKeyIndexUnlock(KeyIndex* index);
+    // the replaced filter is freed by GcFreeList as the key index, KeyMayExist may still read it
+    void ReplaceKeyFilterUnlock(KeyFilter* filter);
+    // insert a new key to entries_, the key filter and the key index, return the height of the node
+    uint8_t InsertKeyEntryUnlock(const Slice& key, void* entry);
+    // insert the node of a new key to the key index and the one being built, mu_ must be held
+    void InsertKeyIndex(base::Node<Slice, void*>* node);
+    // close the entries of key and unlink it, the puts without mu_ do not insert into a removed key. If only_empty
+    // is set, the key is kept when any of its entries has a row. Return the node unlinked
+    base::Node<Slice, void*>* RemoveKeyEntryUnlock(const Slice& key, bool only_empty);
+
+    // called after a row of a single ts segment is inserted, it keeps the expiry directory of gc valid
+    void UpdateOldestPutTime(uint64_t time) {
+        uint64_t cur = oldest_put_time_.load();
+        while (time < cur && !oldest_put_time_.compare_exchange_weak(cur, time)) {
+        }
+    }
+
+ private:
+    class GcScanner;
+    enum class GcPassMode { kScan, kBuild, kDirectory };
+    // adjacent keys from start_key to the start_key of the next chunk, and the oldest time of their rows
+    struct GcChunk {
+        std::string start_key;
+        uint64_t oldest_time;
+    };
+
  protected:
+    // declared first, it must outlive the entries and the node cache
+    std::shared_ptr<base::SlabAllocator> slab_;
     KeyEntries* entries_;
-    std::mutex mu_;
+    // the puts of a new key hold it in shared mode and insert the key with cas, delete and gc which unlink keys hold
+    // it exclusively. The puts of an existing key do not take it, the time index of the key synchronizes them
+    std::shared_mutex mu_;
     std::atomic<uint64_t> idx_byte_size_;
     std::atomic<uint64_t> pk_cnt_;
     uint8_t key_entry_max_height_;
     uint32_t ts_cnt_;
     std::atomic<uint64_t> gc_version_;
+    std::atomic<uint64_t> delete_cnt_;
     // <real_ts_idx, idx_in_entries>
     std::map<uint32_t, uint32_t> ts_idx_map_;
     std::vector<std::shared_ptr<std::atomic<uint64_t>>> idx_cnt_vec_;
     uint64_t ttl_offset_;
     NodeCache node_cache_;
+    // null if disabled. readers load it without mu_, it is replaced with mu_ held exclusively
+    std::atomic<KeyFilter*> key_filter_;
+    // the filter being filled by RebuildKeyFilter, puts add new keys to it too. guarded by mu_
+    KeyFilter* building_key_filter_;
+    // null if disabled. point lookups read it without mu_, puts insert new keys with mu_ held shared, removes and
+    // grows hold mu_ exclusively
+    std::atomic<KeyIndex*> key_index_;
+    // the index being filled by ReserveKeyIndex, puts insert new keys to it too. guarded by mu_ as the nodes
+    // removed meanwhile, which are removed again before the index is used
+    KeyIndex* building_key_index_;
+    std::vector<base::Node<Slice, void*>*> building_removed_nodes_;
+    // held by the build of the key index, GcFreeList keeps the removed nodes until the build is done
+    std::mutex grow_key_index_mu_;
+    std::mutex retired_mu_;
+    // <gc version, filter or index>, guarded by retired_mu_
+    std::vector<std::pair<uint64_t, std::unique_ptr<KeyFilter>>> retired_key_filters_;
+    std::vector<std::pair<uint64_t, std::unique_ptr<KeyIndex>>> retired_key_indexes_;
+    // the state of incremental gc, only used by the gc thread. gc_cursor_ is the key a stopped pass resumes from
+    std::optional<std::string> gc_cursor_;
+    GcPassMode gc_cursor_mode_;
+    bool gc_pass_stopped_;
+    uint64_t gc_visited_key_cnt_;
+    // the expiry directory of a single ts segment, built by a pass by expire time. it's valid while every time
+    // put since the build started is later than the expire time, the chunks with no older rows are skipped then
+    std::vector<GcChunk> gc_chunks_;
+    std::vector<GcChunk> building_gc_chunks_;
+    bool gc_chunks_ready_;
+    std::atomic<uint64_t> oldest_put_time_;
 };
 
 }  // namespace storage
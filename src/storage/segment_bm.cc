@@ -0,0 +1,131 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "gflags/gflags.h"
+#include "storage/segment.h"
+
+DECLARE_bool(enable_memtable_hash_index);
+
+namespace openmldb {
+namespace storage {
+
+static Segment* segment = nullptr;
+
+// all threads put into the same segment, range(0) is the count of keys
+static void BM_SegmentPut(benchmark::State& state) {  // NOLINT
+    if (state.thread_index() == 0) {
+        segment = new Segment(8);
+    }
+    uint32_t key_num = state.range(0);
+    std::vector<std::string> keys;
+    keys.reserve(key_num);
+    for (uint32_t i = 0; i < key_num; i++) {
+        keys.push_back(absl::StrCat("key", i, "_", state.thread_index()));
+    }
+    std::string value(100, 'a');
+    uint64_t ts = 1;
+    uint32_t pos = 0;
+    for (auto _ : state) {
+        segment->Put(::openmldb::base::Slice(keys[pos]), ts++, value.c_str(), value.size());
+        if (++pos == key_num) {
+            pos = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        delete segment;
+        segment = nullptr;
+    }
+}
+
+// all threads put into the same keys
+static void BM_SegmentPutHotKey(benchmark::State& state) {  // NOLINT
+    if (state.thread_index() == 0) {
+        segment = new Segment(8);
+    }
+    uint32_t key_num = state.range(0);
+    std::vector<std::string> keys;
+    keys.reserve(key_num);
+    for (uint32_t i = 0; i < key_num; i++) {
+        keys.push_back(absl::StrCat("key", i));
+    }
+    std::string value(100, 'a');
+    uint64_t ts = 1;
+    uint32_t pos = 0;
+    for (auto _ : state) {
+        segment->Put(::openmldb::base::Slice(keys[pos]), (ts++ << 8) + state.thread_index(), value.c_str(),
+                     value.size());
+        if (++pos == key_num) {
+            pos = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        delete segment;
+        segment = nullptr;
+    }
+}
+
+// point lookups of existing keys in random order, range(0) is the count of keys and range(1) enables the hash
+// index. the segment is built once for each pair of args
+static void BM_SegmentGet(benchmark::State& state) {  // NOLINT
+    static std::unique_ptr<Segment> get_segment;
+    static std::vector<std::string> keys;
+    static std::pair<int64_t, int64_t> built_args = {0, 0};
+    if (built_args != std::make_pair(state.range(0), state.range(1))) {
+        get_segment.reset();
+        FLAGS_enable_memtable_hash_index = state.range(1) != 0;
+        get_segment = std::make_unique<Segment>(8);
+        FLAGS_enable_memtable_hash_index = false;
+        keys.clear();
+        keys.reserve(state.range(0));
+        std::string value(100, 'a');
+        for (int64_t i = 0; i < state.range(0); i++) {
+            keys.push_back(absl::StrCat("user_", i));
+            get_segment->Put(::openmldb::base::Slice(keys.back()), 1, value.c_str(), value.size());
+        }
+        std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+        built_args = {state.range(0), state.range(1)};
+    }
+    size_t pos = 0;
+    for (auto _ : state) {
+        Ticket ticket;
+        std::unique_ptr<MemTableIterator> it(
+            get_segment->NewIterator(keys[pos], ticket, type::CompressType::kNoCompress));
+        it->SeekToFirst();
+        benchmark::DoNotOptimize(it->Valid());
+        if (++pos == keys.size()) {
+            pos = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_SegmentPut)->Arg(1000)->Arg(100000)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(BM_SegmentPutHotKey)->Arg(1)->Arg(100)->ThreadRange(1, 16)->UseRealTime();
+// 100M keys of one partition take about 20GB
+BENCHMARK(BM_SegmentGet)->ArgsProduct({{10000000, 100000000}, {0, 1}})->Unit(benchmark::kNanosecond);
+
+}  // namespace storage
+}  // namespace openmldb
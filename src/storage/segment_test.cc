@@ -18,13 +18,20 @@
 
 #include <iostream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "absl/strings/str_cat.h"
 #include "base/glog_wrapper.h"
 #include "base/slice.h"
+#include "gflags/gflags.h"
 #include "gtest/gtest.h"
 #include "storage/record.h"
 
+DECLARE_uint32(time_index_array_max_size);
+DECLARE_uint32(key_filter_bits_per_key);
+DECLARE_bool(enable_memtable_hash_index);
+
 using ::openmldb::base::Slice;
 
 namespace openmldb {
@@ -38,7 +45,7 @@ class SegmentTest : public ::testing::Test {
 
 TEST_F(SegmentTest, Size) {
     ASSERT_EQ(16, (int64_t)sizeof(DataBlock));
-    ASSERT_EQ(40, (int64_t)sizeof(KeyEntry));
+    ASSERT_EQ(32, (int64_t)sizeof(KeyEntry));
 }
 
 TEST_F(SegmentTest, DataBlock) {
@@ -145,6 +152,70 @@ TEST_F(SegmentTest, Delete) {
     CheckStatisticsInfo(CreateStatisticsInfo(4, 365, 4 * (5 + sizeof(DataBlock))), gc_info);
 }
 
+TEST_F(SegmentTest, KeyFilter) {
+    FLAGS_key_filter_bits_per_key = 10;
+    Segment segment(8);
+    FLAGS_key_filter_bits_per_key = 0;
+    const int key_num = 10000;
+    std::string value = "test";
+    for (int i = 0; i < key_num; i++) {
+        segment.Put(Slice(absl::StrCat("key", i)), 9527, value.c_str(), value.size());
+    }
+    for (int i = 0; i < key_num; i++) {
+        std::string key = absl::StrCat("key", i);
+        ASSERT_TRUE(segment.KeyMayExist(key));
+        Ticket ticket;
+        std::unique_ptr<MemTableIterator> it(segment.NewIterator(key, ticket, type::CompressType::kNoCompress));
+        it->SeekToFirst();
+        ASSERT_TRUE(it->Valid());
+        uint64_t count = 0;
+        ASSERT_EQ(0, segment.GetCount(key, count));
+        ASSERT_EQ(1u, count);
+    }
+    int false_positive = 0;
+    for (int i = 0; i < key_num; i++) {
+        std::string key = absl::StrCat("absent", i);
+        if (segment.KeyMayExist(key)) {
+            false_positive++;
+        }
+        Ticket ticket;
+        std::unique_ptr<MemTableIterator> it(segment.NewIterator(key, ticket, type::CompressType::kNoCompress));
+        it->SeekToFirst();
+        ASSERT_FALSE(it->Valid());
+    }
+    ASSERT_LT(false_positive, key_num / 20);
+
+    for (int i = 0; i < key_num; i += 2) {
+        ASSERT_TRUE(segment.Delete(std::nullopt, absl::StrCat("key", i)));
+    }
+    // the deleted keys stay in the filter until it is rebuilt
+    for (int i = 0; i < key_num; i += 2) {
+        ASSERT_TRUE(segment.KeyMayExist(absl::StrCat("key", i)));
+    }
+    segment.RebuildKeyFilter();
+    false_positive = 0;
+    for (int i = 0; i < key_num; i++) {
+        std::string key = absl::StrCat("key", i);
+        if (i % 2 == 1) {
+            ASSERT_TRUE(segment.KeyMayExist(key));
+        } else if (segment.KeyMayExist(key)) {
+            false_positive++;
+        }
+    }
+    ASSERT_LT(false_positive, key_num / 20);
+    segment.IncrGcVersion();
+    segment.IncrGcVersion();
+    StatisticsInfo gc_info(1);
+    segment.GcFreeList(&gc_info);
+    ASSERT_EQ(key_num / 2, (int64_t)gc_info.GetIdxCnt(0));
+    // the replaced filter is freed with the gc version, the installed one is kept
+    ASSERT_TRUE(segment.KeyMayExist("key1"));
+
+    // a segment without filter always returns true
+    Segment no_filter_segment(8);
+    ASSERT_TRUE(no_filter_segment.KeyMayExist("absent"));
+}
+
 TEST_F(SegmentTest, GetCount) {
     Segment segment(8);
     Slice pk("test1");
@@ -193,6 +264,43 @@ TEST_F(SegmentTest, GetCount) {
     ASSERT_EQ(1, (int64_t)count);
 }
 
+TEST_F(SegmentTest, GetPutCount) {
+    Segment segment(8);
+    Slice pk("test1");
+    std::string value = "test0";
+    uint64_t count = 0;
+    ASSERT_EQ(-1, segment.GetPutCount(pk, 0, count));
+    segment.Put(pk, 9527, value.c_str(), value.size());
+    segment.Put(pk, 9529, value.c_str(), value.size());
+    ASSERT_EQ(0, segment.GetPutCount(pk, 0, count));
+    ASSERT_EQ(2, (int64_t)count);
+    // a row put late counts as well
+    segment.Put(pk, 9528, value.c_str(), value.size());
+    ASSERT_EQ(0, segment.GetPutCount(pk, 0, count));
+    ASSERT_EQ(3, (int64_t)count);
+    // gc does not decrease it
+    StatisticsInfo gc_info(1);
+    segment.Gc4TTL(9528, &gc_info);
+    ASSERT_EQ(0, segment.GetCount(pk, count));
+    ASSERT_EQ(1, (int64_t)count);
+    ASSERT_EQ(0, segment.GetPutCount(pk, 0, count));
+    ASSERT_EQ(3, (int64_t)count);
+
+    std::vector<uint32_t> ts_idx_vec = {1, 3};
+    Segment segment1(8, ts_idx_vec);
+    Slice pk1("pk");
+    std::map<int32_t, uint64_t> ts_map = {{1, 1100}, {3, 1200}};
+    DataBlock db(1, "test1", 5);
+    segment1.Put(pk1, ts_map, &db);
+    ts_map.erase(3);
+    segment1.Put(pk1, ts_map, &db);
+    ASSERT_EQ(-1, segment1.GetPutCount(pk1, 0, count));
+    ASSERT_EQ(0, segment1.GetPutCount(pk1, 1, count));
+    ASSERT_EQ(2, (int64_t)count);
+    ASSERT_EQ(0, segment1.GetPutCount(pk1, 3, count));
+    ASSERT_EQ(1, (int64_t)count);
+}
+
 TEST_F(SegmentTest, Iterator) {
     Segment segment(8);
     Slice pk("test1");
@@ -260,6 +368,40 @@ TEST_F(SegmentTest, TestGc4TTL) {
     CheckStatisticsInfo(CreateStatisticsInfo(2, 194, 2 * GetRecordSize(5)), gc_info);
 }
 
+TEST_F(SegmentTest, TestGc4TTLWithSlab) {
+    auto slab = std::make_shared<base::SlabAllocator>();
+    Segment segment(8, slab);
+    for (int i = 0; i < 1000; i++) {
+        segment.Put(absl::StrCat("PK", i), 9768, "test1", 5);
+        segment.Put(absl::StrCat("PK", i), 9769, "test2", 5);
+    }
+    ASSERT_GT(slab->GetUsedBytes(), 0u);
+    Ticket ticket;
+    std::unique_ptr<MemTableIterator> it(segment.NewIterator("PK1", ticket, type::CompressType::kNoCompress));
+    it->SeekToFirst();
+    ASSERT_TRUE(it->Valid());
+    ASSERT_EQ(9769, (int64_t)it->GetKey());
+    ASSERT_EQ("test2", it->GetValue().ToString());
+    it.reset();
+    ticket.Pop();
+
+    StatisticsInfo gc_info(1);
+    segment.Gc4TTL(9770, &gc_info);
+    CheckStatisticsInfo(CreateStatisticsInfo(2000, 0, 2000 * GetRecordSize(5)), gc_info);
+    segment.IncrGcVersion();
+    segment.IncrGcVersion();
+    segment.GcFreeList(&gc_info);
+    ASSERT_EQ(0u, segment.GetIdxCnt());
+    ASSERT_EQ(0u, slab->GetUsedBytes());
+    for (int i = 0; i < 1000; i++) {
+        segment.Put(absl::StrCat("PK", i), 9768, "test1", 5);
+    }
+    ASSERT_EQ(1000u, segment.GetIdxCnt());
+    StatisticsInfo release_info(1);
+    segment.Release(&release_info);
+    ASSERT_EQ(0u, slab->GetUsedBytes());
+}
+
 TEST_F(SegmentTest, TestGc4TTLAndHead) {
     Segment segment(8);
     segment.Put("PK1", 9766, "test1", 5);
@@ -540,6 +682,381 @@ TEST_F(SegmentTest, PutIfAbsent) {
     }
 }
 
+TEST_F(SegmentTest, TimeIndexArray) {
+    uint32_t old_max_size = FLAGS_time_index_array_max_size;
+    FLAGS_time_index_array_max_size = 4;
+    auto scan = [](Segment* segment) {
+        Ticket ticket;
+        std::unique_ptr<MemTableIterator> it(segment->NewIterator("PK", ticket, type::CompressType::kNoCompress));
+        std::vector<std::string> rows;
+        for (it->SeekToFirst(); it->Valid(); it->Next()) {
+            rows.push_back(absl::StrCat(it->GetKey(), ":", it->GetValue().ToString()));
+        }
+        return rows;
+    };
+    Segment segment(8);
+    segment.Put("PK", 9768, "test1", 5);
+    uint64_t pk_size = segment.GetIdxByteSize() - TIME_SLOT_SIZE;
+    segment.Put("PK", 9770, "test2", 5);
+    segment.Put("PK", 9769, "test3", 5);
+    segment.Put("PK", 9769, "test4", 5);
+    ASSERT_EQ(pk_size + 4 * TIME_SLOT_SIZE, segment.GetIdxByteSize());
+    std::vector<std::string> expect = {"9770:test2", "9769:test4", "9769:test3", "9768:test1"};
+    ASSERT_EQ(expect, scan(&segment));
+    {
+        Ticket ticket;
+        std::unique_ptr<MemTableIterator> it(segment.NewIterator("PK", ticket, type::CompressType::kNoCompress));
+        it->Seek(9769);
+        ASSERT_TRUE(it->Valid());
+        ASSERT_EQ("test4", it->GetValue().ToString());
+        it->SeekToLast();
+        ASSERT_TRUE(it->Valid());
+        ASSERT_EQ("test1", it->GetValue().ToString());
+    }
+
+    // the fifth row promotes the array to a skiplist and keeps the order
+    segment.Put("PK", 9769, "test5", 5);
+    ASSERT_GT(segment.GetIdxByteSize(), pk_size + GetTimeListSize(8) + 5 * TIME_SLOT_SIZE);
+    expect = {"9770:test2", "9769:test5", "9769:test4", "9769:test3", "9768:test1"};
+    ASSERT_EQ(expect, scan(&segment));
+
+    // the list is not compacted while it's read
+    StatisticsInfo gc_info(1);
+    {
+        Ticket ticket;
+        std::unique_ptr<MemTableIterator> it(segment.NewIterator("PK", ticket, type::CompressType::kNoCompress));
+        it->SeekToFirst();
+        segment.Gc4Head(2, &gc_info);
+        ASSERT_EQ(0u, gc_info.GetIdxCnt(0));
+    }
+    // gc shrinks the list to no more than the half of the max size, it's compacted to an array
+    segment.Gc4Head(2, &gc_info);
+    ASSERT_EQ(3u, gc_info.GetIdxCnt(0));
+    ASSERT_EQ(3 * GetRecordSize(5), gc_info.record_byte_size);
+    ASSERT_EQ(pk_size + 2 * TIME_SLOT_SIZE, segment.GetIdxByteSize());
+    expect = {"9770:test2", "9769:test5"};
+    ASSERT_EQ(expect, scan(&segment));
+
+    // delete the rows in the array, an iterator keeps reading the array it loads until the gc version passes
+    {
+        Ticket ticket;
+        std::unique_ptr<MemTableIterator> it(segment.NewIterator("PK", ticket, type::CompressType::kNoCompress));
+        it->SeekToFirst();
+        ASSERT_TRUE(segment.Delete(std::nullopt, "PK", 9770, 9769));
+        std::vector<std::string> rows;
+        for (; it->Valid(); it->Next()) {
+            rows.push_back(absl::StrCat(it->GetKey(), ":", it->GetValue().ToString()));
+        }
+        ASSERT_EQ(expect, rows);
+    }
+    expect = {"9769:test5"};
+    ASSERT_EQ(expect, scan(&segment));
+    ASSERT_TRUE(segment.Delete(std::nullopt, "PK", 9769, std::nullopt));
+    ASSERT_TRUE(scan(&segment).empty());
+    segment.IncrGcVersion();
+    segment.IncrGcVersion();
+    segment.GcFreeList(&gc_info);
+    ASSERT_EQ(0u, segment.GetIdxByteSize());
+    ASSERT_EQ(5u, gc_info.GetIdxCnt(0));
+
+    // 0 keeps the rows in a skiplist as before
+    FLAGS_time_index_array_max_size = 0;
+    segment.Put("PK", 9768, "test1", 5);
+    ASSERT_GT(segment.GetIdxByteSize(), pk_size + GetTimeListSize(8));
+    FLAGS_time_index_array_max_size = old_max_size;
+}
+
+TEST_F(SegmentTest, ConcurrentPut) {
+    uint32_t thread_num = 8;
+    uint32_t key_num = 100;
+    uint32_t put_num = 2000;
+    {
+        Segment segment(8);
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < thread_num; i++) {
+            threads.emplace_back([&segment, i, key_num, put_num] {
+                std::string value = "value";
+                for (uint32_t j = 0; j < put_num; j++) {
+                    std::string key = absl::StrCat("key", j % key_num);
+                    segment.Put(Slice(key), 1000 + j * 10 + i, value.c_str(), value.size());
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        ASSERT_EQ(key_num, segment.GetPkCnt());
+        ASSERT_EQ(thread_num * put_num, segment.GetIdxCnt());
+        ASSERT_EQ(thread_num * put_num, (uint32_t)GetCount(&segment, 0));
+        uint64_t count = 0;
+        ASSERT_EQ(0, segment.GetCount(Slice("key0"), count));
+        ASSERT_EQ(thread_num * put_num / key_num, count);
+    }
+    {
+        std::vector<uint32_t> ts_idx_vec = {1, 3};
+        Segment segment(8, ts_idx_vec);
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < thread_num; i++) {
+            threads.emplace_back([&segment, i, key_num, put_num] {
+                for (uint32_t j = 0; j < put_num; j++) {
+                    std::string key = absl::StrCat("key", j % key_num);
+                    std::map<int32_t, uint64_t> ts_map = {{1, 1000 + j * 10 + i}, {3, 2000 + j * 10 + i}};
+                    auto* block = new DataBlock(2, "value", 5);
+                    segment.Put(Slice(key), ts_map, block);
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        ASSERT_EQ(key_num, segment.GetPkCnt());
+        ASSERT_EQ(thread_num * put_num, (uint32_t)GetCount(&segment, 1));
+        ASSERT_EQ(thread_num * put_num, (uint32_t)GetCount(&segment, 3));
+    }
+}
+
+TEST_F(SegmentTest, CloseTimeEntries) {
+    KeyEntry entry(4);
+    RemovedRows retired;
+    uint32_t byte_size = 0;
+    auto* row = new DataBlock(1, "value", 5);
+    ASSERT_TRUE(entry.entries.Insert(1000, row, nullptr, &retired, &byte_size) ==
+                TimeEntries::InsertStatus::kInserted);
+    ASSERT_FALSE(entry.entries.Close(true));
+    auto exists = [] { return true; };
+    ASSERT_TRUE(entry.entries.InsertIfAbsent(1000, row, nullptr, &retired, &byte_size, exists) ==
+                TimeEntries::InsertStatus::kExisted);
+    RemovedRows rows = entry.entries.SplitAll(nullptr);
+    ASSERT_TRUE(entry.entries.Close(true));
+    // a put to a closed key fails, it looks the key up again
+    ASSERT_TRUE(entry.entries.Insert(1001, row, nullptr, &retired, &byte_size) == TimeEntries::InsertStatus::kClosed);
+    ASSERT_TRUE(entry.entries.InsertIfAbsent(1001, row, nullptr, &retired, &byte_size, exists) ==
+                TimeEntries::InsertStatus::kClosed);
+    entry.entries.Reopen();
+    ASSERT_TRUE(entry.entries.Insert(1001, row, nullptr, &retired, &byte_size) ==
+                TimeEntries::InsertStatus::kInserted);
+    ASSERT_EQ(1u, entry.entries.GetSize());
+    ASSERT_TRUE(entry.entries.Close(false));
+    RemovedRows left = entry.entries.SplitAll(nullptr);
+    TimeArray::Delete(rows.rows, nullptr);
+    TimeArray::Delete(left.rows, nullptr);
+    delete row;
+}
+
+TEST_F(SegmentTest, ConcurrentPutAndGc) {
+    // the puts take no segment lock, gc removing a key emptied by it must not drop a row put to the key meanwhile
+    uint32_t thread_num = 4;
+    uint32_t key_num = 20000;
+    Segment segment(8);
+    std::atomic<bool> stop(false);
+    std::thread gc_thread([&segment, &stop] {
+        while (!stop.load(std::memory_order_relaxed)) {
+            StatisticsInfo gc_info(1);
+            segment.Gc4TTL(100, &gc_info);
+        }
+    });
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < thread_num; i++) {
+        threads.emplace_back([&segment, i, key_num] {
+            std::string value = "value";
+            for (uint32_t j = 0; j < key_num; j++) {
+                std::string key = absl::StrCat("key", j);
+                segment.Put(Slice(key), 1, value.c_str(), value.size());
+                segment.Put(Slice(key), 1000 + i, value.c_str(), value.size());
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    stop.store(true);
+    gc_thread.join();
+    StatisticsInfo gc_info(1);
+    segment.Gc4TTL(100, &gc_info);
+    ASSERT_EQ(thread_num * key_num, (uint32_t)GetCount(&segment, 0));
+    for (uint32_t j = 0; j < key_num; j++) {
+        uint64_t count = 0;
+        ASSERT_EQ(0, segment.GetCount(Slice(absl::StrCat("key", j)), count));
+    }
+}
+
+TEST_F(SegmentTest, HashIndex) {
+    FLAGS_enable_memtable_hash_index = true;
+    Segment segment(8);
+    std::vector<uint32_t> ts_idx_vec = {1, 3};
+    Segment multi_ts_segment(8, ts_idx_vec);
+    FLAGS_enable_memtable_hash_index = false;
+    // the index grows from 1024 slots several times
+    const int key_num = 10000;
+    std::string value = "test";
+    auto put = [&](int i) {
+        std::string key = absl::StrCat("key", i);
+        segment.Put(Slice(key), 9527, value.c_str(), value.size());
+        std::map<int32_t, uint64_t> ts_map = {{1, 9527}, {3, 9527}};
+        multi_ts_segment.Put(Slice(key), ts_map, new DataBlock(2, value.c_str(), value.size()));
+    };
+    auto exists = [&](const std::string& key) {
+        Ticket ticket;
+        std::unique_ptr<MemTableIterator> it(segment.NewIterator(key, ticket, type::CompressType::kNoCompress));
+        it->SeekToFirst();
+        std::unique_ptr<MemTableIterator> multi_it(
+            multi_ts_segment.NewIterator(key, 3, ticket, type::CompressType::kNoCompress));
+        multi_it->SeekToFirst();
+        EXPECT_EQ(it->Valid(), multi_it->Valid()) << key;
+        return it->Valid();
+    };
+    for (int i = 0; i < key_num; i++) {
+        put(i);
+    }
+    for (int i = 0; i < key_num; i++) {
+        ASSERT_TRUE(exists(absl::StrCat("key", i)));
+        uint64_t count = 0;
+        ASSERT_EQ(0, segment.GetCount(absl::StrCat("key", i), count));
+        ASSERT_EQ(1u, count);
+        ASSERT_FALSE(exists(absl::StrCat("absent", i)));
+    }
+    for (int i = 0; i < key_num; i += 2) {
+        ASSERT_TRUE(segment.Delete(std::nullopt, absl::StrCat("key", i)));
+        ASSERT_TRUE(multi_ts_segment.Delete(1, absl::StrCat("key", i)));
+        ASSERT_TRUE(multi_ts_segment.Delete(3, absl::StrCat("key", i)));
+    }
+    for (int i = 0; i < key_num; i++) {
+        ASSERT_EQ(i % 2 == 1, exists(absl::StrCat("key", i)));
+    }
+    // put the deleted keys back, they reuse the removed slots
+    for (int i = 0; i < key_num; i += 2) {
+        put(i);
+    }
+    for (int i = 0; i < key_num; i++) {
+        ASSERT_TRUE(exists(absl::StrCat("key", i)));
+    }
+    ASSERT_EQ(key_num, GetCount(&segment, 0));
+    for (int i = 0; i < 3; i++) {
+        segment.IncrGcVersion();
+        multi_ts_segment.IncrGcVersion();
+        StatisticsInfo gc_info(1);
+        segment.GcFreeList(&gc_info);
+        StatisticsInfo multi_ts_gc_info(2);
+        multi_ts_segment.GcFreeList(&multi_ts_gc_info);
+    }
+    for (int i = 0; i < key_num; i++) {
+        ASSERT_TRUE(exists(absl::StrCat("key", i)));
+    }
+}
+
+TEST_F(SegmentTest, HashIndexGrowWithPutsAndDeletes) {
+    FLAGS_enable_memtable_hash_index = true;
+    Segment segment(8);
+    FLAGS_enable_memtable_hash_index = false;
+    // the index is built without the lock while the other threads put and delete
+    const int thread_num = 4;
+    const int key_num = 20000;
+    std::string value = "test";
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_num; t++) {
+        threads.emplace_back([&, t] {
+            for (int i = t; i < key_num; i += thread_num) {
+                segment.Put(Slice(absl::StrCat("key", i)), 9527, value.c_str(), value.size());
+                if (i % 3 == 0) {
+                    segment.Delete(std::nullopt, absl::StrCat("key", i / 2));
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int i = 0; i < key_num; i++) {
+        std::string key = absl::StrCat("key", i);
+        Ticket ticket;
+        std::unique_ptr<MemTableIterator> it(segment.NewIterator(key, ticket, type::CompressType::kNoCompress));
+        it->SeekToFirst();
+        void* entry = nullptr;
+        // the index agrees with the skiplist
+        ASSERT_EQ(segment.GetKeyEntries()->Get(Slice(key), entry) == 0, it->Valid()) << key;
+    }
+}
+
+TEST_F(SegmentTest, IncrementalGc) {
+    Segment segment(8);
+    const int key_num = 10000;
+    std::string value = "test";
+    // the keys are in the order of i, the row of key i is at 1000 + i
+    auto key_of = [](int i) { return absl::StrCat("key", 10000 + i); };
+    for (int i = 0; i < key_num; i++) {
+        segment.Put(Slice(key_of(i)), 1000 + i, value.c_str(), value.size());
+    }
+    // gc does not decrease the pk cnt, the keys left are counted in the key entries
+    auto key_cnt = [](Segment* seg) {
+        uint64_t cnt = 0;
+        std::unique_ptr<KeyEntries::Iterator> it(seg->GetKeyEntries()->NewIterator());
+        for (it->SeekToFirst(); it->Valid(); it->Next()) {
+            cnt++;
+        }
+        return cnt;
+    };
+    // run the slices of a pass, return the keys visited
+    auto gc = [&segment](uint64_t time, const GcBudget& budget, int* slice_cnt) {
+        uint64_t visited_key_cnt = 0;
+        *slice_cnt = 0;
+        do {
+            StatisticsInfo gc_info(1);
+            segment.Gc4TTL(time, &gc_info, budget);
+            visited_key_cnt += segment.GetGcVisitedKeyCnt();
+            (*slice_cnt)++;
+        } while (!segment.IsGcPassFinished());
+        return visited_key_cnt;
+    };
+    int slice_cnt = 0;
+    // the first pass visits all keys and builds the expiry directory
+    ASSERT_EQ(10000u, gc(500, GcBudget{1000, 0}, &slice_cnt));
+    ASSERT_EQ(10, slice_cnt);
+    ASSERT_EQ(10000u, key_cnt(&segment));
+    // a slice starts a new chunk, so the chunks have 1000 keys. only the first three have rows at or before 3058
+    ASSERT_EQ(3000u, gc(3058, GcBudget{100000, 0}, &slice_cnt));
+    ASSERT_EQ(1, slice_cnt);
+    ASSERT_EQ(7941u, key_cnt(&segment));
+    ASSERT_EQ(7941u, segment.GetIdxCnt());
+    ASSERT_EQ(0u, gc(3058, GcBudget{100000, 0}, &slice_cnt));
+    // the keys from 2059 to 3999 in two chunks, a pass resumes in the chunk it stops in
+    ASSERT_EQ(1941u, gc(4000, GcBudget{500, 0}, &slice_cnt));
+    ASSERT_EQ(4, slice_cnt);
+    ASSERT_EQ(6999u, key_cnt(&segment));
+    for (int i = 0; i < key_num; i++) {
+        Ticket ticket;
+        std::unique_ptr<MemTableIterator> it(segment.NewIterator(key_of(i), ticket, type::CompressType::kNoCompress));
+        it->SeekToFirst();
+        ASSERT_EQ(i > 3000, it->Valid()) << i;
+    }
+    // a row older than the expire time invalidates the directory, the next pass visits all keys
+    segment.Put(Slice(key_of(5)), 10, value.c_str(), value.size());
+    ASSERT_EQ(7000u, gc(4000, GcBudget{100000, 0}, &slice_cnt));
+    ASSERT_EQ(6999u, key_cnt(&segment));
+    ASSERT_EQ(6999u, segment.GetIdxCnt());
+    // a pass without budget visits all keys
+    StatisticsInfo gc_info(1);
+    segment.Gc4TTL(4000, &gc_info);
+    ASSERT_EQ(6999u, segment.GetGcVisitedKeyCnt());
+
+    // the slices of gc on a segment of multi ts
+    std::vector<uint32_t> ts_idx_vec = {1, 3};
+    Segment multi_ts_segment(8, ts_idx_vec);
+    for (int i = 0; i < 3000; i++) {
+        std::map<int32_t, uint64_t> ts_map = {{1, 1000 + i}, {3, 1000 + i}};
+        multi_ts_segment.Put(Slice(key_of(i)), ts_map, new DataBlock(2, value.c_str(), value.size()));
+    }
+    std::map<uint32_t, TTLSt> ttl_st_map = {{1, TTLSt(2999, 0, TTLType::kAbsoluteTime)},
+                                            {3, TTLSt(2999, 0, TTLType::kAbsoluteTime)}};
+    slice_cnt = 0;
+    do {
+        StatisticsInfo multi_ts_gc_info(2);
+        multi_ts_segment.GcAllType(ttl_st_map, &multi_ts_gc_info, std::nullopt, GcBudget{700, 0});
+        slice_cnt++;
+    } while (!multi_ts_segment.IsGcPassFinished());
+    ASSERT_EQ(5, slice_cnt);
+    ASSERT_EQ(1000u, key_cnt(&multi_ts_segment));
+}
+
 }  // namespace storage
 }  // namespace openmldb
 
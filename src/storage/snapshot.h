@@ -51,6 +51,7 @@ class Snapshot {
     uint64_t GetOffset() { return offset_; }
     int GenManifest(const std::string& snapshot_name, uint64_t key_count, uint64_t offset, uint64_t term);
     int GenManifest(const SnapshotMeta& snapshot_meta);
+    int GenManifest(const ::openmldb::api::Manifest& manifest);
     static int GetLocalManifest(const std::string& full_path,
                                 ::openmldb::api::Manifest& manifest);  // NOLINT
     std::string GetSnapshotPath() { return snapshot_path_; }
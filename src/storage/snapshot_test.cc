@@ -43,6 +43,9 @@
 
 DECLARE_string(db_root_path);
 DECLARE_string(snapshot_compression);
+DECLARE_string(snapshot_format);
+DECLARE_uint32(snapshot_max_delta_num);
+DECLARE_uint32(binlog_recover_thread_num);
 
 using ::openmldb::api::LogEntry;
 namespace openmldb {
@@ -343,6 +346,134 @@ TEST_F(SnapshotTest, Recover_only_binlog) {
     ASSERT_FALSE(it->Valid());
 }
 
+TEST_F(SnapshotTest, Recover_binlog_parallel) {
+    std::string binlog_dir = FLAGS_db_root_path + "/5_3/binlog/";
+    LogParts* log_part = new LogParts(12, 4, scmp);
+    uint64_t offset = 0;
+    uint32_t binlog_index = 0;
+    WriteHandle* wh = nullptr;
+    RollWLogFile(&wh, log_part, binlog_dir, binlog_index, offset);
+    uint32_t key_cnt = 100;
+    uint32_t total_num = 10000;
+    for (uint32_t count = 0; count < total_num; count++) {
+        std::string buffer;
+        if (count > 0 && count % (total_num / 4) == 0) {
+            RollWLogFile(&wh, log_part, binlog_dir, binlog_index, offset);
+        }
+        if (count == total_num / 2) {
+            // the puts of key0 before the delete are removed and the ones after it are kept
+            offset++;
+            ::openmldb::api::LogEntry entry;
+            entry.set_log_index(offset);
+            entry.set_method_type(::openmldb::api::MethodType::kDelete);
+            ::openmldb::api::Dimension* dimension = entry.add_dimensions();
+            dimension->set_key("key0");
+            dimension->set_idx(0);
+            entry.SerializeToString(&buffer);
+            ASSERT_TRUE(wh->Write(::openmldb::base::Slice(buffer)).ok());
+        }
+        offset++;
+        auto entry = ::openmldb::test::PackKVEntry(offset, "key" + std::to_string(count % key_cnt),
+                                                   "value" + std::to_string(count), count + 1, 0);
+        entry.SerializeToString(&buffer);
+        ASSERT_TRUE(wh->Write(::openmldb::base::Slice(buffer)).ok());
+    }
+    wh->Sync();
+    for (uint32_t thread_num : {1u, 4u}) {
+        FLAGS_binlog_recover_thread_num = thread_num;
+        std::map<std::string, uint32_t> mapping;
+        mapping.insert(std::make_pair("idx0", 0));
+        std::shared_ptr<MemTable> table =
+            std::make_shared<MemTable>("test", 5, 3, 8, mapping, 0, ::openmldb::type::TTLType::kAbsoluteTime);
+        table->Init();
+        uint64_t latest_offset = 0;
+        Binlog binlog(log_part, binlog_dir);
+        ASSERT_TRUE(binlog.RecoverFromBinlog(table, 0, latest_offset));
+        ASSERT_EQ(total_num + 1, latest_offset);
+        for (uint32_t i = 0; i < key_cnt; i++) {
+            Ticket ticket;
+            std::unique_ptr<TableIterator> it(table->NewIterator("key" + std::to_string(i), ticket));
+            it->SeekToFirst();
+            uint32_t expect_cnt = i == 0 ? total_num / key_cnt / 2 : total_num / key_cnt;
+            uint32_t cnt = 0;
+            // the entries of a key are in the descending order of ts
+            for (; it->Valid(); it->Next()) {
+                cnt++;
+                ASSERT_EQ(total_num - key_cnt + i + 1 - (cnt - 1) * key_cnt, it->GetKey());
+            }
+            ASSERT_EQ(expect_cnt, cnt) << "key" << i;
+        }
+    }
+    FLAGS_binlog_recover_thread_num = 3;
+}
+
+TEST_F(SnapshotTest, Recover_binlog_parallel_multi_dimension) {
+    std::string binlog_dir = FLAGS_db_root_path + "/5_4/binlog/";
+    LogParts* log_part = new LogParts(12, 4, scmp);
+    uint64_t offset = 0;
+    uint32_t binlog_index = 0;
+    WriteHandle* wh = nullptr;
+    RollWLogFile(&wh, log_part, binlog_dir, binlog_index, offset);
+    auto meta = ::openmldb::test::GetTableMeta({"card", "merchant", "value"});
+    ::openmldb::codec::SDKCodec sdk_codec(meta);
+    uint32_t total_num = 10000;
+    for (uint32_t count = 0; count < total_num; count++) {
+        // the cards are all different while the merchants are shared, and the entries of a ts are put in binlog order
+        offset++;
+        ::openmldb::api::LogEntry entry;
+        entry.set_log_index(offset);
+        entry.set_ts(count / 10 + 1);
+        std::string result;
+        sdk_codec.EncodeRow({"card" + std::to_string(count), "merchant" + std::to_string(count % 4),
+                             "value" + std::to_string(count)}, &result);
+        entry.set_value(result);
+        ::openmldb::api::Dimension* d1 = entry.add_dimensions();
+        d1->set_key("card" + std::to_string(count));
+        d1->set_idx(0);
+        ::openmldb::api::Dimension* d2 = entry.add_dimensions();
+        d2->set_key("merchant" + std::to_string(count % 4));
+        d2->set_idx(1);
+        std::string buffer;
+        entry.SerializeToString(&buffer);
+        ASSERT_TRUE(wh->Write(::openmldb::base::Slice(buffer)).ok());
+    }
+    wh->Sync();
+    std::map<std::string, uint32_t> mapping;
+    mapping.insert(std::make_pair("card", 0));
+    mapping.insert(std::make_pair("merchant", 1));
+    std::vector<std::string> expect_values;
+    for (uint32_t thread_num : {1u, 4u}) {
+        FLAGS_binlog_recover_thread_num = thread_num;
+        std::shared_ptr<MemTable> table =
+            std::make_shared<MemTable>("test", 5, 4, 8, mapping, 0, ::openmldb::type::TTLType::kAbsoluteTime);
+        table->Init();
+        uint64_t latest_offset = 0;
+        Binlog binlog(log_part, binlog_dir);
+        ASSERT_TRUE(binlog.RecoverFromBinlog(table, 0, latest_offset));
+        ASSERT_EQ(total_num, latest_offset);
+        // the entries of a merchant are in the same order as the sequential replay, including the ones of equal ts
+        std::vector<std::string> values;
+        for (uint32_t i = 0; i < 4; i++) {
+            Ticket ticket;
+            std::unique_ptr<TableIterator> it(table->NewIterator(1, "merchant" + std::to_string(i), ticket));
+            it->SeekToFirst();
+            for (; it->Valid(); it->Next()) {
+                std::string value(it->GetValue().data(), it->GetValue().size());
+                std::vector<std::string> row;
+                sdk_codec.DecodeRow(value, &row);
+                values.push_back(row[2]);
+            }
+        }
+        ASSERT_EQ(total_num, values.size());
+        if (thread_num == 1) {
+            expect_values = values;
+        } else {
+            ASSERT_EQ(expect_values, values);
+        }
+    }
+    FLAGS_binlog_recover_thread_num = 3;
+}
+
 TEST_F(SnapshotTest, Recover_only_snapshot_multi) {
     std::string snapshot_dir = FLAGS_db_root_path + "/3_2/snapshot";
     std::string binlog_dir = FLAGS_db_root_path + "/3_2/binlog";
@@ -1839,6 +1970,98 @@ TEST_F(SnapshotTest, DeleteRange) {
     ASSERT_EQ(5, (int64_t)manifest.term());
 }
 
+TEST_F(SnapshotTest, MakeSnapshotDelta) {
+    LogParts* log_part = new LogParts(12, 4, scmp);
+    uint32_t tid = GenRand();
+    uint32_t pid = 2;
+    MemTableSnapshot snapshot(tid, pid, log_part, FLAGS_db_root_path);
+    snapshot.Init();
+    std::map<std::string, uint32_t> mapping = { {"idx0", 0} };
+    auto table = std::make_shared<MemTable>("tx_log", tid, pid, 8, mapping, 0,
+            ::openmldb::type::TTLType::kAbsoluteTime);
+    table->Init();
+    uint64_t offset = 0;
+    uint32_t binlog_index = 0;
+    std::string log_path = absl::StrCat(FLAGS_db_root_path, "/", tid, "_", pid, "/binlog/");
+    std::string snapshot_path = absl::StrCat(FLAGS_db_root_path, "/", tid, "_", pid, "/snapshot/");
+    WriteHandle* wh = NULL;
+    RollWLogFile(&wh, log_part, log_path, binlog_index, offset++);
+    std::string buffer;
+    auto put = [&](int key_num) {
+        for (int i = 0; i < key_num; i++) {
+            auto entry = ::openmldb::test::PackKVEntry(offset, absl::StrCat("key", offset), "value", 9527, 5);
+            entry.SerializeToString(&buffer);
+            wh->Write(base::Slice(buffer));
+            offset++;
+        }
+        wh->Sync();
+    };
+    auto check = [&](uint64_t expect_offset, uint64_t expect_cnt, int expect_delta_num) {
+        ::openmldb::api::Manifest manifest;
+        ASSERT_EQ(0, GetManifest(snapshot_path + "MANIFEST", &manifest));
+        ASSERT_EQ(expect_offset, manifest.offset());
+        ASSERT_EQ(expect_cnt, manifest.count());
+        ASSERT_EQ(expect_delta_num, manifest.deltas_size());
+        std::vector<std::string> vec;
+        ASSERT_EQ(0, ::openmldb::base::GetFileName(snapshot_path, vec));
+        // the base, the deltas and MANIFEST
+        ASSERT_EQ(expect_delta_num + 2, static_cast<int>(vec.size()));
+    };
+    FLAGS_snapshot_max_delta_num = 2;
+    uint64_t offset_value = 0;
+    put(10);
+    ASSERT_EQ(0, snapshot.MakeSnapshot(table, offset_value, 0));
+    check(10, 10, 0);
+    put(2);
+    ASSERT_EQ(0, snapshot.MakeSnapshot(table, offset_value, 0));
+    check(12, 12, 1);
+    put(2);
+    ASSERT_EQ(0, snapshot.MakeSnapshot(table, offset_value, 0));
+    check(14, 14, 2);
+    ASSERT_EQ(14u, offset_value);
+    {
+        // recover the base and the deltas
+        auto new_table = std::make_shared<MemTable>("tx_log", tid, pid, 8, mapping, 0,
+                ::openmldb::type::TTLType::kAbsoluteTime);
+        new_table->Init();
+        MemTableSnapshot new_snapshot(tid, pid, log_part, FLAGS_db_root_path);
+        ASSERT_TRUE(new_snapshot.Init());
+        uint64_t latest_offset = 0;
+        ASSERT_TRUE(new_snapshot.Recover(new_table, latest_offset));
+        ASSERT_EQ(14u, latest_offset);
+        ASSERT_EQ(14u, new_table->GetRecordCnt());
+        for (int i = 1; i <= 14; i++) {
+            Ticket ticket;
+            std::unique_ptr<TableIterator> it(new_table->NewIterator(absl::StrCat("key", i), ticket));
+            it->SeekToFirst();
+            ASSERT_TRUE(it->Valid());
+            ASSERT_EQ(9527u, it->GetKey());
+        }
+    }
+    // the chain reaches the max delta count and is compacted
+    put(1);
+    ASSERT_EQ(0, snapshot.MakeSnapshot(table, offset_value, 0));
+    check(15, 15, 0);
+    put(2);
+    ASSERT_EQ(0, snapshot.MakeSnapshot(table, offset_value, 0));
+    check(17, 17, 1);
+    // a delete is compacted into the base
+    ::openmldb::api::LogEntry entry;
+    entry.set_log_index(offset++);
+    entry.set_method_type(::openmldb::api::MethodType::kDelete);
+    auto dimension = entry.add_dimensions();
+    dimension->set_key("key1");
+    dimension->set_idx(0);
+    entry.set_term(5);
+    entry.SerializeToString(&buffer);
+    wh->Write(base::Slice(buffer));
+    wh->Sync();
+    ASSERT_EQ(0, snapshot.MakeSnapshot(table, offset_value, 0));
+    check(18, 16, 0);
+    FLAGS_snapshot_max_delta_num = 0;
+    delete wh;
+}
+
 }  // namespace storage
 }  // namespace openmldb
 
@@ -1850,12 +2073,16 @@ int main(int argc, char** argv) {
     ::openmldb::test::InitRandomDiskFlags("snapshot_test");
     int ret = 0;
     std::vector<std::string> vec{"off", "zlib", "snappy"};
+    std::vector<std::string> formats{"log", "block"};
     ::openmldb::test::TempPath tmp_path;
-    for (size_t i = 0; i < vec.size(); i++) {
-        std::cout << "compress type: " << vec[i] << std::endl;
-        FLAGS_db_root_path = tmp_path.GetTempPath();
-        FLAGS_snapshot_compression = vec[i];
-        ret += RUN_ALL_TESTS();
+    for (const auto& format : formats) {
+        for (size_t i = 0; i < vec.size(); i++) {
+            std::cout << "snapshot format: " << format << ", compress type: " << vec[i] << std::endl;
+            FLAGS_db_root_path = tmp_path.GetTempPath();
+            FLAGS_snapshot_compression = vec[i];
+            FLAGS_snapshot_format = format;
+            ret += RUN_ALL_TESTS();
+        }
     }
     return ret;
 }
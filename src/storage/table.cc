@@ -115,6 +115,15 @@ int Table::InitColumnDesc() {
     AddVersionSchema(*table_meta_);
     return 0;
 }
+void Table::PutBatch(const std::vector<::openmldb::api::LogEntry>& entries, bool put_if_absent,
+                     std::vector<absl::Status>* status) {
+    status->clear();
+    status->reserve(entries.size());
+    for (const auto& entry : entries) {
+        status->push_back(Put(entry.ts(), entry.value(), entry.dimensions(), put_if_absent));
+    }
+}
+
 void Table::SetTTL(const ::openmldb::storage::UpdateTTLMeta& ttl_meta) {
     std::shared_ptr<std::vector<::openmldb::storage::UpdateTTLMeta>> old_ttl;
     std::shared_ptr<std::vector<::openmldb::storage::UpdateTTLMeta>> new_ttl;
@@ -57,6 +57,10 @@ class Table {
 
     bool Put(const ::openmldb::api::LogEntry& entry) { return Put(entry.ts(), entry.value(), entry.dimensions()).ok(); }
 
+    // put the rows of entries, status has the result of each row
+    virtual void PutBatch(const std::vector<::openmldb::api::LogEntry>& entries, bool put_if_absent,
+                          std::vector<absl::Status>* status);
+
     virtual bool Delete(const ::openmldb::api::LogEntry& entry) = 0;
 
     virtual bool Delete(uint32_t idx, const std::string& key, const std::optional<uint64_t>& start_ts,
@@ -70,6 +74,9 @@ class Table {
 
     virtual TraverseIterator* NewTraverseIterator(uint32_t index) = 0;
 
+    // false if pk is surely absent in the index, the tables without a key filter always return true
+    virtual bool KeyMayExist(uint32_t index, const std::string& pk) { return true; }
+
     virtual ::hybridse::vm::WindowIterator* NewWindowIterator(uint32_t index) = 0;
 
     virtual void SchedGc() = 0;
@@ -175,6 +182,13 @@ class Table {
 
     virtual int GetCount(uint32_t index, const std::string& pk, uint64_t& count) = 0;  // NOLINT
 
+    // the count of the rows ever put into pk of the index, it never decreases while the key lives.
+    // return -1 if the table does not track it
+    virtual int GetPutCount(uint32_t index, const std::string& pk, uint64_t& put_cnt,  // NOLINT
+                            uint64_t& delete_cnt) {                                    // NOLINT
+        return -1;
+    }
+
  protected:
     void UpdateTTL();
     bool InitFromMeta();
@@ -16,6 +16,13 @@
 
 #include "tablet/file_receiver.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
 #include "base/file_util.h"
 #include "base/glog_wrapper.h"
 #include "base/strings.h"
@@ -24,16 +31,25 @@ namespace openmldb {
 namespace tablet {
 
 FileReceiver::FileReceiver(const std::string& file_name, const std::string& dir_name, const std::string& path)
-    : file_name_(file_name), dir_name_(dir_name), path_(path), size_(0), block_id_(0), file_(NULL) {}
+    : file_name_(file_name),
+      dir_name_(dir_name),
+      path_(path),
+      size_(0),
+      expect_size_(0),
+      block_size_(0),
+      block_id_(0),
+      complete_(false),
+      fd_(-1) {}
 
 FileReceiver::~FileReceiver() {
-    if (file_) fclose(file_);
+    if (fd_ >= 0) close(fd_);
 }
 
-bool FileReceiver::Init() {
-    if (file_) {
-        fclose(file_);
-        file_ = NULL;
+bool FileReceiver::Init(uint64_t expect_size, uint32_t block_size) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
     }
     if (path_.back() != '/') {
         path_.append("/");
@@ -43,44 +59,120 @@ bool FileReceiver::Init() {
         return false;
     }
     std::string full_path = path_ + file_name_ + ".tmp";
-    FILE* file = fopen(full_path.c_str(), "wb");
-    if (file == NULL) {
+    int fd = open(full_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
         PDLOG(WARNING, "fail to open file %s", full_path.c_str());
         return false;
     }
-    file_ = file;
+    fd_ = fd;
+    size_ = 0;
+    expect_size_ = expect_size;
+    block_size_ = block_size;
     block_id_ = 0;
+    complete_ = false;
+    // the sender always sends the last block even if it is empty
+    received_.assign(block_size > 0 ? expect_size / block_size + 1 : 0, false);
     return true;
 }
 
-uint64_t FileReceiver::GetBlockId() { return block_id_; }
+uint64_t FileReceiver::GetBlockId() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return block_id_;
+}
+
+bool FileReceiver::HasBlock(uint64_t block_id) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (block_size_ == 0) {
+        return block_id <= block_id_;
+    }
+    return block_id > 0 && block_id <= received_.size() && received_[block_id - 1];
+}
 
-int FileReceiver::WriteData(const std::string& data, uint64_t block_id) {
-    if (file_ == NULL) {
-        PDLOG(WARNING, "file is NULL");
+static bool WriteAt(int fd, const std::string& data, uint64_t offset) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t r = pwrite(fd, data.data() + written, data.size() - written, offset + written);
+        if (r < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        written += r;
+    }
+    return true;
+}
+
+int FileReceiver::WriteData(const std::string& data, uint64_t block_id, bool eof, bool* complete) {
+    *complete = false;
+    std::unique_lock<std::mutex> lock(mu_);
+    if (fd_ < 0) {
+        PDLOG(WARNING, "file is not opened");
+        return -1;
+    }
+    if (block_size_ == 0) {
+        if (block_id <= block_id_) {
+            DEBUGLOG("block id %lu has been received", block_id);
+            return 0;
+        }
+        if (!WriteAt(fd_, data, size_)) {
+            PDLOG(WARNING, "write error. name %s%s error %s", path_.c_str(), file_name_.c_str(), strerror(errno));
+            return -1;
+        }
+        size_ += data.size();
+        block_id_ = block_id;
+        if (eof && !complete_) {
+            complete_ = true;
+            *complete = true;
+        }
+        return 0;
+    }
+    if (block_id == 0 || block_id > received_.size()) {
+        PDLOG(WARNING, "invalid block id %lu. name %s%s block num %lu", block_id, path_.c_str(), file_name_.c_str(),
+              received_.size());
         return -1;
     }
-    if (block_id <= block_id_) {
+    uint64_t offset = (block_id - 1) * block_size_;
+    if (data.size() != std::min<uint64_t>(block_size_, expect_size_ - offset)) {
+        PDLOG(WARNING, "invalid size %lu of block %lu. name %s%s", data.size(), block_id, path_.c_str(),
+              file_name_.c_str());
+        return -1;
+    }
+    if (received_[block_id - 1]) {
         DEBUGLOG("block id %lu has been received", block_id);
         return 0;
     }
-
-#ifdef __APPLE__
-    size_t r = fwrite(data.c_str(), 1, data.size(), file_);
-#else
-    // linux
-    size_t r = fwrite_unlocked(data.c_str(), 1, data.size(), file_);
-#endif
-    if (r < data.size()) {
-        PDLOG(WARNING, "write error. name %s%s", path_.c_str(), file_name_.c_str());
+    int fd = fd_;
+    // the blocks of the threads of the sender are written in parallel, they never overlap
+    lock.unlock();
+    if (!WriteAt(fd, data, offset)) {
+        PDLOG(WARNING, "write error. name %s%s error %s", path_.c_str(), file_name_.c_str(), strerror(errno));
         return -1;
     }
-    size_ += r;
-    block_id_ = block_id;
+    lock.lock();
+    if (received_[block_id - 1]) {
+        return 0;
+    }
+    received_[block_id - 1] = true;
+    size_ += data.size();
+    while (block_id_ < received_.size() && received_[block_id_]) {
+        block_id_++;
+    }
+    if (block_id_ == received_.size() && !complete_) {
+        complete_ = true;
+        *complete = true;
+    }
     return 0;
 }
 
 void FileReceiver::SaveFile() {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (fd_ >= 0) {
+            close(fd_);
+            fd_ = -1;
+        }
+    }
     std::string full_path = path_ + file_name_;
     std::string tmp_file_path = full_path + ".tmp";
     if (::openmldb::base::IsExists(full_path)) {
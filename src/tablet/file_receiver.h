@@ -16,7 +16,9 @@
 
 #pragma once
 
+#include <mutex>  // NOLINT
 #include <string>
+#include <vector>
 
 namespace openmldb {
 namespace tablet {
@@ -27,18 +29,31 @@ class FileReceiver {
     ~FileReceiver();
     FileReceiver(const FileReceiver&) = delete;
     FileReceiver& operator=(const FileReceiver&) = delete;
-    bool Init();
-    int WriteData(const std::string& data, uint64_t block_id);
+    // expect_size is the size of the file sent. with block_size 0 the blocks come in order and the last one has
+    // the eof, otherwise the blocks of block_size come in any order from the threads of the sender
+    bool Init(uint64_t expect_size, uint32_t block_size);
+    // complete is set by the write that makes the file have all its blocks, only one write sets it
+    int WriteData(const std::string& data, uint64_t block_id, bool eof, bool* complete);
     void SaveFile();
+    // the count of the blocks received in order from the first one, a resumed sender continues from it
     uint64_t GetBlockId();
+    bool HasBlock(uint64_t block_id);
+    uint64_t GetExpectSize() const { return expect_size_; }
+    uint32_t GetBlockSize() const { return block_size_; }
 
  private:
     std::string file_name_;
     std::string dir_name_;
     std::string path_;
+    std::mutex mu_;
     uint64_t size_;
+    uint64_t expect_size_;
+    uint32_t block_size_;
     uint64_t block_id_;
-    FILE* file_;
+    // the blocks received out of order, only used with a block size
+    std::vector<bool> received_;
+    bool complete_;
+    int fd_;
 };
 
 }  // namespace tablet
@@ -16,19 +16,21 @@
 
 #include "tablet/file_sender.h"
 
+#include <algorithm>
+#include <atomic>
 #include <thread>  // NOLINT
 #include <vector>
 
 #include "base/file_util.h"
 #include "base/glog_wrapper.h"
+#include "base/token_bucket.h"
 #include "boost/algorithm/string/predicate.hpp"
-#include "common/timer.h"
 #include "gflags/gflags.h"
+#include "log/crc32c.h"
 #include "nameserver/system_table.h"
 
 DECLARE_int32(send_file_max_try);
-DECLARE_uint32(stream_block_size);
-DECLARE_int32(stream_bandwidth_limit);
+DECLARE_uint32(send_file_thread_num);
 DECLARE_uint32(stream_block_size);
 DECLARE_int32(stream_bandwidth_limit);
 DECLARE_int32(stream_close_wait_time_ms);
@@ -39,16 +41,21 @@ DECLARE_int32(request_timeout_ms);
 namespace openmldb {
 namespace tablet {
 
-FileSender::FileSender(uint32_t tid, uint32_t pid, common::StorageMode storage_mode, const std::string& endpoint)
+// a range sent by a thread has at least the blocks, the smaller files are sent by one thread
+constexpr uint64_t kMinRangeBlockNum = 16;
+
+FileSender::FileSender(uint32_t tid, uint32_t pid, common::StorageMode storage_mode, const std::string& endpoint,
+                       ::openmldb::base::TokenBucket* total_limiter)
     : tid_(tid),
       pid_(pid),
       storage_mode_(storage_mode),
       endpoint_(endpoint),
       cur_try_time_(0),
       max_try_time_(FLAGS_send_file_max_try),
-      limit_time_(0),
       channel_(NULL),
-      stub_(NULL) {}
+      stub_(NULL),
+      limiter_(std::max(FLAGS_stream_bandwidth_limit, 0), FLAGS_stream_block_size),
+      total_limiter_(total_limiter) {}
 
 FileSender::~FileSender() {
     delete channel_;
@@ -56,12 +63,6 @@ FileSender::~FileSender() {
 }
 
 bool FileSender::Init() {
-    // compute the used time(microseconds) that send a block by limit bandwidth.
-    // limit_time = (FLAGS_stream_block_size / FLAGS_stream_bandwidth_limit) *
-    // 1000 * 1000
-    if (FLAGS_stream_bandwidth_limit > 0) {
-        limit_time_ = (FLAGS_stream_block_size * 1000000) / FLAGS_stream_bandwidth_limit;
-    }
     channel_ = new brpc::Channel();
     brpc::ChannelOptions options;
     options.auth = &client_authenticator_;
@@ -76,12 +77,47 @@ bool FileSender::Init() {
     return true;
 }
 
+int FileSender::InitReceiver(const std::string& file_name, const std::string& dir_name, uint64_t file_size,
+                             bool resume, uint64_t* received_block, bool* ranged) {
+    ::openmldb::api::SendDataRequest request;
+    request.set_tid(tid_);
+    request.set_pid(pid_);
+    request.set_storage_mode(storage_mode_);
+    request.set_file_name(file_name);
+    if (!dir_name.empty()) {
+        request.set_dir_name(dir_name);
+    }
+    request.set_block_id(0);
+    request.set_block_size(FLAGS_stream_block_size);
+    request.set_resume(resume);
+    request.set_file_size(file_size);
+    brpc::Controller cntl;
+    ::openmldb::api::GeneralResponse response;
+    stub_->SendData(&cntl, &request, &response, NULL);
+    if (cntl.Failed()) {
+        PDLOG(WARNING, "init file receiver failed. tid %u pid %u file %s error msg %s", tid_, pid_,
+              file_name.c_str(), cntl.ErrorText().c_str());
+        return -1;
+    } else if (response.code() != 0) {
+        PDLOG(WARNING, "init file receiver failed. tid %u pid %u file %s error msg %s", tid_, pid_,
+              file_name.c_str(), response.msg().c_str());
+        return -1;
+    }
+    *received_block = response.count();
+    // a receiver of an older version writes the blocks in order only
+    *ranged = response.block_size() == FLAGS_stream_block_size;
+    return 0;
+}
+
 int FileSender::WriteData(const std::string& file_name, const std::string& dir_name, const char* buffer, size_t len,
                           uint64_t block_id) {
     if (buffer == NULL) {
         return -1;
     }
-    uint64_t cur_time = ::baidu::common::timer::get_micros();
+    limiter_.Acquire(len);
+    if (total_limiter_ != nullptr) {
+        total_limiter_->Acquire(len);
+    }
     ::openmldb::api::SendDataRequest request;
     request.set_tid(tid_);
     request.set_pid(pid_);
@@ -92,11 +128,10 @@ int FileSender::WriteData(const std::string& file_name, const std::string& dir_n
     }
     request.set_block_id(block_id);
     request.set_block_size(len);
+    request.set_checksum(::openmldb::log::Value(buffer, len));
     brpc::Controller cntl;
-    if (block_id > 0) {
-        cntl.request_attachment().append(buffer, len);
-    }
-    if (len > 0 && len < FLAGS_stream_block_size) {
+    cntl.request_attachment().append(buffer, len);
+    if (len < FLAGS_stream_block_size) {
         request.set_eof(true);
     }
     ::openmldb::api::GeneralResponse response;
@@ -110,12 +145,6 @@ int FileSender::WriteData(const std::string& file_name, const std::string& dir_n
               response.msg().c_str());
         return -1;
     }
-    uint64_t time_used = ::baidu::common::timer::get_micros() - cur_time;
-    if (limit_time_ > time_used && len > FLAGS_stream_block_size / 2) {
-        uint64_t sleep_time = limit_time_ - time_used;
-        DEBUGLOG("sleep %lu us, limit_time %lu time_used %lu", sleep_time, limit_time_, time_used);
-        std::this_thread::sleep_for(std::chrono::microseconds(sleep_time));
-    }
     return 0;
 }
 
@@ -124,6 +153,11 @@ int FileSender::SendFile(const std::string& file_name, const std::string& full_p
 }
 
 int FileSender::SendFile(const std::string& file_name, const std::string& dir_name, const std::string& full_path) {
+    return SendFile(file_name, dir_name, full_path, FLAGS_send_file_thread_num);
+}
+
+int FileSender::SendFile(const std::string& file_name, const std::string& dir_name, const std::string& full_path,
+                         uint32_t thread_num) {
     if (!boost::ends_with(full_path, file_name)) {
         PDLOG(WARNING, "invalid file[%s] path[%s]", file_name.c_str(), full_path.c_str());
         return -1;
@@ -136,14 +170,24 @@ int FileSender::SendFile(const std::string& file_name, const std::string& dir_na
     PDLOG(INFO, "send file %s to %s. size[%lu]", full_path.c_str(), endpoint_.c_str(), file_size);
     int try_times = FLAGS_send_file_max_try;
     do {
-        if (try_times < FLAGS_send_file_max_try) {
+        // a retry continues from the blocks the receiver has
+        bool resume = try_times < FLAGS_send_file_max_try;
+        if (resume) {
             std::this_thread::sleep_for(
                 std::chrono::milliseconds((FLAGS_send_file_max_try - try_times) * FLAGS_retry_send_file_wait_time_ms));
             PDLOG(INFO, "retry to send file %s to %s. total size[%lu]", full_path.c_str(), endpoint_.c_str(),
                   file_size);
         }
         try_times--;
-        if (SendFileInternal(file_name, dir_name, full_path, file_size) < 0) {
+        uint64_t start_block = 0;
+        bool ranged = false;
+        if (InitReceiver(file_name, dir_name, file_size, resume, &start_block, &ranged) < 0) {
+            continue;
+        }
+        if (start_block > 0) {
+            PDLOG(INFO, "resume file %s from block %lu. tid[%u] pid[%u]", file_name.c_str(), start_block, tid_, pid_);
+        }
+        if (SendBlocks(file_name, dir_name, full_path, file_size, start_block, ranged, thread_num) < 0) {
             continue;
         }
         if (CheckFile(file_name, dir_name, file_size) < 0) {
@@ -154,39 +198,63 @@ int FileSender::SendFile(const std::string& file_name, const std::string& dir_na
     return -1;
 }
 
+int FileSender::SendBlocks(const std::string& file_name, const std::string& dir_name, const std::string& full_path,
+                           uint64_t file_size, uint64_t start_block, bool ranged, uint32_t thread_num) {
+    // the last block is sent even if it is empty, it has the eof
+    uint64_t block_num = file_size / FLAGS_stream_block_size + 1;
+    uint64_t range_num = 1;
+    if (ranged) {
+        range_num = std::min<uint64_t>(thread_num, (block_num - start_block) / kMinRangeBlockNum);
+    }
+    if (range_num <= 1) {
+        return SendFileInternal(file_name, dir_name, full_path, file_size, start_block, block_num);
+    }
+    PDLOG(INFO, "send file %s in %lu ranges. tid[%u] pid[%u]", file_name.c_str(), range_num, tid_, pid_);
+    uint64_t range_size = (block_num - start_block + range_num - 1) / range_num;
+    std::atomic<bool> has_error(false);
+    std::vector<std::thread> threads;
+    for (uint64_t begin = start_block; begin < block_num; begin += range_size) {
+        uint64_t end = std::min(begin + range_size, block_num);
+        threads.emplace_back([&, begin, end] {
+            if (SendFileInternal(file_name, dir_name, full_path, file_size, begin, end) < 0) {
+                has_error.store(true, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return has_error.load(std::memory_order_relaxed) ? -1 : 0;
+}
+
 int FileSender::SendFileInternal(const std::string& file_name, const std::string& dir_name,
-                                 const std::string& full_path, uint64_t file_size) {
+                                 const std::string& full_path, uint64_t file_size, uint64_t start_block,
+                                 uint64_t end_block) {
     FILE* file = fopen(full_path.c_str(), "rb");
     if (file == NULL) {
         PDLOG(WARNING, "fail to open file %s", full_path.c_str());
         return -1;
     }
-    char buffer[FLAGS_stream_block_size];
+    if (start_block > 0 && fseeko(file, start_block * FLAGS_stream_block_size, SEEK_SET) != 0) {
+        PDLOG(WARNING, "fail to seek file %s to block %lu", full_path.c_str(), start_block);
+        fclose(file);
+        return -1;
+    }
+    std::vector<char> block(FLAGS_stream_block_size);
+    char* buffer = block.data();
 
     uint64_t block_num = file_size / FLAGS_stream_block_size + 1;
     uint64_t report_block_num = block_num / 100;
     int ret = 0;
-    uint64_t block_count = 0;
-    do {
-        if (block_count == 0 && WriteData(file_name, dir_name, buffer, 0, block_count) < 0) {
-            PDLOG(WARNING, "Init file receiver failed. tid[%u] pid[%u] file %s", tid_, pid_, file_name.c_str());
-            ret = -1;
-            break;
-        }
-        block_count++;
-
+    for (uint64_t block_count = start_block + 1; block_count <= end_block; block_count++) {
+        uint64_t offset = (block_count - 1) * FLAGS_stream_block_size;
+        size_t expect_len = std::min<uint64_t>(FLAGS_stream_block_size, file_size - offset);
 #ifdef __APPLE__
-        size_t len = fread(buffer, 1, FLAGS_stream_block_size, file);
+        size_t len = fread(buffer, 1, expect_len, file);
 #else
-        size_t len = fread_unlocked(buffer, 1, FLAGS_stream_block_size, file);
+        size_t len = fread_unlocked(buffer, 1, expect_len, file);
 #endif
-        if (len < FLAGS_stream_block_size) {
-            if (feof(file)) {
-                if (len > 0) {
-                    ret = WriteData(file_name, dir_name, buffer, len, block_count);
-                }
-                break;
-            }
+        if (len < expect_len) {
             PDLOG(WARNING, "read file %s error. error message: %s", file_name.c_str(), strerror(errno));
             ret = -1;
             break;
@@ -202,7 +270,7 @@ int FileSender::SendFileInternal(const std::string& file_name, const std::string
                   "file[%s] endpoint[%s]",
                   block_count, block_num, tid_, pid_, file_name.c_str(), endpoint_.c_str());
         }
-    } while (true);
+    }
     fclose(file);
     std::this_thread::sleep_for(std::chrono::milliseconds(FLAGS_stream_close_wait_time_ms));
     return ret;
@@ -234,15 +302,44 @@ int FileSender::CheckFile(const std::string& file_name, const std::string& dir_n
     return 0;
 }
 
+int FileSender::SendFiles(const std::vector<std::pair<std::string, std::string>>& files,
+                          const std::string& dir_name) {
+    uint32_t thread_num = std::max(1u, std::min<uint32_t>(FLAGS_send_file_thread_num, files.size()));
+    // the threads left are used to split the blocks of each file
+    uint32_t range_thread_num = std::max(1u, FLAGS_send_file_thread_num / thread_num);
+    std::atomic<size_t> next_file(0);
+    std::atomic<bool> has_error(false);
+    // every thread keeps taking the next file until all of them are sent or one fails
+    auto send = [&] {
+        while (!has_error.load(std::memory_order_relaxed)) {
+            size_t idx = next_file.fetch_add(1, std::memory_order_relaxed);
+            if (idx >= files.size()) {
+                break;
+            }
+            if (SendFile(files[idx].first, dir_name, files[idx].second, range_thread_num) < 0) {
+                has_error.store(true, std::memory_order_relaxed);
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (uint32_t i = 1; i < thread_num; i++) {
+        threads.emplace_back(send);
+    }
+    send();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return has_error.load(std::memory_order_relaxed) ? -1 : 0;
+}
+
 int FileSender::SendDir(const std::string& dir_name, const std::string& full_path) {
     std::vector<std::string> file_vec;
     ::openmldb::base::GetFileName(full_path, file_vec);
+    std::vector<std::pair<std::string, std::string>> files;
     for (const std::string& file : file_vec) {
-        if (SendFile(file.substr(file.find_last_of("/") + 1), dir_name, file) < 0) {
-            return -1;
-        }
+        files.emplace_back(file.substr(file.find_last_of("/") + 1), file);
     }
-    return 0;
+    return SendFiles(files, dir_name);
 }
 
 }  // namespace tablet
@@ -20,38 +20,60 @@
 #include <brpc/controller.h>
 
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "proto/tablet.pb.h"
 #include "auth/brpc_authenticator.h"
+#include "base/token_bucket.h"
 
 namespace openmldb {
 namespace tablet {
 
 class FileSender {
  public:
-    FileSender(uint32_t tid, uint32_t pid, common::StorageMode storage_mode, const std::string& endpoint);
+    // the sender is limited by stream_bandwidth_limit, and by total_limiter shared with the other senders if it is
+    // not null
+    FileSender(uint32_t tid, uint32_t pid, common::StorageMode storage_mode, const std::string& endpoint,
+               ::openmldb::base::TokenBucket* total_limiter = nullptr);
     ~FileSender();
     bool Init();
     int SendFile(const std::string& file_name, const std::string& dir_name, const std::string& full_path);
     int SendFile(const std::string& file_name, const std::string& full_path);
+    // send the blocks in (start_block, end_block]
     int SendFileInternal(const std::string& file_name, const std::string& dir_name, const std::string& full_path,
-                         uint64_t file_size);
+                         uint64_t file_size, uint64_t start_block, uint64_t end_block);
+    // send the pairs of file name and full path with send_file_thread_num threads. the threads are split among the
+    // files, and the blocks of a file are split into ranges among its threads
+    int SendFiles(const std::vector<std::pair<std::string, std::string>>& files, const std::string& dir_name);
     int SendDir(const std::string& dir_name, const std::string& full_path);
+    // create the receiver of the file. with resume, the receiver keeps the blocks received if it has the same
+    // file size, and the count of them is returned in received_block. ranged is set if the receiver takes the
+    // blocks in any order
+    int InitReceiver(const std::string& file_name, const std::string& dir_name, uint64_t file_size, bool resume,
+                     uint64_t* received_block, bool* ranged);
     int WriteData(const std::string& file_name, const std::string& dir_name, const char* buffer, size_t len,
                   uint64_t block_id);
     int CheckFile(const std::string& file_name, const std::string& dir_name, uint64_t file_size);
 
  private:
+    int SendFile(const std::string& file_name, const std::string& dir_name, const std::string& full_path,
+                 uint32_t thread_num);
+    // send the blocks after start_block, split into the ranges of thread_num threads if ranged
+    int SendBlocks(const std::string& file_name, const std::string& dir_name, const std::string& full_path,
+                   uint64_t file_size, uint64_t start_block, bool ranged, uint32_t thread_num);
+
     uint32_t tid_;
     uint32_t pid_;
     common::StorageMode storage_mode_;
     std::string endpoint_;
     uint32_t cur_try_time_;
     uint32_t max_try_time_;
-    uint64_t limit_time_;
     brpc::Channel* channel_;
     ::openmldb::api::TabletServer_Stub* stub_;
     openmldb::authn::BRPCAuthenticator client_authenticator_;
+    ::openmldb::base::TokenBucket limiter_;
+    ::openmldb::base::TokenBucket* total_limiter_;
 };
 
 }  // namespace tablet
@@ -47,7 +47,10 @@
 #include "boost/bind.hpp"
 #include "boost/container/deque.hpp"
 #include "brpc/controller.h"
+#include "brpc/reloadable_flags.h"
+#include "bthread/bthread.h"
 #include "butil/iobuf.h"
+#include "client/tablet_client.h"
 #include "codec/codec.h"
 #include "codec/row_codec.h"
 #include "codec/sql_rpc_row_codec.h"
@@ -60,6 +63,7 @@
 #endif
 #include "google/protobuf/io/zero_copy_stream_impl.h"
 #include "google/protobuf/text_format.h"
+#include "log/crc32c.h"
 #include "nameserver/task.h"
 #include "schema/schema_adapter.h"
 #include "storage/binlog.h"
@@ -104,6 +108,11 @@ DECLARE_uint32(task_check_interval);
 DECLARE_uint32(load_index_max_wait_time);
 DECLARE_bool(use_name);
 DECLARE_bool(enable_distsql);
+DECLARE_uint32(window_agg_cache_size);
+DECLARE_string(jit_object_cache_dir);
+DECLARE_bool(enable_numa_placement);
+DECLARE_uint32(numa_worker_num_per_node);
+DECLARE_uint32(numa_max_pending_task_per_node);
 DECLARE_string(snapshot_compression);
 DECLARE_string(file_compression);
 DECLARE_int32(request_timeout_ms);
@@ -127,6 +136,11 @@ DECLARE_uint32(snapshot_ttl_check_interval);
 DECLARE_uint32(put_slow_log_threshold);
 DECLARE_uint32(query_slow_log_threshold);
 DECLARE_int32(snapshot_pool_size);
+DECLARE_uint32(stream_block_size);
+DECLARE_int32(stream_total_bandwidth_limit);
+
+// the limit could be changed by the flags service of brpc at runtime
+BRPC_VALIDATE_GFLAG(stream_total_bandwidth_limit, brpc::NonNegativeInteger);
 
 namespace openmldb {
 namespace tablet {
@@ -135,6 +149,16 @@ static const uint32_t SEED = 0xe17a1465;
 
 static constexpr const char DEPLOY_STATS[] = "deploy_stats";
 
+// the numa node the current worker is pinned to, -1 if it is not a numa worker
+static thread_local int numa_worker_node = -1;
+
+static double GetNumaRemoteAccessRatio(void* arg) {
+    auto access = reinterpret_cast<bvar::Adder<uint64_t>*>(arg);
+    uint64_t local = access[0].get_value();
+    uint64_t remote = access[1].get_value();
+    return local + remote == 0 ? 0 : static_cast<double>(remote) / (local + remote);
+}
+
 TabletImpl::TabletImpl()
     : tables_(),
       mu_(),
@@ -146,6 +170,7 @@ TabletImpl::TabletImpl()
       task_pool_(FLAGS_task_pool_size),
       io_pool_(FLAGS_io_pool_size),
       snapshot_pool_(FLAGS_snapshot_pool_size),
+      send_limiter_(std::max(FLAGS_stream_total_bandwidth_limit, 0), FLAGS_stream_block_size),
       mode_root_paths_(),
       mode_recycle_root_paths_(),
       follower_(false),
@@ -158,9 +183,29 @@ TabletImpl::TabletImpl()
       notify_path_(),
       globalvar_changed_notify_path_(),
       startup_mode_(::openmldb::type::StartupMode::kStandalone),
-      user_access_manager_(GetSystemTableIterator()) {}
+      user_access_manager_(GetSystemTableIterator()) {
+    if (FLAGS_enable_numa_placement) {
+        const auto& topology = ::openmldb::base::NumaTopology::Get();
+        for (uint32_t node = 0; node < topology.GetNodeCount(); node++) {
+            uint32_t worker_num = FLAGS_numa_worker_num_per_node;
+            if (worker_num == 0) {
+                worker_num = std::max<size_t>(1, topology.GetCpus(node).size());
+            }
+            numa_pools_.push_back(std::make_unique<ThreadPool>(worker_num));
+        }
+        numa_access_[0].expose("tablet_numa_local_access");
+        numa_access_[1].expose("tablet_numa_remote_access");
+        numa_overflow_.expose("tablet_numa_overflow");
+        numa_remote_ratio_ = std::make_unique<bvar::PassiveStatus<double>>("tablet_numa_remote_access_ratio",
+                                                                            GetNumaRemoteAccessRatio, numa_access_);
+        PDLOG(INFO, "numa placement is enabled with %u nodes", topology.GetNodeCount());
+    }
+}
 
 TabletImpl::~TabletImpl() {
+    for (auto& pool : numa_pools_) {
+        pool->Stop(true);
+    }
     task_pool_.Stop(true);
     trivial_task_pool_.Stop(true);
     gc_pool_.Stop(true);
@@ -222,6 +267,8 @@ bool TabletImpl::Init(const std::string& zk_cluster, const std::string& zk_path,
     } else {
         options.SetClusterOptimized(false);
     }
+    options.SetWindowAggCacheSize(FLAGS_window_agg_cache_size);
+    options.jit_options().SetObjectCacheDir(FLAGS_jit_object_cache_dir);
     engine_ = std::make_unique<::hybridse::vm::Engine>(catalog_, options);
     catalog_->SetLocalTablet(std::make_shared<::hybridse::vm::LocalTablet>(engine_.get(), sp_cache_));
     std::set<std::string> snapshot_compression_set{"off", "zlib", "snappy"};
@@ -711,8 +758,45 @@ void TabletImpl::Get(RpcController* controller, const ::openmldb::api::GetReques
     }
 }
 
+bool TabletImpl::DispatchToNumaNode(uint32_t pid, const std::function<void()>& task) {
+    if (numa_pools_.empty()) {
+        return false;
+    }
+    const auto& topology = ::openmldb::base::NumaTopology::Get();
+    int node = topology.GetNodeOfPartition(pid);
+    if (numa_worker_node == node) {
+        // the task dispatched below, it was counted when it arrived
+        return false;
+    }
+    // counted where the request arrives, a dispatched request always runs on its node
+    if (topology.GetCurrentNode() == node) {
+        numa_access_[0] << 1;
+        return false;
+    }
+    numa_access_[1] << 1;
+    // a full pool does not queue more, the request runs on the rpc worker and the rpc concurrency limit applies
+    if (numa_pools_[node]->PendingNum() >= static_cast<int64_t>(FLAGS_numa_max_pending_task_per_node)) {
+        numa_overflow_ << 1;
+        return false;
+    }
+    numa_pools_[node]->AddTask([node, task]() {
+        if (numa_worker_node != node) {
+            if (!::openmldb::base::NumaTopology::Get().PinCurrentThread(node)) {
+                PDLOG(WARNING, "fail to pin worker to numa node %d", node);
+            }
+            numa_worker_node = node;
+        }
+        task();
+    });
+    return true;
+}
+
+
 void TabletImpl::Put(RpcController* controller, const ::openmldb::api::PutRequest* request,
                      ::openmldb::api::PutResponse* response, Closure* done) {
+    if (DispatchToNumaNode(request->pid(), [=]() { Put(controller, request, response, done); })) {
+        return;
+    }
     brpc::ClosureGuard done_guard(done);
     if (follower_.load(std::memory_order_relaxed)) {
         response->set_code(::openmldb::base::ReturnCode::kIsFollowerCluster);
@@ -870,6 +954,137 @@ void TabletImpl::Put(RpcController* controller, const ::openmldb::api::PutReques
     }
 }
 
+void TabletImpl::PutBatch(RpcController* controller, const ::openmldb::api::PutBatchRequest* request,
+                          ::openmldb::api::PutBatchResponse* response, Closure* done) {
+    if (DispatchToNumaNode(request->pid(), [=]() { PutBatch(controller, request, response, done); })) {
+        return;
+    }
+    brpc::ClosureGuard done_guard(done);
+    if (follower_.load(std::memory_order_relaxed)) {
+        response->set_code(::openmldb::base::ReturnCode::kIsFollowerCluster);
+        response->set_msg("is follower cluster");
+        return;
+    }
+    uint32_t tid = request->tid();
+    uint32_t pid = request->pid();
+    auto table = GetTable(tid, pid);
+    if (auto status = CheckTable(tid, pid, true, table); !status.OK()) {
+        SetResponseStatus(status, response);
+        return;
+    }
+    uint64_t start_time = ::baidu::common::timer::get_micros();
+    if (table->GetStorageMode() == ::openmldb::common::StorageMode::kMemory &&
+        memory_used_.load(std::memory_order_relaxed) > FLAGS_max_memory_mb) {
+        PDLOG(WARNING, "current memory %lu MB exceed max memory limit %lu MB. tid %u, pid %u",
+              memory_used_.load(std::memory_order_relaxed), FLAGS_max_memory_mb, tid, pid);
+        response->set_code(::openmldb::base::ReturnCode::kExceedMaxMemory);
+        response->set_msg("exceed max memory");
+        return;
+    }
+    // the rows which pass the check, row_pos is the position of each entry in the request
+    std::vector<::openmldb::api::LogEntry> entries;
+    std::vector<int> row_pos;
+    entries.reserve(request->rows_size());
+    row_pos.reserve(request->rows_size());
+    for (int i = 0; i < request->rows_size(); i++) {
+        const auto& row = request->rows(i);
+        auto row_status = response->add_row_status();
+        row_status->set_code(::openmldb::base::ReturnCode::kOk);
+        if (row.dimensions_size() == 0 || CheckDimessionPut(row.dimensions(), table->GetIdxCnt()) != 0) {
+            row_status->set_code(::openmldb::base::ReturnCode::kInvalidDimensionParameter);
+            row_status->set_msg("invalid dimension parameter");
+            continue;
+        }
+        auto& entry = entries.emplace_back();
+        entry.set_ts(row.time());
+        if (table->GetCompressType() == openmldb::type::CompressType::kSnappy) {
+            ::snappy::Compress(row.value().c_str(), row.value().length(), entry.mutable_value());
+        } else {
+            entry.set_value(row.value());
+        }
+        entry.mutable_dimensions()->CopyFrom(row.dimensions());
+        row_pos.push_back(i);
+    }
+
+    std::vector<absl::Status> put_status;
+    table->PutBatch(entries, request->put_if_absent(), &put_status);
+    // only the rows put into the table are written to binlog
+    std::vector<::openmldb::api::LogEntry> log_entries;
+    std::vector<int> log_row_pos;
+    log_entries.reserve(entries.size());
+    for (size_t i = 0; i < entries.size(); i++) {
+        const auto& st = put_status[i];
+        if (st.ok()) {
+            log_entries.push_back(std::move(entries[i]));
+            log_row_pos.push_back(row_pos[i]);
+            continue;
+        }
+        auto row_status = response->mutable_row_status(row_pos[i]);
+        if (request->put_if_absent() && absl::IsAlreadyExists(st)) {
+            row_status->set_msg("exists but ignore");
+            continue;
+        }
+        LOG(WARNING) << st.ToString();
+        row_status->set_code(::openmldb::base::ReturnCode::kPutFailed);
+        row_status->set_msg(st.ToString());
+    }
+
+    std::shared_ptr<LogReplicator> replicator;
+    if (!log_entries.empty()) {
+        replicator = GetReplicator(tid, pid);
+        if (!replicator) {
+            PDLOG(WARNING, "fail to find table tid %u pid %u leader's log replicator", tid, pid);
+        } else {
+            uint64_t term = replicator->GetLeaderTerm();
+            for (auto& entry : log_entries) {
+                entry.set_term(term);
+            }
+            // Aggregator update assumes that binlog_offset is strictly increasing,
+            // so the appended rows of the batch are updated within the replicator lock
+            int appended_cnt = 0;
+            auto update_aggr = [this, tid, pid, &request, &response, &log_entries, &log_row_pos, &appended_cnt]() {
+                for (int i = 0; i < appended_cnt; i++) {
+                    const auto& row = request->rows(log_row_pos[i]);
+                    if (!UpdateAggrs(tid, pid, row.value(), row.dimensions(), log_entries[i].log_index())) {
+                        auto row_status = response->mutable_row_status(log_row_pos[i]);
+                        row_status->set_code(::openmldb::base::ReturnCode::kError);
+                        row_status->set_msg("update aggr failed");
+                    }
+                }
+            };
+            UpdateAggrClosure closure(update_aggr);
+            replicator->AppendEntries(&log_entries, &closure, &appended_cnt);
+            // the rows after the appended ones are in the table but not in the binlog
+            for (size_t i = appended_cnt; i < log_row_pos.size(); i++) {
+                auto row_status = response->mutable_row_status(log_row_pos[i]);
+                row_status->set_code(::openmldb::base::ReturnCode::kError);
+                row_status->set_msg("append binlog failed");
+            }
+        }
+    }
+
+    response->set_code(::openmldb::base::ReturnCode::kOk);
+    for (const auto& row_status : response->row_status()) {
+        if (row_status.code() != ::openmldb::base::ReturnCode::kOk) {
+            response->set_code(row_status.code());
+            response->set_msg(row_status.msg());
+            break;
+        }
+    }
+    uint64_t end_time = ::baidu::common::timer::get_micros();
+    if (start_time + FLAGS_put_slow_log_threshold < end_time) {
+        PDLOG(INFO, "slow log[put batch]. rows %d time %lu. tid %u, pid %u", request->rows_size(),
+              end_time - start_time, tid, pid);
+    }
+    if (replicator && FLAGS_binlog_notify_on_put) {
+        replicator->Notify();
+    }
+    if (!IsClusterMode() && table->GetDB() == openmldb::nameserver::INFORMATION_SCHEMA_DB &&
+        table->GetName() == openmldb::nameserver::GLOBAL_VARIABLES) {
+        UpdateGlobalVarTable();
+    }
+}
+
 int32_t TabletImpl::ScanIndex(const ::openmldb::api::ScanRequest* request, const ::openmldb::api::TableMeta& meta,
                               const std::map<int32_t, std::shared_ptr<Schema>>& vers_schema, bool use_attachment,
                               CombineIterator* combine_it, butil::IOBuf* io_buf, uint32_t* count, bool* is_finish) {
@@ -1716,6 +1931,9 @@ void TabletImpl::Delete(RpcController* controller, const ::openmldb::api::Delete
 
 void TabletImpl::Query(RpcController* ctrl, const openmldb::api::QueryRequest* request,
                        openmldb::api::QueryResponse* response, Closure* done) {
+    if (request->has_pid() && DispatchToNumaNode(request->pid(), [=]() { Query(ctrl, request, response, done); })) {
+        return;
+    }
     DLOG(INFO) << "handle query request begin!";
     brpc::ClosureGuard done_guard(done);
     brpc::Controller* cntl = static_cast<brpc::Controller*>(ctrl);
@@ -1799,7 +2017,7 @@ void TabletImpl::ProcessQuery(bool is_sub, RpcController* ctrl, const openmldb::
                     return;
                 }
                 byte_size += output_row.size();
-                buf->append(reinterpret_cast<void*>(output_row.buf()), output_row.size());
+                codec::AppendRpcSlice(&output_row, 0, buf);
                 count += 1;
             }
             response->set_schema(session.GetEncodedSchema());
@@ -1894,7 +2112,7 @@ void TabletImpl::ProcessQuery(bool is_sub, RpcController* ctrl, const openmldb::
                     return;
                 }
                 byte_size += output_row.size();
-                buf->append(reinterpret_cast<void*>(output_row.buf()), output_row.size());
+                codec::AppendRpcSlice(&output_row, 0, buf);
                 count += 1;
             }
             response->set_schema(session.GetEncodedSchema());
@@ -1913,6 +2131,7 @@ void TabletImpl::ProcessQuery(bool is_sub, RpcController* ctrl, const openmldb::
 
 void TabletImpl::SubQuery(RpcController* ctrl, const openmldb::api::QueryRequest* request,
                           openmldb::api::QueryResponse* response, Closure* done) {
+    // not dispatched to the numa workers, a query running on them may wait for its subqueries
     DLOG(INFO) << "handle subquery request begin!";
     brpc::ClosureGuard done_guard(done);
     brpc::Controller* cntl = static_cast<brpc::Controller*>(ctrl);
@@ -1921,6 +2140,64 @@ void TabletImpl::SubQuery(RpcController* ctrl, const openmldb::api::QueryRequest
     ProcessQuery(true, ctrl, request, response, &buf);
 }
 
+void TabletImpl::MultiProcedureQuery(RpcController* ctrl, const openmldb::api::MultiProcedureQueryRequest* request,
+                                     openmldb::api::MultiProcedureQueryResponse* response, Closure* done) {
+    brpc::ClosureGuard done_guard(done);
+    struct ProcedureTask {
+        TabletImpl* tablet;
+        RpcController* ctrl;
+        ::openmldb::api::QueryRequest request;
+        ::openmldb::api::QueryResponse* response;
+        butil::IOBuf buf;
+    };
+    int cnt = request->sp_names_size();
+    std::vector<ProcedureTask> tasks(cnt);
+    for (int i = 0; i < cnt; i++) {
+        auto& task = tasks[i];
+        task.tablet = this;
+        task.ctrl = ctrl;
+        task.request.set_db(request->db());
+        task.request.set_sp_name(request->sp_names(i));
+        task.request.set_is_debug(request->is_debug());
+        task.request.set_is_batch(false);
+        task.request.set_is_procedure(true);
+        task.request.set_row_size(request->row_size());
+        task.request.set_row_slices(request->row_slices());
+        task.response = response->add_results();
+    }
+    auto run = [](void* arg) -> void* {
+        auto task = reinterpret_cast<ProcedureTask*>(arg);
+        task->tablet->ProcessQuery(false, task->ctrl, &task->request, task->response, &task->buf);
+        return nullptr;
+    };
+    // the procedures decode the request row from the shared attachment, the first one runs in the calling bthread
+    std::vector<bthread_t> bthreads(cnt, INVALID_BTHREAD);
+    for (int i = 1; i < cnt; i++) {
+        if (bthread_start_background(&bthreads[i], nullptr, run, &tasks[i]) != 0) {
+            bthreads[i] = INVALID_BTHREAD;
+            run(&tasks[i]);
+        }
+    }
+    if (cnt > 0) {
+        run(&tasks[0]);
+    }
+    for (int i = 1; i < cnt; i++) {
+        if (bthreads[i] != INVALID_BTHREAD) {
+            bthread_join(bthreads[i], nullptr);
+        }
+    }
+    butil::IOBuf& buf = static_cast<brpc::Controller*>(ctrl)->response_attachment();
+    for (auto& task : tasks) {
+        if (task.response->code() == ::openmldb::base::kOk) {
+            buf.append(std::move(task.buf));
+        } else {
+            task.response->clear_byte_size();
+        }
+    }
+    response->set_code(::openmldb::base::kOk);
+    response->set_msg("ok");
+}
+
 void TabletImpl::SQLBatchRequestQuery(RpcController* ctrl, const openmldb::api::SQLBatchRequestQueryRequest* request,
                                       openmldb::api::SQLBatchRequestQueryResponse* response, Closure* done) {
     DLOG(INFO) << "handle query batch request begin!";
@@ -2077,8 +2354,8 @@ void TabletImpl::ProcessBatchRequestQuery(bool is_sub, RpcController* ctrl,
                 LOG(WARNING) << "illegal row ptrs: expect 2";
                 return;
             }
-            buf.append(output_row.buf(1), output_row.size(1));
             response->add_row_sizes(output_row.size(1));
+            codec::AppendRpcSlice(&output_row, 1, &buf);
         } else {
             if (output_row.GetRowPtrCnt() != 1) {
                 response->set_msg("illegal row ptrs: expect 1");
@@ -2086,8 +2363,8 @@ void TabletImpl::ProcessBatchRequestQuery(bool is_sub, RpcController* ctrl,
                 LOG(WARNING) << "illegal row ptrs: expect 1";
                 return;
             }
-            buf.append(output_row.buf(0), output_row.size(0));
             response->add_row_sizes(output_row.size(0));
+            codec::AppendRpcSlice(&output_row, 0, &buf);
         }
     }
 
@@ -2372,19 +2649,16 @@ void TabletImpl::AppendEntries(RpcController* controller, const ::openmldb::api:
         PDLOG(INFO, "first sync log_index! log_offset[%lu] tid[%u] pid[%u]", last_log_offset, tid, pid);
         return;
     }
-    for (int32_t i = 0; i < request->entries_size(); i++) {
+    // the entries are written to the binlog with one flush, then the ones written are put into the table
+    int applied_cnt = 0;
+    bool applied = replicator->ApplyEntries(request->entries(), &applied_cnt);
+    for (int32_t i = 0; i < applied_cnt; i++) {
         const auto& entry = request->entries(i);
         if (entry.log_index() <= last_log_offset) {
             PDLOG(WARNING, "entry log_index %lu cur log_offset %lu tid %u pid %u", request->entries(i).log_index(),
                   last_log_offset, tid, pid);
             continue;
         }
-        if (!replicator->ApplyEntry(entry)) {
-            PDLOG(WARNING, "fail to write binlog. tid %u pid %u", tid, pid);
-            response->set_code(::openmldb::base::ReturnCode::kFailToAppendEntriesToReplicator);
-            response->set_msg("fail to append entries to replicator");
-            return;
-        }
         if (entry.has_method_type() && entry.method_type() == ::openmldb::api::MethodType::kDelete) {
             table->Delete(entry);         // TODO(hw): error handle
         } else if (!table->Put(entry)) {  // put if type is not delete
@@ -2394,6 +2668,12 @@ void TabletImpl::AppendEntries(RpcController* controller, const ::openmldb::api:
             return;
         }
     }
+    if (!applied) {
+        PDLOG(WARNING, "fail to write binlog. tid %u pid %u", tid, pid);
+        response->set_code(::openmldb::base::ReturnCode::kFailToAppendEntriesToReplicator);
+        response->set_msg("fail to append entries to replicator");
+        return;
+    }
     response->set_log_offset(replicator->GetOffset());
 }
 
@@ -2816,8 +3096,18 @@ void TabletImpl::SendData(RpcController* controller, const ::openmldb::api::Send
                 file_receiver_map_.insert(
                     std::make_pair(combine_key, std::make_shared<FileReceiver>(request->file_name(), dir_name, path)));
                 iter = file_receiver_map_.find(combine_key);
+            } else if (request->resume() && iter->second->GetExpectSize() == request->file_size() &&
+                       iter->second->GetBlockSize() == request->block_size()) {
+                PDLOG(INFO, "resume file receiver. tid %u, pid %u, file_name %s, block_id %lu", tid, pid,
+                      request->file_name().c_str(), iter->second->GetBlockId());
+                response->set_count(iter->second->GetBlockId());
+                response->set_block_size(request->block_size());
+                response->set_code(::openmldb::base::ReturnCode::kOk);
+                response->set_msg("ok");
+                return;
             }
-            if (!iter->second->Init()) {
+            // a sender with the block size sends the blocks of a file from several threads
+            if (!iter->second->Init(request->file_size(), request->block_size())) {
                 PDLOG(WARNING, "file receiver init failed. tid %u, pid %u, file_name %s", tid, pid,
                       request->file_name().c_str());
                 response->set_code(::openmldb::base::ReturnCode::kFileReceiverInitFailed);
@@ -2826,6 +3116,7 @@ void TabletImpl::SendData(RpcController* controller, const ::openmldb::api::Send
                 return;
             }
             PDLOG(INFO, "file receiver init ok. tid %u, pid %u, file_name %s", tid, pid, request->file_name().c_str());
+            response->set_block_size(request->block_size());
             response->set_code(::openmldb::base::ReturnCode::kOk);
             response->set_msg("ok");
         } else if (iter == file_receiver_map_.end()) {
@@ -2843,12 +3134,12 @@ void TabletImpl::SendData(RpcController* controller, const ::openmldb::api::Send
         response->set_msg("cannot find receiver");
         return;
     }
-    if (receiver->GetBlockId() == request->block_id()) {
+    if (receiver->HasBlock(request->block_id())) {
         response->set_msg("ok");
         response->set_code(::openmldb::base::ReturnCode::kOk);
         return;
     }
-    if (request->block_id() != receiver->GetBlockId() + 1) {
+    if (receiver->GetBlockSize() == 0 && request->block_id() != receiver->GetBlockId() + 1) {
         response->set_msg("block_id mismatch");
         PDLOG(WARNING,
               "block_id mismatch. tid %u, pid %u, file_name %s, request "
@@ -2867,14 +3158,22 @@ void TabletImpl::SendData(RpcController* controller, const ::openmldb::api::Send
         response->set_msg("receive data error");
         return;
     }
-    if (receiver->WriteData(data, request->block_id()) < 0) {
+    if (request->has_checksum() && ::openmldb::log::Value(data.data(), data.size()) != request->checksum()) {
+        PDLOG(WARNING, "checksum mismatch. tid %u, pid %u, file_name %s, block_id %lu", tid, pid,
+              request->file_name().c_str(), request->block_id());
+        response->set_code(::openmldb::base::ReturnCode::kReceiveDataError);
+        response->set_msg("checksum mismatch");
+        return;
+    }
+    bool complete = false;
+    if (receiver->WriteData(data, request->block_id(), request->eof(), &complete) < 0) {
         PDLOG(WARNING, "receiver write data failed. tid %u, pid %u, file_name %s", tid, pid,
               request->file_name().c_str());
         response->set_code(::openmldb::base::ReturnCode::kWriteDataFailed);
         response->set_msg("write data failed");
         return;
     }
-    if (request->eof()) {
+    if (complete) {
         receiver->SaveFile();
         std::lock_guard<std::mutex> lock(mu_);
         file_receiver_map_.erase(combine_key);
@@ -2907,7 +3206,7 @@ void TabletImpl::SendSnapshot(RpcController* controller, const ::openmldb::api::
                 response->set_msg("table does not exist");
                 break;
             }
-            if (!table->IsLeader()) {
+            if (!table->IsLeader() && request->leader_endpoint().empty()) {
                 PDLOG(WARNING, "table is follower. tid %u, pid %u", tid, pid);
                 response->set_code(::openmldb::base::ReturnCode::kTableIsFollower);
                 response->set_msg("table is follower");
@@ -2929,7 +3228,7 @@ void TabletImpl::SendSnapshot(RpcController* controller, const ::openmldb::api::
         }
         sync_snapshot_set_.insert(sync_snapshot_key);
         task_pool_.AddTask(boost::bind(&TabletImpl::SendSnapshotInternal, this, request->endpoint(), tid, pid,
-                                       request->remote_tid(), task_ptr));
+                                       request->remote_tid(), request->leader_endpoint(), task_ptr));
         response->set_code(::openmldb::base::ReturnCode::kOk);
         response->set_msg("ok");
         return;
@@ -2938,6 +3237,7 @@ void TabletImpl::SendSnapshot(RpcController* controller, const ::openmldb::api::
 }
 
 void TabletImpl::SendSnapshotInternal(const std::string& endpoint, uint32_t tid, uint32_t pid, uint32_t remote_tid,
+                                      const std::string& leader_endpoint,
                                       std::shared_ptr<::openmldb::api::TaskInfo> task) {
     bool has_error = true;
     do {
@@ -2965,13 +3265,21 @@ void TabletImpl::SendSnapshotInternal(const std::string& endpoint, uint32_t tid,
             }
             real_endpoint = iter->second;
         }
-        FileSender sender(remote_tid, pid, table->GetStorageMode(), real_endpoint);
+        std::string full_path = GetDBPath(db_root_path, tid, pid) + "/";
+        if (!leader_endpoint.empty()) {
+            ::openmldb::api::Manifest manifest;
+            if (Snapshot::GetLocalManifest(full_path + "snapshot/MANIFEST", manifest) < 0 ||
+                !CheckSnapshotNotOlder(leader_endpoint, tid, pid, table->GetStorageMode(), manifest.offset())) {
+                PDLOG(WARNING, "the snapshot cannot be sent by follower. tid[%u] pid[%u]", tid, pid);
+                break;
+            }
+        }
+        FileSender sender(remote_tid, pid, table->GetStorageMode(), real_endpoint, GetSendLimiter());
         if (!sender.Init()) {
             PDLOG(WARNING, "Init FileSender failed. tid[%u] pid[%u] endpoint[%s]", tid, pid, endpoint.c_str());
             break;
         }
         // send table_meta file
-        std::string full_path = GetDBPath(db_root_path, tid, pid) + "/";
         std::string file_name = "table_meta.txt";
         if (sender.SendFile(file_name, full_path + file_name) < 0) {
             PDLOG(WARNING, "send table_meta.txt failed. tid[%u] pid[%u]", tid, pid);
@@ -2980,6 +3288,7 @@ void TabletImpl::SendSnapshotInternal(const std::string& endpoint, uint32_t tid,
         full_path.append("snapshot/");
         std::string manifest_file = full_path + "MANIFEST";
         std::string snapshot_file;
+        std::vector<std::string> delta_files;
         {
             int fd = open(manifest_file.c_str(), O_RDONLY);
             if (fd < 0) {
@@ -2995,10 +3304,18 @@ void TabletImpl::SendSnapshotInternal(const std::string& endpoint, uint32_t tid,
                 break;
             }
             snapshot_file = manifest.name();
+            for (const auto& delta : manifest.deltas()) {
+                delta_files.push_back(delta.name());
+            }
         }
         if (table->GetStorageMode() == common::kMemory) {
-            // send snapshot file
-            if (sender.SendFile(snapshot_file, full_path + snapshot_file) < 0) {
+            // send snapshot file and its deltas, the manifest sent at last makes them visible
+            std::vector<std::pair<std::string, std::string>> files;
+            files.emplace_back(snapshot_file, full_path + snapshot_file);
+            for (const auto& delta_file : delta_files) {
+                files.emplace_back(delta_file, full_path + delta_file);
+            }
+            if (sender.SendFiles(files, "") < 0) {
                 PDLOG(WARNING, "send snapshot failed. tid[%u] pid[%u]", tid, pid);
                 break;
             }
@@ -3029,6 +3346,41 @@ void TabletImpl::SendSnapshotInternal(const std::string& endpoint, uint32_t tid,
     sync_snapshot_set_.erase(sync_snapshot_key);
 }
 
+::openmldb::base::TokenBucket* TabletImpl::GetSendLimiter() {
+    send_limiter_.SetRate(std::max(FLAGS_stream_total_bandwidth_limit, 0));
+    return &send_limiter_;
+}
+
+bool TabletImpl::CheckSnapshotNotOlder(const std::string& leader_endpoint, uint32_t tid, uint32_t pid,
+                                       ::openmldb::common::StorageMode storage_mode, uint64_t offset) {
+    std::string real_endpoint;
+    if (FLAGS_use_name) {
+        auto tmp_map = std::atomic_load_explicit(&real_ep_map_, std::memory_order_acquire);
+        auto iter = tmp_map->find(leader_endpoint);
+        if (iter == tmp_map->end()) {
+            PDLOG(WARNING, "name %s not found in real_ep_map. tid[%u] pid[%u]", leader_endpoint.c_str(), tid, pid);
+            return false;
+        }
+        real_endpoint = iter->second;
+    }
+    ::openmldb::client::TabletClient client(leader_endpoint, real_endpoint);
+    if (client.Init() < 0) {
+        PDLOG(WARNING, "init client of leader %s failed. tid[%u] pid[%u]", leader_endpoint.c_str(), tid, pid);
+        return false;
+    }
+    ::openmldb::api::Manifest manifest;
+    if (!client.GetManifest(tid, pid, storage_mode, manifest)) {
+        PDLOG(WARNING, "get manifest from leader %s failed. tid[%u] pid[%u]", leader_endpoint.c_str(), tid, pid);
+        return false;
+    }
+    if (manifest.offset() > offset) {
+        PDLOG(WARNING, "snapshot offset %lu is older than %lu of leader %s. tid[%u] pid[%u]", offset,
+              manifest.offset(), leader_endpoint.c_str(), tid, pid);
+        return false;
+    }
+    return true;
+}
+
 void TabletImpl::PauseSnapshot(RpcController* controller, const ::openmldb::api::GeneralRequest* request,
                                ::openmldb::api::GeneralResponse* response, Closure* done) {
     brpc::ClosureGuard done_guard(done);
@@ -4725,16 +5077,20 @@ bool TabletImpl::RefreshAggrCatalog() {
 }
 
 int TabletImpl::CheckDimessionPut(const ::openmldb::api::PutRequest* request, uint32_t idx_cnt) {
-    for (int32_t i = 0; i < request->dimensions_size(); i++) {
-        if (idx_cnt <= request->dimensions(i).idx()) {
+    return CheckDimessionPut(request->dimensions(), idx_cnt);
+}
+
+int TabletImpl::CheckDimessionPut(const ::openmldb::storage::Dimensions& dimensions, uint32_t idx_cnt) {
+    for (const auto& dimension : dimensions) {
+        if (idx_cnt <= dimension.idx()) {
             PDLOG(WARNING,
                   "invalid put request dimensions, request idx %u is greater "
                   "than table idx cnt %u",
-                  request->dimensions(i).idx(), idx_cnt);
+                  dimension.idx(), idx_cnt);
             return -1;
         }
-        if (request->dimensions(i).key().length() <= 0) {
-            PDLOG(WARNING, "invalid put request dimension key is empty with idx %u", request->dimensions(i).idx());
+        if (dimension.key().length() <= 0) {
+            PDLOG(WARNING, "invalid put request dimension key is empty with idx %u", dimension.idx());
             return 1;
         }
     }
@@ -5046,7 +5402,7 @@ void TabletImpl::SendIndexDataInternal(std::shared_ptr<::openmldb::storage::Tabl
                 }
                 real_endpoint = iter->second;
             }
-            FileSender sender(tid, kv.first, table->GetStorageMode(), real_endpoint);
+            FileSender sender(tid, kv.first, table->GetStorageMode(), real_endpoint, GetSendLimiter());
             if (!sender.Init()) {
                 PDLOG(WARNING, "Init FileSender failed. tid[%u] pid[%u] des_pid[%u] endpoint[%s]", tid, pid, kv.first,
                       kv.second.c_str());
@@ -5583,7 +5939,7 @@ void TabletImpl::RunRequestQuery(RpcController* ctrl, const openmldb::api::Query
         return;
     }
     size_t buf_total_size;
-    if (!codec::EncodeRpcRow(output, &buf, &buf_total_size)) {
+    if (!codec::EncodeRpcRow(&output, &buf, &buf_total_size)) {
         response.set_code(::openmldb::base::kSQLRunError);
         response.set_msg("fail to encode sql output row");
         return;
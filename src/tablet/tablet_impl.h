@@ -17,6 +17,7 @@
 #ifndef SRC_TABLET_TABLET_IMPL_H_
 #define SRC_TABLET_TABLET_IMPL_H_
 
+#include <functional>
 #include <list>
 #include <map>
 #include <memory>
@@ -27,8 +28,11 @@
 #include <vector>
 
 #include "auth/user_access_manager.h"
+#include "base/numa_util.h"
 #include "base/spinlock.h"
+#include "base/token_bucket.h"
 #include "brpc/server.h"
+#include "bvar/bvar.h"
 #include "catalog/tablet_catalog.h"
 #include "common/thread_pool.h"
 #include "nameserver/system_table.h"
@@ -86,6 +90,9 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     void Put(RpcController* controller, const ::openmldb::api::PutRequest* request,
              ::openmldb::api::PutResponse* response, Closure* done);
 
+    void PutBatch(RpcController* controller, const ::openmldb::api::PutBatchRequest* request,
+                  ::openmldb::api::PutBatchResponse* response, Closure* done);
+
     void Get(RpcController* controller, const ::openmldb::api::GetRequest* request,
              ::openmldb::api::GetResponse* response, Closure* done);
 
@@ -228,6 +235,10 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     void SubQuery(RpcController* controller, const openmldb::api::QueryRequest* request,
                   openmldb::api::QueryResponse* response, Closure* done);
 
+    // run the procedures with the same request row in parallel
+    void MultiProcedureQuery(RpcController* controller, const openmldb::api::MultiProcedureQueryRequest* request,
+                             openmldb::api::MultiProcedureQueryResponse* response, Closure* done);
+
     void SQLBatchRequestQuery(RpcController* controller, const openmldb::api::SQLBatchRequestQueryRequest* request,
                               openmldb::api::SQLBatchRequestQueryResponse* response, Closure* done);
     void SubBatchRequestQuery(RpcController* controller, const openmldb::api::SQLBatchRequestQueryRequest* request,
@@ -318,7 +329,16 @@ class TabletImpl : public ::openmldb::api::TabletServer {
                               std::shared_ptr<::openmldb::api::TaskInfo> task, bool is_force);
 
     void SendSnapshotInternal(const std::string& endpoint, uint32_t tid, uint32_t pid, uint32_t remote_tid,
-                              std::shared_ptr<::openmldb::api::TaskInfo> task);
+                              const std::string& leader_endpoint, std::shared_ptr<::openmldb::api::TaskInfo> task);
+
+    // the limiter shared by the senders, its rate is updated to stream_total_bandwidth_limit which could be changed
+    // at runtime
+    ::openmldb::base::TokenBucket* GetSendLimiter();
+
+    // whether the snapshot of the follower is not older than the one of the leader, the leader deletes the binlog
+    // before its snapshot only
+    bool CheckSnapshotNotOlder(const std::string& leader_endpoint, uint32_t tid, uint32_t pid,
+                               ::openmldb::common::StorageMode storage_mode, uint64_t offset);
 
     void DumpIndexDataInternal(std::shared_ptr<::openmldb::storage::Table> table,
                                std::shared_ptr<::openmldb::storage::MemTableSnapshot> memtable_snapshot,
@@ -379,6 +399,7 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     bool IsExistTaskUnLock(const ::openmldb::api::TaskInfo& task);
 
     int CheckDimessionPut(const ::openmldb::api::PutRequest* request, uint32_t idx_cnt);
+    int CheckDimessionPut(const ::openmldb::storage::Dimensions& dimensions, uint32_t idx_cnt);
 
     // sync log data from page cache to disk
     void SchedSyncDisk(uint32_t tid, uint32_t pid);
@@ -417,6 +438,11 @@ class TabletImpl : public ::openmldb::api::TabletServer {
                                   openmldb::api::SQLBatchRequestQueryResponse* response,
                                   butil::IOBuf& buf);  // NOLINT
 
+    // run task on a worker pinned to the numa node of the partition, return false if numa placement is
+    // disabled, the caller runs on that node or the workers of the node are full, then the caller should run it
+    // in place. counts whether the request arrives on the node of its partition
+    bool DispatchToNumaNode(uint32_t pid, const std::function<void()>& task);
+
     bool UpdateAggrs(uint32_t tid, uint32_t pid, const std::string& value,
                      const ::openmldb::storage::Dimensions& dimensions, uint64_t log_offset);
 
@@ -467,9 +493,18 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     ThreadPool task_pool_;
     ThreadPool io_pool_;
     ThreadPool snapshot_pool_;
+    // the workers pinned to each numa node, empty if numa placement is disabled
+    std::vector<std::unique_ptr<ThreadPool>> numa_pools_;
+    // the count of the requests arriving on a cpu inside and outside the numa node of their partition
+    bvar::Adder<uint64_t> numa_access_[2];
+    // the count of the remote requests run in place since the workers of the node are full
+    bvar::Adder<uint64_t> numa_overflow_;
+    std::unique_ptr<bvar::PassiveStatus<double>> numa_remote_ratio_;
     std::map<uint64_t, std::list<std::shared_ptr<::openmldb::api::TaskInfo>>> task_map_;
     std::set<std::string> sync_snapshot_set_;
     std::map<std::string, std::shared_ptr<FileReceiver>> file_receiver_map_;
+    // shared by all the files sent by the tablet
+    ::openmldb::base::TokenBucket send_limiter_;
     BulkLoadMgr bulk_load_mgr_;
     std::map<::openmldb::common::StorageMode, std::vector<std::string>> mode_root_paths_;
     std::map<::openmldb::common::StorageMode, std::vector<std::string>> mode_recycle_root_paths_;
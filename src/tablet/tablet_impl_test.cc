@@ -42,6 +42,7 @@
 #include "log/log_writer.h"
 #include "proto/tablet.pb.h"
 #include "proto/type.pb.h"
+#include "storage/record.h"
 #include "test/util.h"
 
 DECLARE_string(db_root_path);
@@ -60,6 +61,8 @@ DECLARE_string(recycle_bin_ssd_root_path);
 DECLARE_string(recycle_bin_hdd_root_path);
 DECLARE_string(endpoint);
 DECLARE_uint32(recycle_ttl);
+DECLARE_uint32(skiplist_max_height);
+DECLARE_uint32(time_index_array_max_size);
 
 namespace openmldb {
 namespace tablet {
@@ -1835,6 +1838,58 @@ TEST_P(TabletImplTest, Scan) {
 }
 
 
+TEST_P(TabletImplTest, PutBatch) {
+    ::openmldb::common::StorageMode storage_mode = GetParam();
+    TabletImpl tablet;
+    uint32_t id = counter++;
+    tablet.Init("");
+    ASSERT_EQ(0, CreateDefaultTable("", "t0", id, 1, 0, 0, kAbsoluteTime, storage_mode, &tablet));
+    MockClosure closure;
+    ::openmldb::api::PutBatchRequest prequest;
+    prequest.set_tid(id);
+    prequest.set_pid(1);
+    for (int i = 0; i < 10; i++) {
+        auto row = prequest.add_rows();
+        row->set_time(9527 + i);
+        std::string key = "test" + std::to_string(i % 3);
+        row->set_value(::openmldb::test::EncodeKV(key, "value" + std::to_string(i)));
+        auto dim = row->add_dimensions();
+        dim->set_idx(0);
+        dim->set_key(key);
+    }
+    // a row with an empty key fails alone
+    auto row = prequest.add_rows();
+    row->set_time(9527);
+    row->set_value(::openmldb::test::EncodeKV("", "value"));
+    auto dim = row->add_dimensions();
+    dim->set_idx(0);
+    ::openmldb::api::PutBatchResponse presponse;
+    tablet.PutBatch(NULL, &prequest, &presponse, &closure);
+    ASSERT_EQ(::openmldb::base::ReturnCode::kInvalidDimensionParameter, presponse.code());
+    ASSERT_EQ(11, presponse.row_status_size());
+    for (int i = 0; i < 10; i++) {
+        ASSERT_EQ(0, presponse.row_status(i).code());
+    }
+    ASSERT_EQ(::openmldb::base::ReturnCode::kInvalidDimensionParameter, presponse.row_status(10).code());
+
+    ::openmldb::api::ScanRequest sr;
+    sr.set_tid(id);
+    sr.set_pid(1);
+    sr.set_pk("test0");
+    sr.set_st(9600);
+    sr.set_et(9500);
+    ::openmldb::api::ScanResponse srp;
+    tablet.Scan(NULL, &sr, &srp, &closure);
+    ASSERT_EQ(0, srp.code());
+    ASSERT_EQ(4, (signed)srp.count());
+
+    prequest.set_tid(id + 10000);
+    ::openmldb::api::PutBatchResponse not_found_response;
+    tablet.PutBatch(NULL, &prequest, &not_found_response, &closure);
+    ASSERT_EQ(100, not_found_response.code());
+}
+
+
 TEST_P(TabletImplTest, GCWithUpdateLatest) {
     ::openmldb::common::StorageMode storage_mode = GetParam();
     int32_t old_gc_interval = FLAGS_gc_interval;
@@ -6234,6 +6289,12 @@ INSTANTIATE_TEST_SUITE_P(AggregatorTest, AggregatorDeleteTest, testing::ValuesIn
 
 TEST_F(TabletImplTest, DeleteRange) {
     uint32_t id = counter++;
+    // the pk nodes get the height 1 and the rows of a key fit in its time array, so the idx byte size is exact
+    uint32_t old_max_height = FLAGS_skiplist_max_height;
+    FLAGS_skiplist_max_height = 1;
+    absl::Cleanup reset_height = [old_max_height] { FLAGS_skiplist_max_height = old_max_height; };
+    const int rows_per_key = 8;
+    ASSERT_LE(static_cast<uint32_t>(rows_per_key), FLAGS_time_index_array_max_size);
     MockClosure closure;
     ::openmldb::api::TableMeta table_meta_test;
     TabletImpl tablet;
@@ -6267,7 +6328,7 @@ TEST_F(TabletImplTest, DeleteRange) {
         d1->set_idx(0);
         d1->set_key("card" + std::to_string(i));
         uint64_t now = ::baidu::common::timer::get_micros() / 1000;
-        for (int j = 0; j < 10; j++) {
+        for (int j = 0; j < rows_per_key; j++) {
             request.set_time(now - j);
             ::openmldb::api::PutResponse response;
             MockClosure closure;
@@ -6286,7 +6347,10 @@ TEST_F(TabletImplTest, DeleteRange) {
         ASSERT_EQ(record_byte_size, g_response.all_table_status(0).record_byte_size());
         ASSERT_EQ(record_idx_byte_size, g_response.all_table_status(0).record_idx_byte_size());
     };
-    assert_status(100, 3400, 5786);
+    // "card0" to "card9", each key is a pk node and its rows are the slots of a time array
+    uint64_t idx_byte_size =
+        10 * (storage::GetRecordPkIdxSize(1, 5) + rows_per_key * storage::TIME_SLOT_SIZE);
+    assert_status(80, 2720, idx_byte_size);
 
     ::openmldb::api::DeleteRequest delete_request;
     ::openmldb::api::GeneralResponse gen_response;
@@ -6303,7 +6367,7 @@ TEST_F(TabletImplTest, DeleteRange) {
     tablet.ExecuteGc(NULL, &e_request, &gen_response, &closure);
     ASSERT_EQ(0, gen_response.code()) << gen_response.ShortDebugString();
     sleep(2);
-    assert_status(100, 3400, 5786);  // before node cache gc, status will be the same
+    assert_status(80, 2720, idx_byte_size);  // before node cache gc, status will be the same
     // gc node cache
     tablet.ExecuteGc(NULL, &e_request, &gen_response, &closure);
     ASSERT_EQ(0, gen_response.code()) << gen_response.ShortDebugString();
@@ -33,6 +33,7 @@
 #include "log/log_writer.h"
 #include "proto/common.pb.h"
 #include "proto/tablet.pb.h"
+#include "storage/block_snapshot.h"
 #include "storage/snapshot.h"
 #include "tools/tablemeta_reader.h"
 
@@ -56,6 +57,9 @@ void LogExporter::ReadManifest() {
     }
     std::string snapshot_name = manifest.name();
     snapshot_path_ = table_dir_path_ + "/snapshot/" + snapshot_name;
+    for (const auto& delta : manifest.deltas()) {
+        delta_paths_.push_back(table_dir_path_ + "/snapshot/" + delta.name());
+    }
     offset_ = manifest.offset();
     PDLOG(INFO, "Snapshot's offset: %lu, path: %s.", offset_, snapshot_path_.c_str());
 }
@@ -73,7 +77,10 @@ void LogExporter::ExportTable() {
         file_path.emplace_back(log);
     }
     if (snapshot_path_.length()) {
-        ReadSnapshot();
+        ReadSnapshot(snapshot_path_);
+        for (const auto& delta_path : delta_paths_) {
+            ReadSnapshot(delta_path);
+        }
     }
     (void) closedir(dir);
     // Sorts binlog files and performs binary search
@@ -171,17 +178,21 @@ void LogExporter::ReadLog(const std::string &log_path) {
     offset_ += success_cnt;
 }
 
-void LogExporter::ReadSnapshot() {
-    FILE* fd_r = fopen(snapshot_path_.c_str(), "rb");
+void LogExporter::ReadSnapshot(const std::string& path) {
+    if (::openmldb::storage::IsBlockSnapshot(path)) {
+        ReadBlockSnapshot(path);
+        return;
+    }
+    FILE* fd_r = fopen(path.c_str(), "rb");
     if (fd_r == NULL) {
-        PDLOG(ERROR, "fopen failed: %s", snapshot_path_.c_str());
+        PDLOG(ERROR, "fopen failed: %s", path.c_str());
         return;
     }
-    SequentialFile* rf = NewSeqFile(snapshot_path_, fd_r);
+    SequentialFile* rf = NewSeqFile(path, fd_r);
     std::string scratch;
     bool is_compress = false;
-    if (snapshot_path_.find(openmldb::log::ZLIB_COMPRESS_SUFFIX) != std::string::npos ||
-        snapshot_path_.find(openmldb::log::SNAPPY_COMPRESS_SUFFIX) != std::string::npos) {
+    if (path.find(openmldb::log::ZLIB_COMPRESS_SUFFIX) != std::string::npos ||
+        path.find(openmldb::log::SNAPPY_COMPRESS_SUFFIX) != std::string::npos) {
         is_compress = true;
     }
     Reader reader(rf, NULL, true, 0, is_compress);
@@ -214,6 +225,43 @@ void LogExporter::ReadSnapshot() {
     } while (status.ok());
 }
 
+void LogExporter::ReadBlockSnapshot(const std::string& path) {
+    ::openmldb::storage::BlockSnapshotReader reader(path);
+    Status status = reader.Open();
+    if (!status.ok()) {
+        PDLOG(ERROR, "fail to open block snapshot %s: %s", path.c_str(), status.ToString().c_str());
+        return;
+    }
+    RowView view(schema_);
+    std::string buf;
+    std::string row;
+    ::openmldb::storage::BlockChunk chunk;
+    ::google::protobuf::RepeatedPtrField<::openmldb::api::Dimension> dimensions;
+    for (uint32_t idx = 0; idx < reader.GetChunkCnt(); idx++) {
+        status = reader.ReadChunk(idx, &buf, &chunk);
+        if (!status.ok()) {
+            PDLOG(ERROR, "fail to read chunk %u of %s: %s", idx, path.c_str(), status.ToString().c_str());
+            continue;
+        }
+        for (uint32_t i = 0; i < chunk.GetRecordCnt(); i++) {
+            if (chunk.IsDelete(i)) {
+                continue;
+            }
+            // the same as the log format, only the rows with a dimension of idx 0 are exported
+            chunk.GetDimensions(i, &dimensions);
+            for (const auto& dimension : dimensions) {
+                if (dimension.idx() == 0) {
+                    auto value = chunk.GetValue(i);
+                    row.assign(value.data(), value.size());
+                    view.Reset(reinterpret_cast<int8_t*>(&(row[0])), row.size());
+                    WriteToFile(view);
+                    break;
+                }
+            }
+        }
+    }
+}
+
 void LogExporter::WriteToFile(::openmldb::codec::RowView& view) {
     // Gets the values for each column, then writes the row to the csv file.
     for (int i = 0; i < schema_.size(); ++i) {
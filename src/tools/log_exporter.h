@@ -58,13 +58,17 @@ class LogExporter {
     std::ofstream& table_cout_;
     uint64_t offset_;
     std::string snapshot_path_;
+    // the deltas after the snapshot, they are read in order
+    std::vector<std::string> delta_paths_;
     Schema schema_;
 
     uint64_t GetLogStartOffset(std::string&);
 
     void ReadLog(const std::string&);
 
-    void ReadSnapshot();
+    void ReadSnapshot(const std::string&);
+
+    void ReadBlockSnapshot(const std::string&);
 
     void WriteToFile(RowView&);
 };